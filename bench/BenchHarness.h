@@ -0,0 +1,82 @@
+#ifndef BENCHHARNESS_H
+#define BENCHHARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rove::bench {
+
+/**
+ * @struct BenchResult
+ * @brief 单个场景的测量结果：吞吐量与单次操作延迟分位数。
+ */
+struct BenchResult {
+    std::string name;
+    std::size_t iterations = 0;
+    double opsPerSecond = 0.0;
+    double p50Micros = 0.0;
+    double p99Micros = 0.0;
+};
+
+/**
+ * @brief 由逐次耗时样本（微秒）计算吞吐量与 p50/p99 延迟；吞吐量按全部样本耗时之和计算。
+ */
+inline BenchResult summarize(std::string name, std::vector<double> samples) {
+    BenchResult result;
+    result.name = std::move(name);
+    result.iterations = samples.size();
+    if (samples.empty()) {
+        return result;
+    }
+    double totalMicros = 0.0;
+    for (double micros : samples) {
+        totalMicros += micros;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        const auto rank = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+        return samples[std::min(rank, samples.size() - 1)];
+    };
+    result.p50Micros = percentile(0.50);
+    result.p99Micros = percentile(0.99);
+    result.opsPerSecond = totalMicros > 0.0 ? static_cast<double>(samples.size()) * 1e6 / totalMicros : 0.0;
+    return result;
+}
+
+/**
+ * @brief 逐次计时执行 fn(i)，i 从 0 到 iterations-1，返回吞吐量与 p50/p99 延迟。
+ * 中文：每次调用单独计时，样本排序后取分位数；不含计时外的准备工作。
+ */
+template <typename Fn>
+BenchResult measure(std::string name, std::size_t iterations, Fn&& fn) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (std::size_t i = 0; i < iterations; ++i) {
+        const auto begin = Clock::now();
+        fn(i);
+        const auto end = Clock::now();
+        samples.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+    }
+    return summarize(std::move(name), std::move(samples));
+}
+
+/**
+ * @brief 以对齐的表格打印结果，便于前后两次运行直接比较。
+ */
+inline void printResults(const std::vector<BenchResult>& results) {
+    std::printf("%-28s %10s %14s %12s %12s\n", "scenario", "iters", "ops/sec", "p50(us)", "p99(us)");
+    for (const auto& r : results) {
+        std::printf("%-28s %10zu %14.1f %12.1f %12.1f\n", r.name.c_str(), r.iterations, r.opsPerSecond, r.p50Micros,
+                    r.p99Micros);
+    }
+}
+
+}  // namespace rove::bench
+
+#endif  // BENCHHARNESS_H
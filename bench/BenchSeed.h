@@ -0,0 +1,194 @@
+#ifndef BENCHSEED_H
+#define BENCHSEED_H
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "AchievementManager.h"
+#include "DatabaseManager.h"
+#include "LogEntry.h"
+#include "ShopManager.h"
+
+/**
+ * @file BenchSeed.h
+ * @brief bench_core 与 bench_ui 共用的合成数据生成函数。
+ * 中文：各函数只追加数据、不清理旧行，可多次调用把同一个库逐级扩充到更大的规模。
+ */
+
+namespace rove::bench {
+
+/**
+ * @brief 删除上次运行留下的主库、WAL、共享内存与归档文件，保证每次从同一状态开始。
+ */
+inline void removeDatabaseFiles(const std::string& path) {
+    for (const char* suffix : {"", "-wal", "-shm", ".archive", ".archive-wal", ".archive-shm"}) {
+        std::remove((path + suffix).c_str());
+    }
+}
+
+inline std::vector<int> seedTasks(data::DatabaseManager& database, int ownerId, std::size_t count) {
+    using data::Task;
+    static constexpr Task::TaskType kTypes[] = {Task::TaskType::Daily, Task::TaskType::Weekly,
+                                                Task::TaskType::Semester, Task::TaskType::Custom};
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    std::vector<int> ids;
+    ids.reserve(count);
+    bool transactionStarted = false;
+    try {
+        transactionStarted = database.beginTransaction();
+        for (std::size_t i = 0; i < count; ++i) {
+            data::DatabaseManager::TaskRecord record;
+            record.ownerId = ownerId;
+            record.name = "bench task " + std::to_string(i);
+            record.description = "synthetic";
+            record.type = Task::typeToString(kTypes[i % 4]);
+            record.difficulty = static_cast<int>(1 + i % 5);
+            record.deadlineIso = now.addDays(static_cast<int>(1 + i % 90)).toString(Qt::ISODate).toStdString();
+            record.coinReward = 10;
+            record.growthReward = 5;
+            record.attributeReward = data::User::AttributeSet{1, 0, 0, 1, 0, 0};
+            record.customSettings = "{}";
+            record.progressGoal = 1;
+            ids.push_back(database.createTask(record));
+        }
+        database.commitTransaction();
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                database.rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+    return ids;
+}
+
+/**
+ * @brief 生成均匀分布在最近一年内的日志，四种类型轮换，分批写入。
+ */
+inline void seedLogs(data::DatabaseManager& database, int ownerId, std::size_t count) {
+    using data::LogEntry;
+    static constexpr LogEntry::LogType kTypes[] = {LogEntry::LogType::Auto, LogEntry::LogType::Manual,
+                                                   LogEntry::LogType::Milestone, LogEntry::LogType::Event};
+    constexpr std::size_t kBatchSize = 5000;
+    const QDateTime start = QDateTime::currentDateTimeUtc().addDays(-365);
+    const qint64 stepSeconds = std::max<qint64>(1, 365LL * 24 * 3600 / static_cast<qint64>(count));
+    std::vector<data::DatabaseManager::LogRecord> batch;
+    batch.reserve(kBatchSize);
+    for (std::size_t i = 0; i < count; ++i) {
+        data::DatabaseManager::LogRecord record;
+        record.ownerId = ownerId;
+        record.timestampIso =
+            start.addSecs(static_cast<qint64>(i) * stepSeconds).toString(Qt::ISODate).toStdString();
+        record.type = LogEntry::typeToString(kTypes[i % 4]);
+        record.content = "bench log " + std::to_string(i) + (i % 7 == 0 ? " 图书馆自习" : " 操场跑步");
+        record.attributeChanges = "[]";
+        batch.push_back(std::move(record));
+        if (batch.size() == kBatchSize) {
+            static_cast<void>(database.insertLogRecords(batch));
+            batch.clear();
+        }
+    }
+    if (!batch.empty()) {
+        static_cast<void>(database.insertLogRecords(batch));
+    }
+}
+
+inline void seedInventory(data::DatabaseManager& database, int ownerId, int itemId, std::size_t count) {
+    const std::string purchased = QDateTime::currentDateTimeUtc().addDays(-30).toString(Qt::ISODate).toStdString();
+    std::vector<data::DatabaseManager::InventoryRecord> records;
+    records.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        data::DatabaseManager::InventoryRecord record;
+        record.itemId = itemId;
+        record.ownerId = ownerId;
+        record.quantity = 1;
+        record.status = "Unused";
+        record.purchaseTimeIso = purchased;
+        records.push_back(std::move(record));
+    }
+    static_cast<void>(database.insertInventoryRecords(records));
+}
+
+/**
+ * @brief 经 AchievementManager 创建自定义成就；目标值足够大，基准期间不会解锁，但每次完成任务都要遍历条件索引。
+ */
+inline void seedAchievements(data::AchievementManager& manager, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        data::Achievement achievement;
+        achievement.setName("bench achievement " + std::to_string(i));
+        achievement.setDescription("synthetic");
+        achievement.setRewardType(data::Achievement::RewardType::NoReward);
+        achievement.setProgressMode(data::Achievement::ProgressMode::Incremental);
+        achievement.setGalleryGroup("bench " + std::to_string(i % 10));
+        data::Achievement::Condition condition;
+        condition.type = data::Achievement::Condition::ConditionType::CompleteAnyTask;
+        condition.targetValue = 1000000;
+        achievement.setConditions({condition});
+        static_cast<void>(manager.createCustomAchievement(achievement));
+    }
+}
+
+/**
+ * @brief 上架一件不限购的堆叠道具，购买场景不受预置商品限购规则影响。
+ */
+inline int createBenchItem(data::ShopManager& shop) {
+    data::ShopItem item;
+    item.setName("bench coupon");
+    item.setDescription("synthetic");
+    item.setItemType(data::ShopItem::ItemType::Prop);
+    item.setPropEffectType(data::ShopItem::PropEffectType::ForgivenessCoupon);
+    item.setPriceCoins(10);
+    item.setPurchaseLimit(0);
+    item.setAvailable(true);
+    return shop.createItem(item);
+}
+
+/**
+ * @brief 生成均匀分布在最近一年内的成长快照，成长值与属性随时间单调上升，聚合表在同一事务内维护。
+ */
+inline void seedSnapshots(data::DatabaseManager& database, int ownerId, std::size_t count) {
+    const QDateTime start = QDateTime::currentDateTimeUtc().addDays(-365);
+    const qint64 stepSeconds = std::max<qint64>(1, 365LL * 24 * 3600 / static_cast<qint64>(count));
+    bool transactionStarted = false;
+    try {
+        transactionStarted = database.beginTransaction();
+        for (std::size_t i = 0; i < count; ++i) {
+            const int step = static_cast<int>(i);
+            data::DatabaseManager::GrowthSnapshotRecord record;
+            record.ownerId = ownerId;
+            record.timestampIso =
+                start.addSecs(static_cast<qint64>(i) * stepSeconds).toString(Qt::ISODate).toStdString();
+            record.userLevel = 1 + step / 500;
+            record.growthPoints = step * 3;
+            record.execution = step / 40;
+            record.perseverance = step / 50;
+            record.decision = step / 60;
+            record.knowledge = step / 30;
+            record.social = step / 70;
+            record.pride = step / 90;
+            record.completedTasks = step;
+            record.manualLogCount = step / 4;
+            static_cast<void>(database.insertGrowthSnapshot(record));
+        }
+        database.commitTransaction();
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                database.rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+}  // namespace rove::bench
+
+#endif  // BENCHSEED_H
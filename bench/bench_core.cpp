@@ -0,0 +1,281 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "AchievementManager.h"
+#include "BenchHarness.h"
+#include "BenchSeed.h"
+#include "DatabaseManager.h"
+#include "EconomySimulator.h"
+#include "InventoryManager.h"
+#include "LogManager.h"
+#include "Metrics.h"
+#include "RewardRules.h"
+#include "ShopManager.h"
+#include "TaskManager.h"
+#include "UserManager.h"
+
+/**
+ * @file bench_core.cpp
+ * @brief 数据层与核心管理器的微基准：生成合成数据库后逐场景测量吞吐量与 p50/p99 延迟。
+ * 中文：无界面运行（QCoreApplication），只链接 cyber_core；
+ *       用法：bench_core [--scale=<倍数>] [--db=<路径>] [--metrics=<json 路径>] [--trace-queries=<毫秒>] [--check-plans]
+ *       [--in-memory]，
+ *       scale 按比例缩放数据量与迭代次数，便于快速冒烟；--metrics 在结束时导出热路径埋点（逐条 SQL 延迟、读取行数、
+ *       事务耗时等）；--trace-queries 在造数后开启查询跟踪，结束时打印各语句耗时、全表扫描与超过阈值的慢查询计划；
+ *       --check-plans 在结束时对本次执行过的全部语句做 EXPLAIN QUERY PLAN，热点表出现全表扫描时以退出码 1 结束，
+ *       用于诊断真实数据分布下的计划（回归门禁是 ctest 中的 query_plan_check，审计登记的全部热路径语句）；
+ *       --in-memory 在内存库上运行（退出时写回 --db 文件），用于区分磁盘开销与查询本身的开销。
+ */
+
+namespace {
+
+using namespace rove::data;
+using rove::bench::BenchResult;
+using rove::bench::measure;
+using rove::bench::createBenchItem;
+using rove::bench::removeDatabaseFiles;
+using rove::bench::seedAchievements;
+using rove::bench::seedInventory;
+using rove::bench::seedLogs;
+using rove::bench::seedTasks;
+
+/**
+ * @brief 合成数据规模，默认值对应一个重度使用数年的学生账号。
+ */
+struct BenchConfig {
+    double scale = 1.0;
+    std::string databasePath;
+    std::string metricsPath;  //!< 非空时把埋点注册表写成 JSON。
+    int traceThresholdMs = -1;  //!< 非负时开启查询跟踪，结束后打印语句聚合与慢查询。
+    bool checkPlans = false;    //!< 结束时检查执行计划，热点表全表扫描视为失败。
+    bool inMemory = false;      //!< 使用 ConnectionProfile::inMemoryCheckpointed()。
+    std::size_t taskCount = 10000;
+    std::size_t logCount = 100000;
+    std::size_t achievementCount = 500;
+    std::size_t inventoryCount = 5000;
+
+    [[nodiscard]] std::size_t scaled(std::size_t value) const {
+        return std::max<std::size_t>(1, static_cast<std::size_t>(static_cast<double>(value) * scale));
+    }
+};
+
+BenchConfig parseArguments(int argc, char* argv[]) {
+    BenchConfig config;
+    config.databasePath = QDir::tempPath().toStdString() + "/bench_core.db";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--scale=", 0) == 0) {
+            config.scale = std::max(0.001, std::atof(arg.c_str() + 8));
+        } else if (arg.rfind("--db=", 0) == 0) {
+            config.databasePath = arg.substr(5);
+        } else if (arg.rfind("--metrics=", 0) == 0) {
+            config.metricsPath = arg.substr(10);
+        } else if (arg.rfind("--trace-queries=", 0) == 0) {
+            config.traceThresholdMs = std::max(0, std::atoi(arg.c_str() + 16));
+        } else if (arg == "--check-plans") {
+            config.checkPlans = true;
+        } else if (arg == "--in-memory") {
+            config.inMemory = true;
+        } else {
+            std::fprintf(stderr, "unknown argument: %s\n", arg.c_str());
+            std::exit(2);
+        }
+    }
+    config.taskCount = config.scaled(config.taskCount);
+    config.logCount = config.scaled(config.logCount);
+    config.achievementCount = config.scaled(config.achievementCount);
+    config.inventoryCount = config.scaled(config.inventoryCount);
+    return config;
+}
+
+/**
+ * @brief 允许整表扫描的表：商品目录与账号表按设计整表读取且行数很少，sqlite_master 只在启动与迁移时查询。
+ */
+constexpr const char* kScanAllowedTables[] = {"shop_items", "users", "sqlite_master"};
+
+/**
+ * @brief 执行计划回归检查：打印在其他表上出现整表扫描的语句及其计划。
+ * @return 没有违规语句时返回 true。
+ */
+bool checkQueryPlans(const DatabaseManager& database) {
+    const auto audits = database.auditQueryPlans();
+    std::size_t violations = 0;
+    for (const auto& audit : audits) {
+        const bool allowed = std::all_of(audit.scannedTables.begin(), audit.scannedTables.end(),
+                                         [](const std::string& table) {
+                                             for (const char* allowedTable : kScanAllowedTables) {
+                                                 if (table == allowedTable) {
+                                                     return true;
+                                                 }
+                                             }
+                                             return false;
+                                         });
+        if (allowed) {
+            continue;
+        }
+        ++violations;
+        std::printf("full scan: %s\n", audit.sql.c_str());
+        for (const auto& row : audit.plan) {
+            std::printf("    %s\n", row.c_str());
+        }
+    }
+    std::printf("\nquery plans: %zu statements checked, %zu with full scans\n", audits.size(), violations);
+    return violations == 0;
+}
+
+int runBenchmarks(const BenchConfig& config) {
+    removeDatabaseFiles(config.databasePath);
+    rove::metrics::setEnabled(!config.metricsPath.empty());
+    auto& database = DatabaseManager::instance();
+    database.initialize(config.databasePath, config.inMemory ? DatabaseManager::ConnectionProfile::inMemoryCheckpointed()
+                                                             : DatabaseManager::ConnectionProfile::balanced());
+
+    UserManager userManager(database);
+    if (!userManager.login("x", "1")) {
+        std::fprintf(stderr, "failed to log in the preconfigured account\n");
+        return 1;
+    }
+    userManager.updateActiveUser([](User& user) {
+        user.addCoins(100000000);  // 中文：保证购买场景不会因余额不足提前返回。
+        return true;
+    });
+    const int ownerId = userManager.activeUserId();
+
+    auto& taskManager = TaskManager::instance(database, userManager);
+    auto& achievementManager = AchievementManager::instance(database, userManager, taskManager);
+    auto& logManager = LogManager::instance(database, userManager, achievementManager, taskManager);
+    auto& inventoryManager = InventoryManager::instance();
+    inventoryManager.initialize(database);
+    auto& shopManager = ShopManager::instance();
+    shopManager.initialize(database, userManager, inventoryManager);
+
+    std::printf("seeding %zu tasks, %zu logs, %zu achievements, %zu inventory rows into %s\n", config.taskCount,
+                config.logCount, config.achievementCount, config.inventoryCount, config.databasePath.c_str());
+    const std::vector<int> taskIds = seedTasks(database, ownerId, config.taskCount);
+    seedLogs(database, ownerId, config.logCount);
+    const int itemId = createBenchItem(shopManager);
+    seedInventory(database, ownerId, itemId, config.inventoryCount);
+    achievementManager.refreshFromDatabase();
+    seedAchievements(achievementManager, config.achievementCount);
+    taskManager.refreshFromDatabase();
+    if (config.traceThresholdMs >= 0) {
+        DatabaseManager::QueryTraceOptions trace;
+        trace.enabled = true;
+        trace.slowThresholdMs = config.traceThresholdMs;
+        database.setQueryTrace(trace);
+    }
+
+    std::vector<BenchResult> results;
+    const std::size_t loadIterations = config.scaled(20);
+
+    results.push_back(measure("task.refresh", loadIterations, [&](std::size_t) { taskManager.refreshFromDatabase(); }));
+    results.push_back(measure("task.complete", std::min(taskIds.size(), config.scaled(1000)),
+                              [&](std::size_t i) { taskManager.markTaskCompleted(taskIds[i]); }));
+    // 中文：纯内存平衡模拟，每次迭代结算 10000 次不同类型、星级与连胜的模拟完成。
+    std::vector<rewards::RewardInput> simulated(10000);
+    for (std::size_t i = 0; i < simulated.size(); ++i) {
+        simulated[i].type = static_cast<Task::TaskType>(i % 4);
+        simulated[i].difficultyStars = static_cast<int>(i % 5) + 1;
+        simulated[i].bonusStreak = static_cast<int>(i % 80);
+        simulated[i].baseCoins = 10 + static_cast<int>(i % 40);
+        simulated[i].baseGrowth = 20 + static_cast<int>(i % 60);
+    }
+    results.push_back(measure("reward.score_batch", config.scaled(200),
+                              [&](std::size_t) { static_cast<void>(rewards::sumBatch(simulated)); }));
+    // 中文：蒙特卡洛经济模拟，每次迭代 1 万名玩家 × 120 天奇遇判定与 20 次开包。
+    EconomySimulator::Config economy;
+    economy.luckyRewards = {{ShopItem::LuckyBagReward::RewardType::Coins, 30, 0.6, -1, "coins"},
+                            {ShopItem::LuckyBagReward::RewardType::Growth, 50, 0.3, -1, "growth"},
+                            {ShopItem::LuckyBagReward::RewardType::ShopItem, 1, 0.1, -1, "item"}};
+    economy.bagPriceCoins = 40;
+    results.push_back(measure("economy.simulate", config.scaled(10), [&](std::size_t i) {
+        economy.seed = i;
+        static_cast<void>(EconomySimulator::run(economy));
+    }));
+    logManager.flush();  // 中文：完成任务产生的自动日志经后台队列写入，计入下一场景前先落盘。
+    achievementManager.flushPendingProgress();
+
+    results.push_back(measure("achievement.refresh", loadIterations,
+                              [&](std::size_t) { achievementManager.refreshFromDatabase(); }));
+
+    std::size_t purchased = 0;
+    results.push_back(measure("shop.purchase", config.scaled(1000), [&](std::size_t) {
+        if (shopManager.purchaseItem(itemId, 1).success) {
+            ++purchased;
+        }
+    }));
+    std::printf("shop.purchase succeeded %zu/%zu\n", purchased, results.back().iterations);
+    results.push_back(measure("inventory.list", config.scaled(50),
+                              [&](std::size_t) { static_cast<void>(inventoryManager.listByOwner(ownerId)); }));
+    logManager.flush();
+
+    const std::size_t filterIterations = config.scaled(200);
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    results.push_back(measure("log.filter.type_30d", filterIterations, [&](std::size_t) {
+        static_cast<void>(logManager.filterLogWindow(LogEntry::LogType::Auto, now.addDays(-30), std::nullopt,
+                                                     std::nullopt, std::nullopt, std::nullopt, 200));
+    }));
+    std::optional<DatabaseManager::LogCursor> cursor;
+    results.push_back(measure("log.filter.page_walk", filterIterations, [&](std::size_t) {
+        auto window = logManager.filterLogWindow(std::nullopt, std::nullopt, std::nullopt, std::nullopt, std::nullopt,
+                                                 cursor, 200);
+        cursor = window.nextCursor;  // 中文：翻到末页后从头再来，测量键集分页在任意深度的代价。
+    }));
+    results.push_back(measure("log.filter.keyword", config.scaled(100), [&](std::size_t) {
+        static_cast<void>(logManager.filterLogWindow(std::nullopt, std::nullopt, std::nullopt, std::nullopt,
+                                                     std::string("图书馆"), std::nullopt, 50));
+    }));
+
+    results.push_back(
+        measure("snapshot.capture", config.scaled(200), [&](std::size_t) { static_cast<void>(logManager.captureSnapshot()); }));
+    results.push_back(measure("snapshot.query", config.scaled(50), [&](std::size_t) {
+        static_cast<void>(logManager.querySnapshots(std::nullopt, std::nullopt));
+    }));
+    results.push_back(measure("snapshot.series_stats", config.scaled(50), [&](std::size_t) {
+        const auto series = logManager.querySnapshotSeries(std::nullopt, std::nullopt);
+        static_cast<void>(series.stats(rove::data::SnapshotColumn::Growth));
+    }));
+    results.push_back(measure("analytics.insights", config.scaled(200), [&](std::size_t) {
+        static_cast<void>(logManager.growthInsights(rove::data::GrowthAnalytics::Window::Month));
+    }));
+
+    rove::bench::printResults(results);
+    if (config.traceThresholdMs >= 0) {
+        std::printf("\n%s", database.queryTraceReport().toText().c_str());
+    }
+    if (!config.metricsPath.empty()) {
+        std::FILE* file = std::fopen(config.metricsPath.c_str(), "wb");
+        if (file == nullptr) {
+            std::fprintf(stderr, "failed to open %s\n", config.metricsPath.c_str());
+            return 1;
+        }
+        const std::string json = rove::metrics::Registry::instance().toJson();
+        std::fwrite(json.data(), 1, json.size(), file);
+        std::fclose(file);
+    }
+    if (config.checkPlans && !checkQueryPlans(database)) {
+        return 1;
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    try {
+        return runBenchmarks(parseArguments(argc, argv));
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "bench_core failed: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,449 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AchievementManager.h"
+#include "BenchHarness.h"
+#include "BenchSeed.h"
+#include "DatabaseManager.h"
+#include "InventoryManager.h"
+#include "LogManager.h"
+#include "Metrics.h"
+#include "ShopManager.h"
+#include "TaskManager.h"
+#include "UserManager.h"
+
+/**
+ * @file bench_stress.cpp
+ * @brief 多线程扩展性压测：1 到 N 个线程同时经管理器执行混合读写，报告吞吐量曲线、锁等待与 SQLITE_BUSY 比例。
+ * 中文：用法：bench_stress [--threads=<最大线程数>] [--seconds=<每档秒数>] [--watchdog=<秒>] [--db=<路径>]
+ *       [--json=<路径>]
+ *       线程数按 1、2、4… 递增到最大值，每档运行固定时长；每个线程按固定比例随机执行完成任务、购买、
+ *       手写日志与成长时间线查询。每档开始前清零埋点，结束后从 Locks 子系统读取各具名锁的争用次数与等待时间，
+ *       从 Database 子系统读取 sqlite.busy（忙等回调超时放弃、返回 SQLITE_BUSY 的次数）。
+ *       看门狗：任一线程的单次操作超过 --watchdog 秒仍未返回即视为死锁或活锁，打印各线程正在执行的操作与
+ *       锁埋点后以退出码 3 结束（卡住的线程无法回收，不做 join）。
+ */
+
+namespace {
+
+using namespace rove::data;
+using rove::bench::BenchResult;
+using rove::bench::summarize;
+
+enum class Op { Complete, Purchase, LogInsert, SnapshotQuery };
+
+constexpr std::array<const char*, 4> kOpNames = {"task.complete", "shop.purchase", "log.insert", "snapshot.query"};
+constexpr std::array<int, 4> kOpWeights = {25, 15, 30, 30};  //!< 各操作的抽取权重（百分比）
+
+struct StressConfig {
+    std::size_t maxThreads = 8;
+    double secondsPerStep = 3.0;
+    double watchdogSeconds = 10.0;
+    std::string databasePath;
+    std::string jsonPath;
+};
+
+StressConfig parseArguments(int argc, char* argv[]) {
+    StressConfig config;
+    config.maxThreads = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 2, 16);
+    config.databasePath = QDir::tempPath().toStdString() + "/bench_stress.db";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--threads=", 0) == 0) {
+            config.maxThreads = static_cast<std::size_t>(std::max(1, std::atoi(arg.c_str() + 10)));
+        } else if (arg.rfind("--seconds=", 0) == 0) {
+            config.secondsPerStep = std::max(0.1, std::atof(arg.c_str() + 10));
+        } else if (arg.rfind("--watchdog=", 0) == 0) {
+            config.watchdogSeconds = std::max(0.5, std::atof(arg.c_str() + 11));
+        } else if (arg.rfind("--db=", 0) == 0) {
+            config.databasePath = arg.substr(5);
+        } else if (arg.rfind("--json=", 0) == 0) {
+            config.jsonPath = arg.substr(7);
+        } else {
+            std::fprintf(stderr, "unknown argument: %s\n", arg.c_str());
+            std::exit(2);
+        }
+    }
+    return config;
+}
+
+/**
+ * @brief 1、2、4… 直到 maxThreads，最大值不是 2 的幂时补在末尾。
+ */
+std::vector<std::size_t> threadSteps(std::size_t maxThreads) {
+    std::vector<std::size_t> steps;
+    for (std::size_t threads = 1; threads < maxThreads; threads *= 2) {
+        steps.push_back(threads);
+    }
+    steps.push_back(maxThreads);
+    return steps;
+}
+
+std::int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @brief 一个压测线程的状态：看门狗读取 opStartedNs/currentOp，样本与错误数只在 join 之后读取。
+ */
+struct Worker {
+    std::atomic<std::int64_t> opStartedNs{0};  //!< 当前操作开始时刻，0 表示空闲
+    std::atomic<int> currentOp{-1};
+    std::array<std::vector<double>, kOpNames.size()> samples;  //!< 各操作的逐次耗时（微秒）
+    std::array<std::size_t, kOpNames.size()> errors{};
+    std::thread thread;
+};
+
+/**
+ * @brief 压测期间共享的管理器与数据；完成任务的目标取自日常任务池，用完后由取到末尾的线程重置日常任务。
+ */
+struct Workload {
+    TaskManager& taskManager;
+    LogManager& logManager;
+    ShopManager& shopManager;
+    std::vector<int> dailyTaskIds;
+    int itemId = 0;
+    std::atomic<std::size_t> nextTask{0};
+
+    void run(Op op, std::mt19937& rng) {
+        switch (op) {
+        case Op::Complete: {
+            const std::size_t index = nextTask.fetch_add(1);
+            if (index > 0 && index % dailyTaskIds.size() == 0) {
+                taskManager.resetDailyTasks();
+            }
+            taskManager.markTaskCompleted(dailyTaskIds[index % dailyTaskIds.size()]);
+            break;
+        }
+        case Op::Purchase:
+            static_cast<void>(shopManager.purchaseItem(itemId, 1));
+            break;
+        case Op::LogInsert:
+            static_cast<void>(logManager.recordManualLog("stress log " + std::to_string(rng()),
+                                                         LogEntry::MoodTag::Neutral));
+            break;
+        case Op::SnapshotQuery: {
+            const QDateTime monthAgo = QDateTime::currentDateTimeUtc().addDays(-30);
+            static_cast<void>(logManager.querySnapshotSeries(monthAgo, std::nullopt));
+            break;
+        }
+        }
+    }
+};
+
+Op pickOp(std::mt19937& rng) {
+    int roll = static_cast<int>(rng() % 100);
+    for (std::size_t i = 0; i < kOpWeights.size(); ++i) {
+        if (roll < kOpWeights[i]) {
+            return static_cast<Op>(i);
+        }
+        roll -= kOpWeights[i];
+    }
+    return Op::SnapshotQuery;
+}
+
+void runWorker(Workload& workload, Worker& worker, std::uint32_t seed, const std::atomic<bool>& stop) {
+    std::mt19937 rng(seed);
+    while (!stop.load(std::memory_order_relaxed)) {
+        const Op op = pickOp(rng);
+        const auto index = static_cast<std::size_t>(op);
+        const std::int64_t started = steadyNowNs();
+        worker.currentOp.store(static_cast<int>(op), std::memory_order_relaxed);
+        worker.opStartedNs.store(started, std::memory_order_release);
+        try {
+            workload.run(op, rng);
+        } catch (const std::exception&) {
+            ++worker.errors[index];
+        }
+        worker.opStartedNs.store(0, std::memory_order_release);
+        worker.samples[index].push_back(static_cast<double>(steadyNowNs() - started) / 1000.0);
+    }
+}
+
+/**
+ * @brief 打印各线程卡住的操作与锁埋点后立即结束进程；卡住的线程仍持有锁，无法正常析构。
+ */
+[[noreturn]] void reportStall(const std::vector<std::unique_ptr<Worker>>& workers, std::int64_t limitNs) {
+    const std::int64_t now = steadyNowNs();
+    std::fprintf(stderr, "\nwatchdog: an operation exceeded %.1f s, suspected deadlock\n",
+                 static_cast<double>(limitNs) / 1e9);
+    for (std::size_t i = 0; i < workers.size(); ++i) {
+        const std::int64_t started = workers[i]->opStartedNs.load(std::memory_order_acquire);
+        const int op = workers[i]->currentOp.load(std::memory_order_relaxed);
+        if (started == 0 || op < 0) {
+            std::fprintf(stderr, "  thread %zu: idle\n", i);
+        } else {
+            std::fprintf(stderr, "  thread %zu: %s for %.1f s\n", i, kOpNames[static_cast<std::size_t>(op)],
+                         static_cast<double>(now - started) / 1e9);
+        }
+    }
+    const std::string metrics = rove::metrics::Registry::instance().toJson();
+    std::fwrite(metrics.data(), 1, metrics.size(), stderr);
+    std::fflush(stderr);
+    std::_Exit(3);
+}
+
+/**
+ * @brief 一把具名锁在一档压测中的争用情况，数值来自 Locks 子系统。
+ */
+struct LockStats {
+    std::uint64_t acquired = 0;
+    std::uint64_t contended = 0;
+    rove::metrics::Histogram::Snapshot wait;
+    rove::metrics::Histogram::Snapshot hold;
+};
+
+struct StepResult {
+    std::size_t threads = 0;
+    double seconds = 0.0;
+    std::size_t operations = 0;
+    std::size_t errors = 0;
+    std::uint64_t sqliteBusy = 0;
+    std::vector<BenchResult> ops;
+    std::array<std::size_t, kOpNames.size()> opErrors{};
+    std::map<std::string, LockStats> locks;
+
+    [[nodiscard]] double opsPerSecond() const {
+        return seconds > 0.0 ? static_cast<double>(operations) / seconds : 0.0;
+    }
+};
+
+void collectMetrics(StepResult& step) {
+    for (const auto& entry : rove::metrics::Registry::instance().snapshot()) {
+        if (entry.subsystem == rove::metrics::Subsystem::Database && entry.name == "sqlite.busy") {
+            step.sqliteBusy += entry.value;
+        }
+        if (entry.subsystem != rove::metrics::Subsystem::Locks) {
+            continue;
+        }
+        LockStats& lock = step.locks[entry.label];
+        if (entry.name == "acquire") {
+            lock.acquired = entry.value;
+        } else if (entry.name == "contended") {
+            lock.contended = entry.value;
+        } else if (entry.name == "wait") {
+            lock.wait = entry.timing;
+        } else if (entry.name == "hold") {
+            lock.hold = entry.timing;
+        }
+    }
+}
+
+/**
+ * @brief 以 threads 个线程运行一档；主线程负责看门狗并处理排队到 GUI 线程的信号。
+ */
+StepResult runStep(Workload& workload, const StressConfig& config, std::size_t threads) {
+    rove::metrics::Registry::instance().reset();
+    std::atomic<bool> stop{false};
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < threads; ++i) {
+        Worker& worker = *workers[i];
+        worker.thread = std::thread(runWorker, std::ref(workload), std::ref(worker),
+                                    static_cast<std::uint32_t>(threads * 1000 + i), std::cref(stop));
+    }
+
+    const auto limitNs = static_cast<std::int64_t>(config.watchdogSeconds * 1e9);
+    const auto deadline = begin + std::chrono::duration<double>(config.secondsPerStep);
+    auto anyBusy = [&workers]() {
+        return std::any_of(workers.begin(), workers.end(),
+                           [](const auto& worker) { return worker->opStartedNs.load(std::memory_order_acquire) != 0; });
+    };
+    // 中文：停止信号发出后继续看门狗，直到所有线程结束当前操作，收尾阶段的死锁同样能被发现。
+    while (std::chrono::steady_clock::now() < deadline || anyBusy()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            stop.store(true, std::memory_order_relaxed);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        QCoreApplication::processEvents();
+        const std::int64_t now = steadyNowNs();
+        for (const auto& worker : workers) {
+            const std::int64_t started = worker->opStartedNs.load(std::memory_order_acquire);
+            if (started != 0 && now - started > limitNs) {
+                reportStall(workers, limitNs);
+            }
+        }
+    }
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+
+    StepResult step;
+    step.threads = threads;
+    step.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    for (std::size_t op = 0; op < kOpNames.size(); ++op) {
+        std::vector<double> samples;
+        for (const auto& worker : workers) {
+            samples.insert(samples.end(), worker->samples[op].begin(), worker->samples[op].end());
+            step.opErrors[op] += worker->errors[op];
+        }
+        step.operations += samples.size();
+        step.errors += step.opErrors[op];
+        step.ops.push_back(summarize(kOpNames[op], std::move(samples)));
+    }
+    collectMetrics(step);
+    return step;
+}
+
+void printStep(const StepResult& step, double baseline) {
+    const double speedup = baseline > 0.0 ? step.opsPerSecond() / baseline : 0.0;
+    std::printf("\nthreads=%zu  ops/sec=%.1f  speedup=%.2f  efficiency=%.0f%%  errors=%zu  sqlite.busy=%llu\n",
+                step.threads, step.opsPerSecond(), speedup, 100.0 * speedup / static_cast<double>(step.threads),
+                step.errors, static_cast<unsigned long long>(step.sqliteBusy));
+    rove::bench::printResults(step.ops);
+    if (!rove::metrics::Registry::kCompiledIn) {
+        std::printf("lock metrics not compiled in (CYBER_LANDA_ENABLE_METRICS=OFF)\n");
+        return;
+    }
+    std::printf("%-28s %10s %10s %14s %12s %12s\n", "lock", "acquired", "contended", "wait.total(ms)", "wait.p99(us)",
+                "hold.p99(us)");
+    for (const auto& [name, lock] : step.locks) {
+        std::printf("%-28s %10llu %10llu %14.1f %12.1f %12.1f\n", name.c_str(),
+                    static_cast<unsigned long long>(lock.acquired), static_cast<unsigned long long>(lock.contended),
+                    static_cast<double>(lock.wait.totalNs) / 1e6, static_cast<double>(lock.wait.p99Ns) / 1e3,
+                    static_cast<double>(lock.hold.p99Ns) / 1e3);
+    }
+}
+
+QJsonObject toJson(const StepResult& step, double baseline) {
+    QJsonObject obj;
+    obj.insert("threads", static_cast<double>(step.threads));
+    obj.insert("seconds", step.seconds);
+    obj.insert("operations", static_cast<double>(step.operations));
+    obj.insert("opsPerSec", step.opsPerSecond());
+    obj.insert("speedup", baseline > 0.0 ? step.opsPerSecond() / baseline : 0.0);
+    obj.insert("errors", static_cast<double>(step.errors));
+    obj.insert("sqliteBusy", static_cast<double>(step.sqliteBusy));
+    obj.insert("busyRate", step.operations > 0 ? static_cast<double>(step.sqliteBusy) / step.operations : 0.0);
+    QJsonArray ops;
+    for (std::size_t i = 0; i < step.ops.size(); ++i) {
+        QJsonObject op;
+        op.insert("name", QString::fromStdString(step.ops[i].name));
+        op.insert("iterations", static_cast<double>(step.ops[i].iterations));
+        op.insert("errors", static_cast<double>(step.opErrors[i]));
+        op.insert("p50Us", step.ops[i].p50Micros);
+        op.insert("p99Us", step.ops[i].p99Micros);
+        ops.append(op);
+    }
+    obj.insert("ops", ops);
+    QJsonArray locks;
+    for (const auto& [name, lock] : step.locks) {
+        QJsonObject entry;
+        entry.insert("name", QString::fromStdString(name));
+        entry.insert("acquired", static_cast<double>(lock.acquired));
+        entry.insert("contended", static_cast<double>(lock.contended));
+        entry.insert("waitTotalUs", static_cast<double>(lock.wait.totalNs) / 1e3);
+        entry.insert("waitP99Us", static_cast<double>(lock.wait.p99Ns) / 1e3);
+        entry.insert("holdP99Us", static_cast<double>(lock.hold.p99Ns) / 1e3);
+        locks.append(entry);
+    }
+    obj.insert("locks", locks);
+    return obj;
+}
+
+int runStress(const StressConfig& config) {
+    rove::bench::removeDatabaseFiles(config.databasePath);
+    rove::metrics::setEnabled(true);  // 中文：锁争用与 sqlite.busy 统计来自埋点；未编译埋点时为空操作。
+    auto& database = DatabaseManager::instance();
+    database.initialize(config.databasePath, DatabaseManager::ConnectionProfile::balanced());
+
+    UserManager userManager(database);
+    if (!userManager.login("x", "1")) {
+        std::fprintf(stderr, "failed to log in the preconfigured account\n");
+        return 1;
+    }
+    userManager.updateActiveUser([](User& user) {
+        user.addCoins(1000000000);  // 中文：保证购买在整个压测期间不会因余额不足提前返回。
+        return true;
+    });
+    const int ownerId = userManager.activeUserId();
+
+    auto& taskManager = TaskManager::instance(database, userManager);
+    auto& achievementManager = AchievementManager::instance(database, userManager, taskManager);
+    auto& logManager = LogManager::instance(database, userManager, achievementManager, taskManager);
+    auto& inventoryManager = InventoryManager::instance();
+    inventoryManager.initialize(database);
+    auto& shopManager = ShopManager::instance();
+    shopManager.initialize(database, userManager, inventoryManager);
+
+    // 中文：seedTasks 按日常、每周、学期、自定义轮换类型，下标为 4 的倍数的是日常任务。
+    const std::vector<int> taskIds = rove::bench::seedTasks(database, ownerId, 8000);
+    Workload workload{taskManager, logManager, shopManager, {}, 0, {}};
+    for (std::size_t i = 0; i < taskIds.size(); i += 4) {
+        workload.dailyTaskIds.push_back(taskIds[i]);
+    }
+    rove::bench::seedLogs(database, ownerId, 20000);
+    rove::bench::seedSnapshots(database, ownerId, 5000);
+    workload.itemId = rove::bench::createBenchItem(shopManager);
+    taskManager.refreshFromDatabase();
+    achievementManager.refreshFromDatabase();
+    std::printf("stress: up to %zu threads, %.1f s per step, watchdog %.1f s, database %s\n", config.maxThreads,
+                config.secondsPerStep, config.watchdogSeconds, config.databasePath.c_str());
+
+    QJsonArray steps;
+    double baseline = 0.0;
+    for (std::size_t threads : threadSteps(config.maxThreads)) {
+        const StepResult step = runStep(workload, config, threads);
+        logManager.flush();
+        achievementManager.flushPendingProgress();
+        if (threads == 1) {
+            baseline = step.opsPerSecond();
+        }
+        printStep(step, baseline);
+        steps.append(toJson(step, baseline));
+    }
+
+    if (config.jsonPath.empty()) {
+        return 0;
+    }
+    QJsonObject root;
+    root.insert("benchmark", "bench_stress");
+    root.insert("secondsPerStep", config.secondsPerStep);
+    root.insert("metricsCompiledIn", rove::metrics::Registry::kCompiledIn);
+    root.insert("steps", steps);
+    QFile file(QString::fromStdString(config.jsonPath));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        std::fprintf(stderr, "failed to open %s\n", config.jsonPath.c_str());
+        return 1;
+    }
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    return file.write(json) == json.size() ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    try {
+        return runStress(parseArguments(argc, argv));
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "bench_stress failed: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,354 @@
+#include <QApplication>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPushButton>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AchievementGallery.h"
+#include "BenchHarness.h"
+#include "BenchSeed.h"
+#include "GrowthDashboard.h"
+#include "LogBrowser.h"
+#include "MainWindow.h"
+
+/**
+ * @file bench_ui.cpp
+ * @brief 界面帧耗时基准：在逐级扩大的合成数据库上构造 MainWindow，测量各页面刷新与重绘的耗时。
+ * 中文：默认使用 offscreen 平台无界面运行，链接 cyber_ui 与 cyber_core；
+ *       用法：bench_ui [--scales=0.01,0.1,1] [--frames=<每场景帧数>] [--db=<路径>] [--json=<路径>]
+ *       每个规模重新装载管理器缓存并新建一个主窗口，依次测量 refreshDashboard、首次切换页面、切换页面、
+ *       LogBrowser::reload、AchievementGallery::reload 与 GrowthDashboard::render；每帧先计时操作本身
+ *       （含随后的事件处理），再计时一次整窗同步重绘，后者记为同名场景的 .paint。
+ *       规模按升序处理，数据只追加不重建；--json 输出各规模的数据量与全部场景，便于跨版本比较延迟随数据量的增长。
+ */
+
+namespace {
+
+using namespace rove::data;
+using rove::bench::BenchResult;
+using rove::bench::measure;
+using rove::bench::summarize;
+
+/**
+ * @brief 某一规模下库中的合成数据量；规模 1 与 bench_core 的默认数据量一致，另加一年的成长快照。
+ */
+struct DataSize {
+    std::size_t tasks = 0;
+    std::size_t logs = 0;
+    std::size_t achievements = 0;
+    std::size_t inventory = 0;
+    std::size_t snapshots = 0;
+};
+
+struct UiBenchConfig {
+    std::vector<double> scales{0.01, 0.1, 1.0};
+    std::size_t frames = 20;
+    std::string databasePath;
+    std::string jsonPath;  //!< 非空时把各规模的结果写成 JSON。
+
+    [[nodiscard]] static DataSize sizeAt(double scale) {
+        auto scaled = [scale](std::size_t value) {
+            return std::max<std::size_t>(1, static_cast<std::size_t>(static_cast<double>(value) * scale));
+        };
+        return DataSize{scaled(10000), scaled(100000), scaled(500), scaled(5000), scaled(20000)};
+    }
+};
+
+std::vector<double> parseScales(const std::string& list) {
+    std::vector<double> scales;
+    std::size_t begin = 0;
+    while (begin <= list.size()) {
+        const std::size_t comma = std::min(list.find(',', begin), list.size());
+        const double scale = std::atof(list.substr(begin, comma - begin).c_str());
+        if (scale > 0.0) {
+            scales.push_back(scale);
+        }
+        begin = comma + 1;
+    }
+    std::sort(scales.begin(), scales.end());
+    scales.erase(std::unique(scales.begin(), scales.end()), scales.end());
+    return scales;
+}
+
+UiBenchConfig parseArguments(int argc, char* argv[]) {
+    UiBenchConfig config;
+    config.databasePath = QDir::tempPath().toStdString() + "/bench_ui.db";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--scales=", 0) == 0) {
+            config.scales = parseScales(arg.substr(9));
+        } else if (arg.rfind("--frames=", 0) == 0) {
+            config.frames = static_cast<std::size_t>(std::max(1, std::atoi(arg.c_str() + 9)));
+        } else if (arg.rfind("--db=", 0) == 0) {
+            config.databasePath = arg.substr(5);
+        } else if (arg.rfind("--json=", 0) == 0) {
+            config.jsonPath = arg.substr(7);
+        } else {
+            std::fprintf(stderr, "unknown argument: %s\n", arg.c_str());
+            std::exit(2);
+        }
+    }
+    if (config.scales.empty()) {
+        std::fprintf(stderr, "--scales needs at least one positive value\n");
+        std::exit(2);
+    }
+    return config;
+}
+
+/**
+ * @brief 运行期间常驻的管理器与服务，组装方式与 main.cpp 相同；各规模共用，主窗口按规模新建。
+ */
+struct Services {
+    DatabaseManager& database;
+    UserManager& userManager;
+    TaskManager& taskManager;
+    AchievementManager& achievementManager;
+    LogManager& logManager;
+    ShopManager& shopManager;
+    InventoryManager& inventoryManager;
+    SerendipityEngine& serendipityEngine;
+    rove::GrowthVisualizer& growthVisualizer;
+    CommandExecutor& commandExecutor;
+    ActivityFeed& activityFeed;
+};
+
+/**
+ * @brief 把库从 current 追加到 target 规模，只写差额。
+ */
+void growTo(Services& services, int ownerId, int itemId, DataSize& current, const DataSize& target) {
+    auto missing = [](std::size_t have, std::size_t want) { return want > have ? want - have : 0; };
+    if (const std::size_t count = missing(current.tasks, target.tasks)) {
+        static_cast<void>(rove::bench::seedTasks(services.database, ownerId, count));
+    }
+    if (const std::size_t count = missing(current.logs, target.logs)) {
+        rove::bench::seedLogs(services.database, ownerId, count);
+    }
+    if (const std::size_t count = missing(current.inventory, target.inventory)) {
+        rove::bench::seedInventory(services.database, ownerId, itemId, count);
+    }
+    if (const std::size_t count = missing(current.snapshots, target.snapshots)) {
+        rove::bench::seedSnapshots(services.database, ownerId, count);
+    }
+    if (const std::size_t count = missing(current.achievements, target.achievements)) {
+        rove::bench::seedAchievements(services.achievementManager, count);
+    }
+    current = target;
+}
+
+/**
+ * @brief 逐帧执行 op：先计时操作与随后的事件处理，再计时整窗同步重绘，分别汇总为 name 与 name.paint。
+ */
+void recordFrames(QWidget& window,
+                  std::vector<BenchResult>& results,
+                  const std::string& name,
+                  std::size_t frames,
+                  const std::function<void(std::size_t)>& op) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> update;
+    std::vector<double> paint;
+    update.reserve(frames);
+    paint.reserve(frames);
+    for (std::size_t i = 0; i < frames; ++i) {
+        const auto begin = Clock::now();
+        op(i);
+        QCoreApplication::processEvents();
+        const auto updated = Clock::now();
+        window.repaint();
+        const auto painted = Clock::now();
+        update.push_back(std::chrono::duration<double, std::micro>(updated - begin).count());
+        paint.push_back(std::chrono::duration<double, std::micro>(painted - updated).count());
+    }
+    results.push_back(summarize(name, std::move(update)));
+    results.push_back(summarize(name + ".paint", std::move(paint)));
+}
+
+/**
+ * @brief 等待启动装载结束；主窗口在此之后构造，页面直接以装载好的缓存创建，不经过骨架占位。
+ */
+void waitForHydration(StartupHydrator& hydrator) {
+    if (hydrator.isFinished()) {
+        return;
+    }
+    QEventLoop loop;
+    QObject::connect(&hydrator, &StartupHydrator::finished, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+QJsonObject toJson(const BenchResult& result) {
+    QJsonObject obj;
+    obj.insert("name", QString::fromStdString(result.name));
+    obj.insert("iterations", static_cast<double>(result.iterations));
+    obj.insert("opsPerSec", result.opsPerSecond);
+    obj.insert("p50Us", result.p50Micros);
+    obj.insert("p99Us", result.p99Micros);
+    return obj;
+}
+
+/**
+ * @brief 在当前数据量上新建主窗口并测量全部场景，返回该规模的 JSON 记录。
+ */
+QJsonObject runScale(Services& services, const UiBenchConfig& config, double scale, const DataSize& size) {
+    std::printf("\nscale %g: %zu tasks, %zu logs, %zu achievements, %zu inventory rows, %zu snapshots\n", scale,
+                size.tasks, size.logs, size.achievements, size.inventory, size.snapshots);
+    StartupHydrator hydrator(services.taskManager, services.achievementManager, services.shopManager);
+    hydrator.start();
+    waitForHydration(hydrator);
+
+    std::vector<BenchResult> results;
+    std::unique_ptr<MainWindow> window;
+    results.push_back(measure("window.open", 1, [&](std::size_t) {
+        window = std::make_unique<MainWindow>(services.userManager, services.taskManager, services.achievementManager,
+                                              services.logManager, services.shopManager, services.inventoryManager,
+                                              services.serendipityEngine, services.growthVisualizer, hydrator,
+                                              services.commandExecutor, services.activityFeed);
+        window->resize(1200, 800);
+        window->show();
+        QCoreApplication::processEvents();
+        window->repaint();
+    }));
+
+    // 中文：按钮顺序与 MainWindow 的堆叠页顺序一致；首次点击创建页面，之后的点击只切换或刷新过期页面。
+    static constexpr std::array<const char*, 7> kNavButtons = {"dashboardBtn", "taskBtn", "achievementBtn", "growthBtn",
+                                                               "shopBtn",      "logBtn",  "customBtn"};
+    std::array<QPushButton*, kNavButtons.size()> buttons{};
+    for (std::size_t i = 0; i < kNavButtons.size(); ++i) {
+        buttons[i] = window->findChild<QPushButton*>(QString::fromLatin1(kNavButtons[i]));
+        if (buttons[i] == nullptr) {
+            throw std::runtime_error(std::string("navigation button not found: ") + kNavButtons[i]);
+        }
+    }
+
+    recordFrames(*window, results, "dashboard.refresh", config.frames, [&](std::size_t) {
+        QMetaObject::invokeMethod(window.get(), "refreshDashboard", Qt::DirectConnection);
+    });
+    recordFrames(*window, results, "tab.first_visit", kNavButtons.size() - 1,
+                 [&](std::size_t i) { buttons[i + 1]->click(); });
+    recordFrames(*window, results, "tab.switch", config.frames,
+                 [&](std::size_t i) { buttons[i % buttons.size()]->click(); });
+
+    buttons[5]->click();
+    auto* logBrowser = window->findChild<LogBrowser*>();
+    recordFrames(*window, results, "log.reload", config.frames, [&](std::size_t) { logBrowser->reload(); });
+
+    buttons[2]->click();
+    auto* gallery = window->findChild<AchievementGallery*>();
+    recordFrames(*window, results, "achievement.reload", config.frames, [&](std::size_t) { gallery->reload(); });
+
+    buttons[3]->click();
+    auto* growth = window->findChild<GrowthDashboard*>();
+    const SnapshotSeries series = services.logManager.querySnapshotSeries(std::nullopt, std::nullopt);
+    recordFrames(*window, results, "growth.render", config.frames,
+                 [&](std::size_t) { growth->render(services.userManager.activeUser(), series); });
+
+    window.reset();
+    QCoreApplication::processEvents();
+    rove::bench::printResults(results);
+
+    QJsonObject run;
+    run.insert("scale", scale);
+    run.insert("tasks", static_cast<double>(size.tasks));
+    run.insert("logs", static_cast<double>(size.logs));
+    run.insert("achievements", static_cast<double>(size.achievements));
+    run.insert("inventory", static_cast<double>(size.inventory));
+    run.insert("snapshots", static_cast<double>(size.snapshots));
+    run.insert("timelinePoints", static_cast<double>(series.size()));
+    QJsonArray scenarios;
+    for (const auto& result : results) {
+        scenarios.append(toJson(result));
+    }
+    run.insert("results", scenarios);
+    return run;
+}
+
+bool writeJson(const std::string& path, const QJsonObject& root) {
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        std::fprintf(stderr, "failed to open %s\n", path.c_str());
+        return false;
+    }
+    return file.write(json) == json.size();
+}
+
+int runBenchmarks(const UiBenchConfig& config) {
+    rove::bench::removeDatabaseFiles(config.databasePath);
+    auto& database = DatabaseManager::instance();
+    database.initialize(config.databasePath, DatabaseManager::ConnectionProfile::balanced());
+
+    UserManager userManager(database);
+    if (!userManager.login("x", "1")) {
+        std::fprintf(stderr, "failed to log in the preconfigured account\n");
+        return 1;
+    }
+    const int ownerId = userManager.activeUserId();
+    auto& taskManager = TaskManager::instance(database, userManager);
+    auto& achievementManager = AchievementManager::instance(database, userManager, taskManager);
+    auto& logManager = LogManager::instance(database, userManager, achievementManager, taskManager);
+    auto& inventoryManager = InventoryManager::instance();
+    inventoryManager.initialize(database);
+    auto& shopManager = ShopManager::instance();
+    shopManager.initialize(database, userManager, inventoryManager);
+    auto& serendipityEngine = SerendipityEngine::instance(database, logManager, userManager);
+    auto& growthVisualizer = rove::GrowthVisualizer::instance();
+    ActivityFeed activityFeed(database, userManager, taskManager, achievementManager, logManager, shopManager,
+                              inventoryManager);
+    CommandExecutor commandExecutor;
+    commandExecutor.start();
+    Services services{database,         userManager,      taskManager,       achievementManager,
+                      logManager,       shopManager,      inventoryManager,  serendipityEngine,
+                      growthVisualizer, commandExecutor,  activityFeed};
+
+    const int itemId = rove::bench::createBenchItem(shopManager);
+    achievementManager.refreshFromDatabase();
+    DataSize seeded;
+    QJsonArray runs;
+    for (double scale : config.scales) {
+        const DataSize target = UiBenchConfig::sizeAt(scale);
+        growTo(services, ownerId, itemId, seeded, target);
+        runs.append(runScale(services, config, scale, seeded));
+    }
+    commandExecutor.stop();
+    logManager.flush();
+
+    if (config.jsonPath.empty()) {
+        return 0;
+    }
+    QJsonObject root;
+    root.insert("benchmark", "bench_ui");
+    root.insert("platform", QGuiApplication::platformName());
+    root.insert("frames", static_cast<double>(config.frames));
+    root.insert("runs", runs);
+    return writeJson(config.jsonPath, root) ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    // 中文：未指定平台时使用 offscreen，在无显示环境（CI）中也能创建窗口与绘制。
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    try {
+        return runBenchmarks(parseArguments(argc, argv));
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "bench_ui failed: %s\n", e.what());
+        return 1;
+    }
+}
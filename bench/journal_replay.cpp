@@ -0,0 +1,349 @@
+#include <QCoreApplication>
+#include <QDateTime>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AchievementManager.h"
+#include "BackupService.h"
+#include "DatabaseManager.h"
+#include "EventJournal.h"
+#include "InventoryManager.h"
+#include "LogManager.h"
+#include "Metrics.h"
+#include "ShopManager.h"
+#include "TaskManager.h"
+#include "UserManager.h"
+
+/**
+ * @file journal_replay.cpp
+ * @brief 事件日志回放工具：把用户会话的命令日志重新作用在起点快照的副本上，并开启全部埋点与 SQL 追踪。
+ * 中文：
+ *   journal_replay --db=<起点快照> --journal=<日志文件> [--work=<副本路径>] [--timing=fast|original] [--speed=1]
+ *                  [--user=x] [--password=1] [--trace-ms=20] [--json=<埋点 JSON>]
+ *       起点快照通常是应用开启 CYBER_LANDA_EVENT_JOURNAL 时写出的 <日志文件>.base.db；快照本身不被修改，
+ *       回放作用在 --work 指定的副本上（默认 <快照>.replay.db）。timing=fast 不等待，连续执行全部命令；
+ *       timing=original 按记录的时间间隔除以 speed 等待，期间处理 Qt 事件，定时器与后台队列照常运行。
+ *       手写日志的时间戳取记录时刻，幸运包按记录的种子重播抽奖引擎，因此同一日志两次回放的结果相同。
+ *       每条命令的耗时按命令类型记入埋点直方图，结束时输出各命令的分位数与最慢的 SQL 语句。
+ *       日志只包含管理器命令：每日重置、奇遇判定等由定时器触发的写入不在其中，回放时按回放时刻自然发生。
+ */
+
+namespace {
+
+using namespace rove::data;
+
+constexpr std::array<JournalCommand, 7> kCommands = {
+    JournalCommand::CompleteTask, JournalCommand::FailTask,  JournalCommand::TaskProgress, JournalCommand::Purchase,
+    JournalCommand::UseItem,      JournalCommand::ManualLog, JournalCommand::ForgiveLog};
+
+struct Options {
+    std::string databasePath;
+    std::string journalPath;
+    std::string workPath;
+    std::string jsonPath;
+    std::string username = "x";
+    std::string password = "1";
+    bool originalTiming = false;
+    double speed = 1.0;
+    int traceThresholdMs = 20;
+};
+
+struct Journal {
+    JournalHeader header;
+    std::vector<JournalEvent> events;
+    std::uint64_t missing = 0;  //!< 序号空缺数，即记录时因缓冲写满而丢弃的命令
+    bool truncated = false;
+};
+
+Journal readJournal(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot open journal " + path);
+    }
+    EventJournalReader reader(in);
+    Journal journal;
+    journal.header = reader.header();
+    JournalEvent event;
+    std::uint64_t highest = 0;
+    while (reader.next(event)) {
+        highest = std::max(highest, event.sequence + 1);
+        journal.events.push_back(event);
+    }
+    journal.truncated = reader.truncated();
+    journal.missing = highest - std::min<std::uint64_t>(highest, journal.events.size());
+    // 中文：多个线程同时记录时文件中的顺序即入队顺序，序号可能局部乱序；按序号排回命令发起的先后。
+    std::stable_sort(journal.events.begin(), journal.events.end(),
+                     [](const JournalEvent& a, const JournalEvent& b) { return a.sequence < b.sequence; });
+    return journal;
+}
+
+/**
+ * @brief 回放期间持有的管理器集合，与 workload_tool 的装配方式相同。
+ */
+class Replayer {
+public:
+    Replayer(const std::string& databasePath, const Options& options)
+        : m_database(openDatabase(databasePath, options.traceThresholdMs)), m_userManager(m_database) {
+        if (!m_userManager.login(options.username, options.password)) {
+            throw std::runtime_error("failed to log in as " + options.username);
+        }
+        m_tasks = &TaskManager::instance(m_database, m_userManager);
+        m_achievements = &AchievementManager::instance(m_database, m_userManager, *m_tasks);
+        m_logs = &LogManager::instance(m_database, m_userManager, *m_achievements, *m_tasks);
+        m_inventory = &InventoryManager::instance();
+        m_inventory->initialize(m_database);
+        m_shop = &ShopManager::instance();
+        m_shop->initialize(m_database, m_userManager, *m_inventory);
+        m_tasks->refreshFromDatabase();
+        m_achievements->refreshFromDatabase();
+        for (const JournalCommand command : kCommands) {
+            m_histograms[index(command)] = &rove::metrics::Registry::instance().histogram(
+                rove::metrics::Subsystem::Database, "replay.command", journalCommandName(command));
+        }
+    }
+
+    [[nodiscard]] int userId() const { return m_userManager.activeUserId(); }
+
+    /**
+     * @brief 执行一条命令并计时；业务层拒绝或抛出异常记为失败，不中断回放。
+     */
+    void apply(const JournalEvent& event) {
+        const std::size_t slot = index(event.command);
+        bool ok = false;
+        {
+            const rove::metrics::ScopedTimer timer(*m_histograms[slot]);
+            try {
+                ok = dispatch(event);
+            } catch (const std::exception& e) {
+                std::fprintf(stderr, "replay: #%llu %s failed: %s\n", static_cast<unsigned long long>(event.sequence),
+                             journalCommandName(event.command), e.what());
+            }
+        }
+        ++(ok ? m_applied : m_failed)[slot];
+    }
+
+    /**
+     * @brief 把后台日志队列与成就进度写回，计入回放总耗时。
+     */
+    void finish() {
+        m_logs->flush();
+        m_achievements->flushPendingProgress();
+        m_logs->setClock({});
+    }
+
+    void printReport() const {
+        std::printf("%-14s %8s %8s %10s %10s %10s %10s\n", "command", "applied", "failed", "p50 (us)", "p99 (us)",
+                    "max (us)", "total (ms)");
+        for (const JournalCommand command : kCommands) {
+            const std::size_t slot = index(command);
+            const auto timing = m_histograms[slot]->snapshot();
+            std::printf("%-14s %8zu %8zu %10.1f %10.1f %10.1f %10.2f\n", journalCommandName(command), m_applied[slot],
+                        m_failed[slot], static_cast<double>(timing.p50Ns) / 1e3, static_cast<double>(timing.p99Ns) / 1e3,
+                        static_cast<double>(timing.maxNs) / 1e3, static_cast<double>(timing.totalNs) / 1e6);
+        }
+        std::printf("\n%s\n", m_database.queryTraceReport().toText().c_str());
+    }
+
+private:
+    static DatabaseManager& openDatabase(const std::string& path, int traceThresholdMs) {
+        auto& database = DatabaseManager::instance();
+        database.initialize(path);
+        DatabaseManager::QueryTraceOptions trace;
+        trace.enabled = true;
+        trace.slowThresholdMs = std::max(0, traceThresholdMs);
+        database.setQueryTrace(trace);
+        return database;
+    }
+
+    static std::size_t index(JournalCommand command) {
+        return static_cast<std::size_t>(command) - static_cast<std::size_t>(JournalCommand::CompleteTask);
+    }
+
+    bool dispatch(const JournalEvent& event) {
+        const int target = static_cast<int>(event.target);
+        m_logs->setClock([timestampMs = event.timestampMs]() { return QDateTime::fromMSecsSinceEpoch(timestampMs); });
+        switch (event.command) {
+        case JournalCommand::CompleteTask:
+            m_tasks->markTaskCompleted(target);
+            return true;
+        case JournalCommand::FailTask:
+            m_tasks->failTask(target, event.arg != 0);
+            return true;
+        case JournalCommand::TaskProgress:
+            m_tasks->updateTaskProgress(target, static_cast<int>(event.arg));
+            return true;
+        case JournalCommand::Purchase:
+            return m_shop->purchaseItem(target, static_cast<int>(event.arg)).success;
+        case JournalCommand::UseItem: {
+            if (event.rngSeed != 0) {
+                m_shop->seedRandomEngine(event.rngSeed);
+            }
+            std::string message;
+            return m_shop->useInventoryItem(target, &message);
+        }
+        case JournalCommand::ManualLog:
+            return m_logs->recordManualLog(event.text, static_cast<LogEntry::MoodTag>(event.arg)) > 0;
+        case JournalCommand::ForgiveLog:
+            m_logs->forgiveLog(target);
+            return true;
+        }
+        return false;
+    }
+
+    DatabaseManager& m_database;
+    UserManager m_userManager;
+    TaskManager* m_tasks = nullptr;
+    AchievementManager* m_achievements = nullptr;
+    LogManager* m_logs = nullptr;
+    InventoryManager* m_inventory = nullptr;
+    ShopManager* m_shop = nullptr;
+    std::array<rove::metrics::Histogram*, kCommands.size()> m_histograms{};
+    std::array<std::size_t, kCommands.size()> m_applied{};
+    std::array<std::size_t, kCommands.size()> m_failed{};
+};
+
+/**
+ * @brief timing=original 时按记录间隔除以 speed 等待到期，等待期间处理排队的信号与定时器。
+ */
+void replay(Replayer& replayer, const std::vector<JournalEvent>& events, const Options& options) {
+    using Clock = std::chrono::steady_clock;
+    const auto replayStart = Clock::now();
+    const std::int64_t firstMs = events.empty() ? 0 : events.front().timestampMs;
+    for (const auto& event : events) {
+        if (options.originalTiming && options.speed > 0.0) {
+            const auto due = replayStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(
+                                               static_cast<double>(event.timestampMs - firstMs) / options.speed));
+            while (Clock::now() < due) {
+                QCoreApplication::processEvents();
+                std::this_thread::sleep_until(std::min(due, Clock::now() + std::chrono::milliseconds(20)));
+            }
+        }
+        replayer.apply(event);
+        QCoreApplication::processEvents();
+    }
+    replayer.finish();
+}
+
+[[noreturn]] void usage() {
+    std::fprintf(stderr,
+                 "usage: journal_replay --db=<base snapshot> --journal=<file> [--work=<copy>] [--timing=fast|original]\n"
+                 "                      [--speed=1] [--user=x] [--password=1] [--trace-ms=20] [--json=<file>]\n");
+    std::exit(2);
+}
+
+Options parseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&arg](const char* prefix) -> std::optional<std::string> {
+            const std::string p = prefix;
+            return arg.rfind(p, 0) == 0 ? std::optional<std::string>(arg.substr(p.size())) : std::nullopt;
+        };
+        if (auto v = value("--db=")) {
+            options.databasePath = *v;
+        } else if (auto v = value("--journal=")) {
+            options.journalPath = *v;
+        } else if (auto v = value("--work=")) {
+            options.workPath = *v;
+        } else if (auto v = value("--json=")) {
+            options.jsonPath = *v;
+        } else if (auto v = value("--user=")) {
+            options.username = *v;
+        } else if (auto v = value("--password=")) {
+            options.password = *v;
+        } else if (auto v = value("--timing=")) {
+            if (*v != "fast" && *v != "original") {
+                usage();
+            }
+            options.originalTiming = *v == "original";
+        } else if (auto v = value("--speed=")) {
+            options.speed = std::max(0.0, std::atof(v->c_str()));
+        } else if (auto v = value("--trace-ms=")) {
+            options.traceThresholdMs = std::atoi(v->c_str());
+        } else {
+            usage();
+        }
+    }
+    if (options.databasePath.empty() || options.journalPath.empty()) {
+        usage();
+    }
+    if (options.workPath.empty()) {
+        options.workPath = options.databasePath + ".replay.db";
+    }
+    if (options.workPath == options.databasePath) {
+        std::fprintf(stderr, "journal_replay: --work must differ from --db, the snapshot is kept unchanged\n");
+        std::exit(2);
+    }
+    return options;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const Options options = parseOptions(argc, argv);
+    try {
+        const Journal journal = readJournal(options.journalPath);
+        std::printf("journal: %zu commands, session seed %u, recorded from %s\n", journal.events.size(),
+                    journal.header.sessionSeed,
+                    QDateTime::fromMSecsSinceEpoch(journal.header.startedAtMs).toString(Qt::ISODate).toStdString().c_str());
+        if (journal.missing > 0) {
+            std::fprintf(stderr, "journal_replay: %llu commands were dropped while recording; results may diverge\n",
+                         static_cast<unsigned long long>(journal.missing));
+        }
+        if (journal.truncated) {
+            std::fprintf(stderr, "journal_replay: last record is incomplete and was skipped\n");
+        }
+
+        for (const char* suffix : {"", "-wal", "-shm"}) {
+            std::remove((options.workPath + suffix).c_str());
+        }
+        const BackupReport copy = BackupService::backupTo(options.databasePath, options.workPath, 1024,
+                                                          std::chrono::milliseconds(0));
+        if (!copy.succeeded) {
+            throw std::runtime_error("cannot copy " + options.databasePath + ": " + copy.error);
+        }
+
+        rove::metrics::setEnabled(true);
+        rove::metrics::Registry::instance().reset();
+        Replayer replayer(options.workPath, options);
+        for (const auto& event : journal.events) {
+            if (event.userId != 0 && event.userId != replayer.userId()) {
+                std::fprintf(stderr, "journal_replay: journal was recorded for user %d, replaying as user %d\n",
+                             event.userId, replayer.userId());
+                break;
+            }
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        replay(replayer, journal.events, options);
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        replayer.printReport();
+        std::printf("replayed %zu commands in %.2fs (%s timing)\n", journal.events.size(), elapsed,
+                    options.originalTiming ? "original" : "fast");
+
+        if (!options.jsonPath.empty()) {
+            std::ofstream json(options.jsonPath, std::ios::trunc);
+            json << rove::metrics::Registry::instance().toJson();
+            if (!json) {
+                throw std::runtime_error("cannot write " + options.jsonPath);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "journal_replay failed: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,456 @@
+#include <QCoreApplication>
+#include <QDateTime>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AchievementManager.h"
+#include "DatabaseManager.h"
+#include "InventoryManager.h"
+#include "LogManager.h"
+#include "ShopManager.h"
+#include "TaskManager.h"
+#include "UserManager.h"
+
+/**
+ * @file workload_tool.cpp
+ * @brief 合成负载生成与回放工具：经真实管理器接口模拟数月校园活动，并可按倍速回放事件轨迹。
+ * 中文：
+ *   workload_tool generate --db=<路径> [--days=90] [--seed=42] [--trace=<轨迹文件>]
+ *       从空库开始逐日模拟：每日/每周重置、完成任务、购买、开福袋与手写日志；
+ *       相同种子在新库上生成完全相同的事件序列，日志与快照时间戳落在模拟时间上。
+ *   workload_tool replay --db=<路径> --trace=<轨迹文件> [--speed=60]
+ *       按轨迹时间间隔除以 speed 回放（speed=0 表示不等待）；轨迹中的任务与商品 ID
+ *       对应以同一种子 generate 出来的库，回放时使用系统时间。
+ */
+
+namespace {
+
+using namespace rove::data;
+
+/**
+ * @brief 轨迹中的事件类型，文本形式写入轨迹文件。
+ */
+enum class EventKind { DailyReset, WeeklyReset, CreateTask, CompleteTask, Purchase, LuckyBag, ManualLog };
+
+constexpr std::array<const char*, 7> kEventNames = {"daily_reset", "weekly_reset", "create_task", "complete_task",
+                                                    "purchase",    "lucky_bag",    "manual_log"};
+
+/**
+ * @brief 一条轨迹事件；offsetMs 为距轨迹起点的模拟毫秒数。
+ * 中文：arg 含义随类型而定：重置为模拟日期的 epoch 毫秒，建任务为 TaskType，完成任务为任务 ID，
+ *       购买与开福袋为商品 ID，手写日志为心情枚举；text 只用于建任务名称与日志内容，不含制表符与换行。
+ */
+struct WorkloadEvent {
+    std::int64_t offsetMs = 0;
+    EventKind kind = EventKind::DailyReset;
+    std::int64_t arg = 0;
+    std::string text;
+};
+
+struct EventStats {
+    std::array<std::size_t, kEventNames.size()> applied{};
+    std::array<std::size_t, kEventNames.size()> failed{};
+};
+
+/**
+ * @brief 工具运行期间持有的管理器集合，构造时登录预置账号并装载缓存。
+ */
+class Workload {
+public:
+    explicit Workload(const std::string& databasePath)
+        : m_database(openDatabase(databasePath)), m_userManager(m_database) {
+        if (!m_userManager.login("x", "1")) {
+            throw std::runtime_error("failed to log in the preconfigured account");
+        }
+        m_tasks = &TaskManager::instance(m_database, m_userManager);
+        m_achievements = &AchievementManager::instance(m_database, m_userManager, *m_tasks);
+        m_logs = &LogManager::instance(m_database, m_userManager, *m_achievements, *m_tasks);
+        m_inventory = &InventoryManager::instance();
+        m_inventory->initialize(m_database);
+        m_shop = &ShopManager::instance();
+        m_shop->initialize(m_database, m_userManager, *m_inventory);
+        m_tasks->refreshFromDatabase();
+        m_achievements->refreshFromDatabase();
+    }
+
+    ~Workload() {
+        try {
+            finish();
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "workload: final flush failed: %s\n", e.what());
+        }
+    }
+
+    /**
+     * @brief 执行一条事件；业务层拒绝（余额不足、限购、任务已完成等）记为失败而不中断运行。
+     */
+    bool apply(const WorkloadEvent& event) {
+        const auto index = static_cast<std::size_t>(event.kind);
+        bool ok = false;
+        try {
+            ok = dispatch(event);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "workload: %s failed: %s\n", kEventNames[index], e.what());
+        }
+        ++(ok ? m_stats.applied : m_stats.failed)[index];
+        return ok;
+    }
+
+    /**
+     * @brief 把后台日志队列与成就进度写回磁盘。
+     */
+    void finish() {
+        m_logs->flush();
+        m_achievements->flushPendingProgress();
+    }
+
+    void printStats() const {
+        std::printf("%-16s %10s %10s\n", "event", "applied", "failed");
+        for (std::size_t i = 0; i < kEventNames.size(); ++i) {
+            std::printf("%-16s %10zu %10zu\n", kEventNames[i], m_stats.applied[i], m_stats.failed[i]);
+        }
+    }
+
+    TaskManager& tasks() { return *m_tasks; }
+    ShopManager& shop() { return *m_shop; }
+    LogManager& logs() { return *m_logs; }
+
+private:
+    static DatabaseManager& openDatabase(const std::string& path) {
+        auto& database = DatabaseManager::instance();
+        database.initialize(path);
+        return database;
+    }
+
+    bool dispatch(const WorkloadEvent& event) {
+        switch (event.kind) {
+        case EventKind::DailyReset:
+            m_tasks->resetDailyTasks();
+            return true;
+        case EventKind::WeeklyReset:
+            m_tasks->resetWeeklyTasks(QDateTime::fromMSecsSinceEpoch(event.arg).toUTC().date());
+            return true;
+        case EventKind::CreateTask: {
+            Task task;
+            task.setName(event.text);
+            task.setDescription("workload");
+            task.setType(static_cast<Task::TaskType>(event.arg));
+            task.setDifficultyStars(2);
+            task.setDeadline(QDateTime::currentDateTimeUtc().addDays(120));
+            task.setCoinReward(20);
+            task.setGrowthReward(15);
+            task.setAttributeReward(User::AttributeSet{1, 0, 0, 1, 0, 0});
+            task.setProgressGoal(1);
+            return m_tasks->createTask(task) > 0;
+        }
+        case EventKind::CompleteTask: {
+            const auto task = m_tasks->taskById(static_cast<int>(event.arg));
+            if (!task.has_value() || task->isCompleted()) {
+                return false;
+            }
+            m_tasks->markTaskCompleted(task->id());
+            return true;
+        }
+        case EventKind::Purchase:
+        case EventKind::LuckyBag:
+            return m_shop->purchaseItem(static_cast<int>(event.arg), 1).success;
+        case EventKind::ManualLog:
+            m_logs->recordManualLog(event.text, static_cast<LogEntry::MoodTag>(event.arg),
+                                    LogManager::LogDelivery::FireAndForget);
+            return true;
+        }
+        return false;
+    }
+
+    DatabaseManager& m_database;
+    UserManager m_userManager;
+    TaskManager* m_tasks = nullptr;
+    AchievementManager* m_achievements = nullptr;
+    LogManager* m_logs = nullptr;
+    InventoryManager* m_inventory = nullptr;
+    ShopManager* m_shop = nullptr;
+    EventStats m_stats;
+};
+
+void writeHeader(std::ostream& out, std::int64_t startMs, std::uint32_t seed) {
+    out << "# rove-workload v1 start=" << startMs << " seed=" << seed << '\n';
+}
+
+void writeEvent(std::ostream& out, const WorkloadEvent& event) {
+    out << event.offsetMs << '\t' << kEventNames[static_cast<std::size_t>(event.kind)] << '\t' << event.arg << '\t'
+        << event.text << '\n';
+}
+
+std::vector<WorkloadEvent> readTrace(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open trace " + path);
+    }
+    std::vector<WorkloadEvent> events;
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string offset;
+        std::string kind;
+        std::string arg;
+        WorkloadEvent event;
+        if (!std::getline(fields, offset, '\t') || !std::getline(fields, kind, '\t') ||
+            !std::getline(fields, arg, '\t')) {
+            throw std::runtime_error("malformed trace line " + std::to_string(lineNumber));
+        }
+        std::getline(fields, event.text);
+        const auto name = std::find(kEventNames.begin(), kEventNames.end(), kind);
+        if (name == kEventNames.end()) {
+            throw std::runtime_error("unknown event '" + kind + "' on trace line " + std::to_string(lineNumber));
+        }
+        event.kind = static_cast<EventKind>(name - kEventNames.begin());
+        event.offsetMs = std::stoll(offset);
+        event.arg = std::stoll(arg);
+        events.push_back(std::move(event));
+    }
+    return events;
+}
+
+/**
+ * @brief 在 [0, bound) 内取随机整数；std::uniform_int_distribution 的输出随标准库实现而异，
+ *        这里直接取模，保证不同编译器上同一种子生成同一轨迹。
+ */
+std::uint32_t pick(std::mt19937& rng, std::uint32_t bound) { return bound == 0 ? 0 : rng() % bound; }
+
+bool chance(std::mt19937& rng, std::uint32_t percent) { return pick(rng, 100) < percent; }
+
+/**
+ * @brief 从空库开始模拟 days 天的活动，边生成边执行，并可把事件写入轨迹文件。
+ * 中文：事件先按当天的模拟时刻排序再依次执行；需要目标 ID 的事件在执行前才从管理器当前状态中选取，
+ *       因此轨迹记录的是实际发生的操作，回放到同种子生成的库上可以一一对应。
+ */
+void generate(Workload& workload, int days, std::uint32_t seed, std::ostream* trace) {
+    constexpr std::int64_t kDayMs = 24LL * 3600 * 1000;
+    static const char* kManualTexts[] = {"今天在图书馆自习了一下午", "和室友去操场夜跑", "社团例会讨论了下周活动",
+                                         "实验报告终于写完", "萃英山上看日落"};
+
+    std::mt19937 rng(seed);
+    workload.shop().seedRandomEngine(seed);
+    const std::int64_t startMs =
+        (QDateTime::currentMSecsSinceEpoch() / kDayMs - static_cast<std::int64_t>(days)) * kDayMs;
+    std::int64_t simulatedMs = startMs;
+    workload.logs().setClock([&simulatedMs]() { return QDateTime::fromMSecsSinceEpoch(simulatedMs); });
+    if (trace != nullptr) {
+        writeHeader(*trace, startMs, seed);
+    }
+
+    auto run = [&](WorkloadEvent event) {
+        simulatedMs = startMs + event.offsetMs;
+        workload.apply(event);
+        if (trace != nullptr) {
+            writeEvent(*trace, event);
+        }
+    };
+
+    // 中文：第一天早上建立一批个人任务，日常任务占多数，与实际使用比例相近。
+    const std::pair<Task::TaskType, int> kInitialTasks[] = {
+        {Task::TaskType::Daily, 8}, {Task::TaskType::Weekly, 3}, {Task::TaskType::Semester, 2}, {Task::TaskType::Custom, 3}};
+    std::int64_t offset = 8LL * 3600 * 1000;
+    for (const auto& [type, count] : kInitialTasks) {
+        for (int i = 0; i < count; ++i) {
+            run({offset++, EventKind::CreateTask, static_cast<std::int64_t>(type),
+                 "workload " + Task::typeToString(type) + " " + std::to_string(i)});
+        }
+    }
+
+    for (int day = 0; day < days; ++day) {
+        const std::int64_t dayOffset = static_cast<std::int64_t>(day) * kDayMs;
+        const std::int64_t dayStartMs = startMs + dayOffset;
+        if (day > 0) {
+            run({dayOffset, EventKind::DailyReset, dayStartMs, {}});
+            if (QDateTime::fromMSecsSinceEpoch(dayStartMs).toUTC().date().dayOfWeek() == 1) {
+                run({dayOffset + 1, EventKind::WeeklyReset, dayStartMs, {}});
+            }
+        }
+
+        // 中文：白天 08:00–22:00 内随机分布当天的动作。
+        struct Planned {
+            std::int64_t offsetMs;
+            EventKind kind;
+        };
+        std::vector<Planned> planned;
+        const auto actionTime = [&]() {
+            return dayOffset + 8LL * 3600 * 1000 + static_cast<std::int64_t>(pick(rng, 14U * 3600 * 1000));
+        };
+        const std::uint32_t completions = 2 + pick(rng, 5);
+        for (std::uint32_t i = 0; i < completions; ++i) {
+            planned.push_back({actionTime(), EventKind::CompleteTask});
+        }
+        if (chance(rng, 30)) {
+            planned.push_back({actionTime(), EventKind::Purchase});
+        }
+        if (chance(rng, 15)) {
+            planned.push_back({actionTime(), EventKind::LuckyBag});
+        }
+        const std::uint32_t manualLogs = pick(rng, 3);
+        for (std::uint32_t i = 0; i < manualLogs; ++i) {
+            planned.push_back({actionTime(), EventKind::ManualLog});
+        }
+        std::stable_sort(planned.begin(), planned.end(),
+                         [](const Planned& a, const Planned& b) { return a.offsetMs < b.offsetMs; });
+
+        for (const auto& step : planned) {
+            WorkloadEvent event{step.offsetMs, step.kind, 0, {}};
+            if (step.kind == EventKind::CompleteTask) {
+                std::vector<int> open;
+                workload.tasks().forEachTask([&open](const Task& task) {
+                    if (!task.isCompleted()) {
+                        open.push_back(task.id());
+                    }
+                });
+                if (open.empty()) {
+                    continue;
+                }
+                event.arg = open[pick(rng, static_cast<std::uint32_t>(open.size()))];
+            } else if (step.kind == EventKind::Purchase || step.kind == EventKind::LuckyBag) {
+                const bool wantLuckyBag = step.kind == EventKind::LuckyBag;
+                std::vector<int> candidates;
+                for (const auto& entry : workload.shop().catalog()->entries) {
+                    const bool isLuckyBag = entry.priced.itemType() == ShopItem::ItemType::LuckyBag;
+                    if (entry.priced.isAvailable() && isLuckyBag == wantLuckyBag) {
+                        candidates.push_back(entry.priced.id());
+                    }
+                }
+                if (candidates.empty()) {
+                    continue;
+                }
+                event.arg = candidates[pick(rng, static_cast<std::uint32_t>(candidates.size()))];
+            } else {
+                event.arg = static_cast<std::int64_t>(pick(rng, 3));
+                event.text = kManualTexts[pick(rng, static_cast<std::uint32_t>(std::size(kManualTexts)))];
+            }
+            run(std::move(event));
+        }
+        QCoreApplication::processEvents();
+    }
+
+    workload.finish();
+    workload.logs().setClock({});
+}
+
+/**
+ * @brief 按轨迹时间间隔回放；speed 为时间压缩倍数，0 表示不等待。
+ */
+void replay(Workload& workload, const std::vector<WorkloadEvent>& events, double speed) {
+    using Clock = std::chrono::steady_clock;
+    const auto replayStart = Clock::now();
+    const std::int64_t firstOffset = events.empty() ? 0 : events.front().offsetMs;
+    for (const auto& event : events) {
+        if (speed > 0.0) {
+            const auto due = replayStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(
+                                               static_cast<double>(event.offsetMs - firstOffset) / speed));
+            while (Clock::now() < due) {
+                QCoreApplication::processEvents();  // 中文：等待期间处理排队信号，快照与维护定时器照常运行。
+                std::this_thread::sleep_until(std::min(due, Clock::now() + std::chrono::milliseconds(20)));
+            }
+        }
+        workload.apply(event);
+    }
+    workload.finish();
+}
+
+struct Options {
+    std::string command;
+    std::string databasePath;
+    std::string tracePath;
+    int days = 90;
+    std::uint32_t seed = 42;
+    double speed = 60.0;
+};
+
+[[noreturn]] void usage() {
+    std::fprintf(stderr,
+                 "usage: workload_tool generate --db=<path> [--days=90] [--seed=42] [--trace=<file>]\n"
+                 "       workload_tool replay --db=<path> --trace=<file> [--speed=60]\n");
+    std::exit(2);
+}
+
+Options parseOptions(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+    }
+    Options options;
+    options.command = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&arg](const char* prefix) -> std::optional<std::string> {
+            const std::string p = prefix;
+            return arg.rfind(p, 0) == 0 ? std::optional<std::string>(arg.substr(p.size())) : std::nullopt;
+        };
+        if (auto v = value("--db=")) {
+            options.databasePath = *v;
+        } else if (auto v = value("--trace=")) {
+            options.tracePath = *v;
+        } else if (auto v = value("--days=")) {
+            options.days = std::max(1, std::atoi(v->c_str()));
+        } else if (auto v = value("--seed=")) {
+            options.seed = static_cast<std::uint32_t>(std::strtoul(v->c_str(), nullptr, 10));
+        } else if (auto v = value("--speed=")) {
+            options.speed = std::max(0.0, std::atof(v->c_str()));
+        } else {
+            usage();
+        }
+    }
+    if (options.databasePath.empty() || (options.command == "replay" && options.tracePath.empty())) {
+        usage();
+    }
+    if (options.command != "generate" && options.command != "replay") {
+        usage();
+    }
+    return options;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const Options options = parseOptions(argc, argv);
+    try {
+        Workload workload(options.databasePath);
+        const auto begin = std::chrono::steady_clock::now();
+        if (options.command == "generate") {
+            std::ofstream trace;
+            if (!options.tracePath.empty()) {
+                trace.open(options.tracePath);
+                if (!trace) {
+                    throw std::runtime_error("cannot write trace " + options.tracePath);
+                }
+            }
+            generate(workload, options.days, options.seed, trace.is_open() ? &trace : nullptr);
+        } else {
+            replay(workload, readTrace(options.tracePath), options.speed);
+        }
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        workload.printStats();
+        std::printf("%s finished in %.2fs\n", options.command.c_str(), elapsed);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "workload_tool failed: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -4,8 +4,8 @@ namespace rove::data {
 
 Achievement::Achievement()
     : m_id(-1),
-      m_owner(),
-      m_creator(),
+      m_ownerId(0),
+      m_creatorId(0),
       m_name(),
       m_description(),
       m_iconPath(),
@@ -31,11 +31,11 @@ Achievement::Achievement()
 int Achievement::id() const noexcept { return m_id; }
 void Achievement::setId(int id) noexcept { m_id = id; }
 
-const std::string& Achievement::owner() const noexcept { return m_owner; }
-void Achievement::setOwner(std::string owner) { m_owner = std::move(owner); }
+int Achievement::ownerId() const noexcept { return m_ownerId; }
+void Achievement::setOwnerId(int ownerId) noexcept { m_ownerId = ownerId; }
 
-const std::string& Achievement::creator() const noexcept { return m_creator; }
-void Achievement::setCreator(std::string creator) { m_creator = std::move(creator); }
+int Achievement::creatorId() const noexcept { return m_creatorId; }
+void Achievement::setCreatorId(int creatorId) noexcept { m_creatorId = creatorId; }
 
 const std::string& Achievement::name() const noexcept { return m_name; }
 void Achievement::setName(std::string name) { m_name = std::move(name); }
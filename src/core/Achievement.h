@@ -4,6 +4,7 @@
 #include <QColor>
 #include <QDateTime>
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -42,7 +43,8 @@ public:
     struct Condition {
         /**
          * @enum ConditionType
-         * @brief 支持的触发来源：任务、等级、自豪感、金币或自定义计数。
+         * @brief 支持的触发来源：任务、等级、自豪感、金币、自定义计数或自定义规则。
+         * 中文：Rule 的元数据是规则源码（语法见 AchievementRule.h），装载与创建时编译一次。
          */
         enum class ConditionType {
             CompleteAnyTask,
@@ -50,13 +52,15 @@ public:
             ReachLevel,
             ReachPride,
             ReachCoins,
-            CustomCounter
+            CustomCounter,
+            Rule
         };
 
         ConditionType type = ConditionType::CompleteAnyTask;
         int targetValue = 1;
         int currentValue = 0;
         std::string metadata;
+        std::vector<std::int64_t> ruleHits;  //!< 带时间窗的计数规则：窗口内最近的命中时刻（毫秒），至多 targetValue 个
     };
 
     Achievement();
@@ -64,11 +68,17 @@ public:
     int id() const noexcept;
     void setId(int id) noexcept;
 
-    const std::string& owner() const noexcept;
-    void setOwner(std::string owner);
+    /**
+     * @brief 所属学生的 users.id。
+     */
+    int ownerId() const noexcept;
+    void setOwnerId(int ownerId) noexcept;
 
-    const std::string& creator() const noexcept;
-    void setCreator(std::string creator);
+    /**
+     * @brief 创建者的 users.id；系统模板为 0。
+     */
+    int creatorId() const noexcept;
+    void setCreatorId(int creatorId) noexcept;
 
     const std::string& name() const noexcept;
     void setName(std::string name);
@@ -138,8 +148,8 @@ public:
 
 private:
     int m_id;
-    std::string m_owner;
-    std::string m_creator;
+    int m_ownerId;
+    int m_creatorId;
     std::string m_name;
     std::string m_description;
     std::string m_iconPath;
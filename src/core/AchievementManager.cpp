@@ -1,57 +1,33 @@
 #include "AchievementManager.h"
 
 #include <QDate>
+#include <QDebug>
 
 #include <algorithm>
 #include <cmath>
+#include <exception>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "EnumText.h"
+#include "Metrics.h"
+#include "RecordCodec.h"
 
 namespace rove::data {
 namespace {
 
+constexpr int kProgressFlushIntervalMs = 2000;     //!< 进度写回的最长延迟
+constexpr std::size_t kProgressFlushBatchSize = 64;  //!< 脏集合达到该规模时立即刷写
+
 std::string serializeConditions(const std::vector<Achievement::Condition>& conditions) {
-    std::ostringstream stream;
-    bool first = true;
-    for (const auto& condition : conditions) {
-        if (!first) {
-            stream << ';';
-        }
-        first = false;
-        stream << static_cast<int>(condition.type) << ',' << condition.targetValue << ','
-               << condition.currentValue << ',' << condition.metadata;
-    }
-    return stream.str();
+    return codec::encodeConditions(conditions);
 }
 
 std::vector<Achievement::Condition> deserializeConditions(const std::string& blob) {
     std::vector<Achievement::Condition> conditions;
-    std::istringstream stream(blob);
-    std::string segment;
-    while (std::getline(stream, segment, ';')) {
-        if (segment.empty()) {
-            continue;
-        }
-        std::istringstream part(segment);
-        std::string typeToken;
-        std::string targetToken;
-        std::string currentToken;
-        std::string metadataToken;
-        std::getline(part, typeToken, ',');
-        std::getline(part, targetToken, ',');
-        std::getline(part, currentToken, ',');
-        std::getline(part, metadataToken);
-        Achievement::Condition condition;
-        try {
-            condition.type = static_cast<Achievement::Condition::ConditionType>(std::stoi(typeToken));
-            condition.targetValue = std::max(1, std::stoi(targetToken));
-            condition.currentValue = std::max(0, std::stoi(currentToken));
-        } catch (...) {
-            continue;
-        }
-        condition.metadata = metadataToken;
-        conditions.push_back(condition);
-    }
+    codec::decodeConditions(blob, conditions);
     if (conditions.empty()) {
         Achievement::Condition fallback;
         fallback.targetValue = 1;
@@ -85,48 +61,41 @@ std::vector<std::string> deserializeItems(const std::string& blob) {
     return items;
 }
 
-std::string serializeAttributes(const User::AttributeSet& set) {
-    std::ostringstream stream;
-    stream << set.execution << ',' << set.perseverance << ',' << set.decision << ',' << set.knowledge
-           << ',' << set.social << ',' << set.pride;
-    return stream.str();
-}
+constexpr EnumTextTable<Achievement::Type, 2> kTypeText{{{
+    {Achievement::Type::System, "System"},
+    {Achievement::Type::Custom, "Custom"},
+}}};
 
-User::AttributeSet deserializeAttributes(const std::string& blob) {
-    User::AttributeSet set;
-    std::istringstream stream(blob);
-    std::string token;
-    int* fields[] = {&set.execution, &set.perseverance, &set.decision, &set.knowledge, &set.social, &set.pride};
-    for (int i = 0; i < 6 && std::getline(stream, token, ','); ++i) {
-        try {
-            *fields[i] = std::stoi(token);
-        } catch (...) {
-            *fields[i] = 0;
-        }
-    }
-    return set;
-}
+constexpr EnumTextTable<Achievement::RewardType, 2> kRewardTypeText{{{
+    {Achievement::RewardType::WithReward, "WithReward"},
+    {Achievement::RewardType::NoReward, "NoReward"},
+}}};
 
-std::string typeToText(Achievement::Type type) { return type == Achievement::Type::System ? "System" : "Custom"; }
+constexpr EnumTextTable<Achievement::ProgressMode, 2> kProgressModeText{{{
+    {Achievement::ProgressMode::Milestone, "Milestone"},
+    {Achievement::ProgressMode::Incremental, "Incremental"},
+}}};
 
-Achievement::Type typeFromText(const std::string& text) {
-    return text == "System" ? Achievement::Type::System : Achievement::Type::Custom;
+std::string typeToText(Achievement::Type type) { return std::string(kTypeText.text(type).value_or("Custom")); }
+
+Achievement::Type typeFromText(std::string_view text) {
+    return kTypeText.value(text).value_or(Achievement::Type::Custom);
 }
 
 std::string rewardTypeToText(Achievement::RewardType type) {
-    return type == Achievement::RewardType::WithReward ? "WithReward" : "NoReward";
+    return std::string(kRewardTypeText.text(type).value_or("NoReward"));
 }
 
-Achievement::RewardType rewardTypeFromText(const std::string& text) {
-    return text == "WithReward" ? Achievement::RewardType::WithReward : Achievement::RewardType::NoReward;
+Achievement::RewardType rewardTypeFromText(std::string_view text) {
+    return kRewardTypeText.value(text).value_or(Achievement::RewardType::NoReward);
 }
 
 std::string progressModeToText(Achievement::ProgressMode mode) {
-    return mode == Achievement::ProgressMode::Incremental ? "Incremental" : "Milestone";
+    return std::string(kProgressModeText.text(mode).value_or("Milestone"));
 }
 
-Achievement::ProgressMode progressModeFromText(const std::string& text) {
-    return text == "Incremental" ? Achievement::ProgressMode::Incremental : Achievement::ProgressMode::Milestone;
+Achievement::ProgressMode progressModeFromText(std::string_view text) {
+    return kProgressModeText.value(text).value_or(Achievement::ProgressMode::Milestone);
 }
 
 }  // namespace
@@ -147,76 +116,211 @@ AchievementManager::AchievementManager(DatabaseManager& database,
       m_taskManager(taskManager),
       m_achievements(),
       m_galleryIndex(),
-      m_mutex() {
+      m_galleryPlacement(),
+      m_rewardQuota(),
+      m_conditionIndex(),
+      m_dirtyProgress(),
+      m_flushTimer(std::make_unique<QTimer>()),
+      m_outbox(),
+      m_loadedOwner(0),
+      m_snapshot(std::make_shared<const AchievementSet>()),
+      m_mutex("AchievementManager"),
+      m_memoryRegistration() {
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(kProgressFlushIntervalMs);
+    QObject::connect(m_flushTimer.get(), &QTimer::timeout, this, &AchievementManager::flushPendingProgress);
+    // 中文：业务信号固定直连：无论写操作在 GUI 线程还是 CommandExecutor 的数据线程上执行，
+    //       成就推进都在发出信号的线程上、并入同一个工作单元完成。
     if (auto* proxy = m_taskManager.signalProxy()) {
-        QObject::connect(proxy, &TaskManagerSignalProxy::taskCompleted, this, &AchievementManager::onTaskCompleted);
-        QObject::connect(proxy, &TaskManagerSignalProxy::taskProgressed, this, &AchievementManager::onTaskProgressed);
+        QObject::connect(proxy, &TaskManagerSignalProxy::taskCompleted, this, &AchievementManager::onTaskCompleted,
+                         Qt::DirectConnection);
+        QObject::connect(proxy, &TaskManagerSignalProxy::taskProgressed, this, &AchievementManager::onTaskProgressed,
+                         Qt::DirectConnection);
     }
     if (auto* proxy = m_userManager.signalProxy()) {
-        QObject::connect(proxy, &UserManagerSignalProxy::levelChanged, this, &AchievementManager::onUserLevelChanged);
-        QObject::connect(proxy, &UserManagerSignalProxy::prideChanged, this, &AchievementManager::onPrideChanged);
-        QObject::connect(proxy, &UserManagerSignalProxy::coinsChanged, this, &AchievementManager::onCoinsChanged);
+        QObject::connect(proxy, &UserManagerSignalProxy::levelChanged, this, &AchievementManager::onUserLevelChanged,
+                         Qt::DirectConnection);
+        QObject::connect(proxy, &UserManagerSignalProxy::prideChanged, this, &AchievementManager::onPrideChanged,
+                         Qt::DirectConnection);
+        QObject::connect(proxy, &UserManagerSignalProxy::coinsChanged, this, &AchievementManager::onCoinsChanged,
+                         Qt::DirectConnection);
+        QObject::connect(proxy, &UserManagerSignalProxy::sessionChanged, this, &AchievementManager::onSessionChanged,
+                         Qt::DirectConnection);
+    }
+    m_memoryRegistration = metrics::MemoryRegistry::instance().add("achievements", [this]() { return memoryUsage(); });
+}
+
+AchievementManager::~AchievementManager() {
+    try {
+        flushPendingProgress();
+    } catch (const std::exception& e) {
+        qWarning() << "AchievementManager: 退出时写回成就进度失败:" << e.what();
+    }
+}
+
+/**
+ * @brief 刷写脏集合中的成就进度，定时器超时、应用退出与析构时调用。
+ * 中文：在事务内取走脏集合并写回，并发的刷写按事务顺序落盘，不会用旧快照覆盖新进度；
+ *       写入失败时把取走的 ID 放回脏集合，等待下一次刷写重试。
+ */
+void AchievementManager::flushPendingProgress() {
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        if (m_dirtyProgress.empty()) {
+            return;
+        }
     }
+    m_database.runInTransaction([this]() {
+        std::vector<int> ids;
+        std::vector<DatabaseManager::AchievementRecord> records;
+        {
+            std::unique_lock<StateMutex> lock(m_mutex);
+            QMetaObject::invokeMethod(m_flushTimer.get(), [timer = m_flushTimer.get()]() { timer->stop(); });
+            ids.assign(m_dirtyProgress.begin(), m_dirtyProgress.end());
+            records.reserve(ids.size());
+            for (int id : ids) {
+                if (auto it = m_achievements.find(id); it != m_achievements.end()) {
+                    records.push_back(toRecord(it->second));
+                }
+            }
+            m_dirtyProgress.clear();
+        }
+        try {
+            m_database.updateAchievements(records);
+        } catch (...) {
+            std::unique_lock<StateMutex> lock(m_mutex);
+            m_dirtyProgress.insert(ids.begin(), ids.end());
+            throw;
+        }
+    });
 }
 
+/**
+ * @brief 重新装载当前用户的成就；读库、补齐系统模板与构建都在锁外完成，最后在独占锁内替换缓存。
+ */
 void AchievementManager::refreshFromDatabase() {
     if (!m_userManager.hasActiveUser()) {
         return;
     }
-    const std::string owner = m_userManager.activeUser().username();
-    const auto records = m_database.getAchievementsForOwner(owner);
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_achievements.clear();
-    for (const auto& record : records) {
-        Achievement achievement = hydrateAchievement(record);
-        m_achievements[achievement.id()] = achievement;
-    }
-    ensureSystemAchievements();
+    flushPendingProgress();
+    const int owner = m_userManager.activeUserId();
+    std::unordered_map<int, Achievement> loaded;
+    m_database.streamAchievementsForOwner(owner, [this, &loaded](DatabaseManager::AchievementRecord& record) {
+        Achievement achievement = hydrateAchievement(std::move(record));
+        loaded[achievement.id()] = std::move(achievement);
+    });
+    ensureSystemAchievements(loaded);
+    std::unique_lock<StateMutex> lock(m_mutex);
+    m_dirtyProgress.clear();
+    m_achievements.swap(loaded);
+    m_loadedOwner = owner;
     rebuildGalleryIndex();
+    rebuildRewardQuota();
+    rebuildConditionIndex();
+    m_snapshotRebuild = true;
+    publishSnapshotLocked();
 }
 
-std::vector<Achievement> AchievementManager::achievements() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    std::vector<Achievement> result;
-    for (const auto& [id, achievement] : m_achievements) {
-        result.push_back(achievement);
+/**
+ * @brief 会话切换到其他用户时重新装载成就；首次装载由启动流程负责，退出登录时保留缓存直到下次登录。
+ */
+void AchievementManager::onSessionChanged(int userId) {
+    if (userId == 0) {
+        return;
+    }
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        if (m_loadedOwner == 0 || m_loadedOwner == userId) {
+            return;
+        }
     }
-    return result;
+    refreshFromDatabase();
 }
 
-std::vector<Achievement> AchievementManager::achievementsInGroup(const std::string& group) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    std::vector<Achievement> result;
-    auto it = m_galleryIndex.find(group);
-    if (it == m_galleryIndex.end()) {
-        return result;
+std::shared_ptr<const AchievementManager::AchievementSet> AchievementManager::snapshot() const {
+    return std::atomic_load(&m_snapshot);
+}
+
+/**
+ * @brief 快照中未改动的成就与上一版本共享对象，这里按每个条目一份 Achievement 计，结果偏大。
+ */
+metrics::MemoryUsage AchievementManager::memoryUsage() const {
+    std::shared_lock<StateMutex> lock(m_mutex);
+    metrics::MemoryUsage usage;
+    usage.entries = m_achievements.size();
+    usage.bytes = metrics::nodeContainerBytes(m_achievements.size(), sizeof(std::pair<const int, Achievement>),
+                                              m_achievements.bucket_count());
+    for (const auto& [id, achievement] : m_achievements) {
+        usage.bytes += metrics::heapBytes(achievement.name()) + metrics::heapBytes(achievement.description()) +
+                       metrics::heapBytes(achievement.iconPath()) + metrics::heapBytes(achievement.conditions());
+    }
+    usage.bytes += metrics::nodeContainerBytes(m_snapshotEntries.size(),
+                                               sizeof(std::pair<const int, std::shared_ptr<const Achievement>>) +
+                                                   sizeof(Achievement));
+    for (const auto& [group, keys] : m_galleryIndex) {
+        usage.bytes += metrics::heapBytes(group) + metrics::heapBytes(keys);
     }
-    for (int id : it->second) {
-        auto entry = m_achievements.find(id);
-        if (entry != m_achievements.end()) {
-            result.push_back(entry->second);
+    using GalleryNode = std::pair<const std::string, std::vector<GalleryKey>>;
+    usage.bytes +=
+        metrics::nodeContainerBytes(m_galleryIndex.size(), sizeof(GalleryNode), m_galleryIndex.bucket_count()) +
+        metrics::nodeContainerBytes(m_galleryPlacement.size(), sizeof(std::pair<const int, GalleryPlacement>),
+                                    m_galleryPlacement.bucket_count());
+    using ConditionNode = std::pair<const std::string, std::vector<ConditionSlot>>;
+    for (const auto& [type, byMetadata] : m_conditionIndex) {
+        for (const auto& [metadata, subscribers] : byMetadata) {
+            usage.bytes += metrics::nodeContainerBytes(1, sizeof(ConditionNode)) + metrics::heapBytes(metadata) +
+                           metrics::heapBytes(subscribers);
         }
     }
-    return result;
+    for (const auto& subscribers : m_ruleIndex) {
+        usage.bytes += metrics::heapBytes(subscribers);
+    }
+    return usage;
 }
 
-std::optional<Achievement> AchievementManager::achievementById(int id) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_achievements.find(id);
-    if (it == m_achievements.end()) {
-        return std::nullopt;
+std::shared_ptr<const Achievement> AchievementManager::AchievementSet::find(int id) const {
+    if (indexById == nullptr) {
+        return nullptr;
     }
-    return it->second;
+    auto it = indexById->find(id);
+    return it == indexById->end() ? nullptr : items[it->second];
 }
 
+std::vector<int> AchievementManager::galleryPage(const std::string& group,
+                                                 std::size_t offset,
+                                                 std::size_t limit) const {
+    std::shared_lock<StateMutex> lock(m_mutex);
+    std::vector<int> ids;
+    auto it = m_galleryIndex.find(group);
+    if (it == m_galleryIndex.end() || offset >= it->second.size()) {
+        return ids;
+    }
+    const auto first = it->second.begin() + static_cast<std::ptrdiff_t>(offset);
+    const auto last = first + static_cast<std::ptrdiff_t>(std::min(limit, it->second.size() - offset));
+    ids.reserve(static_cast<std::size_t>(last - first));
+    for (auto entry = first; entry != last; ++entry) {
+        ids.push_back(entry->id);
+    }
+    return ids;
+}
+
+std::size_t AchievementManager::gallerySize(const std::string& group) const {
+    std::shared_lock<StateMutex> lock(m_mutex);
+    auto it = m_galleryIndex.find(group);
+    return it != m_galleryIndex.end() ? it->second.size() : 0;
+}
+
+std::shared_ptr<const Achievement> AchievementManager::achievementById(int id) const { return snapshot()->find(id); }
+
 int AchievementManager::createCustomAchievement(Achievement achievement) {
     if (!m_userManager.hasActiveUser()) {
         throw std::runtime_error("未登录无法创建成就");
     }
-    achievement.setOwner(m_userManager.activeUser().username());
-    achievement.setCreator(m_userManager.activeUser().username());
+    achievement.setOwnerId(m_userManager.activeUserId());
+    achievement.setCreatorId(m_userManager.activeUserId());
     achievement.setType(Achievement::Type::Custom);
     achievement.setCreatedAt(QDateTime::currentDateTimeUtc());
+    RuleCache compiled = prepareRuleConditions(achievement);
     if (!validateCustomAchievement(achievement)) {
         throw std::runtime_error("自定义成就校验失败");
     }
@@ -228,75 +332,103 @@ int AchievementManager::createCustomAchievement(Achievement achievement) {
     const int newId = m_database.createAchievement(record);
     achievement.setId(newId);
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        std::unique_lock<StateMutex> lock(m_mutex);
         m_achievements[newId] = achievement;
-        updateGalleryForAchievement(achievement);
+        placeInGalleryLocked(achievement);
+        countRewardQuota(achievement);
+        m_compiledRules.merge(compiled);
+        indexConditionsFor(achievement);
+        markSnapshotDirtyLocked(newId);
+        schedulePublishLocked();
     }
     return newId;
 }
 
 void AchievementManager::updateCustomAchievement(const Achievement& achievement) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_achievements.find(achievement.id());
-    if (it == m_achievements.end()) {
-        throw std::runtime_error("成就不存在");
-    }
-    if (it->second.type() == Achievement::Type::System) {
-        throw std::runtime_error("系统成就禁止修改");
-    }
+    // 中文：规则编译与序列化只读传入的副本，放在写事务与状态锁之外，不延长任何锁的持有时间。
     Achievement copy = achievement;
-    copy.setOwner(m_userManager.activeUser().username());
+    copy.setOwnerId(m_userManager.activeUserId());
+    RuleCache compiled = prepareRuleConditions(copy);
     copy.setConditionBlob(serializeConditions(copy.conditions()));
     copy.setRewardItemsBlob(serializeItems(copy.specialItems()));
     recalculateProgress(copy);
-    m_database.updateAchievement(toRecord(copy));
-    m_achievements[copy.id()] = copy;
-    rebuildGalleryIndex();
+    m_database.runInTransaction([&]() {
+        {
+            std::shared_lock<StateMutex> lock(m_mutex);
+            auto it = m_achievements.find(copy.id());
+            if (it == m_achievements.end()) {
+                throw std::runtime_error("成就不存在");
+            }
+            if (it->second.type() == Achievement::Type::System) {
+                throw std::runtime_error("系统成就禁止修改");
+            }
+        }
+        m_database.updateAchievement(toRecord(copy));
+        std::unique_lock<StateMutex> lock(m_mutex);
+        m_dirtyProgress.erase(copy.id());
+        const int id = copy.id();
+        m_achievements[id] = std::move(copy);
+        placeInGalleryLocked(m_achievements[id]);
+        rebuildRewardQuota();
+        m_compiledRules.merge(compiled);
+        rebuildConditionIndex();
+        markSnapshotDirtyLocked(id);
+        schedulePublishLocked();
+    });
 }
 
 void AchievementManager::deleteCustomAchievement(int achievementId) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_achievements.find(achievementId);
-    if (it == m_achievements.end()) {
-        return;
-    }
-    if (it->second.type() == Achievement::Type::System) {
-        throw std::runtime_error("系统成就禁止删除");
-    }
-    m_database.deleteAchievement(achievementId);
-    m_achievements.erase(it);
-    rebuildGalleryIndex();
+    m_database.runInTransaction([&]() {
+        {
+            std::shared_lock<StateMutex> lock(m_mutex);
+            auto it = m_achievements.find(achievementId);
+            if (it == m_achievements.end()) {
+                return;
+            }
+            if (it->second.type() == Achievement::Type::System) {
+                throw std::runtime_error("系统成就禁止删除");
+            }
+        }
+        m_database.deleteAchievement(achievementId);
+        std::unique_lock<StateMutex> lock(m_mutex);
+        m_achievements.erase(achievementId);
+        m_dirtyProgress.erase(achievementId);
+        removeFromGalleryLocked(achievementId);
+        rebuildRewardQuota();
+        rebuildConditionIndex();
+        markSnapshotDirtyLocked(achievementId);
+        schedulePublishLocked();
+    });
 }
 
 void AchievementManager::recordCustomProgress(int achievementId, int delta) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_achievements.find(achievementId);
-    if (it == m_achievements.end()) {
-        throw std::runtime_error("成就不存在");
-    }
-    updateConditionCache(it->second, Achievement::Condition::ConditionType::CustomCounter, delta, "");
-    if (recalculateProgress(it->second)) {
-        m_database.updateAchievement(toRecord(it->second));
-        emit achievementProgressChanged(it->second.id(), it->second.progressValue(), it->second.progressGoal());
-    }
-    evaluateCompletion(it->second);
+    mutateThenDeliver([&]() {
+        auto it = m_achievements.find(achievementId);
+        if (it == m_achievements.end()) {
+            throw std::runtime_error("成就不存在");
+        }
+        updateConditionCache(it->second, Achievement::Condition::ConditionType::CustomCounter, delta, "");
+        markSnapshotDirtyLocked(achievementId);
+        if (recalculateProgress(it->second)) {
+            markProgressDirtyLocked(it->second.id());
+            m_outbox.progress.push_back({it->second.id(), it->second.progressValue(), it->second.progressGoal()});
+        }
+        evaluateCompletion(it->second);
+    });
 }
 
-void AchievementManager::onTaskCompleted(int /*taskId*/, int taskType, int /*difficulty*/) {
+void AchievementManager::onTaskCompleted(int /*taskId*/, int taskType, int difficulty) {
+    ROVE_SCOPED_TIMER(Achievements, "onTaskCompleted");
     const Task::TaskType type = static_cast<Task::TaskType>(taskType);
-    std::lock_guard<std::mutex> lock(m_mutex);
-    for (auto& [id, achievement] : m_achievements) {
-        updateConditionCache(achievement, Achievement::Condition::ConditionType::CompleteAnyTask, 1, "");
-        updateConditionCache(achievement,
-                             Achievement::Condition::ConditionType::CompleteTaskType,
-                             1,
-                             Task::typeToString(type));
-        if (recalculateProgress(achievement)) {
-            m_database.updateAchievement(toRecord(achievement));
-            emit achievementProgressChanged(id, achievement.progressValue(), achievement.progressGoal());
-        }
-        evaluateCompletion(achievement);
-    }
+    const std::string typeName = Task::typeToString(type);
+    mutateThenDeliver([&]() {
+        dispatchConditionEventsLocked({{Achievement::Condition::ConditionType::CompleteAnyTask, "", 1, false},
+                                       {Achievement::Condition::ConditionType::CompleteTaskType, typeName, 1, false}});
+        RuleEvent event = ruleEventFor(RuleEvent::Kind::TaskCompleted);
+        event.taskType = taskType;
+        event.difficulty = difficulty;
+        dispatchRuleEventLocked(event);
+    });
 }
 
 void AchievementManager::onTaskProgressed(int /*taskId*/, int currentValue, int goalValue) {
@@ -304,33 +436,82 @@ void AchievementManager::onTaskProgressed(int /*taskId*/, int currentValue, int
         return;
     }
     const int clampedProgress = std::clamp(currentValue, 0, goalValue);
-    std::lock_guard<std::mutex> lock(m_mutex);
-    for (auto& [id, achievement] : m_achievements) {
-        replaceConditionValue(achievement,
-                              Achievement::Condition::ConditionType::CustomCounter,
-                              clampedProgress,
-                              "task_progress");
-        if (recalculateProgress(achievement)) {
-            m_database.updateAchievement(toRecord(achievement));
-            emit achievementProgressChanged(id, achievement.progressValue(), achievement.progressGoal());
-        }
-        evaluateCompletion(achievement);
-    }
+    mutateThenDeliver([&]() {
+        dispatchConditionEventsLocked(
+            {{Achievement::Condition::ConditionType::CustomCounter, "task_progress", clampedProgress, true}});
+    });
 }
 
 void AchievementManager::onUserLevelChanged(int newLevel) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    handleUserLevelChangedLocked(newLevel);
+    mutateThenDeliver([&]() { handleUserLevelChangedLocked(newLevel); });
 }
 
 void AchievementManager::onPrideChanged(int newPride) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    handlePrideChangedLocked(newPride);
+    mutateThenDeliver([&]() { handlePrideChangedLocked(newPride); });
 }
 
 void AchievementManager::onCoinsChanged(int newCoins) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    handleCoinsChangedLocked(newCoins);
+    mutateThenDeliver([&]() { handleCoinsChangedLocked(newCoins); });
+}
+
+/**
+ * @brief 持锁修改内存状态，释放锁后再落盘与发信号。
+ * 中文：mutate 中途抛出异常时，已累积的副作用仍会交付（缓存里已生效的解锁不能漏写），随后再透传异常。
+ */
+void AchievementManager::mutateThenDeliver(const std::function<void()>& mutate) {
+    Outbox outbox;
+    std::exception_ptr failure;
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        try {
+            mutate();
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        schedulePublishLocked();
+        outbox = std::exchange(m_outbox, Outbox{});
+    }
+    deliver(std::move(outbox));
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+/**
+ * @brief 锁外执行副作用：解锁记录与用户成就计数在一个事务内写入，随后按需刷写进度并发出信号。
+ * 中文：写入失败时解锁状态已在缓存中生效，把这些成就转入脏集合，由下一次刷写重试整行写入。
+ */
+void AchievementManager::deliver(Outbox outbox) {
+    if (!outbox.unlockedRecords.empty() || outbox.userUnlocks > 0) {
+        try {
+            m_database.runInTransaction([&]() {
+                for (int i = 0; i < outbox.userUnlocks; ++i) {
+                    m_userManager.unlockAchievement();
+                }
+                m_database.updateAchievements(outbox.unlockedRecords);
+            });
+        } catch (...) {
+            std::unique_lock<StateMutex> lock(m_mutex);
+            m_dirtyProgress.insert(outbox.unlockedIds.begin(), outbox.unlockedIds.end());
+            throw;
+        }
+    }
+    if (outbox.flushDue) {
+        flushPendingProgress();
+    }
+    if (outbox.progress.empty() && outbox.unlockedIds.empty()) {
+        return;
+    }
+    // 中文：并入外层事务（例如 UnitOfWork）时等到外层提交再通知，外层回滚则不通知。
+    m_database.runAfterCommit(
+        [this, progress = std::move(outbox.progress), unlockedIds = std::move(outbox.unlockedIds)]() {
+            for (const auto& entry : progress) {
+                emit achievementProgressChanged(entry.achievementId, entry.value, entry.goal);
+            }
+            for (int id : unlockedIds) {
+                emit achievementUnlocked(id);
+            }
+        });
 }
 
 /**
@@ -339,80 +520,261 @@ void AchievementManager::onCoinsChanged(int newCoins) {
  *       都调用本方法，在同一把锁下完成条件刷新与解锁判定。
  */
 void AchievementManager::handleUserLevelChangedLocked(int newLevel) {
-    for (auto& [id, achievement] : m_achievements) {
-        replaceConditionValue(achievement,
-                              Achievement::Condition::ConditionType::ReachLevel,
-                              newLevel,
-                              "");
-        if (recalculateProgress(achievement)) {
-            m_database.updateAchievement(toRecord(achievement));
-            emit achievementProgressChanged(id, achievement.progressValue(), achievement.progressGoal());
-        }
-        evaluateCompletion(achievement);
-    }
+    dispatchConditionEventsLocked({{Achievement::Condition::ConditionType::ReachLevel, "", newLevel, true}});
+    RuleEvent event = ruleEventFor(RuleEvent::Kind::LevelChanged);
+    event.level = newLevel;
+    dispatchRuleEventLocked(event);
 }
 
 /**
  * @brief 自豪感变更的共享处理逻辑，调用时需确保互斥锁已锁定。
  */
 void AchievementManager::handlePrideChangedLocked(int newPride) {
-    for (auto& [id, achievement] : m_achievements) {
-        replaceConditionValue(achievement,
-                              Achievement::Condition::ConditionType::ReachPride,
-                              newPride,
-                              "");
-        if (recalculateProgress(achievement)) {
-            m_database.updateAchievement(toRecord(achievement));
-            emit achievementProgressChanged(id, achievement.progressValue(), achievement.progressGoal());
-        }
-        evaluateCompletion(achievement);
-    }
+    dispatchConditionEventsLocked({{Achievement::Condition::ConditionType::ReachPride, "", newPride, true}});
+    RuleEvent event = ruleEventFor(RuleEvent::Kind::PrideChanged);
+    event.pride = newPride;
+    dispatchRuleEventLocked(event);
 }
 
 /**
  * @brief 兰州币余额变动的共享处理逻辑，调用前同样需要持有互斥锁。
  */
 void AchievementManager::handleCoinsChangedLocked(int newCoins) {
-    for (auto& [id, achievement] : m_achievements) {
-        replaceConditionValue(achievement,
-                              Achievement::Condition::ConditionType::ReachCoins,
-                              newCoins,
-                              "");
+    dispatchConditionEventsLocked({{Achievement::Condition::ConditionType::ReachCoins, "", newCoins, true}});
+    RuleEvent event = ruleEventFor(RuleEvent::Kind::CoinsChanged);
+    event.coins = newCoins;
+    dispatchRuleEventLocked(event);
+}
+
+/**
+ * @brief 条件事件分发：经倒排索引只触达订阅了该事件的成就，记入脏集合并判定解锁。
+ * 中文：元数据匹配规则与逐个扫描时一致——事件或条件任一方元数据为空即视为匹配；
+ *       同一成就被多个事件命中时只重新序列化一次条件，进度变化交由 flushPendingProgress
+ *       合并写回，进度信号与解锁写入记入 m_outbox。调用方需持有 m_mutex 独占锁。
+ */
+void AchievementManager::dispatchConditionEventsLocked(const std::vector<ConditionEvent>& events) {
+    std::vector<int> touchedIds;
+    auto apply = [&](const ConditionEvent& event, const std::vector<ConditionSlot>& subscribers) {
+        for (const auto& slot : subscribers) {
+            auto it = m_achievements.find(slot.achievementId);
+            if (it == m_achievements.end() || slot.conditionIndex >= it->second.conditions().size()) {
+                continue;
+            }
+            auto& condition = it->second.conditions()[slot.conditionIndex];
+            const int next = event.absolute ? event.value : condition.currentValue + event.value;
+            condition.currentValue = std::clamp(next, 0, condition.targetValue);
+            if (std::find(touchedIds.begin(), touchedIds.end(), slot.achievementId) == touchedIds.end()) {
+                touchedIds.push_back(slot.achievementId);
+            }
+        }
+    };
+    for (const auto& event : events) {
+        if (!event.absolute && event.value == 0) {
+            continue;
+        }
+        auto byType = m_conditionIndex.find(event.type);
+        if (byType == m_conditionIndex.end()) {
+            continue;
+        }
+        if (event.metadata.empty()) {
+            for (const auto& [metadata, subscribers] : byType->second) {
+                apply(event, subscribers);
+            }
+            continue;
+        }
+        if (auto wildcard = byType->second.find(std::string()); wildcard != byType->second.end()) {
+            apply(event, wildcard->second);
+        }
+        if (auto exact = byType->second.find(event.metadata); exact != byType->second.end()) {
+            apply(event, exact->second);
+        }
+    }
+    ROVE_COUNTER_ADD(Achievements, "dispatch.touched", touchedIds.size());
+    settleTouchedLocked(touchedIds);
+}
+
+/**
+ * @brief 规则事件分发：只遍历订阅了该事件类型的规则，执行预先编译的字节码，不解析文本。
+ */
+void AchievementManager::dispatchRuleEventLocked(const RuleEvent& event) {
+    const auto& subscribers = m_ruleIndex[static_cast<std::size_t>(event.kind)];
+    if (subscribers.empty()) {
+        return;
+    }
+    std::vector<int> touchedIds;
+    std::size_t evaluated = 0;
+    for (const auto& slot : subscribers) {
+        auto it = m_achievements.find(slot.achievementId);
+        if (it == m_achievements.end() || it->second.unlocked() ||
+            slot.conditionIndex >= it->second.conditions().size()) {
+            continue;
+        }
+        ++evaluated;
+        if (slot.rule->apply(event, it->second.conditions()[slot.conditionIndex]) &&
+            std::find(touchedIds.begin(), touchedIds.end(), slot.achievementId) == touchedIds.end()) {
+            touchedIds.push_back(slot.achievementId);
+        }
+    }
+    ROVE_COUNTER_ADD(Achievements, "rules.evaluated", evaluated);
+    settleTouchedLocked(touchedIds);
+}
+
+RuleEvent AchievementManager::ruleEventFor(RuleEvent::Kind kind) const {
+    RuleEvent event;
+    event.kind = kind;
+    event.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    if (m_userManager.hasActiveUser()) {
+        const User& user = m_userManager.activeUser();
+        event.level = user.level();
+        event.coins = user.coins();
+        event.pride = user.attributes().pride;
+    }
+    return event;
+}
+
+/**
+ * @brief 条件内容变化即记入脏集合：规则的窗口命中可能在进度不变时推移，同样需要写回。
+ */
+void AchievementManager::settleTouchedLocked(const std::vector<int>& touchedIds) {
+    for (int id : touchedIds) {
+        Achievement& achievement = m_achievements.at(id);
+        markSnapshotDirtyLocked(id);
+        achievement.setConditionBlob(serializeConditions(achievement.conditions()));
+        markProgressDirtyLocked(id);
         if (recalculateProgress(achievement)) {
-            m_database.updateAchievement(toRecord(achievement));
-            emit achievementProgressChanged(id, achievement.progressValue(), achievement.progressGoal());
+            m_outbox.progress.push_back({id, achievement.progressValue(), achievement.progressGoal()});
         }
-        evaluateCompletion(achievement);
+    }
+    for (int id : touchedIds) {
+        evaluateCompletion(m_achievements.at(id));
     }
 }
 
-void AchievementManager::ensureSystemAchievements() {
-    const std::string owner = m_userManager.activeUser().username();
-    const auto templates = buildSystemTemplates(owner);
-    for (auto templ : templates) {
-        bool exists = false;
-        for (const auto& [id, achievement] : m_achievements) {
-            if (achievement.type() == Achievement::Type::System && achievement.name() == templ.name()) {
-                exists = true;
-                break;
+/**
+ * @brief 重建条件倒排索引，成就集合或条件结构变化后调用。
+ */
+void AchievementManager::rebuildConditionIndex() {
+    m_conditionIndex.clear();
+    for (auto& subscribers : m_ruleIndex) {
+        subscribers.clear();
+    }
+    RuleCache previous;
+    previous.swap(m_compiledRules);
+    for (const auto& [id, achievement] : m_achievements) {
+        indexConditionsFor(achievement, &previous);
+    }
+}
+
+void AchievementManager::indexConditionsFor(const Achievement& achievement, RuleCache* previous) {
+    const auto& conditions = achievement.conditions();
+    for (std::size_t i = 0; i < conditions.size(); ++i) {
+        if (conditions[i].type != Achievement::Condition::ConditionType::Rule) {
+            m_conditionIndex[conditions[i].type][conditions[i].metadata].push_back({achievement.id(), i});
+            continue;
+        }
+        const auto rule = ruleForLocked(conditions[i].metadata, previous);
+        if (rule == nullptr) {
+            continue;
+        }
+        for (std::size_t kind = 0; kind < AchievementRule::kEventKindCount; ++kind) {
+            if (rule->subscribes(static_cast<RuleEvent::Kind>(kind))) {
+                m_ruleIndex[kind].push_back({achievement.id(), i, rule});
             }
         }
+    }
+}
+
+std::shared_ptr<const AchievementRule> AchievementManager::ruleForLocked(const std::string& source,
+                                                                         RuleCache* previous) {
+    if (auto it = m_compiledRules.find(source); it != m_compiledRules.end()) {
+        return it->second;
+    }
+    if (previous != nullptr) {
+        if (auto it = previous->find(source); it != previous->end()) {
+            return m_compiledRules.emplace(source, std::move(it->second)).first->second;
+        }
+    }
+    try {
+        return m_compiledRules.emplace(source, AchievementRule::compile(source)).first->second;
+    } catch (const std::exception& error) {
+        qWarning() << "成就规则无法编译，已忽略:" << QString::fromStdString(source) << error.what();
+        return nullptr;
+    }
+}
+
+/**
+ * @brief 在锁外编译规则（编译只读源码，不触碰共享状态），目标值以规则为准。
+ */
+AchievementManager::RuleCache AchievementManager::prepareRuleConditions(Achievement& achievement) const {
+    RuleCache compiled;
+    for (auto& condition : achievement.conditions()) {
+        if (condition.type != Achievement::Condition::ConditionType::Rule) {
+            continue;
+        }
+        auto& rule = compiled[condition.metadata];
+        if (rule == nullptr) {
+            rule = AchievementRule::compile(condition.metadata);
+        }
+        condition.targetValue = rule->target();
+        condition.currentValue = std::clamp(condition.currentValue, 0, condition.targetValue);
+        if (!rule->counting() && !rule->subscribes(RuleEvent::Kind::TaskCompleted)) {
+            rule->apply(ruleEventFor(RuleEvent::Kind::LevelChanged), condition);
+        }
+    }
+    return compiled;
+}
+
+/**
+ * @brief 标记成就进度待写回：达到批量上限时请求 deliver 立即刷写，否则确保刷写定时器已启动。
+ * 中文：QTimer 只能在所属线程启停，在其他线程（命令执行器的数据线程）调用时排队到定时器线程执行。
+ */
+void AchievementManager::markProgressDirtyLocked(int achievementId) {
+    m_dirtyProgress.insert(achievementId);
+    if (m_dirtyProgress.size() >= kProgressFlushBatchSize) {
+        m_outbox.flushDue = true;
+        return;
+    }
+    QMetaObject::invokeMethod(m_flushTimer.get(), [timer = m_flushTimer.get()]() {
+        if (!timer->isActive()) {
+            timer->start();
+        }
+    });
+}
+
+/**
+ * @brief 为尚未入库的系统成就模板建行，多条模板在同一事务内插入；achievements 为刷新中尚未发布的缓存。
+ */
+void AchievementManager::ensureSystemAchievements(std::unordered_map<int, Achievement>& achievements) {
+    std::vector<Achievement> missing;
+    for (auto& templ : buildSystemTemplates(m_userManager.activeUserId())) {
+        const bool exists = std::any_of(achievements.begin(), achievements.end(), [&templ](const auto& entry) {
+            return entry.second.type() == Achievement::Type::System && entry.second.name() == templ.name();
+        });
         if (!exists) {
             templ.setConditionBlob(serializeConditions(templ.conditions()));
             templ.setRewardItemsBlob(serializeItems(templ.specialItems()));
-            const int newId = m_database.createAchievement(toRecord(templ));
-            templ.setId(newId);
-            m_achievements[newId] = templ;
+            missing.push_back(std::move(templ));
         }
     }
+    if (missing.empty()) {
+        return;
+    }
+    m_database.runInTransaction([&]() {
+        for (auto& templ : missing) {
+            templ.setId(m_database.createAchievement(toRecord(templ)));
+        }
+    });
+    for (auto& templ : missing) {
+        const int id = templ.id();
+        achievements[id] = std::move(templ);
+    }
 }
 
-std::vector<Achievement> AchievementManager::buildSystemTemplates(const std::string& owner) const {
+std::vector<Achievement> AchievementManager::buildSystemTemplates(int ownerId) const {
     std::vector<Achievement> templates;
 
     Achievement newbie;
-    newbie.setOwner(owner);
-    newbie.setCreator("system");
+    newbie.setOwnerId(ownerId);
     newbie.setType(Achievement::Type::System);
     newbie.setRewardType(Achievement::RewardType::WithReward);
     newbie.setProgressMode(Achievement::ProgressMode::Milestone);
@@ -432,8 +794,7 @@ std::vector<Achievement> AchievementManager::buildSystemTemplates(const std::str
     templates.push_back(newbie);
 
     Achievement pride;
-    pride.setOwner(owner);
-    pride.setCreator("system");
+    pride.setOwnerId(ownerId);
     pride.setType(Achievement::Type::System);
     pride.setRewardType(Achievement::RewardType::WithReward);
     pride.setProgressMode(Achievement::ProgressMode::Incremental);
@@ -454,8 +815,7 @@ std::vector<Achievement> AchievementManager::buildSystemTemplates(const std::str
     templates.push_back(pride);
 
     Achievement taskHunter;
-    taskHunter.setOwner(owner);
-    taskHunter.setCreator("system");
+    taskHunter.setOwnerId(ownerId);
     taskHunter.setType(Achievement::Type::System);
     taskHunter.setRewardType(Achievement::RewardType::NoReward);
     taskHunter.setProgressMode(Achievement::ProgressMode::Incremental);
@@ -471,8 +831,7 @@ std::vector<Achievement> AchievementManager::buildSystemTemplates(const std::str
     templates.push_back(taskHunter);
 
     Achievement weeklyStar;
-    weeklyStar.setOwner(owner);
-    weeklyStar.setCreator("system");
+    weeklyStar.setOwnerId(ownerId);
     weeklyStar.setType(Achievement::Type::System);
     weeklyStar.setRewardType(Achievement::RewardType::WithReward);
     weeklyStar.setProgressMode(Achievement::ProgressMode::Incremental);
@@ -496,26 +855,29 @@ std::vector<Achievement> AchievementManager::buildSystemTemplates(const std::str
     return templates;
 }
 
-Achievement AchievementManager::hydrateAchievement(const DatabaseManager::AchievementRecord& record) const {
+/**
+ * @brief 解析记录为成就对象：需要保留的字符串直接移走，颜色、枚举与时间文本只读取解析，留在记录中供下一行复用。
+ */
+Achievement AchievementManager::hydrateAchievement(DatabaseManager::AchievementRecord&& record) const {
     Achievement achievement;
     achievement.setId(record.id);
-    achievement.setOwner(record.owner);
-    achievement.setCreator(record.creator);
-    achievement.setName(record.name);
-    achievement.setDescription(record.description);
-    achievement.setIconPath(record.iconPath);
+    achievement.setOwnerId(record.ownerId);
+    achievement.setCreatorId(record.creatorId);
+    achievement.setName(std::move(record.name));
+    achievement.setDescription(std::move(record.description));
+    achievement.setIconPath(std::move(record.iconPath));
     achievement.setDisplayColor(QColor(record.color.c_str()));
     achievement.setType(typeFromText(record.type));
     achievement.setRewardType(rewardTypeFromText(record.rewardType));
     achievement.setProgressMode(progressModeFromText(record.progressMode));
     achievement.setConditions(deserializeConditions(record.conditions));
-    achievement.setConditionBlob(record.conditions);
+    achievement.setConditionBlob(std::move(record.conditions));
     achievement.setProgressValue(record.progressValue);
     achievement.setProgressGoal(record.progressGoal);
     achievement.setRewardCoins(record.rewardCoins);
-    achievement.setRewardAttributes(deserializeAttributes(record.rewardAttributes));
+    achievement.setRewardAttributes(record.rewardAttributes);
     achievement.setSpecialItems(deserializeItems(record.rewardItems));
-    achievement.setRewardItemsBlob(record.rewardItems);
+    achievement.setRewardItemsBlob(std::move(record.rewardItems));
     achievement.setUnlocked(record.unlocked);
     if (!record.completionTime.empty()) {
         achievement.setCompletedAt(QDateTime::fromString(QString::fromStdString(record.completionTime), Qt::ISODate));
@@ -523,16 +885,16 @@ Achievement AchievementManager::hydrateAchievement(const DatabaseManager::Achiev
     if (!record.createdAt.empty()) {
         achievement.setCreatedAt(QDateTime::fromString(QString::fromStdString(record.createdAt), Qt::ISODate));
     }
-    achievement.setGalleryGroup(record.galleryGroup);
-    achievement.setSpecialMetadata(record.specialMetadata);
+    achievement.setGalleryGroup(std::move(record.galleryGroup));
+    achievement.setSpecialMetadata(std::move(record.specialMetadata));
     return achievement;
 }
 
 DatabaseManager::AchievementRecord AchievementManager::toRecord(const Achievement& achievement) const {
     DatabaseManager::AchievementRecord record;
     record.id = achievement.id();
-    record.owner = achievement.owner();
-    record.creator = achievement.creator();
+    record.ownerId = achievement.ownerId();
+    record.creatorId = achievement.creatorId();
     record.name = achievement.name();
     record.description = achievement.description();
     record.iconPath = achievement.iconPath();
@@ -545,7 +907,7 @@ DatabaseManager::AchievementRecord AchievementManager::toRecord(const Achievemen
     record.progressValue = achievement.progressValue();
     record.progressGoal = achievement.progressGoal();
     record.rewardCoins = achievement.rewardCoins();
-    record.rewardAttributes = serializeAttributes(achievement.rewardAttributes());
+    record.rewardAttributes = achievement.rewardAttributes();
     record.rewardItems = achievement.rewardItemsBlob().empty() ? serializeItems(achievement.specialItems())
                                                               : achievement.rewardItemsBlob();
     record.unlocked = achievement.unlocked();
@@ -583,9 +945,12 @@ void AchievementManager::evaluateCompletion(Achievement& achievement) {
     }
     achievement.setUnlocked(true);
     achievement.setCompletedAt(QDateTime::currentDateTimeUtc());
+    placeInGalleryLocked(achievement);
     grantRewards(achievement);
-    m_database.updateAchievement(toRecord(achievement));
-    emit achievementUnlocked(achievement.id());
+    // 解锁必须同步落盘：整行记录交由 deliver 在释放锁后写入，已包含最新进度，因此顺带清除该成就的脏标记。
+    m_outbox.unlockedRecords.push_back(toRecord(achievement));
+    m_outbox.unlockedIds.push_back(achievement.id());
+    m_dirtyProgress.erase(achievement.id());
 }
 
 /**
@@ -598,24 +963,27 @@ void AchievementManager::grantRewards(Achievement& achievement) {
         return;
     }
     if (achievement.rewardType() == Achievement::RewardType::NoReward) {
-        m_userManager.unlockAchievement();
+        ++m_outbox.userUnlocks;
         return;
     }
-    User& user = m_userManager.activeUser();
-    const int beforeLevel = user.level();
-    const int previousCoins = user.coins();
-    user.addCoins(achievement.rewardCoins());
-    const int previousPride = user.attributes().pride;
-    user.applyAttributeBonus(achievement.rewardAttributes());
-    m_userManager.unlockAchievement();
-    if (beforeLevel != user.level()) {
-        handleUserLevelChangedLocked(user.level());
+    // 中文：奖励只改内存中的当前用户，随 deliver 中的 unlockAchievement 一并保存。
+    ProgressionState before;
+    ProgressionState after;
+    m_userManager.mutateActiveUser([&](User& user) {
+        before = ProgressionState::of(user);
+        user.addCoins(achievement.rewardCoins());
+        user.applyAttributeBonus(achievement.rewardAttributes());
+        after = ProgressionState::of(user);
+    });
+    ++m_outbox.userUnlocks;
+    if (before.level != after.level) {
+        handleUserLevelChangedLocked(after.level);
     }
-    if (previousPride != user.attributes().pride) {
-        handlePrideChangedLocked(user.attributes().pride);
+    if (before.attributes.pride != after.attributes.pride) {
+        handlePrideChangedLocked(after.attributes.pride);
     }
-    if (user.coins() != previousCoins) {
-        handleCoinsChangedLocked(user.coins());
+    if (after.coins != before.coins) {
+        handleCoinsChangedLocked(after.coins);
     }
 }
 
@@ -629,7 +997,7 @@ bool AchievementManager::validateCustomAchievement(const Achievement& achievemen
         }
     }
     if (achievement.rewardType() == Achievement::RewardType::WithReward) {
-        const int used = countRewardAchievementsThisMonth(achievement.owner());
+        const int used = countRewardAchievementsThisMonth(achievement.ownerId());
         if (used >= 2) {
             throw std::runtime_error("本月奖励型自定义成就已达上限");
         }
@@ -637,25 +1005,210 @@ bool AchievementManager::validateCustomAchievement(const Achievement& achievemen
     return true;
 }
 
+AchievementManager::GalleryKey AchievementManager::galleryKeyFor(const Achievement& achievement) {
+    GalleryKey key;
+    key.locked = !achievement.unlocked();
+    key.completedMs = achievement.unlocked() && achievement.completedAt().isValid()
+                          ? achievement.completedAt().toMSecsSinceEpoch()
+                          : 0;
+    key.id = achievement.id();
+    return key;
+}
+
+/**
+ * @brief 整体装载后重建画廊：逐组追加后各排序一次，O(n log n)；之后的变更都走增量路径。
+ */
 void AchievementManager::rebuildGalleryIndex() {
     m_galleryIndex.clear();
+    m_galleryPlacement.clear();
     for (const auto& [id, achievement] : m_achievements) {
-        updateGalleryForAchievement(achievement);
+        const GalleryKey key = galleryKeyFor(achievement);
+        m_galleryIndex[achievement.galleryGroup()].push_back(key);
+        m_galleryPlacement[id] = GalleryPlacement{achievement.galleryGroup(), key};
+    }
+    for (auto& [group, entries] : m_galleryIndex) {
+        std::sort(entries.begin(), entries.end());
+    }
+}
+
+/**
+ * @brief 增量维护：有序数组上二分定位后插入，单次变更只移动该组内的 id，不再整表重建。
+ */
+void AchievementManager::placeInGalleryLocked(const Achievement& achievement) {
+    const GalleryKey key = galleryKeyFor(achievement);
+    if (auto placed = m_galleryPlacement.find(achievement.id()); placed != m_galleryPlacement.end()) {
+        if (placed->second.group == achievement.galleryGroup() && placed->second.key == key) {
+            return;
+        }
+        removeFromGalleryLocked(achievement.id());
+    }
+    auto& entries = m_galleryIndex[achievement.galleryGroup()];
+    entries.insert(std::lower_bound(entries.begin(), entries.end(), key), key);
+    m_galleryPlacement[achievement.id()] = GalleryPlacement{achievement.galleryGroup(), key};
+}
+
+void AchievementManager::removeFromGalleryLocked(int achievementId) {
+    auto placed = m_galleryPlacement.find(achievementId);
+    if (placed == m_galleryPlacement.end()) {
+        return;
+    }
+    if (auto group = m_galleryIndex.find(placed->second.group); group != m_galleryIndex.end()) {
+        auto& entries = group->second;
+        auto it = std::lower_bound(entries.begin(), entries.end(), placed->second.key);
+        if (it != entries.end() && *it == placed->second.key) {
+            entries.erase(it);
+        }
+        if (entries.empty()) {
+            m_galleryIndex.erase(group);
+        }
+    }
+    m_galleryPlacement.erase(placed);
+}
+
+/**
+ * @brief 月度配额校验：成就缓存已装载的用户在共享锁内 O(1) 查表，无需每次按创建时间扫描成就表。
+ * 中文：计数随缓存同步维护，装载、修改、删除时整体重建，创建时增量累加；
+ *       查询其他用户（缓存未装载）时才回退到 countCustomRewardAchievements。
+ */
+int AchievementManager::countRewardAchievementsThisMonth(int ownerId) const {
+    const QDate today = QDate::currentDate();
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        if (ownerId == m_loadedOwner) {
+            const auto it = m_rewardQuota.find(monthKey(today));
+            return it != m_rewardQuota.end() ? it->second : 0;
+        }
+    }
+    return m_database.countCustomRewardAchievements(ownerId, today.toString("yyyy-MM").toStdString());
+}
+
+/**
+ * @brief 记入脏集合；处于事务中时同时保存该成就在本事务内首次改动前的版本，供回滚时恢复。
+ * 中文：事务外的改动当即发布，事务内的发布推迟到提交前，因此本事务首次改动某成就时 m_snapshotEntries 中的条目
+ *       就是改动前的版本（新建的成就没有条目，回滚时删除），只需保存共享指针，不复制成就。
+ *       本事务首次登记回滚回调时清空上一个事务遗留的记录。
+ */
+void AchievementManager::markSnapshotDirtyLocked(int achievementId) {
+    m_snapshotDirty.insert(achievementId);
+    if (!m_database.inTransaction()) {
+        return;
+    }
+    if (m_database.runOnRollback(this, [this]() { restoreAfterRollback(); })) {
+        m_rollbackOriginals.clear();
+    }
+    const auto published = m_snapshotEntries.find(achievementId);
+    m_rollbackOriginals.try_emplace(achievementId,
+                                    published != m_snapshotEntries.end() ? published->second : nullptr);
+}
+
+/**
+ * @brief 外层事务回滚后恢复本事务改动过的成就，重建画廊、配额与条件索引并发布快照。
+ * 中文：解锁信号与进度通知经 runAfterCommit 登记，已随回滚丢弃；脏集合保留，下一次刷写写回的是恢复后的版本。
+ */
+void AchievementManager::restoreAfterRollback() {
+    std::unique_lock<StateMutex> lock(m_mutex);
+    for (auto& [id, original] : std::exchange(m_rollbackOriginals, {})) {
+        if (original != nullptr) {
+            m_achievements.insert_or_assign(id, *original);
+        } else {
+            m_achievements.erase(id);
+            m_dirtyProgress.erase(id);
+        }
+        m_snapshotDirty.insert(id);
+    }
+    rebuildGalleryIndex();
+    rebuildRewardQuota();
+    rebuildConditionIndex();
+    publishSnapshotLocked();
+}
+
+/**
+ * @brief RCU 式发布：在独占锁内基于上一版本构建新集合，再以 std::atomic_store 替换指针。
+ * 中文：脏成就复制一份新的不可变对象，其余条目直接复用上一版本的 shared_ptr，因此一次进度事件只深拷贝被触达的成就；
+ *       成员集合不变（只有进度、解锁等字段变化）时复制指针数组、替换脏槽位并共享上一版本的 id 索引；
+ *       有成就新增或删除时才按 id 顺序重建数组与索引。旧快照由仍持有它的读者在释放时回收。
+ */
+void AchievementManager::publishSnapshotLocked() {
+    if (!m_snapshotRebuild && m_snapshotDirty.empty()) {
+        return;
+    }
+    const std::shared_ptr<const AchievementSet> previous = m_snapshot;  // 中文：只有持独占锁的写者替换该指针。
+    bool membershipChanged = m_snapshotRebuild || previous == nullptr || previous->indexById == nullptr;
+    if (m_snapshotRebuild) {
+        m_snapshotEntries.clear();
+        for (const auto& [id, achievement] : m_achievements) {
+            m_snapshotEntries.emplace(id, std::make_shared<const Achievement>(achievement));
+        }
+    } else {
+        for (int id : m_snapshotDirty) {
+            if (auto it = m_achievements.find(id); it != m_achievements.end()) {
+                const bool inserted =
+                    m_snapshotEntries.insert_or_assign(id, std::make_shared<const Achievement>(it->second)).second;
+                membershipChanged = membershipChanged || inserted;
+            } else {
+                membershipChanged = membershipChanged || m_snapshotEntries.erase(id) > 0;
+            }
+        }
+    }
+
+    auto next = std::make_shared<AchievementSet>();
+    next->version = ++m_snapshotVersion;
+    if (membershipChanged) {
+        auto index = std::make_shared<std::unordered_map<int, std::size_t>>();
+        next->items.reserve(m_snapshotEntries.size());
+        index->reserve(m_snapshotEntries.size());
+        for (const auto& [id, achievement] : m_snapshotEntries) {
+            index->emplace(id, next->items.size());
+            next->items.push_back(achievement);
+        }
+        next->indexById = std::move(index);
+    } else {
+        next->items = previous->items;
+        next->indexById = previous->indexById;
+        for (int id : m_snapshotDirty) {
+            next->items[next->indexById->at(id)] = m_snapshotEntries.at(id);
+        }
     }
+    m_snapshotDirty.clear();
+    m_snapshotRebuild = false;
+    std::atomic_store(&m_snapshot, std::shared_ptr<const AchievementSet>(std::move(next)));
 }
 
-void AchievementManager::updateGalleryForAchievement(const Achievement& achievement) {
-    auto& slot = m_galleryIndex[achievement.galleryGroup()];
-    if (std::find(slot.begin(), slot.end(), achievement.id()) == slot.end()) {
-        slot.push_back(achievement.id());
+/**
+ * 中文：推迟的发布在提交前、仍持有写连接时执行，锁顺序与其他路径一致（数据库 → m_mutex）；
+ *       事务回滚时推迟的发布被丢弃，由 restoreAfterRollback 恢复缓存后发布。
+ */
+void AchievementManager::schedulePublishLocked() {
+    if (!m_database.inTransaction()) {
+        publishSnapshotLocked();
+        return;
     }
+    m_database.deferUntilCommit(&m_snapshot, [this]() {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        publishSnapshotLocked();
+    });
 }
 
-int AchievementManager::countRewardAchievementsThisMonth(const std::string& owner) const {
-    const QString monthToken = QDate::currentDate().toString("yyyy-MM");
-    return m_database.countCustomRewardAchievements(owner, monthToken.toStdString());
+void AchievementManager::rebuildRewardQuota() {
+    m_rewardQuota.clear();
+    for (const auto& [id, achievement] : m_achievements) {
+        countRewardQuota(achievement);
+    }
 }
 
+/**
+ * @brief 奖励型自定义成就按本地时间的创建月份计入配额，与校验时取本地当前月份的口径一致。
+ */
+void AchievementManager::countRewardQuota(const Achievement& achievement) {
+    if (achievement.type() != Achievement::Type::Custom ||
+        achievement.rewardType() != Achievement::RewardType::WithReward || !achievement.createdAt().isValid()) {
+        return;
+    }
+    ++m_rewardQuota[monthKey(achievement.createdAt().toLocalTime().date())];
+}
+
+int AchievementManager::monthKey(const QDate& date) noexcept { return date.year() * 100 + date.month(); }
+
 void AchievementManager::updateConditionCache(Achievement& achievement,
                                               Achievement::Condition::ConditionType type,
                                               int delta,
@@ -675,21 +1228,5 @@ void AchievementManager::updateConditionCache(Achievement& achievement,
     achievement.setConditionBlob(serializeConditions(achievement.conditions()));
 }
 
-void AchievementManager::replaceConditionValue(Achievement& achievement,
-                                               Achievement::Condition::ConditionType type,
-                                               int value,
-                                               const std::string& metadata) {
-    for (auto& condition : achievement.conditions()) {
-        if (condition.type != type) {
-            continue;
-        }
-        if (!metadata.empty() && !condition.metadata.empty() && metadata != condition.metadata) {
-            continue;
-        }
-        condition.currentValue = std::clamp(value, 0, condition.targetValue);
-    }
-    achievement.setConditionBlob(serializeConditions(achievement.conditions()));
-}
-
 }  // namespace rove::data
 
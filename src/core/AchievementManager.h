@@ -1,16 +1,28 @@
 #ifndef ACHIEVEMENTMANAGER_H
 #define ACHIEVEMENTMANAGER_H
 
+#include <QDate>
 #include <QObject>
+#include <QTimer>
 
-#include <mutex>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
 #include <optional>
+#include <shared_mutex>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "Achievement.h"
+#include "AchievementRule.h"
 #include "DatabaseManager.h"
+#include "MemoryAccounting.h"
+#include "Metrics.h"
 #include "TaskManager.h"
 #include "UserManager.h"
 
@@ -20,16 +32,39 @@ namespace rove::data {
  * @class AchievementManager
  * @brief 成就系统单例，负责以下事项：
  * 1. 成就分类：系统成就模板 + 学生自定义成就（含奖励型与非奖励型）。
- * 2. 条件检测：通过 Qt 信号槽监听 TaskManager 与 UserManager 的事件，实现事件驱动的完成判定。
+ * 2. 条件检测：通过 Qt 信号槽监听 TaskManager 与 UserManager 的事件，实现事件驱动的完成判定；
+ *    自定义规则条件在创建与装载时编译一次（AchievementRule），按所依赖的事件类型登记，只在相关事件发生时求值。
  * 3. 进度追踪：多条件累计进度 -> 统一换算为 progressValue/progressGoal，供 UI 展示进度条。
- * 4. 成就画廊：按照 galleryGroup 构建索引，界面可以直接按分组展示。
+ * 4. 成就画廊：按照 galleryGroup 维护有序索引（已解锁在前、按解锁时间排列），创建/修改/删除/解锁时增量调整，
+ *    界面按分组分页取 id，再按需读取详情。
  * 5. 奖励派发：解锁时发放兰州币、属性点及“自豪感”特殊加成，记录获得的纪念物品。
  * 6. 自定义限制：每名学生每月仅允许创建 2 个带奖励的自定义成就，纯展示型不受限。
+ * 锁模型：m_mutex 为读写锁，只保护内存状态，持锁期间不访问数据库、不发信号。条件分发等 *Locked 方法
+ *         把需要同步落盘的解锁记录、待发信号与刷写请求记入 m_outbox，由 deliver() 在释放锁后统一执行；
+ *         写库序列在 DatabaseManager::runInTransaction 内串行化，锁顺序为 DatabaseManager → AchievementManager。
+ *         上游信号在事务提交后才发出，本类发出的信号同样经 runAfterCommit 推迟；事务内改动过的成就
+ *         在外层事务回滚时恢复为改动前的版本。
  */
 class AchievementManager : public QObject {
     Q_OBJECT
 
 public:
+    /**
+     * @brief 不可变的成就集合快照，条目按 id 升序排列。
+     *        每个成就以 shared_ptr<const Achievement> 保存，相邻版本间未变化的成就共用同一对象，
+     *        发布新版本只复制指针与本次改动过的成就；读者持有快照即可在锁外遍历，不会观察到半更新状态。
+     */
+    struct AchievementSet {
+        std::uint64_t version = 0;
+        std::vector<std::shared_ptr<const Achievement>> items;
+        /**
+         * @brief id -> items 下标；成员集合不变的发布沿用上一版本的同一份索引，不重建哈希表。
+         */
+        std::shared_ptr<const std::unordered_map<int, std::size_t>> indexById;
+
+        [[nodiscard]] std::shared_ptr<const Achievement> find(int id) const;
+    };
+
     static AchievementManager& instance(DatabaseManager& database,
                                         UserManager& userManager,
                                         TaskManager& taskManager);
@@ -38,19 +73,50 @@ public:
     AchievementManager& operator=(const AchievementManager&) = delete;
     AchievementManager(AchievementManager&&) = delete;
     AchievementManager& operator=(AchievementManager&&) = delete;
+    ~AchievementManager() override;
 
     void refreshFromDatabase();
-    [[nodiscard]] std::vector<Achievement> achievements() const;
-    [[nodiscard]] std::vector<Achievement> achievementsInGroup(const std::string& group) const;
-    [[nodiscard]] std::optional<Achievement> achievementById(int id) const;
+    /**
+     * @brief 当前发布的成就快照：原子读取指针，不取 m_mutex，任务结算修改进度期间界面读取也不会等待。
+     *        写者在每次修改后、释放锁前发布新版本（RCU），已取得的旧快照保持不变直至最后一个持有者释放。
+     */
+    [[nodiscard]] std::shared_ptr<const AchievementSet> snapshot() const;
+    /**
+     * @brief 画廊分页：返回分组内按画廊顺序第 [offset, offset + limit) 个成就的 id。
+     *        只复制 id，界面对可见行再调用 achievementById 取详情，大分组翻页不必复制整组成就。
+     */
+    [[nodiscard]] std::vector<int> galleryPage(const std::string& group, std::size_t offset, std::size_t limit) const;
+    [[nodiscard]] std::size_t gallerySize(const std::string& group) const;
+    /**
+     * @brief 从当前快照中查找成就，返回共享的只读对象，不复制；不存在时返回空指针。
+     */
+    [[nodiscard]] std::shared_ptr<const Achievement> achievementById(int id) const;
 
     int createCustomAchievement(Achievement achievement);
     void updateCustomAchievement(const Achievement& achievement);
     void deleteCustomAchievement(int achievementId);
     void recordCustomProgress(int achievementId, int delta);
 
+    /**
+     * @brief 立即把缓冲中的进度变化写回数据库。
+     * 中文：进度采用写后缓冲（write-behind）：解锁、用户自定义修改与删除始终同步落盘；
+     *       普通进度变化先记入脏集合，由定时器、批量上限、解锁或退出时统一刷写。
+     *       进程异常终止时最多丢失最近一个刷写周期内的进度，已解锁状态不会丢失。
+     *       状态锁只在取走脏集合、生成记录时短暂持有，数据库写入在锁外进行；调用方不得持有 m_mutex。
+     */
+    void flushPendingProgress();
+
+    /**
+     * @brief 估算成就缓存、画廊与条件索引及已发布快照的内存，登记为 MemoryRegistry 的 "achievements"。
+     *        这些结构都是结算路径的工作集，没有可丢弃的部分，因此只报告、不登记回收。
+     */
+    [[nodiscard]] metrics::MemoryUsage memoryUsage() const;
+
 signals:
     void achievementUnlocked(int achievementId);
+    /**
+     * @brief 成就进度变化，事务提交后逐条发出；界面经 ChangeBus 按 id 合并，每周期只刷新一次。
+     */
     void achievementProgressChanged(int achievementId, int currentValue, int goalValue);
 
 private slots:
@@ -59,15 +125,40 @@ private slots:
     void onUserLevelChanged(int newLevel);
     void onPrideChanged(int newPride);
     void onCoinsChanged(int newCoins);
+    void onSessionChanged(int userId);
 
 private:
     explicit AchievementManager(DatabaseManager& database,
                                 UserManager& userManager,
                                 TaskManager& taskManager);
 
-    void ensureSystemAchievements();
-    [[nodiscard]] std::vector<Achievement> buildSystemTemplates(const std::string& owner) const;
-    Achievement hydrateAchievement(const DatabaseManager::AchievementRecord& record) const;
+    using StateMutex = metrics::ProfiledMutex<std::shared_mutex>;
+
+    /**
+     * @brief 持锁期间累积、释放锁后执行的副作用。
+     */
+    struct Outbox {
+        struct Progress {
+            int achievementId = -1;
+            int value = 0;
+            int goal = 0;
+        };
+
+        std::vector<DatabaseManager::AchievementRecord> unlockedRecords;  //!< 解锁须同步落盘的整行记录
+        std::vector<int> unlockedIds;
+        int userUnlocks = 0;  //!< 待计入 UserManager::unlockAchievement 的次数
+        std::vector<Progress> progress;
+        bool flushDue = false;  //!< 脏集合达到批量上限，需立即刷写
+    };
+
+    /**
+     * @brief 独占锁内执行 mutate，释放锁后 deliver 其间累积的副作用。
+     */
+    void mutateThenDeliver(const std::function<void()>& mutate);
+    void deliver(Outbox outbox);
+    void ensureSystemAchievements(std::unordered_map<int, Achievement>& achievements);
+    [[nodiscard]] std::vector<Achievement> buildSystemTemplates(int ownerId) const;
+    Achievement hydrateAchievement(DatabaseManager::AchievementRecord&& record) const;
     DatabaseManager::AchievementRecord toRecord(const Achievement& achievement) const;
     bool recalculateProgress(Achievement& achievement);
     void evaluateCompletion(Achievement& achievement);
@@ -75,25 +166,150 @@ private:
     void handleUserLevelChangedLocked(int newLevel);
     void handlePrideChangedLocked(int newPride);
     void handleCoinsChangedLocked(int newCoins);
+    /**
+     * @brief 一次条件事件：按 (类型, 元数据) 定位订阅者，absolute 为 true 时覆盖数值，否则累加。
+     */
+    struct ConditionEvent {
+        Achievement::Condition::ConditionType type;
+        std::string metadata;
+        int value = 0;
+        bool absolute = false;
+    };
+
+    /**
+     * @brief 倒排索引中的一个订阅位置：哪个成就的第几条条件。
+     */
+    struct ConditionSlot {
+        int achievementId = -1;
+        std::size_t conditionIndex = 0;
+    };
+
+    using ConditionIndex = std::unordered_map<Achievement::Condition::ConditionType,
+                                              std::unordered_map<std::string, std::vector<ConditionSlot>>>;
+
+    /**
+     * @brief 规则条件的订阅位置，持有编译结果，求值时不再查找。
+     */
+    struct RuleSlot {
+        int achievementId = -1;
+        std::size_t conditionIndex = 0;
+        std::shared_ptr<const AchievementRule> rule;
+    };
+
+    using RuleIndex = std::array<std::vector<RuleSlot>, AchievementRule::kEventKindCount>;
+    using RuleCache = std::unordered_map<std::string, std::shared_ptr<const AchievementRule>>;
+
+    void dispatchConditionEventsLocked(const std::vector<ConditionEvent>& events);
+    /**
+     * @brief 把一次事件送给订阅了该事件类型的规则条件，未解锁的成就才会求值。调用方需持有 m_mutex 独占锁。
+     */
+    void dispatchRuleEventLocked(const RuleEvent& event);
+    /**
+     * @brief 以当前用户状态填充规则事件的等级、金币与自豪感字段。
+     */
+    [[nodiscard]] RuleEvent ruleEventFor(RuleEvent::Kind kind) const;
+    /**
+     * @brief 条件被改动过的成就：重新序列化条件、刷新进度并判定解锁。
+     */
+    void settleTouchedLocked(const std::vector<int>& touchedIds);
+    /**
+     * @brief 编译成就中的规则条件并把目标值改为规则给出的值；不依赖任务的状态谓词按当前用户状态先求值一次。
+     * @return 本次编译的规则，供加入 m_compiledRules。
+     * @throws std::runtime_error 规则有误。
+     */
+    RuleCache prepareRuleConditions(Achievement& achievement) const;
+    void rebuildConditionIndex();
+    /**
+     * @param previous 重建索引前的编译缓存，仍被引用的规则从中取回而不重新编译。
+     */
+    void indexConditionsFor(const Achievement& achievement, RuleCache* previous = nullptr);
+    /**
+     * @brief 按源码取编译后的规则，依次查当前缓存、previous，最后才编译；数据损坏无法编译时返回空指针。
+     */
+    std::shared_ptr<const AchievementRule> ruleForLocked(const std::string& source, RuleCache* previous);
+    void markProgressDirtyLocked(int achievementId);
     bool validateCustomAchievement(const Achievement& achievement) const;
+    /**
+     * @brief 画廊排序键：已解锁在前，已解锁者按解锁时刻先后，最后按 id 保证全序。
+     */
+    struct GalleryKey {
+        bool locked = true;
+        qint64 completedMs = 0;
+        int id = -1;
+
+        bool operator<(const GalleryKey& other) const noexcept {
+            return std::tie(locked, completedMs, id) < std::tie(other.locked, other.completedMs, other.id);
+        }
+        bool operator==(const GalleryKey& other) const noexcept {
+            return locked == other.locked && completedMs == other.completedMs && id == other.id;
+        }
+    };
+
+    /**
+     * @brief 成就当前在画廊中的位置，移除或换组时据此在原分组内二分定位。
+     */
+    struct GalleryPlacement {
+        std::string group;
+        GalleryKey key;
+    };
+
+    static GalleryKey galleryKeyFor(const Achievement& achievement);
     void rebuildGalleryIndex();
-    void updateGalleryForAchievement(const Achievement& achievement);
-    int countRewardAchievementsThisMonth(const std::string& owner) const;
+    /**
+     * @brief 按成就当前的分组与解锁状态放入画廊；位置未变时不做任何事，换组或解锁时先移出原位置。
+     */
+    void placeInGalleryLocked(const Achievement& achievement);
+    void removeFromGalleryLocked(int achievementId);
+    /**
+     * @brief 本月已创建的奖励型自定义成就数：已装载用户直接查 m_rewardQuota，其他用户回退到数据库计数。
+     */
+    int countRewardAchievementsThisMonth(int ownerId) const;
+    /**
+     * @brief 记录需要进入下一版本快照的成就（新增、修改或删除）；调用方需持有 m_mutex 独占锁。
+     */
+    void markSnapshotDirtyLocked(int achievementId);
+    /**
+     * @brief 外层事务回滚后按 m_rollbackOriginals 恢复成就缓存；由 DatabaseManager::runOnRollback 调用。
+     */
+    void restoreAfterRollback();
+    /**
+     * @brief 有改动时构建并原子发布新快照：只为脏成就生成新对象，其余沿用上一版本的指针。
+     */
+    void publishSnapshotLocked();
+    /**
+     * @brief 不在事务中时立即发布；在事务中时推迟到提交前发布一次，一个工作单元内的多次修改合并为一次发布。
+     */
+    void schedulePublishLocked();
+    void rebuildRewardQuota();
+    void countRewardQuota(const Achievement& achievement);
+    static int monthKey(const QDate& date) noexcept;
     void updateConditionCache(Achievement& achievement,
                               Achievement::Condition::ConditionType type,
                               int delta,
                               const std::string& metadata);
-    void replaceConditionValue(Achievement& achievement,
-                               Achievement::Condition::ConditionType type,
-                               int value,
-                               const std::string& metadata);
 
     DatabaseManager& m_database;
     UserManager& m_userManager;
     TaskManager& m_taskManager;
     std::unordered_map<int, Achievement> m_achievements;
-    std::unordered_map<std::string, std::vector<int>> m_galleryIndex;
-    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::vector<GalleryKey>> m_galleryIndex;  //!< 分组 -> 按 GalleryKey 有序的条目
+    std::unordered_map<int, GalleryPlacement> m_galleryPlacement;  //!< 成就 id -> 所在分组与排序键
+    std::unordered_map<int, int> m_rewardQuota;  //!< 月份键（年 * 100 + 月）-> 当月创建的奖励型自定义成就数
+    ConditionIndex m_conditionIndex;  //!< (条件类型, 元数据) -> 订阅该事件的成就条件
+    RuleIndex m_ruleIndex;            //!< RuleEvent::Kind -> 依赖该事件的规则条件
+    RuleCache m_compiledRules;        //!< 规则源码 -> 编译结果，相同规则的条件共享同一对象
+    std::unordered_set<int> m_dirtyProgress;  //!< 进度已变化但尚未写回数据库的成就
+    std::unique_ptr<QTimer> m_flushTimer;     //!< 单次定时器，首个脏成就出现后定时刷写
+    Outbox m_outbox;                          //!< 由 m_mutex 保护，mutateThenDeliver 每次取空
+    int m_loadedOwner;                        //!< 当前缓存所属用户 users.id，受 m_mutex 保护；0 表示尚未装载
+    std::map<int, std::shared_ptr<const Achievement>> m_snapshotEntries;  //!< 最新快照的条目，按 id 有序
+    std::unordered_set<int> m_snapshotDirty;  //!< 尚未发布的改动
+    std::unordered_map<int, std::shared_ptr<const Achievement>> m_rollbackOriginals;  //!< 当前事务改动前的版本，空指针表示新建
+    bool m_snapshotRebuild = false;           //!< 整体重新装载后置位，下次发布全部重建
+    std::uint64_t m_snapshotVersion = 0;
+    std::shared_ptr<const AchievementSet> m_snapshot;  //!< 只经 std::atomic_load/std::atomic_store 访问
+    mutable StateMutex m_mutex;
+    metrics::MemoryRegistration m_memoryRegistration;
 };
 
 }  // namespace rove::data
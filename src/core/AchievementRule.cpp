@@ -0,0 +1,391 @@
+#include "AchievementRule.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "Task.h"
+
+namespace rove::data {
+namespace {
+
+constexpr qint64 kMsPerHour = 60LL * 60 * 1000;
+constexpr qint64 kMsPerDay = 24 * kMsPerHour;
+
+constexpr std::uint32_t bit(RuleEvent::Kind kind) noexcept { return 1U << static_cast<unsigned>(kind); }
+
+std::string lowered(std::string_view text) {
+    std::string out(text);
+    std::transform(out.begin(), out.end(), out.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return out;
+}
+
+std::optional<int> taskTypeValue(std::string_view name) {
+    const std::string key = lowered(name);
+    for (const auto type : {Task::TaskType::Daily, Task::TaskType::Weekly, Task::TaskType::Semester,
+                            Task::TaskType::Custom}) {
+        if (lowered(Task::typeToString(type)) == key) {
+            return static_cast<int>(type);
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
+/**
+ * @brief 递归下降编译器：边解析边按后缀顺序输出指令，同时记录求值栈深度与规则读取的字段。
+ */
+class AchievementRule::Compiler {
+public:
+    Compiler(std::string_view source, AchievementRule& rule) : m_source(source), m_rule(rule) {}
+
+    void compileRule() {
+        if (peekKeyword("count")) {
+            next();
+            expect("(");
+            compileExpression();
+            expect(")");
+            m_rule.m_counting = true;
+            if (peekKeyword("within")) {
+                next();
+                // "7d" 会被切成一个词，"7 d" 则是两个，两种写法都接受。
+                std::string token = next();
+                const std::size_t digits = token.find_first_not_of("0123456789");
+                std::string unit = digits == std::string::npos ? next() : token.substr(digits);
+                token.resize(std::min(digits, token.size()));
+                const qint64 amount = parseInteger(token);
+                unit = lowered(unit);
+                if (unit != "d" && unit != "h") {
+                    fail("时间窗单位只支持 d 或 h");
+                }
+                m_rule.m_windowMs = amount * (unit == "d" ? kMsPerDay : kMsPerHour);
+                if (m_rule.m_windowMs <= 0) {
+                    fail("时间窗必须为正");
+                }
+            }
+            const std::string op = next();
+            if (op != ">=" && op != "≥") {
+                fail("计数规则须以 >= 阈值 结尾");
+            }
+            m_rule.m_threshold = expectInteger();
+            if (m_rule.m_threshold <= 0) {
+                fail("计数阈值必须为正");
+            }
+        } else {
+            compileExpression();
+        }
+        skipSpace();
+        if (m_pos != m_source.size()) {
+            fail("规则末尾有多余内容");
+        }
+        if (m_rule.m_eventMask == 0) {
+            fail("规则未引用 level、coins、pride 或 task 字段");
+        }
+        // 任务字段只在任务完成事件中有效：引用了任务字段的规则只在任务完成时求值。
+        if ((m_rule.m_eventMask & bit(RuleEvent::Kind::TaskCompleted)) != 0) {
+            m_rule.m_eventMask = bit(RuleEvent::Kind::TaskCompleted);
+        }
+    }
+
+private:
+    void compileExpression() {
+        compileTerm();
+        while (peekSymbol("||") || peekKeyword("or")) {
+            next();
+            compileTerm();
+            appendOp(Op::Or, 0, -1);
+        }
+    }
+
+    void compileTerm() {
+        compileFactor();
+        while (peekSymbol("&&") || peekKeyword("and")) {
+            next();
+            compileFactor();
+            appendOp(Op::And, 0, -1);
+        }
+    }
+
+    void compileFactor() {
+        if (peekSymbol("!") || peekKeyword("not")) {
+            next();
+            compileFactor();
+            appendOp(Op::Not, 0, 0);
+            return;
+        }
+        if (peekSymbol("(")) {
+            next();
+            compileExpression();
+            expect(")");
+            return;
+        }
+        compileOperand();
+        const std::string op = next();
+        Op compare = Op::Eq;
+        if (op == "==" || op == "=") {
+            compare = Op::Eq;
+        } else if (op == "!=") {
+            compare = Op::Ne;
+        } else if (op == "<") {
+            compare = Op::Lt;
+        } else if (op == "<=" || op == "≤") {
+            compare = Op::Le;
+        } else if (op == ">") {
+            compare = Op::Gt;
+        } else if (op == ">=" || op == "≥") {
+            compare = Op::Ge;
+        } else {
+            fail("缺少比较运算符");
+        }
+        compileOperand();
+        appendOp(compare, 0, -1);
+    }
+
+    void compileOperand() {
+        skipSpace();
+        const std::size_t start = m_pos;
+        const std::string token = next();
+        if (token.empty()) {
+            fail("规则意外结束");
+        }
+        int value = 0;
+        const auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (ec == std::errc() && end == token.data() + token.size()) {
+            appendOp(Op::Push, value, 1);
+            return;
+        }
+        const std::string name = lowered(token);
+        if (name == "level") {
+            load(Field::Level, RuleEvent::Kind::LevelChanged);
+        } else if (name == "coins") {
+            load(Field::Coins, RuleEvent::Kind::CoinsChanged);
+        } else if (name == "pride") {
+            load(Field::Pride, RuleEvent::Kind::PrideChanged);
+        } else if (name == "task.type") {
+            load(Field::TaskType, RuleEvent::Kind::TaskCompleted);
+        } else if (name == "task.difficulty") {
+            load(Field::TaskDifficulty, RuleEvent::Kind::TaskCompleted);
+        } else if (const auto type = taskTypeValue(token)) {
+            appendOp(Op::Push, *type, 1);
+        } else {
+            m_pos = start;
+            fail("未知字段 " + token);
+        }
+    }
+
+    void load(Field field, RuleEvent::Kind kind) {
+        m_rule.m_eventMask |= bit(kind);
+        appendOp(Op::Load, static_cast<std::int32_t>(field), 1);
+    }
+
+    void appendOp(Op op, std::int32_t operand, int stackEffect) {
+        m_rule.m_code.push_back({op, operand});
+        m_depth += stackEffect;
+        if (m_depth > static_cast<int>(kMaxStackDepth)) {
+            fail("规则嵌套过深");
+        }
+    }
+
+    void skipSpace() {
+        while (m_pos < m_source.size() && std::isspace(static_cast<unsigned char>(m_source[m_pos])) != 0) {
+            ++m_pos;
+        }
+    }
+
+    /**
+     * @brief 取下一个词法单元：标识符（含 '.'、'_'）、整数、UTF-8 比较符或 1～2 字符的符号。
+     */
+    std::string next() {
+        skipSpace();
+        if (m_pos >= m_source.size()) {
+            return {};
+        }
+        const std::size_t start = m_pos;
+        const auto isWord = [](unsigned char c) { return std::isalnum(c) != 0 || c == '_' || c == '.' || c == '-'; };
+        if (isWord(static_cast<unsigned char>(m_source[m_pos]))) {
+            ++m_pos;
+            while (m_pos < m_source.size() && isWord(static_cast<unsigned char>(m_source[m_pos])) &&
+                   m_source[m_pos] != '-') {
+                ++m_pos;
+            }
+            return std::string(m_source.substr(start, m_pos - start));
+        }
+        for (const std::string_view symbol : {"≥", "≤", "&&", "||", "==", "!=", "<=", ">="}) {
+            if (m_source.substr(m_pos, symbol.size()) == symbol) {
+                m_pos += symbol.size();
+                return std::string(symbol);
+            }
+        }
+        return std::string(1, m_source[m_pos++]);
+    }
+
+    bool peekSymbol(std::string_view symbol) {
+        skipSpace();
+        return m_source.substr(m_pos, symbol.size()) == symbol &&
+               !(symbol == "!" && m_source.substr(m_pos, 2) == "!=");
+    }
+
+    bool peekKeyword(std::string_view keyword) {
+        const std::size_t saved = m_pos;
+        const bool match = lowered(next()) == keyword;
+        m_pos = saved;
+        return match;
+    }
+
+    void expect(std::string_view symbol) {
+        if (next() != symbol) {
+            fail("缺少 " + std::string(symbol));
+        }
+    }
+
+    int expectInteger() { return parseInteger(next()); }
+
+    int parseInteger(const std::string& token) const {
+        int value = 0;
+        const auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (token.empty() || ec != std::errc() || end != token.data() + token.size()) {
+            fail("此处需要整数");
+        }
+        return value;
+    }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error("成就规则第 " + std::to_string(m_pos) + " 字节处有误：" + message);
+    }
+
+    std::string_view m_source;
+    AchievementRule& m_rule;
+    std::size_t m_pos = 0;
+    int m_depth = 0;
+};
+
+std::shared_ptr<const AchievementRule> AchievementRule::compile(std::string_view source) {
+    auto rule = std::make_shared<AchievementRule>();
+    Compiler(source, *rule).compileRule();
+    rule->m_code.shrink_to_fit();
+    return rule;
+}
+
+bool AchievementRule::subscribes(RuleEvent::Kind kind) const noexcept { return (m_eventMask & bit(kind)) != 0; }
+
+bool AchievementRule::matches(const RuleEvent& event) const noexcept {
+    std::array<std::int32_t, kMaxStackDepth> stack{};
+    std::size_t top = 0;
+    for (const auto& instruction : m_code) {
+        switch (instruction.op) {
+        case Op::Push:
+            stack[top++] = instruction.operand;
+            break;
+        case Op::Load:
+            switch (static_cast<Field>(instruction.operand)) {
+            case Field::Level:
+                stack[top++] = event.level;
+                break;
+            case Field::Coins:
+                stack[top++] = event.coins;
+                break;
+            case Field::Pride:
+                stack[top++] = event.pride;
+                break;
+            case Field::TaskType:
+                stack[top++] = event.taskType;
+                break;
+            case Field::TaskDifficulty:
+                stack[top++] = event.difficulty;
+                break;
+            }
+            break;
+        case Op::Not:
+            stack[top - 1] = stack[top - 1] == 0 ? 1 : 0;
+            break;
+        default: {
+            const std::int32_t rhs = stack[--top];
+            std::int32_t& lhs = stack[top - 1];
+            switch (instruction.op) {
+            case Op::Eq:
+                lhs = lhs == rhs;
+                break;
+            case Op::Ne:
+                lhs = lhs != rhs;
+                break;
+            case Op::Lt:
+                lhs = lhs < rhs;
+                break;
+            case Op::Le:
+                lhs = lhs <= rhs;
+                break;
+            case Op::Gt:
+                lhs = lhs > rhs;
+                break;
+            case Op::Ge:
+                lhs = lhs >= rhs;
+                break;
+            case Op::And:
+                lhs = lhs != 0 && rhs != 0;
+                break;
+            case Op::Or:
+                lhs = lhs != 0 || rhs != 0;
+                break;
+            default:
+                break;
+            }
+        }
+        }
+    }
+    return top == 1 && stack[0] != 0;
+}
+
+/**
+ * @brief 状态谓词跟随当前真值；只看任务字段的谓词一旦命中即保持（“完成过这样的任务”）。
+ *        计数规则不限窗口时逐次累加；带窗口时 ruleHits 按时间有序，只保留窗口内最近的 阈值 个命中。
+ */
+bool AchievementRule::apply(const RuleEvent& event, Achievement::Condition& condition) const {
+    const bool hit = matches(event);
+    if (!m_counting) {
+        const bool latching = subscribes(RuleEvent::Kind::TaskCompleted);
+        const int next = hit ? 1 : (latching ? condition.currentValue : 0);
+        if (condition.currentValue == next) {
+            return false;
+        }
+        condition.currentValue = next;
+        return true;
+    }
+    if (m_windowMs <= 0) {
+        if (!hit || condition.currentValue >= m_threshold) {
+            return false;
+        }
+        ++condition.currentValue;
+        return true;
+    }
+
+    auto& hits = condition.ruleHits;
+    bool changed = false;
+    if (hit) {
+        hits.insert(std::upper_bound(hits.begin(), hits.end(), event.timestampMs), event.timestampMs);
+        changed = true;
+    }
+    const qint64 newest = hits.empty() ? event.timestampMs : std::max<qint64>(event.timestampMs, hits.back());
+    const auto firstLive = std::lower_bound(hits.begin(), hits.end(), newest - m_windowMs);
+    if (firstLive != hits.begin()) {
+        hits.erase(hits.begin(), firstLive);
+        changed = true;
+    }
+    if (hits.size() > static_cast<std::size_t>(m_threshold)) {
+        hits.erase(hits.begin(), hits.end() - m_threshold);
+    }
+    const int next = static_cast<int>(hits.size());
+    if (condition.currentValue != next) {
+        condition.currentValue = next;
+        changed = true;
+    }
+    return changed;
+}
+
+}  // namespace rove::data
@@ -0,0 +1,97 @@
+#ifndef ACHIEVEMENTRULE_H
+#define ACHIEVEMENTRULE_H
+
+#include <QtGlobal>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "Achievement.h"
+
+namespace rove::data {
+
+/**
+ * @brief 规则求值的输入：一次业务事件连同事件发生时的用户状态。
+ * 中文：任务字段只在 TaskCompleted 事件中有效；等级、金币、自豪感在所有事件中都填入当前值，
+ *       因此 "coins >= 500 && level >= 10" 在金币或等级任一变化时都能完整求值。
+ */
+struct RuleEvent {
+    enum class Kind : std::uint8_t { TaskCompleted, LevelChanged, CoinsChanged, PrideChanged };
+
+    Kind kind = Kind::TaskCompleted;
+    qint64 timestampMs = 0;
+    int taskType = -1;   //!< Task::TaskType 的整数值
+    int difficulty = 0;  //!< 任务星级
+    int level = 0;
+    int coins = 0;
+    int pride = 0;
+};
+
+/**
+ * @class AchievementRule
+ * @brief 自定义成就的条件规则：源码编译为后缀形式的字节码，按事件求值，不再逐次解析文本。
+ * 中文：语法（关键字不区分大小写，AND/OR/NOT 与 && / || / ! 等价，比较符另接受 =、≥、≤）：
+ *       rule    := 'count' '(' expr ')' [ 'within' 整数 ('d' | 'h') ] '>=' 整数  |  expr
+ *       expr    := term { '||' term }
+ *       term    := factor { '&&' factor }
+ *       factor  := '!' factor | '(' expr ')' | operand 比较符 operand
+ *       operand := level | coins | pride | task.type | task.difficulty | 整数 | 任务类型名（Daily、Weekly…）
+ *       例："count(task.type == Weekly && task.difficulty >= 4) within 7d >= 3"、"coins >= 500 AND level >= 10"。
+ *       状态谓词的目标值为 1，谓词成立时条件达成；计数规则的目标值为阈值，带时间窗时在条件的 ruleHits
+ *       中保留最近 阈值 个命中时刻，窗口内命中数即当前值。编译时记下规则读取的字段对应的事件类型，
+ *       AchievementManager 只把这些事件送来求值。规则对象不可变，可在多个条件间共享。
+ */
+class AchievementRule final {
+public:
+    static constexpr std::size_t kEventKindCount = 4;
+
+    /**
+     * @brief 编译规则源码。
+     * @throws std::runtime_error 语法错误、未知字段或规则未引用任何事件字段，信息含出错位置。
+     */
+    [[nodiscard]] static std::shared_ptr<const AchievementRule> compile(std::string_view source);
+
+    [[nodiscard]] bool subscribes(RuleEvent::Kind kind) const noexcept;
+    [[nodiscard]] bool counting() const noexcept { return m_counting; }
+    /**
+     * @brief 条件的目标值：计数规则为阈值，状态谓词为 1。
+     */
+    [[nodiscard]] int target() const noexcept { return m_threshold; }
+
+    /**
+     * @brief 执行谓词字节码；求值期间不分配内存。
+     */
+    [[nodiscard]] bool matches(const RuleEvent& event) const noexcept;
+
+    /**
+     * @brief 把事件作用到条件上：更新 currentValue，带时间窗的计数规则同时维护 ruleHits。
+     * @return 条件是否发生变化。
+     */
+    bool apply(const RuleEvent& event, Achievement::Condition& condition) const;
+
+private:
+    enum class Op : std::uint8_t { Push, Load, Eq, Ne, Lt, Le, Gt, Ge, And, Or, Not };
+    enum class Field : std::uint8_t { Level, Coins, Pride, TaskType, TaskDifficulty };
+
+    struct Instruction {
+        Op op = Op::Push;
+        std::int32_t operand = 0;
+    };
+
+    class Compiler;
+
+    static constexpr std::size_t kMaxStackDepth = 32;
+
+    std::vector<Instruction> m_code;
+    std::uint32_t m_eventMask = 0;  //!< 按 RuleEvent::Kind 置位
+    bool m_counting = false;
+    int m_threshold = 1;
+    qint64 m_windowMs = 0;  //!< 0 表示不限时间窗
+};
+
+}  // namespace rove::data
+
+#endif  // ACHIEVEMENTRULE_H
@@ -0,0 +1,198 @@
+#include "ActivityFeed.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QString>
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include "RecordCodec.h"
+
+namespace rove::data {
+
+namespace {
+
+constexpr std::uint8_t kFeedFormatV1 = 1;
+constexpr std::size_t kLogExcerptChars = 24;  //!< 手动日志在动态中展示的字符数
+
+}  // namespace
+
+bool ActivityRing::push(ActivityEvent event) {
+    const bool evicted = m_size == kCapacity;
+    m_slots[m_next] = std::move(event);
+    m_next = (m_next + 1) % kCapacity;
+    if (!evicted) {
+        ++m_size;
+    }
+    return evicted;
+}
+
+const ActivityEvent& ActivityRing::at(std::size_t index) const noexcept {
+    return m_slots[(m_next + kCapacity - 1 - index) % kCapacity];
+}
+
+void ActivityRing::clear() noexcept {
+    m_next = 0;
+    m_size = 0;
+}
+
+std::string ActivityRing::encode() const {
+    std::string out;
+    out.reserve(2 + m_size * 32);
+    codec::putU8(out, kFeedFormatV1);
+    codec::putU8(out, static_cast<std::uint8_t>(m_size));
+    for (std::size_t i = m_size; i-- > 0;) {
+        const ActivityEvent& event = at(i);
+        codec::putU8(out, static_cast<std::uint8_t>(event.kind));
+        codec::putI32(out, event.refId);
+        codec::putI64(out, event.timestampMs);
+        const std::size_t length = std::min<std::size_t>(event.text.size(), 0xFFFF);
+        codec::putU16(out, static_cast<std::uint16_t>(length));
+        out.append(event.text, 0, length);
+    }
+    return out;
+}
+
+std::optional<ActivityRing> ActivityRing::decode(std::string_view blob) {
+    codec::ByteReader reader{blob};
+    if (reader.u8() != kFeedFormatV1) {
+        return std::nullopt;
+    }
+    const std::size_t count = reader.u8();
+    if (!reader.ok || count > kCapacity) {
+        return std::nullopt;
+    }
+    ActivityRing ring;
+    for (std::size_t i = 0; i < count; ++i) {
+        ActivityEvent event;
+        const std::uint8_t kind = reader.u8();
+        event.refId = reader.i32();
+        event.timestampMs = reader.i64();
+        event.text = std::string(reader.bytes(reader.u16()));
+        if (!reader.ok || kind > static_cast<std::uint8_t>(ActivityEvent::Kind::ItemAcquired)) {
+            return std::nullopt;
+        }
+        event.kind = static_cast<ActivityEvent::Kind>(kind);
+        ring.push(std::move(event));
+    }
+    if (reader.pos != blob.size()) {
+        return std::nullopt;
+    }
+    return ring;
+}
+
+ActivityFeed::ActivityFeed(DatabaseManager& database,
+                           UserManager& userManager,
+                           TaskManager& taskManager,
+                           AchievementManager& achievementManager,
+                           LogManager& logManager,
+                           ShopManager& shopManager,
+                           InventoryManager& inventoryManager,
+                           QObject* parent)
+    : QObject(parent),
+      m_database(database),
+      m_taskManager(taskManager),
+      m_achievementManager(achievementManager),
+      m_shopManager(shopManager),
+      m_inventoryManager(inventoryManager) {
+    qRegisterMetaType<ActivityEvent>("rove::data::ActivityEvent");
+    if (auto* proxy = userManager.signalProxy()) {
+        QObject::connect(proxy, &UserManagerSignalProxy::sessionChanged, this,
+                         [this](int userId) { onSessionChanged(userId); });
+    }
+    if (auto* proxy = m_taskManager.signalProxy()) {
+        QObject::connect(proxy, &TaskManagerSignalProxy::taskCompleted, this, [this](int taskId, int, int) {
+            const auto task = m_taskManager.taskById(taskId);
+            append(ActivityEvent::Kind::TaskCompleted, taskId,
+                   "完成任务：" + (task ? task->name() : "#" + std::to_string(taskId)));
+        });
+    }
+    QObject::connect(&m_achievementManager, &AchievementManager::achievementUnlocked, this, [this](int achievementId) {
+        const auto achievement = m_achievementManager.achievementById(achievementId);
+        append(ActivityEvent::Kind::AchievementUnlocked, achievementId,
+               "解锁成就：" + (achievement ? achievement->name() : "#" + std::to_string(achievementId)));
+    });
+    QObject::connect(&logManager, &LogManager::logInserted, this, [this](const LogEntry& entry) {
+        if (entry.type() != LogEntry::LogType::Manual) {
+            return;
+        }
+        const QString content = QString::fromStdString(entry.content());
+        const QString excerpt = content.size() > static_cast<int>(kLogExcerptChars)
+                                    ? content.left(static_cast<int>(kLogExcerptChars)) + QStringLiteral("…")
+                                    : content;
+        append(ActivityEvent::Kind::ManualLog, entry.id(), "写下日志：" + excerpt.toStdString());
+    });
+    if (auto* proxy = m_inventoryManager.signalProxy()) {
+        QObject::connect(proxy, &InventoryManagerSignalProxy::inventoryInserted, this,
+                         [this](int ownerId, const QVector<int>& inventoryIds) {
+                             if (ownerId != m_ownerId) {
+                                 return;
+                             }
+                             const auto catalog = m_shopManager.catalog();
+                             for (int inventoryId : inventoryIds) {
+                                 const auto item = m_inventoryManager.findById(inventoryId);
+                                 if (!item) {
+                                     continue;
+                                 }
+                                 const auto* entry = catalog->find(item->itemId());
+                                 const std::string name =
+                                     entry != nullptr ? entry->item.name() : "#" + std::to_string(item->itemId());
+                                 append(ActivityEvent::Kind::ItemAcquired, inventoryId,
+                                        "获得物品：" + name + " ×" + std::to_string(item->quantity()));
+                             }
+                         });
+    }
+    if (userManager.hasActiveUser()) {
+        onSessionChanged(userManager.activeUserId());
+    }
+}
+
+ActivityFeed::~ActivityFeed() = default;
+
+void ActivityFeed::persist() {
+    if (m_ownerId == 0 || !m_dirty) {
+        return;
+    }
+    try {
+        m_database.saveActivityFeed(m_ownerId, m_ring.encode());
+        m_dirty = false;
+    } catch (const std::exception& e) {
+        qWarning() << "保存近期动态失败:" << e.what();
+    }
+}
+
+/**
+ * @brief 先写回上一位用户的缓冲，再读取新用户的缓冲；退出登录（userId 为 0）只写回、不读取。
+ */
+void ActivityFeed::onSessionChanged(int userId) {
+    persist();
+    m_ring.clear();
+    m_ownerId = userId;
+    m_dirty = false;
+    if (userId != 0) {
+        try {
+            if (const auto blob = m_database.loadActivityFeed(userId)) {
+                if (auto ring = ActivityRing::decode(*blob)) {
+                    m_ring = std::move(*ring);
+                }
+            }
+        } catch (const std::exception& e) {
+            qWarning() << "读取近期动态失败:" << e.what();
+        }
+    }
+    emit activitiesReset();
+}
+
+void ActivityFeed::append(ActivityEvent::Kind kind, int refId, std::string text) {
+    if (m_ownerId == 0) {
+        return;
+    }
+    ActivityEvent event{kind, refId, QDateTime::currentMSecsSinceEpoch(), std::move(text)};
+    const bool evicted = m_ring.push(event);
+    m_dirty = true;
+    emit activityAppended(event, evicted);
+}
+
+}  // namespace rove::data
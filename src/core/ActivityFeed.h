@@ -0,0 +1,133 @@
+#ifndef ACTIVITYFEED_H
+#define ACTIVITYFEED_H
+
+#include <QObject>
+#include <QtGlobal>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "AchievementManager.h"
+#include "DatabaseManager.h"
+#include "InventoryManager.h"
+#include "LogManager.h"
+#include "ShopManager.h"
+#include "TaskManager.h"
+#include "UserManager.h"
+
+namespace rove::data {
+
+/**
+ * @brief 一条近期动态：来源、关联对象 id、发生时刻与展示文本。
+ */
+struct ActivityEvent {
+    enum class Kind : std::uint8_t { TaskCompleted, AchievementUnlocked, ManualLog, ItemAcquired };
+
+    Kind kind = Kind::TaskCompleted;
+    int refId = 0;  //!< 任务、成就、日志或库存行 id
+    qint64 timestampMs = 0;
+    std::string text;
+};
+
+/**
+ * @class ActivityRing
+ * @brief 定容环形缓冲，保存最近 kCapacity 条动态；写满后新事件覆盖最旧的一条。
+ * 中文：追加与淘汰都是 O(1)，不随历史增长；可编码为字节串持久化。本类不加锁，由调用方串行访问。
+ */
+class ActivityRing {
+public:
+    static constexpr std::size_t kCapacity = 20;
+
+    /**
+     * @brief 追加一条动态。
+     * @return 是否因缓冲已满而淘汰了最旧的一条。
+     */
+    bool push(ActivityEvent event);
+
+    [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+    /**
+     * @brief 按从新到旧的顺序取第 index 条，index 须小于 size()。
+     */
+    [[nodiscard]] const ActivityEvent& at(std::size_t index) const noexcept;
+
+    void clear() noexcept;
+
+    /**
+     * @brief 编码为小端字节串（含 NUL 字节，需以 BLOB 存取），按从旧到新的顺序写出。
+     */
+    [[nodiscard]] std::string encode() const;
+
+    /**
+     * @brief 解码 encode 的输出；版本不符或数据损坏时返回空，调用方以空缓冲代替。
+     */
+    [[nodiscard]] static std::optional<ActivityRing> decode(std::string_view blob);
+
+private:
+    std::array<ActivityEvent, kCapacity> m_slots{};
+    std::size_t m_next = 0;  //!< 下一次写入的槽位
+    std::size_t m_size = 0;
+};
+
+/**
+ * @class ActivityFeed
+ * @brief 仪表盘“近期动态”的数据源：订阅任务、成就、日志与库存信号，维护当前用户的 ActivityRing。
+ * 中文：事件到达时只追加一条并发出 activityAppended，界面插入一行、必要时移除最旧的一行，
+ *       展示近期动态不再查询数据库。缓冲按用户保存：登录时读取一次，切换会话与退出程序时写回。
+ *       日志只收录手动日志，任务完成与成就解锁生成的自动日志已由对应事件覆盖。
+ *       本对象只在 GUI 线程访问；数据线程上发出的业务信号由 Qt 排队送达。
+ */
+class ActivityFeed : public QObject {
+    Q_OBJECT
+
+public:
+    ActivityFeed(DatabaseManager& database,
+                 UserManager& userManager,
+                 TaskManager& taskManager,
+                 AchievementManager& achievementManager,
+                 LogManager& logManager,
+                 ShopManager& shopManager,
+                 InventoryManager& inventoryManager,
+                 QObject* parent = nullptr);
+    ~ActivityFeed() override;
+
+    [[nodiscard]] const ActivityRing& recent() const noexcept { return m_ring; }
+
+    /**
+     * @brief 写回当前用户的缓冲；没有会话或自上次保存以来没有变化时不访问数据库。
+     */
+    void persist();
+
+signals:
+    /**
+     * @brief 追加了一条动态；evictedOldest 为 true 时最旧的一条已被淘汰。
+     */
+    void activityAppended(const rove::data::ActivityEvent& event, bool evictedOldest);
+
+    /**
+     * @brief 会话切换后整个缓冲被替换，界面应按 recent() 重建列表。
+     */
+    void activitiesReset();
+
+private:
+    void onSessionChanged(int userId);
+    void append(ActivityEvent::Kind kind, int refId, std::string text);
+
+    DatabaseManager& m_database;
+    TaskManager& m_taskManager;
+    AchievementManager& m_achievementManager;
+    ShopManager& m_shopManager;
+    InventoryManager& m_inventoryManager;
+    ActivityRing m_ring;
+    int m_ownerId = 0;
+    bool m_dirty = false;  //!< 自上次读取或保存以来缓冲是否有变化
+};
+
+}  // namespace rove::data
+
+#endif  // ACTIVITYFEED_H
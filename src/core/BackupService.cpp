@@ -0,0 +1,289 @@
+#include "BackupService.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "DatabaseManager.h"
+#include "Metrics.h"
+
+namespace rove::data {
+
+namespace {
+
+struct SqliteCloser {
+    void operator()(sqlite3* handle) const noexcept { sqlite3_close_v2(handle); }
+};
+using SqliteHandle = std::unique_ptr<sqlite3, SqliteCloser>;
+
+std::string sqliteError(const std::string& prefix, sqlite3* handle) {
+    return prefix + " | sqlite: " + (handle != nullptr ? sqlite3_errmsg(handle) : "out of memory");
+}
+
+SqliteHandle openConnection(const std::string& path, int flags) {
+    sqlite3* raw = nullptr;
+    const int rc = sqlite3_open_v2(path.c_str(), &raw, flags | SQLITE_OPEN_NOMUTEX, nullptr);
+    SqliteHandle handle(raw);
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error(sqliteError("Failed to open " + path, raw));
+    }
+    sqlite3_busy_timeout(raw, 2000);
+    return handle;
+}
+
+void execute(sqlite3* handle, const char* sql) {
+    if (sqlite3_exec(handle, sql, nullptr, nullptr, nullptr) != SQLITE_OK) {
+        throw std::runtime_error(sqliteError(std::string("Failed to execute ") + sql, handle));
+    }
+}
+
+/**
+ * @brief quick_check 只返回一行 "ok" 时认为文件完好。
+ */
+void requireIntact(sqlite3* handle, const std::string& path) {
+    sqlite3_stmt* raw = nullptr;
+    if (sqlite3_prepare_v2(handle, "PRAGMA quick_check;", -1, &raw, nullptr) != SQLITE_OK) {
+        throw std::runtime_error(sqliteError("Failed to check " + path, handle));
+    }
+    std::string verdict;
+    if (sqlite3_step(raw) == SQLITE_ROW) {
+        const auto* text = sqlite3_column_text(raw, 0);
+        verdict = text != nullptr ? reinterpret_cast<const char*>(text) : "";
+    }
+    sqlite3_finalize(raw);
+    if (verdict != "ok") {
+        throw std::runtime_error("Backup " + path + " failed quick_check: " + verdict);
+    }
+}
+
+/**
+ * @brief 复制完成后的共同收尾：目标切回 DELETE 日志模式成为单个文件，做 quick_check 并按页大小换算字节数。
+ */
+void finalizeTarget(sqlite3* target, const std::string& targetPath, BackupReport& report) {
+    execute(target, "PRAGMA journal_mode = DELETE;");
+    requireIntact(target, targetPath);
+    sqlite3_stmt* raw = nullptr;
+    if (sqlite3_prepare_v2(target, "PRAGMA page_size;", -1, &raw, nullptr) == SQLITE_OK &&
+        sqlite3_step(raw) == SQLITE_ROW) {
+        report.bytes = report.pages * sqlite3_column_int64(raw, 0);
+    }
+    sqlite3_finalize(raw);
+    report.succeeded = true;
+}
+
+void recordThroughput(metrics::Clock::time_point start, BackupReport& report) {
+    report.elapsedMs = static_cast<std::int64_t>(metrics::ScopedTimer::elapsedNanoseconds(start) / 1000000U);
+    const double seconds = std::max<std::int64_t>(1, report.elapsedMs) / 1000.0;
+    report.pagesPerSecond = static_cast<double>(report.pages) / seconds;
+    report.bytesPerSecond = static_cast<double>(report.bytes) / seconds;
+}
+
+QString baseName(const std::string& databasePath) {
+    return QFileInfo(QString::fromStdString(databasePath)).completeBaseName();
+}
+
+}  // namespace
+
+BackupService::BackupService(std::string databasePath, Options options, QObject* parent)
+    : QObject(parent),
+      m_databasePath(std::move(databasePath)),
+      m_options(std::move(options)),
+      m_pool(std::make_unique<QThreadPool>()),
+      m_timer(std::make_unique<QTimer>()) {
+    qRegisterMetaType<BackupReport>("rove::data::BackupReport");
+    m_pool->setMaxThreadCount(1);
+    m_timer->setTimerType(Qt::VeryCoarseTimer);
+    QObject::connect(m_timer.get(), &QTimer::timeout, this, [this]() { requestBackup(); });
+}
+
+BackupService::~BackupService() { stop(); }
+
+void BackupService::setMemorySource(DatabaseManager* database) { m_memorySource = database; }
+
+void BackupService::start() {
+    if (m_options.interval.count() <= 0) {
+        return;
+    }
+    m_timer->setInterval(std::chrono::duration_cast<std::chrono::milliseconds>(m_options.interval));
+    m_timer->start();
+}
+
+bool BackupService::requestBackup() {
+    if (m_databasePath.empty() || m_databasePath == ":memory:" || m_running.exchange(true)) {
+        return false;
+    }
+    m_cancelled.store(false);
+    m_pool->start([this]() { runBackup(); });
+    return true;
+}
+
+void BackupService::stop() {
+    m_timer->stop();
+    m_cancelled.store(true);
+    m_pool->waitForDone();  // 中文：工作线程访问 this，析构前必须结束；取消后最多再等一步的复制时间。
+}
+
+/**
+ * @brief 源连接只读打开并在读事务中先读一次，固定 WAL 快照；sqlite3_backup_step 发现源已有读事务时不会自行开关，
+ *        整个备份因此复制同一快照，其他连接的提交既不被阻塞也不会让备份重来。
+ * 中文：目标复制完成后切回 DELETE 日志模式，备份成为不依赖 -wal/-shm 的单个文件，随后做 quick_check。
+ */
+BackupReport BackupService::backupTo(const std::string& databasePath, const std::string& targetPath,
+                                     int pagesPerStep, std::chrono::milliseconds pause,
+                                     const std::atomic<bool>* cancelled) {
+    BackupReport report;
+    report.filePath = targetPath;
+    const auto start = metrics::Clock::now();
+    try {
+        auto source = openConnection(databasePath, SQLITE_OPEN_READONLY);
+        auto target = openConnection(targetPath, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+        execute(source.get(), "BEGIN; SELECT COUNT(*) FROM sqlite_schema;");
+
+        sqlite3_backup* backup = sqlite3_backup_init(target.get(), "main", source.get(), "main");
+        if (backup == nullptr) {
+            throw std::runtime_error(sqliteError("Failed to start backup", target.get()));
+        }
+        int rc = SQLITE_OK;
+        while (true) {
+            if (cancelled != nullptr && cancelled->load()) {
+                rc = SQLITE_INTERRUPT;
+                break;
+            }
+            rc = sqlite3_backup_step(backup, std::max(1, pagesPerStep));
+            ++report.steps;
+            if (rc == SQLITE_DONE) {
+                break;
+            }
+            if (rc != SQLITE_OK && rc != SQLITE_BUSY && rc != SQLITE_LOCKED) {
+                break;
+            }
+            std::this_thread::sleep_for(pause);
+        }
+        report.pages = sqlite3_backup_pagecount(backup);
+        sqlite3_backup_finish(backup);
+        sqlite3_exec(source.get(), "COMMIT;", nullptr, nullptr, nullptr);
+        if (rc == SQLITE_INTERRUPT) {
+            throw std::runtime_error("Backup cancelled");
+        }
+        if (rc != SQLITE_DONE) {
+            throw std::runtime_error(sqliteError("Backup step failed", target.get()));
+        }
+        finalizeTarget(target.get(), targetPath, report);
+    } catch (const std::exception& error) {
+        report.error = error.what();
+    }
+    recordThroughput(start, report);
+    return report;
+}
+
+/**
+ * @brief 内存模式下以写连接的内存库为源，磁盘上的检查点文件可能落后一个检查点间隔，不能作为备份源。
+ * 中文：复制经 DatabaseManager::copyMemoryDatabase 分步进行，每步只短暂持有写连接锁；收尾与 backupTo 相同。
+ */
+BackupReport BackupService::backupMemoryTo(DatabaseManager& database, const std::string& targetPath, int pagesPerStep,
+                                           std::chrono::milliseconds pause, const std::atomic<bool>* cancelled) {
+    BackupReport report;
+    report.filePath = targetPath;
+    const auto start = metrics::Clock::now();
+    try {
+        auto target = openConnection(targetPath, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+        report.pages = database.copyMemoryDatabase(target.get(), pagesPerStep, pause, cancelled, &report.steps);
+        finalizeTarget(target.get(), targetPath, report);
+    } catch (const std::exception& error) {
+        report.error = error.what();
+    }
+    recordThroughput(start, report);
+    return report;
+}
+
+void BackupService::restore(const std::string& backupPath, const std::string& databasePath) {
+    auto source = openConnection(backupPath, SQLITE_OPEN_READONLY);
+    requireIntact(source.get(), backupPath);
+    auto target = openConnection(databasePath, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+
+    sqlite3_backup* backup = sqlite3_backup_init(target.get(), "main", source.get(), "main");
+    if (backup == nullptr) {
+        throw std::runtime_error(sqliteError("Failed to start restore", target.get()));
+    }
+    const int rc = sqlite3_backup_step(backup, -1);
+    sqlite3_backup_finish(backup);
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(sqliteError("Restore from " + backupPath + " failed", target.get()));
+    }
+}
+
+void BackupService::runBackup() {
+    QDir().mkpath(QString::fromStdString(m_options.directory));
+    const std::string finalPath = timestampedPath();
+    const std::string partialPath = finalPath + ".part";
+    QFile::remove(QString::fromStdString(partialPath));
+
+    BackupReport report =
+        m_memorySource != nullptr
+            ? backupMemoryTo(*m_memorySource, partialPath, m_options.pagesPerStep, m_options.pauseBetweenSteps,
+                             &m_cancelled)
+            : backupTo(m_databasePath, partialPath, m_options.pagesPerStep, m_options.pauseBetweenSteps, &m_cancelled);
+    if (report.succeeded && !QFile::rename(QString::fromStdString(partialPath), QString::fromStdString(finalPath))) {
+        report.succeeded = false;
+        report.error = "Failed to move backup into place";
+    }
+    if (report.succeeded) {
+        report.filePath = finalPath;
+        rotate();
+    } else {
+        QFile::remove(QString::fromStdString(partialPath));
+    }
+
+    if (metrics::isEnabled()) {
+        auto& registry = metrics::Registry::instance();
+        const char* outcome = report.succeeded ? "ok" : "failed";
+        registry.counter(metrics::Subsystem::Database, "backup.runs", outcome).add(1);
+        registry.counter(metrics::Subsystem::Database, "backup.bytes", outcome).add(report.bytes);
+        registry.histogram(metrics::Subsystem::Database, "backup.elapsed", outcome)
+            .record(static_cast<std::uint64_t>(report.elapsedMs) * 1000000U);
+    }
+    if (report.succeeded) {
+        qInfo().noquote() << QStringLiteral("数据库备份完成: %1，%2 页 / %3 KiB，%4 ms（%5 页/秒，%6 KiB/秒）")
+                                 .arg(QString::fromStdString(report.filePath))
+                                 .arg(static_cast<qint64>(report.pages))
+                                 .arg(static_cast<qint64>(report.bytes / 1024))
+                                 .arg(static_cast<qint64>(report.elapsedMs))
+                                 .arg(report.pagesPerSecond, 0, 'f', 0)
+                                 .arg(report.bytesPerSecond / 1024.0, 0, 'f', 0);
+    } else {
+        qWarning() << "数据库备份失败:" << QString::fromStdString(report.error);
+    }
+
+    m_running.store(false);
+    QMetaObject::invokeMethod(this, [this, report]() { emit backupFinished(report); }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief 备份文件名以时间戳结尾，按文件名排序即按时间排序。
+ */
+void BackupService::rotate() const {
+    const QDir directory(QString::fromStdString(m_options.directory));
+    const QStringList backups = directory.entryList({baseName(m_databasePath) + QStringLiteral("-*.db")},
+                                                    QDir::Files, QDir::Name);
+    for (int i = 0; i + std::max(1, m_options.keepCount) < backups.size(); ++i) {
+        QFile::remove(directory.filePath(backups.at(i)));
+    }
+}
+
+std::string BackupService::timestampedPath() const {
+    const QString name = baseName(m_databasePath) + QLatin1Char('-') +
+                         QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss")) +
+                         QStringLiteral(".db");
+    return QDir(QString::fromStdString(m_options.directory)).filePath(name).toStdString();
+}
+
+}  // namespace rove::data
@@ -0,0 +1,136 @@
+#ifndef BACKUPSERVICE_H
+#define BACKUPSERVICE_H
+
+#include <QMetaType>
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace rove::data {
+
+class DatabaseManager;
+
+/**
+ * @brief 一次在线备份的结果与吞吐。
+ */
+struct BackupReport {
+    bool succeeded = false;
+    std::string filePath;            //!< 成功时为轮转目录中的备份文件
+    std::string error;               //!< 失败原因（succeeded 为 false 时有效）
+    std::int64_t pages = 0;          //!< 复制的页数
+    std::int64_t bytes = 0;          //!< 复制的字节数（页数 × 页大小）
+    std::int64_t steps = 0;          //!< sqlite3_backup_step 调用次数
+    std::int64_t elapsedMs = 0;      //!< 含批次间让步的总耗时
+    double pagesPerSecond = 0.0;
+    double bytesPerSecond = 0.0;
+};
+
+/**
+ * @class BackupService
+ * @brief 基于 sqlite3_backup 的后台在线备份：按计划把数据库复制到备份目录，保留最近若干份。
+ * 中文：备份使用独立的只读连接作为源，整个过程不触碰 DatabaseManager 的写锁；源连接先开启读事务固定 WAL 快照，
+ *       期间的写入不会迫使备份重新开始，写事务也不会被阻塞。每次 sqlite3_backup_step 只复制 pagesPerStep 页，
+ *       步与步之间休眠 pauseBetweenSteps 让出磁盘带宽。备份先写入临时文件，完成并校验后再改名为带时间戳的
+ *       正式文件，中途失败或进程退出不会留下半份备份。
+ *       内存模式下文件只是检查点，设置 setMemorySource 后改以内存库为源，经写连接分步复制（见 backupMemoryTo）。
+ *       日志归档库（growth.db.archive）是独立文件，不在备份范围内。
+ */
+class BackupService : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 备份计划与轮转配置。
+     */
+    struct Options {
+        std::string directory;                                   //!< 备份目录，不存在时自动创建
+        std::chrono::minutes interval{std::chrono::hours(6)};   //!< 计划备份间隔；0 表示只手动触发
+        int pagesPerStep = 256;                                  //!< 每步复制的页数（4 KiB 页约 1 MiB）
+        std::chrono::milliseconds pauseBetweenSteps{5};         //!< 步间让步时长
+        int keepCount = 5;                                       //!< 轮转保留的备份份数
+    };
+
+    BackupService(std::string databasePath, Options options, QObject* parent = nullptr);
+    ~BackupService() override;
+
+    /**
+     * @brief 内存模式下设置备份源；为空时从 databasePath 指向的文件备份。须在 start 之前设置。
+     */
+    void setMemorySource(DatabaseManager* database);
+
+    /**
+     * @brief 启动计划定时器；首次备份在一个间隔之后执行，不拖慢启动。
+     */
+    void start();
+
+    /**
+     * @brief 立即在后台执行一次备份；已有备份进行中时忽略。
+     * @return 是否已排队。
+     */
+    bool requestBackup();
+
+    /**
+     * @brief 请求中止进行中的备份并等待后台线程结束，析构与退出前调用。
+     */
+    void stop();
+
+    /**
+     * @brief 在调用线程同步执行一次备份（不轮转），供 requestBackup 的工作线程与工具程序使用。
+     * @throws 不抛出异常，失败信息写入报告。
+     */
+    [[nodiscard]] static BackupReport backupTo(const std::string& databasePath, const std::string& targetPath,
+                                               int pagesPerStep, std::chrono::milliseconds pause,
+                                               const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * @brief 在调用线程同步把内存库备份到 targetPath（不轮转），步间只短暂持有写连接锁。
+     * @throws 不抛出异常，失败信息写入报告。
+     */
+    [[nodiscard]] static BackupReport backupMemoryTo(DatabaseManager& database, const std::string& targetPath,
+                                                     int pagesPerStep, std::chrono::milliseconds pause,
+                                                     const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * @brief 用备份文件覆盖数据库内容。
+     * 中文：必须在 DatabaseManager::initialize 之前调用——运行中的连接持有旧页缓存与各管理器的内存状态，
+     *       热替换无法保证一致。先对备份执行 quick_check，校验失败时不改动目标库。
+     * @throws std::runtime_error 备份损坏或复制失败。
+     */
+    static void restore(const std::string& backupPath, const std::string& databasePath);
+
+signals:
+    void backupFinished(const rove::data::BackupReport& report);
+
+private:
+    /**
+     * @brief 工作线程入口：备份到临时文件，成功后改名并轮转，结果排队回到本对象所在线程发出。
+     */
+    void runBackup();
+
+    /**
+     * @brief 删除超出 keepCount 的最旧备份。
+     */
+    void rotate() const;
+
+    [[nodiscard]] std::string timestampedPath() const;
+
+    std::string m_databasePath;
+    Options m_options;
+    DatabaseManager* m_memorySource = nullptr;  //!< 非空时从内存库备份
+    std::unique_ptr<QThreadPool> m_pool;  //!< 单线程，保证同一时刻至多一份备份
+    std::unique_ptr<QTimer> m_timer;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_cancelled{false};
+};
+
+}  // namespace rove::data
+
+Q_DECLARE_METATYPE(rove::data::BackupReport)
+
+#endif  // BACKUPSERVICE_H
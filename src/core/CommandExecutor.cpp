@@ -0,0 +1,51 @@
+#include "CommandExecutor.h"
+
+#include <QDebug>
+
+namespace rove::data {
+
+CommandExecutor::CommandExecutor(QObject* parent)
+    : QObject(parent), m_thread(std::make_unique<QThread>()), m_context(std::make_unique<QObject>()) {
+    m_thread->setObjectName(QStringLiteral("rove-data"));
+    m_context->moveToThread(m_thread.get());
+}
+
+CommandExecutor::~CommandExecutor() { stop(); }
+
+void CommandExecutor::start() {
+    if (!m_stopped && !m_thread->isRunning()) {
+        m_thread->start();
+    }
+}
+
+void CommandExecutor::stop() {
+    if (m_stopped) {
+        return;
+    }
+    m_stopped = true;
+    if (!m_thread->isRunning()) {
+        return;
+    }
+    // 中文：退出请求排在已提交的命令之后，quit 生效前队列中的命令都会执行完。
+    QThread* thread = m_thread.get();
+    QMetaObject::invokeMethod(m_context.get(), [thread]() { thread->quit(); }, Qt::QueuedConnection);
+    m_thread->wait();
+}
+
+void CommandExecutor::deliver(quint64 commandId,
+                              const QString& name,
+                              const QString& error,
+                              const std::function<void()>& rollback) {
+    if (error.isEmpty()) {
+        emit commandFinished(commandId, name);
+        return;
+    }
+    ROVE_COUNTER_ADD(Database, "command.failed", 1);
+    qWarning() << "命令执行失败:" << name << error;
+    if (rollback) {
+        rollback();
+    }
+    emit commandFailed(commandId, name, error);
+}
+
+}  // namespace rove::data
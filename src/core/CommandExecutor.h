@@ -0,0 +1,140 @@
+#ifndef COMMANDEXECUTOR_H
+#define COMMANDEXECUTOR_H
+
+#include <QFuture>
+#include <QObject>
+#include <QPromise>
+#include <QString>
+#include <QThread>
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Metrics.h"
+
+namespace rove::data {
+
+/**
+ * @class CommandExecutor
+ * @brief 数据线程上的命令执行器：界面把管理器的写操作作为命令提交，GUI 线程不再等待数据库。
+ * 中文：命令按提交顺序在同一条数据线程上逐个执行，写者之间天然串行；submit() 立即返回 QFuture，
+ *       结果与异常经 QPromise 送回。界面可先做乐观更新，并随命令登记回滚函数：命令抛异常时，
+ *       回滚在执行器所在线程（GUI 线程）先于 future 的后续处理运行，随后发出 commandFailed。
+ *       命令内发出的业务信号在数据线程上直连派发（成就推进、自动日志仍并入命令的工作单元），
+ *       界面一侧的订阅者由 Qt 自动排队到 GUI 线程。
+ */
+class CommandExecutor : public QObject {
+    Q_OBJECT
+
+public:
+    explicit CommandExecutor(QObject* parent = nullptr);
+    ~CommandExecutor() override;
+
+    CommandExecutor(const CommandExecutor&) = delete;
+    CommandExecutor& operator=(const CommandExecutor&) = delete;
+
+    /**
+     * @brief 启动数据线程；重复调用无效。
+     */
+    void start();
+
+    /**
+     * @brief 执行完已提交的命令后结束数据线程并等待其退出；之后提交的命令不再执行。
+     * 中文：须在 aboutToQuit 中、刷写成就进度与日志之前调用，保证最后一次操作已经落盘。
+     */
+    void stop();
+
+    /**
+     * @brief 数据线程，可供需要与命令同线程的对象 moveToThread。
+     */
+    [[nodiscard]] QThread* dataThread() const noexcept { return m_thread.get(); }
+
+    /**
+     * @brief 提交命令，立即返回其结果的 future。
+     * @param name 命令名，用于失败通知与埋点。
+     * @param work 在数据线程执行的操作，返回值即 future 的结果；抛出的异常转交给 future。
+     * @param rollback 命令失败时在执行器线程调用，撤销界面的乐观更新；可为空。
+     * 中文：stop() 之后提交的命令不再执行，其 future 立即以异常结束，回滚与 commandFailed 照常投递。
+     */
+    template <typename Work>
+    QFuture<std::invoke_result_t<Work>> submit(const QString& name, Work work, std::function<void()> rollback = {});
+
+signals:
+    void commandFinished(quint64 commandId, const QString& name);
+    void commandFailed(quint64 commandId, const QString& name, const QString& message);
+
+private:
+    /**
+     * @brief 命令结束后回到执行器线程：失败时先回滚再发出 commandFailed，成功时发出 commandFinished。
+     */
+    void deliver(quint64 commandId, const QString& name, const QString& error, const std::function<void()>& rollback);
+
+    std::unique_ptr<QThread> m_thread;
+    std::unique_ptr<QObject> m_context;  //!< 住在数据线程上，命令以排队调用投递给它
+    std::atomic<quint64> m_nextId{0};
+    bool m_stopped = false;
+};
+
+template <typename Work>
+QFuture<std::invoke_result_t<Work>> CommandExecutor::submit(const QString& name,
+                                                            Work work,
+                                                            std::function<void()> rollback) {
+    using Result = std::invoke_result_t<Work>;
+    auto promise = std::make_shared<QPromise<Result>>();
+    QFuture<Result> future = promise->future();
+    promise->start();
+    const quint64 commandId = ++m_nextId;
+    if (m_stopped) {
+        // 中文：数据线程已退出，排队的命令永远不会运行；直接让 future 失败，免得调用方一直等待。
+        const QString error = QStringLiteral("命令执行器已停止");
+        promise->setException(std::make_exception_ptr(std::runtime_error(error.toStdString())));
+        QMetaObject::invokeMethod(
+            this,
+            [this, commandId, name, error, rollback = std::move(rollback)]() {
+                deliver(commandId, name, error, rollback);
+            },
+            Qt::QueuedConnection);
+        promise->finish();
+        return future;
+    }
+    QMetaObject::invokeMethod(
+        m_context.get(),
+        [this, commandId, name, promise, work = std::move(work), rollback = std::move(rollback)]() mutable {
+            QString error;
+            {
+                ROVE_SCOPED_TIMER(Database, "command.run");
+                try {
+                    if constexpr (std::is_void_v<Result>) {
+                        work();
+                    } else {
+                        promise->addResult(work());
+                    }
+                } catch (const std::exception& e) {
+                    error = QString::fromUtf8(e.what());
+                    promise->setException(std::current_exception());
+                } catch (...) {
+                    error = QStringLiteral("未知错误");
+                    promise->setException(std::current_exception());
+                }
+            }
+            // 中文：先排队投递回滚与通知，再结束 promise，future 的后续处理因此总在回滚之后运行。
+            QMetaObject::invokeMethod(
+                this,
+                [this, commandId, name, error, rollback = std::move(rollback)]() {
+                    deliver(commandId, name, error, rollback);
+                },
+                Qt::QueuedConnection);
+            promise->finish();
+        },
+        Qt::QueuedConnection);
+    return future;
+}
+
+}  // namespace rove::data
+
+#endif  // COMMANDEXECUTOR_H
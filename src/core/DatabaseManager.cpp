@@ -1,12 +1,24 @@
 #include "DatabaseManager.h"
 
+#include <QByteArray>
 #include <QDateTime>
+#include <QDebug>
 
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <exception>
+#include <iterator>
+#include <limits>
 #include <sstream>
+#include <string_view>
 #include <stdexcept>
+#include <utility>
 #include <numeric>
 
 #include "Achievement.h"
+#include "LogTemplate.h"
+#include "RecordCodec.h"
 #include "ShopItem.h"
 #include "Task.h"
 
@@ -33,1663 +45,6665 @@ std::string buildErrorMessage(const std::string& prefix, sqlite3* handle) {
     }
     return oss.str();
 }
-}  // namespace
 
 /**
- * @brief Construct the singleton with a null sqlite handle so RAII can attach later.
- * 中文：构造函数保持 sqlite 句柄为空，等待 initialize() 打开数据库后才交由 RAII 管理。
+ * @brief Busy handler equivalent to sqlite3_busy_timeout that counts give-ups as "sqlite.busy".
+ * 中文：与 sqlite3_busy_timeout 等价的忙等回调；等待超时、即将向调用方返回 SQLITE_BUSY 时计入 "sqlite.busy"。
  *
- * Business logic: delaying actual IO operations avoids unnecessary disk access during program start.
- * 中文：推迟实际 IO 操作可减少程序启动期间的磁盘访问，提高响应速度。
+ * Business logic: SQLite invokes the handler only when a lock is actually contended, so the counter
+ * reflects real busy results instead of whatever error code happens to be pending when a message is built.
+ * 中文：只有真正发生锁争用时 SQLite 才会调用该回调，计数因此对应实际返回的 SQLITE_BUSY，
+ *       而不是拼接错误信息时恰好残留的错误码。退避序列与 SQLite 内置实现一致。
  *
- * @return true 当创建了最外层事务。中文：若当前调用成为最外层事务则返回 true。
+ * @param context Pointer to the std::atomic<int> timeout in milliseconds. 中文：指向超时毫秒数的原子变量。
+ * @param attempts Number of prior invocations for this lock. 中文：本次锁等待已调用的次数。
+ * @return Non-zero to retry, zero to give up. 中文：非零表示重试，零表示放弃并返回 SQLITE_BUSY。
  * @throws None. 中文：不抛出异常。
  */
-DatabaseManager::DatabaseManager()
-    : m_db(nullptr, &sqlite3_close),
-      m_databasePath(),
-      m_mutex(),
-      m_initialized(false),
-      m_transactionDepth(0),
-      m_transactionLock() {}
+int countingBusyHandler(void* context, int attempts) {
+    static constexpr int kDelaysMs[] = {1, 2, 5, 10, 15, 20, 25, 25, 25, 50, 50, 100};
+    static constexpr int kDelayCount = static_cast<int>(sizeof(kDelaysMs) / sizeof(kDelaysMs[0]));
+    const int timeoutMs = static_cast<const std::atomic<int>*>(context)->load(std::memory_order_relaxed);
+    int delayMs = kDelaysMs[kDelayCount - 1];
+    int elapsedMs = 0;
+    if (attempts < kDelayCount) {
+        delayMs = kDelaysMs[attempts];
+        for (int i = 0; i < attempts; ++i) {
+            elapsedMs += kDelaysMs[i];
+        }
+    } else {
+        for (int i = 0; i < kDelayCount; ++i) {
+            elapsedMs += kDelaysMs[i];
+        }
+        elapsedMs += delayMs * (attempts - kDelayCount);
+    }
+    if (elapsedMs + delayMs > timeoutMs) {
+        delayMs = timeoutMs - elapsedMs;
+        if (delayMs <= 0) {
+            ROVE_COUNTER_ADD(Database, "sqlite.busy", 1);
+            return 0;
+        }
+    }
+    sqlite3_sleep(delayMs);
+    return 1;
+}
 
 /**
- * @brief Destructor closes the connection automatically thanks to std::unique_ptr.
- * 中文：析构函数依赖 std::unique_ptr 自动关闭连接，符合 RAII 原则。
- *
- * Business logic: keeping cleanup centralized means every module can trust DatabaseManager to free
- * resources when the application shuts down. 中文：集中化清理逻辑可确保应用退出时自动释放资源。
+ * @brief Detect statements that change the schema and therefore invalidate cached plans.
+ * 中文：判断 SQL 是否为结构变更语句（CREATE/DROP/ALTER/ATTACH/DETACH），此类语句会使缓存的执行计划失效。
  *
- * @return void. 中文：无返回值。
+ * @param sql Statement text. 中文：SQL 文本。
+ * @return true for DDL statements. 中文：DDL 语句返回 true。
  * @throws None. 中文：不抛出异常。
  */
-DatabaseManager::~DatabaseManager() { closeDatabase(); }
+bool isSchemaStatement(const std::string& sql) noexcept {
+    std::size_t pos = 0;
+    while (pos < sql.size() && std::isspace(static_cast<unsigned char>(sql[pos])) != 0) {
+        ++pos;
+    }
+    auto startsWith = [&sql, pos](const char* keyword) {
+        std::size_t i = 0;
+        for (; keyword[i] != '\0'; ++i) {
+            if (pos + i >= sql.size() ||
+                std::toupper(static_cast<unsigned char>(sql[pos + i])) != keyword[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    return startsWith("CREATE") || startsWith("DROP") || startsWith("ALTER") || startsWith("ATTACH") ||
+           startsWith("DETACH");
+}
 
 /**
- * @brief Retrieve the single global DatabaseManager instance (Singleton pattern).
- * 中文：获取全局唯一的 DatabaseManager 单例，确保所有模块复用同一连接。
+ * @brief Count UTF-8 code points; trigram tokens need at least three characters.
+ * 中文：统计 UTF-8 字符数；trigram 分词器要求检索词至少 3 个字符才能走索引。
  *
- * Business logic: singleton guarantees consistent transaction boundaries and simplifies dependency injection
- * in Qt widgets. 中文：单例保证事务边界一致，简化 Qt 控件的依赖注入。
+ * @param text UTF-8 text. 中文：UTF-8 文本。
+ * @return Code point count. 中文：字符数。
+ * @throws None. 中文：不抛出异常。
+ */
+std::size_t utf8Length(const std::string& text) noexcept {
+    std::size_t count = 0;
+    for (unsigned char c : text) {
+        if ((c & 0xC0U) != 0x80U) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Quote a keyword as a single FTS5 phrase so user input cannot inject query syntax.
+ * 中文：把关键词包装为 FTS5 短语并转义双引号，防止用户输入被解析为查询语法。
  *
- * @return Reference to the singleton. 中文：返回单例引用。
+ * @param keyword Raw keyword. 中文：原始关键词。
+ * @return Phrase literal. 中文：短语字面量。
  * @throws None. 中文：不抛出异常。
  */
-DatabaseManager& DatabaseManager::instance() {
-    static DatabaseManager instance;
-    return instance;
+std::string toFtsPhrase(const std::string& keyword) {
+    std::string phrase = "\"";
+    for (char c : keyword) {
+        phrase += c;
+        if (c == '"') {
+            phrase += '"';
+        }
+    }
+    phrase += '"';
+    return phrase;
+}
+
+constexpr std::size_t kTrigramMinimumLength = 3;
+
+/**
+ * @brief 冷日志压缩格式：首字节为格式号，其后是 qCompress 输出（4 字节原长 + zlib 流）。
+ * 中文：压缩后的正文以 BLOB 存回 logs.content，存储类型本身就是标记，未压缩的行仍是 TEXT；
+ *       格式号为将来换用带字典的编码预留，读取时遇到未知格式视为损坏。
+ */
+constexpr char kCompressedLogFormat = 0x01;
+constexpr int kLogCompressionLevel = 9;
+constexpr std::size_t kMinCompressibleLogBytes = 64;  // 中文：更短的正文压缩后通常反而变长。
+
+std::optional<std::string> compressLogContent(std::string_view text) {
+    const QByteArray packed =
+        qCompress(reinterpret_cast<const uchar*>(text.data()), static_cast<int>(text.size()), kLogCompressionLevel);
+    if (packed.isEmpty() || static_cast<std::size_t>(packed.size()) + 1 >= text.size()) {
+        return std::nullopt;
+    }
+    std::string blob;
+    blob.reserve(static_cast<std::size_t>(packed.size()) + 1);
+    blob += kCompressedLogFormat;
+    blob.append(packed.constData(), static_cast<std::size_t>(packed.size()));
+    return blob;
+}
+
+std::optional<std::string> inflateLogContent(const void* data, int bytes) {
+    const auto* raw = static_cast<const char*>(data);
+    if (raw == nullptr || bytes < 1 || raw[0] != kCompressedLogFormat) {
+        return std::nullopt;
+    }
+    const QByteArray text = qUncompress(reinterpret_cast<const uchar*>(raw + 1), bytes - 1);
+    if (text.isEmpty()) {
+        return std::nullopt;
+    }
+    return std::string(text.constData(), static_cast<std::size_t>(text.size()));
 }
 
 /**
- * @brief Initialize database connection, ensure schema, and seed default data.
- * 中文：初始化数据库连接、确保数据表存在并写入默认数据。
+ * @brief SQL function render_log(template_id, content): expand templated auto-log text.
+ * 中文：SQL 函数 render_log(template_id, content)，展开模板日志的文本；LIKE 检索与归档经由它看到渲染后的文本。
+ *       每个连接（写连接与只读连接）打开后都要注册。content 为压缩后的 BLOB 时先解压，查询因此无需区分冷热日志。
+ *       函数只在本程序的连接上存在，表结构（触发器、视图）不得引用它，否则其他工具打开数据库写日志会失败。
+ */
+void renderLogFunction(sqlite3_context* context, int, sqlite3_value** argv) {
+    try {
+        std::string inflated;
+        std::string_view args;
+        if (sqlite3_value_type(argv[1]) == SQLITE_BLOB) {
+            auto text = inflateLogContent(sqlite3_value_blob(argv[1]), sqlite3_value_bytes(argv[1]));
+            if (!text.has_value()) {
+                sqlite3_result_error(context, "render_log: corrupt compressed log content", -1);
+                return;
+            }
+            inflated = std::move(*text);
+            args = inflated;
+        } else {
+            const auto* raw = reinterpret_cast<const char*>(sqlite3_value_text(argv[1]));
+            args = std::string_view(raw == nullptr ? "" : raw, static_cast<std::size_t>(sqlite3_value_bytes(argv[1])));
+        }
+        const std::string rendered = renderLogTemplate(sqlite3_value_int(argv[0]), args);
+        sqlite3_result_text(context, rendered.data(), static_cast<int>(rendered.size()), SQLITE_TRANSIENT);
+    } catch (const std::bad_alloc&) {
+        sqlite3_result_error_nomem(context);
+    }
+}
+
+void registerLogFunctions(sqlite3* handle) {
+    sqlite3_create_function_v2(handle, "render_log", 2, SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS,
+                               nullptr, &renderLogFunction, nullptr, nullptr, nullptr);
+}
+
+/**
+ * @brief Read a column as raw bytes; binary condition blobs may contain NUL.
+ * 中文：按原始字节读取列值，二进制条件编码可能包含 NUL，不能用 C 字符串截断。
  *
- * Business logic: explicit initialization lets the UI show friendly diagnostics if the path is invalid,
- * and ensures schema creation runs only once. 中文：显式初始化让界面在路径无效时提供提示，并确保建表只执行一次。
+ * @param statement Stepped statement. 中文：已 step 的语句。
+ * @param column Column index. 中文：列索引。
+ * @return Column bytes, empty for NULL. 中文：列字节，NULL 时为空。
+ * @throws None. 中文：不抛出异常。
+ */
+std::string readBytes(sqlite3_stmt* statement, int column) {
+    const void* data = sqlite3_column_blob(statement, column);
+    const int size = sqlite3_column_bytes(statement, column);
+    if (data == nullptr || size <= 0) {
+        return {};
+    }
+    return std::string(static_cast<const char*>(data), static_cast<std::size_t>(size));
+}
+
+/**
+ * @brief Overwrite target with a TEXT column, reusing its capacity.
+ * 中文：把 TEXT 列写入已有字符串，复用其容量；流式读取逐行复用同一条记录时，
+ *       未被调用方取走的字段不再逐行分配。NULL 写为空串。
  *
- * @param databasePath Path to SQLite file. 中文：SQLite 文件路径。
- * @return void. 中文：无返回值。
- * @throws std::runtime_error When database open or schema bootstrap fails. 中文：打开数据库或建表失败时抛出异常。
+ * @param target String to overwrite. 中文：被覆盖的字符串。
+ * @param statement Stepped statement. 中文：已 step 的语句。
+ * @param column Column index. 中文：列索引。
+ * @throws std::bad_alloc When growing target fails. 中文：扩容失败时抛出。
  */
-void DatabaseManager::initialize(const std::string& databasePath) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+void assignText(std::string& target, sqlite3_stmt* statement, int column) {
+    const unsigned char* text = sqlite3_column_text(statement, column);
+    if (text == nullptr) {
+        target.clear();
+        return;
+    }
+    target.assign(reinterpret_cast<const char*>(text),
+                  static_cast<std::size_t>(sqlite3_column_bytes(statement, column)));
+}
 
-    if (m_initialized && m_db != nullptr && databasePath == m_databasePath) {
-        // English: Skip redundant open to preserve active connections.
-        // 中文：若已连接同一路径则直接返回，保持现有连接和事务。
+/**
+ * @brief Overwrite target with a BLOB column, reusing its capacity.
+ * 中文：按原始字节覆盖 target，语义同 readBytes。
+ */
+void assignBytes(std::string& target, sqlite3_stmt* statement, int column) {
+    const void* data = sqlite3_column_blob(statement, column);
+    const int size = sqlite3_column_bytes(statement, column);
+    if (data == nullptr || size <= 0) {
+        target.clear();
         return;
     }
+    target.assign(static_cast<const char*>(data), static_cast<std::size_t>(size));
+}
 
-    closeDatabase();
-    openDatabase(databasePath);
-    ensureUserTable();
-    ensureTaskTable();
-    ensureAchievementTable();
-    ensureShopTable();
-    ensureInventoryTable();
-    ensureLogTable();
-    ensureForgivenLogTable();
-    ensureGrowthSnapshotTable();
-    seedDefaultTasks();
-    seedDefaultAchievements();
-    seedDefaultShopItems();
-    m_initialized = true;
+/**
+ * @brief Column names backing User::AttributeSet, in codec::attributeFields order.
+ * 中文：六维属性对应的整数列名，顺序与 codec::attributeFields 一致。
+ */
+constexpr const char* kAttributeColumns[codec::kAttributeFieldCount] = {
+    "attr_execution", "attr_perseverance", "attr_decision", "attr_knowledge", "attr_social", "attr_pride"};
+
+/**
+ * @brief Bind an AttributeSet to six consecutive placeholders.
+ * 中文：将六维属性绑定到连续的六个占位符。
+ *
+ * @param statement Prepared statement. 中文：已准备的语句。
+ * @param firstIndex Index of the attr_execution placeholder. 中文：attr_execution 占位符序号。
+ * @param set Attribute values. 中文：属性值。
+ * @return Next free placeholder index. 中文：下一个可用占位符序号。
+ * @throws None. 中文：不抛出异常。
+ */
+int bindAttributeSet(sqlite3_stmt* statement, int firstIndex, const User::AttributeSet& set) {
+    for (int value : codec::attributeFields(set)) {
+        sqlite3_bind_int(statement, firstIndex++, value);
+    }
+    return firstIndex;
 }
 
 /**
- * @brief Report whether a valid sqlite3 handle exists.
- * 中文：报告当前是否存在有效 sqlite3 句柄。
+ * @brief Read six consecutive attr_* columns into an AttributeSet.
+ * 中文：从连续六列读取六维属性。
  *
- * Business logic: allows UI to gray-out DB-dependent actions when disconnected. 中文：用于界面判断是否禁用依赖数据库的按钮。
+ * @param statement Stepped statement. 中文：已 step 的语句。
+ * @param firstColumn Index of the attr_execution column. 中文：attr_execution 列索引。
+ * @return Attribute values. 中文：属性值。
+ * @throws None. 中文：不抛出异常。
+ */
+User::AttributeSet readAttributeSet(sqlite3_stmt* statement, int firstColumn) {
+    codec::AttributeFields fields{};
+    for (int& value : fields) {
+        value = sqlite3_column_int(statement, firstColumn++);
+    }
+    return codec::attributesFromFields(fields);
+}
+
+/**
+ * @brief Value columns shared by growth_snapshots and its rollup tables.
+ * 中文：成长快照表与聚合表共用的数值列，顺序与 bindSnapshotValues 一致。
+ */
+constexpr const char* kSnapshotValueColumns[] = {"user_level",   "growth_points", "execution",         "perseverance",
+                                                 "decision",     "knowledge",     "social",            "pride",
+                                                 "achievement_count", "completed_tasks", "failed_tasks", "manual_log_count"};
+static_assert(std::size(kSnapshotValueColumns) == kSnapshotColumnCount,
+              "SnapshotColumn must mirror the snapshot value columns");
+
+/**
+ * @brief One rollup tier: table name and the SQL expression mapping ?1 (timestamp) to its bucket key.
+ * 中文：一个聚合层级：表名与把 ?1 时间戳映射为桶起点的 SQL 表达式（周桶以周一为起点）。
+ */
+struct GrowthRollupTier {
+    DatabaseManager::SnapshotResolution resolution;
+    const char* table;
+    const char* bucketExpression;
+};
+
+constexpr GrowthRollupTier kGrowthRollupTiers[] = {
+    {DatabaseManager::SnapshotResolution::Hourly, "growth_snapshots_hourly", "strftime('%Y-%m-%dT%H:00:00', ?1)"},
+    {DatabaseManager::SnapshotResolution::Daily, "growth_snapshots_daily", "date(?1)"},
+    {DatabaseManager::SnapshotResolution::Weekly, "growth_snapshots_weekly", "date(?1, '-6 days', 'weekday 1')"},
+};
+
+/**
+ * @brief Look up the rollup table for a resolution.
+ * 中文：返回分辨率对应的聚合表名，Raw 返回 nullptr。
  *
- * @return true when connection is alive, false otherwise. 中文：连接有效返回 true，否则 false。
+ * @param resolution Requested resolution. 中文：请求的分辨率。
+ * @return Table name or nullptr. 中文：表名或空指针。
  * @throws None. 中文：不抛出异常。
  */
-bool DatabaseManager::isConnected() const noexcept { return m_db != nullptr; }
+const char* rollupTableFor(DatabaseManager::SnapshotResolution resolution) noexcept {
+    for (const auto& tier : kGrowthRollupTiers) {
+        if (tier.resolution == resolution) {
+            return tier.table;
+        }
+    }
+    return nullptr;
+}
 
 /**
- * @brief Create the users table if missing and seed the teacher-specified testing account.
- * 中文：若 users 表不存在则创建，并插入教师要求的预置账号。
+ * @brief Build the UPSERT that folds one snapshot into a rollup bucket.
+ * 中文：生成把一条快照并入聚合桶的 UPSERT：计数加一、更新成长值极值，仅当新快照更晚时覆盖“桶末值”。
+ *       SET 子句右侧引用的均为更新前的旧值，因此 last_timestamp_ms 可在同一语句中安全比较。
  *
- * Business logic: centralizing schema creation prevents divergence when multiple developers run migrations
- * on different machines. 中文：集中建表逻辑可避免多开发环境间的数据结构差异。
+ * @param tier Rollup tier. 中文：聚合层级。
+ * @return SQL text with ?1 = ISO timestamp, ?2..?13 = value columns, ?14 = epoch ms and ?15 = owner id.
+ *         中文：?1 为 ISO 时间，?2..?13 为数值列，?14 为毫秒时间戳，?15 为所属用户。
+ * @throws None. 中文：不抛出异常。
+ */
+std::string buildRollupUpsertSql(const GrowthRollupTier& tier) {
+    std::string columns;
+    std::string placeholders;
+    std::string updates;
+    int index = 2;
+    for (const char* column : kSnapshotValueColumns) {
+        columns += ", ";
+        columns += column;
+        placeholders += ", ?" + std::to_string(index++);
+        updates += ", ";
+        updates += column;
+        updates += " = CASE WHEN excluded.last_timestamp_ms >= IFNULL(last_timestamp_ms, 0) THEN excluded.";
+        updates += column;
+        updates += " ELSE ";
+        updates += column;
+        updates += " END";
+    }
+    return std::string("INSERT INTO ") + tier.table + " (bucket_start, sample_count, last_timestamp" + columns +
+           ", min_growth, max_growth, last_timestamp_ms, owner_id) VALUES (" + tier.bucketExpression + ", 1, ?1" +
+           placeholders +
+           ", ?3, ?3, ?14, ?15) ON CONFLICT(owner_id, bucket_start) DO UPDATE SET sample_count = sample_count + 1, "
+           "min_growth = MIN(min_growth, excluded.growth_points), "
+           "max_growth = MAX(max_growth, excluded.growth_points), "
+           "last_timestamp = CASE WHEN excluded.last_timestamp_ms >= IFNULL(last_timestamp_ms, 0) "
+           "THEN excluded.last_timestamp ELSE last_timestamp END, "
+           "last_timestamp_ms = MAX(IFNULL(last_timestamp_ms, 0), excluded.last_timestamp_ms)" +
+           updates;
+}
+
+/**
+ * @brief Bind the twelve snapshot value columns to consecutive placeholders.
+ * 中文：把十二个快照数值绑定到连续占位符。
  *
+ * @param statement Prepared statement. 中文：已准备的语句。
+ * @param firstIndex Index of the user_level placeholder. 中文：user_level 占位符序号。
+ * @param record Snapshot values. 中文：快照数据。
  * @return void. 中文：无返回值。
- * @throws std::runtime_error On SQL execution failures. 中文：SQL 执行失败时抛出异常。
+ * @throws None. 中文：不抛出异常。
  */
-void DatabaseManager::ensureUserTable() {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+void bindSnapshotValues(sqlite3_stmt* statement, int firstIndex, const DatabaseManager::GrowthSnapshotRecord& record) {
+    const int values[] = {record.userLevel,    record.growthPoints, record.execution,        record.perseverance,
+                          record.decision,     record.knowledge,    record.social,           record.pride,
+                          record.achievementCount, record.completedTasks, record.failedTasks, record.manualLogCount};
+    for (int value : values) {
+        sqlite3_bind_int(statement, firstIndex++, value);
+    }
+}
 
-    const std::string sql =
-        "CREATE TABLE IF NOT EXISTS users ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "username TEXT UNIQUE NOT NULL,"
-        "password TEXT NOT NULL,"
-        "level INTEGER NOT NULL DEFAULT 1,"
-        "currency INTEGER NOT NULL DEFAULT 0,"
-        "attributes TEXT NOT NULL DEFAULT '{}')";
+/**
+ * @brief Build the raw timeline query over loose snapshot rows and packed snapshot blocks.
+ * 中文：原始时间线由 growth_snapshots 明细行与 growth_snapshot_blocks 快照块共同组成。两者在同一条语句中读取，
+ *       看到同一个读快照，打包事务恰好在中途提交也不会重复或遗漏；块行的数值列以 0 占位、末列为块内容，
+ *       明细行末列为 NULL。块按区间重叠筛选，区间外的行由解码器跳过。
+ *
+ * @param leadColumns Columns before the values for loose rows. 中文：明细行数值列之前的列。
+ * @param blockLeadColumns Same columns for block rows. 中文：块行对应的占位列。
+ * @param trailColumns Columns after the values for loose rows. 中文：明细行数值列之后的列。
+ * @param blockTrailColumns Same columns for block rows. 中文：块行对应的列。
+ * @param hasStart Whether ?2 bounds loose rows. 中文：明细行是否受 ?2 下界约束。
+ * @param hasEnd Whether ?3 bounds loose rows. 中文：明细行是否受 ?3 上界约束。
+ * @return SQL with ?1 = owner id, ?2/?3 = epoch-ms bounds. 中文：?1 为用户，?2/?3 为毫秒区间。
+ * @throws None. 中文：不抛出异常。
+ */
+std::string buildRawTimelineSql(const char* leadColumns, const char* blockLeadColumns, const char* trailColumns,
+                                const char* blockTrailColumns, bool hasStart, bool hasEnd) {
+    std::string values;
+    std::string placeholders;
+    for (const char* column : kSnapshotValueColumns) {
+        values += ", ";
+        values += column;
+        placeholders += ", 0";
+    }
+    std::string sql = std::string("SELECT ") + leadColumns + values + ", " + trailColumns +
+                      ", NULL FROM growth_snapshots WHERE owner_id = ?1";
+    if (hasStart) {
+        sql += " AND timestamp_ms >= ?2";
+    }
+    if (hasEnd) {
+        sql += " AND timestamp_ms <= ?3";
+    }
+    sql += std::string(" UNION ALL SELECT ") + blockLeadColumns + placeholders + ", " + blockTrailColumns +
+           ", payload FROM growth_snapshot_blocks WHERE owner_id = ?1 AND last_timestamp_ms >= ?2 "
+           "AND first_timestamp_ms <= ?3";
+    return sql;
+}
 
-    executeNonQuery(sql);
+/**
+ * @brief Raw timeline as full records: id and ISO time lead, epoch ms trails; block rows carry -1/NULL.
+ * 中文：按毫秒时间（第 15 列）与 id 排序，块行的 id 为 -1。
+ */
+std::string buildRawSnapshotRecordsSql(bool hasStart, bool hasEnd) {
+    return buildRawTimelineSql("id, timestamp", "-1, NULL", "timestamp_ms", "first_timestamp_ms", hasStart, hasEnd) +
+           " ORDER BY 15 ASC, 1 ASC";
+}
 
-    const std::string countSql =
-        "SELECT COUNT(1) FROM users WHERE username = ? AND password = ?";
-    auto stmt = prepareStatement(countSql);
-    sqlite3_bind_text(stmt.get(), 1, kPreconfiguredUsername, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt.get(), 2, kPreconfiguredPassword, -1, SQLITE_STATIC);
+/**
+ * @brief Raw timeline in columnar form: epoch ms leads, id trails for a stable order.
+ * 中文：按毫秒时间与 id（第 14 列）排序，块行以 first_timestamp_ms 参与排序。
+ */
+std::string buildRawSnapshotSeriesSql(bool hasStart, bool hasEnd) {
+    return buildRawTimelineSql("timestamp_ms", "first_timestamp_ms", "id", "-1", hasStart, hasEnd) +
+           " ORDER BY 1 ASC, 14 ASC";
+}
 
-    int rc = sqlite3_step(stmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to query default account", m_db.get()));
+/**
+ * @brief Build the raw timeline row count over loose snapshot rows and packed blocks.
+ * 中文：明细行在 SQL 中计数；完全落在区间内的块直接返回块内行数，跨越区间边界的块返回块内容交给调用方解码。
+ *
+ * @param hasStart Whether ?2 bounds loose rows. 中文：明细行是否受 ?2 下界约束。
+ * @param hasEnd Whether ?3 bounds loose rows. 中文：明细行是否受 ?3 上界约束。
+ * @return SQL with ?1 = owner id, ?2/?3 = epoch-ms bounds. 中文：?1 为用户，?2/?3 为毫秒区间。
+ * @throws None. 中文：不抛出异常。
+ */
+std::string buildRawTimelineCountSql(bool hasStart, bool hasEnd) {
+    std::string sql = "SELECT COUNT(1), NULL FROM growth_snapshots WHERE owner_id = ?1";
+    if (hasStart) {
+        sql += " AND timestamp_ms >= ?2";
     }
+    if (hasEnd) {
+        sql += " AND timestamp_ms <= ?3";
+    }
+    sql +=
+        " UNION ALL SELECT sample_count, CASE WHEN first_timestamp_ms >= ?2 AND last_timestamp_ms <= ?3 "
+        "THEN NULL ELSE payload END FROM growth_snapshot_blocks WHERE owner_id = ?1 "
+        "AND last_timestamp_ms >= ?2 AND first_timestamp_ms <= ?3";
+    return sql;
+}
 
-    bool needInsert = sqlite3_column_int(stmt.get(), 0) == 0;
-    if (needInsert) {
-        const std::string insertSql =
-            "INSERT INTO users (username, password, level, currency, attributes) "
-            "VALUES (?, ?, 1, 0, '{""initial"":true}')";
-        auto insertStmt = prepareStatement(insertSql);
-        sqlite3_bind_text(insertStmt.get(), 1, kPreconfiguredUsername, -1, SQLITE_STATIC);
-        sqlite3_bind_text(insertStmt.get(), 2, kPreconfiguredPassword, -1, SQLITE_STATIC);
-        rc = sqlite3_step(insertStmt.get());
-        if (!isSuccessCode(rc)) {
-            throw std::runtime_error(buildErrorMessage("Failed to insert default account", m_db.get()));
-        }
+/**
+ * @brief Build a rollup timeline query filtered by bucket-end time and ordered by bucket start.
+ * 中文：聚合表按桶末快照时间过滤、按桶起点（主键）升序返回；区间边界依次占用 owner_id 之后的占位符。
+ *
+ * @param table Rollup table. 中文：聚合表名。
+ * @param leadColumns Columns before the values. 中文：数值列之前的列。
+ * @param trailColumns Columns after the values, or nullptr. 中文：数值列之后的列，可为空。
+ * @param hasStart Whether a lower bound follows the owner id. 中文：是否带下界。
+ * @param hasEnd Whether an upper bound follows. 中文：是否带上界。
+ * @return SQL text. 中文：SQL 文本。
+ * @throws None. 中文：不抛出异常。
+ */
+std::string buildRollupTimelineSql(const char* table,
+                                   const char* leadColumns,
+                                   const char* trailColumns,
+                                   bool hasStart,
+                                   bool hasEnd) {
+    std::string sql = std::string("SELECT ") + leadColumns;
+    for (const char* column : kSnapshotValueColumns) {
+        sql += ", ";
+        sql += column;
+    }
+    if (trailColumns != nullptr) {
+        sql += std::string(", ") + trailColumns;
+    }
+    sql += std::string(" FROM ") + table + " WHERE owner_id = ?";
+    if (hasStart) {
+        sql += " AND last_timestamp_ms >= ?";
     }
+    if (hasEnd) {
+        sql += " AND last_timestamp_ms <= ?";
+    }
+    sql += " ORDER BY bucket_start ASC";
+    return sql;
 }
 
 /**
- * @brief 确保任务表存在，集中管理任务系统的持久化结构。
- * 中文：任务表字段涵盖任务类型、难度星级、截止时间、奖励、连胜、宽恕券、进度等信息，
- *       通过集中建表既能满足教师“奖励与难度平衡”的讲解需要，也方便 TaskManager 事务化操作。
+ * @brief Build the rollup timeline row count with the same bounds as buildRollupTimelineSql.
+ * 中文：与 buildRollupTimelineSql 使用相同的过滤条件与占位符顺序。
  */
-void DatabaseManager::ensureTaskTable() {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "CREATE TABLE IF NOT EXISTS tasks ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "name TEXT NOT NULL,"
-        "description TEXT NOT NULL,"
-        "type TEXT NOT NULL,"
-        "difficulty INTEGER NOT NULL,"
-        "deadline TEXT NOT NULL,"
-        "completed INTEGER NOT NULL DEFAULT 0,"
-        "coin_reward INTEGER NOT NULL DEFAULT 0,"
-        "growth_reward INTEGER NOT NULL DEFAULT 0,"
-        "attribute_reward TEXT NOT NULL DEFAULT '{}',"
-        "bonus_streak INTEGER NOT NULL DEFAULT 0,"
-        "custom_settings TEXT NOT NULL DEFAULT '{}',"
-        "forgiveness_coupons INTEGER NOT NULL DEFAULT 0,"
-        "progress_value INTEGER NOT NULL DEFAULT 0,"
-        "progress_goal INTEGER NOT NULL DEFAULT 100)";
-    executeNonQuery(sql);
+std::string buildRollupCountSql(const char* table, bool hasStart, bool hasEnd) {
+    std::string sql = std::string("SELECT COUNT(1) FROM ") + table + " WHERE owner_id = ?";
+    if (hasStart) {
+        sql += " AND last_timestamp_ms >= ?";
+    }
+    if (hasEnd) {
+        sql += " AND last_timestamp_ms <= ?";
+    }
+    return sql;
 }
 
-void DatabaseManager::ensureAchievementTable() {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "CREATE TABLE IF NOT EXISTS achievements ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "owner TEXT NOT NULL,"
-        "creator TEXT NOT NULL,"
-        "name TEXT NOT NULL,"
-        "description TEXT NOT NULL,"
-        "icon_path TEXT NOT NULL,"
-        "display_color TEXT NOT NULL,"
-        "type TEXT NOT NULL,"
-        "reward_type TEXT NOT NULL,"
-        "progress_mode TEXT NOT NULL,"
-        "progress_value INTEGER NOT NULL DEFAULT 0,"
-        "progress_goal INTEGER NOT NULL DEFAULT 1,"
-        "reward_coins INTEGER NOT NULL DEFAULT 0,"
-        "reward_attributes TEXT NOT NULL DEFAULT '0,0,0,0,0,0',"
-        "reward_items TEXT NOT NULL DEFAULT '',"
-        "unlocked INTEGER NOT NULL DEFAULT 0,"
-        "completion_time TEXT,"
-        "conditions TEXT NOT NULL,"
-        "gallery_group TEXT NOT NULL DEFAULT 'default',"
-        "created_at TEXT NOT NULL,"
-        "special_metadata TEXT NOT NULL DEFAULT '')";
-    executeNonQuery(sql);
+/**
+ * @brief Build the loose-row lookup for the latest snapshot at or before a time point.
+ * 中文：明细行按 (owner_id, timestamp_ms) 倒序取第一条；?1 为用户，?2 为时间点。
+ */
+std::string buildSnapshotCheckpointSql() {
+    std::string sql = "SELECT timestamp_ms";
+    for (const char* column : kSnapshotValueColumns) {
+        sql += ", ";
+        sql += column;
+    }
+    return sql + " FROM growth_snapshots WHERE owner_id = ? AND timestamp_ms <= ? ORDER BY timestamp_ms DESC LIMIT 1";
 }
 
-void DatabaseManager::ensureShopTable() {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "CREATE TABLE IF NOT EXISTS shop_items ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "name TEXT NOT NULL,"
-        "description TEXT NOT NULL,"
-        "icon_path TEXT NOT NULL,"
-        "item_type TEXT NOT NULL,"
-        "price_coins INTEGER NOT NULL,"
-        "purchase_limit INTEGER NOT NULL DEFAULT 0,"
-        "available INTEGER NOT NULL DEFAULT 1,"
-        "effect_description TEXT NOT NULL DEFAULT '',"
-        "effect_logic TEXT NOT NULL DEFAULT '',"
-        "prop_effect_type TEXT NOT NULL DEFAULT '',"
-        "prop_duration_minutes INTEGER NOT NULL DEFAULT 0,"
-        "usage_conditions TEXT NOT NULL DEFAULT '',"
-        "physical_redeem TEXT NOT NULL DEFAULT '',"
-        "physical_notes TEXT NOT NULL DEFAULT '',"
-        "lucky_rules TEXT NOT NULL DEFAULT '{}',"
-        "level_requirement INTEGER NOT NULL DEFAULT 1);";
-    executeNonQuery(sql);
-    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_shop_items_type ON shop_items(item_type);");
-}
+/**
+ * @brief 检查点候选块：整块早于时间点的最后一块，以及跨过时间点的下一块。?1 为用户，?2 为时间点。
+ */
+const char* const kSnapshotCheckpointBlockSql[] = {
+    "SELECT payload FROM growth_snapshot_blocks WHERE owner_id = ? AND last_timestamp_ms <= ? "
+    "ORDER BY last_timestamp_ms DESC LIMIT 1",
+    "SELECT payload FROM growth_snapshot_blocks WHERE owner_id = ? AND last_timestamp_ms > ? "
+    "AND first_timestamp_ms <= ?2 ORDER BY last_timestamp_ms ASC LIMIT 1",
+};
 
-void DatabaseManager::ensureInventoryTable() {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "CREATE TABLE IF NOT EXISTS user_inventory ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "owner TEXT NOT NULL,"
-        "item_id INTEGER NOT NULL,"
-        "quantity INTEGER NOT NULL,"
-        "used_quantity INTEGER NOT NULL DEFAULT 0,"
-        "status TEXT NOT NULL,"
-        "purchase_time TEXT NOT NULL,"
-        "expiration_time TEXT,"
-        "lucky_payload TEXT NOT NULL DEFAULT '{}',"
-        "notes TEXT NOT NULL DEFAULT '',"
-        "FOREIGN KEY(owner) REFERENCES users(username) ON DELETE CASCADE,"
-        "FOREIGN KEY(item_id) REFERENCES shop_items(id) ON DELETE CASCADE);";
-    executeNonQuery(sql);
-    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_inventory_owner ON user_inventory(owner);");
-    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_inventory_item ON user_inventory(item_id);");
+/**
+ * @brief 打包候选：该用户早于截止时间的最早 ?3 条快照。读取与删除使用同一条件，在同一事务内看到同一批行。
+ */
+const char* const kSnapshotPackCandidates =
+    "FROM growth_snapshots WHERE owner_id = ?1 AND timestamp_ms < ?2 ORDER BY timestamp_ms ASC, id ASC LIMIT ?3";
+
+std::string buildSnapshotPackSelectSql() {
+    std::string sql = "SELECT timestamp_ms";
+    for (const char* column : kSnapshotValueColumns) {
+        sql += ", ";
+        sql += column;
+    }
+    return sql + " " + kSnapshotPackCandidates;
 }
 
+std::string buildSnapshotPackDeleteSql() {
+    return std::string("DELETE FROM growth_snapshots WHERE id IN (SELECT id ") + kSnapshotPackCandidates + ")";
+}
 
 /**
- * @brief 确保日志表存在并建立必要索引。
- * 中文：记录自动、手动、里程碑与事件日志，为时间线过滤提供结构。
+ * @brief Build the per-day task statistics query.
+ * 中文：日期边界依次占用 owner_id 之后的占位符。
  */
-void DatabaseManager::ensureLogTable() {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "CREATE TABLE IF NOT EXISTS logs (\n"
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,\n"
-        "timestamp TEXT NOT NULL,\n"
-        "type TEXT NOT NULL,\n"
-        "content TEXT NOT NULL,\n"
-        "related_id INTEGER,\n"
-        "attribute_changes TEXT NOT NULL DEFAULT '{}',\n"
-        "level_change INTEGER NOT NULL DEFAULT 0,\n"
-        "special_event TEXT NOT NULL DEFAULT '',\n"
-        "mood TEXT NOT NULL DEFAULT ''"
-        " );";
-    executeNonQuery(sql);
-    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_logs_timestamp ON logs(timestamp);");
-    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_logs_type ON logs(type);");
+std::string buildTaskStatsSql(bool hasStartDay, bool hasEndDay) {
+    std::string sql = "SELECT day, type, completed, failed FROM task_stats WHERE owner_id = ?";
+    if (hasStartDay) {
+        sql += " AND day >= ?";
+    }
+    if (hasEndDay) {
+        sql += " AND day <= ?";
+    }
+    return sql + " ORDER BY day ASC, type ASC";
 }
 
 /**
- * @brief 确保宽恕日志表存在，记录被隐藏的日志 ID，支持跨会话恢复状态。
- * 中文：宽恕表仅保存日志主键，依赖外键约束保证数据一致性。
+ * @brief Build the daily log summary query; a summary matches when its time span overlaps the range.
+ * 中文：按时间跨度与区间重叠筛选，区间边界依次占用 owner_id 之后的占位符。
  */
-void DatabaseManager::ensureForgivenLogTable() {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "CREATE TABLE IF NOT EXISTS forgiven_logs (\n"
-        "log_id INTEGER PRIMARY KEY,\n"
-        "FOREIGN KEY(log_id) REFERENCES logs(id) ON DELETE CASCADE\n"
-        ");";
-    executeNonQuery(sql);
+std::string buildLogDailySummariesSql(bool hasStart, bool hasEnd) {
+    std::string sql =
+        "SELECT day, special_event, entry_count, level_change, first_timestamp_ms, last_timestamp_ms "
+        "FROM log_daily_summaries WHERE owner_id = ?";
+    if (hasStart) {
+        sql += " AND last_timestamp_ms >= ?";
+    }
+    if (hasEnd) {
+        sql += " AND first_timestamp_ms <= ?";
+    }
+    return sql + " ORDER BY day ASC, special_event ASC";
+}
+
+void bindTimelineRange(sqlite3_stmt* statement,
+                       int ownerId,
+                       const std::optional<std::int64_t>& startMs,
+                       const std::optional<std::int64_t>& endMs) {
+    sqlite3_bind_int(statement, 1, ownerId);
+    sqlite3_bind_int64(statement, 2, startMs.value_or(std::numeric_limits<std::int64_t>::min()));
+    sqlite3_bind_int64(statement, 3, endMs.value_or(std::numeric_limits<std::int64_t>::max()));
 }
 
 /**
- * @brief 确保成长快照表存在，支撑时间轴可视化。
- * 中文：存储等级、成长值与属性，方便绘制折线和雷达图。
+ * @brief Decode one block row's payload into a series.
+ * 中文：把块行末列的块内容解码追加到 out，块损坏时抛出异常。
+ *
+ * @throws std::runtime_error Corrupt block. 中文：块内容损坏。
  */
-void DatabaseManager::ensureGrowthSnapshotTable() {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "CREATE TABLE IF NOT EXISTS growth_snapshots (\n"
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,\n"
-        "timestamp TEXT NOT NULL,\n"
-        "user_level INTEGER NOT NULL,\n"
-        "growth_points INTEGER NOT NULL,\n"
-        "execution INTEGER NOT NULL,\n"
-        "perseverance INTEGER NOT NULL,\n"
-        "decision INTEGER NOT NULL,\n"
-        "knowledge INTEGER NOT NULL,\n"
-        "social INTEGER NOT NULL,\n"
-        "pride INTEGER NOT NULL,\n"
-        "achievement_count INTEGER NOT NULL,\n"
-        "completed_tasks INTEGER NOT NULL,\n"
-        "failed_tasks INTEGER NOT NULL,\n"
-        "manual_log_count INTEGER NOT NULL"
-        " );";
-    executeNonQuery(sql);
-    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_growth_snapshots_timestamp ON growth_snapshots(timestamp);");
+void decodeTimelineBlock(sqlite3_stmt* statement,
+                         int payloadColumn,
+                         const std::optional<std::int64_t>& startMs,
+                         const std::optional<std::int64_t>& endMs,
+                         SnapshotSeries& out) {
+    const auto* data = static_cast<const char*>(sqlite3_column_blob(statement, payloadColumn));
+    const std::string_view payload(data == nullptr ? "" : data,
+                                   static_cast<std::size_t>(sqlite3_column_bytes(statement, payloadColumn)));
+    if (!series::decodeBlock(payload, startMs.value_or(std::numeric_limits<std::int64_t>::min()),
+                             endMs.value_or(std::numeric_limits<std::int64_t>::max()), out)) {
+        throw std::runtime_error("Corrupt growth snapshot block");
+    }
 }
 
 /**
- * @brief 预置教学示例用的任务列表，避免界面空白。
- * 中文：应用首次启动时插入日常、周常、学期与自定义任务各一批，便于老师演示奖励与进度逻辑。
+ * @brief Restore time order after merging loose rows into packed blocks.
+ * 中文：块按首行时间排序，补写的旧时间快照可能落在某块的时间跨度内，此时按时间重排（稳定排序）。
+ *
+ * @param series Series to reorder in place. 中文：原地重排的序列。
+ * @throws std::bad_alloc On allocation failure. 中文：内存不足时抛出。
  */
-void DatabaseManager::seedDefaultTasks() {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+void sortSeriesByTime(SnapshotSeries& series) {
+    const auto& timestamps = series.timestamps();
+    if (std::is_sorted(timestamps.begin(), timestamps.end())) {
+        return;
+    }
+    std::vector<std::size_t> order(series.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::stable_sort(order.begin(), order.end(),
+                     [&timestamps](std::size_t a, std::size_t b) { return timestamps[a] < timestamps[b]; });
+    SnapshotSeries sorted;
+    sorted.reserve(series.size());
+    for (std::size_t index : order) {
+        sorted.append(timestamps[index], series.row(index));
+    }
+    series = std::move(sorted);
+}
 
-    const std::string countSql = "SELECT COUNT(1) FROM tasks";
-    auto countStmt = prepareStatement(countSql);
-    int rc = sqlite3_step(countStmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to count tasks", m_db.get()));
+/**
+ * @brief Derive the epoch-millisecond value stored next to an ISO8601 column.
+ * 中文：沿用读取端的 QDateTime ISO 解析规则（无时区后缀按本地时间）；空串或非法时间返回空。
+ *
+ * @param iso ISO8601 text. 中文：ISO8601 文本。
+ * @return Epoch milliseconds or nullopt. 中文：毫秒时间戳或空。
+ * @throws None. 中文：不抛出异常。
+ */
+std::optional<std::int64_t> isoToEpochMs(const std::string& iso) {
+    if (iso.empty()) {
+        return std::nullopt;
     }
-    if (sqlite3_column_int(countStmt.get(), 0) > 0) {
-        return;  // 已有任务则不重复插入。
+    const QDateTime parsed = QDateTime::fromString(QString::fromStdString(iso), Qt::ISODate);
+    if (!parsed.isValid()) {
+        return std::nullopt;
     }
+    return parsed.toMSecsSinceEpoch();
+}
 
-    struct TaskSeed {
-        std::string name;
-        std::string description;
-        Task::TaskType type;
-        int difficulty = 1;
-        int deadlineOffsetDays = 1;
-        int coins = 0;
-        int growth = 0;
-        std::string attributeReward;
-        int forgiveness = 0;
-        int progressGoal = 1;
-    };
+/**
+ * @brief Bind the epoch-millisecond twin of an ISO column, NULL when the text is empty or invalid.
+ * 中文：绑定 ISO 列对应的毫秒列；无法解析时绑定 NULL，范围比较天然排除该行。
+ *
+ * @return void. 中文：无返回值。
+ * @throws None. 中文：不抛出异常。
+ */
+void bindEpochMs(sqlite3_stmt* statement, int index, const std::string& iso) {
+    const auto epochMs = isoToEpochMs(iso);
+    if (epochMs.has_value()) {
+        sqlite3_bind_int64(statement, index, static_cast<sqlite3_int64>(*epochMs));
+    } else {
+        sqlite3_bind_null(statement, index);
+    }
+}
 
-    const std::vector<TaskSeed> seeds = {
-        {"晨读 30 分钟", "在图书馆完成一段英文原版阅读，提升自律。", Task::TaskType::Daily, 2, 1, 20, 15,
-         "execution=1;perseverance=0;decision=0;knowledge=2;social=0;pride=0", 0, 1},
-        {"操场跑 3 公里", "保持锻炼习惯，完成基础耐力训练。", Task::TaskType::Daily, 3, 1, 25, 18,
-         "execution=1;perseverance=1;decision=0;knowledge=0;social=0;pride=0", 0, 1},
-        {"周项目研讨", "与小组讨论课程项目方案，提交会议纪要。", Task::TaskType::Weekly, 3, 7, 80, 60,
-         "execution=0;perseverance=1;decision=1;knowledge=2;social=2;pride=0", 1, 1},
-        {"学期科研训练", "在导师指导下完成一次小型实验并整理报告。", Task::TaskType::Semester, 4, 90, 200, 180,
-         "execution=1;perseverance=2;decision=1;knowledge=3;social=1;pride=1", 2, 1},
-        {"自定义兴趣练习", "记录一次社团活动或个人兴趣练习。", Task::TaskType::Custom, 1, 14, 30, 25,
-         "execution=0;perseverance=1;decision=0;knowledge=1;social=1;pride=0", 0, 100}};
+/**
+ * @brief Bind a users.id foreign key, NULL when the id is not positive.
+ * 中文：绑定引用 users(id) 的外键列；0 表示“无用户”（如系统创建者）绑定为 NULL，
+ *       NOT NULL 列因此直接报约束错误，而不是写入一条外键检查无法发现的 0。
+ *
+ * @return void. 中文：无返回值。
+ * @throws None. 中文：不抛出异常。
+ */
+void bindUserReference(sqlite3_stmt* statement, int index, int userId) {
+    if (userId > 0) {
+        sqlite3_bind_int(statement, index, userId);
+    } else {
+        sqlite3_bind_null(statement, index);
+    }
+}
 
-    const std::string insertSql =
-        "INSERT INTO tasks (name, description, type, difficulty, deadline, completed, coin_reward, growth_reward, "
-        "attribute_reward, bonus_streak, custom_settings, forgiveness_coupons, progress_value, progress_goal) "
-        "VALUES (?, ?, ?, ?, ?, 0, ?, ?, ?, 0, '{}', ?, 0, ?)";
+/**
+ * @brief Read a nullable epoch-millisecond column.
+ * 中文：读取可空的毫秒列，NULL 返回空。
+ *
+ * @return Epoch milliseconds or nullopt. 中文：毫秒时间戳或空。
+ * @throws None. 中文：不抛出异常。
+ */
+std::optional<std::int64_t> readEpochMs(sqlite3_stmt* statement, int column) {
+    if (sqlite3_column_type(statement, column) == SQLITE_NULL) {
+        return std::nullopt;
+    }
+    return static_cast<std::int64_t>(sqlite3_column_int64(statement, column));
+}
 
-    for (const auto& seed : seeds) {
-        auto insertStmt = prepareStatement(insertSql);
-        const std::string deadlineIso =
-            QDateTime::currentDateTimeUtc().addDays(seed.deadlineOffsetDays).toString(Qt::ISODate).toStdString();
-        sqlite3_bind_text(insertStmt.get(), 1, seed.name.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(insertStmt.get(), 2, seed.description.c_str(), -1, SQLITE_TRANSIENT);
-        const std::string typeText = Task::typeToString(seed.type);
-        sqlite3_bind_text(insertStmt.get(), 3, typeText.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_int(insertStmt.get(), 4, seed.difficulty);
-        sqlite3_bind_text(insertStmt.get(), 5, deadlineIso.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_int(insertStmt.get(), 6, seed.coins);
-        sqlite3_bind_int(insertStmt.get(), 7, seed.growth);
-        sqlite3_bind_text(insertStmt.get(), 8, seed.attributeReward.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_int(insertStmt.get(), 9, seed.forgiveness);
-        sqlite3_bind_int(insertStmt.get(), 10, seed.progressGoal);
-        rc = sqlite3_step(insertStmt.get());
-        if (!isSuccessCode(rc)) {
-            throw std::runtime_error(buildErrorMessage("Failed to seed default tasks", m_db.get()));
-        }
+#if ROVE_ENABLE_METRICS
+/**
+ * @brief 语句埋点的标签：SQL 文本的 FNV-1a 64 位摘要，原文经 Registry::describe 只登记一次。
+ * 中文：以短 ID 作标签，埋点查找不再逐字比较整段 SQL，JSON 与面板的条目名也不会被长语句撑满。
+ */
+std::string statementMetricId(std::string_view sql) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char c : sql) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
     }
+    char id[24];
+    std::snprintf(id, sizeof(id), "stmt-%016llx", static_cast<unsigned long long>(hash));
+    metrics::Registry::instance().describe(id, sql);
+    return id;
 }
 
 /**
- * @brief 预置成就，确保画廊与奖励系统开箱即用。
- * 中文：仅当当前用户没有任何成就记录时插入系统模板，避免重复。
+ * @brief 当前线程已取出、尚未归还的语句句柄及其已返回的行数。
+ * 中文：语句从取出到归还都在同一线程上执行，同一时刻在用的语句通常只有一两条，线性查找即可；
+ *       FTS5 等内部语句不在表中，ROW 回调直接忽略。
  */
-void DatabaseManager::seedDefaultAchievements() {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+thread_local std::vector<std::pair<sqlite3_stmt*, std::uint64_t>> tStatementRows;
 
-    const std::string owner = kPreconfiguredUsername;
-    const std::string countSql = "SELECT COUNT(1) FROM achievements WHERE owner = ?";
-    auto countStmt = prepareStatement(countSql);
-    sqlite3_bind_text(countStmt.get(), 1, owner.c_str(), -1, SQLITE_TRANSIENT);
-    int rc = sqlite3_step(countStmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to count achievements", m_db.get()));
-    }
-    if (sqlite3_column_int(countStmt.get(), 0) > 0) {
-        return;
+/**
+ * @brief SQLITE_TRACE_ROW：为正在计时的语句累计返回行数。
+ */
+void countStatementRow(sqlite3_stmt* statement) noexcept {
+    for (auto it = tStatementRows.rbegin(); it != tStatementRows.rend(); ++it) {
+        if (it->first == statement) {
+            ++it->second;
+            return;
+        }
     }
+}
 
-    auto serializeConditionsCompact = [](const std::vector<Achievement::Condition>& conditions) {
-        std::ostringstream stream;
-        bool first = true;
-        for (const auto& condition : conditions) {
-            if (!first) {
-                stream << ';';
-            }
-            first = false;
-            stream << static_cast<int>(condition.type) << ',' << condition.targetValue << ',' << condition.currentValue
-                   << ',' << condition.metadata;
+/**
+ * @brief 取出并移除语句的行数登记。
+ */
+std::uint64_t takeStatementRows(sqlite3_stmt* statement) noexcept {
+    for (auto it = tStatementRows.rbegin(); it != tStatementRows.rend(); ++it) {
+        if (it->first == statement) {
+            const std::uint64_t rows = it->second;
+            tStatementRows.erase(std::next(it).base());
+            return rows;
         }
-        return stream.str();
-    };
+    }
+    return 0;
+}
+#endif
 
-    auto serializeAttributesCompact = [](const User::AttributeSet& set) {
-        std::ostringstream stream;
-        stream << set.execution << ',' << set.perseverance << ',' << set.decision << ',' << set.knowledge << ','
-               << set.social << ',' << set.pride;
-        return stream.str();
-    };
+/**
+ * @brief PROFILE 回调中发现、尚待解释执行计划的慢查询。
+ */
+struct PendingSlowQuery {
+    DatabaseManager* owner = nullptr;
+    sqlite3* handle = nullptr;
+    std::string templateSql;
+    DatabaseManager::SlowQuery query;
+};
 
-    auto serializeItemsCompact = [](const std::vector<std::string>& items) {
-        std::ostringstream stream;
-        bool first = true;
-        for (const auto& item : items) {
-            if (!first) {
-                stream << '|';
-            }
-            first = false;
-            stream << item;
-        }
-        return stream.str();
-    };
+/**
+ * @brief 热路径语句文本。集中定义，供各方法准备语句，也供 queryPlanCatalog 逐条审计执行计划。
+ */
+const char* const kSelectAppStateSql =
+    "SELECT value FROM app_state WHERE key = ?";
 
-    struct AchievementSeed {
-        std::string name;
-        std::string description;
-        std::string iconPath;
-        std::string color;
-        Achievement::Type type = Achievement::Type::System;
-        Achievement::RewardType rewardType = Achievement::RewardType::WithReward;
-        Achievement::ProgressMode progressMode = Achievement::ProgressMode::Milestone;
-        std::vector<Achievement::Condition> conditions;
-        int rewardCoins = 0;
-        User::AttributeSet rewardAttributes;
-        std::vector<std::string> rewardItems;
-        std::string galleryGroup;
-    };
+const char* const kSelectActivityFeedSql =
+    "SELECT state FROM activity_feed_state WHERE owner_id = ?";
 
-    std::vector<AchievementSeed> seeds;
+const char* const kSelectGrowthAnalyticsSql =
+    "SELECT state FROM growth_analytics_state WHERE owner_id = ?";
 
-    Achievement::Condition levelCond;
-    levelCond.type = Achievement::Condition::ConditionType::ReachLevel;
-    levelCond.targetValue = 3;
-    seeds.push_back({"初入兰大",
-                    "首次达到 3 级，证明已融入校园节奏",
-                    ":/icons/rookie.png",
-                    "#4CAF50",
-                    Achievement::Type::System,
-                    Achievement::RewardType::WithReward,
-                    Achievement::ProgressMode::Milestone,
-                    {levelCond},
-                    50,
-                    User::AttributeSet{0, 0, 0, 0, 0, 2},
-                    {},
-                    "新生礼遇"});
+const char* const kValidateAccountSql =
+    "SELECT COUNT(1) FROM users WHERE username = ? AND password = ?";
 
-    Achievement::Condition prideCond;
-    prideCond.type = Achievement::Condition::ConditionType::ReachPride;
-    prideCond.targetValue = 20;
-    seeds.push_back({"西北自豪",
-                    "自豪感达到 20，成为兰大形象大使",
-                    ":/icons/pride.png",
-                    "#FFC107",
-                    Achievement::Type::System,
-                    Achievement::RewardType::WithReward,
-                    Achievement::ProgressMode::Incremental,
-                    {prideCond},
-                    80,
-                    User::AttributeSet{0, 0, 0, 0, 0, 5},
-                    {"校史徽章"},
-                    "精神成长"});
+const char* const kSelectUserByNameSql =
+    "SELECT id, username, password, level, currency, attributes, attr_execution, attr_perseverance, "
+    "attr_decision, attr_knowledge, attr_social, attr_pride FROM users WHERE username = ?";
 
-    Achievement::Condition weeklyCond;
-    weeklyCond.type = Achievement::Condition::ConditionType::CompleteTaskType;
-    weeklyCond.targetValue = 5;
-    weeklyCond.metadata = Task::typeToString(Task::TaskType::Weekly);
-    seeds.push_back({"周计划达人",
-                    "完成 5 个周任务",
-                    ":/icons/weekly.png",
-                    "#9C27B0",
-                    Achievement::Type::System,
-                    Achievement::RewardType::WithReward,
-                    Achievement::ProgressMode::Incremental,
-                    {weeklyCond},
-                    40,
-                    User::AttributeSet{1, 0, 0, 0, 0, 1},
-                    {},
-                    "勤奋实践"});
+const char* const kSelectUserIdByNameSql =
+    "SELECT id FROM users WHERE username = ?";
 
-    const std::string insertSql =
-        "INSERT INTO achievements (owner, creator, name, description, icon_path, display_color, type, reward_type, "
-        "progress_mode, progress_value, progress_goal, reward_coins, reward_attributes, reward_items, unlocked, "
-        "completion_time, conditions, gallery_group, created_at, special_metadata) "
-        "VALUES (?, 'system', ?, ?, ?, ?, ?, ?, ?, 0, ?, ?, ?, ?, 0, '', ?, ?, ?, '')";
+const char* const kUpdateUserLevelSql =
+    "UPDATE users SET level = ? WHERE id = ?";
 
-    const auto createdAt = QDateTime::currentDateTimeUtc().toString(Qt::ISODate).toStdString();
-    for (const auto& seed : seeds) {
-        auto insertStmt = prepareStatement(insertSql);
-        sqlite3_bind_text(insertStmt.get(), 1, owner.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(insertStmt.get(), 2, seed.name.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(insertStmt.get(), 3, seed.description.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(insertStmt.get(), 4, seed.iconPath.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(insertStmt.get(), 5, seed.color.c_str(), -1, SQLITE_TRANSIENT);
-        const std::string typeText = seed.type == Achievement::Type::System ? "System" : "Custom";
-        sqlite3_bind_text(insertStmt.get(), 6, typeText.c_str(), -1, SQLITE_TRANSIENT);
-        const std::string rewardText =
-            seed.rewardType == Achievement::RewardType::WithReward ? "WithReward" : "NoReward";
-        sqlite3_bind_text(insertStmt.get(), 7, rewardText.c_str(), -1, SQLITE_TRANSIENT);
-        const std::string modeText = seed.progressMode == Achievement::ProgressMode::Incremental ? "Incremental"
-                                                                                              : "Milestone";
-        sqlite3_bind_text(insertStmt.get(), 8, modeText.c_str(), -1, SQLITE_TRANSIENT);
-        const int progressGoal = std::max(1, static_cast<int>(seed.conditions.size()) == 1
-                                                 ? seed.conditions.front().targetValue
-                                                 : std::accumulate(seed.conditions.begin(),
-                                                                   seed.conditions.end(),
-                                                                   0,
-                                                                   [](int acc, const Achievement::Condition& cond) {
-                                                                       return acc + cond.targetValue;
-                                                                   }));
-        sqlite3_bind_int(insertStmt.get(), 9, progressGoal);
-        sqlite3_bind_int(insertStmt.get(), 10, seed.rewardCoins);
-        const std::string attrText = serializeAttributesCompact(seed.rewardAttributes);
-        sqlite3_bind_text(insertStmt.get(), 11, attrText.c_str(), -1, SQLITE_TRANSIENT);
-        const std::string itemsText = serializeItemsCompact(seed.rewardItems);
-        sqlite3_bind_text(insertStmt.get(), 12, itemsText.c_str(), -1, SQLITE_TRANSIENT);
-        const std::string conditionText = serializeConditionsCompact(seed.conditions);
-        sqlite3_bind_text(insertStmt.get(), 13, conditionText.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(insertStmt.get(), 14, seed.galleryGroup.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(insertStmt.get(), 15, createdAt.c_str(), -1, SQLITE_TRANSIENT);
+const char* const kUpdateUserCurrencySql =
+    "UPDATE users SET currency = ? WHERE id = ?";
 
-        rc = sqlite3_step(insertStmt.get());
-        if (!isSuccessCode(rc)) {
-            throw std::runtime_error(buildErrorMessage("Failed to seed achievements", m_db.get()));
-        }
-    }
-}
+const char* const kUpdateUserAttributesSql =
+    "UPDATE users SET attributes = ?, attr_execution = ?, attr_perseverance = ?, attr_decision = ?, "
+    "attr_knowledge = ?, attr_social = ?, attr_pride = ? WHERE id = ?";
 
-/**
- * @brief 预置商城商品，方便学生体验购买与道具效果。
- * 中文：插入物理商品、增益道具与幸运包三类示例，覆盖 ShopManager 的主要分支逻辑。
- */
-void DatabaseManager::seedDefaultShopItems() {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+const char* const kDeleteUserSql =
+    "DELETE FROM users WHERE id = ?";
 
-    const std::string countSql = "SELECT COUNT(1) FROM shop_items";
-    auto countStmt = prepareStatement(countSql);
-    int rc = sqlite3_step(countStmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to count shop items", m_db.get()));
-    }
-    if (sqlite3_column_int(countStmt.get(), 0) > 0) {
-        return;
-    }
+const char* const kDeleteTaskSql =
+    "DELETE FROM tasks WHERE id = ?";
 
-    std::vector<ShopItem> seeds;
+const char* const kDeleteAchievementSql =
+    "DELETE FROM achievements WHERE id = ?";
 
-    ShopItem merch;
-    merch.setName("校园周边礼包");
-    merch.setDescription("校徽 + 帆布袋套装，线下兑换纪念校园生活。");
-    merch.setIconPath(":/icons/merch.png");
-    merch.setItemType(ShopItem::ItemType::Physical);
-    merch.setPriceCoins(80);
-    merch.setPurchaseLimit(1);
-    merch.setAvailable(true);
-    merch.setPhysicalRedeemMethod("持购买截图到辅导员处登记领取");
-    merch.setPhysicalNotes("兑换时需核验学生证，仅限本人领取。");
-    seeds.push_back(merch);
+const char* const kSelectTaskByIdSql =
+    "SELECT id, name, description, type, difficulty, deadline, completed, coin_reward, growth_reward, "
+    "attr_execution, attr_perseverance, attr_decision, attr_knowledge, attr_social, attr_pride, "
+    "bonus_streak, custom_settings, forgiveness_coupons, progress_value, progress_goal, deadline_ms "
+    "FROM tasks WHERE id = ?";
 
-    ShopItem restCard;
-    restCard.setName("自习室休息日卡");
-    restCard.setDescription("为自己安排一天减压假，任务失败不计入连胜中断。");
-    restCard.setIconPath(":/icons/rest.png");
-    restCard.setItemType(ShopItem::ItemType::Prop);
-    restCard.setPriceCoins(30);
-    restCard.setPurchaseLimit(2);
-    restCard.setAvailable(true);
-    restCard.setPropEffectType(ShopItem::PropEffectType::RestDay);
-    restCard.setEffectDurationMinutes(1440);
-    restCard.setEffectDescription("使用后 24 小时内的单次任务失败将被忽略。");
-    restCard.setUsageConditions("当周有效，避免与宽恕券叠加使用。");
-    seeds.push_back(restCard);
+const char* const kSelectTasksForOwnerSql =
+    "SELECT id, name, description, type, difficulty, deadline, completed, coin_reward, growth_reward, "
+    "attr_execution, attr_perseverance, attr_decision, attr_knowledge, attr_social, attr_pride, "
+    "bonus_streak, custom_settings, forgiveness_coupons, progress_value, progress_goal, deadline_ms "
+    "FROM tasks WHERE owner_id = ?";
 
-    ShopItem luckyBag;
-    luckyBag.setName("兰大幸运盲盒");
-    luckyBag.setDescription("随机掉落兰大币、成长值或额外道具，增添惊喜。");
-    luckyBag.setIconPath(":/icons/lucky.png");
-    luckyBag.setItemType(ShopItem::ItemType::LuckyBag);
-    luckyBag.setPriceCoins(45);
-    luckyBag.setPurchaseLimit(0);
-    luckyBag.setAvailable(true);
-    luckyBag.setLevelRequirement(1);
-    std::vector<ShopItem::LuckyBagReward> rewards;
-    ShopItem::LuckyBagReward rewardCoins;
-    rewardCoins.type = ShopItem::LuckyBagReward::RewardType::Coins;
-    rewardCoins.amount = 120;
-    rewardCoins.probability = 0.3;
-    rewardCoins.description = "120 兰大币";
-    rewards.push_back(rewardCoins);
+const char* const kSelectDeadlineFailuresSql =
+    "SELECT f.task_id, f.deadline_ms FROM task_deadline_failures f "
+    "JOIN tasks t ON t.id = f.task_id WHERE t.owner_id = ?";
 
-    ShopItem::LuckyBagReward rewardGrowth;
-    rewardGrowth.type = ShopItem::LuckyBagReward::RewardType::Growth;
-    rewardGrowth.amount = 40;
-    rewardGrowth.probability = 0.2;
-    rewardGrowth.description = "成长值 +40";
-    rewards.push_back(rewardGrowth);
+const char* const kSelectDailyActivitySql =
+    "SELECT day, completions, growth, logs FROM daily_activity "
+    "WHERE owner_id = ? AND day BETWEEN ? AND ? ORDER BY day ASC";
 
-    ShopItem::LuckyBagReward rewardCoupon;
-    rewardCoupon.type = ShopItem::LuckyBagReward::RewardType::ShopItem;
-    rewardCoupon.referenceItemId = -1;
-    rewardCoupon.amount = 1;
-    rewardCoupon.probability = 0.5;
-    rewardCoupon.description = "额外获取一张自习室休息日卡";
-    rewards.push_back(rewardCoupon);
-    luckyBag.setLuckyRewards(rewards);
-    seeds.push_back(luckyBag);
+const char* const kSelectProgressionDeltasSql =
+    "SELECT timestamp_ms, level_delta, growth_delta, attr_execution, attr_perseverance, attr_decision, "
+    "attr_knowledge, attr_social, attr_pride FROM progression_deltas "
+    "WHERE owner_id = ? AND timestamp_ms > ? AND timestamp_ms <= ? ORDER BY timestamp_ms ASC, id ASC";
 
-    for (auto& item : seeds) {
-        rc = insertShopItem(item.toRecord());
-        if (rc < 0) {
-            throw std::runtime_error(buildErrorMessage("Failed to seed shop items", m_db.get()));
+const char* const kSelectInventoryHeldAtSql =
+    "SELECT id, item_id, owner_id, quantity, used_quantity, status, purchase_time, expiration_time, "
+    "lucky_payload, notes, purchase_time_ms, expiration_time_ms FROM user_inventory "
+    "WHERE owner_id = ? AND purchase_time_ms <= ?2 AND (expiration_time_ms IS NULL OR expiration_time_ms > ?2) "
+    "ORDER BY purchase_time_ms DESC, id DESC";
+
+const char* const kSelectTaskStatTotalsSql =
+    "SELECT type, SUM(completed), SUM(failed) FROM task_stats WHERE owner_id = ? GROUP BY type";
+
+const char* const kSelectAchievementsForOwnerSql =
+    "SELECT id, owner_id, creator_id, name, description, icon_path, display_color, type, reward_type, "
+    "progress_mode, progress_value, progress_goal, reward_coins, attr_execution, attr_perseverance, "
+    "attr_decision, attr_knowledge, attr_social, attr_pride, reward_items, "
+    "unlocked, completion_time, conditions, gallery_group, created_at, special_metadata "
+    "FROM achievements WHERE owner_id = ? ORDER BY id";
+
+const char* const kUpdateShopItemSql =
+    "UPDATE shop_items SET name = ?, description = ?, icon_path = ?, item_type = ?, price_coins = ?, "
+    "purchase_limit = ?, available = ?, effect_description = ?, effect_logic = ?, prop_effect_type = ?, "
+    "prop_duration_minutes = ?, usage_conditions = ?, physical_redeem = ?, physical_notes = ?, "
+    "lucky_rules = ?, level_requirement = ? WHERE id = ?";
+
+const char* const kDeleteShopItemSql =
+    "DELETE FROM shop_items WHERE id = ?";
+
+const char* const kSelectShopItemByIdSql =
+    "SELECT id, name, description, icon_path, item_type, price_coins, purchase_limit, available, "
+    "effect_description, effect_logic, prop_effect_type, prop_duration_minutes, usage_conditions, "
+    "physical_redeem, physical_notes, lucky_rules, level_requirement FROM shop_items WHERE id = ?";
+
+const char* const kSelectAllShopItemsSql =
+    "SELECT id, name, description, icon_path, item_type, price_coins, purchase_limit, available, "
+    "effect_description, effect_logic, prop_effect_type, prop_duration_minutes, usage_conditions, "
+    "physical_redeem, physical_notes, lucky_rules, level_requirement FROM shop_items ORDER BY id";
+
+const char* const kDeleteInventorySql =
+    "DELETE FROM user_inventory WHERE id = ?";
+
+const char* const kSelectInventoryByIdSql =
+    "SELECT id, item_id, owner_id, quantity, used_quantity, status, purchase_time, expiration_time, "
+    "lucky_payload, notes, purchase_time_ms, expiration_time_ms FROM user_inventory WHERE id = ?";
+
+const char* const kSelectInventoryForOwnerSql =
+    "SELECT id, item_id, owner_id, quantity, used_quantity, status, purchase_time, expiration_time, "
+    "lucky_payload, notes, purchase_time_ms, expiration_time_ms FROM user_inventory WHERE owner_id = ? ORDER BY purchase_time_ms DESC, id DESC";
+
+const char* const kSelectExpiredInventorySql =
+    "SELECT id, item_id, owner_id, quantity, used_quantity, status, purchase_time, expiration_time, "
+    "lucky_payload, notes, purchase_time_ms, expiration_time_ms FROM user_inventory "
+    "WHERE status IN ('Unused', 'Active', 'Consumed') AND expiration_time_ms <= ? ORDER BY id";
+
+const char* const kCountInventoryByItemSql =
+    "SELECT IFNULL(SUM(quantity), 0) FROM user_inventory WHERE owner_id = ? AND item_id = ?";
+
+const char* const kInventoryTypeSummarySql =
+    "SELECT s.item_type, IFNULL(SUM(i.quantity), 0), "
+    "IFNULL(SUM(CASE WHEN i.expiration_time_ms > ? AND i.expiration_time_ms < ? THEN i.quantity ELSE 0 END), 0) "
+    "FROM user_inventory i LEFT JOIN shop_items s ON s.id = i.item_id "
+    "WHERE i.owner_id = ? GROUP BY s.item_type";
+
+const char* const kSelectInventoryItemTypesSql =
+    "SELECT DISTINCT i.item_id, s.item_type FROM user_inventory i JOIN shop_items s ON s.id = i.item_id "
+    "WHERE i.owner_id = ? AND s.item_type IS NOT NULL";
+
+const char* const kCountCustomRewardAchievementsSql =
+    "SELECT COUNT(1) FROM achievements WHERE owner_id = ?1 AND type = 'Custom' AND reward_type = 'WithReward' "
+    "AND created_at >= ?2 || '-01' AND created_at < date(?2 || '-01', '+1 month')";
+
+const char* const kCountManualLogsSql =
+    "SELECT COUNT(*) FROM logs WHERE owner_id = ? AND type = 'Manual'";
+
+const char* const kSelectForgivenLogIdsSql =
+    "SELECT f.log_id FROM forgiven_logs f JOIN logs l ON l.id = f.log_id WHERE l.owner_id = ? ORDER BY f.log_id";
+
+const char* const kSelectColdLogsSql =
+    "SELECT id, content FROM logs WHERE id > ?1 AND timestamp_ms < ?2 AND template_id = 0 "
+    "AND typeof(content) = 'text' AND length(CAST(content AS BLOB)) >= ?3 ORDER BY id LIMIT ?4";
+
+const char* const kUpdateLogContentSql =
+    "UPDATE logs SET content = ? WHERE id = ?";
+
+const char* const kSelectSnapshotOwnersToPackSql =
+    "SELECT owner_id FROM growth_snapshots WHERE timestamp_ms < ?1 GROUP BY owner_id HAVING COUNT(1) >= ?2";
+
+const char* const kUpsertAppStateSql =
+    "INSERT INTO app_state (key, value) VALUES (?, ?) ON CONFLICT(key) DO UPDATE SET value = excluded.value";
+
+const char* const kUpsertActivityFeedSql =
+    "INSERT INTO activity_feed_state (owner_id, state) VALUES (?, ?) "
+    "ON CONFLICT(owner_id) DO UPDATE SET state = excluded.state";
+
+const char* const kUpsertGrowthAnalyticsSql =
+    "INSERT INTO growth_analytics_state (owner_id, last_sample_ms, state) VALUES (?, ?, ?) "
+    "ON CONFLICT(owner_id) DO UPDATE SET last_sample_ms = excluded.last_sample_ms, state = excluded.state "
+    "WHERE excluded.last_sample_ms >= growth_analytics_state.last_sample_ms";
+
+const char* const kUpsertTaskStatSql =
+    "INSERT INTO task_stats (owner_id, day, type, completed, failed) VALUES (?, ?, ?, ?, ?) "
+    "ON CONFLICT(owner_id, day, type) DO UPDATE SET completed = completed + excluded.completed, "
+    "failed = failed + excluded.failed";
+
+const char* const kUpsertDeadlineFailureSql =
+    "INSERT INTO task_deadline_failures (task_id, deadline_ms) VALUES (?, ?) "
+    "ON CONFLICT(task_id) DO UPDATE SET deadline_ms = excluded.deadline_ms "
+    "WHERE deadline_ms <> excluded.deadline_ms";
+
+const char* const kUpsertDailyActivitySql =
+    "INSERT INTO daily_activity (owner_id, day, completions, growth, logs) "
+    "VALUES (?, CAST(julianday(? / 1000.0, 'unixepoch', 'localtime') + 0.5 AS INTEGER), ?, ?, ?) "
+    "ON CONFLICT(owner_id, day) DO UPDATE SET completions = completions + excluded.completions, "
+    "growth = growth + excluded.growth, logs = logs + excluded.logs";
+
+const char* const kInsertProgressionDeltaSql =
+    "INSERT INTO progression_deltas (owner_id, timestamp_ms, level_delta, growth_delta, attr_execution, "
+    "attr_perseverance, attr_decision, attr_knowledge, attr_social, attr_pride) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+const char* const kInsertForgivenLogSql =
+    "INSERT OR IGNORE INTO forgiven_logs (log_id) VALUES (?)";
+
+const char* const kSelectTimelineStartSql =
+    "SELECT CAST(strftime('%s', bucket_start) AS INTEGER) * 1000 FROM growth_snapshots_weekly "
+    "WHERE owner_id = ? ORDER BY bucket_start ASC LIMIT 1";
+
+const char* const kInsertSnapshotBlockSql =
+    "INSERT INTO growth_snapshot_blocks (owner_id, first_timestamp_ms, last_timestamp_ms, sample_count, "
+    "payload) VALUES (?, ?, ?, ?, ?)";
+
+constexpr std::size_t kMaxPendingSlowQueries = 16;
+constexpr int kAnalysisLimitRows = 400;  //!< 维护时 ANALYZE 每个索引最多采样的行数
+constexpr int kCheckpointPagesPerStep = 256;  //!< 内存库检查点每步复制的页数，步间可让出写锁
+
+thread_local std::vector<PendingSlowQuery> tPendingSlowQueries;
+thread_local bool tExplainingPlan = false;  //!< 正在执行跟踪器自己的 EXPLAIN，PROFILE 回调忽略它。
+
+/**
+ * @brief Run EXPLAIN QUERY PLAN for @p sql and return its detail rows, indented by depth.
+ * 中文：执行 EXPLAIN QUERY PLAN，按 parent 关系缩进返回各行 detail；准备失败时返回一行说明。
+ *
+ * @return Plan rows. 中文：计划行。
+ * @throws std::bad_alloc only. 中文：仅可能抛出内存分配异常。
+ */
+std::vector<std::string> explainQueryPlan(sqlite3* handle, const std::string& sql) {
+    std::vector<std::string> plan;
+    const std::string text = "EXPLAIN QUERY PLAN " + sql;
+    sqlite3_stmt* raw = nullptr;
+    tExplainingPlan = true;
+    if (sqlite3_prepare_v2(handle, text.c_str(), -1, &raw, nullptr) != SQLITE_OK) {
+        tExplainingPlan = false;
+        plan.push_back(std::string("(plan unavailable: ") + sqlite3_errmsg(handle) + ")");
+        return plan;
+    }
+    std::unique_ptr<sqlite3_stmt, decltype(&sqlite3_finalize)> statement(raw, &sqlite3_finalize);
+    std::unordered_map<int, std::size_t> depthById;
+    while (sqlite3_step(raw) == SQLITE_ROW) {
+        const int id = sqlite3_column_int(raw, 0);
+        const int parent = sqlite3_column_int(raw, 1);
+        const auto parentDepth = depthById.find(parent);
+        const std::size_t depth = parentDepth != depthById.end() ? parentDepth->second + 1 : 0;
+        depthById[id] = depth;
+        const auto* detail = reinterpret_cast<const char*>(sqlite3_column_text(raw, 3));
+        plan.push_back(std::string(depth * 2, ' ') + (detail != nullptr ? detail : ""));
+    }
+    statement.reset();
+    tExplainingPlan = false;
+    return plan;
+}
+
+/**
+ * @brief 计划中是否有不经索引的表扫描（"SCAN t"，排除 "USING ... INDEX" 与虚拟表）。
+ */
+bool planHasTableScan(const std::vector<std::string>& plan) {
+    for (const auto& row : plan) {
+        const auto begin = row.find_first_not_of(' ');
+        if (begin == std::string::npos || row.compare(begin, 5, "SCAN ") != 0) {
+            continue;
+        }
+        if (row.find(" USING ", begin) == std::string::npos && row.find("VIRTUAL TABLE", begin) == std::string::npos) {
+            return true;
         }
     }
+    return false;
 }
 
 /**
- * @brief Validate credentials specifically against the preconfigured "x"/"1" account.
- * 中文：专门验证预置的用户名 "x" 与密码 "1"。
- *
- * Business logic: teacher demo requires this credential; centralizing validation avoids hard-coded copies.
- * 中文：教师演示只认该账号，集中校验可避免多处硬编码导致维护困难。
- *
- * @param username Supplied username. 中文：输入的用户名。
- * @param password Supplied password. 中文：输入的密码。
- * @return true if credentials match stored row. 中文：匹配成功返回 true。
- * @throws std::runtime_error When SQLite query fails. 中文：查询失败时抛出异常。
+ * @brief 列出计划中不经索引扫描的表（语句使用别名时为别名），跳过常量行与子查询。
  */
-bool DatabaseManager::validatePreconfiguredAccount(const std::string& username,
-                                                    const std::string& password) const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    if (username != kPreconfiguredUsername || password != kPreconfiguredPassword) {
-        return false;
+std::vector<std::string> planScannedTables(const std::vector<std::string>& plan) {
+    std::vector<std::string> tables;
+    for (const auto& row : plan) {
+        const auto begin = row.find_first_not_of(' ');
+        if (begin == std::string::npos || row.compare(begin, 5, "SCAN ") != 0 ||
+            row.find(" USING ", begin) != std::string::npos || row.find("VIRTUAL TABLE", begin) != std::string::npos) {
+            continue;
+        }
+        const std::string name = row.substr(begin + 5, row.find(' ', begin + 5) - (begin + 5));
+        if (name != "CONSTANT" && name.rfind('(', 0) != 0) {
+            tables.push_back(name);
+        }
     }
+    return tables;
+}
 
-    const std::string sql =
-        "SELECT COUNT(1) FROM users WHERE username = ? AND password = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, username.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 2, password.c_str(), -1, SQLITE_TRANSIENT);
+thread_local DatabaseManager::WriteCounters tWriteCounters;  //!< 由写连接的提交回调在提交线程上累加。
 
-    int rc = sqlite3_step(stmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to validate preconfigured account", m_db.get()));
+/**
+ * @brief 依次执行提交后或回滚后的回调；某个回调抛出时记录警告，其余回调照常执行。
+ * 中文：此时事务已有定论（数据已提交或已撤销），回调失败不能再被当作事务失败报告给调用方。
+ */
+void runSettledActions(std::vector<std::function<void()>>& actions, const char* phase) {
+    for (auto& action : actions) {
+        try {
+            action();
+        } catch (const std::exception& error) {
+            qWarning() << phase << "callback failed:" << error.what();
+        } catch (...) {
+            qWarning() << phase << "callback failed with an unknown exception";
+        }
     }
-    return sqlite3_column_int(stmt.get(), 0) > 0;
 }
+}  // namespace
 
 /**
- * @brief Insert a new user record and return the generated row id.
- * 中文：插入新的用户记录，并返回 SQLite 生成的行号。
+ * @brief Construct the singleton with a null sqlite handle so RAII can attach later.
+ * 中文：构造函数保持 sqlite 句柄为空，等待 initialize() 打开数据库后才交由 RAII 管理。
  *
- * Business logic: returning the row id helps subsequent modules (inventory, quests) link foreign keys.
- * 中文：返回行号可让任务、背包等模块建立外键关联。
+ * Business logic: delaying actual IO operations avoids unnecessary disk access during program start.
+ * 中文：推迟实际 IO 操作可减少程序启动期间的磁盘访问，提高响应速度。
  *
- * @param user User data to store (id ignored). 中文：要保存的用户数据（忽略 id）。
- * @return Generated row id. 中文：生成的行号。
- * @throws std::runtime_error When insert fails. 中文：插入失败抛出异常。
+ * @return true 当创建了最外层事务。中文：若当前调用成为最外层事务则返回 true。
+ * @throws None. 中文：不抛出异常。
  */
-int DatabaseManager::createUser(const UserRecord& user) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "INSERT INTO users (username, password, level, currency, attributes) VALUES (?, ?, ?, ?, ?)";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, user.username.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 2, user.password.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 3, user.level);
-    sqlite3_bind_int(stmt.get(), 4, user.currency);
-    sqlite3_bind_text(stmt.get(), 5, user.attributes.c_str(), -1, SQLITE_TRANSIENT);
-
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to create user", m_db.get()));
-    }
-    return static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+DatabaseManager::DatabaseManager()
+    : m_db(nullptr, &sqlite3_close_v2),
+      m_databasePath(),
+      m_checkpointPath(),
+      m_checkpointedVersion(0),
+      m_checkpointWriteMutex(),
+      m_checkpointThread(),
+      m_checkpointerMutex(),
+      m_checkpointerWake(),
+      m_checkpointerStopping(false),
+      m_foregroundCheckpoints(0),
+      m_mutex("DatabaseManager"),
+      m_initialized(false),
+      m_transactionDepth(0),
+      m_transactionLock(),
+      m_connectionSettings(),
+      m_statementCache(),
+      m_statementCacheStats(),
+      m_transactionOwner(std::thread::id()),
+      m_preCommitActions(),
+      m_postCommitActions(),
+      m_rollbackActions(),
+      m_settledChanges(0),
+      m_busyTimeoutMs(0),
+      m_readPool(),
+      m_readPoolMutex(),
+      m_readPoolIdle(),
+      m_readerCacheStats(),
+      m_logSearchIndexed(false),
+      m_transactionStartedAt(),
+      m_queryTraceMutex(),
+      m_queryTraceOptions(),
+      m_queryTraceStatements(),
+      m_slowQueries(),
+      m_queryPlans(),
+      m_memoryRegistration() {
+    m_memoryRegistration = metrics::MemoryRegistry::instance().add(
+        "sqlite",
+        [this]() {
+            // 中文：预分配页缓存池中的页不经过 SQLite 堆，不计入 heapUsed，按已用槽数单独加上。
+            const SqliteMemoryStatus status = memoryStatus();
+            const SqliteMemoryStats process = sqliteMemoryStats();
+            const auto pageCacheBytes =
+                static_cast<std::size_t>(std::max<std::int64_t>(process.pageCacheSlotsUsed, 0)) *
+                process.pageCacheSlotBytes;
+            return metrics::MemoryUsage{
+                static_cast<std::size_t>(std::max<std::int64_t>(status.heapUsed, 0)) + pageCacheBytes,
+                status.connections};
+        },
+        [this]() { releaseMemory(); });
 }
 
 /**
- * @brief Retrieve a user row by username.
- * 中文：根据用户名查询用户记录。
+ * @brief Destructor closes the connection automatically thanks to std::unique_ptr.
+ * 中文：析构函数依赖 std::unique_ptr 自动关闭连接，符合 RAII 原则。
  *
- * Business logic: optional return type clearly communicates the possibility of a missing user.
- * 中文：使用 std::optional 可明确表达“可能不存在”的语义。
+ * Business logic: keeping cleanup centralized means every module can trust DatabaseManager to free
+ * resources when the application shuts down. 中文：集中化清理逻辑可确保应用退出时自动释放资源。
  *
- * @param username Target username. 中文：目标用户名。
- * @return Optional user record. 中文：若找到则返回用户记录，否则 std::nullopt。
- * @throws std::runtime_error When SQLite reports an error. 中文：查询出错时抛出异常。
+ * @return void. 中文：无返回值。
+ * @throws None. 中文：不抛出异常。
  */
-std::optional<DatabaseManager::UserRecord> DatabaseManager::getUserByName(
-    const std::string& username) const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+DatabaseManager::~DatabaseManager() { closeDatabase(); }
+
+/**
+ * @brief Retrieve the single global DatabaseManager instance (Singleton pattern).
+ * 中文：获取全局唯一的 DatabaseManager 单例，确保所有模块复用同一连接。
+ *
+ * Business logic: singleton guarantees consistent transaction boundaries and simplifies dependency injection
+ * in Qt widgets. 中文：单例保证事务边界一致，简化 Qt 控件的依赖注入。
+ *
+ * @return Reference to the singleton. 中文：返回单例引用。
+ * @throws None. 中文：不抛出异常。
+ */
+DatabaseManager& DatabaseManager::instance() {
+    static DatabaseManager instance;
+    return instance;
+}
+
+/**
+ * @brief Durable preset: WAL with a full fsync on every commit.
+ * 中文：持久优先预设：使用 WAL，但每次提交都完整 fsync。
+ */
+DatabaseManager::ConnectionProfile DatabaseManager::ConnectionProfile::durable() {
+    ConnectionProfile profile;
+    profile.name = "durable";
+    profile.walJournal = true;
+    profile.synchronous = SynchronousMode::Full;
+    profile.mmapSizeBytes = 0;
+    profile.cacheSizeKiB = 4096;
+    profile.tempStore = TempStore::Default;
+    profile.busyTimeoutMs = 5000;
+    return profile;
+}
+
+/**
+ * @brief Balanced preset used by default: WAL + synchronous=NORMAL.
+ * 中文：默认的均衡预设：WAL + NORMAL 同步，仅在检查点时 fsync。
+ */
+DatabaseManager::ConnectionProfile DatabaseManager::ConnectionProfile::balanced() { return ConnectionProfile{}; }
+
+/**
+ * @brief Fast interactive preset: no fsync, larger page cache and mmap window.
+ * 中文：交互优先预设：关闭同步、加大页缓存与内存映射窗口。
+ */
+DatabaseManager::ConnectionProfile DatabaseManager::ConnectionProfile::fastInteractive() {
+    ConnectionProfile profile;
+    profile.name = "fast-interactive";
+    profile.walJournal = true;
+    profile.synchronous = SynchronousMode::Off;
+    profile.mmapSizeBytes = 256LL * 1024 * 1024;
+    profile.cacheSizeKiB = 32768;
+    profile.tempStore = TempStore::Memory;
+    profile.busyTimeoutMs = 1000;
+    return profile;
+}
+
+/**
+ * @brief In-memory preset: the file is loaded into :memory: and written back every 30 seconds and on close.
+ * 中文：内存预设：文件载入内存库，每 30 秒及关闭时写回；内存库无法启用 WAL，只读连接池随之关闭，
+ *       读取改走写连接（内存中的查询足够快，无需分流）。
+ */
+DatabaseManager::ConnectionProfile DatabaseManager::ConnectionProfile::inMemoryCheckpointed() {
+    ConnectionProfile profile;
+    profile.name = "in-memory";
+    profile.walJournal = false;
+    profile.synchronous = SynchronousMode::Off;
+    profile.mmapSizeBytes = 0;
+    profile.cacheSizeKiB = 8192;
+    profile.tempStore = TempStore::Memory;
+    profile.busyTimeoutMs = 1000;
+    profile.readConnections = 0;
+    profile.inMemory = true;
+    profile.memoryCheckpointIntervalMs = 30000;
+    return profile;
+}
+
+/**
+ * @brief Initialize database connection, ensure schema, and seed default data.
+ * 中文：初始化数据库连接、确保数据表存在并写入默认数据。
+ *
+ * Business logic: explicit initialization lets the UI show friendly diagnostics if the path is invalid,
+ * and ensures schema creation runs only once. 中文：显式初始化让界面在路径无效时提供提示，并确保建表只执行一次。
+ *
+ * @param databasePath Path to SQLite file. 中文：SQLite 文件路径。
+ * @param profile PRAGMA preset applied right after opening. 中文：打开后立即应用的 PRAGMA 预设。
+ * @return void. 中文：无返回值。
+ * @throws std::runtime_error When database open or schema bootstrap fails. 中文：打开数据库或建表失败时抛出异常。
+ */
+void DatabaseManager::initialize(const std::string& databasePath, const ConnectionProfile& profile) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+
+    const std::string& openedPath = m_checkpointPath.empty() ? m_databasePath : m_checkpointPath;
+    if (m_initialized && m_db != nullptr && databasePath == openedPath && profile.inMemory == !m_checkpointPath.empty()) {
+        // English: Skip redundant open to preserve active connections; only re-apply the PRAGMA profile.
+        // 中文：若已连接同一路径则直接返回，保持现有连接和事务，仅重新应用 PRAGMA 配置。
+        if (profile.name != m_connectionSettings.profileName &&
+            m_transactionOwner.load() != std::this_thread::get_id()) {
+            applyConnectionProfile(profile);
+            openReadPool(profile);
+        }
+        return;
+    }
+
+    if (hasStatementsInUse()) {
+        throw std::runtime_error("Cannot reopen the database while cached statements are checked out");
+    }
+    closeDatabase();
+    const bool memoryMode = profile.inMemory && !databasePath.empty() && databasePath != ":memory:";
+    openDatabase(memoryMode ? ":memory:" : databasePath);
+    if (memoryMode) {
+        loadIntoMemory(databasePath);
+        m_checkpointPath = databasePath;
+    }
+    // 中文：新库须在切换 WAL 与建表前设置才会立即生效；旧库保持原模式，由空闲维护择机转换（见 convertToIncrementalVacuum）。
+    executeNonQuery("PRAGMA auto_vacuum = INCREMENTAL;");
+    // 中文：外键约束按连接开启且在事务内设置无效；只有写连接会修改数据，只读连接无需开启。
+    executeNonQuery("PRAGMA foreign_keys = ON;");
+    applyConnectionProfile(profile);
+    migrateSchema();
+    openReadPool(profile);
+    if (memoryMode) {
+        startCheckpointer(profile.memoryCheckpointIntervalMs);
+    }
+    m_initialized = true;
+}
+
+/**
+ * @brief Bring the schema up to kSchemaVersion using numbered migrations.
+ * 中文：按 PRAGMA user_version 执行编号迁移，把库结构升级到 kSchemaVersion。
+ *
+ * Business logic: a current database costs a single query at startup; version and FTS index presence are read
+ * together so no DDL, seeding or table inspection runs before the window appears.
+ * 中文：版本已是最新时启动只需一次查询，版本号与全文索引是否存在一并读出，窗口出现前不执行任何建表与预置插入。
+ *
+ * @return void. 中文：无返回值。
+ * @throws std::runtime_error When the file was written by a newer schema or a migration fails.
+ *         中文：库版本高于当前程序或迁移失败时抛出异常。
+ */
+void DatabaseManager::migrateSchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+
+    int currentVersion = 0;
+    bool searchIndexPresent = false;
+    {
+        auto stmt = prepareStatement(
+            "SELECT (SELECT user_version FROM pragma_user_version), "
+            "EXISTS(SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'logs_fts')");
+        if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+            throw std::runtime_error(buildErrorMessage("Failed to read schema version", m_db.get()));
+        }
+        currentVersion = sqlite3_column_int(stmt.get(), 0);
+        searchIndexPresent = sqlite3_column_int(stmt.get(), 1) != 0;
+    }
+
+    if (currentVersion > kSchemaVersion) {
+        throw std::runtime_error("Database schema version " + std::to_string(currentVersion) +
+                                 " is newer than supported version " + std::to_string(kSchemaVersion));
+    }
+    if (currentVersion == kSchemaVersion) {
+        if (searchIndexPresent) {
+            m_logSearchIndexed = true;
+        } else {
+            // 中文：库由缺少 FTS5 的构建创建，换用支持 FTS5 的构建时补建索引；仍不支持则保持 LIKE 检索。
+            ensureLogSearchIndex();
+        }
+        return;
+    }
+
+    struct SchemaMigration {
+        int version;
+        void (DatabaseManager::*apply)();
+    };
+    // 中文：新增迁移时追加一项并递增 kSchemaVersion，已发布的迁移不可修改。
+    static constexpr SchemaMigration kMigrations[] = {
+        {1, &DatabaseManager::applyBaselineSchema},
+        {2, &DatabaseManager::applyAppStateSchema},
+        {3, &DatabaseManager::applyGrowthAnalyticsSchema},
+        {4, &DatabaseManager::applyTaskStatsSchema},
+        {5, &DatabaseManager::applyOwnerPartitionSchema},
+        {6, &DatabaseManager::applyUserForeignKeySchema},
+        {7, &DatabaseManager::applyCoveringIndexSchema},
+        {8, &DatabaseManager::applyLogTemplateSchema},
+        {9, &DatabaseManager::applySnapshotBlockSchema},
+        {10, &DatabaseManager::applyActivityFeedSchema},
+        {11, &DatabaseManager::applyDailyActivitySchema},
+        {12, &DatabaseManager::applyProgressionDeltaSchema},
+        {13, &DatabaseManager::applyTaskDeadlineFailureSchema},
+    };
+
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        for (const auto& migration : kMigrations) {
+            if (migration.version > currentVersion) {
+                (this->*migration.apply)();
+            }
+        }
+        executeNonQuery("PRAGMA user_version = " + std::to_string(kSchemaVersion) + ";");
+        commitTransaction();
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+/**
+ * @brief 迁移 1：建表、兼容旧版列布局并写入预置数据。
+ * 中文：引入版本号之前的库（user_version 为 0）无论处于哪种旧布局，都由这些可重入步骤补齐。
+ */
+void DatabaseManager::applyBaselineSchema() {
+    ensureUserTable();
+    migrateAttributeColumns("users", "attributes", false);
+    ensureTaskTable();
+    migrateAttributeColumns("tasks", "attribute_reward", true);
+    ensureAchievementTable();
+    migrateAttributeColumns("achievements", "reward_attributes", true);
+    migrateAchievementConditions();
+    ensureShopTable();
+    ensureInventoryTable();
+    ensureLogTable();
+    ensureLogSearchIndex();
+    ensureForgivenLogTable();
+    ensureGrowthSnapshotTable();
+    seedDefaultTasks();
+    seedDefaultAchievements();
+    seedDefaultShopItems();
+}
+
+/**
+ * @brief Return the PRAGMA values read back after the last profile application.
+ * 中文：返回最近一次应用配置后读回的 PRAGMA 值。
+ *
+ * @return Applied settings. 中文：实际生效的配置。
+ * @throws None. 中文：不抛出异常。
+ */
+DatabaseManager::AppliedConnectionSettings DatabaseManager::appliedConnectionSettings() const {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    return m_connectionSettings;
+}
+
+/**
+ * @brief Report whether a valid sqlite3 handle exists.
+ * 中文：报告当前是否存在有效 sqlite3 句柄。
+ *
+ * Business logic: allows UI to gray-out DB-dependent actions when disconnected. 中文：用于界面判断是否禁用依赖数据库的按钮。
+ *
+ * @return true when connection is alive, false otherwise. 中文：连接有效返回 true，否则 false。
+ * @throws None. 中文：不抛出异常。
+ */
+bool DatabaseManager::isConnected() const noexcept { return m_db != nullptr; }
+
+/**
+ * @brief Create the users table if missing and seed the teacher-specified testing account.
+ * 中文：若 users 表不存在则创建，并插入教师要求的预置账号。
+ *
+ * Business logic: centralizing schema creation prevents divergence when multiple developers run migrations
+ * on different machines. 中文：集中建表逻辑可避免多开发环境间的数据结构差异。
+ *
+ * @return void. 中文：无返回值。
+ * @throws std::runtime_error On SQL execution failures. 中文：SQL 执行失败时抛出异常。
+ */
+void DatabaseManager::ensureUserTable() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+
     const std::string sql =
-        "SELECT id, username, password, level, currency, attributes FROM users WHERE username = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, username.c_str(), -1, SQLITE_TRANSIENT);
+        "CREATE TABLE IF NOT EXISTS users ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "username TEXT UNIQUE NOT NULL,"
+        "password TEXT NOT NULL,"
+        "level INTEGER NOT NULL DEFAULT 1,"
+        "currency INTEGER NOT NULL DEFAULT 0,"
+        "attributes TEXT NOT NULL DEFAULT '{}',"
+        "attr_execution INTEGER NOT NULL DEFAULT 0,"
+        "attr_perseverance INTEGER NOT NULL DEFAULT 0,"
+        "attr_decision INTEGER NOT NULL DEFAULT 0,"
+        "attr_knowledge INTEGER NOT NULL DEFAULT 0,"
+        "attr_social INTEGER NOT NULL DEFAULT 0,"
+        "attr_pride INTEGER NOT NULL DEFAULT 0)";
+
+    executeNonQuery(sql);
+
+    const std::string countSql =
+        "SELECT COUNT(1) FROM users WHERE username = ? AND password = ?";
+    auto stmt = prepareStatement(countSql);
+    sqlite3_bind_text(stmt.get(), 1, kPreconfiguredUsername, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 2, kPreconfiguredPassword, -1, SQLITE_STATIC);
 
     int rc = sqlite3_step(stmt.get());
-    if (rc == SQLITE_ROW) {
-        UserRecord record;
-        record.id = sqlite3_column_int(stmt.get(), 0);
-        record.username = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 1));
-        record.password = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 2));
-        record.level = sqlite3_column_int(stmt.get(), 3);
-        record.currency = sqlite3_column_int(stmt.get(), 4);
-        record.attributes = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 5));
-        return record;
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to query default account", m_db.get()));
+    }
+
+    bool needInsert = sqlite3_column_int(stmt.get(), 0) == 0;
+    if (needInsert) {
+        const std::string insertSql =
+            "INSERT INTO users (username, password, level, currency, attributes) "
+            "VALUES (?, ?, 1, 0, '{""initial"":true}')";
+        auto insertStmt = prepareStatement(insertSql);
+        sqlite3_bind_text(insertStmt.get(), 1, kPreconfiguredUsername, -1, SQLITE_STATIC);
+        sqlite3_bind_text(insertStmt.get(), 2, kPreconfiguredPassword, -1, SQLITE_STATIC);
+        rc = sqlite3_step(insertStmt.get());
+        if (!isSuccessCode(rc)) {
+            throw std::runtime_error(buildErrorMessage("Failed to insert default account", m_db.get()));
+        }
+    }
+}
+
+/**
+ * @brief 确保任务表存在，集中管理任务系统的持久化结构。
+ * 中文：任务表字段涵盖任务类型、难度星级、截止时间、奖励、连胜、宽恕券、进度等信息，
+ *       通过集中建表既能满足教师“奖励与难度平衡”的讲解需要，也方便 TaskManager 事务化操作。
+ */
+void DatabaseManager::ensureTaskTable() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "CREATE TABLE IF NOT EXISTS tasks ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "name TEXT NOT NULL,"
+        "description TEXT NOT NULL,"
+        "type TEXT NOT NULL,"
+        "difficulty INTEGER NOT NULL,"
+        "deadline TEXT NOT NULL,"
+        "completed INTEGER NOT NULL DEFAULT 0,"
+        "coin_reward INTEGER NOT NULL DEFAULT 0,"
+        "growth_reward INTEGER NOT NULL DEFAULT 0,"
+        "attr_execution INTEGER NOT NULL DEFAULT 0,"
+        "attr_perseverance INTEGER NOT NULL DEFAULT 0,"
+        "attr_decision INTEGER NOT NULL DEFAULT 0,"
+        "attr_knowledge INTEGER NOT NULL DEFAULT 0,"
+        "attr_social INTEGER NOT NULL DEFAULT 0,"
+        "attr_pride INTEGER NOT NULL DEFAULT 0,"
+        "bonus_streak INTEGER NOT NULL DEFAULT 0,"
+        "custom_settings TEXT NOT NULL DEFAULT '{}',"
+        "forgiveness_coupons INTEGER NOT NULL DEFAULT 0,"
+        "progress_value INTEGER NOT NULL DEFAULT 0,"
+        "progress_goal INTEGER NOT NULL DEFAULT 100,"
+        "deadline_ms INTEGER)";
+    executeNonQuery(sql);
+    migrateEpochColumn("tasks", "deadline", "deadline_ms");
+}
+
+void DatabaseManager::ensureAchievementTable() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "CREATE TABLE IF NOT EXISTS achievements ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "owner TEXT NOT NULL,"
+        "creator TEXT NOT NULL,"
+        "name TEXT NOT NULL,"
+        "description TEXT NOT NULL,"
+        "icon_path TEXT NOT NULL,"
+        "display_color TEXT NOT NULL,"
+        "type TEXT NOT NULL,"
+        "reward_type TEXT NOT NULL,"
+        "progress_mode TEXT NOT NULL,"
+        "progress_value INTEGER NOT NULL DEFAULT 0,"
+        "progress_goal INTEGER NOT NULL DEFAULT 1,"
+        "reward_coins INTEGER NOT NULL DEFAULT 0,"
+        "attr_execution INTEGER NOT NULL DEFAULT 0,"
+        "attr_perseverance INTEGER NOT NULL DEFAULT 0,"
+        "attr_decision INTEGER NOT NULL DEFAULT 0,"
+        "attr_knowledge INTEGER NOT NULL DEFAULT 0,"
+        "attr_social INTEGER NOT NULL DEFAULT 0,"
+        "attr_pride INTEGER NOT NULL DEFAULT 0,"
+        "reward_items TEXT NOT NULL DEFAULT '',"
+        "unlocked INTEGER NOT NULL DEFAULT 0,"
+        "completion_time TEXT,"
+        "conditions BLOB NOT NULL,"
+        "gallery_group TEXT NOT NULL DEFAULT 'default',"
+        "created_at TEXT NOT NULL,"
+        "special_metadata TEXT NOT NULL DEFAULT '')";
+    executeNonQuery(sql);
+}
+
+/**
+ * @brief 旧库升级：补齐 attr_* 属性列，从旧文本列解析一次属性值后写入新列。
+ * 中文：以 attr_execution 列是否存在判断是否已迁移；加列、回填与删除旧列处于同一事务，
+ *       SQLite 的 DDL 同样受事务保护，失败时整体回滚，下次启动重试。
+ */
+void DatabaseManager::migrateAttributeColumns(const std::string& table,
+                                              const std::string& legacyColumn,
+                                              bool dropLegacy) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    bool hasAttributeColumns = false;
+    bool hasLegacyColumn = false;
+    {
+        auto infoStmt = prepareStatement("PRAGMA table_info(" + table + ")");
+        while (true) {
+            int rc = sqlite3_step(infoStmt.get());
+            if (rc == SQLITE_ROW) {
+                const std::string name = reinterpret_cast<const char*>(sqlite3_column_text(infoStmt.get(), 1));
+                hasAttributeColumns = hasAttributeColumns || name == kAttributeColumns[0];
+                hasLegacyColumn = hasLegacyColumn || name == legacyColumn;
+                continue;
+            }
+            if (rc == SQLITE_DONE) {
+                break;
+            }
+            throw std::runtime_error(buildErrorMessage("Failed to inspect table " + table, m_db.get()));
+        }
+    }
+    if (hasAttributeColumns) {
+        return;
+    }
+
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        for (const char* column : kAttributeColumns) {
+            executeNonQuery("ALTER TABLE " + table + " ADD COLUMN " + column + " INTEGER NOT NULL DEFAULT 0");
+        }
+        if (hasLegacyColumn) {
+            std::vector<std::pair<int, User::AttributeSet>> rows;
+            {
+                auto selectStmt = prepareStatement("SELECT id, " + legacyColumn + " FROM " + table);
+                while (true) {
+                    int rc = sqlite3_step(selectStmt.get());
+                    if (rc == SQLITE_ROW) {
+                        const unsigned char* text = sqlite3_column_text(selectStmt.get(), 1);
+                        rows.emplace_back(sqlite3_column_int(selectStmt.get(), 0),
+                                          codec::decodeLegacyAttributes(
+                                              text == nullptr ? "" : reinterpret_cast<const char*>(text)));
+                        continue;
+                    }
+                    if (rc == SQLITE_DONE) {
+                        break;
+                    }
+                    throw std::runtime_error(buildErrorMessage("Failed to read legacy attributes", m_db.get()));
+                }
+            }
+            {
+                auto updateStmt = prepareStatement(
+                    "UPDATE " + table +
+                    " SET attr_execution = ?, attr_perseverance = ?, attr_decision = ?, attr_knowledge = ?, "
+                    "attr_social = ?, attr_pride = ? WHERE id = ?");
+                for (const auto& [id, attributes] : rows) {
+                    sqlite3_reset(updateStmt.get());
+                    const int next = bindAttributeSet(updateStmt.get(), 1, attributes);
+                    sqlite3_bind_int(updateStmt.get(), next, id);
+                    if (sqlite3_step(updateStmt.get()) != SQLITE_DONE) {
+                        throw std::runtime_error(buildErrorMessage("Failed to migrate attributes", m_db.get()));
+                    }
+                }
+            }
+            if (dropLegacy) {
+                executeNonQuery("ALTER TABLE " + table + " DROP COLUMN " + legacyColumn);
+            }
+        }
+        commitTransaction();
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+/**
+ * @brief 将旧版 "type,target,current,metadata;..." 文本条件一次性改写为二进制编码。
+ * 中文：只扫描 typeof(conditions) = 'text' 的行，迁移完成后再次启动不会命中任何行；
+ *       整个迁移处于同一事务中，失败时回滚，旧格式仍可被解码器读取。
+ */
+void DatabaseManager::migrateAchievementConditions() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    std::vector<std::pair<int, std::string>> legacyRows;
+    {
+        auto selectStmt = prepareStatement("SELECT id, conditions FROM achievements WHERE typeof(conditions) = 'text'");
+        while (true) {
+            int rc = sqlite3_step(selectStmt.get());
+            if (rc == SQLITE_ROW) {
+                legacyRows.emplace_back(sqlite3_column_int(selectStmt.get(), 0), readBytes(selectStmt.get(), 1));
+                continue;
+            }
+            if (rc == SQLITE_DONE) {
+                break;
+            }
+            throw std::runtime_error(buildErrorMessage("Failed to scan legacy achievement conditions", m_db.get()));
+        }
+    }
+    if (legacyRows.empty()) {
+        return;
+    }
+
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        auto updateStmt = prepareStatement("UPDATE achievements SET conditions = ? WHERE id = ?");
+        std::vector<Achievement::Condition> conditions;
+        for (const auto& [id, text] : legacyRows) {
+            codec::decodeConditions(text, conditions);
+            const std::string encoded = codec::encodeConditions(conditions);
+            sqlite3_reset(updateStmt.get());
+            sqlite3_bind_blob(updateStmt.get(), 1, encoded.data(), static_cast<int>(encoded.size()), SQLITE_TRANSIENT);
+            sqlite3_bind_int(updateStmt.get(), 2, id);
+            if (sqlite3_step(updateStmt.get()) != SQLITE_DONE) {
+                throw std::runtime_error(buildErrorMessage("Failed to migrate achievement conditions", m_db.get()));
+            }
+        }
+        commitTransaction();
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+void DatabaseManager::ensureShopTable() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "CREATE TABLE IF NOT EXISTS shop_items ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "name TEXT NOT NULL,"
+        "description TEXT NOT NULL,"
+        "icon_path TEXT NOT NULL,"
+        "item_type TEXT NOT NULL,"
+        "price_coins INTEGER NOT NULL,"
+        "purchase_limit INTEGER NOT NULL DEFAULT 0,"
+        "available INTEGER NOT NULL DEFAULT 1,"
+        "effect_description TEXT NOT NULL DEFAULT '',"
+        "effect_logic TEXT NOT NULL DEFAULT '',"
+        "prop_effect_type TEXT NOT NULL DEFAULT '',"
+        "prop_duration_minutes INTEGER NOT NULL DEFAULT 0,"
+        "usage_conditions TEXT NOT NULL DEFAULT '',"
+        "physical_redeem TEXT NOT NULL DEFAULT '',"
+        "physical_notes TEXT NOT NULL DEFAULT '',"
+        "lucky_rules TEXT NOT NULL DEFAULT '{}',"
+        "level_requirement INTEGER NOT NULL DEFAULT 1);";
+    executeNonQuery(sql);
+    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_shop_items_type ON shop_items(item_type);");
+}
+
+void DatabaseManager::ensureInventoryTable() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "CREATE TABLE IF NOT EXISTS user_inventory ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "owner TEXT NOT NULL,"
+        "item_id INTEGER NOT NULL,"
+        "quantity INTEGER NOT NULL,"
+        "used_quantity INTEGER NOT NULL DEFAULT 0,"
+        "status TEXT NOT NULL,"
+        "purchase_time TEXT NOT NULL,"
+        "expiration_time TEXT,"
+        "lucky_payload TEXT NOT NULL DEFAULT '{}',"
+        "notes TEXT NOT NULL DEFAULT '',"
+        "purchase_time_ms INTEGER,"
+        "expiration_time_ms INTEGER,"
+        "FOREIGN KEY(owner) REFERENCES users(username) ON DELETE CASCADE,"
+        "FOREIGN KEY(item_id) REFERENCES shop_items(id) ON DELETE CASCADE);";
+    executeNonQuery(sql);
+    migrateEpochColumn("user_inventory", "purchase_time", "purchase_time_ms");
+    migrateEpochColumn("user_inventory", "expiration_time", "expiration_time_ms");
+    // 中文：(owner, item_id, quantity) 覆盖索引让限购统计的 SUM(quantity) 只读索引；
+    //       其 owner 前缀同样服务于按用户列出库存，因此删除旧的单列 owner 索引。
+    executeNonQuery(
+        "CREATE INDEX IF NOT EXISTS idx_inventory_owner_item ON user_inventory(owner, item_id, quantity);");
+    executeNonQuery("DROP INDEX IF EXISTS idx_inventory_owner;");
+    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_inventory_item ON user_inventory(item_id);");
+    executeNonQuery(
+        "CREATE INDEX IF NOT EXISTS idx_inventory_status_expiration_ms ON user_inventory(status, expiration_time_ms);");
+    executeNonQuery("DROP INDEX IF EXISTS idx_inventory_status_expiration;");
+}
+
+
+/**
+ * @brief 确保日志表存在并建立必要索引。
+ * 中文：记录自动、手动、里程碑与事件日志，为时间线过滤提供结构。
+ */
+void DatabaseManager::ensureLogTable() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "CREATE TABLE IF NOT EXISTS logs (\n"
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,\n"
+        "timestamp TEXT NOT NULL,\n"
+        "type TEXT NOT NULL,\n"
+        "content TEXT NOT NULL,\n"
+        "related_id INTEGER,\n"
+        "attribute_changes TEXT NOT NULL DEFAULT '{}',\n"
+        "level_change INTEGER NOT NULL DEFAULT 0,\n"
+        "special_event TEXT NOT NULL DEFAULT '',\n"
+        "mood TEXT NOT NULL DEFAULT '',\n"
+        "timestamp_ms INTEGER"
+        " );";
+    executeNonQuery(sql);
+    migrateEpochColumn("logs", "timestamp", "timestamp_ms");
+    // 中文：排序、区间与分页游标均按整数 timestamp_ms 比较，索引随之改建在毫秒列上。
+    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_logs_timestamp_ms ON logs(timestamp_ms);");
+    executeNonQuery("DROP INDEX IF EXISTS idx_logs_timestamp;");
+    // 中文：(type, timestamp_ms) 组合索引让“按类型 + 时间区间”的视图直接走索引范围扫描，
+    //       并覆盖原单列 type 索引的所有用途，因此删除旧索引以减少写放大。
+    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_logs_type_timestamp_ms ON logs(type, timestamp_ms);");
+    executeNonQuery("DROP INDEX IF EXISTS idx_logs_type_timestamp;");
+    executeNonQuery("DROP INDEX IF EXISTS idx_logs_type;");
+    // 中文：超出保留期的 Auto 日志按 (本地日期, special_event) 汇总于此，明细移入归档库。
+    executeNonQuery(
+        "CREATE TABLE IF NOT EXISTS log_daily_summaries (\n"
+        "day TEXT NOT NULL,\n"
+        "special_event TEXT NOT NULL,\n"
+        "entry_count INTEGER NOT NULL,\n"
+        "level_change INTEGER NOT NULL,\n"
+        "first_timestamp_ms INTEGER NOT NULL,\n"
+        "last_timestamp_ms INTEGER NOT NULL,\n"
+        "PRIMARY KEY(day, special_event)) WITHOUT ROWID;");
+}
+
+/**
+ * @brief 旧库升级：为 ISO 文本时间列补齐对应的 INTEGER 毫秒列，并一次性回填。
+ * 中文：以毫秒列是否存在判断是否已迁移；按去重后的 ISO 值逐个换算（同一时刻只解析一次），
+ *       无法解析的值保持 NULL。加列与回填处于同一事务，失败时整体回滚，下次启动重试。
+ */
+void DatabaseManager::migrateEpochColumn(const std::string& table,
+                                         const std::string& isoColumn,
+                                         const std::string& msColumn) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    bool hasColumn = false;
+    {
+        auto infoStmt = prepareStatement("PRAGMA table_info(" + table + ")");
+        while (true) {
+            int rc = sqlite3_step(infoStmt.get());
+            if (rc == SQLITE_ROW) {
+                const std::string name = reinterpret_cast<const char*>(sqlite3_column_text(infoStmt.get(), 1));
+                hasColumn = hasColumn || name == msColumn;
+                continue;
+            }
+            if (rc == SQLITE_DONE) {
+                break;
+            }
+            throw std::runtime_error(buildErrorMessage("Failed to inspect table " + table, m_db.get()));
+        }
+    }
+    if (hasColumn) {
+        return;
+    }
+
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        executeNonQuery("ALTER TABLE " + table + " ADD COLUMN " + msColumn + " INTEGER");
+        std::vector<std::string> values;
+        {
+            auto selectStmt = prepareStatement("SELECT DISTINCT " + isoColumn + " FROM " + table + " WHERE " +
+                                               isoColumn + " IS NOT NULL");
+            while (true) {
+                int rc = sqlite3_step(selectStmt.get());
+                if (rc == SQLITE_ROW) {
+                    values.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(selectStmt.get(), 0)));
+                    continue;
+                }
+                if (rc == SQLITE_DONE) {
+                    break;
+                }
+                throw std::runtime_error(buildErrorMessage("Failed to read " + table + "." + isoColumn, m_db.get()));
+            }
+        }
+        {
+            auto updateStmt = prepareStatement("UPDATE " + table + " SET " + msColumn + " = ? WHERE " + isoColumn +
+                                               " = ?");
+            for (const auto& value : values) {
+                sqlite3_reset(updateStmt.get());
+                bindEpochMs(updateStmt.get(), 1, value);
+                sqlite3_bind_text(updateStmt.get(), 2, value.c_str(), -1, SQLITE_TRANSIENT);
+                if (sqlite3_step(updateStmt.get()) != SQLITE_DONE) {
+                    throw std::runtime_error(buildErrorMessage("Failed to migrate " + table + "." + msColumn,
+                                                               m_db.get()));
+                }
+            }
+        }
+        commitTransaction();
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+/**
+ * @brief 建立 logs_fts 无内容全文索引，插入由写入路径维护，删除由触发器同步。
+ * 中文：trigram 分词器按三字滑窗切分，中文无需分词词典即可子串检索。
+ *       模板日志的 content 只是参数、冷日志的 content 是压缩 BLOB，显示文本只能由程序渲染，
+ *       因此索引不设内容源（content=''），插入日志的同一事务内由 indexLogRecord 写入渲染后的文本；
+ *       contentless_delete 让删除只需 rowid，删除触发器不引用任何应用注册的 SQL 函数。
+ *       其他工具直接写入的日志不会进入索引，LIKE 回退与下次重建不受影响。
+ *       索引表首次创建时按行渲染回填已有日志。
+ */
+void DatabaseManager::ensureLogSearchIndex() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    bool existed = false;
+    {
+        auto stmt = prepareStatement("SELECT EXISTS(SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'logs_fts')");
+        if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+            throw std::runtime_error(buildErrorMessage("Failed to inspect log search index", m_db.get()));
+        }
+        existed = sqlite3_column_int(stmt.get(), 0) != 0;
+    }
+    try {
+        executeNonQuery(
+            "CREATE VIRTUAL TABLE IF NOT EXISTS logs_fts USING fts5("
+            "content, special_event, content='', contentless_delete=1, tokenize='trigram');");
+    } catch (const std::runtime_error&) {
+        // 中文：链接的 SQLite 缺少 FTS5 时保持 LIKE 检索。
+        m_logSearchIndexed = false;
+        return;
+    }
+    executeNonQuery(
+        "CREATE TRIGGER IF NOT EXISTS logs_fts_ad AFTER DELETE ON logs BEGIN "
+        "DELETE FROM logs_fts WHERE rowid = old.id; "
+        "END;");
+    m_logSearchIndexed = true;
+    if (!existed) {
+        indexLogsForSearch(std::nullopt);
+    }
+}
+
+/**
+ * @brief 把已有日志渲染后写入 logs_fts；ownerId 为空时处理全部日志。
+ * 中文：迁移 1 建索引时 logs 还没有 template_id 列，此时按原文写入；压缩过的正文先解压。
+ *       调用方持有写锁。
+ */
+void DatabaseManager::indexLogsForSearch(const std::optional<int>& ownerId) {
+    bool templated = false;
+    {
+        auto stmt = prepareStatement("SELECT EXISTS(SELECT 1 FROM pragma_table_info('logs') WHERE name = 'template_id')");
+        if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+            throw std::runtime_error(buildErrorMessage("Failed to inspect log columns", m_db.get()));
+        }
+        templated = sqlite3_column_int(stmt.get(), 0) != 0;
+    }
+    std::string sql = std::string("SELECT id, ") + (templated ? "template_id" : "0") +
+                      ", content, special_event FROM logs";
+    if (ownerId.has_value()) {
+        sql += " WHERE owner_id = ?";
+    }
+    auto select = prepareStatement(sql);
+    if (ownerId.has_value()) {
+        sqlite3_bind_int(select.get(), 1, *ownerId);
+    }
+    LogRecord record;
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(select.get())) == SQLITE_ROW) {
+        const int id = sqlite3_column_int(select.get(), 0);
+        record.templateId = sqlite3_column_int(select.get(), 1);
+        if (sqlite3_column_type(select.get(), 2) == SQLITE_BLOB) {
+            auto text = inflateLogContent(sqlite3_column_blob(select.get(), 2), sqlite3_column_bytes(select.get(), 2));
+            if (!text.has_value()) {
+                throw std::runtime_error("Corrupt compressed content in log " + std::to_string(id));
+            }
+            record.content = std::move(*text);
+        } else {
+            assignText(record.content, select.get(), 2);
+        }
+        assignText(record.specialEvent, select.get(), 3);
+        indexLogRecord(id, record);
+    }
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to index logs for search", m_db.get()));
+    }
+}
+
+/**
+ * @brief 确保宽恕日志表存在，记录被隐藏的日志 ID，支持跨会话恢复状态。
+ * 中文：宽恕表仅保存日志主键，依赖外键约束保证数据一致性。
+ */
+void DatabaseManager::ensureForgivenLogTable() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "CREATE TABLE IF NOT EXISTS forgiven_logs (\n"
+        "log_id INTEGER PRIMARY KEY,\n"
+        "FOREIGN KEY(log_id) REFERENCES logs(id) ON DELETE CASCADE\n"
+        ");";
+    executeNonQuery(sql);
+}
+
+/**
+ * @brief 迁移 2：新建 app_state 键值表。
+ * 中文：保存每日/每周重置与每日奇遇等已处理水位，键为文本、值为整数。
+ */
+void DatabaseManager::applyAppStateSchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    executeNonQuery(
+        "CREATE TABLE IF NOT EXISTS app_state (\n"
+        "    key TEXT PRIMARY KEY,\n"
+        "    value INTEGER NOT NULL\n"
+        ") WITHOUT ROWID;");
+}
+
+/**
+ * @brief 读取 app_state 中的整数状态值，键不存在时返回空。
+ * 中文：走写连接而非读连接池，事务内调用可看到本事务尚未提交的写入。
+ */
+std::optional<std::int64_t> DatabaseManager::getAppState(const std::string& key) const {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kSelectAppStateSql);
+    sqlite3_bind_text(stmt.get(), 1, key.c_str(), -1, SQLITE_TRANSIENT);
+    const int rc = sqlite3_step(stmt.get());
+    if (rc == SQLITE_ROW) {
+        return sqlite3_column_int64(stmt.get(), 0);
+    }
+    if (rc == SQLITE_DONE) {
+        return std::nullopt;
+    }
+    throw std::runtime_error(buildErrorMessage("Failed to read app state", m_db.get()));
+}
+
+/**
+ * @brief 写入 app_state 中的整数状态值，键已存在时覆盖。
+ * 中文：在调用方事务内执行时随事务一同提交或回滚，保证水位与对应的业务写入一致。
+ */
+void DatabaseManager::setAppState(const std::string& key, std::int64_t value) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpsertAppStateSql);
+    sqlite3_bind_text(stmt.get(), 1, key.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt.get(), 2, value);
+    if (!isSuccessCode(sqlite3_step(stmt.get()))) {
+        throw std::runtime_error(buildErrorMessage("Failed to write app state", m_db.get()));
+    }
+}
+
+void DatabaseManager::applyGrowthAnalyticsSchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    executeNonQuery(
+        "CREATE TABLE IF NOT EXISTS growth_analytics_state (\n"
+        "    id INTEGER PRIMARY KEY CHECK (id = 1),\n"
+        "    last_sample_ms INTEGER NOT NULL,\n"
+        "    state BLOB NOT NULL\n"
+        ");");
+}
+
+void DatabaseManager::applyTaskStatsSchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    executeNonQuery(
+        "CREATE TABLE IF NOT EXISTS task_stats (\n"
+        "    day TEXT NOT NULL,\n"
+        "    type TEXT NOT NULL,\n"
+        "    completed INTEGER NOT NULL DEFAULT 0,\n"
+        "    failed INTEGER NOT NULL DEFAULT 0,\n"
+        "    PRIMARY KEY (day, type)\n"
+        ") WITHOUT ROWID;");
+    // 中文：此前的完成统计在启动时由已完成任务数重建，迁移时把它作为当日基线写入，升级前后数值连续。
+    executeNonQuery(
+        "INSERT OR IGNORE INTO task_stats (day, type, completed, failed) "
+        "SELECT date('now', 'localtime'), type, COUNT(1), 0 FROM tasks WHERE completed = 1 GROUP BY type;");
+}
+
+/**
+ * @brief 迁移 5：任务、日志与成长快照按用户分区。
+ * 中文：三张明细表新增 owner_id（users.id），既有行归属最早创建的用户（即预置账号）；时间索引改建为
+ *       (owner_id, ...) 组合索引，按用户查询只定位该用户的区间，不再扫描其他学生的数据。
+ *       以 (day, type) 等为主键的派生表无法原地加入用户列，按“新建 → 复制 → 删除 → 改名”重建；
+ *       app_state 中的任务重置水位改为带用户后缀的键，与 SerendipityEngine 的按用户键一致。
+ */
+void DatabaseManager::applyOwnerPartitionSchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    // 中文：ADD COLUMN 的默认值只能是常量，先以 0 加列再统一回填。
+    const std::string legacyOwner = "IFNULL((SELECT MIN(id) FROM users), 0)";
+    for (const char* table : {"tasks", "logs", "growth_snapshots"}) {
+        executeNonQuery(std::string("ALTER TABLE ") + table + " ADD COLUMN owner_id INTEGER NOT NULL DEFAULT 0;");
+        executeNonQuery(std::string("UPDATE ") + table + " SET owner_id = " + legacyOwner + ";");
+    }
+    // 中文：组合索引覆盖原单列时间索引的全部用途（查询总是带用户条件），旧索引删除以减少写放大。
+    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_tasks_owner_deadline_ms ON tasks(owner_id, deadline_ms);");
+    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_logs_owner_timestamp_ms ON logs(owner_id, timestamp_ms);");
+    executeNonQuery(
+        "CREATE INDEX IF NOT EXISTS idx_logs_owner_type_timestamp_ms ON logs(owner_id, type, timestamp_ms);");
+    executeNonQuery("DROP INDEX IF EXISTS idx_logs_timestamp_ms;");
+    executeNonQuery("DROP INDEX IF EXISTS idx_logs_type_timestamp_ms;");
+    executeNonQuery(
+        "CREATE INDEX IF NOT EXISTS idx_growth_snapshots_owner_timestamp_ms ON growth_snapshots(owner_id, timestamp_ms);");
+    executeNonQuery("DROP INDEX IF EXISTS idx_growth_snapshots_timestamp_ms;");
+
+    const auto rekey = [this, &legacyOwner](const std::string& table, const std::string& definition,
+                                            const std::string& columns) {
+        executeNonQuery("CREATE TABLE " + table + "_by_owner (" + definition + ") WITHOUT ROWID;");
+        executeNonQuery("INSERT INTO " + table + "_by_owner (owner_id, " + columns + ") SELECT " + legacyOwner + ", " +
+                        columns + " FROM " + table + ";");
+        executeNonQuery("DROP TABLE " + table + ";");
+        executeNonQuery("ALTER TABLE " + table + "_by_owner RENAME TO " + table + ";");
+    };
+    rekey("task_stats",
+          "owner_id INTEGER NOT NULL, day TEXT NOT NULL, type TEXT NOT NULL, completed INTEGER NOT NULL DEFAULT 0, "
+          "failed INTEGER NOT NULL DEFAULT 0, PRIMARY KEY (owner_id, day, type)",
+          "day, type, completed, failed");
+    rekey("log_daily_summaries",
+          "owner_id INTEGER NOT NULL, day TEXT NOT NULL, special_event TEXT NOT NULL, entry_count INTEGER NOT NULL, "
+          "level_change INTEGER NOT NULL, first_timestamp_ms INTEGER NOT NULL, last_timestamp_ms INTEGER NOT NULL, "
+          "PRIMARY KEY (owner_id, day, special_event)",
+          "day, special_event, entry_count, level_change, first_timestamp_ms, last_timestamp_ms");
+    rekey("growth_analytics_state",
+          "owner_id INTEGER PRIMARY KEY, last_sample_ms INTEGER NOT NULL, state BLOB NOT NULL",
+          "last_sample_ms, state");
+    rebuildGrowthRollups();
+
+    executeNonQuery("UPDATE app_state SET key = key || ':' || " + legacyOwner +
+                    " WHERE key IN ('tasks.daily_reset_day', 'tasks.weekly_reset_week');");
+}
+
+/**
+ * @brief 迁移 6：成就与库存改用整数外键引用 users(id)。
+ * 中文：owner/creator 文本列无法原地改为外键，按“新建 → 复制 → 删除 → 改名”重建两张表，
+ *       复制时按用户名连接 users 换成主键，已删除用户遗留的孤儿行在此一并丢弃；系统模板的创建者存为 NULL。
+ *       owner_id 声明 ON DELETE CASCADE，删除用户时成就与库存随之删除；库存的 item_id 不再声明外键，
+ *       商品下架删除后库存照常保留（aggregateInventoryByType 把这类库存的类型报告为空）。
+ *       迁移 5 以 ADD COLUMN 加入的 owner_id 无法补声明外键，改由 users 的删除触发器清理任务、日志、快照与派生表。
+ *       奇遇水位键的用户名后缀同样换成 users.id，先写入临时前缀再改名，避免数字用户名与主键互相覆盖。
+ */
+void DatabaseManager::applyUserForeignKeySchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string achievementColumns =
+        "name, description, icon_path, display_color, type, reward_type, progress_mode, progress_value, "
+        "progress_goal, reward_coins, attr_execution, attr_perseverance, attr_decision, attr_knowledge, attr_social, "
+        "attr_pride, reward_items, unlocked, completion_time, conditions, gallery_group, created_at, special_metadata";
+    executeNonQuery(
+        "CREATE TABLE achievements_by_user ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "owner_id INTEGER NOT NULL REFERENCES users(id) ON DELETE CASCADE,"
+        "creator_id INTEGER REFERENCES users(id) ON DELETE SET NULL,"
+        "name TEXT NOT NULL,"
+        "description TEXT NOT NULL,"
+        "icon_path TEXT NOT NULL,"
+        "display_color TEXT NOT NULL,"
+        "type TEXT NOT NULL,"
+        "reward_type TEXT NOT NULL,"
+        "progress_mode TEXT NOT NULL,"
+        "progress_value INTEGER NOT NULL DEFAULT 0,"
+        "progress_goal INTEGER NOT NULL DEFAULT 1,"
+        "reward_coins INTEGER NOT NULL DEFAULT 0,"
+        "attr_execution INTEGER NOT NULL DEFAULT 0,"
+        "attr_perseverance INTEGER NOT NULL DEFAULT 0,"
+        "attr_decision INTEGER NOT NULL DEFAULT 0,"
+        "attr_knowledge INTEGER NOT NULL DEFAULT 0,"
+        "attr_social INTEGER NOT NULL DEFAULT 0,"
+        "attr_pride INTEGER NOT NULL DEFAULT 0,"
+        "reward_items TEXT NOT NULL DEFAULT '',"
+        "unlocked INTEGER NOT NULL DEFAULT 0,"
+        "completion_time TEXT,"
+        "conditions BLOB NOT NULL,"
+        "gallery_group TEXT NOT NULL DEFAULT 'default',"
+        "created_at TEXT NOT NULL,"
+        "special_metadata TEXT NOT NULL DEFAULT '');");
+    // 中文：users 同样有 attr_* 列，连接时只暴露 id 与 username，避免列名歧义；查不到所属用户的孤儿行随之丢弃。
+    executeNonQuery("INSERT INTO achievements_by_user (id, owner_id, creator_id, " + achievementColumns +
+                    ") SELECT a.id, o.user_id, c.user_id, " + achievementColumns +
+                    " FROM achievements a JOIN (SELECT id AS user_id, username FROM users) o ON o.username = a.owner "
+                    "LEFT JOIN (SELECT id AS user_id, username FROM users) c ON c.username = a.creator;");
+    executeNonQuery("DROP TABLE achievements;");
+    executeNonQuery("ALTER TABLE achievements_by_user RENAME TO achievements;");
+    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_achievements_owner ON achievements(owner_id);");
+    // 中文：删除用户时外键检查按 creator_id 查找子行；系统模板占多数且为 NULL，部分索引只收录自定义成就。
+    executeNonQuery(
+        "CREATE INDEX IF NOT EXISTS idx_achievements_creator ON achievements(creator_id) "
+        "WHERE creator_id IS NOT NULL;");
+
+    const std::string inventoryColumns =
+        "item_id, quantity, used_quantity, status, purchase_time, expiration_time, lucky_payload, notes, "
+        "purchase_time_ms, expiration_time_ms";
+    executeNonQuery(
+        "CREATE TABLE user_inventory_by_user ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "owner_id INTEGER NOT NULL REFERENCES users(id) ON DELETE CASCADE,"
+        "item_id INTEGER NOT NULL,"
+        "quantity INTEGER NOT NULL,"
+        "used_quantity INTEGER NOT NULL DEFAULT 0,"
+        "status TEXT NOT NULL,"
+        "purchase_time TEXT NOT NULL,"
+        "expiration_time TEXT,"
+        "lucky_payload TEXT NOT NULL DEFAULT '{}',"
+        "notes TEXT NOT NULL DEFAULT '',"
+        "purchase_time_ms INTEGER,"
+        "expiration_time_ms INTEGER);");
+    executeNonQuery("INSERT INTO user_inventory_by_user (id, owner_id, " + inventoryColumns + ") SELECT i.id, o.user_id, " +
+                    inventoryColumns +
+                    " FROM user_inventory i JOIN (SELECT id AS user_id, username FROM users) o ON o.username = i.owner;");
+    executeNonQuery("DROP TABLE user_inventory;");
+    executeNonQuery("ALTER TABLE user_inventory_by_user RENAME TO user_inventory;");
+    executeNonQuery(
+        "CREATE INDEX IF NOT EXISTS idx_inventory_owner_item ON user_inventory(owner_id, item_id, quantity);");
+    executeNonQuery("CREATE INDEX IF NOT EXISTS idx_inventory_item ON user_inventory(item_id);");
+    executeNonQuery(
+        "CREATE INDEX IF NOT EXISTS idx_inventory_status_expiration_ms ON user_inventory(status, expiration_time_ms);");
+
+    std::string cascade =
+        "CREATE TRIGGER IF NOT EXISTS users_owned_rows_ad AFTER DELETE ON users BEGIN "
+        "DELETE FROM tasks WHERE owner_id = old.id; "
+        "DELETE FROM task_stats WHERE owner_id = old.id; "
+        "DELETE FROM logs WHERE owner_id = old.id; "
+        "DELETE FROM log_daily_summaries WHERE owner_id = old.id; "
+        "DELETE FROM growth_snapshots WHERE owner_id = old.id; "
+        "DELETE FROM growth_analytics_state WHERE owner_id = old.id; ";
+    for (const auto& tier : kGrowthRollupTiers) {
+        cascade += std::string("DELETE FROM ") + tier.table + " WHERE owner_id = old.id; ";
+    }
+    cascade += "DELETE FROM app_state WHERE key LIKE '%:' || old.id; END;";
+    executeNonQuery(cascade);
+
+    executeNonQuery(
+        "UPDATE app_state SET key = 'serendipity.login_day#' || "
+        "(SELECT id FROM users WHERE 'serendipity.login_day:' || username = app_state.key) "
+        "WHERE key IN (SELECT 'serendipity.login_day:' || username FROM users);");
+    executeNonQuery("DELETE FROM app_state WHERE key LIKE 'serendipity.login_day:%';");
+    executeNonQuery(
+        "UPDATE app_state SET key = 'serendipity.login_day:' || substr(key, length('serendipity.login_day#') + 1) "
+        "WHERE key LIKE 'serendipity.login_day#%';");
+}
+
+/**
+ * @brief 迁移 7：补充热点查询缺少的覆盖/复合索引。
+ * 中文：自定义奖励成就的月度计数原先经 idx_achievements_owner 定位后逐行回表检查类型与创建月份，
+ *       (owner_id, type, reward_type, created_at) 复合索引让等值条件与创建时间区间都落在索引上，计数无需回表；
+ *       库存列表按购买时间倒序返回，(owner_id, purchase_time_ms) 让排序沿索引完成，不再建临时 B 树。
+ *       限购计数已由 idx_inventory_owner_item(owner_id, item_id, quantity) 覆盖，快照区间查询由
+ *       idx_growth_snapshots_owner_timestamp_ms 与聚合表主键承担，这里不再重复建索引。
+ */
+void DatabaseManager::applyCoveringIndexSchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    executeNonQuery(
+        "CREATE INDEX IF NOT EXISTS idx_achievements_owner_type_created "
+        "ON achievements(owner_id, type, reward_type, created_at);");
+    executeNonQuery(
+        "CREATE INDEX IF NOT EXISTS idx_inventory_owner_purchase_ms ON user_inventory(owner_id, purchase_time_ms);");
+}
+
+/**
+ * @brief 迁移 8：自动日志改存模板编号与紧凑参数，文本在显示时渲染。
+ * 中文：新增 template_id 列；已有的任务完成、解锁成就、升级日志能按模板完整还原的改写为参数形式，
+ *       无法还原的（例如被手动修改过的文案）保持原文。旧版本的外部内容索引及其三个触发器直接读取 content，
+ *       改写后会索引到参数串，因此先删除，改写完成后按渲染文本重建无内容索引。
+ */
+void DatabaseManager::applyLogTemplateSchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    executeNonQuery("ALTER TABLE logs ADD COLUMN template_id INTEGER NOT NULL DEFAULT 0;");
+    executeNonQuery("DROP TRIGGER IF EXISTS logs_fts_ai;");
+    executeNonQuery("DROP TRIGGER IF EXISTS logs_fts_ad;");
+    executeNonQuery("DROP TRIGGER IF EXISTS logs_fts_au;");
+    executeNonQuery("DROP TABLE IF EXISTS logs_fts;");
+
+    struct LegacyTemplate {
+        const char* specialEvent;
+        LogTemplate logTemplate;
+    };
+    static constexpr LegacyTemplate kLegacyTemplates[] = {
+        {"TaskCompleted", LogTemplate::TaskCompleted},
+        {"AchievementUnlocked", LogTemplate::AchievementUnlocked},
+        {"LevelUp", LogTemplate::LevelUp},
+    };
+    auto update = prepareStatement("UPDATE logs SET template_id = ?, content = ? WHERE id = ?");
+    for (const auto& legacy : kLegacyTemplates) {
+        std::vector<std::pair<int, std::string>> converted;
+        {
+            auto select = prepareStatement("SELECT id, content FROM logs WHERE special_event = ? AND template_id = 0");
+            sqlite3_bind_text(select.get(), 1, legacy.specialEvent, -1, SQLITE_STATIC);
+            while (sqlite3_step(select.get()) == SQLITE_ROW) {
+                const auto* content = reinterpret_cast<const char*>(sqlite3_column_text(select.get(), 1));
+                auto args = matchLogTemplate(static_cast<int>(legacy.logTemplate), content == nullptr ? "" : content);
+                if (args.has_value()) {
+                    converted.emplace_back(sqlite3_column_int(select.get(), 0), std::move(*args));
+                }
+            }
+        }
+        for (const auto& [id, args] : converted) {
+            sqlite3_bind_int(update.get(), 1, static_cast<int>(legacy.logTemplate));
+            sqlite3_bind_text(update.get(), 2, args.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(update.get(), 3, id);
+            if (sqlite3_step(update.get()) != SQLITE_DONE) {
+                throw std::runtime_error(buildErrorMessage("Failed to convert legacy auto-log", m_db.get()));
+            }
+            sqlite3_reset(update.get());
+        }
+    }
+    ensureLogSearchIndex();
+}
+
+/**
+ * @brief 迁移 9：成长快照可打包为关键帧加差分的快照块。
+ * 中文：块表按 (owner_id, last_timestamp_ms) 建索引，区间查询定位首个与区间重叠的块后顺序读取；
+ *       迁移 6 的用户删除触发器不可修改，块表的清理由单独的触发器负责。
+ */
+void DatabaseManager::applySnapshotBlockSchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    executeNonQuery(
+        "CREATE TABLE IF NOT EXISTS growth_snapshot_blocks (\n"
+        "id INTEGER PRIMARY KEY,\n"
+        "owner_id INTEGER NOT NULL,\n"
+        "first_timestamp_ms INTEGER NOT NULL,\n"
+        "last_timestamp_ms INTEGER NOT NULL,\n"
+        "sample_count INTEGER NOT NULL,\n"
+        "payload BLOB NOT NULL);");
+    executeNonQuery(
+        "CREATE INDEX IF NOT EXISTS idx_growth_snapshot_blocks_owner_last "
+        "ON growth_snapshot_blocks(owner_id, last_timestamp_ms);");
+    executeNonQuery(
+        "CREATE TRIGGER IF NOT EXISTS growth_snapshot_blocks_owner_ad AFTER DELETE ON users BEGIN "
+        "DELETE FROM growth_snapshot_blocks WHERE owner_id = old.id; END;");
+}
+
+/**
+ * @brief 迁移 10：近期动态容量固定，每个用户整体保存为一个 BLOB，退出时覆盖写入一次。
+ */
+void DatabaseManager::applyActivityFeedSchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    executeNonQuery(
+        "CREATE TABLE IF NOT EXISTS activity_feed_state (\n"
+        "owner_id INTEGER PRIMARY KEY,\n"
+        "state BLOB NOT NULL) WITHOUT ROWID;");
+    executeNonQuery(
+        "CREATE TRIGGER IF NOT EXISTS activity_feed_state_owner_ad AFTER DELETE ON users BEGIN "
+        "DELETE FROM activity_feed_state WHERE owner_id = old.id; END;");
+}
+
+/**
+ * @brief 迁移 11：日历热力图的逐日聚合，以 (owner_id, day) 为主键，一年的数据是一段连续的主键区间。
+ * 中文：day 为本地日期的儒略日，写入时由 SQL 从毫秒时间戳换算，回填与增量使用同一换算，结果一致。
+ *       回填来源：完成次数取自 task_stats；成长值取自每日快照聚合相邻两日末值之差（含任务以外的来源，
+ *       与此后 UserManager 结算路径记录的口径相同）；手动日志按 timestamp_ms 计数，已压缩归档的日志不再计入。
+ */
+void DatabaseManager::applyDailyActivitySchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    executeNonQuery(
+        "CREATE TABLE IF NOT EXISTS daily_activity (\n"
+        "owner_id INTEGER NOT NULL,\n"
+        "day INTEGER NOT NULL,\n"
+        "completions INTEGER NOT NULL DEFAULT 0,\n"
+        "growth INTEGER NOT NULL DEFAULT 0,\n"
+        "logs INTEGER NOT NULL DEFAULT 0,\n"
+        "PRIMARY KEY (owner_id, day)) WITHOUT ROWID;");
+    executeNonQuery(
+        "CREATE TRIGGER IF NOT EXISTS daily_activity_owner_ad AFTER DELETE ON users BEGIN "
+        "DELETE FROM daily_activity WHERE owner_id = old.id; END;");
+    executeNonQuery(
+        "INSERT INTO daily_activity (owner_id, day, completions) "
+        "SELECT owner_id, CAST(julianday(day) + 0.5 AS INTEGER), SUM(completed) FROM task_stats "
+        "GROUP BY owner_id, day HAVING SUM(completed) > 0;");
+    executeNonQuery(
+        "INSERT INTO daily_activity (owner_id, day, growth) "
+        "SELECT owner_id, CAST(julianday(bucket_start) + 0.5 AS INTEGER), gained FROM ("
+        "SELECT owner_id, bucket_start, growth_points - COALESCE(LAG(growth_points) OVER "
+        "(PARTITION BY owner_id ORDER BY bucket_start), min_growth) AS gained FROM growth_snapshots_daily) "
+        "WHERE gained > 0 "
+        "ON CONFLICT(owner_id, day) DO UPDATE SET growth = excluded.growth;");
+    executeNonQuery(
+        "INSERT INTO daily_activity (owner_id, day, logs) "
+        "SELECT owner_id, CAST(julianday(timestamp_ms / 1000.0, 'unixepoch', 'localtime') + 0.5 AS INTEGER) "
+        "AS local_day, COUNT(1) FROM logs WHERE type = 'Manual' GROUP BY owner_id, local_day "
+        "ON CONFLICT(owner_id, day) DO UPDATE SET logs = excluded.logs;");
+}
+
+/**
+ * @brief 迁移 12：成长变化记录只追加、按 (owner_id, timestamp_ms) 区间读取。
+ * 中文：迁移前没有写回路径的变化量，回填只能依据日志：level_change 作为等级变化，attribute_changes 中
+ *       名称为属性英文键的条目累加为属性变化；成长值无法从日志还原，回填行的成长变化量为 0。
+ */
+void DatabaseManager::applyProgressionDeltaSchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    executeNonQuery(
+        "CREATE TABLE IF NOT EXISTS progression_deltas (\n"
+        "id INTEGER PRIMARY KEY,\n"
+        "owner_id INTEGER NOT NULL,\n"
+        "timestamp_ms INTEGER NOT NULL,\n"
+        "level_delta INTEGER NOT NULL DEFAULT 0,\n"
+        "growth_delta INTEGER NOT NULL DEFAULT 0,\n"
+        "attr_execution INTEGER NOT NULL DEFAULT 0,\n"
+        "attr_perseverance INTEGER NOT NULL DEFAULT 0,\n"
+        "attr_decision INTEGER NOT NULL DEFAULT 0,\n"
+        "attr_knowledge INTEGER NOT NULL DEFAULT 0,\n"
+        "attr_social INTEGER NOT NULL DEFAULT 0,\n"
+        "attr_pride INTEGER NOT NULL DEFAULT 0);");
+    executeNonQuery(
+        "CREATE INDEX IF NOT EXISTS idx_progression_deltas_owner_time "
+        "ON progression_deltas(owner_id, timestamp_ms);");
+    executeNonQuery(
+        "CREATE TRIGGER IF NOT EXISTS progression_deltas_owner_ad AFTER DELETE ON users BEGIN "
+        "DELETE FROM progression_deltas WHERE owner_id = old.id; END;");
+    executeNonQuery(
+        "INSERT INTO progression_deltas (owner_id, timestamp_ms, level_delta, attr_execution, attr_perseverance, "
+        "attr_decision, attr_knowledge, attr_social, attr_pride) "
+        "SELECT l.owner_id, l.timestamp_ms, l.level_change, "
+        "COALESCE(SUM(CASE c.name WHEN 'execution' THEN c.delta END), 0), "
+        "COALESCE(SUM(CASE c.name WHEN 'perseverance' THEN c.delta END), 0), "
+        "COALESCE(SUM(CASE c.name WHEN 'decision' THEN c.delta END), 0), "
+        "COALESCE(SUM(CASE c.name WHEN 'knowledge' THEN c.delta END), 0), "
+        "COALESCE(SUM(CASE c.name WHEN 'social' THEN c.delta END), 0), "
+        "COALESCE(SUM(CASE c.name WHEN 'pride' THEN c.delta END), 0) "
+        "FROM logs l LEFT JOIN (SELECT logs.id AS log_id, lower(json_extract(e.value, '$.name')) AS name, "
+        "CAST(json_extract(e.value, '$.delta') AS INTEGER) AS delta FROM logs, "
+        "json_each(CASE WHEN json_valid(logs.attribute_changes) THEN logs.attribute_changes ELSE '[]' END) e "
+        "WHERE e.type = 'object') c ON c.log_id = l.id "
+        "WHERE l.timestamp_ms > 0 GROUP BY l.id "
+        "HAVING l.level_change <> 0 OR COUNT(c.delta) > 0;");
+}
+
+/**
+ * @brief 迁移 13：学期任务的截止判定标记落盘。
+ * 中文：此前判定记录只在内存中，重启后仍未完成的过期任务会被再判定一次、重复计入失败统计；
+ *       标记以 task_id 为主键、随任务级联删除，删除任务或用户后不留残余。
+ */
+void DatabaseManager::applyTaskDeadlineFailureSchema() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    executeNonQuery(
+        "CREATE TABLE IF NOT EXISTS task_deadline_failures (\n"
+        "task_id INTEGER PRIMARY KEY REFERENCES tasks(id) ON DELETE CASCADE,\n"
+        "deadline_ms INTEGER NOT NULL) WITHOUT ROWID;");
+}
+
+std::optional<std::string> DatabaseManager::loadActivityFeed(int ownerId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectActivityFeedSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    const int rc = sqlite3_step(stmt.get());
+    if (rc == SQLITE_ROW) {
+        const auto* data = static_cast<const char*>(sqlite3_column_blob(stmt.get(), 0));
+        return std::string(data != nullptr ? data : "", static_cast<std::size_t>(sqlite3_column_bytes(stmt.get(), 0)));
+    }
+    if (rc == SQLITE_DONE) {
+        return std::nullopt;
+    }
+    throw std::runtime_error(buildErrorMessage("Failed to read activity feed", reader.handle()));
+}
+
+void DatabaseManager::saveActivityFeed(int ownerId, std::string_view state) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpsertActivityFeedSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    sqlite3_bind_blob(stmt.get(), 2, state.data(), static_cast<int>(state.size()), SQLITE_TRANSIENT);
+    if (!isSuccessCode(sqlite3_step(stmt.get()))) {
+        throw std::runtime_error(buildErrorMessage("Failed to write activity feed", m_db.get()));
+    }
+}
+
+std::optional<std::string> DatabaseManager::loadGrowthAnalyticsState(int ownerId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectGrowthAnalyticsSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    const int rc = sqlite3_step(stmt.get());
+    if (rc == SQLITE_ROW) {
+        const auto* data = static_cast<const char*>(sqlite3_column_blob(stmt.get(), 0));
+        return std::string(data != nullptr ? data : "", static_cast<std::size_t>(sqlite3_column_bytes(stmt.get(), 0)));
+    }
+    if (rc == SQLITE_DONE) {
+        return std::nullopt;
+    }
+    throw std::runtime_error(buildErrorMessage("Failed to read growth analytics state", reader.handle()));
+}
+
+void DatabaseManager::saveGrowthAnalyticsState(int ownerId, std::int64_t lastSampleMs, std::string_view state) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpsertGrowthAnalyticsSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    sqlite3_bind_int64(stmt.get(), 2, lastSampleMs);
+    sqlite3_bind_blob(stmt.get(), 3, state.data(), static_cast<int>(state.size()), SQLITE_TRANSIENT);
+    if (!isSuccessCode(sqlite3_step(stmt.get()))) {
+        throw std::runtime_error(buildErrorMessage("Failed to write growth analytics state", m_db.get()));
+    }
+}
+
+/**
+ * @brief 确保成长快照表存在，支撑时间轴可视化。
+ * 中文：存储等级、成长值与属性，方便绘制折线和雷达图。
+ */
+void DatabaseManager::ensureGrowthSnapshotTable() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "CREATE TABLE IF NOT EXISTS growth_snapshots (\n"
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,\n"
+        "timestamp TEXT NOT NULL,\n"
+        "user_level INTEGER NOT NULL,\n"
+        "growth_points INTEGER NOT NULL,\n"
+        "execution INTEGER NOT NULL,\n"
+        "perseverance INTEGER NOT NULL,\n"
+        "decision INTEGER NOT NULL,\n"
+        "knowledge INTEGER NOT NULL,\n"
+        "social INTEGER NOT NULL,\n"
+        "pride INTEGER NOT NULL,\n"
+        "achievement_count INTEGER NOT NULL,\n"
+        "completed_tasks INTEGER NOT NULL,\n"
+        "failed_tasks INTEGER NOT NULL,\n"
+        "manual_log_count INTEGER NOT NULL,\n"
+        "timestamp_ms INTEGER"
+        " );";
+    executeNonQuery(sql);
+    migrateEpochColumn("growth_snapshots", "timestamp", "timestamp_ms");
+    executeNonQuery(
+        "CREATE INDEX IF NOT EXISTS idx_growth_snapshots_timestamp_ms ON growth_snapshots(timestamp_ms);");
+    executeNonQuery("DROP INDEX IF EXISTS idx_growth_snapshots_timestamp;");
+    // 中文：小时/天/周聚合表按用户分区，由迁移 5 的 rebuildGrowthRollups 建立并回填。
+}
+
+/**
+ * @brief 按用户重建小时/天/周聚合表，并用既有快照一次性回填；调用方负责事务。
+ * 中文：每桶保存末值与成长值极值；以 (owner_id, 桶起点) 为主键的 WITHOUT ROWID 表天然按用户、按时间有序。
+ *       旧版以桶起点为主键的聚合表无法原地加入用户列，整表丢弃后从原始快照重算，结果与逐条写入一致。
+ */
+void DatabaseManager::rebuildGrowthRollups() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    std::string columns;
+    for (const char* column : kSnapshotValueColumns) {
+        columns += column;
+        columns += " INTEGER NOT NULL,\n";
+    }
+    for (const auto& tier : kGrowthRollupTiers) {
+        executeNonQuery(std::string("DROP TABLE IF EXISTS ") + tier.table + ";");
+        executeNonQuery(std::string("CREATE TABLE ") + tier.table +
+                        " (\nowner_id INTEGER NOT NULL,\nbucket_start TEXT NOT NULL,\nsample_count INTEGER NOT NULL,\n"
+                        "last_timestamp TEXT NOT NULL,\n" +
+                        columns +
+                        "min_growth INTEGER NOT NULL,\nmax_growth INTEGER NOT NULL,\nlast_timestamp_ms INTEGER,\n"
+                        "PRIMARY KEY (owner_id, bucket_start)) WITHOUT ROWID;");
+    }
+    auto scan = prepareStatement(
+        "SELECT id, timestamp, user_level, growth_points, execution, perseverance, decision, knowledge, "
+        "social, pride, achievement_count, completed_tasks, failed_tasks, manual_log_count, timestamp_ms, owner_id "
+        "FROM growth_snapshots WHERE timestamp_ms IS NOT NULL ORDER BY owner_id ASC, timestamp_ms ASC, id ASC");
+    while (true) {
+        int rc = sqlite3_step(scan.get());
+        if (rc == SQLITE_ROW) {
+            GrowthSnapshotRecord record = readGrowthSnapshotRecord(scan.get());
+            record.ownerId = sqlite3_column_int(scan.get(), 15);
+            upsertGrowthRollups(record, record.timestampMs);
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to backfill growth rollups", m_db.get()));
+    }
+}
+
+/**
+ * @brief 将一条快照并入全部聚合表。
+ * 中文：调用方负责事务；每个层级一条 UPSERT，语句文本只构建一次；桶内先后按 timestampMs 判定。
+ */
+void DatabaseManager::upsertGrowthRollups(const GrowthSnapshotRecord& record, std::int64_t timestampMs) {
+    static const std::vector<std::string> upserts = [] {
+        std::vector<std::string> sql;
+        for (const auto& tier : kGrowthRollupTiers) {
+            sql.push_back(buildRollupUpsertSql(tier));
+        }
+        return sql;
+    }();
+    for (const auto& sql : upserts) {
+        auto stmt = prepareStatement(sql);
+        sqlite3_bind_text(stmt.get(), 1, record.timestampIso.c_str(), -1, SQLITE_TRANSIENT);
+        bindSnapshotValues(stmt.get(), 2, record);
+        sqlite3_bind_int64(stmt.get(), 14, static_cast<sqlite3_int64>(timestampMs));
+        sqlite3_bind_int(stmt.get(), 15, record.ownerId);
+        int rc = sqlite3_step(stmt.get());
+        if (rc != SQLITE_DONE) {
+            throw std::runtime_error(buildErrorMessage("Failed to update growth rollup", m_db.get()));
+        }
+    }
+}
+
+/**
+ * @brief 预置教学示例用的任务列表，避免界面空白。
+ * 中文：应用首次启动时插入日常、周常、学期与自定义任务各一批，便于老师演示奖励与进度逻辑。
+ */
+void DatabaseManager::seedDefaultTasks() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+
+    const std::string countSql = "SELECT COUNT(1) FROM tasks";
+    auto countStmt = prepareStatement(countSql);
+    int rc = sqlite3_step(countStmt.get());
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to count tasks", m_db.get()));
+    }
+    if (sqlite3_column_int(countStmt.get(), 0) > 0) {
+        return;  // 已有任务则不重复插入。
+    }
+
+    struct TaskSeed {
+        std::string name;
+        std::string description;
+        Task::TaskType type;
+        int difficulty = 1;
+        int deadlineOffsetDays = 1;
+        int coins = 0;
+        int growth = 0;
+        User::AttributeSet attributeReward;
+        int forgiveness = 0;
+        int progressGoal = 1;
+    };
+
+    const std::vector<TaskSeed> seeds = {
+        {"晨读 30 分钟", "在图书馆完成一段英文原版阅读，提升自律。", Task::TaskType::Daily, 2, 1, 20, 15,
+         User::AttributeSet{1, 0, 0, 2, 0, 0}, 0, 1},
+        {"操场跑 3 公里", "保持锻炼习惯，完成基础耐力训练。", Task::TaskType::Daily, 3, 1, 25, 18,
+         User::AttributeSet{1, 1, 0, 0, 0, 0}, 0, 1},
+        {"周项目研讨", "与小组讨论课程项目方案，提交会议纪要。", Task::TaskType::Weekly, 3, 7, 80, 60,
+         User::AttributeSet{0, 1, 1, 2, 2, 0}, 1, 1},
+        {"学期科研训练", "在导师指导下完成一次小型实验并整理报告。", Task::TaskType::Semester, 4, 90, 200, 180,
+         User::AttributeSet{1, 2, 1, 3, 1, 1}, 2, 1},
+        {"自定义兴趣练习", "记录一次社团活动或个人兴趣练习。", Task::TaskType::Custom, 1, 14, 30, 25,
+         User::AttributeSet{0, 1, 0, 1, 1, 0}, 0, 100}};
+
+    const std::string insertSql =
+        "INSERT INTO tasks (name, description, type, difficulty, deadline, completed, coin_reward, growth_reward, "
+        "attr_execution, attr_perseverance, attr_decision, attr_knowledge, attr_social, attr_pride, "
+        "bonus_streak, custom_settings, forgiveness_coupons, progress_value, progress_goal, deadline_ms) "
+        "VALUES (?, ?, ?, ?, ?, 0, ?, ?, ?, ?, ?, ?, ?, ?, 0, '{}', ?, 0, ?, ?)";
+
+    auto insertStmt = prepareStatement(insertSql);
+    for (const auto& seed : seeds) {
+        sqlite3_reset(insertStmt.get());
+        const std::string deadlineIso =
+            QDateTime::currentDateTimeUtc().addDays(seed.deadlineOffsetDays).toString(Qt::ISODate).toStdString();
+        sqlite3_bind_text(insertStmt.get(), 1, seed.name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertStmt.get(), 2, seed.description.c_str(), -1, SQLITE_TRANSIENT);
+        const std::string typeText = Task::typeToString(seed.type);
+        sqlite3_bind_text(insertStmt.get(), 3, typeText.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(insertStmt.get(), 4, seed.difficulty);
+        sqlite3_bind_text(insertStmt.get(), 5, deadlineIso.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(insertStmt.get(), 6, seed.coins);
+        sqlite3_bind_int(insertStmt.get(), 7, seed.growth);
+        const int next = bindAttributeSet(insertStmt.get(), 8, seed.attributeReward);
+        sqlite3_bind_int(insertStmt.get(), next, seed.forgiveness);
+        sqlite3_bind_int(insertStmt.get(), next + 1, seed.progressGoal);
+        bindEpochMs(insertStmt.get(), next + 2, deadlineIso);
+        rc = sqlite3_step(insertStmt.get());
+        if (!isSuccessCode(rc)) {
+            throw std::runtime_error(buildErrorMessage("Failed to seed default tasks", m_db.get()));
+        }
+    }
+}
+
+/**
+ * @brief 预置成就，确保画廊与奖励系统开箱即用。
+ * 中文：仅当当前用户没有任何成就记录时插入系统模板，避免重复。
+ */
+void DatabaseManager::seedDefaultAchievements() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+
+    const std::string owner = kPreconfiguredUsername;
+    const std::string countSql = "SELECT COUNT(1) FROM achievements WHERE owner = ?";
+    auto countStmt = prepareStatement(countSql);
+    sqlite3_bind_text(countStmt.get(), 1, owner.c_str(), -1, SQLITE_TRANSIENT);
+    int rc = sqlite3_step(countStmt.get());
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to count achievements", m_db.get()));
+    }
+    if (sqlite3_column_int(countStmt.get(), 0) > 0) {
+        return;
+    }
+
+    auto serializeItemsCompact = [](const std::vector<std::string>& items) {
+        std::ostringstream stream;
+        bool first = true;
+        for (const auto& item : items) {
+            if (!first) {
+                stream << '|';
+            }
+            first = false;
+            stream << item;
+        }
+        return stream.str();
+    };
+
+    struct AchievementSeed {
+        std::string name;
+        std::string description;
+        std::string iconPath;
+        std::string color;
+        Achievement::Type type = Achievement::Type::System;
+        Achievement::RewardType rewardType = Achievement::RewardType::WithReward;
+        Achievement::ProgressMode progressMode = Achievement::ProgressMode::Milestone;
+        std::vector<Achievement::Condition> conditions;
+        int rewardCoins = 0;
+        User::AttributeSet rewardAttributes;
+        std::vector<std::string> rewardItems;
+        std::string galleryGroup;
+    };
+
+    std::vector<AchievementSeed> seeds;
+
+    Achievement::Condition levelCond;
+    levelCond.type = Achievement::Condition::ConditionType::ReachLevel;
+    levelCond.targetValue = 3;
+    seeds.push_back({"初入兰大",
+                    "首次达到 3 级，证明已融入校园节奏",
+                    ":/icons/rookie.png",
+                    "#4CAF50",
+                    Achievement::Type::System,
+                    Achievement::RewardType::WithReward,
+                    Achievement::ProgressMode::Milestone,
+                    {levelCond},
+                    50,
+                    User::AttributeSet{0, 0, 0, 0, 0, 2},
+                    {},
+                    "新生礼遇"});
+
+    Achievement::Condition prideCond;
+    prideCond.type = Achievement::Condition::ConditionType::ReachPride;
+    prideCond.targetValue = 20;
+    seeds.push_back({"西北自豪",
+                    "自豪感达到 20，成为兰大形象大使",
+                    ":/icons/pride.png",
+                    "#FFC107",
+                    Achievement::Type::System,
+                    Achievement::RewardType::WithReward,
+                    Achievement::ProgressMode::Incremental,
+                    {prideCond},
+                    80,
+                    User::AttributeSet{0, 0, 0, 0, 0, 5},
+                    {"校史徽章"},
+                    "精神成长"});
+
+    Achievement::Condition weeklyCond;
+    weeklyCond.type = Achievement::Condition::ConditionType::CompleteTaskType;
+    weeklyCond.targetValue = 5;
+    weeklyCond.metadata = Task::typeToString(Task::TaskType::Weekly);
+    seeds.push_back({"周计划达人",
+                    "完成 5 个周任务",
+                    ":/icons/weekly.png",
+                    "#9C27B0",
+                    Achievement::Type::System,
+                    Achievement::RewardType::WithReward,
+                    Achievement::ProgressMode::Incremental,
+                    {weeklyCond},
+                    40,
+                    User::AttributeSet{1, 0, 0, 0, 0, 1},
+                    {},
+                    "勤奋实践"});
+
+    const std::string insertSql =
+        "INSERT INTO achievements (owner, creator, name, description, icon_path, display_color, type, reward_type, "
+        "progress_mode, progress_value, progress_goal, reward_coins, attr_execution, attr_perseverance, "
+        "attr_decision, attr_knowledge, attr_social, attr_pride, reward_items, unlocked, "
+        "completion_time, conditions, gallery_group, created_at, special_metadata) "
+        "VALUES (?, 'system', ?, ?, ?, ?, ?, ?, ?, 0, ?, ?, ?, ?, ?, ?, ?, ?, ?, 0, '', ?, ?, ?, '')";
+
+    const auto createdAt = QDateTime::currentDateTimeUtc().toString(Qt::ISODate).toStdString();
+    auto insertStmt = prepareStatement(insertSql);
+    for (const auto& seed : seeds) {
+        sqlite3_reset(insertStmt.get());
+        sqlite3_bind_text(insertStmt.get(), 1, owner.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertStmt.get(), 2, seed.name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertStmt.get(), 3, seed.description.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertStmt.get(), 4, seed.iconPath.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertStmt.get(), 5, seed.color.c_str(), -1, SQLITE_TRANSIENT);
+        const std::string typeText = seed.type == Achievement::Type::System ? "System" : "Custom";
+        sqlite3_bind_text(insertStmt.get(), 6, typeText.c_str(), -1, SQLITE_TRANSIENT);
+        const std::string rewardText =
+            seed.rewardType == Achievement::RewardType::WithReward ? "WithReward" : "NoReward";
+        sqlite3_bind_text(insertStmt.get(), 7, rewardText.c_str(), -1, SQLITE_TRANSIENT);
+        const std::string modeText = seed.progressMode == Achievement::ProgressMode::Incremental ? "Incremental"
+                                                                                              : "Milestone";
+        sqlite3_bind_text(insertStmt.get(), 8, modeText.c_str(), -1, SQLITE_TRANSIENT);
+        const int progressGoal = std::max(1, static_cast<int>(seed.conditions.size()) == 1
+                                                 ? seed.conditions.front().targetValue
+                                                 : std::accumulate(seed.conditions.begin(),
+                                                                   seed.conditions.end(),
+                                                                   0,
+                                                                   [](int acc, const Achievement::Condition& cond) {
+                                                                       return acc + cond.targetValue;
+                                                                   }));
+        sqlite3_bind_int(insertStmt.get(), 9, progressGoal);
+        sqlite3_bind_int(insertStmt.get(), 10, seed.rewardCoins);
+        bindAttributeSet(insertStmt.get(), 11, seed.rewardAttributes);
+        const std::string itemsText = serializeItemsCompact(seed.rewardItems);
+        sqlite3_bind_text(insertStmt.get(), 17, itemsText.c_str(), -1, SQLITE_TRANSIENT);
+        const std::string conditionBytes = codec::encodeConditions(seed.conditions);
+        sqlite3_bind_blob(insertStmt.get(), 18, conditionBytes.data(), static_cast<int>(conditionBytes.size()),
+                          SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertStmt.get(), 19, seed.galleryGroup.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(insertStmt.get(), 20, createdAt.c_str(), -1, SQLITE_TRANSIENT);
+
+        rc = sqlite3_step(insertStmt.get());
+        if (!isSuccessCode(rc)) {
+            throw std::runtime_error(buildErrorMessage("Failed to seed achievements", m_db.get()));
+        }
+    }
+}
+
+/**
+ * @brief 预置商城商品，方便学生体验购买与道具效果。
+ * 中文：插入物理商品、增益道具与幸运包三类示例，覆盖 ShopManager 的主要分支逻辑。
+ */
+void DatabaseManager::seedDefaultShopItems() {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+
+    const std::string countSql = "SELECT COUNT(1) FROM shop_items";
+    auto countStmt = prepareStatement(countSql);
+    int rc = sqlite3_step(countStmt.get());
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to count shop items", m_db.get()));
+    }
+    if (sqlite3_column_int(countStmt.get(), 0) > 0) {
+        return;
+    }
+
+    std::vector<ShopItem> seeds;
+
+    ShopItem merch;
+    merch.setName("校园周边礼包");
+    merch.setDescription("校徽 + 帆布袋套装，线下兑换纪念校园生活。");
+    merch.setIconPath(":/icons/merch.png");
+    merch.setItemType(ShopItem::ItemType::Physical);
+    merch.setPriceCoins(80);
+    merch.setPurchaseLimit(1);
+    merch.setAvailable(true);
+    merch.setPhysicalRedeemMethod("持购买截图到辅导员处登记领取");
+    merch.setPhysicalNotes("兑换时需核验学生证，仅限本人领取。");
+    seeds.push_back(merch);
+
+    ShopItem restCard;
+    restCard.setName("自习室休息日卡");
+    restCard.setDescription("为自己安排一天减压假，任务失败不计入连胜中断。");
+    restCard.setIconPath(":/icons/rest.png");
+    restCard.setItemType(ShopItem::ItemType::Prop);
+    restCard.setPriceCoins(30);
+    restCard.setPurchaseLimit(2);
+    restCard.setAvailable(true);
+    restCard.setPropEffectType(ShopItem::PropEffectType::RestDay);
+    restCard.setEffectDurationMinutes(1440);
+    restCard.setEffectDescription("使用后 24 小时内的单次任务失败将被忽略。");
+    restCard.setUsageConditions("当周有效，避免与宽恕券叠加使用。");
+    seeds.push_back(restCard);
+
+    ShopItem luckyBag;
+    luckyBag.setName("兰大幸运盲盒");
+    luckyBag.setDescription("随机掉落兰大币、成长值或额外道具，增添惊喜。");
+    luckyBag.setIconPath(":/icons/lucky.png");
+    luckyBag.setItemType(ShopItem::ItemType::LuckyBag);
+    luckyBag.setPriceCoins(45);
+    luckyBag.setPurchaseLimit(0);
+    luckyBag.setAvailable(true);
+    luckyBag.setLevelRequirement(1);
+    std::vector<ShopItem::LuckyBagReward> rewards;
+    ShopItem::LuckyBagReward rewardCoins;
+    rewardCoins.type = ShopItem::LuckyBagReward::RewardType::Coins;
+    rewardCoins.amount = 120;
+    rewardCoins.probability = 0.3;
+    rewardCoins.description = "120 兰大币";
+    rewards.push_back(rewardCoins);
+
+    ShopItem::LuckyBagReward rewardGrowth;
+    rewardGrowth.type = ShopItem::LuckyBagReward::RewardType::Growth;
+    rewardGrowth.amount = 40;
+    rewardGrowth.probability = 0.2;
+    rewardGrowth.description = "成长值 +40";
+    rewards.push_back(rewardGrowth);
+
+    ShopItem::LuckyBagReward rewardCoupon;
+    rewardCoupon.type = ShopItem::LuckyBagReward::RewardType::ShopItem;
+    rewardCoupon.referenceItemId = -1;
+    rewardCoupon.amount = 1;
+    rewardCoupon.probability = 0.5;
+    rewardCoupon.description = "额外获取一张自习室休息日卡";
+    rewards.push_back(rewardCoupon);
+    luckyBag.setLuckyRewards(rewards);
+    seeds.push_back(luckyBag);
+
+    for (auto& item : seeds) {
+        rc = insertShopItem(item.toRecord());
+        if (rc < 0) {
+            throw std::runtime_error(buildErrorMessage("Failed to seed shop items", m_db.get()));
+        }
+    }
+}
+
+/**
+ * @brief Validate credentials specifically against the preconfigured "x"/"1" account.
+ * 中文：专门验证预置的用户名 "x" 与密码 "1"。
+ *
+ * Business logic: teacher demo requires this credential; centralizing validation avoids hard-coded copies.
+ * 中文：教师演示只认该账号，集中校验可避免多处硬编码导致维护困难。
+ *
+ * @param username Supplied username. 中文：输入的用户名。
+ * @param password Supplied password. 中文：输入的密码。
+ * @return true if credentials match stored row. 中文：匹配成功返回 true。
+ * @throws std::runtime_error When SQLite query fails. 中文：查询失败时抛出异常。
+ */
+bool DatabaseManager::validatePreconfiguredAccount(const std::string& username,
+                                                    const std::string& password) const {
+    auto reader = acquireReader();
+    if (username != kPreconfiguredUsername || password != kPreconfiguredPassword) {
+        return false;
+    }
+
+    auto stmt = reader.prepare(kValidateAccountSql);
+    sqlite3_bind_text(stmt.get(), 1, username.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 2, password.c_str(), -1, SQLITE_TRANSIENT);
+
+    int rc = sqlite3_step(stmt.get());
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to validate preconfigured account", reader.handle()));
+    }
+    return sqlite3_column_int(stmt.get(), 0) > 0;
+}
+
+/**
+ * @brief Insert a new user record and return the generated row id.
+ * 中文：插入新的用户记录，并返回 SQLite 生成的行号。
+ *
+ * Business logic: returning the row id helps subsequent modules (inventory, quests) link foreign keys.
+ * 中文：返回行号可让任务、背包等模块建立外键关联。
+ *
+ * @param user User data to store (id ignored). 中文：要保存的用户数据（忽略 id）。
+ * @return Generated row id. 中文：生成的行号。
+ * @throws std::runtime_error When insert fails. 中文：插入失败抛出异常。
+ */
+int DatabaseManager::createUser(const UserRecord& user) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "INSERT INTO users (username, password, level, currency, attributes, attr_execution, attr_perseverance, "
+        "attr_decision, attr_knowledge, attr_social, attr_pride) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+    auto stmt = prepareStatement(sql);
+    sqlite3_bind_text(stmt.get(), 1, user.username.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 2, user.password.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 3, user.level);
+    sqlite3_bind_int(stmt.get(), 4, user.currency);
+    sqlite3_bind_text(stmt.get(), 5, user.attributes.c_str(), -1, SQLITE_TRANSIENT);
+    bindAttributeSet(stmt.get(), 6, user.attributeSet);
+
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to create user", m_db.get()));
+    }
+    return static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+}
+
+/**
+ * @brief Retrieve a user row by username.
+ * 中文：根据用户名查询用户记录。
+ *
+ * Business logic: optional return type clearly communicates the possibility of a missing user.
+ * 中文：使用 std::optional 可明确表达“可能不存在”的语义。
+ *
+ * @param username Target username. 中文：目标用户名。
+ * @return Optional user record. 中文：若找到则返回用户记录，否则 std::nullopt。
+ * @throws std::runtime_error When SQLite reports an error. 中文：查询出错时抛出异常。
+ */
+std::optional<DatabaseManager::UserRecord> DatabaseManager::getUserByName(
+    const std::string& username) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectUserByNameSql);
+    sqlite3_bind_text(stmt.get(), 1, username.c_str(), -1, SQLITE_TRANSIENT);
+
+    int rc = sqlite3_step(stmt.get());
+    if (rc == SQLITE_ROW) {
+        UserRecord record;
+        record.id = sqlite3_column_int(stmt.get(), 0);
+        record.username = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 1));
+        record.password = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 2));
+        record.level = sqlite3_column_int(stmt.get(), 3);
+        record.currency = sqlite3_column_int(stmt.get(), 4);
+        record.attributes = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 5));
+        record.attributeSet = readAttributeSet(stmt.get(), 6);
+        return record;
+    }
+    if (rc == SQLITE_DONE) {
+        return std::nullopt;
+    }
+    throw std::runtime_error(buildErrorMessage("Failed to query user", reader.handle()));
+}
+
+/**
+ * @brief Resolve a username to its primary key.
+ * 中文：按用户名查询主键，命中 username 唯一索引，不读取其余列。
+ *
+ * @param username Target username. 中文：目标用户名。
+ * @return users.id if found. 中文：找到时返回主键，否则 std::nullopt。
+ * @throws std::runtime_error When SQLite reports an error. 中文：查询出错时抛出异常。
+ */
+std::optional<int> DatabaseManager::getUserIdByName(const std::string& username) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectUserIdByNameSql);
+    sqlite3_bind_text(stmt.get(), 1, username.c_str(), -1, SQLITE_TRANSIENT);
+    int rc = sqlite3_step(stmt.get());
+    if (rc == SQLITE_ROW) {
+        return sqlite3_column_int(stmt.get(), 0);
+    }
+    if (rc == SQLITE_DONE) {
+        return std::nullopt;
+    }
+    throw std::runtime_error(buildErrorMessage("Failed to query user id", reader.handle()));
+}
+
+/**
+ * @brief Update the level column for a user.
+ * 中文：更新指定用户的等级字段。
+ *
+ * Business logic: splitting updates by field keeps UI actions granular and simple to audit in logs.
+ * 中文：按字段拆分更新，便于界面精细控制并在日志中记录操作。
+ *
+ * @param userId Target users.id. 中文：目标用户主键。
+ * @param newLevel Desired level. 中文：新等级。
+ * @return true if a row changed. 中文：若有行被更新返回 true。
+ * @throws std::runtime_error When SQLite update fails. 中文：更新失败抛出异常。
+ */
+bool DatabaseManager::updateUserLevel(int userId, int newLevel) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpdateUserLevelSql);
+    sqlite3_bind_int(stmt.get(), 1, newLevel);
+    sqlite3_bind_int(stmt.get(), 2, userId);
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to update user level", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+/**
+ * @brief Update the currency column for a user.
+ * 中文：更新指定用户的货币字段。
+ *
+ * Business logic: isolating currency updates simplifies implementing economic audits later.
+ * 中文：单独的货币更新接口便于未来实现经济系统审计。
+ *
+ * @param userId Target users.id. 中文：目标用户主键。
+ * @param newCurrency Desired currency. 中文：新的货币值。
+ * @return true if a row changed. 中文：若有记录被更新返回 true。
+ * @throws std::runtime_error When update fails. 中文：更新失败抛出异常。
+ */
+bool DatabaseManager::updateUserCurrency(int userId, int newCurrency) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpdateUserCurrencySql);
+    sqlite3_bind_int(stmt.get(), 1, newCurrency);
+    sqlite3_bind_int(stmt.get(), 2, userId);
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to update user currency", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+/**
+ * @brief Update attribute columns and serialized stats for a user.
+ * 中文：更新用户的六维属性列与序列化统计数据。
+ *
+ * Business logic: the six attributes live in integer columns so they can be aggregated in SQL; growth and
+ * progress counters stay in the flexible key=value text. 中文：六维属性存为整数列，便于 SQL 聚合；
+ * 成长值与统计计数仍保存在键值文本中，便于灵活扩展。
+ *
+ * @param userId Target users.id. 中文：目标用户主键。
+ * @param attributes Six attribute values. 中文：六维属性。
+ * @param newStats Serialized growth/progress stats. 中文：新的统计键值串。
+ * @return true if a row changed. 中文：若有行被更新返回 true。
+ * @throws std::runtime_error When update fails. 中文：更新失败抛出异常。
+ */
+bool DatabaseManager::updateUserAttributes(int userId,
+                                           const User::AttributeSet& attributes,
+                                           const std::string& newStats) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpdateUserAttributesSql);
+    sqlite3_bind_text(stmt.get(), 1, newStats.c_str(), -1, SQLITE_TRANSIENT);
+    const int next = bindAttributeSet(stmt.get(), 2, attributes);
+    sqlite3_bind_int(stmt.get(), next, userId);
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to update user attributes", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+/**
+ * @brief Upsert a user row, updating only the requested columns on conflict.
+ * 中文：以单条 INSERT ... ON CONFLICT DO UPDATE 写入用户，替代“事务 + 三条 UPDATE”。
+ *
+ * Business logic: every task completion and purchase saves the user; writing only the dirty columns keeps the
+ * row rewrite small. The conflict target is the integer primary key; a record without an id is inserted.
+ * 中文：任务完成与购买都会保存用户，只写变化的列可减少写入量；冲突判定走整数主键，id 无效的记录按新用户插入。
+ *
+ * @param record Full user state. 中文：完整用户数据。
+ * @param columns UserColumn bitmask. 中文：列掩码。
+ * @return true if a row was inserted or changed. 中文：有行被插入或更新时返回 true。
+ * @throws std::runtime_error When the statement fails. 中文：执行失败抛出异常。
+ */
+bool DatabaseManager::updateUser(const UserRecord& record, std::uint32_t columns) {
+    if ((columns & UserAllColumns) == 0) {
+        return false;
+    }
+    std::string assignments;
+    auto assign = [&assignments](const char* column) {
+        if (!assignments.empty()) {
+            assignments += ", ";
+        }
+        assignments += column;
+        assignments += " = excluded.";
+        assignments += column;
+    };
+    if ((columns & UserLevelColumn) != 0) {
+        assign("level");
+    }
+    if ((columns & UserCurrencyColumn) != 0) {
+        assign("currency");
+    }
+    if ((columns & UserStatsColumn) != 0) {
+        assign("attributes");
+    }
+    if ((columns & UserAttributeColumns) != 0) {
+        for (const char* column : kAttributeColumns) {
+            assign(column);
+        }
+    }
+
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "INSERT INTO users (id, username, password, level, currency, attributes, attr_execution, "
+        "attr_perseverance, attr_decision, attr_knowledge, attr_social, attr_pride) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) ON CONFLICT(id) DO UPDATE SET " + assignments;
+    auto stmt = prepareStatement(sql);
+    bindUserReference(stmt.get(), 1, record.id);
+    sqlite3_bind_text(stmt.get(), 2, record.username.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 3, record.password.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 4, record.level);
+    sqlite3_bind_int(stmt.get(), 5, record.currency);
+    sqlite3_bind_text(stmt.get(), 6, record.attributes.c_str(), -1, SQLITE_TRANSIENT);
+    bindAttributeSet(stmt.get(), 7, record.attributeSet);
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to upsert user", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+/**
+ * @brief Delete a user row by id together with everything the user owns.
+ * 中文：按主键删除用户记录，连同其名下的全部数据。
+ *
+ * Business logic: this helper allows the admin UI to reset test data quickly without writing SQL manually.
+ * Achievements and inventory follow through ON DELETE CASCADE; tasks, logs and growth data through the
+ * users_owned_rows_ad trigger, so no orphan rows are left for later queries to skip.
+ * 中文：该接口让管理界面可以快速清理测试数据，无需手写 SQL；成就与库存经外键级联删除，
+ *       任务、日志与成长数据由 users_owned_rows_ad 触发器清理，不再遗留孤儿行。
+ *
+ * @param userId Target users.id. 中文：目标用户主键。
+ * @return true if a row was removed. 中文：若删除了一行返回 true。
+ * @throws std::runtime_error When delete fails. 中文：删除失败抛出异常。
+ */
+bool DatabaseManager::deleteUser(int userId) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kDeleteUserSql);
+    sqlite3_bind_int(stmt.get(), 1, userId);
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to delete user", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+/**
+ * @brief 将 TaskRecord 插入数据库并返回行号。
+ * 中文：任务创建流程统一走此接口，便于在 UI 中调用后得到主键用于后续编辑。
+ */
+int DatabaseManager::createTask(const TaskRecord& task) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "INSERT INTO tasks (name, description, type, difficulty, deadline, completed, coin_reward, "
+        "growth_reward, attr_execution, attr_perseverance, attr_decision, attr_knowledge, attr_social, "
+        "attr_pride, bonus_streak, custom_settings, forgiveness_coupons, progress_value, progress_goal, "
+        "deadline_ms, owner_id) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+    auto stmt = prepareStatement(sql);
+    sqlite3_bind_text(stmt.get(), 1, task.name.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 2, task.description.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 3, task.type.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 4, task.difficulty);
+    sqlite3_bind_text(stmt.get(), 5, task.deadlineIso.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 6, task.completed ? 1 : 0);
+    sqlite3_bind_int(stmt.get(), 7, task.coinReward);
+    sqlite3_bind_int(stmt.get(), 8, task.growthReward);
+    bindAttributeSet(stmt.get(), 9, task.attributeReward);
+    sqlite3_bind_int(stmt.get(), 15, task.bonusStreak);
+    sqlite3_bind_text(stmt.get(), 16, task.customSettings.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 17, task.forgivenessCoupons);
+    sqlite3_bind_int(stmt.get(), 18, task.progressValue);
+    sqlite3_bind_int(stmt.get(), 19, task.progressGoal);
+    bindEpochMs(stmt.get(), 20, task.deadlineIso);
+    sqlite3_bind_int(stmt.get(), 21, task.ownerId);
+
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to insert task", m_db.get()));
+    }
+    return static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+}
+
+int DatabaseManager::createAchievement(const AchievementRecord& record) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "INSERT INTO achievements (owner_id, creator_id, name, description, icon_path, display_color, type, "
+        "reward_type, progress_mode, progress_value, progress_goal, reward_coins, attr_execution, "
+        "attr_perseverance, attr_decision, attr_knowledge, attr_social, attr_pride, reward_items, unlocked, "
+        "completion_time, conditions, gallery_group, created_at, special_metadata) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+    auto stmt = prepareStatement(sql);
+    bindUserReference(stmt.get(), 1, record.ownerId);
+    bindUserReference(stmt.get(), 2, record.creatorId);
+    sqlite3_bind_text(stmt.get(), 3, record.name.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 4, record.description.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 5, record.iconPath.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 6, record.color.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 7, record.type.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 8, record.rewardType.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 9, record.progressMode.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 10, record.progressValue);
+    sqlite3_bind_int(stmt.get(), 11, record.progressGoal);
+    sqlite3_bind_int(stmt.get(), 12, record.rewardCoins);
+    bindAttributeSet(stmt.get(), 13, record.rewardAttributes);
+    sqlite3_bind_text(stmt.get(), 19, record.rewardItems.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 20, record.unlocked ? 1 : 0);
+    if (record.completionTime.empty()) {
+        sqlite3_bind_null(stmt.get(), 21);
+    } else {
+        sqlite3_bind_text(stmt.get(), 21, record.completionTime.c_str(), -1, SQLITE_TRANSIENT);
+    }
+    sqlite3_bind_blob(stmt.get(), 22, record.conditions.data(), static_cast<int>(record.conditions.size()),
+                      SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 23, record.galleryGroup.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 24, record.createdAt.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 25, record.specialMetadata.c_str(), -1, SQLITE_TRANSIENT);
+
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to create achievement", m_db.get()));
+    }
+    return static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+}
+
+namespace {
+const char* const kUpdateTaskSql =
+    "UPDATE tasks SET name = ?, description = ?, type = ?, difficulty = ?, deadline = ?, completed = ?, "
+    "coin_reward = ?, growth_reward = ?, attr_execution = ?, attr_perseverance = ?, attr_decision = ?, "
+    "attr_knowledge = ?, attr_social = ?, attr_pride = ?, bonus_streak = ?, custom_settings = ?, "
+    "forgiveness_coupons = ?, progress_value = ?, progress_goal = ?, deadline_ms = ? WHERE id = ?";
+
+const char* const kUpdateAchievementSql =
+    "UPDATE achievements SET owner_id = ?, creator_id = ?, name = ?, description = ?, icon_path = ?, "
+    "display_color = ?, type = ?, reward_type = ?, progress_mode = ?, progress_value = ?, "
+    "progress_goal = ?, reward_coins = ?, attr_execution = ?, attr_perseverance = ?, attr_decision = ?, "
+    "attr_knowledge = ?, attr_social = ?, attr_pride = ?, reward_items = ?, unlocked = ?, "
+    "completion_time = ?, conditions = ?, gallery_group = ?, created_at = ?, special_metadata = ? "
+    "WHERE id = ?";
+
+const char* const kInsertInventorySql =
+    "INSERT INTO user_inventory (owner_id, item_id, quantity, used_quantity, status, purchase_time, "
+    "expiration_time, lucky_payload, notes, purchase_time_ms, expiration_time_ms) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+const char* const kInsertLogSql =
+    "INSERT INTO logs (timestamp, type, content, related_id, attribute_changes, level_change, special_event, mood, "
+    "timestamp_ms, owner_id, template_id) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+const char* const kUpdateInventorySql =
+    "UPDATE user_inventory SET owner_id = ?, item_id = ?, quantity = ?, used_quantity = ?, status = ?, "
+    "purchase_time = ?, expiration_time = ?, lucky_payload = ?, notes = ?, purchase_time_ms = ?, "
+    "expiration_time_ms = ? WHERE id = ?";
+}  // namespace
+
+/**
+ * @brief 根据 TaskRecord 更新数据库行，保持内存缓存与磁盘一致。
+ * 中文：所有字段一次性写回，保证教师强调的数据一致性。
+ */
+bool DatabaseManager::updateTask(const TaskRecord& task) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpdateTaskSql);
+    bindTaskUpdate(stmt.get(), task);
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to update task", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+/**
+ * @brief 批量写回任务，供每日/每周重置与学期截止检查使用。
+ * 中文：整个批次处于同一事务内，仅在最外层提交一次；任一行失败则整体回滚。
+ */
+std::size_t DatabaseManager::updateTasks(const std::vector<TaskRecord>& tasks) {
+    return runBatchUpdate(kUpdateTaskSql, tasks, &DatabaseManager::bindTaskUpdate, "Failed to batch update tasks");
+}
+
+/**
+ * @brief 批量写回成就进度，供事件驱动的条件刷新使用。
+ */
+std::size_t DatabaseManager::updateAchievements(const std::vector<AchievementRecord>& records) {
+    return runBatchUpdate(kUpdateAchievementSql,
+                          records,
+                          &DatabaseManager::bindAchievementUpdate,
+                          "Failed to batch update achievements");
+}
+
+/**
+ * @brief 批量事务执行器：同一条语句在循环中 reset 后重复绑定执行。
+ * 中文：调用方若已处于事务中则仅增加事务深度，不会提前提交。
+ *
+ * @param sql 更新语句文本。
+ * @param records 待写入的记录集合。
+ * @param binder 将单条记录绑定到语句参数的函数。
+ * @param errorContext 异常信息前缀。
+ * @return 发生变化的行数。
+ * @throws std::runtime_error 写入失败时回滚并抛出。
+ */
+template <typename Record, typename Binder>
+std::size_t DatabaseManager::runBatchUpdate(const std::string& sql,
+                                            const std::vector<Record>& records,
+                                            Binder binder,
+                                            const char* errorContext) {
+    if (records.empty()) {
+        return 0;
+    }
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        std::size_t changed = 0;
+        {
+            auto stmt = prepareStatement(sql);
+            for (const auto& record : records) {
+                binder(stmt.get(), record);
+                int rc = sqlite3_step(stmt.get());
+                if (rc != SQLITE_DONE) {
+                    throw std::runtime_error(buildErrorMessage(errorContext, m_db.get()));
+                }
+                changed += static_cast<std::size_t>(sqlite3_changes(m_db.get()));
+                sqlite3_reset(stmt.get());
+            }
+        }
+        commitTransaction();
+        return changed;
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+bool DatabaseManager::updateAchievement(const AchievementRecord& record) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpdateAchievementSql);
+    bindAchievementUpdate(stmt.get(), record);
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to update achievement", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+/**
+ * @brief 根据任务 ID 删除记录。
+ * 中文：提供统一删除入口，便于 TaskManager 在清理自定义任务时使用。
+ */
+bool DatabaseManager::deleteTask(int taskId) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kDeleteTaskSql);
+    sqlite3_bind_int(stmt.get(), 1, taskId);
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to delete task", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+bool DatabaseManager::deleteAchievement(int achievementId) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kDeleteAchievementSql);
+    sqlite3_bind_int(stmt.get(), 1, achievementId);
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to delete achievement", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+/**
+ * @brief 根据主键查询任务。
+ * 中文：配合 TaskManager::taskById 进行按需加载。
+ */
+std::optional<DatabaseManager::TaskRecord> DatabaseManager::getTaskById(int taskId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectTaskByIdSql);
+    sqlite3_bind_int(stmt.get(), 1, taskId);
+    int rc = sqlite3_step(stmt.get());
+    if (rc == SQLITE_ROW) {
+        return readTaskRecord(stmt.get());
+    }
+    if (rc == SQLITE_DONE) {
+        return std::nullopt;
+    }
+    throw std::runtime_error(buildErrorMessage("Failed to query task", reader.handle()));
+}
+
+/**
+ * @brief 获取某用户的全部任务记录，供登录后初始化缓存。
+ * 中文：一次性读取能减少频繁往返数据库，提高 UI 响应速度。
+ */
+std::vector<DatabaseManager::TaskRecord> DatabaseManager::getTasksForOwner(int ownerId) const {
+    std::vector<TaskRecord> records;
+    streamTasksForOwner(ownerId, [&records](TaskRecord& record) { records.push_back(std::move(record)); });
+    return records;
+}
+
+std::size_t DatabaseManager::streamTasksForOwner(int ownerId, const TaskRecordVisitor& visitor) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectTasksForOwnerSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    TaskRecord record;
+    std::size_t visited = 0;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            readTaskRecordInto(stmt.get(), record);
+            record.ownerId = ownerId;
+            visitor(record);
+            ++visited;
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to read task list", reader.handle()));
+    }
+    return visited;
+}
+
+void DatabaseManager::recordTaskOutcome(int ownerId,
+                                        const std::string& day,
+                                        const std::string& type,
+                                        int completedDelta,
+                                        int failedDelta) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpsertTaskStatSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    sqlite3_bind_text(stmt.get(), 2, day.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 3, type.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 4, completedDelta);
+    sqlite3_bind_int(stmt.get(), 5, failedDelta);
+    if (!isSuccessCode(sqlite3_step(stmt.get()))) {
+        throw std::runtime_error(buildErrorMessage("Failed to record task outcome", m_db.get()));
+    }
+}
+
+bool DatabaseManager::recordTaskDeadlineFailure(int taskId, std::int64_t deadlineMs) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpsertDeadlineFailureSql);
+    sqlite3_bind_int(stmt.get(), 1, taskId);
+    sqlite3_bind_int64(stmt.get(), 2, deadlineMs);
+    if (!isSuccessCode(sqlite3_step(stmt.get()))) {
+        throw std::runtime_error(buildErrorMessage("Failed to record task deadline failure", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+std::unordered_map<int, std::int64_t> DatabaseManager::getTaskDeadlineFailures(int ownerId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectDeadlineFailuresSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    std::unordered_map<int, std::int64_t> failures;
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+        failures.emplace(sqlite3_column_int(stmt.get(), 0), sqlite3_column_int64(stmt.get(), 1));
+    }
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to read task deadline failures", reader.handle()));
+    }
+    return failures;
+}
+
+void DatabaseManager::recordDailyActivity(int ownerId,
+                                          std::int64_t timestampMs,
+                                          int completions,
+                                          int growth,
+                                          int logs) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpsertDailyActivitySql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    sqlite3_bind_int64(stmt.get(), 2, static_cast<sqlite3_int64>(timestampMs));
+    sqlite3_bind_int(stmt.get(), 3, completions);
+    sqlite3_bind_int(stmt.get(), 4, growth);
+    sqlite3_bind_int(stmt.get(), 5, logs);
+    if (!isSuccessCode(sqlite3_step(stmt.get()))) {
+        throw std::runtime_error(buildErrorMessage("Failed to record daily activity", m_db.get()));
+    }
+}
+
+std::vector<DatabaseManager::DailyActivityRecord> DatabaseManager::queryDailyActivity(int ownerId,
+                                                                                     std::int64_t firstJulianDay,
+                                                                                     std::int64_t lastJulianDay) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectDailyActivitySql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    sqlite3_bind_int64(stmt.get(), 2, static_cast<sqlite3_int64>(firstJulianDay));
+    sqlite3_bind_int64(stmt.get(), 3, static_cast<sqlite3_int64>(lastJulianDay));
+    std::vector<DailyActivityRecord> records;
+    while (true) {
+        const int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            DailyActivityRecord record;
+            record.julianDay = static_cast<std::int64_t>(sqlite3_column_int64(stmt.get(), 0));
+            record.completions = sqlite3_column_int(stmt.get(), 1);
+            record.growth = sqlite3_column_int(stmt.get(), 2);
+            record.logs = sqlite3_column_int(stmt.get(), 3);
+            records.push_back(record);
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to query daily activity", reader.handle()));
+    }
+    return records;
+}
+
+void DatabaseManager::recordProgressionDelta(const ProgressionDeltaRecord& record) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kInsertProgressionDeltaSql);
+    sqlite3_bind_int(stmt.get(), 1, record.ownerId);
+    sqlite3_bind_int64(stmt.get(), 2, static_cast<sqlite3_int64>(record.timestampMs));
+    sqlite3_bind_int(stmt.get(), 3, record.levelDelta);
+    sqlite3_bind_int(stmt.get(), 4, record.growthDelta);
+    bindAttributeSet(stmt.get(), 5, record.attributeDelta);
+    if (!isSuccessCode(sqlite3_step(stmt.get()))) {
+        throw std::runtime_error(buildErrorMessage("Failed to record progression delta", m_db.get()));
+    }
+}
+
+std::vector<DatabaseManager::ProgressionDeltaRecord> DatabaseManager::queryProgressionDeltas(
+    int ownerId, std::int64_t afterMs, std::int64_t untilMs) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectProgressionDeltasSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    sqlite3_bind_int64(stmt.get(), 2, static_cast<sqlite3_int64>(afterMs));
+    sqlite3_bind_int64(stmt.get(), 3, static_cast<sqlite3_int64>(untilMs));
+    std::vector<ProgressionDeltaRecord> records;
+    while (true) {
+        const int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            ProgressionDeltaRecord record;
+            record.ownerId = ownerId;
+            record.timestampMs = static_cast<std::int64_t>(sqlite3_column_int64(stmt.get(), 0));
+            record.levelDelta = sqlite3_column_int(stmt.get(), 1);
+            record.growthDelta = sqlite3_column_int(stmt.get(), 2);
+            record.attributeDelta = readAttributeSet(stmt.get(), 3);
+            records.push_back(record);
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to query progression deltas", reader.handle()));
+    }
+    return records;
+}
+
+/**
+ * @brief 明细行取倒序第一条；快照块取整块早于时间点的最后一块，以及跨过时间点的下一块，
+ *        二者解码到 timestampMs 为止后取最晚的一行。补写的旧快照使块间时间略有重叠时，结果仍是这几行中最晚的一条。
+ */
+std::optional<DatabaseManager::SnapshotCheckpoint> DatabaseManager::findSnapshotCheckpoint(
+    int ownerId, std::int64_t timestampMs) const {
+    ROVE_SCOPED_TIMER(Database, "findSnapshotCheckpoint");
+    auto reader = acquireReader();
+    std::optional<SnapshotCheckpoint> best;
+    static const std::string sql = buildSnapshotCheckpointSql();
+    {
+        auto stmt = reader.prepare(sql);
+        sqlite3_bind_int(stmt.get(), 1, ownerId);
+        sqlite3_bind_int64(stmt.get(), 2, static_cast<sqlite3_int64>(timestampMs));
+        const int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            SnapshotCheckpoint checkpoint;
+            checkpoint.timestampMs = static_cast<std::int64_t>(sqlite3_column_int64(stmt.get(), 0));
+            for (std::size_t column = 0; column < kSnapshotColumnCount; ++column) {
+                checkpoint.values[column] = sqlite3_column_int(stmt.get(), static_cast<int>(column) + 1);
+            }
+            best = checkpoint;
+        } else if (rc != SQLITE_DONE) {
+            throw std::runtime_error(buildErrorMessage("Failed to query snapshot checkpoint", reader.handle()));
+        }
+    }
+    SnapshotSeries decoded;
+    for (const char* candidate : kSnapshotCheckpointBlockSql) {
+        auto stmt = reader.prepare(candidate);
+        sqlite3_bind_int(stmt.get(), 1, ownerId);
+        sqlite3_bind_int64(stmt.get(), 2, static_cast<sqlite3_int64>(timestampMs));
+        const int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            decodeTimelineBlock(stmt.get(), 0, std::nullopt, timestampMs, decoded);
+        } else if (rc != SQLITE_DONE) {
+            throw std::runtime_error(buildErrorMessage("Failed to query snapshot checkpoint", reader.handle()));
+        }
+    }
+    const auto& timestamps = decoded.timestamps();
+    for (std::size_t index = 0; index < timestamps.size(); ++index) {
+        if (!best.has_value() || timestamps[index] > best->timestampMs) {
+            best = SnapshotCheckpoint{timestamps[index], decoded.row(index)};
+        }
+    }
+    return best;
+}
+
+std::vector<DatabaseManager::InventoryRecord> DatabaseManager::queryInventoryHeldAt(int ownerId,
+                                                                                   std::int64_t timestampMs) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectInventoryHeldAtSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    sqlite3_bind_int64(stmt.get(), 2, static_cast<sqlite3_int64>(timestampMs));
+    std::vector<InventoryRecord> records;
+    while (true) {
+        const int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            records.push_back(readInventoryRecord(stmt.get()));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to query inventory history", reader.handle()));
+    }
+    return records;
+}
+
+std::vector<DatabaseManager::TaskStatRecord> DatabaseManager::getTaskStatTotals(int ownerId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectTaskStatTotalsSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    std::vector<TaskStatRecord> records;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            TaskStatRecord record;
+            assignText(record.type, stmt.get(), 0);
+            record.completed = sqlite3_column_int(stmt.get(), 1);
+            record.failed = sqlite3_column_int(stmt.get(), 2);
+            records.push_back(std::move(record));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to read task statistics", reader.handle()));
+    }
+    return records;
+}
+
+std::vector<DatabaseManager::TaskStatRecord> DatabaseManager::queryTaskStats(
+    int ownerId,
+    const std::optional<std::string>& startDay,
+    const std::optional<std::string>& endDay) const {
+    auto reader = acquireReader();
+    std::vector<const std::string*> params;
+    if (startDay.has_value()) {
+        params.push_back(&*startDay);
+    }
+    if (endDay.has_value()) {
+        params.push_back(&*endDay);
+    }
+    auto stmt = reader.prepare(buildTaskStatsSql(startDay.has_value(), endDay.has_value()));
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    for (std::size_t i = 0; i < params.size(); ++i) {
+        sqlite3_bind_text(stmt.get(), static_cast<int>(i + 2), params[i]->c_str(), -1, SQLITE_TRANSIENT);
+    }
+    std::vector<TaskStatRecord> records;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            TaskStatRecord record;
+            assignText(record.day, stmt.get(), 0);
+            assignText(record.type, stmt.get(), 1);
+            record.completed = sqlite3_column_int(stmt.get(), 2);
+            record.failed = sqlite3_column_int(stmt.get(), 3);
+            records.push_back(std::move(record));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to query task statistics", reader.handle()));
+    }
+    return records;
+}
+
+std::vector<DatabaseManager::AchievementRecord> DatabaseManager::getAchievementsForOwner(int ownerId) const {
+    std::vector<AchievementRecord> records;
+    streamAchievementsForOwner(ownerId, [&records](AchievementRecord& record) { records.push_back(std::move(record)); });
+    return records;
+}
+
+std::size_t DatabaseManager::streamAchievementsForOwner(int ownerId,
+                                                        const AchievementRecordVisitor& visitor) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectAchievementsForOwnerSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    AchievementRecord record;
+    std::size_t visited = 0;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            readAchievementRecordInto(stmt.get(), record);
+            visitor(record);
+            ++visited;
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to read achievements", reader.handle()));
+    }
+    return visited;
+}
+
+int DatabaseManager::insertShopItem(const ShopItemRecord& record) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "INSERT INTO shop_items (name, description, icon_path, item_type, price_coins, purchase_limit, "
+        "available, effect_description, effect_logic, prop_effect_type, prop_duration_minutes, "
+        "usage_conditions, physical_redeem, physical_notes, lucky_rules, level_requirement) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+    auto stmt = prepareStatement(sql);
+    sqlite3_bind_text(stmt.get(), 1, record.name.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 2, record.description.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 3, record.iconPath.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 4, record.itemType.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 5, record.priceCoins);
+    sqlite3_bind_int(stmt.get(), 6, record.purchaseLimit);
+    sqlite3_bind_int(stmt.get(), 7, record.available ? 1 : 0);
+    sqlite3_bind_text(stmt.get(), 8, record.effectDescription.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 9, record.effectLogic.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 10, record.propEffectType.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 11, record.propDurationMinutes);
+    sqlite3_bind_text(stmt.get(), 12, record.usageConditions.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 13, record.physicalRedeem.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 14, record.physicalNotes.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 15, record.luckyBagRules.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 16, record.levelRequirement);
+    int rc = sqlite3_step(stmt.get());
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to insert shop item", m_db.get()));
+    }
+    return static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+}
+
+bool DatabaseManager::updateShopItem(const ShopItemRecord& record) {
+    if (record.id < 0) {
+        throw std::runtime_error("Invalid shop item id");
+    }
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpdateShopItemSql);
+    sqlite3_bind_text(stmt.get(), 1, record.name.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 2, record.description.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 3, record.iconPath.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 4, record.itemType.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 5, record.priceCoins);
+    sqlite3_bind_int(stmt.get(), 6, record.purchaseLimit);
+    sqlite3_bind_int(stmt.get(), 7, record.available ? 1 : 0);
+    sqlite3_bind_text(stmt.get(), 8, record.effectDescription.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 9, record.effectLogic.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 10, record.propEffectType.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 11, record.propDurationMinutes);
+    sqlite3_bind_text(stmt.get(), 12, record.usageConditions.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 13, record.physicalRedeem.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 14, record.physicalNotes.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt.get(), 15, record.luckyBagRules.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt.get(), 16, record.levelRequirement);
+    sqlite3_bind_int(stmt.get(), 17, record.id);
+    int rc = sqlite3_step(stmt.get());
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to update shop item", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+bool DatabaseManager::deleteShopItem(int itemId) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kDeleteShopItemSql);
+    sqlite3_bind_int(stmt.get(), 1, itemId);
+    int rc = sqlite3_step(stmt.get());
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to delete shop item", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+std::optional<DatabaseManager::ShopItemRecord> DatabaseManager::getShopItemById(int itemId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectShopItemByIdSql);
+    sqlite3_bind_int(stmt.get(), 1, itemId);
+    int rc = sqlite3_step(stmt.get());
+    if (rc == SQLITE_ROW) {
+        return readShopItemRecord(stmt.get());
+    }
+    if (rc == SQLITE_DONE) {
+        return std::nullopt;
+    }
+    throw std::runtime_error(buildErrorMessage("Failed to query shop item", reader.handle()));
+}
+
+std::vector<DatabaseManager::ShopItemRecord> DatabaseManager::getAllShopItems() const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectAllShopItemsSql);
+    std::vector<ShopItemRecord> items;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            items.push_back(readShopItemRecord(stmt.get()));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to read shop items", reader.handle()));
+    }
+    return items;
+}
+
+int DatabaseManager::insertInventoryRecord(const InventoryRecord& record) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kInsertInventorySql);
+    bindInventoryInsert(stmt.get(), record);
+    int rc = sqlite3_step(stmt.get());
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to insert inventory", m_db.get()));
+    }
+    return static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+}
+
+/**
+ * @brief 批量插入库存记录，供购买多件不可堆叠商品（实物、幸运礼包）使用。
+ * 中文：整个批次处于同一事务并复用一条预编译语句；任一行失败则整体回滚。
+ */
+std::vector<int> DatabaseManager::insertInventoryRecords(const std::vector<InventoryRecord>& records) {
+    std::vector<int> ids;
+    if (records.empty()) {
+        return ids;
+    }
+    ids.reserve(records.size());
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        {
+            auto stmt = prepareStatement(kInsertInventorySql);
+            for (const auto& record : records) {
+                bindInventoryInsert(stmt.get(), record);
+                int rc = sqlite3_step(stmt.get());
+                if (rc != SQLITE_DONE) {
+                    throw std::runtime_error(buildErrorMessage("Failed to batch insert inventory", m_db.get()));
+                }
+                ids.push_back(static_cast<int>(sqlite3_last_insert_rowid(m_db.get())));
+                sqlite3_reset(stmt.get());
+            }
+        }
+        commitTransaction();
+        return ids;
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+bool DatabaseManager::updateInventoryRecord(const InventoryRecord& record) {
+    if (record.id < 0) {
+        throw std::runtime_error("Invalid inventory id");
+    }
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kUpdateInventorySql);
+    bindInventoryUpdate(stmt.get(), record);
+    int rc = sqlite3_step(stmt.get());
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to update inventory", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+/**
+ * @brief 批量写回库存记录，供过期清理等批处理使用。
+ */
+std::size_t DatabaseManager::updateInventoryRecords(const std::vector<InventoryRecord>& records) {
+    for (const auto& record : records) {
+        if (record.id < 0) {
+            throw std::runtime_error("Invalid inventory id");
+        }
+    }
+    return runBatchUpdate(kUpdateInventorySql,
+                          records,
+                          &DatabaseManager::bindInventoryUpdate,
+                          "Failed to batch update inventory");
+}
+
+bool DatabaseManager::deleteInventoryRecord(int inventoryId) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kDeleteInventorySql);
+    sqlite3_bind_int(stmt.get(), 1, inventoryId);
+    int rc = sqlite3_step(stmt.get());
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to delete inventory", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+std::optional<DatabaseManager::InventoryRecord> DatabaseManager::getInventoryRecordById(int inventoryId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectInventoryByIdSql);
+    sqlite3_bind_int(stmt.get(), 1, inventoryId);
+    int rc = sqlite3_step(stmt.get());
+    if (rc == SQLITE_ROW) {
+        return readInventoryRecord(stmt.get());
+    }
+    if (rc == SQLITE_DONE) {
+        return std::nullopt;
+    }
+    throw std::runtime_error(buildErrorMessage("Failed to query inventory", reader.handle()));
+}
+
+std::vector<DatabaseManager::InventoryRecord> DatabaseManager::getInventoryForUser(int ownerId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectInventoryForOwnerSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    std::vector<InventoryRecord> records;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            records.push_back(readInventoryRecord(stmt.get()));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to list inventory", reader.handle()));
+    }
+    return records;
+}
+
+std::vector<DatabaseManager::InventoryRecord> DatabaseManager::getAllInventoryRecords() const {
+    auto reader = acquireReader();
+    const std::string sql =
+        "SELECT id, item_id, owner_id, quantity, used_quantity, status, purchase_time, expiration_time, "
+        "lucky_payload, notes, purchase_time_ms, expiration_time_ms FROM user_inventory";
+    auto stmt = reader.prepare(sql);
+    std::vector<InventoryRecord> records;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            records.push_back(readInventoryRecord(stmt.get()));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to scan inventory", reader.handle()));
+    }
+    return records;
+}
+
+/**
+ * @brief 查询已到期但未回收的库存，供过期清理使用。
+ * 中文：status 以 IN 列出其余三种状态，使每个状态都能在索引上做 expiration_time_ms 的整数范围扫描；
+ *       NULL 到期时间不满足比较条件，天然被排除。
+ */
+std::vector<DatabaseManager::InventoryRecord> DatabaseManager::getExpiredInventoryRecords(
+    std::int64_t nowMs) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectExpiredInventorySql);
+    sqlite3_bind_int64(stmt.get(), 1, static_cast<sqlite3_int64>(nowMs));
+    std::vector<InventoryRecord> records;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            records.push_back(readInventoryRecord(stmt.get()));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to query expired inventory", reader.handle()));
+    }
+    return records;
+}
+
+int DatabaseManager::countInventoryByUserAndItem(int ownerId, int itemId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kCountInventoryByItemSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    sqlite3_bind_int(stmt.get(), 2, itemId);
+    int rc = sqlite3_step(stmt.get());
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to count inventory", reader.handle()));
+    }
+    return sqlite3_column_int(stmt.get(), 0);
+}
+
+/**
+ * @brief 按商品类型聚合库存件数，替代逐条查询 shop_items 的 N+1 访问。
+ * 中文：区间比较走 expiration_time_ms 整数列，不依赖 ISO 文本格式一致。
+ */
+std::vector<DatabaseManager::InventoryTypeTotals> DatabaseManager::aggregateInventoryByType(
+    int ownerId,
+    std::int64_t fromMs,
+    std::int64_t untilMs) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kInventoryTypeSummarySql);
+    sqlite3_bind_int64(stmt.get(), 1, static_cast<sqlite3_int64>(fromMs));
+    sqlite3_bind_int64(stmt.get(), 2, static_cast<sqlite3_int64>(untilMs));
+    sqlite3_bind_int(stmt.get(), 3, ownerId);
+    std::vector<InventoryTypeTotals> totals;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            InventoryTypeTotals row;
+            if (sqlite3_column_type(stmt.get(), 0) != SQLITE_NULL) {
+                row.itemType = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0));
+            }
+            row.quantity = sqlite3_column_int(stmt.get(), 1);
+            row.expiringSoon = sqlite3_column_int(stmt.get(), 2);
+            totals.push_back(std::move(row));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to aggregate inventory", reader.handle()));
+    }
+    return totals;
+}
+
+std::vector<std::pair<int, std::string>> DatabaseManager::getInventoryItemTypes(int ownerId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectInventoryItemTypesSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    std::vector<std::pair<int, std::string>> types;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            types.emplace_back(sqlite3_column_int(stmt.get(), 0),
+                               reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 1)));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to query inventory item types", reader.handle()));
+    }
+    return types;
+}
+
+/**
+ * @brief 统计某月创建的自定义奖励成就数量。
+ * 中文：月份条件写成 created_at 的半开区间而非 strftime 比较，可直接在覆盖索引
+ *       idx_achievements_owner_type_created 上计数；ISO 文本按字典序比较与时间顺序一致。
+ */
+int DatabaseManager::countCustomRewardAchievements(int ownerId, const std::string& monthToken) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kCountCustomRewardAchievementsSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    sqlite3_bind_text(stmt.get(), 2, monthToken.c_str(), -1, SQLITE_TRANSIENT);
+    int rc = sqlite3_step(stmt.get());
+    if (!isSuccessCode(rc)) {
+        throw std::runtime_error(buildErrorMessage("Failed to count achievements", reader.handle()));
+    }
+    return sqlite3_column_int(stmt.get(), 0);
+}
+
+/**
+ * @brief 插入一条日志记录，遵循不可变设计。
+ * 中文：所有日志写入后不可更新或删除，仅追加；手动日志与当日活动计数在同一事务内写入。
+ */
+int DatabaseManager::insertLogRecord(const LogRecord& record) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        int newId = -1;
+        {
+            auto stmt = prepareStatement(kInsertLogSql);
+            bindLogInsert(stmt.get(), record);
+            int rc = sqlite3_step(stmt.get());
+            if (rc != SQLITE_DONE) {
+                throw std::runtime_error(buildErrorMessage("Failed to insert log record", m_db.get()));
+            }
+            newId = static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+        }
+        indexLogRecord(newId, record);
+        countManualLogActivity(record);
+        commitTransaction();
+        return newId;
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+/**
+ * @brief 批量插入日志记录，供异步日志写入线程做组提交。
+ * 中文：整批处于同一事务并复用一条预编译语句，一次提交只需一次 WAL 同步；任一行失败则整体回滚。
+ */
+std::vector<int> DatabaseManager::insertLogRecords(const std::vector<LogRecord>& records) {
+    std::vector<int> ids;
+    if (records.empty()) {
+        return ids;
+    }
+    ids.reserve(records.size());
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        {
+            auto stmt = prepareStatement(kInsertLogSql);
+            for (const auto& record : records) {
+                bindLogInsert(stmt.get(), record);
+                int rc = sqlite3_step(stmt.get());
+                if (rc != SQLITE_DONE) {
+                    throw std::runtime_error(buildErrorMessage("Failed to batch insert log records", m_db.get()));
+                }
+                ids.push_back(static_cast<int>(sqlite3_last_insert_rowid(m_db.get())));
+                sqlite3_reset(stmt.get());
+            }
+        }
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            indexLogRecord(ids[i], records[i]);
+            countManualLogActivity(records[i]);
+        }
+        commitTransaction();
+        return ids;
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+/**
+ * @brief 按过滤条件读取日志，使用时间索引提升性能。
+ * 中文：结合类型、时间、心情与关键字进行筛选。
+ */
+std::vector<DatabaseManager::LogRecord> DatabaseManager::queryLogRecords(const std::optional<std::string>& typeFilter,
+                                                                       const std::optional<std::string>& startIso,
+                                                                       const std::optional<std::string>& endIso,
+                                                                       const std::optional<std::string>& moodFilter,
+                                                                       const std::optional<std::string>& keyword) const {
+    const auto toEpochMs = [](const std::optional<std::string>& iso) -> std::optional<std::int64_t> {
+        return iso.has_value() ? isoToEpochMs(*iso) : std::nullopt;
+    };
+    const LogFilter filter{typeFilter, toEpochMs(startIso), toEpochMs(endIso), moodFilter, keyword};
+    std::vector<LogRecord> records;
+    streamLogRecords(filter, std::nullopt, [&records](const LogRecord& record) {
+        records.push_back(record);
+        return true;
+    });
+    return records;
+}
+
+/**
+ * @brief 拼接日志查询 SQL，统一过滤条件与键集游标。
+ * 中文：使用行值比较 (timestamp_ms, id) > (?, ?)，SQLite 可直接在 idx_logs_owner_timestamp_ms 上定位起点。
+ */
+std::string DatabaseManager::buildLogQuerySql(const LogFilter& filter,
+                                              const std::optional<LogCursor>& after,
+                                              std::vector<SqlParam>& params) const {
+    std::string sql = "SELECT id, timestamp, type, content, related_id, attribute_changes, level_change, special_event, mood, timestamp_ms, template_id FROM logs WHERE 1=1";
+    appendLogFilterSql(filter, sql, params);
+    if (after.has_value()) {
+        sql += " AND (timestamp_ms, id) > (?, ?)";
+    }
+    sql += " ORDER BY timestamp_ms ASC, id ASC";
+    return sql;
+}
+
+/**
+ * @brief 追加用户、类型、时间、心情、关键词与宽恕过滤条件，供普通查询与全文检索共用。
+ * 中文：宽恕排除使用 NOT EXISTS 反连接，命中 forgiven_logs 主键，无需把 ID 集合读进内存。
+ */
+void DatabaseManager::appendLogFilterSql(const LogFilter& filter,
+                                         std::string& sql,
+                                         std::vector<SqlParam>& params) const {
+    if (filter.ownerId.has_value()) {
+        sql += " AND owner_id = ?";
+        params.emplace_back(static_cast<std::int64_t>(*filter.ownerId));
+    }
+    if (filter.type.has_value()) {
+        sql += " AND type = ?";
+        params.push_back(*filter.type);
+    }
+    if (filter.startMs.has_value()) {
+        sql += " AND timestamp_ms >= ?";
+        params.emplace_back(*filter.startMs);
+    }
+    if (filter.endMs.has_value()) {
+        sql += " AND timestamp_ms <= ?";
+        params.emplace_back(*filter.endMs);
+    }
+    if (filter.mood.has_value()) {
+        sql += " AND mood = ?";
+        params.push_back(*filter.mood);
+    }
+    if (filter.keyword.has_value()) {
+        appendLogKeywordSql(*filter.keyword, sql, params);
+    }
+    if (filter.excludeForgiven) {
+        sql += " AND NOT EXISTS (SELECT 1 FROM forgiven_logs WHERE forgiven_logs.log_id = logs.id)";
+    }
+}
+
+/**
+ * @brief 追加关键词条件：索引可用且关键词足够长时走 FTS5 MATCH，否则退化为 LIKE。
+ * 中文：两条路径都同时匹配渲染后的文本与 special_event，结果集保持一致；模板日志的 content 只是参数，
+ *       LIKE 因此作用在 render_log 的结果上。
+ */
+void DatabaseManager::appendLogKeywordSql(const std::string& keyword,
+                                          std::string& sql,
+                                          std::vector<SqlParam>& params) const {
+    if (m_logSearchIndexed && utf8Length(keyword) >= kTrigramMinimumLength) {
+        sql += " AND id IN (SELECT rowid FROM logs_fts WHERE logs_fts MATCH ?)";
+        params.push_back(toFtsPhrase(keyword));
+        return;
+    }
+    sql += " AND (render_log(template_id, content) LIKE ? OR special_event LIKE ?)";
+    params.push_back(std::string("%") + keyword + "%");
+    params.push_back(std::string("%") + keyword + "%");
+}
+
+/**
+ * @brief 拼接全文检索 SQL：logs_fts 命中集合连接 logs，其余过滤条件与普通查询共用。
+ * 中文：调用方已确认关键词可走 FTS；limited 为 true 时末尾追加 LIMIT 占位符。
+ */
+std::string DatabaseManager::buildLogSearchSql(const LogFilter& filter,
+                                               bool limited,
+                                               std::vector<SqlParam>& params) const {
+    LogFilter scoped = filter;
+    scoped.keyword.reset();
+    params.push_back(toFtsPhrase(filter.keyword.value_or(std::string())));
+    std::string sql =
+        "SELECT id, timestamp, type, content, related_id, attribute_changes, level_change, special_event, mood, "
+        "timestamp_ms, template_id FROM logs JOIN (SELECT rowid AS hit_id, rank AS hit_rank FROM logs_fts WHERE logs_fts MATCH ?) "
+        "ON hit_id = logs.id WHERE 1=1";
+    appendLogFilterSql(scoped, sql, params);
+    sql += " ORDER BY hit_rank ASC, timestamp_ms ASC, id ASC";
+    if (limited) {
+        sql += " LIMIT ?";
+    }
+    return sql;
+}
+
+/**
+ * @brief 全文检索：通过 logs_fts 命中集合连接 logs，按 bm25 排名输出。
+ */
+std::vector<DatabaseManager::LogRecord> DatabaseManager::searchLogRecords(const LogFilter& filter,
+                                                                        std::size_t limit) const {
+    if (!filter.keyword.has_value() || filter.keyword->empty()) {
+        throw std::runtime_error("Log search requires a keyword");
+    }
+    if (!m_logSearchIndexed || utf8Length(*filter.keyword) < kTrigramMinimumLength) {
+        std::vector<LogRecord> records;
+        streamLogRecords(filter, std::nullopt, [&records, limit](const LogRecord& record) {
+            records.push_back(record);
+            return limit == 0 || records.size() < limit;
+        });
+        return records;
+    }
+
+    std::vector<SqlParam> params;
+    const std::string sql = buildLogSearchSql(filter, limit > 0, params);
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(sql);
+    const int next = bindLogQuery(stmt.get(), params, std::nullopt);
+    if (limit > 0) {
+        sqlite3_bind_int64(stmt.get(), next, static_cast<sqlite3_int64>(limit));
+    }
+    std::vector<LogRecord> records;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            records.push_back(readLogRecord(stmt.get()));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to search logs", reader.handle()));
+    }
+    return records;
+}
+
+bool DatabaseManager::isLogSearchIndexed() const noexcept { return m_logSearchIndexed; }
+
+/**
+ * @brief 绑定 buildLogQuerySql 生成的参数，时间条件与游标以整数绑定。
+ * 中文：返回下一个可用的参数序号，便于调用方继续追加 LIMIT 等参数。
+ */
+int DatabaseManager::bindLogQuery(sqlite3_stmt* statement,
+                                  const std::vector<SqlParam>& params,
+                                  const std::optional<LogCursor>& after) {
+    int index = 1;
+    for (const auto& param : params) {
+        if (const auto* text = std::get_if<std::string>(&param)) {
+            sqlite3_bind_text(statement, index++, text->c_str(), -1, SQLITE_TRANSIENT);
+        } else {
+            sqlite3_bind_int64(statement, index++, static_cast<sqlite3_int64>(std::get<std::int64_t>(param)));
+        }
+    }
+    if (after.has_value()) {
+        sqlite3_bind_int64(statement, index++, static_cast<sqlite3_int64>(after->timestampMs));
+        sqlite3_bind_int(statement, index++, after->id);
+    }
+    return index;
+}
+
+/**
+ * @brief 键集分页查询：多取一行判断是否还有下一页。
+ */
+DatabaseManager::LogPage DatabaseManager::queryLogPage(const LogFilter& filter,
+                                                       const std::optional<LogCursor>& after,
+                                                       std::size_t pageSize) const {
+    if (pageSize == 0) {
+        throw std::runtime_error("Log page size must be positive");
+    }
+    auto reader = acquireReader();
+    std::vector<SqlParam> params;
+    std::string sql = buildLogQuerySql(filter, after, params);
+    sql += " LIMIT ?";
+    auto stmt = reader.prepare(sql);
+    const int next = bindLogQuery(stmt.get(), params, after);
+    sqlite3_bind_int64(stmt.get(), next, static_cast<sqlite3_int64>(pageSize) + 1);
+    LogPage page;
+    page.records.reserve(pageSize);
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            if (page.records.size() == pageSize) {
+                const LogRecord& last = page.records.back();
+                page.nextCursor = LogCursor{last.timestampMs, last.id};
+                break;
+            }
+            page.records.push_back(readLogRecord(stmt.get()));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to query log page", reader.handle()));
+    }
+    return page;
+}
+
+/**
+ * @brief 流式遍历日志，逐行交给回调处理。
+ * 中文：导出、统计等场景无需一次性持有全部记录。
+ */
+std::size_t DatabaseManager::streamLogRecords(const LogFilter& filter,
+                                              const std::optional<LogCursor>& after,
+                                              const LogVisitor& visitor) const {
+    auto reader = acquireReader();
+    std::vector<SqlParam> params;
+    const std::string sql = buildLogQuerySql(filter, after, params);
+    auto stmt = reader.prepare(sql);
+    bindLogQuery(stmt.get(), params, after);
+    LogRecord record;
+    std::size_t visited = 0;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            ++visited;
+            readLogRecordInto(stmt.get(), record);
+            if (!visitor(record)) {
+                break;
+            }
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to query logs", reader.handle()));
+    }
+    return visited;
+}
+
+/**
+ * @brief 统计某用户的手动日志数量，避免从数据库加载全部记录。
+ * 中文：采用 COUNT(*) 聚合，在 (owner_id, type, timestamp_ms) 索引上只计该用户的区间。
+ */
+int DatabaseManager::countManualLogs(int ownerId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kCountManualLogsSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_ROW) {
+        throw std::runtime_error(buildErrorMessage("Failed to count manual logs", reader.handle()));
+    }
+    return sqlite3_column_int(stmt.get(), 0);
+}
+
+/**
+ * @brief 将日志主键写入宽恕表，若已存在则忽略。
+ * 中文：使用 INSERT OR IGNORE 避免重复写入引发错误。
+ */
+bool DatabaseManager::markLogForgiven(int logId) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(kInsertForgivenLogSql);
+    sqlite3_bind_int(stmt.get(), 1, logId);
+    int rc = sqlite3_step(stmt.get());
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to persist forgiven log", m_db.get()));
+    }
+    return sqlite3_changes(m_db.get()) > 0;
+}
+
+/**
+ * @brief 读取某用户被宽恕的日志 ID，供内存状态初始化。
+ * 中文：按主键顺序读取，结果已有序，直接交给 SortedIdSet 无需再排序。
+ */
+SortedIdSet DatabaseManager::loadForgivenLogIds(int ownerId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectForgivenLogIdsSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
+    std::vector<int> ids;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            ids.push_back(sqlite3_column_int(stmt.get(), 0));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to load forgiven logs", reader.handle()));
+    }
+    return SortedIdSet(std::move(ids));
+}
+
+namespace {
+// 中文：候选集合为用户 ?3 的日志按 (timestamp_ms, id) 取前 ?2 行；同一事务内三条语句看到的数据一致，
+//       汇总与归档在删除之前执行，因此三次求值得到同一批日志。
+const char* const kLogCompactionCandidates =
+    "SELECT id FROM logs WHERE owner_id = ?3 AND type = 'Auto' AND timestamp_ms < ?1 "
+    "AND NOT EXISTS (SELECT 1 FROM forgiven_logs WHERE forgiven_logs.log_id = logs.id) "
+    "ORDER BY timestamp_ms ASC, id ASC LIMIT ?2";
+
+const std::string kSummarizeLogBatchSql =
+    std::string("INSERT INTO log_daily_summaries (owner_id, day, special_event, entry_count, level_change, "
+                "first_timestamp_ms, last_timestamp_ms) "
+                "SELECT ?3, date(timestamp_ms / 1000, 'unixepoch', 'localtime'), special_event, COUNT(1), "
+                "SUM(level_change), MIN(timestamp_ms), MAX(timestamp_ms) FROM logs WHERE id IN (") +
+    kLogCompactionCandidates +
+    ") GROUP BY 2, 3 ON CONFLICT(owner_id, day, special_event) DO UPDATE SET "
+    "entry_count = entry_count + excluded.entry_count, "
+    "level_change = level_change + excluded.level_change, "
+    "first_timestamp_ms = MIN(first_timestamp_ms, excluded.first_timestamp_ms), "
+    "last_timestamp_ms = MAX(last_timestamp_ms, excluded.last_timestamp_ms)";
+
+// 中文：归档库保存渲染后的原文，不依赖模板表与 render_log。
+const std::string kArchiveLogBatchSql =
+    std::string("INSERT OR REPLACE INTO log_archive.logs (id, timestamp, type, content, related_id, "
+                "attribute_changes, level_change, special_event, mood, timestamp_ms, owner_id) "
+                "SELECT id, timestamp, type, render_log(template_id, content), related_id, attribute_changes, "
+                "level_change, special_event, mood, timestamp_ms, owner_id FROM main.logs WHERE id IN (") +
+    kLogCompactionCandidates + ")";
+
+const std::string kDeleteLogBatchSql = std::string("DELETE FROM main.logs WHERE id IN (") +
+                                       kLogCompactionCandidates + ")";
+
+/**
+ * @brief Quote a string as an SQL literal by doubling single quotes.
+ * 中文：ATTACH 的文件名通过 sqlite3_exec 执行，单引号需转义。
+ *
+ * @param text Raw text. 中文：原始文本。
+ * @return Quoted literal. 中文：带引号的字面量。
+ * @throws None. 中文：不抛出异常。
+ */
+std::string quoteSqlLiteral(const std::string& text) {
+    std::string quoted = "'";
+    for (char c : text) {
+        quoted += c;
+        if (c == '\'') {
+            quoted += c;
+        }
+    }
+    quoted += "'";
+    return quoted;
+}
+
+/**
+ * @brief Quote an identifier by doubling double quotes.
+ * 中文：维护任务按表名拼接 ANALYZE 语句，表名需以双引号转义。
+ */
+std::string quoteSqlIdentifier(const std::string& name) {
+    std::string quoted = "\"";
+    for (char c : name) {
+        quoted += c;
+        if (c == '"') {
+            quoted += c;
+        }
+    }
+    quoted += "\"";
+    return quoted;
+}
+
+/**
+ * @brief 用户档案涉及的表，按导入顺序排列：被引用的行（用户、日志）先于引用它们的行写入。
+ * 中文：select 与 purge 中的 ?1 绑定用户 id，为空时按 owner_id 列筛选整表。users 只导出可迁移的成长字段
+ *       （不含 id、用户名与密码），导入时更新目标用户所在行；app_state 的按用户键去掉 id 后缀导出，导入时接上目标用户 id。
+ */
+struct ProfileTable {
+    const char* name;
+    const char* select;
+    const char* purge;
+};
+
+constexpr ProfileTable kProfileTables[] = {
+    {"users",
+     "SELECT level, currency, attributes, attr_execution, attr_perseverance, attr_decision, attr_knowledge, "
+     "attr_social, attr_pride FROM users WHERE id = ?1",
+     ""},
+    {"tasks", nullptr, nullptr},
+    {"task_stats", nullptr, nullptr},
+    {"achievements", nullptr, nullptr},
+    {"user_inventory", nullptr, nullptr},
+    {"logs", nullptr, nullptr},
+    {"forgiven_logs", "SELECT f.log_id FROM forgiven_logs f JOIN logs l ON l.id = f.log_id WHERE l.owner_id = ?1",
+     "DELETE FROM forgiven_logs WHERE log_id IN (SELECT id FROM logs WHERE owner_id = ?1)"},
+    {"log_daily_summaries", nullptr, nullptr},
+    {"growth_snapshots", nullptr, nullptr},
+    {"growth_snapshots_hourly", nullptr, nullptr},
+    {"growth_snapshots_daily", nullptr, nullptr},
+    {"growth_snapshots_weekly", nullptr, nullptr},
+    {"growth_snapshot_blocks", nullptr, nullptr},
+    {"growth_analytics_state", nullptr, nullptr},
+    {"activity_feed_state", nullptr, nullptr},
+    {"daily_activity", nullptr, nullptr},
+    {"progression_deltas", nullptr, nullptr},
+    {"app_state",
+     "SELECT substr(key, 1, length(key) - length(?1) - 1) AS key, value FROM app_state WHERE key LIKE '%:' || ?1",
+     "DELETE FROM app_state WHERE key LIKE '%:' || ?1"},
+};
+
+constexpr std::uint64_t kProfileProgressRows = 4096;    //!< 每处理这么多行回调一次进度
+constexpr std::uint64_t kProfileDeferIndexRows = 2000;  //!< 导入行数达到此值的表先删二级索引，写完后一次重建
+
+std::string profileSelectSql(const ProfileTable& table) {
+    return table.select != nullptr ? table.select : "SELECT * FROM " + std::string(table.name) + " WHERE owner_id = ?1";
+}
+
+std::string profilePurgeSql(const ProfileTable& table) {
+    return table.purge != nullptr ? table.purge : "DELETE FROM " + std::string(table.name) + " WHERE owner_id = ?1";
+}
+}  // namespace
+
+/**
+ * 中文说明：日志压缩
+ * - 归档库在整个压缩过程中保持挂载，结束或失败时卸载；挂载期间其他线程照常读写主库；
+ * - 候选按用户划分，逐个用户压缩，每批只走该用户的 (owner_id, type, timestamp_ms) 索引区间；
+ * - 每批单独加锁与提交，对 GUI 线程与日志写入线程的阻塞上限约为一批的耗时；
+ * - 归档使用 INSERT OR REPLACE，上次中途失败后重跑不会因主键冲突中止。
+ */
+std::size_t DatabaseManager::compactLogs(const LogRetentionPolicy& policy, std::int64_t nowMs) {
+    if (policy.detailDays < 0 || policy.batchSize == 0) {
+        return 0;
+    }
+    const std::int64_t cutoffMs = nowMs - static_cast<std::int64_t>(policy.detailDays) * 24 * 60 * 60 * 1000;
+    {
+        std::lock_guard<WriterMutex> lock(m_mutex);
+        if (m_db == nullptr) {
+            throw std::runtime_error("Database is not initialized");
+        }
+        if (m_transactionOwner.load() == std::this_thread::get_id()) {
+            throw std::runtime_error("Cannot compact logs inside a transaction");
+        }
+        // 中文：内存模式下归档跟随检查点文件，与非内存模式落在同一位置。
+        const std::string& basePath = m_checkpointPath.empty() ? m_databasePath : m_checkpointPath;
+        std::string archivePath = policy.archivePath;
+        if (archivePath.empty() && !basePath.empty() && basePath != ":memory:") {
+            archivePath = basePath + ".archive";
+        }
+        if (archivePath.empty()) {
+            return 0;
+        }
+        executeNonQuery("ATTACH DATABASE " + quoteSqlLiteral(archivePath) + " AS log_archive;");
+    }
+    // 中文：DETACH 要求连接上没有打开的事务；持有 m_mutex 即保证其他线程的事务均已结束。
+    const auto detach = [this]() {
+        std::lock_guard<WriterMutex> lock(m_mutex);
+        executeNonQuery("DETACH DATABASE log_archive;");
+    };
+    std::size_t moved = 0;
+    try {
+        {
+            std::lock_guard<WriterMutex> lock(m_mutex);
+            executeNonQuery(
+                "CREATE TABLE IF NOT EXISTS log_archive.logs (\n"
+                "id INTEGER PRIMARY KEY,\n"
+                "timestamp TEXT NOT NULL,\n"
+                "type TEXT NOT NULL,\n"
+                "content TEXT NOT NULL,\n"
+                "related_id INTEGER,\n"
+                "attribute_changes TEXT NOT NULL DEFAULT '{}',\n"
+                "level_change INTEGER NOT NULL DEFAULT 0,\n"
+                "special_event TEXT NOT NULL DEFAULT '',\n"
+                "mood TEXT NOT NULL DEFAULT '',\n"
+                "timestamp_ms INTEGER,\n"
+                "owner_id INTEGER NOT NULL DEFAULT 0);");
+            // 中文：迁移 5 之前写入的归档库没有用户列，补列后归入预置账号，与主库迁移口径一致。
+            bool archivePartitioned = false;
+            {
+                auto probe = prepareStatement(
+                    "SELECT COUNT(1) FROM pragma_table_info('logs', 'log_archive') WHERE name = 'owner_id'");
+                if (sqlite3_step(probe.get()) != SQLITE_ROW) {
+                    throw std::runtime_error(buildErrorMessage("Failed to inspect log archive", m_db.get()));
+                }
+                archivePartitioned = sqlite3_column_int(probe.get(), 0) != 0;
+            }
+            if (!archivePartitioned) {
+                executeNonQuery("ALTER TABLE log_archive.logs ADD COLUMN owner_id INTEGER NOT NULL DEFAULT 0;");
+                executeNonQuery(
+                    "UPDATE log_archive.logs SET owner_id = IFNULL((SELECT MIN(id) FROM main.users), 0);");
+            }
+            executeNonQuery("DROP INDEX IF EXISTS log_archive.idx_archive_logs_timestamp_ms;");
+            executeNonQuery(
+                "CREATE INDEX IF NOT EXISTS log_archive.idx_archive_logs_owner_timestamp_ms "
+                "ON logs(owner_id, timestamp_ms);");
+        }
+        std::vector<int> owners;
+        {
+            auto reader = acquireReader();
+            auto stmt = reader.prepare("SELECT id FROM users ORDER BY id");
+            while (true) {
+                const int rc = sqlite3_step(stmt.get());
+                if (rc == SQLITE_ROW) {
+                    owners.push_back(sqlite3_column_int(stmt.get(), 0));
+                    continue;
+                }
+                if (rc == SQLITE_DONE) {
+                    break;
+                }
+                throw std::runtime_error(buildErrorMessage("Failed to list users", reader.handle()));
+            }
+        }
+        for (int ownerId : owners) {
+            while (true) {
+                const std::size_t batch = compactLogBatch(ownerId, cutoffMs, policy.batchSize);
+                moved += batch;
+                if (batch < policy.batchSize) {
+                    break;
+                }
+            }
+        }
+    } catch (...) {
+        try {
+            detach();
+        } catch (...) {
+        }
+        throw;
+    }
+    detach();
+    return moved;
+}
+
+/**
+ * @brief 在单个事务内汇总、归档并删除一批候选日志。
+ * 中文：调用方已挂载 log_archive；FTS 触发器随删除同步清理 logs_fts。
+ */
+std::size_t DatabaseManager::compactLogBatch(int ownerId, std::int64_t cutoffMs, std::size_t batchSize) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        std::size_t deleted = 0;
+        for (const std::string* sql : {&kSummarizeLogBatchSql, &kArchiveLogBatchSql, &kDeleteLogBatchSql}) {
+            auto stmt = prepareStatement(*sql);
+            sqlite3_bind_int64(stmt.get(), 1, static_cast<sqlite3_int64>(cutoffMs));
+            sqlite3_bind_int64(stmt.get(), 2, static_cast<sqlite3_int64>(batchSize));
+            sqlite3_bind_int(stmt.get(), 3, ownerId);
+            if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+                throw std::runtime_error(buildErrorMessage("Failed to compact logs", m_db.get()));
+            }
+            deleted = static_cast<std::size_t>(sqlite3_changes(m_db.get()));
+        }
+        commitTransaction();
+        return deleted;
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+/**
+ * 中文说明：冷日志压缩
+ * - 候选为早于截止时间、非模板、仍以 TEXT 存储且足够长的日志；压缩无收益的行保持原样，由 id 游标跳过；
+ * - 全文索引保存的是写入时渲染的文本，压缩只改写存储形式，索引无需更新；
+ * - 每批在独立事务中完成，批次之间释放写锁。
+ */
+std::size_t DatabaseManager::compressColdLogs(const LogRetentionPolicy& policy, std::int64_t nowMs) {
+    if (policy.compressAfterDays < 0 || policy.batchSize == 0) {
+        return 0;
+    }
+    ROVE_SCOPED_TIMER(Database, "compressColdLogs");
+    const std::int64_t cutoffMs =
+        nowMs - static_cast<std::int64_t>(policy.compressAfterDays) * 24 * 60 * 60 * 1000;
+    {
+        std::lock_guard<WriterMutex> lock(m_mutex);
+        if (m_db == nullptr) {
+            throw std::runtime_error("Database is not initialized");
+        }
+        if (m_transactionOwner.load() == std::this_thread::get_id()) {
+            throw std::runtime_error("Cannot compress logs inside a transaction");
+        }
+    }
+    std::int64_t cursor = 0;
+    std::size_t compressed = 0;
+    while (compressLogBatch(cutoffMs, policy.batchSize, cursor, compressed) == policy.batchSize) {
+    }
+    return compressed;
+}
+
+std::size_t DatabaseManager::compressLogBatch(std::int64_t cutoffMs, std::size_t batchSize, std::int64_t& cursor,
+                                              std::size_t& compressed) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        std::size_t scanned = 0;
+        std::uint64_t savedBytes = 0;
+        auto select = prepareStatement(kSelectColdLogsSql);
+        sqlite3_bind_int64(select.get(), 1, static_cast<sqlite3_int64>(cursor));
+        sqlite3_bind_int64(select.get(), 2, static_cast<sqlite3_int64>(cutoffMs));
+        sqlite3_bind_int64(select.get(), 3, static_cast<sqlite3_int64>(kMinCompressibleLogBytes));
+        sqlite3_bind_int64(select.get(), 4, static_cast<sqlite3_int64>(batchSize));
+        auto update = prepareStatement(kUpdateLogContentSql);
+        while (true) {
+            const int rc = sqlite3_step(select.get());
+            if (rc == SQLITE_DONE) {
+                break;
+            }
+            if (rc != SQLITE_ROW) {
+                throw std::runtime_error(buildErrorMessage("Failed to scan cold logs", m_db.get()));
+            }
+            ++scanned;
+            cursor = sqlite3_column_int64(select.get(), 0);
+            const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(select.get(), 1));
+            const auto textBytes = static_cast<std::size_t>(sqlite3_column_bytes(select.get(), 1));
+            const auto blob = compressLogContent(std::string_view(text == nullptr ? "" : text, textBytes));
+            if (!blob.has_value()) {
+                continue;
+            }
+            sqlite3_bind_blob(update.get(), 1, blob->data(), static_cast<int>(blob->size()), SQLITE_TRANSIENT);
+            sqlite3_bind_int64(update.get(), 2, static_cast<sqlite3_int64>(cursor));
+            if (sqlite3_step(update.get()) != SQLITE_DONE) {
+                throw std::runtime_error(buildErrorMessage("Failed to compress log", m_db.get()));
+            }
+            sqlite3_reset(update.get());
+            ++compressed;
+            savedBytes += textBytes - blob->size();
+        }
+        commitTransaction();
+        ROVE_COUNTER_ADD(Database, "logs.compressedBytesSaved", savedBytes);
+        return scanned;
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+/**
+ * 中文说明：成长快照打包
+ * - 只打包满块：每块恰好 rowsPerBlock 条，关键帧间隔固定，不会因维护周期产生大量碎块；
+ * - 块与被删除的明细行在同一事务内写入与删除，读取端任何时刻都不会重复或遗漏快照；
+ * - 聚合表与成长分析状态在写入快照时已更新，打包不触碰它们。
+ */
+std::size_t DatabaseManager::packGrowthSnapshots(const SnapshotPackingPolicy& policy, std::int64_t nowMs) {
+    if (policy.packAfterDays < 0 || policy.rowsPerBlock < 2) {
+        return 0;
+    }
+    ROVE_SCOPED_TIMER(Database, "packGrowthSnapshots");
+    const std::int64_t cutoffMs = nowMs - static_cast<std::int64_t>(policy.packAfterDays) * 24 * 60 * 60 * 1000;
+    {
+        std::lock_guard<WriterMutex> lock(m_mutex);
+        if (m_db == nullptr) {
+            throw std::runtime_error("Database is not initialized");
+        }
+        if (m_transactionOwner.load() == std::this_thread::get_id()) {
+            throw std::runtime_error("Cannot pack growth snapshots inside a transaction");
+        }
+    }
+    std::vector<int> owners;
+    {
+        auto reader = acquireReader();
+        auto stmt = reader.prepare(kSelectSnapshotOwnersToPackSql);
+        sqlite3_bind_int64(stmt.get(), 1, static_cast<sqlite3_int64>(cutoffMs));
+        sqlite3_bind_int64(stmt.get(), 2, static_cast<sqlite3_int64>(policy.rowsPerBlock));
+        while (true) {
+            const int rc = sqlite3_step(stmt.get());
+            if (rc == SQLITE_ROW) {
+                owners.push_back(sqlite3_column_int(stmt.get(), 0));
+                continue;
+            }
+            if (rc == SQLITE_DONE) {
+                break;
+            }
+            throw std::runtime_error(buildErrorMessage("Failed to list snapshot owners", reader.handle()));
+        }
+    }
+    std::size_t packed = 0;
+    for (int ownerId : owners) {
+        while (packSnapshotBlock(ownerId, cutoffMs, policy.rowsPerBlock)) {
+            packed += policy.rowsPerBlock;
+        }
+    }
+    return packed;
+}
+
+bool DatabaseManager::packSnapshotBlock(int ownerId, std::int64_t cutoffMs, std::size_t rowsPerBlock) {
+    static const std::string selectSql = buildSnapshotPackSelectSql();
+    static const std::string deleteSql = buildSnapshotPackDeleteSql();
+    const auto bindCandidates = [&](sqlite3_stmt* statement) {
+        sqlite3_bind_int(statement, 1, ownerId);
+        sqlite3_bind_int64(statement, 2, static_cast<sqlite3_int64>(cutoffMs));
+        sqlite3_bind_int64(statement, 3, static_cast<sqlite3_int64>(rowsPerBlock));
+    };
+
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        SnapshotSeries rows;
+        rows.reserve(rowsPerBlock);
+        {
+            auto select = prepareStatement(selectSql);
+            bindCandidates(select.get());
+            SnapshotSeries::Row row{};
+            while (true) {
+                const int rc = sqlite3_step(select.get());
+                if (rc == SQLITE_DONE) {
+                    break;
+                }
+                if (rc != SQLITE_ROW) {
+                    throw std::runtime_error(buildErrorMessage("Failed to read snapshots to pack", m_db.get()));
+                }
+                for (std::size_t i = 0; i < kSnapshotColumnCount; ++i) {
+                    row[i] = sqlite3_column_int(select.get(), static_cast<int>(i + 1));
+                }
+                rows.append(sqlite3_column_int64(select.get(), 0), row);
+            }
+        }
+        if (rows.size() < rowsPerBlock) {
+            commitTransaction();
+            return false;
+        }
+        const std::string payload = series::encodeBlock(rows, 0, rows.size());
+        {
+            auto insert = prepareStatement(kInsertSnapshotBlockSql);
+            sqlite3_bind_int(insert.get(), 1, ownerId);
+            sqlite3_bind_int64(insert.get(), 2, static_cast<sqlite3_int64>(rows.timestamps().front()));
+            sqlite3_bind_int64(insert.get(), 3, static_cast<sqlite3_int64>(rows.timestamps().back()));
+            sqlite3_bind_int64(insert.get(), 4, static_cast<sqlite3_int64>(rows.size()));
+            sqlite3_bind_blob(insert.get(), 5, payload.data(), static_cast<int>(payload.size()), SQLITE_TRANSIENT);
+            if (sqlite3_step(insert.get()) != SQLITE_DONE) {
+                throw std::runtime_error(buildErrorMessage("Failed to insert snapshot block", m_db.get()));
+            }
+        }
+        {
+            auto erase = prepareStatement(deleteSql);
+            bindCandidates(erase.get());
+            if (sqlite3_step(erase.get()) != SQLITE_DONE) {
+                throw std::runtime_error(buildErrorMessage("Failed to delete packed snapshots", m_db.get()));
+            }
+        }
+        commitTransaction();
+        ROVE_COUNTER_ADD(Database, "snapshotBlocks.bytes", static_cast<std::uint64_t>(payload.size()));
+        return true;
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+}
+
+std::vector<DatabaseManager::LogDailySummaryRecord> DatabaseManager::queryLogDailySummaries(
+    int ownerId,
+    const std::optional<std::int64_t>& startMs,
+    const std::optional<std::int64_t>& endMs) const {
+    auto reader = acquireReader();
+    std::vector<std::int64_t> params{ownerId};
+    if (startMs.has_value()) {
+        params.push_back(*startMs);
+    }
+    if (endMs.has_value()) {
+        params.push_back(*endMs);
+    }
+    auto stmt = reader.prepare(buildLogDailySummariesSql(startMs.has_value(), endMs.has_value()));
+    for (std::size_t i = 0; i < params.size(); ++i) {
+        sqlite3_bind_int64(stmt.get(), static_cast<int>(i + 1), static_cast<sqlite3_int64>(params[i]));
+    }
+    std::vector<LogDailySummaryRecord> records;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            LogDailySummaryRecord record;
+            record.day = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0));
+            record.specialEvent = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 1));
+            record.entryCount = sqlite3_column_int(stmt.get(), 2);
+            record.levelChange = sqlite3_column_int(stmt.get(), 3);
+            record.firstTimestampMs = static_cast<std::int64_t>(sqlite3_column_int64(stmt.get(), 4));
+            record.lastTimestampMs = static_cast<std::int64_t>(sqlite3_column_int64(stmt.get(), 5));
+            records.push_back(std::move(record));
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to query log summaries", reader.handle()));
+    }
+    return records;
+}
+
+/**
+ * 中文说明：空闲页回收
+ * - 持有 m_mutex 即保证没有其他线程处于事务中（事务期间一直持有该锁）；
+ * - 每步只回收 kReclaimPagesPerStep 页，步与步之间释放写锁，等待中的写者可以插入，维护不会长时间独占写连接；
+ * - 旧库在 convertToIncrementalVacuum 完成转换之前不是增量模式，这里直接返回；
+ * - 结束后以 TRUNCATE 检查点收缩 WAL，否则被回收的空间仍留在 -wal 文件中。
+ */
+std::int64_t DatabaseManager::reclaimFreePages(std::int64_t maxPages) {
+    constexpr std::int64_t kReclaimPagesPerStep = 64;
+    constexpr std::int64_t kIncrementalAutoVacuum = 2;
+    std::int64_t reclaimed = 0;
+    while (reclaimed < maxPages) {
+        std::lock_guard<WriterMutex> lock(m_mutex);
+        if (m_db == nullptr) {
+            throw std::runtime_error("Database is not initialized");
+        }
+        if (m_transactionOwner.load() == std::this_thread::get_id()) {
+            throw std::runtime_error("Cannot reclaim pages inside a transaction");
+        }
+        const std::int64_t before = readPragmaInteger("PRAGMA freelist_count");
+        if (before == 0 || readPragmaInteger("PRAGMA auto_vacuum") != kIncrementalAutoVacuum) {
+            break;
+        }
+        const std::int64_t step = std::min(kReclaimPagesPerStep, maxPages - reclaimed);
+        executeNonQuery("PRAGMA incremental_vacuum(" + std::to_string(step) + ");");
+        const std::int64_t freed = before - readPragmaInteger("PRAGMA freelist_count");
+        if (freed <= 0) {
+            break;
+        }
+        reclaimed += freed;
+    }
+    if (reclaimed > 0) {
+        std::lock_guard<WriterMutex> lock(m_mutex);
+        executeNonQuery("PRAGMA wal_checkpoint(TRUNCATE);");
+    }
+    return reclaimed;
+}
+
+/**
+ * 中文说明：旧库转换为增量 auto_vacuum
+ * - 只能经一次完整 VACUUM 完成，期间持有写锁并重写整个文件；
+ * - 空闲页不足 minFreePages 时 VACUUM 主要是在复制仍在使用的数据，不值得付出这次重写，保持原模式；
+ * - 由空闲维护在日志归档释放页之后调用，启动流程不会执行。
+ */
+bool DatabaseManager::convertToIncrementalVacuum(std::int64_t minFreePages) {
+    constexpr std::int64_t kIncrementalAutoVacuum = 2;
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    if (m_db == nullptr) {
+        throw std::runtime_error("Database is not initialized");
+    }
+    if (m_transactionOwner.load() == std::this_thread::get_id()) {
+        throw std::runtime_error("Cannot vacuum inside a transaction");
+    }
+    if (readPragmaInteger("PRAGMA auto_vacuum") == kIncrementalAutoVacuum) {
+        return true;
+    }
+    if (readPragmaInteger("PRAGMA freelist_count") < minFreePages) {
+        return false;
+    }
+    ROVE_SCOPED_TIMER(Database, "maintenance.vacuumConversion");
+    executeNonQuery("PRAGMA auto_vacuum = INCREMENTAL;");
+    executeNonQuery("VACUUM;");
+    executeNonQuery("PRAGMA wal_checkpoint(TRUNCATE);");
+    return readPragmaInteger("PRAGMA auto_vacuum") == kIncrementalAutoVacuum;
+}
+
+std::vector<std::string> DatabaseManager::listMaintenanceTables() const {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    auto stmt = prepareStatement(
+        "SELECT name FROM sqlite_master WHERE type = 'table' AND name NOT LIKE 'sqlite_%' "
+        "AND sql NOT LIKE 'CREATE VIRTUAL TABLE%' ORDER BY name");
+    std::vector<std::string> tables;
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+        tables.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0)));
+    }
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to list tables", m_db.get()));
+    }
+    return tables;
+}
+
+/**
+ * 中文说明：预算只在表与表之间检查，单张表的处理不可中断；写锁逐表获取，空闲维护不会长时间独占写连接。
+ */
+DatabaseManager::MaintenanceProgress DatabaseManager::runPerTable(
+    std::size_t firstTable,
+    std::chrono::milliseconds budget,
+    const std::function<void(const std::string&, MaintenanceProgress&)>& step) {
+    const std::vector<std::string> tables = listMaintenanceTables();
+    MaintenanceProgress progress;
+    progress.tableCount = tables.size();
+    progress.nextTable = std::min(firstTable, tables.size());
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    while (progress.nextTable < tables.size()) {
+        {
+            std::lock_guard<WriterMutex> lock(m_mutex);
+            step(tables[progress.nextTable], progress);
+        }
+        ++progress.nextTable;
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+    }
+    return progress;
+}
+
+DatabaseManager::MaintenanceProgress DatabaseManager::analyzeTables(std::size_t firstTable,
+                                                                    std::chrono::milliseconds budget) {
+    ROVE_SCOPED_TIMER(Database, "maintenance.analyze");
+    {
+        std::lock_guard<WriterMutex> lock(m_mutex);
+        if (m_db == nullptr) {
+            throw std::runtime_error("Database is not initialized");
+        }
+        executeNonQuery("PRAGMA analysis_limit = " + std::to_string(kAnalysisLimitRows) + ";");
+    }
+    return runPerTable(firstTable, budget, [this](const std::string& table, MaintenanceProgress&) {
+        executeNonQuery("ANALYZE " + quoteSqlIdentifier(table) + ";");
+    });
+}
+
+DatabaseManager::MaintenanceProgress DatabaseManager::quickCheckTables(std::size_t firstTable,
+                                                                       std::chrono::milliseconds budget) {
+    ROVE_SCOPED_TIMER(Database, "maintenance.quickCheck");
+    return runPerTable(firstTable, budget, [this](const std::string& table, MaintenanceProgress& progress) {
+        auto stmt = prepareStatement("SELECT quick_check FROM pragma_quick_check(?)");
+        sqlite3_bind_text(stmt.get(), 1, table.c_str(), -1, SQLITE_TRANSIENT);
+        int rc = SQLITE_ROW;
+        while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+            const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0));
+            const std::string_view message = text != nullptr ? text : "";
+            if (message != "ok") {
+                progress.problems.push_back(table + ": " + std::string(message));
+            }
+        }
+        if (rc != SQLITE_DONE) {
+            throw std::runtime_error(buildErrorMessage("Failed to check table " + table, m_db.get()));
+        }
+    });
+}
+
+void DatabaseManager::optimizeQueryPlanner() {
+    ROVE_SCOPED_TIMER(Database, "maintenance.optimize");
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    if (m_db == nullptr) {
+        throw std::runtime_error("Database is not initialized");
+    }
+    executeNonQuery("PRAGMA analysis_limit = " + std::to_string(kAnalysisLimitRows) + ";");
+    executeNonQuery("PRAGMA optimize;");
+}
+
+/**
+ * 中文说明：TRUNCATE 需要等待所有读者离开 WAL；只读连接池中的查询持有旧快照时返回 SQLITE_BUSY，
+ *          此时改做 PASSIVE，把能写回的帧先写回，截断留到下一次空闲。
+ */
+DatabaseManager::WalCheckpointResult DatabaseManager::checkpointWal() {
+    ROVE_SCOPED_TIMER(Database, "maintenance.checkpoint");
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    if (m_db == nullptr) {
+        throw std::runtime_error("Database is not initialized");
+    }
+    if (m_transactionOwner.load() == std::this_thread::get_id()) {
+        throw std::runtime_error("Cannot checkpoint inside a transaction");
+    }
+    WalCheckpointResult result;
+    int rc = sqlite3_wal_checkpoint_v2(m_db.get(), nullptr, SQLITE_CHECKPOINT_TRUNCATE, &result.walFrames,
+                                       &result.checkpointedFrames);
+    result.truncated = rc == SQLITE_OK;
+    if (rc == SQLITE_BUSY) {
+        rc = sqlite3_wal_checkpoint_v2(m_db.get(), nullptr, SQLITE_CHECKPOINT_PASSIVE, &result.walFrames,
+                                       &result.checkpointedFrames);
+    }
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error(buildErrorMessage("Failed to checkpoint WAL", m_db.get()));
+    }
+    return result;
+}
+
+/**
+ * 中文说明：档案导出
+ * - 读连接上显式开启读事务，计数与逐表读取看到同一个 WAL 快照，导出期间的写入不会让行数与表头不符；
+ * - 调用线程持有写事务时租约回退到写连接，直接沿用该事务；
+ * - 列名取自语句本身，导入方按列名而非列序号写入，列顺序不同的库之间同样可以迁移。
+ */
+DatabaseManager::ProfileTransferReport DatabaseManager::exportUserProfile(int userId,
+                                                                          std::ostream& out,
+                                                                          const ProfileProgress& progress) const {
+    ROVE_SCOPED_TIMER(Database, "profile.export");
+    auto reader = acquireReader();
+    sqlite3* handle = reader.handle();
+    struct ReadSnapshot {
+        sqlite3* handle;
+        bool active;
+        ~ReadSnapshot() {
+            if (active) {
+                sqlite3_exec(handle, "COMMIT;", nullptr, nullptr, nullptr);
+            }
+        }
+    } snapshot{handle, sqlite3_get_autocommit(handle) != 0};
+    if (snapshot.active && sqlite3_exec(handle, "BEGIN;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        snapshot.active = false;
+        throw std::runtime_error(buildErrorMessage("Failed to begin profile export", handle));
+    }
+
+    ProfileArchiveHeader header;
+    header.schemaVersion = static_cast<std::uint32_t>(kSchemaVersion);
+    header.sourceUserId = userId;
+    header.exportedAtMs = QDateTime::currentMSecsSinceEpoch();
+    std::vector<std::uint64_t> counts;
+    for (const auto& table : kProfileTables) {
+        auto stmt = reader.prepare("SELECT COUNT(1) FROM (" + profileSelectSql(table) + ")");
+        sqlite3_bind_int(stmt.get(), 1, userId);
+        if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+            throw std::runtime_error(buildErrorMessage(std::string("Failed to count ") + table.name, handle));
+        }
+        counts.push_back(static_cast<std::uint64_t>(sqlite3_column_int64(stmt.get(), 0)));
+        header.totalRows += counts.back();
+    }
+    if (counts.front() == 0) {
+        throw std::runtime_error("Cannot export profile of unknown user " + std::to_string(userId));
+    }
+
+    ProfileArchiveWriter writer(out, header);
+    ProfileTransferReport report;
+    for (std::size_t i = 0; i < std::size(kProfileTables); ++i) {
+        auto stmt = reader.prepare(profileSelectSql(kProfileTables[i]));
+        sqlite3_bind_int(stmt.get(), 1, userId);
+        ProfileArchiveTable archived;
+        archived.name = kProfileTables[i].name;
+        archived.rowCount = counts[i];
+        const int columnCount = sqlite3_column_count(stmt.get());
+        for (int column = 0; column < columnCount; ++column) {
+            archived.columns.emplace_back(sqlite3_column_name(stmt.get(), column));
+        }
+        writer.beginTable(archived);
+        int rc = SQLITE_ROW;
+        while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW) {
+            for (int column = 0; column < columnCount; ++column) {
+                switch (sqlite3_column_type(stmt.get(), column)) {
+                case SQLITE_INTEGER:
+                    writer.putInteger(sqlite3_column_int64(stmt.get(), column));
+                    break;
+                case SQLITE_FLOAT:
+                    writer.putReal(sqlite3_column_double(stmt.get(), column));
+                    break;
+                case SQLITE_TEXT:
+                    writer.putText({reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), column)),
+                                    static_cast<std::size_t>(sqlite3_column_bytes(stmt.get(), column))});
+                    break;
+                case SQLITE_BLOB: {
+                    const auto* data = static_cast<const char*>(sqlite3_column_blob(stmt.get(), column));
+                    writer.putBlob({data != nullptr ? data : "",
+                                    static_cast<std::size_t>(sqlite3_column_bytes(stmt.get(), column))});
+                    break;
+                }
+                default:
+                    writer.putNull();
+                    break;
+                }
+            }
+            writer.endRow();
+            if (++report.rows % kProfileProgressRows == 0) {
+                if (!writer.ok()) {
+                    throw std::runtime_error("Failed to write profile archive");
+                }
+                if (progress && !progress(report.rows, header.totalRows)) {
+                    report.cancelled = true;
+                    return report;
+                }
+            }
+        }
+        if (rc != SQLITE_DONE) {
+            throw std::runtime_error(buildErrorMessage(std::string("Failed to export ") + archived.name, handle));
+        }
+        ++report.tables;
+    }
+    writer.finish();
+    if (!writer.ok()) {
+        throw std::runtime_error("Failed to write profile archive");
+    }
+    if (progress) {
+        progress(report.rows, header.totalRows);
+    }
+    return report;
+}
+
+DatabaseManager::ProfileTransferReport DatabaseManager::importUserProfile(int userId,
+                                                                          std::istream& in,
+                                                                          const ProfileProgress& progress) {
+    ROVE_SCOPED_TIMER(Database, "profile.import");
+    ProfileArchiveReader archive(in);
+    const ProfileArchiveHeader header = archive.header();
+    if (header.schemaVersion > static_cast<std::uint32_t>(kSchemaVersion)) {
+        throw std::runtime_error("Profile archive schema version " + std::to_string(header.schemaVersion) +
+                                 " is newer than " + std::to_string(kSchemaVersion));
+    }
+    ProfileTransferReport report;
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        // 中文：外键在提交时统一检查，表之间的写入顺序不受引用关系约束。
+        executeNonQuery("PRAGMA defer_foreign_keys = ON;");
+        {
+            auto stmt = prepareStatement("SELECT 1 FROM users WHERE id = ?");
+            sqlite3_bind_int(stmt.get(), 1, userId);
+            if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+                throw std::runtime_error("Cannot import profile into unknown user " + std::to_string(userId));
+            }
+        }
+        for (auto it = std::rbegin(kProfileTables); it != std::rend(kProfileTables); ++it) {
+            const std::string purge = profilePurgeSql(*it);
+            if (purge.empty()) {
+                continue;
+            }
+            auto stmt = prepareStatement(purge);
+            sqlite3_bind_int(stmt.get(), 1, userId);
+            if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+                throw std::runtime_error(buildErrorMessage(std::string("Failed to clear ") + it->name, m_db.get()));
+            }
+        }
+        ProfileArchiveTable table;
+        while (archive.nextTable(table)) {
+            if (!importProfileTable(table, archive, userId, header.sourceUserId, header.totalRows, report.rows,
+                                    progress)) {
+                report.cancelled = true;
+                break;
+            }
+            ++report.tables;
+        }
+        if (report.cancelled) {
+            rollbackTransaction();
+            return report;
+        }
+        commitTransaction();
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
     }
-    if (rc == SQLITE_DONE) {
-        return std::nullopt;
+    if (progress) {
+        progress(report.rows, header.totalRows);
     }
-    throw std::runtime_error(buildErrorMessage("Failed to query user", m_db.get()));
+    return report;
 }
 
 /**
- * @brief Update the level column for a user.
- * 中文：更新指定用户的等级字段。
- *
- * Business logic: splitting updates by field keeps UI actions granular and simple to audit in logs.
- * 中文：按字段拆分更新，便于界面精细控制并在日志中记录操作。
- *
- * @param username Target username. 中文：目标用户名。
- * @param newLevel Desired level. 中文：新等级。
- * @return true if a row changed. 中文：若有行被更新返回 true。
- * @throws std::runtime_error When SQLite update fails. 中文：更新失败抛出异常。
+ * 中文说明：按列名写入，只校验档案中的列在当前表中存在，当前表多出的列取默认值（旧版本导出的档案照常导入）。
+ *          删除的二级索引在本表写完后以原建表语句重建，一次排序建索引比逐行维护 B 树快得多；
+ *          主键与唯一约束由 sqlite_autoindex 承担（sql 为 NULL），不受影响，冲突仍在插入时立即报告。
  */
-bool DatabaseManager::updateUserLevel(const std::string& username, int newLevel) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql = "UPDATE users SET level = ? WHERE username = ?";
+bool DatabaseManager::importProfileTable(const ProfileArchiveTable& table,
+                                         ProfileArchiveReader& archive,
+                                         int userId,
+                                         int sourceUserId,
+                                         std::uint64_t totalRows,
+                                         std::uint64_t& done,
+                                         const ProfileProgress& progress) {
+    const auto spec = std::find_if(std::begin(kProfileTables), std::end(kProfileTables),
+                                   [&table](const ProfileTable& candidate) { return table.name == candidate.name; });
+    if (spec == std::end(kProfileTables)) {
+        throw std::runtime_error("Unknown table in profile archive: " + table.name);
+    }
+    std::vector<std::string> existing;
+    {
+        auto stmt = prepareStatement("SELECT name FROM pragma_table_info(?)");
+        sqlite3_bind_text(stmt.get(), 1, table.name.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+            existing.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0)));
+        }
+    }
+    for (const auto& column : table.columns) {
+        if (std::find(existing.begin(), existing.end(), column) == existing.end()) {
+            throw std::runtime_error("Profile archive column " + table.name + "." + column + " does not exist");
+        }
+    }
+
+    const bool isUsers = table.name == "users";
+    const bool isAppState = table.name == "app_state";
+    std::string sql;
+    if (isUsers) {
+        sql = "UPDATE users SET ";
+        for (std::size_t i = 0; i < table.columns.size(); ++i) {
+            sql += (i == 0 ? "" : ", ") + quoteSqlIdentifier(table.columns[i]) + " = ?";
+        }
+        sql += " WHERE id = ?";
+    } else {
+        std::string placeholders;
+        sql = "INSERT INTO " + quoteSqlIdentifier(table.name) + " (";
+        for (std::size_t i = 0; i < table.columns.size(); ++i) {
+            sql += (i == 0 ? "" : ", ") + quoteSqlIdentifier(table.columns[i]);
+            placeholders += i == 0 ? "?" : ", ?";
+        }
+        sql += ") VALUES (" + placeholders + ")";
+    }
+
+    std::vector<std::pair<std::string, std::string>> deferredIndexes;
+    if (table.rowCount >= kProfileDeferIndexRows) {
+        auto stmt = prepareStatement(
+            "SELECT name, sql FROM sqlite_master WHERE type = 'index' AND tbl_name = ? AND sql IS NOT NULL");
+        sqlite3_bind_text(stmt.get(), 1, table.name.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+            deferredIndexes.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0)),
+                                         reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 1)));
+        }
+    }
+    for (const auto& index : deferredIndexes) {
+        executeNonQuery("DROP INDEX " + quoteSqlIdentifier(index.first) + ";");
+    }
+
     auto stmt = prepareStatement(sql);
-    sqlite3_bind_int(stmt.get(), 1, newLevel);
-    sqlite3_bind_text(stmt.get(), 2, username.c_str(), -1, SQLITE_TRANSIENT);
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to update user level", m_db.get()));
+    const std::string keySuffix = ":" + std::to_string(userId);
+    std::vector<ProfileArchiveValue> row;
+    while (archive.nextRow(row)) {
+        for (std::size_t i = 0; i < row.size(); ++i) {
+            const int index = static_cast<int>(i) + 1;
+            const auto& column = table.columns[i];
+            auto& value = row[i];
+            if (column == "owner_id") {
+                sqlite3_bind_int(stmt.get(), index, userId);
+                continue;
+            }
+            if (column == "creator_id") {
+                if (value.type == ProfileArchiveValue::Type::Integer && value.integer == sourceUserId) {
+                    sqlite3_bind_int(stmt.get(), index, userId);
+                } else {
+                    sqlite3_bind_null(stmt.get(), index);
+                }
+                continue;
+            }
+            if (isAppState && column == "key") {
+                value.bytes += keySuffix;
+            }
+            switch (value.type) {
+            case ProfileArchiveValue::Type::Integer:
+                sqlite3_bind_int64(stmt.get(), index, value.integer);
+                break;
+            case ProfileArchiveValue::Type::Real:
+                sqlite3_bind_double(stmt.get(), index, value.real);
+                break;
+            case ProfileArchiveValue::Type::Text:
+                sqlite3_bind_text(stmt.get(), index, value.bytes.data(), static_cast<int>(value.bytes.size()),
+                                  SQLITE_STATIC);
+                break;
+            case ProfileArchiveValue::Type::Blob:
+                sqlite3_bind_blob(stmt.get(), index, value.bytes.data(), static_cast<int>(value.bytes.size()),
+                                  SQLITE_STATIC);
+                break;
+            case ProfileArchiveValue::Type::Null:
+                sqlite3_bind_null(stmt.get(), index);
+                break;
+            }
+        }
+        if (isUsers) {
+            sqlite3_bind_int(stmt.get(), static_cast<int>(row.size()) + 1, userId);
+        }
+        if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+            throw std::runtime_error(buildErrorMessage("Failed to import " + table.name, m_db.get()));
+        }
+        sqlite3_reset(stmt.get());
+        if (++done % kProfileProgressRows == 0 && progress && !progress(done, totalRows)) {
+            return false;
+        }
     }
-    return sqlite3_changes(m_db.get()) > 0;
+    for (const auto& index : deferredIndexes) {
+        executeNonQuery(index.second + ";");
+    }
+    // 中文：导入按原始列写入，不经过 insertLogRecord，写完后按用户一次性补录全文索引。
+    if (table.name == "logs" && m_logSearchIndexed) {
+        indexLogsForSearch(userId);
+    }
+    return true;
 }
 
 /**
- * @brief Update the currency column for a user.
- * 中文：更新指定用户的货币字段。
- *
- * Business logic: isolating currency updates simplifies implementing economic audits later.
- * 中文：单独的货币更新接口便于未来实现经济系统审计。
- *
- * @param username Target username. 中文：目标用户名。
- * @param newCurrency Desired currency. 中文：新的货币值。
- * @return true if a row changed. 中文：若有记录被更新返回 true。
- * @throws std::runtime_error When update fails. 中文：更新失败抛出异常。
+ * @brief 写入成长快照。
+ * 中文：在关键事件或定时任务后调用，捕获成长曲线。
  */
-bool DatabaseManager::updateUserCurrency(const std::string& username, int newCurrency) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql = "UPDATE users SET currency = ? WHERE username = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_int(stmt.get(), 1, newCurrency);
-    sqlite3_bind_text(stmt.get(), 2, username.c_str(), -1, SQLITE_TRANSIENT);
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to update user currency", m_db.get()));
+int DatabaseManager::insertGrowthSnapshot(const GrowthSnapshotRecord& record) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    const std::string sql =
+        "INSERT INTO growth_snapshots (timestamp, user_level, growth_points, execution, perseverance, decision, knowledge, social, pride, achievement_count, completed_tasks, failed_tasks, manual_log_count, timestamp_ms, owner_id) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        int newId = -1;
+        {
+            auto stmt = prepareStatement(sql);
+            sqlite3_bind_text(stmt.get(), 1, record.timestampIso.c_str(), -1, SQLITE_TRANSIENT);
+            bindSnapshotValues(stmt.get(), 2, record);
+            bindEpochMs(stmt.get(), 14, record.timestampIso);
+            sqlite3_bind_int(stmt.get(), 15, record.ownerId);
+            int rc = sqlite3_step(stmt.get());
+            if (rc != SQLITE_DONE) {
+                throw std::runtime_error(buildErrorMessage("Failed to insert growth snapshot", m_db.get()));
+            }
+            newId = static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+        }
+        // 中文：原始行与聚合表在同一事务内写入，二者始终一致；时间无法解析的快照不知道该计入哪个时段，不进聚合表。
+        if (const auto timestampMs = isoToEpochMs(record.timestampIso)) {
+            upsertGrowthRollups(record, *timestampMs);
+        }
+        commitTransaction();
+        return newId;
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
+        }
+        throw;
     }
-    return sqlite3_changes(m_db.get()) > 0;
 }
 
 /**
- * @brief Update serialized attribute data for a user.
- * 中文：更新用户的序列化属性数据。
- *
- * Business logic: attributes may store growth stats; keeping this as a blob allows flexible schema evolution.
- * 中文：属性字段可能存储成长数据，使用文本 blob 有助于未来灵活扩展。
- *
- * @param username Target username. 中文：目标用户名。
- * @param newAttributes Serialized attribute string. 中文：新的序列化属性字符串。
- * @return true if a row changed. 中文：若有行被更新返回 true。
- * @throws std::runtime_error When update fails. 中文：更新失败抛出异常。
+ * @brief 查询某用户的成长快照。
+ * 中文：可按时间区间提取用于可视化和压缩。
  */
-bool DatabaseManager::updateUserAttributes(const std::string& username,
-                                           const std::string& newAttributes) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql = "UPDATE users SET attributes = ? WHERE username = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, newAttributes.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 2, username.c_str(), -1, SQLITE_TRANSIENT);
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to update user attributes", m_db.get()));
+std::vector<DatabaseManager::GrowthSnapshotRecord> DatabaseManager::queryGrowthSnapshots(int ownerId,
+                                                                                     const std::optional<std::int64_t>& startMs,
+                                                                                     const std::optional<std::int64_t>& endMs) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(buildRawSnapshotRecordsSql(startMs.has_value(), endMs.has_value()));
+    bindTimelineRange(stmt.get(), ownerId, startMs, endMs);
+    std::vector<GrowthSnapshotRecord> records;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            if (sqlite3_column_type(stmt.get(), 15) == SQLITE_BLOB) {
+                // 中文：打包的快照不再有行号与原始时间文本，与聚合行一样 id 为 -1，时间文本由毫秒时间戳还原。
+                SnapshotSeries packed;
+                decodeTimelineBlock(stmt.get(), 15, startMs, endMs, packed);
+                for (std::size_t i = 0; i < packed.size(); ++i) {
+                    const auto row = packed.row(i);
+                    GrowthSnapshotRecord record;
+                    record.ownerId = ownerId;
+                    record.timestampMs = packed.timestamps()[i];
+                    record.timestampIso =
+                        QDateTime::fromMSecsSinceEpoch(record.timestampMs).toString(Qt::ISODate).toStdString();
+                    int* const fields[] = {&record.userLevel,      &record.growthPoints,  &record.execution,
+                                           &record.perseverance,   &record.decision,      &record.knowledge,
+                                           &record.social,         &record.pride,         &record.achievementCount,
+                                           &record.completedTasks, &record.failedTasks,   &record.manualLogCount};
+                    for (std::size_t c = 0; c < kSnapshotColumnCount; ++c) {
+                        *fields[c] = row[c];
+                    }
+                    records.push_back(std::move(record));
+                }
+                continue;
+            }
+            records.push_back(readGrowthSnapshotRecord(stmt.get()));
+            records.back().ownerId = ownerId;
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to query growth snapshots", reader.handle()));
     }
-    return sqlite3_changes(m_db.get()) > 0;
+    const auto byTime = [](const GrowthSnapshotRecord& a, const GrowthSnapshotRecord& b) {
+        return a.timestampMs < b.timestampMs;
+    };
+    if (!std::is_sorted(records.begin(), records.end(), byTime)) {
+        std::stable_sort(records.begin(), records.end(), byTime);
+    }
+    return records;
 }
 
 /**
- * @brief Delete a user row by username.
- * 中文：按用户名删除用户记录。
- *
- * Business logic: this helper allows the admin UI to reset test data quickly without writing SQL manually.
- * 中文：该接口让管理界面可以快速清理测试数据，无需手写 SQL。
- *
- * @param username Target username. 中文：目标用户名。
- * @return true if a row was removed. 中文：若删除了一行返回 true。
- * @throws std::runtime_error When delete fails. 中文：删除失败抛出异常。
+ * @brief 按分辨率查询成长时间线。
+ * 中文：聚合表以桶末快照时间过滤，按桶起点（主键）升序返回。
  */
-bool DatabaseManager::deleteUser(const std::string& username) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql = "DELETE FROM users WHERE username = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, username.c_str(), -1, SQLITE_TRANSIENT);
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to delete user", m_db.get()));
+std::vector<DatabaseManager::GrowthSnapshotRecord> DatabaseManager::queryGrowthTimeline(
+    int ownerId,
+    SnapshotResolution resolution,
+    const std::optional<std::int64_t>& startMs,
+    const std::optional<std::int64_t>& endMs) const {
+    const char* table = rollupTableFor(resolution);
+    if (table == nullptr) {
+        return queryGrowthSnapshots(ownerId, startMs, endMs);
     }
-    return sqlite3_changes(m_db.get()) > 0;
+    auto reader = acquireReader();
+    std::vector<std::int64_t> params{ownerId};
+    if (startMs.has_value()) {
+        params.push_back(*startMs);
+    }
+    if (endMs.has_value()) {
+        params.push_back(*endMs);
+    }
+    auto stmt = reader.prepare(buildRollupTimelineSql(table, "-1, last_timestamp", "last_timestamp_ms",
+                                                      startMs.has_value(), endMs.has_value()));
+    for (std::size_t i = 0; i < params.size(); ++i) {
+        sqlite3_bind_int64(stmt.get(), static_cast<int>(i + 1), static_cast<sqlite3_int64>(params[i]));
+    }
+    std::vector<GrowthSnapshotRecord> records;
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            records.push_back(readGrowthSnapshotRecord(stmt.get()));
+            records.back().ownerId = ownerId;
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to query growth timeline", reader.handle()));
+    }
+    return records;
 }
 
 /**
- * @brief 将 TaskRecord 插入数据库并返回行号。
- * 中文：任务创建流程统一走此接口，便于在 UI 中调用后得到主键用于后续编辑。
+ * @brief 列式读取成长时间线。
+ * 中文：只选取毫秒时间戳与数值列，先按 countGrowthTimeline 预留容量，读取过程中各列只做 push_back。
  */
-int DatabaseManager::createTask(const TaskRecord& task) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "INSERT INTO tasks (name, description, type, difficulty, deadline, completed, coin_reward, "
-        "growth_reward, attribute_reward, bonus_streak, custom_settings, forgiveness_coupons, "
-        "progress_value, progress_goal) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, task.name.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 2, task.description.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 3, task.type.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 4, task.difficulty);
-    sqlite3_bind_text(stmt.get(), 5, task.deadlineIso.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 6, task.completed ? 1 : 0);
-    sqlite3_bind_int(stmt.get(), 7, task.coinReward);
-    sqlite3_bind_int(stmt.get(), 8, task.growthReward);
-    sqlite3_bind_text(stmt.get(), 9, task.attributeReward.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 10, task.bonusStreak);
-    sqlite3_bind_text(stmt.get(), 11, task.customSettings.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 12, task.forgivenessCoupons);
-    sqlite3_bind_int(stmt.get(), 13, task.progressValue);
-    sqlite3_bind_int(stmt.get(), 14, task.progressGoal);
-
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to insert task", m_db.get()));
+SnapshotSeries DatabaseManager::querySnapshotSeries(int ownerId,
+                                                    SnapshotResolution resolution,
+                                                    const std::optional<std::int64_t>& startMs,
+                                                    const std::optional<std::int64_t>& endMs) const {
+    const char* table = rollupTableFor(resolution);
+    SnapshotSeries series;
+    series.reserve(countGrowthTimeline(ownerId, resolution, startMs, endMs));
+    auto reader = acquireReader();
+    if (table == nullptr) {
+        // 中文：快照块直接解码进各数值列，明细行逐列追加；两者同一语句读取，最后按时间归并。
+        auto stmt = reader.prepare(buildRawSnapshotSeriesSql(startMs.has_value(), endMs.has_value()));
+        bindTimelineRange(stmt.get(), ownerId, startMs, endMs);
+        SnapshotSeries::Row row{};
+        while (true) {
+            int rc = sqlite3_step(stmt.get());
+            if (rc == SQLITE_ROW) {
+                if (sqlite3_column_type(stmt.get(), 14) == SQLITE_BLOB) {
+                    decodeTimelineBlock(stmt.get(), 14, startMs, endMs, series);
+                    continue;
+                }
+                for (std::size_t i = 0; i < kSnapshotColumnCount; ++i) {
+                    row[i] = sqlite3_column_int(stmt.get(), static_cast<int>(i + 1));
+                }
+                series.append(sqlite3_column_int64(stmt.get(), 0), row);
+                continue;
+            }
+            if (rc == SQLITE_DONE) {
+                break;
+            }
+            throw std::runtime_error(buildErrorMessage("Failed to query snapshot series", reader.handle()));
+        }
+        sortSeriesByTime(series);
+        return series;
     }
-    return static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
-}
-
-int DatabaseManager::createAchievement(const AchievementRecord& record) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "INSERT INTO achievements (owner, creator, name, description, icon_path, display_color, type, "
-        "reward_type, progress_mode, progress_value, progress_goal, reward_coins, reward_attributes, "
-        "reward_items, unlocked, completion_time, conditions, gallery_group, created_at, special_metadata) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, record.owner.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 2, record.creator.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 3, record.name.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 4, record.description.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 5, record.iconPath.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 6, record.color.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 7, record.type.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 8, record.rewardType.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 9, record.progressMode.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 10, record.progressValue);
-    sqlite3_bind_int(stmt.get(), 11, record.progressGoal);
-    sqlite3_bind_int(stmt.get(), 12, record.rewardCoins);
-    sqlite3_bind_text(stmt.get(), 13, record.rewardAttributes.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 14, record.rewardItems.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 15, record.unlocked ? 1 : 0);
-    if (record.completionTime.empty()) {
-        sqlite3_bind_null(stmt.get(), 16);
-    } else {
-        sqlite3_bind_text(stmt.get(), 16, record.completionTime.c_str(), -1, SQLITE_TRANSIENT);
+    std::vector<std::int64_t> params{ownerId};
+    if (startMs.has_value()) {
+        params.push_back(*startMs);
     }
-    sqlite3_bind_text(stmt.get(), 17, record.conditions.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 18, record.galleryGroup.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 19, record.createdAt.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 20, record.specialMetadata.c_str(), -1, SQLITE_TRANSIENT);
-
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to create achievement", m_db.get()));
+    if (endMs.has_value()) {
+        params.push_back(*endMs);
     }
-    return static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+    auto stmt = reader.prepare(
+        buildRollupTimelineSql(table, "last_timestamp_ms", nullptr, startMs.has_value(), endMs.has_value()));
+    for (std::size_t i = 0; i < params.size(); ++i) {
+        sqlite3_bind_int64(stmt.get(), static_cast<int>(i + 1), static_cast<sqlite3_int64>(params[i]));
+    }
+    SnapshotSeries::Row row{};
+    while (true) {
+        int rc = sqlite3_step(stmt.get());
+        if (rc == SQLITE_ROW) {
+            for (std::size_t i = 0; i < kSnapshotColumnCount; ++i) {
+                row[i] = sqlite3_column_int(stmt.get(), static_cast<int>(i + 1));
+            }
+            series.append(sqlite3_column_int64(stmt.get(), 0), row);
+            continue;
+        }
+        if (rc == SQLITE_DONE) {
+            break;
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to query snapshot series", reader.handle()));
+    }
+    return series;
 }
 
 /**
- * @brief 根据 TaskRecord 更新数据库行，保持内存缓存与磁盘一致。
- * 中文：所有字段一次性写回，保证教师强调的数据一致性。
+ * @brief 统计某用户的时间线行数。
+ * 中文：原始表走 (owner_id, timestamp_ms) 索引，聚合表本身行数很少。
  */
-bool DatabaseManager::updateTask(const TaskRecord& task) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "UPDATE tasks SET name = ?, description = ?, type = ?, difficulty = ?, deadline = ?, completed = ?, "
-        "coin_reward = ?, growth_reward = ?, attribute_reward = ?, bonus_streak = ?, custom_settings = ?, "
-        "forgiveness_coupons = ?, progress_value = ?, progress_goal = ? WHERE id = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, task.name.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 2, task.description.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 3, task.type.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 4, task.difficulty);
-    sqlite3_bind_text(stmt.get(), 5, task.deadlineIso.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 6, task.completed ? 1 : 0);
-    sqlite3_bind_int(stmt.get(), 7, task.coinReward);
-    sqlite3_bind_int(stmt.get(), 8, task.growthReward);
-    sqlite3_bind_text(stmt.get(), 9, task.attributeReward.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 10, task.bonusStreak);
-    sqlite3_bind_text(stmt.get(), 11, task.customSettings.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 12, task.forgivenessCoupons);
-    sqlite3_bind_int(stmt.get(), 13, task.progressValue);
-    sqlite3_bind_int(stmt.get(), 14, task.progressGoal);
-    sqlite3_bind_int(stmt.get(), 15, task.id);
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to update task", m_db.get()));
+std::size_t DatabaseManager::countGrowthTimeline(int ownerId,
+                                                 SnapshotResolution resolution,
+                                                 const std::optional<std::int64_t>& startMs,
+                                                 const std::optional<std::int64_t>& endMs) const {
+    const char* table = rollupTableFor(resolution);
+    auto reader = acquireReader();
+    if (table == nullptr) {
+        // 中文：完全落在区间内的块直接累加行数，只有跨越区间边界的块（至多两块）需要解码。
+        auto stmt = reader.prepare(buildRawTimelineCountSql(startMs.has_value(), endMs.has_value()));
+        bindTimelineRange(stmt.get(), ownerId, startMs, endMs);
+        std::size_t total = 0;
+        while (true) {
+            int rc = sqlite3_step(stmt.get());
+            if (rc == SQLITE_ROW) {
+                if (sqlite3_column_type(stmt.get(), 1) == SQLITE_BLOB) {
+                    SnapshotSeries partial;
+                    decodeTimelineBlock(stmt.get(), 1, startMs, endMs, partial);
+                    total += partial.size();
+                } else {
+                    total += static_cast<std::size_t>(sqlite3_column_int64(stmt.get(), 0));
+                }
+                continue;
+            }
+            if (rc == SQLITE_DONE) {
+                break;
+            }
+            throw std::runtime_error(buildErrorMessage("Failed to count growth timeline", reader.handle()));
+        }
+        return total;
     }
-    return sqlite3_changes(m_db.get()) > 0;
-}
-
-bool DatabaseManager::updateAchievement(const AchievementRecord& record) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "UPDATE achievements SET owner = ?, creator = ?, name = ?, description = ?, icon_path = ?, "
-        "display_color = ?, type = ?, reward_type = ?, progress_mode = ?, progress_value = ?, "
-        "progress_goal = ?, reward_coins = ?, reward_attributes = ?, reward_items = ?, unlocked = ?, "
-        "completion_time = ?, conditions = ?, gallery_group = ?, created_at = ?, special_metadata = ? "
-        "WHERE id = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, record.owner.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 2, record.creator.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 3, record.name.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 4, record.description.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 5, record.iconPath.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 6, record.color.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 7, record.type.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 8, record.rewardType.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 9, record.progressMode.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 10, record.progressValue);
-    sqlite3_bind_int(stmt.get(), 11, record.progressGoal);
-    sqlite3_bind_int(stmt.get(), 12, record.rewardCoins);
-    sqlite3_bind_text(stmt.get(), 13, record.rewardAttributes.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 14, record.rewardItems.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 15, record.unlocked ? 1 : 0);
-    if (record.completionTime.empty()) {
-        sqlite3_bind_null(stmt.get(), 16);
-    } else {
-        sqlite3_bind_text(stmt.get(), 16, record.completionTime.c_str(), -1, SQLITE_TRANSIENT);
+    std::vector<std::int64_t> params{ownerId};
+    if (startMs.has_value()) {
+        params.push_back(*startMs);
+    }
+    if (endMs.has_value()) {
+        params.push_back(*endMs);
+    }
+    auto stmt = reader.prepare(buildRollupCountSql(table, startMs.has_value(), endMs.has_value()));
+    for (std::size_t i = 0; i < params.size(); ++i) {
+        sqlite3_bind_int64(stmt.get(), static_cast<int>(i + 1), static_cast<sqlite3_int64>(params[i]));
     }
-    sqlite3_bind_text(stmt.get(), 17, record.conditions.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 18, record.galleryGroup.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 19, record.createdAt.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 20, record.specialMetadata.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 21, record.id);
-
     int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to update achievement", m_db.get()));
+    if (rc != SQLITE_ROW) {
+        throw std::runtime_error(buildErrorMessage("Failed to count growth timeline", reader.handle()));
     }
-    return sqlite3_changes(m_db.get()) > 0;
+    return static_cast<std::size_t>(sqlite3_column_int64(stmt.get(), 0));
 }
 
 /**
- * @brief 根据任务 ID 删除记录。
- * 中文：提供统一删除入口，便于 TaskManager 在清理自定义任务时使用。
+ * @brief 返回某用户时间线起点（首个周聚合桶的起始日），没有快照时返回空。
+ * 中文：周聚合表以 (owner_id, bucket_start) 为主键，取首行只需一次索引查找，不随快照数量增长。
  */
-bool DatabaseManager::deleteTask(int taskId) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql = "DELETE FROM tasks WHERE id = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_int(stmt.get(), 1, taskId);
+std::optional<std::int64_t> DatabaseManager::growthTimelineStartMs(int ownerId) const {
+    auto reader = acquireReader();
+    auto stmt = reader.prepare(kSelectTimelineStartSql);
+    sqlite3_bind_int(stmt.get(), 1, ownerId);
     int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to delete task", m_db.get()));
+    if (rc == SQLITE_DONE || (rc == SQLITE_ROW && sqlite3_column_type(stmt.get(), 0) == SQLITE_NULL)) {
+        return std::nullopt;
     }
-    return sqlite3_changes(m_db.get()) > 0;
+    if (rc != SQLITE_ROW) {
+        throw std::runtime_error(buildErrorMessage("Failed to read growth timeline start", reader.handle()));
+    }
+    return static_cast<std::int64_t>(sqlite3_column_int64(stmt.get(), 0));
 }
 
-bool DatabaseManager::deleteAchievement(int achievementId) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql = "DELETE FROM achievements WHERE id = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_int(stmt.get(), 1, achievementId);
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to delete achievement", m_db.get()));
+/**
+ * @brief Begin an explicit transaction to guard multiple operations.
+ * 中文：开启显式事务以保护多条操作的原子性。
+ *
+ * Business logic: gameplay events often update level, currency, and logs simultaneously; using BEGIN ensures
+ * either all succeed or all fail. 中文：成长事件常需同时更新等级、货币与日志，事务可保证要么全部成功要么全部失败。
+ *
+ * @return void. 中文：无返回值。
+ * @throws std::runtime_error When SQLite cannot start the transaction. 中文：开启事务失败抛出异常。
+ */
+bool DatabaseManager::beginTransaction() {
+    // 中文：以所有者线程而非 owns_lock() 判断嵌套，其他线程持有事务时在此阻塞，而不是误并入对方的事务。
+    if (m_transactionOwner.load() != std::this_thread::get_id()) {
+        m_transactionLock = std::unique_lock<WriterMutex>(m_mutex);
+        try {
+            executeNonQuery("BEGIN TRANSACTION;");
+        } catch (...) {
+            releaseTransactionLock();
+            throw;
+        }
+        m_transactionDepth = 1;
+        m_transactionOwner.store(std::this_thread::get_id());
+        m_transactionStartedAt = metrics::startTiming();
+        return true;
     }
-    return sqlite3_changes(m_db.get()) > 0;
+    ++m_transactionDepth;
+    return false;
 }
 
 /**
- * @brief 根据主键查询任务。
- * 中文：配合 TaskManager::taskById 进行按需加载。
+ * @brief Commit the active transaction.
+ * 中文：提交当前事务。
+ *
+ * Business logic: committing here keeps ownership of transactional lifecycle inside DatabaseManager, so other
+ * modules don't have to send raw SQL strings. 中文：在此提交可让其他模块无需直接写 SQL 即可控制事务生命周期。
+ *
+ * @return void. 中文：无返回值。
+ * @throws std::runtime_error When commit fails. 中文：提交失败抛出异常。
  */
-std::optional<DatabaseManager::TaskRecord> DatabaseManager::getTaskById(int taskId) const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "SELECT id, name, description, type, difficulty, deadline, completed, coin_reward, growth_reward, "
-        "attribute_reward, bonus_streak, custom_settings, forgiveness_coupons, progress_value, progress_goal "
-        "FROM tasks WHERE id = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_int(stmt.get(), 1, taskId);
-    int rc = sqlite3_step(stmt.get());
-    if (rc == SQLITE_ROW) {
-        return readTaskRecord(stmt.get());
+void DatabaseManager::commitTransaction() {
+    if (m_transactionOwner.load() != std::this_thread::get_id()) {
+        throw std::runtime_error("No active transaction to commit");
     }
-    if (rc == SQLITE_DONE) {
-        return std::nullopt;
+    if (m_transactionDepth == 0) {
+        throw std::runtime_error("Transaction depth mismatch on commit");
+    }
+    if (m_transactionDepth == 1) {
+        // 中文：回调可能再次登记（例如写用户时触发的嵌套保存），循环直到清空。
+        while (!m_preCommitActions.empty()) {
+            auto actions = std::exchange(m_preCommitActions, {});
+            for (auto& entry : actions) {
+                entry.second();
+            }
+        }
+        executeNonQuery("COMMIT;");
+        m_transactionDepth = 0;
+        m_transactionOwner.store(std::thread::id());
+        m_rollbackActions.clear();
+        ROVE_RECORD_SINCE(Database, "transaction.commit", m_transactionStartedAt);
+        // 中文：先取出提交后回调再释放锁，之后其他线程开启的事务登记的回调不会混进来。
+        auto postCommit = std::exchange(m_postCommitActions, {});
+        releaseTransactionLock();
+        runSettledActions(postCommit, "Post-commit");
+        return;
     }
-    throw std::runtime_error(buildErrorMessage("Failed to query task", m_db.get()));
+    --m_transactionDepth;
 }
 
 /**
- * @brief 获取全部任务记录，供启动阶段初始化缓存。
- * 中文：一次性读取能减少频繁往返数据库，提高 UI 响应速度。
+ * @brief Roll back the active transaction, undoing uncommitted changes.
+ * 中文：回滚当前事务，撤销尚未提交的修改。
+ *
+ * Business logic: by exposing rollback we can safely abort when gameplay validation fails mid-way.
+ * 中文：暴露回滚功能后，当业务校验失败时可安全终止。
+ *
+ * @return void. 中文：无返回值。
+ * @throws std::runtime_error When rollback fails. 中文：回滚失败抛出异常。
  */
-std::vector<DatabaseManager::TaskRecord> DatabaseManager::getAllTasks() const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "SELECT id, name, description, type, difficulty, deadline, completed, coin_reward, growth_reward, "
-        "attribute_reward, bonus_streak, custom_settings, forgiveness_coupons, progress_value, progress_goal "
-        "FROM tasks";
-    auto stmt = prepareStatement(sql);
-    std::vector<TaskRecord> records;
-    while (true) {
-        int rc = sqlite3_step(stmt.get());
-        if (rc == SQLITE_ROW) {
-            records.push_back(readTaskRecord(stmt.get()));
-            continue;
-        }
-        if (rc == SQLITE_DONE) {
-            break;
-        }
-        throw std::runtime_error(buildErrorMessage("Failed to read task list", m_db.get()));
+void DatabaseManager::rollbackTransaction() {
+    if (m_transactionOwner.load() != std::this_thread::get_id()) {
+        return;  // 中文：若当前没有事务则无需处理，防止双重回滚导致崩溃。
     }
-    return records;
+    m_transactionDepth = 0;
+    m_transactionOwner.store(std::thread::id());
+    m_preCommitActions.clear();
+    m_postCommitActions.clear();
+    std::vector<std::function<void()>> restore;
+    restore.reserve(m_rollbackActions.size());
+    for (auto& entry : std::exchange(m_rollbackActions, {})) {
+        restore.push_back(std::move(entry.second));
+    }
+    try {
+        executeNonQuery("ROLLBACK;");
+    } catch (...) {
+        releaseTransactionLock();
+        runSettledActions(restore, "Rollback");
+        throw;
+    }
+    ROVE_RECORD_SINCE(Database, "transaction.rollback", m_transactionStartedAt);
+    // 中文：回滚回调在释放写连接锁之后执行，可以开启新事务重新装载缓存。
+    releaseTransactionLock();
+    runSettledActions(restore, "Rollback");
 }
 
-std::vector<DatabaseManager::AchievementRecord> DatabaseManager::getAchievementsForOwner(
-    const std::string& owner) const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "SELECT id, owner, creator, name, description, icon_path, display_color, type, reward_type, "
-        "progress_mode, progress_value, progress_goal, reward_coins, reward_attributes, reward_items, "
-        "unlocked, completion_time, conditions, gallery_group, created_at, special_metadata "
-        "FROM achievements WHERE owner = ? ORDER BY id";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, owner.c_str(), -1, SQLITE_TRANSIENT);
-    std::vector<AchievementRecord> records;
-    while (true) {
-        int rc = sqlite3_step(stmt.get());
-        if (rc == SQLITE_ROW) {
-            records.push_back(readAchievementRecord(stmt.get()));
-            continue;
-        }
-        if (rc == SQLITE_DONE) {
-            break;
+/**
+ * @brief Run work in a (possibly nested) transaction.
+ * 中文：嵌套调用时 commitTransaction 只配平深度，真正的提交或回滚由最外层决定。
+ *
+ * @param work Statements to run. 中文：事务内执行的操作。
+ * @return void. 中文：无返回值。
+ * @throws Whatever begin/commit or @p work throws. 中文：透传异常。
+ */
+void DatabaseManager::runInTransaction(const std::function<void()>& work) {
+    bool transactionStarted = false;
+    try {
+        transactionStarted = beginTransaction();
+        work();
+        commitTransaction();
+    } catch (...) {
+        if (transactionStarted) {
+            try {
+                rollbackTransaction();
+            } catch (...) {
+            }
         }
-        throw std::runtime_error(buildErrorMessage("Failed to read achievements", m_db.get()));
+        throw;
     }
-    return records;
 }
 
-int DatabaseManager::insertShopItem(const ShopItemRecord& record) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "INSERT INTO shop_items (name, description, icon_path, item_type, price_coins, purchase_limit, "
-        "available, effect_description, effect_logic, prop_effect_type, prop_duration_minutes, "
-        "usage_conditions, physical_redeem, physical_notes, lucky_rules, level_requirement) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, record.name.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 2, record.description.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 3, record.iconPath.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 4, record.itemType.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 5, record.priceCoins);
-    sqlite3_bind_int(stmt.get(), 6, record.purchaseLimit);
-    sqlite3_bind_int(stmt.get(), 7, record.available ? 1 : 0);
-    sqlite3_bind_text(stmt.get(), 8, record.effectDescription.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 9, record.effectLogic.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 10, record.propEffectType.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 11, record.propDurationMinutes);
-    sqlite3_bind_text(stmt.get(), 12, record.usageConditions.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 13, record.physicalRedeem.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 14, record.physicalNotes.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 15, record.luckyBagRules.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 16, record.levelRequirement);
-    int rc = sqlite3_step(stmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to insert shop item", m_db.get()));
-    }
-    return static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+/**
+ * @brief Release the transaction mutex held by the calling thread.
+ * 中文：先把锁移出成员再解锁；若直接 unlock()，其他线程可能在成员的 owns 标志清除前就取得互斥量并改写成员。
+ *
+ * @return void. 中文：无返回值。
+ */
+void DatabaseManager::releaseTransactionLock() {
+    std::unique_lock<WriterMutex> lock(std::move(m_transactionLock));
+    lock.unlock();
 }
 
-bool DatabaseManager::updateShopItem(const ShopItemRecord& record) {
-    if (record.id < 0) {
-        throw std::runtime_error("Invalid shop item id");
+/**
+ * @brief Defer a write until the outermost commit, or run it now outside a transaction.
+ * 中文：若当前线程持有事务则登记到提交前执行（同 key 覆盖旧登记），否则立即执行。
+ *
+ * @param key Deduplication key. 中文：去重键。
+ * @param action Deferred write. 中文：延迟写操作。
+ * @return void. 中文：无返回值。
+ * @throws Whatever the action throws when run immediately. 中文：立即执行时透传回调异常。
+ */
+void DatabaseManager::deferUntilCommit(const void* key, std::function<void()> action) {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    if (m_transactionOwner.load() != std::this_thread::get_id()) {
+        action();
+        return;
     }
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "UPDATE shop_items SET name = ?, description = ?, icon_path = ?, item_type = ?, price_coins = ?, "
-        "purchase_limit = ?, available = ?, effect_description = ?, effect_logic = ?, prop_effect_type = ?, "
-        "prop_duration_minutes = ?, usage_conditions = ?, physical_redeem = ?, physical_notes = ?, "
-        "lucky_rules = ?, level_requirement = ? WHERE id = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, record.name.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 2, record.description.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 3, record.iconPath.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 4, record.itemType.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 5, record.priceCoins);
-    sqlite3_bind_int(stmt.get(), 6, record.purchaseLimit);
-    sqlite3_bind_int(stmt.get(), 7, record.available ? 1 : 0);
-    sqlite3_bind_text(stmt.get(), 8, record.effectDescription.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 9, record.effectLogic.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 10, record.propEffectType.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 11, record.propDurationMinutes);
-    sqlite3_bind_text(stmt.get(), 12, record.usageConditions.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 13, record.physicalRedeem.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 14, record.physicalNotes.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 15, record.luckyBagRules.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 16, record.levelRequirement);
-    sqlite3_bind_int(stmt.get(), 17, record.id);
-    int rc = sqlite3_step(stmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to update shop item", m_db.get()));
+    for (auto& entry : m_preCommitActions) {
+        if (entry.first == key) {
+            entry.second = std::move(action);
+            return;
+        }
     }
-    return sqlite3_changes(m_db.get()) > 0;
+    m_preCommitActions.emplace_back(key, std::move(action));
 }
 
-bool DatabaseManager::deleteShopItem(int itemId) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql = "DELETE FROM shop_items WHERE id = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_int(stmt.get(), 1, itemId);
-    int rc = sqlite3_step(stmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to delete shop item", m_db.get()));
+/**
+ * @brief Queue @p action for after the outermost commit, or run it now outside a transaction.
+ * 中文：只有事务所有者线程会访问登记表，无需加锁；嵌套调用登记到同一张表，由最外层提交统一执行。
+ *
+ * @param action Post-commit side effect. 中文：提交后执行的副作用。
+ * @return void. 中文：无返回值。
+ * @throws Whatever the action throws when run immediately. 中文：立即执行时透传回调异常。
+ */
+void DatabaseManager::runAfterCommit(std::function<void()> action) {
+    if (!inTransaction()) {
+        action();
+        return;
     }
-    return sqlite3_changes(m_db.get()) > 0;
+    m_postCommitActions.push_back(std::move(action));
 }
 
-std::optional<DatabaseManager::ShopItemRecord> DatabaseManager::getShopItemById(int itemId) const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "SELECT id, name, description, icon_path, item_type, price_coins, purchase_limit, available, "
-        "effect_description, effect_logic, prop_effect_type, prop_duration_minutes, usage_conditions, "
-        "physical_redeem, physical_notes, lucky_rules, level_requirement FROM shop_items WHERE id = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_int(stmt.get(), 1, itemId);
-    int rc = sqlite3_step(stmt.get());
-    if (rc == SQLITE_ROW) {
-        return readShopItemRecord(stmt.get());
-    }
-    if (rc == SQLITE_DONE) {
-        return std::nullopt;
+/**
+ * @brief Queue @p action for after the outermost transaction rolls back; no-op outside a transaction.
+ * 中文：与 deferUntilCommit 相同按 key 去重，同一管理器在一个事务内多次改动缓存只登记一次恢复；
+ *       事务提交时登记被丢弃。只有事务所有者线程会访问登记表，无需加锁。
+ *
+ * @param key Deduplication key. 中文：去重键。
+ * @param action Cache restore. 中文：撤销缓存改动的回调。
+ * @return true if this call registered @p key. 中文：本次调用新登记了该 key 时返回 true。
+ * @throws None. 中文：不抛出异常（登记表扩容失败除外）。
+ */
+bool DatabaseManager::runOnRollback(const void* key, std::function<void()> action) {
+    if (!inTransaction()) {
+        return false;
     }
-    throw std::runtime_error(buildErrorMessage("Failed to query shop item", m_db.get()));
-}
-
-std::vector<DatabaseManager::ShopItemRecord> DatabaseManager::getAllShopItems() const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "SELECT id, name, description, icon_path, item_type, price_coins, purchase_limit, available, "
-        "effect_description, effect_logic, prop_effect_type, prop_duration_minutes, usage_conditions, "
-        "physical_redeem, physical_notes, lucky_rules, level_requirement FROM shop_items ORDER BY id";
-    auto stmt = prepareStatement(sql);
-    std::vector<ShopItemRecord> items;
-    while (true) {
-        int rc = sqlite3_step(stmt.get());
-        if (rc == SQLITE_ROW) {
-            items.push_back(readShopItemRecord(stmt.get()));
-            continue;
-        }
-        if (rc == SQLITE_DONE) {
-            break;
+    for (const auto& entry : m_rollbackActions) {
+        if (entry.first == key) {
+            return false;
         }
-        throw std::runtime_error(buildErrorMessage("Failed to read shop items", m_db.get()));
     }
-    return items;
+    m_rollbackActions.emplace_back(key, std::move(action));
+    return true;
 }
 
-int DatabaseManager::insertInventoryRecord(const InventoryRecord& record) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "INSERT INTO user_inventory (owner, item_id, quantity, used_quantity, status, purchase_time, "
-        "expiration_time, lucky_payload, notes) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, record.owner.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 2, record.itemId);
-    sqlite3_bind_int(stmt.get(), 3, record.quantity);
-    sqlite3_bind_int(stmt.get(), 4, record.usedQuantity);
-    sqlite3_bind_text(stmt.get(), 5, record.status.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 6, record.purchaseTimeIso.c_str(), -1, SQLITE_TRANSIENT);
-    if (record.expirationTimeIso.empty()) {
-        sqlite3_bind_null(stmt.get(), 7);
-    } else {
-        sqlite3_bind_text(stmt.get(), 7, record.expirationTimeIso.c_str(), -1, SQLITE_TRANSIENT);
-    }
-    sqlite3_bind_text(stmt.get(), 8, record.luckyPayload.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 9, record.notes.c_str(), -1, SQLITE_TRANSIENT);
-    int rc = sqlite3_step(stmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to insert inventory", m_db.get()));
-    }
-    return static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+bool DatabaseManager::checkpointToDisk() { return writeCheckpoint(false); }
+
+bool DatabaseManager::inTransaction() const noexcept {
+    return m_transactionOwner.load() == std::this_thread::get_id();
 }
 
-bool DatabaseManager::updateInventoryRecord(const InventoryRecord& record) {
-    if (record.id < 0) {
-        throw std::runtime_error("Invalid inventory id");
-    }
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "UPDATE user_inventory SET owner = ?, item_id = ?, quantity = ?, used_quantity = ?, status = ?, "
-        "purchase_time = ?, expiration_time = ?, lucky_payload = ?, notes = ? WHERE id = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, record.owner.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 2, record.itemId);
-    sqlite3_bind_int(stmt.get(), 3, record.quantity);
-    sqlite3_bind_int(stmt.get(), 4, record.usedQuantity);
-    sqlite3_bind_text(stmt.get(), 5, record.status.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 6, record.purchaseTimeIso.c_str(), -1, SQLITE_TRANSIENT);
-    if (record.expirationTimeIso.empty()) {
-        sqlite3_bind_null(stmt.get(), 7);
-    } else {
-        sqlite3_bind_text(stmt.get(), 7, record.expirationTimeIso.c_str(), -1, SQLITE_TRANSIENT);
-    }
-    sqlite3_bind_text(stmt.get(), 8, record.luckyPayload.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 9, record.notes.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 10, record.id);
-    int rc = sqlite3_step(stmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to update inventory", m_db.get()));
+DatabaseManager::WriteCounters DatabaseManager::threadWriteCounters() noexcept { return tWriteCounters; }
+
+/**
+ * @brief sqlite3_commit_hook：把上次结算以来的变更行数计入当前（提交）线程。
+ * 中文：回调在 COMMIT 真正完成前触发，极少数提交随后因 SQLITE_BUSY 失败时会多计一次，只影响诊断计数。
+ *
+ * @return 0 to let the commit proceed. 中文：返回 0 放行提交。
+ */
+int DatabaseManager::commitHook(void* context) noexcept {
+    auto* self = static_cast<DatabaseManager*>(context);
+    ++tWriteCounters.commits;
+    sqlite3* handle = self->m_db.get();
+    if (handle == nullptr) {
+        return 0;  // 中文：连接正在关闭（unique_ptr 已置空），不再结算行数。
     }
-    return sqlite3_changes(m_db.get()) > 0;
+    const sqlite3_int64 total = sqlite3_total_changes64(handle);
+    tWriteCounters.rowsWritten += static_cast<std::uint64_t>(total - self->m_settledChanges);
+    self->m_settledChanges = total;
+    return 0;
 }
 
-bool DatabaseManager::deleteInventoryRecord(int inventoryId) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql = "DELETE FROM user_inventory WHERE id = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_int(stmt.get(), 1, inventoryId);
-    int rc = sqlite3_step(stmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to delete inventory", m_db.get()));
+/**
+ * @brief sqlite3_rollback_hook：回滚的变更不计入任何线程。
+ */
+void DatabaseManager::rollbackHook(void* context) noexcept {
+    auto* self = static_cast<DatabaseManager*>(context);
+    if (sqlite3* handle = self->m_db.get()) {
+        self->m_settledChanges = sqlite3_total_changes64(handle);
     }
-    return sqlite3_changes(m_db.get()) > 0;
 }
 
-std::optional<DatabaseManager::InventoryRecord> DatabaseManager::getInventoryRecordById(int inventoryId) const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "SELECT id, item_id, owner, quantity, used_quantity, status, purchase_time, expiration_time, "
-        "lucky_payload, notes FROM user_inventory WHERE id = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_int(stmt.get(), 1, inventoryId);
-    int rc = sqlite3_step(stmt.get());
-    if (rc == SQLITE_ROW) {
-        return readInventoryRecord(stmt.get());
-    }
-    if (rc == SQLITE_DONE) {
-        return std::nullopt;
+/**
+ * @brief Report prepared-statement cache counters.
+ * 中文：返回预编译语句缓存的命中、未命中与失效次数。
+ *
+ * Business logic: profiling bulk update paths needs to tell re-parsing cost apart from IO cost.
+ * 中文：分析批量更新路径时，需要区分 SQL 解析开销与磁盘 IO 开销。
+ *
+ * @return Counter snapshot. 中文：计数快照。
+ * @throws None. 中文：不抛出异常。
+ */
+DatabaseManager::StatementCacheStats DatabaseManager::statementCacheStats() const {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    StatementCacheStats stats = m_statementCacheStats;
+    stats.cachedStatements = m_statementCache.size();
+    std::lock_guard<std::mutex> poolLock(m_readPoolMutex);
+    stats.hits += m_readerCacheStats.hits;
+    stats.misses += m_readerCacheStats.misses;
+    for (const auto& connection : m_readPool) {
+        stats.cachedStatements += connection->cachedCount;
     }
-    throw std::runtime_error(buildErrorMessage("Failed to query inventory", m_db.get()));
+    return stats;
 }
 
-std::vector<DatabaseManager::InventoryRecord> DatabaseManager::getInventoryForUser(const std::string& owner) const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "SELECT id, item_id, owner, quantity, used_quantity, status, purchase_time, expiration_time, "
-        "lucky_payload, notes FROM user_inventory WHERE owner = ? ORDER BY purchase_time DESC";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, owner.c_str(), -1, SQLITE_TRANSIENT);
-    std::vector<InventoryRecord> records;
-    while (true) {
-        int rc = sqlite3_step(stmt.get());
-        if (rc == SQLITE_ROW) {
-            records.push_back(readInventoryRecord(stmt.get()));
-            continue;
+/**
+ * @brief Sum sqlite3_db_status over the writer and idle readers.
+ * 中文：汇总写连接与空闲只读连接的 sqlite3_db_status；持有池锁期间空闲连接不会被租出。
+ *       本函数由界面线程的内存面板调用，写连接锁只 try_lock：写事务进行中时跳过写连接，不让界面等待写入完成。
+ *       堆用量来自 sqlite3_status64，本身线程安全，无需任何锁。
+ */
+DatabaseManager::SqliteMemoryStatus DatabaseManager::memoryStatus() const {
+    SqliteMemoryStatus status;
+    sqlite3_int64 current = 0;
+    sqlite3_int64 highwater = 0;
+    if (sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &current, &highwater, 0) == SQLITE_OK) {
+        status.heapUsed = current;
+        status.heapHighwater = highwater;
+    }
+    const auto sample = [&status](sqlite3* handle) {
+        int used = 0;
+        int peak = 0;
+        if (sqlite3_db_status(handle, SQLITE_DBSTATUS_CACHE_USED, &used, &peak, 0) == SQLITE_OK) {
+            status.pageCacheUsed += used;
         }
-        if (rc == SQLITE_DONE) {
-            break;
+        if (sqlite3_db_status(handle, SQLITE_DBSTATUS_SCHEMA_USED, &used, &peak, 0) == SQLITE_OK) {
+            status.schemaUsed += used;
+        }
+        if (sqlite3_db_status(handle, SQLITE_DBSTATUS_STMT_USED, &used, &peak, 0) == SQLITE_OK) {
+            status.statementUsed += used;
+        }
+        if (sqlite3_db_status(handle, SQLITE_DBSTATUS_LOOKASIDE_USED, &used, &peak, 0) == SQLITE_OK) {
+            status.lookasideUsed += used;
+        }
+        if (sqlite3_db_status(handle, SQLITE_DBSTATUS_LOOKASIDE_HIT, &used, &peak, 0) == SQLITE_OK) {
+            status.lookasideHits += peak;
+        }
+        if (sqlite3_db_status(handle, SQLITE_DBSTATUS_LOOKASIDE_MISS_SIZE, &used, &peak, 0) == SQLITE_OK) {
+            status.lookasideMissSize += peak;
+        }
+        if (sqlite3_db_status(handle, SQLITE_DBSTATUS_LOOKASIDE_MISS_FULL, &used, &peak, 0) == SQLITE_OK) {
+            status.lookasideMissFull += peak;
+        }
+        ++status.connections;
+    };
+    {
+        std::unique_lock<WriterMutex> lock(m_mutex, std::try_to_lock);
+        if (lock.owns_lock() && m_db) {
+            sample(m_db.get());
+        }
+    }
+    std::lock_guard<std::mutex> poolLock(m_readPoolMutex);
+    for (const auto& connection : m_readPool) {
+        if (!connection->leased && connection->handle) {
+            sample(connection->handle.get());
         }
-        throw std::runtime_error(buildErrorMessage("Failed to list inventory", m_db.get()));
     }
-    return records;
+    return status;
 }
 
-std::vector<DatabaseManager::InventoryRecord> DatabaseManager::getAllInventoryRecords() const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "SELECT id, item_id, owner, quantity, used_quantity, status, purchase_time, expiration_time, "
-        "lucky_payload, notes FROM user_inventory";
-    auto stmt = prepareStatement(sql);
-    std::vector<InventoryRecord> records;
-    while (true) {
-        int rc = sqlite3_step(stmt.get());
-        if (rc == SQLITE_ROW) {
-            records.push_back(readInventoryRecord(stmt.get()));
-            continue;
+/**
+ * @brief Release page-cache memory without waiting for the writer.
+ * 中文：与 memoryStatus 相同，写连接锁只 try_lock；写连接忙时跳过它，它的页缓存正被当前事务使用，本就无法释放。
+ */
+void DatabaseManager::releaseMemory() noexcept {
+    {
+        std::unique_lock<WriterMutex> lock(m_mutex, std::try_to_lock);
+        if (lock.owns_lock() && m_db) {
+            sqlite3_db_release_memory(m_db.get());
         }
-        if (rc == SQLITE_DONE) {
-            break;
+    }
+    std::lock_guard<std::mutex> poolLock(m_readPoolMutex);
+    for (const auto& connection : m_readPool) {
+        if (!connection->leased && connection->handle) {
+            sqlite3_db_release_memory(connection->handle.get());
         }
-        throw std::runtime_error(buildErrorMessage("Failed to scan inventory", m_db.get()));
     }
-    return records;
 }
 
-int DatabaseManager::countInventoryByUserAndItem(const std::string& owner, int itemId) const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "SELECT IFNULL(SUM(quantity), 0) FROM user_inventory WHERE owner = ? AND item_id = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, owner.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 2, itemId);
-    int rc = sqlite3_step(stmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to count inventory", m_db.get()));
+/**
+ * @brief Finalize idle cached statements so the next lookup re-prepares against the current schema.
+ * 中文：释放空闲的缓存语句，使下一次查询基于最新表结构重新编译。
+ *
+ * Business logic: statements still checked out by a caller are kept; SQLite re-prepares them transparently
+ * if the schema changed underneath. 中文：正在使用的语句会被保留，SQLite 会在结构变化时自动重新编译它们。
+ *
+ * @return void. 中文：无返回值。
+ * @throws None. 中文：不抛出异常。
+ */
+void DatabaseManager::invalidateStatementCache() noexcept {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    for (auto it = m_statementCache.begin(); it != m_statementCache.end();) {
+        if (it->second.inUse) {
+            ++it;
+        } else {
+            it = m_statementCache.erase(it);
+        }
     }
-    return sqlite3_column_int(stmt.get(), 0);
+    ++m_statementCacheStats.invalidations;
 }
 
-int DatabaseManager::countCustomRewardAchievements(const std::string& owner,
-                                                   const std::string& monthToken) const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "SELECT COUNT(1) FROM achievements WHERE owner = ? AND type = 'Custom' AND reward_type = 'WithReward' "
-        "AND strftime('%Y-%m', created_at) = ?";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, owner.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 2, monthToken.c_str(), -1, SQLITE_TRANSIENT);
-    int rc = sqlite3_step(stmt.get());
-    if (!isSuccessCode(rc)) {
-        throw std::runtime_error(buildErrorMessage("Failed to count achievements", m_db.get()));
-    }
-    return sqlite3_column_int(stmt.get(), 0);
-}
+/**
+ * @brief Expose raw sqlite3 handle for rare advanced scenarios (e.g., analytics queries).
+ * 中文：在极少数高级场景下（统计分析等）暴露底层 sqlite3 句柄。
+ *
+ * Business logic: providing a controlled escape hatch avoids duplicate singleton implementations.
+ * 中文：提供受控的“后门”避免重复实现单例逻辑。
+ *
+ * @return sqlite3 pointer or nullptr. 中文：返回 sqlite3 指针或 nullptr。
+ * @throws None. 中文：不抛出异常。
+ */
+sqlite3* DatabaseManager::rawHandle() const noexcept { return m_db.get(); }
 
 /**
- * @brief 插入一条日志记录，遵循不可变设计。
- * 中文：所有日志写入后不可更新或删除，仅追加。
+ * @brief Register the trace hooks wanted on a connection.
+ * 中文：编译了埋点时注册 ROW（统计读取行数），跟踪器开启时再注册 PROFILE；两者都不需要时注销回调。
+ * sqlite3_trace_v2 每个连接只有一个回调，因此两类用途共用 traceCallback。
+ *
+ * @param handle Connection to configure. 中文：要配置的连接。
+ * @return void. 中文：无返回值。
+ * @throws None. 中文：不抛出异常。
  */
-int DatabaseManager::insertLogRecord(const LogRecord& record) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "INSERT INTO logs (timestamp, type, content, related_id, attribute_changes, level_change, special_event, mood) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?)";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, record.timestampIso.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 2, record.type.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 3, record.content.c_str(), -1, SQLITE_TRANSIENT);
-    if (record.relatedId.has_value()) {
-        sqlite3_bind_int(stmt.get(), 4, *record.relatedId);
-    } else {
-        sqlite3_bind_null(stmt.get(), 4);
+void DatabaseManager::applyTraceHooks(sqlite3* handle) noexcept {
+    if (handle == nullptr) {
+        return;
     }
-    sqlite3_bind_text(stmt.get(), 5, record.attributeChanges.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 6, record.levelChange);
-    sqlite3_bind_text(stmt.get(), 7, record.specialEvent.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt.get(), 8, record.mood.c_str(), -1, SQLITE_TRANSIENT);
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to insert log record", m_db.get()));
+    unsigned int mask = metrics::Registry::kCompiledIn ? SQLITE_TRACE_ROW : 0U;
+    {
+        std::lock_guard<std::mutex> lock(m_queryTraceMutex);
+        if (m_queryTraceOptions.enabled) {
+            mask |= SQLITE_TRACE_PROFILE;
+        }
     }
-    return static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+    if (mask == 0U) {
+        sqlite3_trace_v2(handle, 0, nullptr, nullptr);
+        return;
+    }
+    sqlite3_trace_v2(handle, mask, &DatabaseManager::traceCallback, this);
 }
 
 /**
- * @brief 按过滤条件读取日志，使用时间索引提升性能。
- * 中文：结合类型、时间、心情与关键字进行筛选。
+ * @brief sqlite3_trace_v2 callback shared by metrics (ROW) and the query tracer (PROFILE).
+ * 中文：ROW 为埋点累计行数；PROFILE 交给 recordQueryProfile 聚合并检测慢查询。
+ *
+ * @return Always 0. 中文：始终返回 0。
+ * @throws None. 中文：不抛出异常。
  */
-std::vector<DatabaseManager::LogRecord> DatabaseManager::queryLogRecords(const std::optional<std::string>& typeFilter,
-                                                                       const std::optional<std::string>& startIso,
-                                                                       const std::optional<std::string>& endIso,
-                                                                       const std::optional<std::string>& moodFilter,
-                                                                       const std::optional<std::string>& keyword) const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    std::string sql = "SELECT id, timestamp, type, content, related_id, attribute_changes, level_change, special_event, mood FROM logs WHERE 1=1";
-    std::vector<std::string> params;
-    if (typeFilter.has_value()) {
-        sql += " AND type = ?";
-        params.push_back(*typeFilter);
+int DatabaseManager::traceCallback(unsigned int type, void* context, void* p, void* x) {
+    auto* statement = static_cast<sqlite3_stmt*>(p);
+    if (type == SQLITE_TRACE_ROW) {
+#if ROVE_ENABLE_METRICS
+        countStatementRow(statement);
+#endif
+        return 0;
     }
-    if (startIso.has_value()) {
-        sql += " AND timestamp >= ?";
-        params.push_back(*startIso);
+    if (type == SQLITE_TRACE_PROFILE && !tExplainingPlan) {
+        try {
+            static_cast<DatabaseManager*>(context)->recordQueryProfile(
+                statement, static_cast<std::uint64_t>(*static_cast<const sqlite3_int64*>(x)));
+        } catch (...) {
+            // 中文：跟踪只用于诊断，内存不足时丢弃本次样本。
+        }
     }
-    if (endIso.has_value()) {
-        sql += " AND timestamp <= ?";
-        params.push_back(*endIso);
+    return 0;
+}
+
+/**
+ * @brief Fold one PROFILE sample into the per-statement aggregate and queue it when slow.
+ * 中文：把一次 PROFILE 样本并入该 SQL 的聚合；超过阈值时暂存，待语句结束后解释执行计划。
+ *
+ * Business logic: the stmt-status counters are read with reset so each sample only counts its own execution.
+ * 中文：读取 stmt-status 计数时同时清零，保证每个样本只统计本次执行。
+ *
+ * @param statement Finished statement. 中文：刚结束的语句。
+ * @param elapsedNs PROFILE elapsed time. 中文：PROFILE 报告的耗时。
+ * @return void. 中文：无返回值。
+ * @throws std::bad_alloc only. 中文：仅可能抛出内存分配异常。
+ */
+void DatabaseManager::recordQueryProfile(sqlite3_stmt* statement, std::uint64_t elapsedNs) {
+    const char* sql = sqlite3_sql(statement);
+    if (sql == nullptr) {
+        return;
     }
-    if (moodFilter.has_value()) {
-        sql += " AND mood = ?";
-        params.push_back(*moodFilter);
+    const auto fullScanSteps =
+        static_cast<std::uint64_t>(sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1));
+    const bool sorted = sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_SORT, 1) > 0;
+    const bool autoIndexed = sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_AUTOINDEX, 1) > 0;
+    bool slow = false;
+    {
+        std::lock_guard<std::mutex> lock(m_queryTraceMutex);
+        if (!m_queryTraceOptions.enabled) {
+            return;
+        }
+        auto& entry = m_queryTraceStatements[sql];
+        ++entry.executions;
+        entry.totalNs += elapsedNs;
+        entry.maxNs = std::max(entry.maxNs, elapsedNs);
+        entry.fullScanSteps += fullScanSteps;
+        entry.fullScanExecutions += fullScanSteps > 0 ? 1 : 0;
+        entry.sortExecutions += sorted ? 1 : 0;
+        entry.autoIndexExecutions += autoIndexed ? 1 : 0;
+        slow = elapsedNs >= static_cast<std::uint64_t>(std::max(0, m_queryTraceOptions.slowThresholdMs)) * 1000000ULL;
     }
-    if (keyword.has_value()) {
-        sql += " AND content LIKE ?";
-        params.push_back(std::string("%") + *keyword + "%");
+    if (!slow) {
+        return;
     }
-    sql += " ORDER BY timestamp ASC";
-    auto stmt = prepareStatement(sql);
-    for (std::size_t i = 0; i < params.size(); ++i) {
-        sqlite3_bind_text(stmt.get(), static_cast<int>(i + 1), params[i].c_str(), -1, SQLITE_TRANSIENT);
+    if (tPendingSlowQueries.size() >= kMaxPendingSlowQueries) {
+        tPendingSlowQueries.erase(tPendingSlowQueries.begin());
     }
-    std::vector<LogRecord> records;
-    while (true) {
-        int rc = sqlite3_step(stmt.get());
-        if (rc == SQLITE_ROW) {
-            records.push_back(readLogRecord(stmt.get()));
-            continue;
-        }
-        if (rc == SQLITE_DONE) {
-            break;
+    PendingSlowQuery pending;
+    pending.owner = this;
+    pending.handle = sqlite3_db_handle(statement);
+    pending.templateSql = sql;
+    char* expanded = sqlite3_expanded_sql(statement);
+    pending.query.sql = expanded != nullptr ? expanded : sql;
+    sqlite3_free(expanded);
+    pending.query.elapsedNs = elapsedNs;
+    pending.query.recordedAtMs = QDateTime::currentMSecsSinceEpoch();
+    pending.query.fullScan = fullScanSteps > 0;
+    tPendingSlowQueries.push_back(std::move(pending));
+}
+
+/**
+ * @brief Explain pending slow queries of @p handle, append them to the log and emit a warning.
+ * 中文：为本线程在该连接上暂存的慢查询补充执行计划（按 SQL 文本缓存），写入慢查询日志并输出警告。
+ *
+ * @param handle Connection whose statement just finished. 中文：刚结束语句所在的连接。
+ * @return void. 中文：无返回值。
+ * @throws None. 中文：不抛出异常。
+ */
+void DatabaseManager::flushSlowQueries(sqlite3* handle) noexcept {
+    try {
+        auto& pendingList = tPendingSlowQueries;
+        for (std::size_t i = 0; i < pendingList.size();) {
+            if (pendingList[i].handle != handle) {
+                ++i;
+                continue;
+            }
+            PendingSlowQuery pending = std::move(pendingList[i]);
+            pendingList.erase(pendingList.begin() + static_cast<std::ptrdiff_t>(i));
+            DatabaseManager& owner = *pending.owner;
+
+            std::vector<std::string> plan;
+            {
+                std::lock_guard<std::mutex> lock(owner.m_queryTraceMutex);
+                if (auto cached = owner.m_queryPlans.find(pending.templateSql); cached != owner.m_queryPlans.end()) {
+                    plan = cached->second;
+                }
+            }
+            if (plan.empty()) {
+                plan = explainQueryPlan(handle, pending.templateSql);
+                std::lock_guard<std::mutex> lock(owner.m_queryTraceMutex);
+                owner.m_queryPlans[pending.templateSql] = plan;
+            }
+            SlowQuery query = std::move(pending.query);
+            query.plan = std::move(plan);
+            query.fullScan = query.fullScan || planHasTableScan(query.plan);
+
+            QString message = QStringLiteral("Slow query (%1 ms%2): %3")
+                                  .arg(static_cast<double>(query.elapsedNs) / 1e6, 0, 'f', 1)
+                                  .arg(query.fullScan ? QStringLiteral(", full scan") : QString())
+                                  .arg(QString::fromStdString(query.sql));
+            for (const auto& row : query.plan) {
+                message += QStringLiteral("\n    ") + QString::fromStdString(row);
+            }
+            qWarning().noquote() << message;
+
+            std::lock_guard<std::mutex> lock(owner.m_queryTraceMutex);
+            owner.m_slowQueries.push_back(std::move(query));
+            while (owner.m_slowQueries.size() > std::max<std::size_t>(1, owner.m_queryTraceOptions.slowLogCapacity)) {
+                owner.m_slowQueries.pop_front();
+            }
         }
-        throw std::runtime_error(buildErrorMessage("Failed to query logs", m_db.get()));
+    } catch (...) {
+        tExplainingPlan = false;
     }
-    return records;
 }
 
 /**
- * @brief 统计手动日志数量，避免从数据库加载全部记录。
- * 中文：采用 COUNT(*) 聚合，加快成长快照的聚合速度。
+ * @brief Enable, disable or reconfigure the query tracer.
+ * 中文：更新跟踪配置并重新为写连接与只读连接注册回调；只读连接须在无人租用时修改，因此等待全部归还。
+ *       等待前先释放写连接锁：持有读租约的线程可能接着请求写连接，连接池耗尽时的读租约也直接落在写连接上，
+ *       持锁等待会与它们互相等待。
+ *
+ * @param options Tracer settings. 中文：跟踪配置。
+ * @return void. 中文：无返回值。
+ * @throws None. 中文：不抛出异常。
  */
-int DatabaseManager::countManualLogs() const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql = "SELECT COUNT(*) FROM logs WHERE type = 'Manual'";
-    auto stmt = prepareStatement(sql);
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_ROW) {
-        throw std::runtime_error(buildErrorMessage("Failed to count manual logs", m_db.get()));
+void DatabaseManager::setQueryTrace(const QueryTraceOptions& options) {
+    {
+        std::lock_guard<WriterMutex> lock(m_mutex);
+        {
+            std::lock_guard<std::mutex> traceLock(m_queryTraceMutex);
+            m_queryTraceOptions = options;
+            while (m_slowQueries.size() > std::max<std::size_t>(1, options.slowLogCapacity)) {
+                m_slowQueries.pop_front();
+            }
+        }
+        applyTraceHooks(m_db.get());
     }
-    return sqlite3_column_int(stmt.get(), 0);
+    std::unique_lock<std::mutex> poolLock(m_readPoolMutex);
+    m_readPoolIdle.wait(poolLock, [this] {
+        for (const auto& connection : m_readPool) {
+            if (connection->leased) {
+                return false;
+            }
+        }
+        return true;
+    });
+    for (auto& connection : m_readPool) {
+        applyTraceHooks(connection->handle.get());
+    }
+}
+
+DatabaseManager::QueryTraceOptions DatabaseManager::queryTraceOptions() const {
+    std::lock_guard<std::mutex> lock(m_queryTraceMutex);
+    return m_queryTraceOptions;
 }
 
 /**
- * @brief 将日志主键写入宽恕表，若已存在则忽略。
- * 中文：使用 INSERT OR IGNORE 避免重复写入引发错误。
+ * @brief Snapshot the tracer: statements sorted by total time, slow queries in arrival order.
+ * 中文：复制跟踪器状态，语句按总耗时降序排列。
+ *
+ * @return Tracer snapshot. 中文：跟踪器快照。
+ * @throws None. 中文：不抛出异常。
  */
-bool DatabaseManager::markLogForgiven(int logId) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql = "INSERT OR IGNORE INTO forgiven_logs (log_id) VALUES (?)";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_int(stmt.get(), 1, logId);
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to persist forgiven log", m_db.get()));
+DatabaseManager::QueryTraceReport DatabaseManager::queryTraceReport() const {
+    QueryTraceReport report;
+    {
+        std::lock_guard<std::mutex> lock(m_queryTraceMutex);
+        report.statements.reserve(m_queryTraceStatements.size());
+        for (const auto& [sql, entry] : m_queryTraceStatements) {
+            report.statements.push_back(entry);
+            report.statements.back().sql = sql;
+        }
+        report.slowQueries.assign(m_slowQueries.begin(), m_slowQueries.end());
     }
-    return sqlite3_changes(m_db.get()) > 0;
+    std::sort(report.statements.begin(), report.statements.end(),
+              [](const QueryTraceStatement& lhs, const QueryTraceStatement& rhs) { return lhs.totalNs > rhs.totalNs; });
+    return report;
+}
+
+void DatabaseManager::resetQueryTrace() {
+    std::lock_guard<std::mutex> lock(m_queryTraceMutex);
+    m_queryTraceStatements.clear();
+    m_slowQueries.clear();
+    m_queryPlans.clear();
 }
 
 /**
- * @brief 读取宽恕表中的所有日志 ID，供内存状态初始化。
- * 中文：使用 std::set 保证唯一性和快速查找。
+ * @brief Explain every cached statement.
+ * 中文：先收集写连接与各只读连接缓存中的 SQL 文本（只读连接须在无人租用时读取其缓存），去重排序后
+ *       在写连接上逐条执行 EXPLAIN QUERY PLAN；附加库中的表（如日志归档）也只在写连接上可见。
+ *
+ * @return One entry per distinct SQL text. 中文：每条不同的 SQL 一项。
+ * @throws None. 中文：不抛出异常。
  */
-std::set<int> DatabaseManager::loadForgivenLogIds() const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql = "SELECT log_id FROM forgiven_logs";
-    auto stmt = prepareStatement(sql);
-    std::set<int> ids;
-    while (true) {
-        int rc = sqlite3_step(stmt.get());
-        if (rc == SQLITE_ROW) {
-            ids.insert(sqlite3_column_int(stmt.get(), 0));
-            continue;
+std::vector<DatabaseManager::QueryPlanAudit> DatabaseManager::auditQueryPlans() const {
+    std::vector<std::string> texts;
+    {
+        std::lock_guard<WriterMutex> lock(m_mutex);
+        for (const auto& entry : m_statementCache) {
+            texts.push_back(entry.first);
         }
-        if (rc == SQLITE_DONE) {
-            break;
+    }
+    {
+        std::unique_lock<std::mutex> poolLock(m_readPoolMutex);
+        m_readPoolIdle.wait(poolLock, [this] {
+            for (const auto& connection : m_readPool) {
+                if (connection->leased) {
+                    return false;
+                }
+            }
+            return true;
+        });
+        for (const auto& connection : m_readPool) {
+            for (const auto& entry : connection->statementCache) {
+                texts.push_back(entry.first);
+            }
         }
-        throw std::runtime_error(buildErrorMessage("Failed to load forgiven logs", m_db.get()));
     }
-    return ids;
+    std::sort(texts.begin(), texts.end());
+    texts.erase(std::unique(texts.begin(), texts.end()), texts.end());
+    return auditQueryPlans(texts);
 }
 
-/**
- * @brief 写入成长快照。
- * 中文：在关键事件或定时任务后调用，捕获成长曲线。
- */
-int DatabaseManager::insertGrowthSnapshot(const GrowthSnapshotRecord& record) {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    const std::string sql =
-        "INSERT INTO growth_snapshots (timestamp, user_level, growth_points, execution, perseverance, decision, knowledge, social, pride, achievement_count, completed_tasks, failed_tasks, manual_log_count) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
-    auto stmt = prepareStatement(sql);
-    sqlite3_bind_text(stmt.get(), 1, record.timestampIso.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt.get(), 2, record.userLevel);
-    sqlite3_bind_int(stmt.get(), 3, record.growthPoints);
-    sqlite3_bind_int(stmt.get(), 4, record.execution);
-    sqlite3_bind_int(stmt.get(), 5, record.perseverance);
-    sqlite3_bind_int(stmt.get(), 6, record.decision);
-    sqlite3_bind_int(stmt.get(), 7, record.knowledge);
-    sqlite3_bind_int(stmt.get(), 8, record.social);
-    sqlite3_bind_int(stmt.get(), 9, record.pride);
-    sqlite3_bind_int(stmt.get(), 10, record.achievementCount);
-    sqlite3_bind_int(stmt.get(), 11, record.completedTasks);
-    sqlite3_bind_int(stmt.get(), 12, record.failedTasks);
-    sqlite3_bind_int(stmt.get(), 13, record.manualLogCount);
-    int rc = sqlite3_step(stmt.get());
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error(buildErrorMessage("Failed to insert growth snapshot", m_db.get()));
+std::vector<DatabaseManager::QueryPlanAudit> DatabaseManager::auditQueryPlans(
+    const std::vector<std::string>& statements) const {
+    std::vector<QueryPlanAudit> audits;
+    audits.reserve(statements.size());
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    for (const auto& sql : statements) {
+        QueryPlanAudit audit;
+        sqlite3_stmt* raw = nullptr;
+        audit.prepared = sqlite3_prepare_v2(m_db.get(), sql.c_str(), -1, &raw, nullptr) == SQLITE_OK;
+        sqlite3_finalize(raw);
+        audit.plan = explainQueryPlan(m_db.get(), sql);
+        audit.scannedTables = planScannedTables(audit.plan);
+        audit.fullScan = !audit.scannedTables.empty();
+        audit.sql = sql;
+        audits.push_back(std::move(audit));
     }
-    return static_cast<int>(sqlite3_last_insert_rowid(m_db.get()));
+    return audits;
 }
 
 /**
- * @brief 查询成长快照。
- * 中文：可按时间区间提取用于可视化和压缩。
+ * @brief 固定语句直接取常量；动态语句对每个可选条件取有/无两种组合，日志查询覆盖界面与导出使用的过滤形态。
  */
-std::vector<DatabaseManager::GrowthSnapshotRecord> DatabaseManager::queryGrowthSnapshots(const std::optional<std::string>& startIso,
-                                                                                     const std::optional<std::string>& endIso) const {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    std::string sql = "SELECT id, timestamp, user_level, growth_points, execution, perseverance, decision, knowledge, social, pride, achievement_count, completed_tasks, failed_tasks, manual_log_count FROM growth_snapshots WHERE 1=1";
-    std::vector<std::string> params;
-    if (startIso.has_value()) {
-        sql += " AND timestamp >= ?";
-        params.push_back(*startIso);
+std::vector<std::string> DatabaseManager::queryPlanCatalog() const {
+    std::vector<std::string> catalog = {
+        kSelectAppStateSql,           kUpsertAppStateSql,
+        kSelectActivityFeedSql,       kUpsertActivityFeedSql,
+        kSelectGrowthAnalyticsSql,    kUpsertGrowthAnalyticsSql,
+        kValidateAccountSql,          kSelectUserByNameSql,
+        kSelectUserIdByNameSql,       kUpdateUserLevelSql,
+        kUpdateUserCurrencySql,       kUpdateUserAttributesSql,
+        kDeleteUserSql,               kUpdateTaskSql,
+        kDeleteTaskSql,               kSelectTaskByIdSql,
+        kSelectTasksForOwnerSql,      kUpsertTaskStatSql,
+        kSelectTaskStatTotalsSql,     kUpsertDeadlineFailureSql,
+        kSelectDeadlineFailuresSql,   kUpsertDailyActivitySql,
+        kSelectDailyActivitySql,      kInsertProgressionDeltaSql,
+        kSelectProgressionDeltasSql,  kUpdateAchievementSql,
+        kDeleteAchievementSql,        kSelectAchievementsForOwnerSql,
+        kCountCustomRewardAchievementsSql,
+        kUpdateShopItemSql,           kDeleteShopItemSql,
+        kSelectShopItemByIdSql,       kSelectAllShopItemsSql,
+        kInsertInventorySql,          kUpdateInventorySql,
+        kDeleteInventorySql,          kSelectInventoryByIdSql,
+        kSelectInventoryForOwnerSql,  kSelectInventoryHeldAtSql,
+        kSelectExpiredInventorySql,   kCountInventoryByItemSql,
+        kInventoryTypeSummarySql,     kSelectInventoryItemTypesSql,
+        kInsertLogSql,                kCountManualLogsSql,
+        kInsertForgivenLogSql,        kSelectForgivenLogIdsSql,
+        kSummarizeLogBatchSql,        kDeleteLogBatchSql,
+        kSelectColdLogsSql,           kUpdateLogContentSql,
+        kSelectTimelineStartSql,      kSelectSnapshotOwnersToPackSql,
+        kInsertSnapshotBlockSql,
+    };
+    catalog.push_back(buildSnapshotCheckpointSql());
+    catalog.insert(catalog.end(), std::begin(kSnapshotCheckpointBlockSql), std::end(kSnapshotCheckpointBlockSql));
+    catalog.push_back(buildSnapshotPackSelectSql());
+    catalog.push_back(buildSnapshotPackDeleteSql());
+
+    for (const bool hasStart : {false, true}) {
+        for (const bool hasEnd : {false, true}) {
+            catalog.push_back(buildTaskStatsSql(hasStart, hasEnd));
+            catalog.push_back(buildLogDailySummariesSql(hasStart, hasEnd));
+            catalog.push_back(buildRawSnapshotRecordsSql(hasStart, hasEnd));
+            catalog.push_back(buildRawSnapshotSeriesSql(hasStart, hasEnd));
+            catalog.push_back(buildRawTimelineCountSql(hasStart, hasEnd));
+            for (const auto& tier : kGrowthRollupTiers) {
+                catalog.push_back(buildRollupTimelineSql(tier.table, "-1, last_timestamp", "last_timestamp_ms",
+                                                         hasStart, hasEnd));
+                catalog.push_back(buildRollupTimelineSql(tier.table, "last_timestamp_ms", nullptr, hasStart, hasEnd));
+                catalog.push_back(buildRollupCountSql(tier.table, hasStart, hasEnd));
+            }
+        }
     }
-    if (endIso.has_value()) {
-        sql += " AND timestamp <= ?";
-        params.push_back(*endIso);
+    for (const auto& tier : kGrowthRollupTiers) {
+        catalog.push_back(buildRollupUpsertSql(tier));
     }
-    sql += " ORDER BY timestamp ASC";
-    auto stmt = prepareStatement(sql);
-    for (std::size_t i = 0; i < params.size(); ++i) {
-        sqlite3_bind_text(stmt.get(), static_cast<int>(i + 1), params[i].c_str(), -1, SQLITE_TRANSIENT);
+
+    // 中文：日志查询形态——仅用户、类型加区间、心情、长关键词（FTS 可用时走 MATCH）、短关键词（LIKE）、
+    //       排除宽恕；每种形态都有首页与带游标翻页两种写法。
+    const auto ownerFilter = [] {
+        LogFilter filter;
+        filter.ownerId = 1;
+        return filter;
+    };
+    std::vector<LogFilter> filters(6, ownerFilter());
+    filters[1].type = std::string("Auto");
+    filters[1].startMs = 0;
+    filters[1].endMs = 1;
+    filters[2].mood = std::string("calm");
+    filters[3].keyword = std::string("keyword");
+    filters[4].keyword = std::string("k");
+    filters[5].excludeForgiven = true;
+    for (const auto& filter : filters) {
+        std::vector<SqlParam> params;
+        catalog.push_back(buildLogQuerySql(filter, std::nullopt, params));
+        params.clear();
+        catalog.push_back(buildLogQuerySql(filter, LogCursor{}, params) + " LIMIT ?");
     }
-    std::vector<GrowthSnapshotRecord> records;
-    while (true) {
-        int rc = sqlite3_step(stmt.get());
-        if (rc == SQLITE_ROW) {
-            records.push_back(readGrowthSnapshotRecord(stmt.get()));
-            continue;
+    if (m_logSearchIndexed) {
+        LogFilter search = filters[1];
+        search.keyword = std::string("keyword");
+        search.excludeForgiven = true;
+        std::vector<SqlParam> params;
+        catalog.push_back(buildLogSearchSql(search, true, params));
+    }
+    return catalog;
+}
+
+/**
+ * @brief Render the report as plain text for logs and the bench tool.
+ * 中文：渲染为纯文本，供日志与基准工具输出；标记 FULLSCAN 的语句即存在不经索引的全表扫描。
+ *
+ * @param topStatements Number of statements listed. 中文：列出的语句条数。
+ * @return Report text. 中文：报告文本。
+ * @throws None. 中文：不抛出异常。
+ */
+std::string DatabaseManager::QueryTraceReport::toText(std::size_t topStatements) const {
+    std::ostringstream oss;
+    oss << "statements by total time (" << statements.size() << " distinct)\n";
+    const std::size_t shown = std::min(topStatements, statements.size());
+    for (std::size_t i = 0; i < shown; ++i) {
+        const auto& entry = statements[i];
+        oss << "  " << entry.executions << "x total " << entry.totalNs / 1000000 << " ms, max "
+            << entry.maxNs / 1000000 << " ms";
+        if (entry.fullScanExecutions > 0) {
+            oss << ", FULLSCAN " << entry.fullScanExecutions << "x/" << entry.fullScanSteps << " rows";
         }
-        if (rc == SQLITE_DONE) {
-            break;
+        if (entry.sortExecutions > 0) {
+            oss << ", sort " << entry.sortExecutions << "x";
         }
-        throw std::runtime_error(buildErrorMessage("Failed to query growth snapshots", m_db.get()));
+        if (entry.autoIndexExecutions > 0) {
+            oss << ", autoindex " << entry.autoIndexExecutions << "x";
+        }
+        oss << "\n    " << entry.sql << "\n";
     }
-    return records;
+    oss << "slow queries (" << slowQueries.size() << ")\n";
+    for (const auto& query : slowQueries) {
+        oss << "  " << static_cast<double>(query.elapsedNs) / 1e6 << " ms" << (query.fullScan ? " FULLSCAN" : "")
+            << ": " << query.sql << "\n";
+        for (const auto& row : query.plan) {
+            oss << "      " << row << "\n";
+        }
+    }
+    return oss.str();
 }
 
 /**
- * @brief Begin an explicit transaction to guard multiple operations.
- * 中文：开启显式事务以保护多条操作的原子性。
+ * @brief Open database file and register its handle in std::unique_ptr for RAII.
+ * 中文：打开数据库文件并交由 std::unique_ptr 托管，确保异常时自动释放。
  *
- * Business logic: gameplay events often update level, currency, and logs simultaneously; using BEGIN ensures
- * either all succeed or all fail. 中文：成长事件常需同时更新等级、货币与日志，事务可保证要么全部成功要么全部失败。
+ * Business logic: isolating open logic lets us reuse it whenever we support runtime database switching.
+ * 中文：独立的打开逻辑方便未来支持运行时切换数据库。
  *
+ * @param path Filesystem path to SQLite file. 中文：SQLite 文件路径。
  * @return void. 中文：无返回值。
- * @throws std::runtime_error When SQLite cannot start the transaction. 中文：开启事务失败抛出异常。
+ * @throws std::runtime_error When sqlite3_open fails. 中文：打开失败抛出异常。
  */
-bool DatabaseManager::beginTransaction() {
-    if (!m_transactionLock.owns_lock()) {
-        m_transactionLock = std::unique_lock<std::recursive_mutex>(m_mutex);
-        executeNonQuery("BEGIN TRANSACTION;");
-        m_transactionDepth = 1;
-        return true;
+void DatabaseManager::openDatabase(const std::string& path) {
+    sqlite3* rawHandle = nullptr;
+    int rc = sqlite3_open(path.c_str(), &rawHandle);
+    if (rc != SQLITE_OK) {
+        std::string message = buildErrorMessage("Failed to open database", rawHandle);
+        if (rawHandle != nullptr) {
+            sqlite3_close(rawHandle);
+        }
+        throw std::runtime_error(message);
     }
-    ++m_transactionDepth;
-    return false;
+    m_db.reset(rawHandle);
+    m_databasePath = path;
+    if (!applyConnectionLookaside(rawHandle, true)) {
+        qWarning() << "写连接的 lookaside 配置未生效";
+    }
+    applyTraceHooks(rawHandle);
+    registerLogFunctions(rawHandle);
+    m_settledChanges = sqlite3_total_changes64(rawHandle);
+    sqlite3_commit_hook(rawHandle, &DatabaseManager::commitHook, this);
+    sqlite3_rollback_hook(rawHandle, &DatabaseManager::rollbackHook, this);
 }
 
 /**
- * @brief Commit the active transaction.
- * 中文：提交当前事务。
+ * @brief Apply journal, sync, mmap, cache, temp-store and busy-timeout settings, then read them back.
+ * 中文：依次设置日志模式、同步级别、内存映射、页缓存、临时存储与忙等待超时，并读回实际值。
  *
- * Business logic: committing here keeps ownership of transactional lifecycle inside DatabaseManager, so other
- * modules don't have to send raw SQL strings. 中文：在此提交可让其他模块无需直接写 SQL 即可控制事务生命周期。
+ * Business logic: SQLite silently ignores some requests (e.g. WAL on in-memory databases), so the effective
+ * values are recorded for diagnostics instead of trusting the requested profile.
+ * 中文：SQLite 会静默忽略部分设置（如内存数据库无法启用 WAL），因此记录读回的实际值而非请求值。
+ *
+ * @param profile Requested settings. 中文：请求的配置。
+ * @return void. 中文：无返回值。
+ * @throws std::runtime_error When a PRAGMA fails. 中文：PRAGMA 执行失败时抛出异常。
+ */
+void DatabaseManager::applyConnectionProfile(const ConnectionProfile& profile) {
+    if (m_db == nullptr) {
+        throw std::runtime_error("Database is not initialized");
+    }
+    m_busyTimeoutMs.store(std::max(0, profile.busyTimeoutMs));
+    sqlite3_busy_handler(m_db.get(), &countingBusyHandler, &m_busyTimeoutMs);
+    executeNonQuery(std::string("PRAGMA journal_mode = ") + (profile.walJournal ? "WAL;" : "DELETE;"));
+    executeNonQuery("PRAGMA synchronous = " + std::to_string(static_cast<int>(profile.synchronous)) + ";");
+    executeNonQuery("PRAGMA mmap_size = " + std::to_string(std::max<std::int64_t>(0, profile.mmapSizeBytes)) + ";");
+    // English: negative cache_size is interpreted by SQLite as KiB rather than pages.
+    // 中文：cache_size 取负值时 SQLite 按 KiB 解释，而不是页数。
+    executeNonQuery("PRAGMA cache_size = -" + std::to_string(std::max(1, profile.cacheSizeKiB)) + ";");
+    executeNonQuery("PRAGMA temp_store = " + std::to_string(static_cast<int>(profile.tempStore)) + ";");
+
+    AppliedConnectionSettings applied;
+    applied.profileName = profile.name;
+    applied.journalMode = readPragmaText("PRAGMA journal_mode");
+    applied.synchronous = static_cast<int>(readPragmaInteger("PRAGMA synchronous"));
+    applied.mmapSizeBytes = readPragmaInteger("PRAGMA mmap_size");
+    applied.cacheSize = static_cast<int>(readPragmaInteger("PRAGMA cache_size"));
+    applied.tempStore = static_cast<int>(readPragmaInteger("PRAGMA temp_store"));
+    // English: PRAGMA busy_timeout reads 0 once a custom busy handler is installed.
+    // 中文：安装自定义忙等回调后 PRAGMA busy_timeout 读回 0，因此记录回调实际使用的超时。
+    applied.busyTimeoutMs = m_busyTimeoutMs.load();
+    m_connectionSettings = applied;
+}
+
+/**
+ * @brief Run a PRAGMA and return the first column of its first row as text.
+ * 中文：执行 PRAGMA 并以文本形式返回首行首列。
+ *
+ * @param pragma PRAGMA statement. 中文：PRAGMA 语句。
+ * @return Result text, empty if no row. 中文：结果文本，无结果时为空。
+ * @throws std::runtime_error When the PRAGMA fails. 中文：执行失败抛出异常。
+ */
+std::string DatabaseManager::readPragmaText(const std::string& pragma) const {
+    auto stmt = prepareStatement(pragma);
+    int rc = sqlite3_step(stmt.get());
+    if (rc == SQLITE_ROW) {
+        const unsigned char* text = sqlite3_column_text(stmt.get(), 0);
+        return text == nullptr ? std::string() : reinterpret_cast<const char*>(text);
+    }
+    if (rc == SQLITE_DONE) {
+        return {};
+    }
+    throw std::runtime_error(buildErrorMessage("Failed to run " + pragma, m_db.get()));
+}
+
+/**
+ * @brief Run a PRAGMA and return the first column of its first row as integer.
+ * 中文：执行 PRAGMA 并以整数形式返回首行首列。
+ *
+ * @param pragma PRAGMA statement. 中文：PRAGMA 语句。
+ * @return Result value, 0 if no row. 中文：结果值，无结果时为 0。
+ * @throws std::runtime_error When the PRAGMA fails. 中文：执行失败抛出异常。
+ */
+std::int64_t DatabaseManager::readPragmaInteger(const std::string& pragma) const {
+    auto stmt = prepareStatement(pragma);
+    int rc = sqlite3_step(stmt.get());
+    if (rc == SQLITE_ROW) {
+        return sqlite3_column_int64(stmt.get(), 0);
+    }
+    if (rc == SQLITE_DONE) {
+        return 0;
+    }
+    throw std::runtime_error(buildErrorMessage("Failed to run " + pragma, m_db.get()));
+}
+
+/**
+ * @brief Open read-only connections that run queries against WAL snapshots concurrently with the writer.
+ * 中文：打开只读连接池，使查询在 WAL 快照上与写事务并发执行。
  *
+ * Business logic: the log browser and dashboard used to block behind applyRewardsLocked transactions because
+ * every read shared m_mutex and the single handle. Readers are only opened for file databases in WAL mode;
+ * otherwise every read keeps using the writer connection.
+ * 中文：此前日志面板与仪表盘的所有读取都与写事务共享 m_mutex 和唯一句柄，会被奖励事务阻塞。
+ *       仅当数据库为文件且处于 WAL 模式时才打开只读连接，否则继续使用写连接。
+ *
+ * @param profile Connection profile (cache, mmap, busy timeout, pool size). 中文：连接配置。
  * @return void. 中文：无返回值。
- * @throws std::runtime_error When commit fails. 中文：提交失败抛出异常。
+ * @throws std::runtime_error When a reader fails to open. 中文：只读连接打开失败时抛出异常。
  */
-void DatabaseManager::commitTransaction() {
-    if (!m_transactionLock.owns_lock()) {
-        throw std::runtime_error("No active transaction to commit");
-    }
-    if (m_transactionDepth == 0) {
-        throw std::runtime_error("Transaction depth mismatch on commit");
-    }
-    if (m_transactionDepth == 1) {
-        executeNonQuery("COMMIT;");
-        m_transactionDepth = 0;
-        m_transactionLock.unlock();
+void DatabaseManager::openReadPool(const ConnectionProfile& profile) {
+    closeReadPool();
+    m_connectionSettings.readConnections = 0;
+    if (profile.readConnections <= 0 || m_connectionSettings.journalMode != "wal" || m_databasePath.empty() ||
+        m_databasePath == ":memory:") {
         return;
     }
-    --m_transactionDepth;
+
+    std::vector<std::unique_ptr<ReadConnection>> pool;
+    for (int i = 0; i < profile.readConnections; ++i) {
+        sqlite3* rawReader = nullptr;
+        int rc = sqlite3_open_v2(m_databasePath.c_str(), &rawReader, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+        auto connection = std::make_unique<ReadConnection>();
+        connection->handle.reset(rawReader);
+        if (rc != SQLITE_OK) {
+            throw std::runtime_error(buildErrorMessage("Failed to open read connection", rawReader));
+        }
+        applyConnectionLookaside(rawReader, false);
+        sqlite3_busy_handler(rawReader, &countingBusyHandler, &m_busyTimeoutMs);
+        applyTraceHooks(rawReader);
+        registerLogFunctions(rawReader);
+        const std::string pragmas = "PRAGMA query_only = 1; PRAGMA mmap_size = " +
+                                    std::to_string(std::max<std::int64_t>(0, profile.mmapSizeBytes)) +
+                                    "; PRAGMA cache_size = -" + std::to_string(std::max(1, profile.cacheSizeKiB)) +
+                                    "; PRAGMA temp_store = " + std::to_string(static_cast<int>(profile.tempStore)) + ";";
+        char* errorMessage = nullptr;
+        rc = sqlite3_exec(rawReader, pragmas.c_str(), nullptr, nullptr, &errorMessage);
+        if (rc != SQLITE_OK) {
+            std::string message = "Failed to configure read connection";
+            if (errorMessage != nullptr) {
+                message += " | sqlite: ";
+                message += errorMessage;
+                sqlite3_free(errorMessage);
+            }
+            throw std::runtime_error(message);
+        }
+        pool.push_back(std::move(connection));
+    }
+
+    std::lock_guard<std::mutex> poolLock(m_readPoolMutex);
+    m_readPool = std::move(pool);
+    m_connectionSettings.readConnections = static_cast<int>(m_readPool.size());
 }
 
 /**
- * @brief Roll back the active transaction, undoing uncommitted changes.
- * 中文：回滚当前事务，撤销尚未提交的修改。
- *
- * Business logic: by exposing rollback we can safely abort when gameplay validation fails mid-way.
- * 中文：暴露回滚功能后，当业务校验失败时可安全终止。
+ * @brief Close all pooled readers, waiting for outstanding leases to be returned.
+ * 中文：关闭全部只读连接，关闭前等待外部租约归还。
  *
  * @return void. 中文：无返回值。
- * @throws std::runtime_error When rollback fails. 中文：回滚失败抛出异常。
+ * @throws None. 中文：不抛出异常。
  */
-void DatabaseManager::rollbackTransaction() {
-    if (!m_transactionLock.owns_lock()) {
-        return;  // 中文：若当前没有事务则无需处理，防止双重回滚导致崩溃。
+void DatabaseManager::closeReadPool() noexcept {
+    std::unique_lock<std::mutex> poolLock(m_readPoolMutex);
+    m_readPoolIdle.wait(poolLock, [this] {
+        for (const auto& connection : m_readPool) {
+            if (connection->leased) {
+                return false;
+            }
+        }
+        return true;
+    });
+    for (auto& connection : m_readPool) {
+        connection->statementCache.clear();
     }
-    executeNonQuery("ROLLBACK;");
-    m_transactionDepth = 0;
-    m_transactionLock.unlock();
+    m_readPool.clear();
 }
 
 /**
- * @brief Expose raw sqlite3 handle for rare advanced scenarios (e.g., analytics queries).
- * 中文：在极少数高级场景下（统计分析等）暴露底层 sqlite3 句柄。
- *
- * Business logic: providing a controlled escape hatch avoids duplicate singleton implementations.
- * 中文：提供受控的“后门”避免重复实现单例逻辑。
+ * @brief Lease a connection for a read-only query.
+ * 中文：为只读查询租用一条连接。
  *
- * @return sqlite3 pointer or nullptr. 中文：返回 sqlite3 指针或 nullptr。
+ * @return Lease on an idle pooled reader, or on the writer connection as fallback. 中文：空闲只读连接或回退写连接的租约。
  * @throws None. 中文：不抛出异常。
  */
-sqlite3* DatabaseManager::rawHandle() const noexcept { return m_db.get(); }
+DatabaseManager::ReadLease DatabaseManager::acquireReader() const {
+    if (m_transactionOwner.load() != std::this_thread::get_id()) {
+        std::lock_guard<std::mutex> poolLock(m_readPoolMutex);
+        for (const auto& connection : m_readPool) {
+            if (!connection->leased) {
+                connection->leased = true;
+                return ReadLease(*this, connection.get());
+            }
+        }
+    }
+    return ReadLease(*this);
+}
 
 /**
- * @brief Open database file and register its handle in std::unique_ptr for RAII.
- * 中文：打开数据库文件并交由 std::unique_ptr 托管，确保异常时自动释放。
+ * @brief Return a pooled reader and fold its cache counters into the global statistics.
+ * 中文：归还只读连接，并把其缓存计数合并到全局统计。
  *
- * Business logic: isolating open logic lets us reuse it whenever we support runtime database switching.
- * 中文：独立的打开逻辑方便未来支持运行时切换数据库。
- *
- * @param path Filesystem path to SQLite file. 中文：SQLite 文件路径。
+ * @param connection Reader being returned. 中文：被归还的连接。
  * @return void. 中文：无返回值。
- * @throws std::runtime_error When sqlite3_open fails. 中文：打开失败抛出异常。
+ * @throws None. 中文：不抛出异常。
  */
-void DatabaseManager::openDatabase(const std::string& path) {
-    sqlite3* rawHandle = nullptr;
-    int rc = sqlite3_open(path.c_str(), &rawHandle);
-    if (rc != SQLITE_OK) {
-        std::string message = buildErrorMessage("Failed to open database", rawHandle);
-        if (rawHandle != nullptr) {
-            sqlite3_close(rawHandle);
-        }
-        throw std::runtime_error(message);
+void DatabaseManager::releaseReader(ReadConnection& connection) const noexcept {
+    {
+        std::lock_guard<std::mutex> poolLock(m_readPoolMutex);
+        m_readerCacheStats.hits += connection.stats.hits;
+        m_readerCacheStats.misses += connection.stats.misses;
+        connection.stats = StatementCacheStats{};
+        connection.cachedCount = connection.statementCache.size();
+        connection.leased = false;
     }
-    m_db.reset(rawHandle);
-    m_databasePath = path;
+    m_readPoolIdle.notify_all();
+}
+
+DatabaseManager::ReadLease::ReadLease(const DatabaseManager& owner, ReadConnection* connection)
+    : m_owner(owner), m_connection(connection), m_writerLock() {}
+
+DatabaseManager::ReadLease::ReadLease(const DatabaseManager& owner)
+    : m_owner(owner), m_connection(nullptr), m_writerLock(owner.m_mutex) {}
+
+DatabaseManager::ReadLease::~ReadLease() {
+    if (m_connection != nullptr) {
+        m_owner.releaseReader(*m_connection);
+    }
+}
+
+sqlite3* DatabaseManager::ReadLease::handle() const noexcept {
+    return m_connection != nullptr ? m_connection->handle.get() : m_owner.m_db.get();
+}
+
+DatabaseManager::StatementHandle DatabaseManager::ReadLease::prepare(const std::string& sql) const {
+    if (m_connection == nullptr) {
+        return m_owner.prepareStatement(sql);
+    }
+    return prepareCachedStatement(m_connection->handle.get(), m_connection->statementCache, m_connection->stats, sql);
 }
 
 /**
@@ -1697,18 +6711,272 @@ void DatabaseManager::openDatabase(const std::string& path) {
  * 中文：安全关闭 sqlite 句柄。
  *
  * Business logic: resetting unique_ptr keeps destructor idempotent, so repeated shutdown attempts are safe.
- * 中文：重置 unique_ptr 让析构函数可多次调用而不会崩溃。
+ * Cached statements still checked out on this thread would keep a pointer into their cache slot; in that case
+ * the close is refused and the connection stays open rather than leaving the releaser dangling.
+ * 中文：重置 unique_ptr 让析构函数可多次调用而不会崩溃。持有写锁后，其他线程的语句句柄均已归还；
+ *       当前线程仍持有缓存语句时拒绝关闭并保留连接，避免句柄归还时写入已释放的缓存槽。
  *
  * @return void. 中文：无返回值。
  * @throws None. 中文：不抛出异常。
  */
 void DatabaseManager::closeDatabase() noexcept {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    if (hasStatementsInUse()) {
+        qWarning() << "closeDatabase refused: cached statements are still checked out";
+        return;
+    }
+    stopCheckpointer();
+    if (m_initialized && !m_checkpointPath.empty()) {
+        try {
+            writeCheckpoint(false);
+        } catch (const std::exception& error) {
+            qWarning() << "Final in-memory checkpoint failed:" << error.what();
+        }
+    }
+    m_checkpointPath.clear();
+    // English: cached statements must be finalized first, otherwise sqlite3_close reports SQLITE_BUSY.
+    // 中文：必须先释放缓存语句，否则 sqlite3_close 会因存在未完成语句而返回 SQLITE_BUSY。
+    closeReadPool();
+    m_statementCache.clear();
     if (m_db != nullptr) {
         m_db.reset();
     }
     m_initialized = false;
 }
 
+/**
+ * @brief 写连接的缓存语句是否仍有句柄未归还；调用方持有写锁。
+ */
+bool DatabaseManager::hasStatementsInUse() const noexcept {
+    return std::any_of(m_statementCache.begin(), m_statementCache.end(),
+                       [](const auto& entry) { return entry.second.inUse; });
+}
+
+namespace {
+/**
+ * @brief 连接 main 库的数据版本，每次提交递增；与 total_changes 不同，DDL 与 user_version 变更也会计入。
+ */
+unsigned int dataVersion(sqlite3* handle) noexcept {
+    unsigned int version = 0;
+    sqlite3_file_control(handle, "main", SQLITE_FCNTL_DATA_VERSION, &version);
+    return version;
+}
+}  // namespace
+
+/**
+ * @brief Copy the database file into the freshly opened :memory: connection.
+ * 中文：把文件整体复制进刚打开的内存库；文件不存在时保持空库，由 migrateSchema 建表，首个检查点创建文件。
+ *
+ * @param path File to load. 中文：要载入的文件。
+ * @return void. 中文：无返回值。
+ * @throws std::runtime_error When the file exists but cannot be copied. 中文：文件存在但复制失败时抛出异常。
+ */
+void DatabaseManager::loadIntoMemory(const std::string& path) {
+    sqlite3* rawSource = nullptr;
+    const int openRc = sqlite3_open_v2(path.c_str(), &rawSource, SQLITE_OPEN_READONLY, nullptr);
+    DatabaseHandle source(rawSource, &sqlite3_close);
+    if (openRc == SQLITE_OK) {
+        sqlite3_busy_timeout(rawSource, 2000);
+        sqlite3_backup* backup = sqlite3_backup_init(m_db.get(), "main", rawSource, "main");
+        if (backup == nullptr) {
+            throw std::runtime_error(buildErrorMessage("Failed to load database into memory", m_db.get()));
+        }
+        const int rc = sqlite3_backup_step(backup, -1);
+        sqlite3_backup_finish(backup);
+        if (rc != SQLITE_DONE) {
+            throw std::runtime_error(buildErrorMessage("Failed to load database into memory", m_db.get()));
+        }
+    } else if (openRc != SQLITE_CANTOPEN) {
+        throw std::runtime_error(buildErrorMessage("Failed to open database for loading", rawSource));
+    }
+    m_checkpointedVersion.store(dataVersion(m_db.get()));
+}
+
+/**
+ * @brief Write the in-memory database back to m_checkpointPath.
+ * 中文：经 copyMemoryImage 以 backup API 分步写入文件，目标在单个写事务中更新，写到一半崩溃时文件仍是上一个检查点；
+ *       写锁按步持有，不额外复制整库映像，内存占用与单次持锁时间都不随库大小增长。
+ *       后台检查点只在步间以 try_lock 取写锁，并在关闭或有前台检查点等待时放弃本轮（文件保持原样）；
+ *       前台检查点（关闭、checkpointToDisk）全程持有写锁，先登记再等待写回互斥量，正在进行的后台检查点因此让出。
+ *
+ * @param background Called from the checkpointer thread. 中文：是否由后台检查点线程调用。
+ * @return true if the file was written. 中文：写回文件时返回 true。
+ * @throws std::runtime_error When opening or writing the file fails. 中文：打开或写入文件失败时抛出异常。
+ */
+bool DatabaseManager::writeCheckpoint(bool background) {
+    std::unique_lock<WriterMutex> writerLock(m_mutex, std::defer_lock);
+    std::unique_lock<std::mutex> writeLock(m_checkpointWriteMutex, std::defer_lock);
+    const auto yieldToOthers = [this]() {
+        return m_checkpointerStopping.load() || m_foregroundCheckpoints.load() > 0;
+    };
+    if (background) {
+        if (!writeLock.try_lock()) {
+            return false;
+        }
+        while (!writerLock.try_lock()) {
+            if (yieldToOthers()) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    } else {
+        writerLock.lock();
+        ++m_foregroundCheckpoints;
+        writeLock.lock();
+        --m_foregroundCheckpoints;
+    }
+    if (m_db == nullptr || m_checkpointPath.empty() || m_transactionOwner.load() == std::this_thread::get_id()) {
+        return false;
+    }
+    if (dataVersion(m_db.get()) == m_checkpointedVersion.load()) {
+        return false;
+    }
+    const std::string target = m_checkpointPath;
+    const std::int64_t pageSize = readPragmaInteger("PRAGMA page_size");
+    if (background) {
+        writerLock.unlock();
+    }
+
+    ROVE_SCOPED_TIMER(Database, "memoryCheckpoint.write");
+    sqlite3* rawTarget = nullptr;
+    const int openRc = sqlite3_open(target.c_str(), &rawTarget);
+    DatabaseHandle file(rawTarget, &sqlite3_close);
+    if (openRc != SQLITE_OK) {
+        throw std::runtime_error(buildErrorMessage("Failed to open checkpoint file", rawTarget));
+    }
+    sqlite3_busy_timeout(rawTarget, 2000);
+    std::int64_t pages = 0;
+    const auto version = copyMemoryImage(rawTarget, kCheckpointPagesPerStep, std::chrono::milliseconds(0), background,
+                                         background ? std::function<bool()>(yieldToOthers) : std::function<bool()>(),
+                                         &pages, nullptr);
+    if (!version.has_value()) {
+        return false;
+    }
+    m_checkpointedVersion.store(*version);
+    ROVE_COUNTER_ADD(Database, "memoryCheckpoint.bytes", static_cast<std::uint64_t>(pages * pageSize));
+    return true;
+}
+
+std::optional<unsigned int> DatabaseManager::copyMemoryImage(sqlite3* target, int pagesPerStep,
+                                                             std::chrono::milliseconds pause, bool pollLock,
+                                                             const std::function<bool()>& abort, std::int64_t* pages,
+                                                             std::int64_t* steps) {
+    const auto aborted = [&abort]() { return abort && abort(); };
+    const auto acquire = [&]() {
+        std::unique_lock<WriterMutex> lock(m_mutex, std::defer_lock);
+        if (!pollLock) {
+            lock.lock();
+            return lock;
+        }
+        while (!lock.try_lock() && !aborted()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return lock;
+    };
+
+    sqlite3* source = nullptr;
+    sqlite3_backup* backup = nullptr;
+    {
+        auto lock = acquire();
+        if (!lock.owns_lock() || m_db == nullptr || m_checkpointPath.empty()) {
+            return std::nullopt;
+        }
+        source = m_db.get();
+        backup = sqlite3_backup_init(target, "main", source, "main");
+        if (backup == nullptr) {
+            throw std::runtime_error(buildErrorMessage("Failed to start copying the in-memory database", target));
+        }
+    }
+    // 中文：写连接以 sqlite3_close_v2 关闭，复制未结束时连接只变为僵尸，sqlite3_backup_finish 之后才真正释放，
+    //       因此每步拿到写锁后比较句柄即可判断期间是否被关闭或重新打开。
+    std::optional<unsigned int> version;
+    int rc = SQLITE_OK;
+    while (!aborted()) {
+        auto lock = acquire();
+        if (!lock.owns_lock() || m_db.get() != source) {
+            break;
+        }
+        rc = sqlite3_backup_step(backup, std::max(1, pagesPerStep));
+        if (steps != nullptr) {
+            ++*steps;
+        }
+        if (rc == SQLITE_DONE) {
+            version = dataVersion(source);
+            if (pages != nullptr) {
+                *pages = sqlite3_backup_pagecount(backup);
+            }
+            break;
+        }
+        if (rc != SQLITE_OK && rc != SQLITE_BUSY && rc != SQLITE_LOCKED) {
+            break;
+        }
+        lock.unlock();
+        if (pause.count() > 0) {
+            std::this_thread::sleep_for(pause);
+        }
+    }
+    sqlite3_backup_finish(backup);
+    if (!version.has_value() && rc != SQLITE_OK && rc != SQLITE_BUSY && rc != SQLITE_LOCKED) {
+        throw std::runtime_error(buildErrorMessage("Failed to copy the in-memory database", target));
+    }
+    return version;
+}
+
+bool DatabaseManager::isInMemory() const {
+    std::lock_guard<WriterMutex> lock(m_mutex);
+    return !m_checkpointPath.empty();
+}
+
+std::int64_t DatabaseManager::copyMemoryDatabase(sqlite3* target, int pagesPerStep, std::chrono::milliseconds pause,
+                                                 const std::atomic<bool>* cancelled, std::int64_t* steps) {
+    if (!isInMemory()) {
+        throw std::runtime_error("Database is not in memory mode");
+    }
+    std::int64_t pages = 0;
+    const auto version = copyMemoryImage(
+        target, pagesPerStep, pause, false, [cancelled]() { return cancelled != nullptr && cancelled->load(); },
+        &pages, steps);
+    if (!version.has_value()) {
+        throw std::runtime_error(cancelled != nullptr && cancelled->load() ? "Backup cancelled"
+                                                                           : "Database closed during backup");
+    }
+    return pages;
+}
+
+/**
+ * @brief Start the thread that checkpoints every @p intervalMs milliseconds.
+ * 中文：启动定时检查点线程；间隔不大于 0 时只在关闭时写回。
+ */
+void DatabaseManager::startCheckpointer(int intervalMs) {
+    if (intervalMs <= 0) {
+        return;
+    }
+    m_checkpointerStopping.store(false);
+    m_checkpointThread = std::thread([this, interval = std::chrono::milliseconds(intervalMs)]() {
+        std::unique_lock<std::mutex> lock(m_checkpointerMutex);
+        while (!m_checkpointerWake.wait_for(lock, interval, [this] { return m_checkpointerStopping.load(); })) {
+            lock.unlock();
+            try {
+                writeCheckpoint(true);
+            } catch (const std::exception& error) {
+                qWarning() << "In-memory checkpoint failed:" << error.what();
+            }
+            lock.lock();
+        }
+    });
+}
+
+void DatabaseManager::stopCheckpointer() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(m_checkpointerMutex);
+        m_checkpointerStopping.store(true);
+    }
+    m_checkpointerWake.notify_all();
+    if (m_checkpointThread.joinable()) {
+        m_checkpointThread.join();
+    }
+}
+
 /**
  * @brief Execute SQL commands that do not return result sets (DDL / DML without rows).
  * 中文：执行不返回结果集的 SQL 语句（如 DDL 或无结果集的 DML）。
@@ -1721,6 +6989,13 @@ void DatabaseManager::closeDatabase() noexcept {
  * @throws std::runtime_error When sqlite3_exec reports an error. 中文：执行失败抛出异常。
  */
 void DatabaseManager::executeNonQuery(const std::string& sql) {
+#if ROVE_ENABLE_METRICS
+    std::optional<metrics::ScopedTimer> timer;
+    if (metrics::isEnabled()) {
+        timer.emplace(metrics::Registry::instance().histogram(metrics::Subsystem::Database, "statement",
+                                                              statementMetricId(sql)));
+    }
+#endif
     char* errorMessage = nullptr;
     int rc = sqlite3_exec(m_db.get(), sql.c_str(), nullptr, nullptr, &errorMessage);
     if (rc != SQLITE_OK) {
@@ -1732,16 +7007,26 @@ void DatabaseManager::executeNonQuery(const std::string& sql) {
         }
         throw std::runtime_error(buildErrorMessage(message, m_db.get()));
     }
+    if (!tPendingSlowQueries.empty()) {
+        flushSlowQueries(m_db.get());
+    }
+    if (isSchemaStatement(sql)) {
+        invalidateStatementCache();
+    }
 }
 
 /**
- * @brief Prepare a sqlite3_stmt and wrap it with std::unique_ptr for automatic finalization.
- * 中文：准备 sqlite3_stmt，并用 std::unique_ptr 在作用域结束时自动调用 sqlite3_finalize。
+ * @brief Fetch a prepared sqlite3_stmt from the statement cache, compiling it on first use.
+ * 中文：从语句缓存中取出预编译语句，首次使用时才调用 sqlite3_prepare 编译。
  *
- * Business logic: RAII statements prevent leaks even when exceptions propagate to the Qt event loop.
- * 中文：RAII 语句即使在异常回到 Qt 事件循环时也不会泄露句柄。
+ * Business logic: the same SQL text is executed thousands of times per session (task resets, achievement
+ * progress), so re-parsing and re-planning dominated the bulk update paths. Cached statements are reset and
+ * their bindings cleared when the returned handle goes out of scope. If the same SQL is already checked out
+ * (re-entrant use), a private uncached statement is prepared instead.
+ * 中文：同一条 SQL 在一次会话中会执行成千上万次（任务重置、成就进度等），反复解析与生成执行计划成为批量更新的瓶颈。
+ * 缓存语句在返回的句柄离开作用域时自动 reset 并清除绑定；若同一语句已被占用（重入场景），则临时编译一条不缓存的语句。
  *
- * @param sql SQL statement text. 中文：SQL 语句文本。
+ * @param sql SQL statement text, also used as cache key. 中文：SQL 文本，同时作为缓存键。
  * @return Managed StatementHandle. 中文：返回自动管理的 StatementHandle。
  * @throws std::runtime_error When database is not initialized or prepare fails. 中文：数据库未初始化或准备失败时抛出异常。
  */
@@ -1749,12 +7034,125 @@ DatabaseManager::StatementHandle DatabaseManager::prepareStatement(const std::st
     if (!m_db) {
         throw std::runtime_error("Database is not initialized");
     }
+    return prepareCachedStatement(m_db.get(), m_statementCache, m_statementCacheStats, sql);
+}
+
+/**
+ * @brief Shared cache lookup used by the writer connection and every pooled reader.
+ * 中文：写连接与各只读连接共用的缓存查找逻辑。
+ *
+ * @param handle Connection that owns the cache. 中文：缓存所属连接。
+ * @param cache Statement cache of that connection. 中文：该连接的语句缓存。
+ * @param stats Counters to update. 中文：需要更新的计数。
+ * @param sql SQL statement text. 中文：SQL 文本。
+ * @return Managed StatementHandle. 中文：返回自动管理的 StatementHandle。
+ * @throws std::runtime_error When prepare fails. 中文：准备失败时抛出异常。
+ */
+DatabaseManager::StatementHandle DatabaseManager::prepareCachedStatement(sqlite3* handle,
+                                                                         StatementCache& cache,
+                                                                         StatementCacheStats& stats,
+                                                                         const std::string& sql) {
+    auto& slot = cache[sql];
+    if (slot.statement != nullptr && !slot.inUse) {
+        ++stats.hits;
+        slot.inUse = true;
+        return StatementHandle(slot.statement.get(), makeReleaser(&slot.inUse, &slot.timing, slot.statement.get()));
+    }
+
+    ++stats.misses;
+    const bool cacheable = slot.statement == nullptr;
     sqlite3_stmt* stmt = nullptr;
-    int rc = sqlite3_prepare_v2(m_db.get(), sql.c_str(), -1, &stmt, nullptr);
+    const unsigned int flags = cacheable ? SQLITE_PREPARE_PERSISTENT : 0U;
+    int rc = sqlite3_prepare_v3(handle, sql.c_str(), -1, flags, &stmt, nullptr);
     if (rc != SQLITE_OK) {
-        throw std::runtime_error(buildErrorMessage("Failed to prepare statement", m_db.get()));
+        if (cacheable) {
+            cache.erase(sql);
+        }
+        throw std::runtime_error(buildErrorMessage("Failed to prepare statement", handle));
+    }
+    if (!cacheable) {
+        return StatementHandle(stmt, makeReleaser(nullptr, nullptr, stmt));
+    }
+    slot.statement.reset(stmt);
+    slot.inUse = true;
+    return StatementHandle(stmt, makeReleaser(&slot.inUse, &slot.timing, stmt));
+}
+
+/**
+ * @brief Return a statement to the cache (reset + clear bindings) or finalize an uncached one.
+ * 中文：将缓存语句重置并清除绑定后归还缓存；非缓存语句则直接 finalize。
+ *
+ * @param statement Statement being released. 中文：被释放的语句。
+ * @return void. 中文：无返回值。
+ * @throws None. 中文：不抛出异常。
+ */
+void DatabaseManager::StatementReleaser::operator()(sqlite3_stmt* statement) const noexcept {
+    if (statement == nullptr) {
+        return;
+    }
+#if ROVE_ENABLE_METRICS
+    if (timing.latency != nullptr) {
+        timing.latency->record(metrics::ScopedTimer::elapsedNanoseconds(startedAt));
+        const std::uint64_t rows = takeStatementRows(statement);
+        timing.rows->add(rows);
+        ROVE_COUNTER_ADD(Database, "rows_read", rows);
     }
-    return StatementHandle(stmt, &sqlite3_finalize);
+#endif
+    sqlite3* handle = sqlite3_db_handle(statement);
+    if (inUse == nullptr) {
+        sqlite3_finalize(statement);
+    } else {
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+        *inUse = false;
+    }
+    if (!tPendingSlowQueries.empty()) {
+        flushSlowQueries(handle);
+    }
+}
+
+/**
+ * @brief Build the releaser for a checked-out statement and, when metrics are on, start timing it.
+ * 中文：构造语句句柄的删除器；埋点开启时解析该 SQL 的延迟与行数埋点（缓存语句只解析一次）并开始计时。
+ *
+ * Business logic: latency covers the whole checkout, from handle acquisition through stepping and column reads
+ * to release, which is what the calling manager actually waits for.
+ * 中文：计时区间为句柄取出到归还，包含绑定、逐行 step 与读列，即调用方真正等待的时间。
+ *
+ * @param inUse Cache slot flag, nullptr for uncached statements. 中文：缓存槽占用标记，非缓存语句为空。
+ * @param cached Metric slots cached on the statement slot, nullptr for uncached statements. 中文：缓存槽上的埋点。
+ * @param statement Statement being checked out. 中文：被取出的语句。
+ * @return Releaser for the StatementHandle. 中文：句柄删除器。
+ * @throws None. 中文：不抛出异常。
+ */
+DatabaseManager::StatementReleaser DatabaseManager::makeReleaser(bool* inUse,
+                                                                 StatementMetrics* cached,
+                                                                 sqlite3_stmt* statement) {
+    StatementReleaser releaser;
+    releaser.inUse = inUse;
+#if ROVE_ENABLE_METRICS
+    if (!metrics::isEnabled()) {
+        return releaser;
+    }
+    StatementMetrics resolved = cached != nullptr ? *cached : StatementMetrics{};
+    if (resolved.latency == nullptr) {
+        const char* sql = sqlite3_sql(statement);
+        const std::string label = statementMetricId(sql != nullptr ? std::string_view(sql) : std::string_view());
+        auto& registry = metrics::Registry::instance();
+        resolved.latency = &registry.histogram(metrics::Subsystem::Database, "statement", label);
+        resolved.rows = &registry.counter(metrics::Subsystem::Database, "statement.rows", label);
+        if (cached != nullptr) {
+            *cached = resolved;
+        }
+    }
+    releaser.timing = resolved;
+    releaser.startedAt = metrics::Clock::now();
+    tStatementRows.emplace_back(statement, 0);
+#else
+    static_cast<void>(cached);
+    static_cast<void>(statement);
+#endif
+    return releaser;
 }
 
 /**
@@ -1772,52 +7170,209 @@ bool DatabaseManager::isSuccessCode(int sqliteResult) {
     return sqliteResult == SQLITE_DONE || sqliteResult == SQLITE_ROW || sqliteResult == SQLITE_OK;
 }
 
+/**
+ * @brief 绑定任务更新语句参数（与 kUpdateTaskSql 的占位符顺序一致）。
+ */
+void DatabaseManager::bindTaskUpdate(sqlite3_stmt* statement, const TaskRecord& task) {
+    sqlite3_bind_text(statement, 1, task.name.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 2, task.description.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 3, task.type.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(statement, 4, task.difficulty);
+    sqlite3_bind_text(statement, 5, task.deadlineIso.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(statement, 6, task.completed ? 1 : 0);
+    sqlite3_bind_int(statement, 7, task.coinReward);
+    sqlite3_bind_int(statement, 8, task.growthReward);
+    bindAttributeSet(statement, 9, task.attributeReward);
+    sqlite3_bind_int(statement, 15, task.bonusStreak);
+    sqlite3_bind_text(statement, 16, task.customSettings.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(statement, 17, task.forgivenessCoupons);
+    sqlite3_bind_int(statement, 18, task.progressValue);
+    sqlite3_bind_int(statement, 19, task.progressGoal);
+    bindEpochMs(statement, 20, task.deadlineIso);
+    sqlite3_bind_int(statement, 21, task.id);
+}
+
+/**
+ * @brief 绑定成就更新语句参数（与 kUpdateAchievementSql 的占位符顺序一致）。
+ */
+void DatabaseManager::bindAchievementUpdate(sqlite3_stmt* statement, const AchievementRecord& record) {
+    bindUserReference(statement, 1, record.ownerId);
+    bindUserReference(statement, 2, record.creatorId);
+    sqlite3_bind_text(statement, 3, record.name.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 4, record.description.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 5, record.iconPath.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 6, record.color.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 7, record.type.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 8, record.rewardType.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 9, record.progressMode.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(statement, 10, record.progressValue);
+    sqlite3_bind_int(statement, 11, record.progressGoal);
+    sqlite3_bind_int(statement, 12, record.rewardCoins);
+    bindAttributeSet(statement, 13, record.rewardAttributes);
+    sqlite3_bind_text(statement, 19, record.rewardItems.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(statement, 20, record.unlocked ? 1 : 0);
+    if (record.completionTime.empty()) {
+        sqlite3_bind_null(statement, 21);
+    } else {
+        sqlite3_bind_text(statement, 21, record.completionTime.c_str(), -1, SQLITE_TRANSIENT);
+    }
+    sqlite3_bind_blob(statement, 22, record.conditions.data(), static_cast<int>(record.conditions.size()),
+                      SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 23, record.galleryGroup.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 24, record.createdAt.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 25, record.specialMetadata.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(statement, 26, record.id);
+}
+
+/**
+ * @brief 绑定日志插入语句参数（与 kInsertLogSql 的占位符顺序一致）。
+ */
+void DatabaseManager::bindLogInsert(sqlite3_stmt* statement, const LogRecord& record) {
+    sqlite3_bind_text(statement, 1, record.timestampIso.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 2, record.type.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 3, record.content.c_str(), -1, SQLITE_TRANSIENT);
+    if (record.relatedId.has_value()) {
+        sqlite3_bind_int(statement, 4, *record.relatedId);
+    } else {
+        sqlite3_bind_null(statement, 4);
+    }
+    sqlite3_bind_text(statement, 5, record.attributeChanges.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(statement, 6, record.levelChange);
+    sqlite3_bind_text(statement, 7, record.specialEvent.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 8, record.mood.c_str(), -1, SQLITE_TRANSIENT);
+    bindEpochMs(statement, 9, record.timestampIso);
+    sqlite3_bind_int(statement, 10, record.ownerId);
+    sqlite3_bind_int(statement, 11, record.templateId);
+}
+
+void DatabaseManager::indexLogRecord(int logId, const LogRecord& record) {
+    if (!m_logSearchIndexed) {
+        return;
+    }
+    auto stmt = prepareStatement("INSERT INTO logs_fts(rowid, content, special_event) VALUES (?, ?, ?)");
+    const std::string text =
+        record.templateId != 0 ? renderLogTemplate(record.templateId, record.content) : record.content;
+    sqlite3_bind_int(stmt.get(), 1, logId);
+    sqlite3_bind_text(stmt.get(), 2, text.data(), static_cast<int>(text.size()), SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 3, record.specialEvent.data(), static_cast<int>(record.specialEvent.size()),
+                      SQLITE_STATIC);
+    if (sqlite3_step(stmt.get()) != SQLITE_DONE) {
+        throw std::runtime_error(buildErrorMessage("Failed to index log record", m_db.get()));
+    }
+}
+
+void DatabaseManager::countManualLogActivity(const LogRecord& record) {
+    if (record.type != "Manual") {
+        return;
+    }
+    // 中文：时间戳无法解析时不知道该计入哪一天，跳过而不是记到 1970-01-01。
+    if (const auto timestampMs = isoToEpochMs(record.timestampIso)) {
+        recordDailyActivity(record.ownerId, *timestampMs, 0, 0, 1);
+    }
+}
+
+/**
+ * @brief 绑定库存插入语句参数（与 kInsertInventorySql 的占位符顺序一致）。
+ */
+void DatabaseManager::bindInventoryInsert(sqlite3_stmt* statement, const InventoryRecord& record) {
+    bindUserReference(statement, 1, record.ownerId);
+    sqlite3_bind_int(statement, 2, record.itemId);
+    sqlite3_bind_int(statement, 3, record.quantity);
+    sqlite3_bind_int(statement, 4, record.usedQuantity);
+    sqlite3_bind_text(statement, 5, record.status.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 6, record.purchaseTimeIso.c_str(), -1, SQLITE_TRANSIENT);
+    if (record.expirationTimeIso.empty()) {
+        sqlite3_bind_null(statement, 7);
+    } else {
+        sqlite3_bind_text(statement, 7, record.expirationTimeIso.c_str(), -1, SQLITE_TRANSIENT);
+    }
+    sqlite3_bind_text(statement, 8, record.luckyPayload.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 9, record.notes.c_str(), -1, SQLITE_TRANSIENT);
+    bindEpochMs(statement, 10, record.purchaseTimeIso);
+    bindEpochMs(statement, 11, record.expirationTimeIso);
+}
+
+/**
+ * @brief 绑定库存更新语句参数（与 kUpdateInventorySql 的占位符顺序一致）。
+ */
+void DatabaseManager::bindInventoryUpdate(sqlite3_stmt* statement, const InventoryRecord& record) {
+    bindUserReference(statement, 1, record.ownerId);
+    sqlite3_bind_int(statement, 2, record.itemId);
+    sqlite3_bind_int(statement, 3, record.quantity);
+    sqlite3_bind_int(statement, 4, record.usedQuantity);
+    sqlite3_bind_text(statement, 5, record.status.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 6, record.purchaseTimeIso.c_str(), -1, SQLITE_TRANSIENT);
+    if (record.expirationTimeIso.empty()) {
+        sqlite3_bind_null(statement, 7);
+    } else {
+        sqlite3_bind_text(statement, 7, record.expirationTimeIso.c_str(), -1, SQLITE_TRANSIENT);
+    }
+    sqlite3_bind_text(statement, 8, record.luckyPayload.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(statement, 9, record.notes.c_str(), -1, SQLITE_TRANSIENT);
+    bindEpochMs(statement, 10, record.purchaseTimeIso);
+    bindEpochMs(statement, 11, record.expirationTimeIso);
+    sqlite3_bind_int(statement, 12, record.id);
+}
+
 DatabaseManager::TaskRecord DatabaseManager::readTaskRecord(sqlite3_stmt* statement) const {
     TaskRecord record;
+    readTaskRecordInto(statement, record);
+    return record;
+}
+
+/**
+ * @brief 覆盖写入 record 的全部字段；流式读取逐行复用同一条记录，字符串字段沿用已有容量。
+ */
+void DatabaseManager::readTaskRecordInto(sqlite3_stmt* statement, TaskRecord& record) const {
     record.id = sqlite3_column_int(statement, 0);
-    record.name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
-    record.description = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
-    record.type = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
+    assignText(record.name, statement, 1);
+    assignText(record.description, statement, 2);
+    assignText(record.type, statement, 3);
     record.difficulty = sqlite3_column_int(statement, 4);
-    record.deadlineIso = reinterpret_cast<const char*>(sqlite3_column_text(statement, 5));
+    assignText(record.deadlineIso, statement, 5);
     record.completed = sqlite3_column_int(statement, 6) != 0;
     record.coinReward = sqlite3_column_int(statement, 7);
     record.growthReward = sqlite3_column_int(statement, 8);
-    record.attributeReward = reinterpret_cast<const char*>(sqlite3_column_text(statement, 9));
-    record.bonusStreak = sqlite3_column_int(statement, 10);
-    record.customSettings = reinterpret_cast<const char*>(sqlite3_column_text(statement, 11));
-    record.forgivenessCoupons = sqlite3_column_int(statement, 12);
-    record.progressValue = sqlite3_column_int(statement, 13);
-    record.progressGoal = sqlite3_column_int(statement, 14);
-    return record;
+    record.attributeReward = readAttributeSet(statement, 9);
+    record.bonusStreak = sqlite3_column_int(statement, 15);
+    assignText(record.customSettings, statement, 16);
+    record.forgivenessCoupons = sqlite3_column_int(statement, 17);
+    record.progressValue = sqlite3_column_int(statement, 18);
+    record.progressGoal = sqlite3_column_int(statement, 19);
+    record.deadlineMs = readEpochMs(statement, 20).value_or(0);
 }
 
 DatabaseManager::AchievementRecord DatabaseManager::readAchievementRecord(sqlite3_stmt* statement) const {
     AchievementRecord record;
+    readAchievementRecordInto(statement, record);
+    return record;
+}
+
+/**
+ * @brief 同 readTaskRecordInto，可空的 completion_time 为 NULL 时清空。
+ */
+void DatabaseManager::readAchievementRecordInto(sqlite3_stmt* statement, AchievementRecord& record) const {
     record.id = sqlite3_column_int(statement, 0);
-    record.owner = reinterpret_cast<const char*>(sqlite3_column_text(statement, 1));
-    record.creator = reinterpret_cast<const char*>(sqlite3_column_text(statement, 2));
-    record.name = reinterpret_cast<const char*>(sqlite3_column_text(statement, 3));
-    record.description = reinterpret_cast<const char*>(sqlite3_column_text(statement, 4));
-    record.iconPath = reinterpret_cast<const char*>(sqlite3_column_text(statement, 5));
-    record.color = reinterpret_cast<const char*>(sqlite3_column_text(statement, 6));
-    record.type = reinterpret_cast<const char*>(sqlite3_column_text(statement, 7));
-    record.rewardType = reinterpret_cast<const char*>(sqlite3_column_text(statement, 8));
-    record.progressMode = reinterpret_cast<const char*>(sqlite3_column_text(statement, 9));
+    record.ownerId = sqlite3_column_int(statement, 1);
+    record.creatorId = sqlite3_column_int(statement, 2);  // 中文：NULL（系统模板）读作 0。
+    assignText(record.name, statement, 3);
+    assignText(record.description, statement, 4);
+    assignText(record.iconPath, statement, 5);
+    assignText(record.color, statement, 6);
+    assignText(record.type, statement, 7);
+    assignText(record.rewardType, statement, 8);
+    assignText(record.progressMode, statement, 9);
     record.progressValue = sqlite3_column_int(statement, 10);
     record.progressGoal = sqlite3_column_int(statement, 11);
     record.rewardCoins = sqlite3_column_int(statement, 12);
-    record.rewardAttributes = reinterpret_cast<const char*>(sqlite3_column_text(statement, 13));
-    record.rewardItems = reinterpret_cast<const char*>(sqlite3_column_text(statement, 14));
-    record.unlocked = sqlite3_column_int(statement, 15) != 0;
-    if (sqlite3_column_type(statement, 16) != SQLITE_NULL) {
-        record.completionTime = reinterpret_cast<const char*>(sqlite3_column_text(statement, 16));
-    }
-    record.conditions = reinterpret_cast<const char*>(sqlite3_column_text(statement, 17));
-    record.galleryGroup = reinterpret_cast<const char*>(sqlite3_column_text(statement, 18));
-    record.createdAt = reinterpret_cast<const char*>(sqlite3_column_text(statement, 19));
-    record.specialMetadata = reinterpret_cast<const char*>(sqlite3_column_text(statement, 20));
-    return record;
+    record.rewardAttributes = readAttributeSet(statement, 13);
+    assignText(record.rewardItems, statement, 19);
+    record.unlocked = sqlite3_column_int(statement, 20) != 0;
+    assignText(record.completionTime, statement, 21);
+    assignBytes(record.conditions, statement, 22);
+    assignText(record.galleryGroup, statement, 23);
+    assignText(record.createdAt, statement, 24);
+    assignText(record.specialMetadata, statement, 25);
 }
 
 DatabaseManager::ShopItemRecord DatabaseManager::readShopItemRecord(sqlite3_stmt* statement) const {
@@ -1853,8 +7408,7 @@ DatabaseManager::InventoryRecord DatabaseManager::readInventoryRecord(sqlite3_st
     InventoryRecord record;
     record.id = sqlite3_column_int(statement, 0);
     record.itemId = sqlite3_column_int(statement, 1);
-    const unsigned char* ownerText = sqlite3_column_text(statement, 2);
-    record.owner = ownerText == nullptr ? std::string() : reinterpret_cast<const char*>(ownerText);
+    record.ownerId = sqlite3_column_int(statement, 2);
     record.quantity = sqlite3_column_int(statement, 3);
     record.usedQuantity = sqlite3_column_int(statement, 4);
     const unsigned char* statusText = sqlite3_column_text(statement, 5);
@@ -1867,6 +7421,8 @@ DatabaseManager::InventoryRecord DatabaseManager::readInventoryRecord(sqlite3_st
     record.luckyPayload = luckyText == nullptr ? std::string() : reinterpret_cast<const char*>(luckyText);
     const unsigned char* notesText = sqlite3_column_text(statement, 9);
     record.notes = notesText == nullptr ? std::string() : reinterpret_cast<const char*>(notesText);
+    record.purchaseTimeMs = readEpochMs(statement, 10).value_or(0);
+    record.expirationTimeMs = readEpochMs(statement, 11);
     return record;
 }
 
@@ -1875,24 +7431,37 @@ DatabaseManager::InventoryRecord DatabaseManager::readInventoryRecord(sqlite3_st
  */
 DatabaseManager::LogRecord DatabaseManager::readLogRecord(sqlite3_stmt* statement) const {
     LogRecord record;
+    readLogRecordInto(statement, record);
+    return record;
+}
+
+/**
+ * @brief 同 readTaskRecordInto，可空的 related_id 为 NULL 时重置。
+ */
+void DatabaseManager::readLogRecordInto(sqlite3_stmt* statement, LogRecord& record) const {
     record.id = sqlite3_column_int(statement, 0);
-    const unsigned char* ts = sqlite3_column_text(statement, 1);
-    record.timestampIso = ts == nullptr ? std::string() : reinterpret_cast<const char*>(ts);
-    const unsigned char* typeText = sqlite3_column_text(statement, 2);
-    record.type = typeText == nullptr ? std::string() : reinterpret_cast<const char*>(typeText);
-    const unsigned char* contentText = sqlite3_column_text(statement, 3);
-    record.content = contentText == nullptr ? std::string() : reinterpret_cast<const char*>(contentText);
+    assignText(record.timestampIso, statement, 1);
+    assignText(record.type, statement, 2);
+    if (sqlite3_column_type(statement, 3) == SQLITE_BLOB) {
+        auto text = inflateLogContent(sqlite3_column_blob(statement, 3), sqlite3_column_bytes(statement, 3));
+        if (!text.has_value()) {
+            throw std::runtime_error("Corrupt compressed content in log " + std::to_string(record.id));
+        }
+        record.content = std::move(*text);
+    } else {
+        assignText(record.content, statement, 3);
+    }
     if (sqlite3_column_type(statement, 4) != SQLITE_NULL) {
         record.relatedId = sqlite3_column_int(statement, 4);
+    } else {
+        record.relatedId.reset();
     }
-    const unsigned char* attrText = sqlite3_column_text(statement, 5);
-    record.attributeChanges = attrText == nullptr ? std::string() : reinterpret_cast<const char*>(attrText);
+    assignText(record.attributeChanges, statement, 5);
     record.levelChange = sqlite3_column_int(statement, 6);
-    const unsigned char* specialText = sqlite3_column_text(statement, 7);
-    record.specialEvent = specialText == nullptr ? std::string() : reinterpret_cast<const char*>(specialText);
-    const unsigned char* moodText = sqlite3_column_text(statement, 8);
-    record.mood = moodText == nullptr ? std::string() : reinterpret_cast<const char*>(moodText);
-    return record;
+    assignText(record.specialEvent, statement, 7);
+    assignText(record.mood, statement, 8);
+    record.timestampMs = static_cast<std::int64_t>(sqlite3_column_int64(statement, 9));
+    record.templateId = sqlite3_column_int(statement, 10);
 }
 
 /**
@@ -1915,6 +7484,7 @@ DatabaseManager::GrowthSnapshotRecord DatabaseManager::readGrowthSnapshotRecord(
     record.completedTasks = sqlite3_column_int(statement, 11);
     record.failedTasks = sqlite3_column_int(statement, 12);
     record.manualLogCount = sqlite3_column_int(statement, 13);
+    record.timestampMs = readEpochMs(statement, 14).value_or(0);
     return record;
 }
 
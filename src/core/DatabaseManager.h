@@ -1,16 +1,34 @@
 #ifndef DATABASEMANAGER_H
 #define DATABASEMANAGER_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
-#include <set>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
 
 #include <sqlite3.h>
 
+#include "MemoryAccounting.h"
+#include "Metrics.h"
+#include "ProfileArchive.h"
+#include "SnapshotSeries.h"
+#include "SortedIdSet.h"
+#include "SqliteMemory.h"
+#include "User.h"
+
 namespace rove::data {
 
 /**
@@ -32,6 +50,73 @@ public:
      */
     static DatabaseManager& instance();
 
+    /**
+     * @struct ConnectionProfile
+     * @brief PRAGMA settings applied to every connection right after it is opened.
+     * 中文：连接打开后立即应用的 PRAGMA 配置（日志模式、同步级别、内存映射、页缓存等）。
+     *
+     * Business logic: the default rollback journal with full fsync made every task completion pay several
+     * disk flushes on laptop HDDs; presets let the caller trade durability for latency explicitly.
+     * 中文：默认回滚日志 + 完全同步会让每次完成任务都触发多次磁盘刷新，预设方案让调用者显式权衡持久性与延迟。
+     */
+    struct ConnectionProfile {
+        enum class SynchronousMode { Off = 0, Normal = 1, Full = 2, Extra = 3 };
+        enum class TempStore { Default = 0, File = 1, Memory = 2 };
+
+        std::string name = "balanced";                       //!< Preset name for diagnostics. 中文：预设名称。
+        bool walJournal = true;                              //!< journal_mode=WAL. 中文：是否启用 WAL 日志。
+        SynchronousMode synchronous = SynchronousMode::Normal;  //!< PRAGMA synchronous. 中文：同步级别。
+        std::int64_t mmapSizeBytes = 64LL * 1024 * 1024;     //!< PRAGMA mmap_size. 中文：内存映射大小。
+        int cacheSizeKiB = 8192;                             //!< PRAGMA cache_size (KiB). 中文：页缓存大小（KiB）。
+        TempStore tempStore = TempStore::Memory;             //!< PRAGMA temp_store. 中文：临时表存放位置。
+        int busyTimeoutMs = 2000;                            //!< sqlite3_busy_timeout. 中文：忙等待超时（毫秒）。
+        int readConnections = 2;                             //!< Read-only WAL connections in the pool. 中文：只读连接池大小。
+        bool inMemory = false;                               //!< Run on :memory:, checkpoint to the file. 中文：在内存库上运行，定期写回文件。
+        int memoryCheckpointIntervalMs = 30000;              //!< Max data-loss window in memory mode. 中文：内存模式的检查点间隔，即最多丢失的时长；0 表示只在关闭时写回。
+
+        /**
+         * @brief Full fsync on every commit; safest against power loss.
+         * 中文：每次提交都完整同步，断电最安全。
+         */
+        [[nodiscard]] static ConnectionProfile durable();
+
+        /**
+         * @brief WAL + synchronous=NORMAL; durable across crashes, last commits may roll back on power loss.
+         * 中文：WAL + NORMAL 同步，进程崩溃不丢数据，断电时可能回退最后几次提交。
+         */
+        [[nodiscard]] static ConnectionProfile balanced();
+
+        /**
+         * @brief WAL + synchronous=OFF with larger caches; lowest UI latency.
+         * 中文：WAL + 关闭同步并加大缓存，界面响应最快。
+         */
+        [[nodiscard]] static ConnectionProfile fastInteractive();
+
+        /**
+         * @brief Load the file into :memory: at startup and write it back periodically and on close.
+         * 中文：启动时把文件整体载入内存库，读写都在内存中进行，按间隔及关闭时写回文件；
+         *       适合展示机、基准与无界面测试。进程崩溃会丢失最近一个检查点间隔内的写入。
+         *       检查点与备份经 sqlite3_backup 分步复制内存库，日志归档写在检查点文件旁。
+         */
+        [[nodiscard]] static ConnectionProfile inMemoryCheckpointed();
+    };
+
+    /**
+     * @struct AppliedConnectionSettings
+     * @brief Values read back from SQLite after applying a ConnectionProfile.
+     * 中文：应用连接配置后从 SQLite 读回的实际生效值（例如内存数据库无法启用 WAL）。
+     */
+    struct AppliedConnectionSettings {
+        std::string profileName;      //!< Requested preset. 中文：请求的预设名称。
+        std::string journalMode;      //!< Effective journal_mode. 中文：实际日志模式。
+        int synchronous = 0;          //!< Effective synchronous level. 中文：实际同步级别。
+        std::int64_t mmapSizeBytes = 0;  //!< Effective mmap_size. 中文：实际内存映射大小。
+        int cacheSize = 0;            //!< Raw cache_size (negative = KiB). 中文：原始 cache_size 值（负数表示 KiB）。
+        int tempStore = 0;            //!< Effective temp_store. 中文：实际临时存储位置。
+        int busyTimeoutMs = 0;        //!< Effective busy timeout. 中文：实际忙等待超时。
+        int readConnections = 0;      //!< Opened read-only connections (0 when not in WAL). 中文：实际打开的只读连接数（非 WAL 时为 0）。
+    };
+
     /**
      * @brief Initialize connection and ensure schema exists.
      * 中文：初始化数据库连接并确保数据表存在。
@@ -40,10 +125,21 @@ public:
      * 中文：显式初始化让调用者能够指定要使用的 SQLite 文件。
      *
      * @param databasePath Path to database file. 中文：数据库文件路径。
+     * @param profile PRAGMA preset applied to the connection. 中文：应用到连接上的 PRAGMA 预设。
      * @return void. 中文：无返回值。
      * @throws std::runtime_error On failure to open DB or create tables. 中文：打开或建表失败抛出异常。
      */
-    void initialize(const std::string& databasePath);
+    void initialize(const std::string& databasePath,
+                    const ConnectionProfile& profile = ConnectionProfile::balanced());
+
+    /**
+     * @brief Report the PRAGMA values that are actually in effect.
+     * 中文：报告当前连接实际生效的 PRAGMA 配置。
+     *
+     * @return Settings read back after the last initialize(). 中文：最近一次初始化后读回的配置。
+     * @throws None. 中文：不抛出异常。
+     */
+    [[nodiscard]] AppliedConnectionSettings appliedConnectionSettings() const;
 
     /**
      * @brief Determine whether a valid SQLite handle is present.
@@ -86,7 +182,8 @@ public:
         std::string password;       //!< Plain password (demo). 中文：演示用密码。
         int level = 1;              //!< Player level. 中文：等级。
         int currency = 0;           //!< Currency amount. 中文：货币。
-        std::string attributes;     //!< Serialized attributes. 中文：序列化属性。
+        std::string attributes;     //!< Serialized growth/progress stats. 中文：成长值与统计的键值串。
+        User::AttributeSet attributeSet;  //!< Six attribute columns. 中文：六维属性整数列。
     };
 
     /**
@@ -95,15 +192,17 @@ public:
      */
     struct TaskRecord {
         int id = -1;                    //!< 主键 ID。
+        int ownerId = 0;                //!< 所属用户 users.id，仅在插入时写入。
         std::string name;               //!< 任务名称。
         std::string description;        //!< 任务描述。
         std::string type;               //!< 任务类型（Daily/Weekly/Semester/Custom）。
         int difficulty = 1;             //!< 难度星级。
         std::string deadlineIso;        //!< 截止时间，ISO8601 字符串。
+        std::int64_t deadlineMs = 0;    //!< deadline_ms 列，读取时填充（0 表示无法解析）；写入时由 deadlineIso 推导。
         bool completed = false;         //!< 完成状态。
         int coinReward = 0;             //!< 基础兰州币奖励。
         int growthReward = 0;           //!< 成长值奖励。
-        std::string attributeReward;    //!< 属性奖励序列化结果。
+        User::AttributeSet attributeReward;  //!< 属性奖励（attr_* 六列）。
         int bonusStreak = 0;            //!< 连续完成次数。
         std::string customSettings;     //!< 自定义配置（JSON 或键值对）。
         int forgivenessCoupons = 0;     //!< 宽恕券数量，用于处理失败。
@@ -111,10 +210,49 @@ public:
         int progressGoal = 100;         //!< 进度目标。
     };
 
+    /**
+     * @brief task_stats 的一行：某日某类任务的完成与失败次数；汇总查询时 day 为空。
+     */
+    struct TaskStatRecord {
+        std::string day;   //!< 本地日期 yyyy-MM-dd。
+        std::string type;  //!< 任务类型（Daily/Weekly/Semester/Custom）。
+        int completed = 0;
+        int failed = 0;
+    };
+
+    /**
+     * @brief daily_activity 的一行：某用户某个本地日期的任务完成次数、成长值增量与手动日志条数。
+     */
+    struct DailyActivityRecord {
+        std::int64_t julianDay = 0;  //!< 本地日期的儒略日，与 QDate::toJulianDay 一致
+        int completions = 0;
+        int growth = 0;
+        int logs = 0;
+    };
+
+    /**
+     * @brief progression_deltas 的一行：一次用户写回相对上次写回的等级、成长值与六维属性变化量。
+     */
+    struct ProgressionDeltaRecord {
+        int ownerId = 0;
+        std::int64_t timestampMs = 0;
+        int levelDelta = 0;
+        int growthDelta = 0;
+        User::AttributeSet attributeDelta;
+    };
+
+    /**
+     * @brief 时间点之前最近的一条成长快照，作为状态回放的起点。
+     */
+    struct SnapshotCheckpoint {
+        std::int64_t timestampMs = 0;
+        SnapshotSeries::Row values{};  //!< 列顺序同 SnapshotColumn
+    };
+
     struct AchievementRecord {
         int id = -1;
-        std::string owner;
-        std::string creator;
+        int ownerId = 0;    //!< 所属学生 users.id。
+        int creatorId = 0;  //!< 创建者 users.id；系统模板为 0，落库为 NULL。
         std::string name;
         std::string description;
         std::string iconPath;
@@ -125,7 +263,7 @@ public:
         int progressValue = 0;
         int progressGoal = 1;
         int rewardCoins = 0;
-        std::string rewardAttributes;
+        User::AttributeSet rewardAttributes;
         std::string rewardItems;
         bool unlocked = false;
         std::string completionTime;
@@ -158,31 +296,132 @@ public:
     struct InventoryRecord {
         int id = -1;
         int itemId = -1;
-        std::string owner;
+        int ownerId = 0;  //!< 所属学生 users.id
         int quantity = 0;
         int usedQuantity = 0;
         std::string status;
         std::string purchaseTimeIso;
         std::string expirationTimeIso;
+        std::int64_t purchaseTimeMs = 0;                //!< purchase_time_ms 列，读取时填充；写入时由 ISO 推导
+        std::optional<std::int64_t> expirationTimeMs;   //!< expiration_time_ms 列，无到期时间时为空
         std::string luckyPayload;
         std::string notes;
     };
 
+    /**
+     * @brief 某用户库存按商品类型聚合的结果；商品已删除的库存 itemType 为空。
+     */
+    struct InventoryTypeTotals {
+        std::string itemType;
+        int quantity = 0;
+        int expiringSoon = 0;
+    };
+
     struct LogRecord {
         int id = -1;
+        int ownerId = 0;  //!< 所属用户 users.id，仅在插入时写入
         std::string timestampIso;
         std::string type;
-        std::string content;
+        std::string content;  //!< template_id 非 0 时为模板参数（逗号分隔的整数），显示时渲染
         std::optional<int> relatedId;
         std::string attributeChanges;
         int levelChange = 0;
         std::string specialEvent;
         std::string mood;
+        std::int64_t timestampMs = 0;  //!< timestamp_ms 列，读取时填充；写入时由 timestampIso 推导
+        int templateId = 0;            //!< LogTemplate 编号，0 表示 content 为原文
+    };
+
+    /**
+     * @brief 日志查询条件，字段为空表示不限制。
+     * 中文：与 queryLogRecords 的参数一一对应，供分页与流式接口复用。
+     */
+    struct LogFilter {
+        std::optional<std::string> type;
+        std::optional<std::int64_t> startMs;  ///< 中文：闭区间起点（毫秒时间戳），与 timestamp_ms 整数比较。
+        std::optional<std::int64_t> endMs;    ///< 中文：闭区间终点（毫秒时间戳）。
+        std::optional<std::string> mood;
+        std::optional<std::string> keyword;
+        bool excludeForgiven = false;  ///< 中文：为 true 时通过反连接排除 forgiven_logs 中的日志。
+        std::optional<int> ownerId;    ///< 中文：所属用户；界面查询总是设置，走 (owner_id, ...) 组合索引。
+    };
+
+    /**
+     * @brief 键集分页游标：上一页最后一行的 (timestamp_ms, id)。
+     * 中文：按 (timestamp_ms, id) 定位而不是 OFFSET，翻到第 N 页也只需一次索引定位。
+     */
+    struct LogCursor {
+        std::int64_t timestampMs = 0;
+        int id = -1;
+    };
+
+    /**
+     * @brief 一页日志结果；nextCursor 为空表示已到末尾。
+     */
+    struct LogPage {
+        std::vector<LogRecord> records;
+        std::optional<LogCursor> nextCursor;
+    };
+
+    /**
+     * @brief 流式读取日志的回调，返回 false 时提前停止。
+     */
+    using LogVisitor = std::function<bool(LogRecord&)>;
+
+    /**
+     * @brief 流式读取任务/成就的回调。记录在行与行之间复用，回调可以移走需要保留的字段，
+     *        未取走的字段（如已有整数列替代的 ISO 文本）在下一行沿用原有容量，不再逐行分配。
+     */
+    using TaskRecordVisitor = std::function<void(TaskRecord&)>;
+    using AchievementRecordVisitor = std::function<void(AchievementRecord&)>;
+
+    /**
+     * @brief 日志保留策略：近期 Auto 日志保留明细，更早的按天汇总进 log_daily_summaries，明细移入归档库。
+     * 中文：Manual、Milestone、Event 日志以及被宽恕的日志始终留在主库，不参与归档；
+     *       超过 compressAfterDays 的非模板日志正文在主库内就地压缩，读取时透明解压。
+     */
+    struct LogRetentionPolicy {
+        int detailDays = 90;          //!< Auto 日志在主库保留明细的天数
+        std::string archivePath;      //!< 归档库路径；为空时使用主库（内存模式下为检查点文件）路径加 ".archive" 后缀
+        std::size_t batchSize = 2000;  //!< 每个事务最多迁移的行数，避免长时间占用写锁
+        int compressAfterDays = 30;   //!< 早于该天数的日志正文压缩存储；负数表示不压缩
+    };
+
+    /**
+     * @brief 成长快照打包策略：早于 packAfterDays 的明细快照每 rowsPerBlock 条打包为一个快照块。
+     * 中文：块以关键帧开头、其后逐行存差值（见 series::encodeBlock），时间线读取时透明解码；
+     *       聚合表在写入时已经维护，打包不影响小时/天/周分辨率。
+     */
+    struct SnapshotPackingPolicy {
+        int packAfterDays = 30;          //!< 明细快照保留为独立行的天数；负数表示不打包
+        std::size_t rowsPerBlock = 256;  //!< 每块的快照条数，即关键帧间隔；不足一块的快照留待下次
+    };
+
+    /**
+     * @brief 一天内同一 special_event 的 Auto 日志汇总行。
+     */
+    struct LogDailySummaryRecord {
+        std::string day;               //!< 本地日期 YYYY-MM-DD
+        std::string specialEvent;
+        int entryCount = 0;
+        int levelChange = 0;
+        std::int64_t firstTimestampMs = 0;
+        std::int64_t lastTimestampMs = 0;
     };
 
+    /**
+     * @brief 成长快照的读取分辨率：原始行，或按小时/天/周（周一起始）汇总的聚合表。
+     */
+    enum class SnapshotResolution { Raw, Hourly, Daily, Weekly };
+
+    /**
+     * @brief 成长快照行；来自聚合表时 id 为 -1，数值为桶内最后一次快照，timestampIso 为其时间。
+     */
     struct GrowthSnapshotRecord {
         int id = -1;
+        int ownerId = 0;               //!< 所属用户 users.id，仅在插入时写入
         std::string timestampIso;
+        std::int64_t timestampMs = 0;  //!< timestamp_ms（聚合表为 last_timestamp_ms），读取时填充
         int userLevel = 1;
         int growthPoints = 0;
         int execution = 0;
@@ -217,48 +456,85 @@ public:
      */
     [[nodiscard]] std::optional<UserRecord> getUserByName(const std::string& username) const;
 
+    /**
+     * @brief Resolve a username to its users.id without reading the rest of the row.
+     * 中文：只按用户名查出主键，供 UserManager 维护用户名到 ID 的映射。
+     *
+     * @param username Target username. 中文：目标用户名。
+     * @return users.id if found. 中文：找到时返回主键，否则返回空。
+     * @throws std::runtime_error On query errors. 中文：查询失败抛出异常。
+     */
+    [[nodiscard]] std::optional<int> getUserIdByName(const std::string& username) const;
+
     /**
      * @brief Update level column for specified user.
      * 中文：更新指定用户的等级。
      *
-     * @param username Target username. 中文：目标用户名。
+     * @param userId Target users.id. 中文：目标用户主键。
      * @param newLevel New level value. 中文：新的等级值。
      * @return true if a row changed. 中文：若成功更新返回 true。
      * @throws std::runtime_error On update errors. 中文：更新失败抛出异常。
      */
-    bool updateUserLevel(const std::string& username, int newLevel);
+    bool updateUserLevel(int userId, int newLevel);
 
     /**
      * @brief Update currency column for specified user.
      * 中文：更新指定用户的货币数值。
      *
-     * @param username Target username. 中文：目标用户名。
+     * @param userId Target users.id. 中文：目标用户主键。
      * @param newCurrency New currency amount. 中文：新的货币值。
      * @return true if a row changed. 中文：若成功更新返回 true。
      * @throws std::runtime_error On update errors. 中文：更新失败抛出异常。
      */
-    bool updateUserCurrency(const std::string& username, int newCurrency);
+    bool updateUserCurrency(int userId, int newCurrency);
 
     /**
-     * @brief Update serialized attributes for specified user.
-     * 中文：更新指定用户的序列化属性。
+     * @brief Update attribute columns and serialized stats for specified user.
+     * 中文：更新指定用户的六维属性列与序列化统计。
      *
-     * @param username Target username. 中文：目标用户名。
-     * @param newAttributes Serialized attribute string. 中文：新的属性字符串。
+     * @param userId Target users.id. 中文：目标用户主键。
+     * @param attributes Six attribute values. 中文：六维属性。
+     * @param newStats Serialized growth/progress stats. 中文：新的统计键值串。
      * @return true if a row changed. 中文：若成功更新返回 true。
      * @throws std::runtime_error On update errors. 中文：更新失败抛出异常。
      */
-    bool updateUserAttributes(const std::string& username, const std::string& newAttributes);
+    bool updateUserAttributes(int userId,
+                              const User::AttributeSet& attributes,
+                              const std::string& newStats);
+
+    /**
+     * @enum UserColumn
+     * @brief Bitmask of users columns written by updateUser.
+     * 中文：updateUser 写入的列位掩码，只有置位的列会被更新。
+     */
+    enum UserColumn : std::uint32_t {
+        UserLevelColumn = 1U << 0,       //!< level
+        UserCurrencyColumn = 1U << 1,    //!< currency
+        UserStatsColumn = 1U << 2,       //!< attributes（成长值与统计键值串）
+        UserAttributeColumns = 1U << 3,  //!< attr_execution … attr_pride
+        UserAllColumns = UserLevelColumn | UserCurrencyColumn | UserStatsColumn | UserAttributeColumns
+    };
 
     /**
-     * @brief Delete user by username.
-     * 中文：根据用户名删除用户。
+     * @brief Upsert a user row in one statement, updating only the columns in @p columns.
+     * 中文：单条 UPSERT 语句写入用户；已存在时仅更新掩码中的列，不存在时整行插入。
      *
-     * @param username Target username. 中文：目标用户名。
+     * @param record Full user state. 中文：完整的用户数据。
+     * @param columns UserColumn bitmask. 中文：需要写入的列掩码。
+     * @return true if a row was inserted or changed. 中文：有行被插入或更新时返回 true。
+     * @throws std::runtime_error On SQL errors. 中文：执行失败抛出异常。
+     */
+    bool updateUser(const UserRecord& record, std::uint32_t columns = UserAllColumns);
+
+    /**
+     * @brief Delete user by id; rows owned by the user are removed with it.
+     * 中文：根据主键删除用户；成就与库存经外键级联删除，任务、日志与快照由删除触发器清理。
+     *
+     * @param userId Target users.id. 中文：目标用户主键。
      * @return true if a row was removed. 中文：若删除成功返回 true。
      * @throws std::runtime_error On delete errors. 中文：删除失败抛出异常。
      */
-    bool deleteUser(const std::string& username);
+    bool deleteUser(int userId);
 
     /**
      * @brief 确保任务表存在，若不存在则创建。
@@ -270,6 +546,26 @@ public:
      */
     void ensureAchievementTable();
 
+    /**
+     * @brief 将旧版文本格式的成就条件迁移为 RecordCodec 二进制编码。
+     */
+    void migrateAchievementConditions();
+
+    /**
+     * @brief 为旧库补齐 attr_* 六个属性整数列，并把旧文本列中的属性值迁移过来。
+     * @param table 目标表名。
+     * @param legacyColumn 旧版属性文本列。
+     * @param dropLegacy 迁移后是否删除旧列（users.attributes 仍保存统计信息，不删除）。
+     */
+    void migrateAttributeColumns(const std::string& table, const std::string& legacyColumn, bool dropLegacy);
+    /**
+     * @brief 为 ISO 文本时间列补齐 INTEGER 毫秒列并回填，已存在时跳过。
+     * @param table 表名。
+     * @param isoColumn ISO8601 文本列。
+     * @param msColumn 新增的毫秒列。
+     */
+    void migrateEpochColumn(const std::string& table, const std::string& isoColumn, const std::string& msColumn);
+
     /**
      * @brief 确保商城商品表存在，提供商城所需的全部元数据。
      */
@@ -281,10 +577,21 @@ public:
     void ensureInventoryTable();
 
     /**
-     * @brief 确保日志表存在，支持按时间与类型索引。
+     * @brief 确保日志表存在，支持按时间以及 (类型, 时间) 组合索引。
      */
     void ensureLogTable();
 
+    /**
+     * @brief 建立日志全文索引（FTS5 trigram，无内容表）及删除同步触发器，首次创建时回填历史日志。
+     * 中文：当前 SQLite 未编译 FTS5 时降级为 LIKE 扫描，不影响启动。
+     */
+    void ensureLogSearchIndex();
+
+    /**
+     * @brief 把已有日志渲染后写入全文索引，ownerId 为空时处理全部日志。
+     */
+    void indexLogsForSearch(const std::optional<int>& ownerId);
+
     /**
      * @brief 确保宽恕日志表存在，持久化记录被隐藏的日志 ID。
      */
@@ -294,6 +601,27 @@ public:
      * @brief 确保成长快照表存在，用于绘制时间线。
      */
     void ensureGrowthSnapshotTable();
+    /**
+     * @brief 按用户重建成长快照聚合表并从原始快照回填，供迁移 5 使用。
+     */
+    void rebuildGrowthRollups();
+    /**
+     * @brief 压缩一批候选日志：汇总、归档、删除在同一事务内完成。
+     * @return 本批删除的行数。
+     */
+    std::size_t compactLogBatch(int ownerId, std::int64_t cutoffMs, std::size_t batchSize);
+
+    /**
+     * @brief 压缩 id 大于 cursor 的一批冷日志，把游标推进到本批最后一行，改写的行数累加到 compressed。
+     * @return 本批扫描的候选行数；小于 batchSize 表示已到末尾。
+     */
+    std::size_t compressLogBatch(std::int64_t cutoffMs, std::size_t batchSize, std::int64_t& cursor,
+                                 std::size_t& compressed);
+    /**
+     * @brief 把指定用户最早的 rowsPerBlock 条早于 cutoffMs 的快照打包为一块。
+     * @return 是否打包了一块；候选不足一块时不做改动。
+     */
+    bool packSnapshotBlock(int ownerId, std::int64_t cutoffMs, std::size_t rowsPerBlock);
 
     /**
      * @brief 新建任务记录并返回行号。
@@ -315,6 +643,21 @@ public:
      */
     bool updateAchievement(const AchievementRecord& record);
 
+    /**
+     * @brief 批量更新任务：单个事务 + 复用同一条预编译语句。
+     * 中文：每日/每周重置会一次性改写上百条任务，逐条自动提交会产生上百次 fsync，批量接口只提交一次。
+     *
+     * @param tasks 待写回的任务记录。
+     * @return 实际发生变化的行数。
+     * @throws std::runtime_error 任一行写入失败时回滚并抛出异常。
+     */
+    std::size_t updateTasks(const std::vector<TaskRecord>& tasks);
+
+    /**
+     * @brief 批量更新成就记录，语义同 updateTasks。
+     */
+    std::size_t updateAchievements(const std::vector<AchievementRecord>& records);
+
     /**
      * @brief 根据 ID 删除任务。
      */
@@ -333,18 +676,108 @@ public:
     /**
      * @brief 查询指定月份内学生创建的奖励型自定义成就数量。
      */
-    [[nodiscard]] int countCustomRewardAchievements(const std::string& owner,
-                                                    const std::string& monthToken) const;
+    [[nodiscard]] int countCustomRewardAchievements(int ownerId, const std::string& monthToken) const;
+
+    /**
+     * @brief 获取指定用户的全部任务记录，用于初始化内存缓存。
+     */
+    [[nodiscard]] std::vector<TaskRecord> getTasksForOwner(int ownerId) const;
+
+    /**
+     * @brief 逐行回调指定用户的任务，不在内存中累积记录；TaskManager 刷新时直接据此构建缓存。
+     * 中文：按 owner_id 组合索引定位，只读取该用户的行。
+     *
+     * @return 实际回调的行数。
+     * @throws std::runtime_error 查询失败时抛出；回调抛出的异常原样传播。
+     */
+    std::size_t streamTasksForOwner(int ownerId, const TaskRecordVisitor& visitor) const;
+
+    /**
+     * @brief 把一次任务完成/失败累加到 task_stats 的 (owner_id, day, type) 行；调用方应处于结算事务中。
+     */
+    void recordTaskOutcome(int ownerId,
+                           const std::string& day,
+                           const std::string& type,
+                           int completedDelta,
+                           int failedDelta);
+
+    /**
+     * @brief 记录任务已按 deadlineMs 判定失败；同一任务只保留最近一次判定的截止时间，调用方应处于结算事务中。
+     * 中文：判定标记与任务状态一同落盘，进程重启后不会把同一截止时间的任务再判定一次。
+     * @return true when the marker is new for this deadline. 中文：该截止时间此前未判定过时返回 true。
+     * @throws std::runtime_error 写入失败时抛出。
+     */
+    bool recordTaskDeadlineFailure(int taskId, std::int64_t deadlineMs);
+
+    /**
+     * @brief 读取指定用户各任务已判定失败的截止时间（任务 ID -> deadline_ms）。
+     * 中文：标记随任务行级联删除，读到的只有仍存在的任务。
+     * @throws std::runtime_error 查询失败时抛出。
+     */
+    [[nodiscard]] std::unordered_map<int, std::int64_t> getTaskDeadlineFailures(int ownerId) const;
+
+    /**
+     * @brief 按类型汇总指定用户的 task_stats，得到累计完成与失败次数；表按天分行，行数远小于任务与日志。
+     */
+    [[nodiscard]] std::vector<TaskStatRecord> getTaskStatTotals(int ownerId) const;
+
+    /**
+     * @brief 读取指定用户 [startDay, endDay] 内的逐日逐类统计，按日期升序；边界为空表示不限。
+     */
+    [[nodiscard]] std::vector<TaskStatRecord> queryTaskStats(int ownerId,
+                                                             const std::optional<std::string>& startDay,
+                                                             const std::optional<std::string>& endDay) const;
 
     /**
-     * @brief 获取所有任务记录，用于初始化内存缓存。
+     * @brief 把一次活动累加到 timestampMs 所在本地日期的 daily_activity 行；调用方应处于结算事务中。
+     * 中文：任务完成与成长值由 UserManager 的结算路径写入，手动日志由 insertLogRecord(s) 在插入时写入。
      */
-    [[nodiscard]] std::vector<TaskRecord> getAllTasks() const;
+    void recordDailyActivity(int ownerId, std::int64_t timestampMs, int completions, int growth, int logs);
 
     /**
-     * @brief 根据学生用户名获取其全部成就记录。
+     * @brief 读取指定用户 [firstJulianDay, lastJulianDay] 内有活动的日期，按日期升序；
+     *        只走 (owner_id, day) 主键区间，一年最多 366 行。
      */
-    [[nodiscard]] std::vector<AchievementRecord> getAchievementsForOwner(const std::string& owner) const;
+    [[nodiscard]] std::vector<DailyActivityRecord> queryDailyActivity(int ownerId,
+                                                                      std::int64_t firstJulianDay,
+                                                                      std::int64_t lastJulianDay) const;
+
+    /**
+     * @brief 追加一条成长变化记录；调用方应处于写回用户行的同一事务中。
+     * 中文：由 UserManager 在提交前写回用户行时调用，变化量全为 0 时不写入。
+     */
+    void recordProgressionDelta(const ProgressionDeltaRecord& record);
+
+    /**
+     * @brief 读取时间戳位于 (afterMs, untilMs] 的变化记录，按时间升序；走 (owner_id, timestamp_ms) 索引区间。
+     */
+    [[nodiscard]] std::vector<ProgressionDeltaRecord> queryProgressionDeltas(int ownerId,
+                                                                             std::int64_t afterMs,
+                                                                             std::int64_t untilMs) const;
+
+    /**
+     * @brief 查找时间戳不晚于 timestampMs 的最近一条成长快照，明细行与快照块都参与比较。
+     * 中文：明细行一次倒序索引查找；快照块按 last_timestamp_ms 索引各取 timestampMs 前后相邻的一块解码，
+     *       代价为 O(log n) 加两块的解码，与历史长度无关。没有更早的快照时返回空。
+     */
+    [[nodiscard]] std::optional<SnapshotCheckpoint> findSnapshotCheckpoint(int ownerId,
+                                                                           std::int64_t timestampMs) const;
+
+    /**
+     * @brief 查询 timestampMs 时刻已购入且未到期的库存，走 (owner_id, purchase_time_ms) 索引区间。
+     * 中文：库存表不记录使用历史，used_quantity 与 status 为当前值，调用方不应据此推断当时的使用状态。
+     */
+    [[nodiscard]] std::vector<InventoryRecord> queryInventoryHeldAt(int ownerId, std::int64_t timestampMs) const;
+
+    /**
+     * @brief 根据学生 users.id 获取其全部成就记录。
+     */
+    [[nodiscard]] std::vector<AchievementRecord> getAchievementsForOwner(int ownerId) const;
+
+    /**
+     * @brief 按 id 升序逐行回调指定学生的成就，语义同 streamAllTasks。
+     */
+    std::size_t streamAchievementsForOwner(int ownerId, const AchievementRecordVisitor& visitor) const;
 
     /**
      * @brief 商城模块：插入新商品、更新、删除、查询。
@@ -359,12 +792,32 @@ public:
      * @brief 库存模块：记录用户道具、幸运礼包及其状态。
      */
     int insertInventoryRecord(const InventoryRecord& record);
+    /**
+     * @brief 批量插入不可堆叠的库存记录：单事务内复用同一预编译语句，返回与输入顺序一致的新 id。
+     */
+    std::vector<int> insertInventoryRecords(const std::vector<InventoryRecord>& records);
     bool updateInventoryRecord(const InventoryRecord& record);
+    std::size_t updateInventoryRecords(const std::vector<InventoryRecord>& records);
     bool deleteInventoryRecord(int inventoryId);
     [[nodiscard]] std::optional<InventoryRecord> getInventoryRecordById(int inventoryId) const;
-    [[nodiscard]] std::vector<InventoryRecord> getInventoryForUser(const std::string& owner) const;
+    [[nodiscard]] std::vector<InventoryRecord> getInventoryForUser(int ownerId) const;
     [[nodiscard]] std::vector<InventoryRecord> getAllInventoryRecords() const;
-    [[nodiscard]] int countInventoryByUserAndItem(const std::string& owner, int itemId) const;
+    /**
+     * @brief 范围查询到期时间不晚于 nowMs 且尚未标记 Expired 的库存，走 (status, expiration_time_ms) 索引。
+     */
+    [[nodiscard]] std::vector<InventoryRecord> getExpiredInventoryRecords(std::int64_t nowMs) const;
+    [[nodiscard]] int countInventoryByUserAndItem(int ownerId, int itemId) const;
+    /**
+     * @brief 单条 LEFT JOIN + GROUP BY 统计用户库存件数；到期时间位于 (fromMs, untilMs) 的计入 expiringSoon。
+     */
+    [[nodiscard]] std::vector<InventoryTypeTotals> aggregateInventoryByType(int ownerId,
+                                                                            std::int64_t fromMs,
+                                                                            std::int64_t untilMs) const;
+    /**
+     * @brief 返回用户持有的每种商品的类型（item_id -> item_type），供库存缓存装载时建立分类计数；
+     *        商品已删除的 item_id 不出现在结果中。
+     */
+    [[nodiscard]] std::vector<std::pair<int, std::string>> getInventoryItemTypes(int ownerId) const;
 
     /**
      * @brief 日志模块：插入与按条件查询日志记录。
@@ -374,6 +827,10 @@ public:
      * 中文：用于将自动或手动日志持久化，保持不可修改特性。
      */
     int insertLogRecord(const LogRecord& record);
+    /**
+     * @brief 单事务批量插入日志记录，返回与输入顺序一致的新 id；手动日志同时计入 daily_activity。
+     */
+    std::vector<int> insertLogRecords(const std::vector<LogRecord>& records);
 
     /**
      * @brief 按类型、时间区间、心情与关键词筛选日志。
@@ -386,9 +843,51 @@ public:
                                                          const std::optional<std::string>& keyword) const;
 
     /**
-     * @brief 统计手动日志数量，用于成长快照采集时快速聚合数据。
+     * @brief 按 (timestamp_ms, id) 升序读取一页日志。
+     * 中文：日志面板只需要可见窗口，避免每次刷新把整张 logs 表复制到内存。
+     *
+     * @param filter 过滤条件。
+     * @param after 上一页返回的游标；为空时从第一行开始。
+     * @param pageSize 每页行数，必须大于 0。
+     * @return 当前页记录及下一页游标。
+     * @throws std::runtime_error 查询失败或 pageSize 为 0 时抛出。
      */
-    [[nodiscard]] int countManualLogs() const;
+    [[nodiscard]] LogPage queryLogPage(const LogFilter& filter,
+                                       const std::optional<LogCursor>& after,
+                                       std::size_t pageSize) const;
+
+    /**
+     * @brief 按 (timestamp_ms, id) 升序逐行回调日志，不在内存中累积结果。
+     * 中文：回调期间占用一条只读连接，回调内不应长时间阻塞；记录在行间复用，回调可移走需要保留的字段。
+     *
+     * @return 实际回调的行数。
+     * @throws std::runtime_error 查询失败时抛出；回调抛出的异常原样传播。
+     */
+    std::size_t streamLogRecords(const LogFilter& filter,
+                                 const std::optional<LogCursor>& after,
+                                 const LogVisitor& visitor) const;
+
+    /**
+     * @brief 关键词全文检索，按 bm25 相关度排序，相关度相同时按时间先后。
+     * 中文：filter.keyword 必须非空；其余条件照常生效。关键词少于 3 个字符时 trigram 无法建索引，
+     *       此时退化为 LIKE 匹配并按时间排序。
+     *
+     * @param filter 过滤条件，keyword 为检索词。
+     * @param limit 最多返回行数，0 表示不限制。
+     * @return 命中的日志记录。
+     * @throws std::runtime_error keyword 为空或查询失败时抛出。
+     */
+    [[nodiscard]] std::vector<LogRecord> searchLogRecords(const LogFilter& filter, std::size_t limit = 0) const;
+
+    /**
+     * @brief 报告日志全文索引是否可用。
+     */
+    [[nodiscard]] bool isLogSearchIndexed() const noexcept;
+
+    /**
+     * @brief 统计指定用户的手动日志数量，用于成长快照采集时快速聚合数据。
+     */
+    [[nodiscard]] int countManualLogs(int ownerId) const;
 
     /**
      * @brief 将指定日志标记为宽恕隐藏状态并持久化。
@@ -396,9 +895,138 @@ public:
     bool markLogForgiven(int logId);
 
     /**
-     * @brief 读取所有已宽恕日志 ID，确保跨会话状态一致。
+     * @brief 读取指定用户已宽恕的日志 ID，确保跨会话状态一致。
+     * 中文：列表查询无需此集合（excludeForgiven 在 SQL 中反连接），仅供需要逐条判断的图表等调用方缓存。
+     */
+    [[nodiscard]] SortedIdSet loadForgivenLogIds(int ownerId) const;
+
+    /**
+     * @brief 按保留策略压缩早于 nowMs - detailDays 的 Auto 日志：先并入按天汇总，再复制到归档库并从主库删除。
+     * 中文：归档库通过 ATTACH 挂载，按用户逐个压缩，每批在独立事务中完成汇总、归档与删除，批次之间释放写锁，
+     *       其他线程的写入可以穿插进行。无法确定归档路径（纯内存库，未配置检查点文件）时不做任何改动；内存模式下归档在检查点文件旁。
+     *
+     * @param policy 保留策略。
+     * @param nowMs 当前时间（毫秒时间戳）。
+     * @return 移出主库的日志行数。
+     * @throws std::runtime_error 挂载归档库或任一批次失败时抛出；已提交的批次保持有效。
+     */
+    std::size_t compactLogs(const LogRetentionPolicy& policy, std::int64_t nowMs);
+
+    /**
+     * @brief 把早于 nowMs - compressAfterDays 的日志正文压缩为 BLOB 存回原列。
+     * 中文：只处理非模板日志（模板日志的正文只是参数），且仅在压缩后确有节省时改写；读取、检索、
+     *       读取经 readLogRecord、LIKE 检索与归档经 render_log 透明解压；全文索引保存写入时的文本，不受压缩影响。
+     *       按 id 游标分批，每批一个事务。
+     *
+     * @param policy 保留策略（使用 compressAfterDays 与 batchSize）。
+     * @param nowMs 当前时间（毫秒时间戳）。
+     * @return 本次压缩的日志行数。
+     * @throws std::runtime_error 当前线程持有事务或任一批次失败时抛出；已提交的批次保持有效。
+     */
+    std::size_t compressColdLogs(const LogRetentionPolicy& policy, std::int64_t nowMs);
+
+    /**
+     * @brief 按时间区间读取指定用户 Auto 日志的按天汇总，区间按 last_timestamp_ms 比较。
+     */
+    [[nodiscard]] std::vector<LogDailySummaryRecord> queryLogDailySummaries(
+        int ownerId,
+        const std::optional<std::int64_t>& startMs,
+        const std::optional<std::int64_t>& endMs) const;
+
+    /**
+     * @brief 回收空闲页并截断 WAL，供空闲时段的维护任务调用。
+     * 中文：分步执行 incremental_vacuum，每步之间释放写锁，不阻塞写者；尚未转换为增量模式的旧库直接返回 0。
+     *
+     * @param maxPages 本次最多回收的页数。
+     * @return 实际回收的页数。
+     * @throws std::runtime_error 当前线程持有事务或回收失败时抛出。
+     */
+    std::int64_t reclaimFreePages(std::int64_t maxPages);
+
+    /**
+     * @brief 把非增量 auto_vacuum 的旧库一次性转换为增量模式，供空闲维护在日志归档之后调用。
+     * 中文：转换需要一次完整 VACUUM，期间持有写锁；空闲页少于 minFreePages 时不值得重写整个文件，保持原模式。
+     *
+     * @param minFreePages 值得转换的最少空闲页数。
+     * @return 库已是（或刚转换为）增量模式时返回 true。
+     * @throws std::runtime_error 当前线程持有事务或 VACUUM 失败时抛出。
+     */
+    bool convertToIncrementalVacuum(std::int64_t minFreePages);
+
+    /**
+     * @brief 按表分步执行的维护任务的进度。
+     * 中文：表按名称排序，nextTable 为下次继续的序号；序号越界（表被删除或本轮已完成）时 finished() 为 true。
+     */
+    struct MaintenanceProgress {
+        std::size_t nextTable = 0;
+        std::size_t tableCount = 0;
+        std::vector<std::string> problems;  //!< quick_check 报告的问题，格式为 "表名: 描述"；ANALYZE 始终为空
+
+        [[nodiscard]] bool finished() const noexcept { return nextTable >= tableCount; }
+    };
+
+    /**
+     * @brief 一次 WAL 检查点的结果。
+     */
+    struct WalCheckpointResult {
+        bool truncated = false;      //!< TRUNCATE 成功；仍有读者持有旧快照时退化为 PASSIVE，WAL 文件不截断
+        int walFrames = 0;           //!< 检查点开始时 WAL 中的帧数
+        int checkpointedFrames = 0;  //!< 已写回主库的帧数
+    };
+
+    /**
+     * @brief 从第 firstTable 张表起逐表执行 ANALYZE，超出 budget 后在表与表之间停下。
+     * 中文：至少处理一张表；每张表单独持有写锁，两张表之间其他线程的写事务可以插入。
+     *       开始前设置 analysis_limit，大表只采样有限行数，单张表的 ANALYZE 耗时有上界。
+     */
+    MaintenanceProgress analyzeTables(std::size_t firstTable, std::chrono::milliseconds budget);
+
+    /**
+     * @brief 从第 firstTable 张表起逐表执行 quick_check（校验页结构与约束，不核对索引内容），预算规则同 analyzeTables。
+     */
+    MaintenanceProgress quickCheckTables(std::size_t firstTable, std::chrono::milliseconds budget);
+
+    /**
+     * @brief 执行 PRAGMA optimize，只重新分析统计信息可能过期的表；analysis_limit 限制每个索引的采样行数。
+     */
+    void optimizeQueryPlanner();
+
+    /**
+     * @brief 以 TRUNCATE 模式执行 WAL 检查点，有读者阻塞时退化为 PASSIVE。
+     * @throws std::runtime_error 当前线程持有事务或检查点失败时抛出。
+     */
+    WalCheckpointResult checkpointWal();
+
+    /**
+     * @brief 用户档案导出/导入的进度回调：参数为已处理行数与总行数，返回 false 取消。
+     */
+    using ProfileProgress = std::function<bool(std::uint64_t done, std::uint64_t total)>;
+
+    /**
+     * @brief 一次档案导出或导入的结果。
      */
-    [[nodiscard]] std::set<int> loadForgivenLogIds() const;
+    struct ProfileTransferReport {
+        std::uint64_t rows = 0;   //!< 已写出或已导入的行数
+        std::size_t tables = 0;   //!< 已处理完的表数
+        bool cancelled = false;   //!< 进度回调返回了 false；导入被取消时事务已回滚
+    };
+
+    /**
+     * @brief 把用户的全部数据（成长字段、任务、成就、库存、日志、快照及派生表、按用户的应用状态）流式写成档案。
+     * 中文：全部表在同一个读事务中先计数再逐行读取，导出的是同一时间点的数据；行按分块写出，内存占用与档案大小无关。
+     *       已移入归档库（growth.db.archive）的日志明细不在导出范围内，其逐日汇总随 log_daily_summaries 导出。
+     * @throws std::runtime_error 用户不存在、查询失败或写入流失败。
+     */
+    ProfileTransferReport exportUserProfile(int userId, std::ostream& out, const ProfileProgress& progress = {}) const;
+
+    /**
+     * @brief 以档案内容替换目标用户的数据，整个导入是一个事务。
+     * 中文：先清除目标用户的已有数据，再按表用预编译语句批量插入，行数较多的表先删除二级索引、写完后重建；
+     *       行保留原主键，与库中其他用户的行冲突时整体回滚。owner_id 换成目标用户，成就的 creator_id 为来源用户时
+     *       同样换成目标用户、否则置空。须在各管理器装载该用户数据之前调用，导入后内存缓存不会自动刷新。
+     * @throws std::runtime_error 档案损坏、结构版本高于当前库、列不存在或写入失败；此时库内容不变。
+     */
+    ProfileTransferReport importUserProfile(int userId, std::istream& in, const ProfileProgress& progress = {});
 
     /**
      * @brief 成长快照模块：插入快照与区间查询。
@@ -410,11 +1038,89 @@ public:
     int insertGrowthSnapshot(const GrowthSnapshotRecord& record);
 
     /**
-     * @brief 根据时间范围查询成长快照。
-     * 中文：支持压缩后的时间线数据抓取，用于可视化。
+     * @brief 根据时间范围查询指定用户的成长快照。
+     * 中文：支持压缩后的时间线数据抓取，用于可视化；走 (owner_id, timestamp_ms) 索引。
+     */
+    [[nodiscard]] std::vector<GrowthSnapshotRecord> queryGrowthSnapshots(int ownerId,
+                                                                        const std::optional<std::int64_t>& startMs,
+                                                                        const std::optional<std::int64_t>& endMs) const;
+
+    /**
+     * @brief 按分辨率查询成长时间线；Raw 等价于 queryGrowthSnapshots，其余读取对应聚合表。
+     * 中文：聚合表在写入快照时同步维护，长时间跨度只需读取少量行。
+     */
+    [[nodiscard]] std::vector<GrowthSnapshotRecord> queryGrowthTimeline(int ownerId,
+                                                                       SnapshotResolution resolution,
+                                                                       const std::optional<std::int64_t>& startMs,
+                                                                       const std::optional<std::int64_t>& endMs) const;
+
+    /**
+     * @brief 按分辨率读取列式成长时间线，逐行把 sqlite 列值直接追加到各数值列。
+     * 中文：不经过 GrowthSnapshotRecord 与 ISO 时间文本，供看板统计与列式导出使用。
+     */
+    [[nodiscard]] SnapshotSeries querySnapshotSeries(int ownerId,
+                                                     SnapshotResolution resolution,
+                                                     const std::optional<std::int64_t>& startMs,
+                                                     const std::optional<std::int64_t>& endMs) const;
+
+    /**
+     * @brief 统计指定分辨率与时间段内的行数，用于列式读取前预留容量。
+     */
+    [[nodiscard]] std::size_t countGrowthTimeline(int ownerId,
+                                                  SnapshotResolution resolution,
+                                                  const std::optional<std::int64_t>& startMs,
+                                                  const std::optional<std::int64_t>& endMs) const;
+
+    /**
+     * @brief 返回某用户时间线的起点（毫秒时间戳），没有快照时返回空。
+     * 中文：读取首个周聚合桶的起始日，只需一次主键查找，供按时间跨度挑选分辨率。
+     */
+    [[nodiscard]] std::optional<std::int64_t> growthTimelineStartMs(int ownerId) const;
+
+    /**
+     * @brief 按打包策略把旧的明细快照打包为快照块，原始行随之删除。
+     * 中文：Raw 分辨率的查询（queryGrowthSnapshots、querySnapshotSeries、countGrowthTimeline）同时读取明细行与
+     *       快照块，结果与打包前一致，只是打包行的 id 为 -1。每块在独立事务中写入，批次之间释放写锁。
+     *
+     * @param policy 打包策略。
+     * @param nowMs 当前时间（毫秒时间戳）。
+     * @return 本次打包的快照条数。
+     * @throws std::runtime_error 当前线程持有事务或任一批次失败时抛出；已提交的块保持有效。
+     */
+    std::size_t packGrowthSnapshots(const SnapshotPackingPolicy& policy, std::int64_t nowMs);
+
+    /**
+     * @brief 读取 app_state 中的整数状态值（如任务重置水位），键不存在时返回空。
+     * 中文：走写连接读取，在事务内调用可看到本事务尚未提交的写入。
+     */
+    [[nodiscard]] std::optional<std::int64_t> getAppState(const std::string& key) const;
+
+    /**
+     * @brief 写入或覆盖 app_state 中的整数状态值；可参与调用方的事务。
+     * 中文：在事务内调用时随事务提交或回滚，水位与对应的业务写入保持一致。
+     */
+    void setAppState(const std::string& key, std::int64_t value);
+
+    /**
+     * @brief 读取指定用户持久化的成长分析状态（GrowthAnalytics::encode 的输出），尚未保存过时返回空。
+     * 中文：走只读连接池，后台快照线程与 GUI 线程均可调用。
+     */
+    [[nodiscard]] std::optional<std::string> loadGrowthAnalyticsState(int ownerId) const;
+
+    /**
+     * @brief 保存指定用户的成长分析状态；库中已有更晚水位的状态时不覆盖，多个线程乱序保存也不会回退。
+     */
+    void saveGrowthAnalyticsState(int ownerId, std::int64_t lastSampleMs, std::string_view state);
+
+    /**
+     * @brief 读取指定用户持久化的近期动态（ActivityRing::encode 的输出），尚未保存过时返回空。
      */
-    [[nodiscard]] std::vector<GrowthSnapshotRecord> queryGrowthSnapshots(const std::optional<std::string>& startIso,
-                                                                        const std::optional<std::string>& endIso) const;
+    [[nodiscard]] std::optional<std::string> loadActivityFeed(int ownerId) const;
+
+    /**
+     * @brief 覆盖保存指定用户的近期动态。
+     */
+    void saveActivityFeed(int ownerId, std::string_view state);
 
     /**
      * @brief Begin explicit transaction.
@@ -443,6 +1149,310 @@ public:
      */
     void rollbackTransaction();
 
+    /**
+     * @brief Run @p work inside a transaction, joining the caller's transaction when one is active.
+     * 中文：在事务中执行 work：本次调用开启了顶层事务时负责提交，work 抛出异常时回滚并透传；
+     *       已处于事务中时直接并入外层事务。事务期间持有写连接锁，管理器借此串行化“落盘 + 更新缓存”序列，
+     *       自身的状态锁只在纯内存操作时短暂持有，锁顺序始终为 DatabaseManager → 管理器。
+     *
+     * @param work Statements to run. 中文：事务内执行的操作。
+     * @return void. 中文：无返回值。
+     * @throws std::runtime_error On begin/commit failure, or whatever @p work throws. 中文：透传异常。
+     */
+    void runInTransaction(const std::function<void()>& work);
+
+    /**
+     * @brief Run @p action right before the outermost transaction commits.
+     * 中文：在最外层事务提交前执行回调，用于合并嵌套调用中的重复写入；同一 key 只保留最后一次登记。
+     *       当前线程不在事务中时立即执行；事务回滚时登记的回调被丢弃。
+     *
+     * @param key Deduplication key, usually the caller's this. 中文：去重键，通常为调用方 this。
+     * @param action Deferred write. 中文：延迟执行的写操作。
+     * @throws Whatever @p action throws. 中文：透传回调抛出的异常。
+     */
+    void deferUntilCommit(const void* key, std::function<void()> action);
+
+    /**
+     * @brief Run @p action after the outermost transaction has committed and released the writer lock.
+     * 中文：在最外层事务提交并释放写连接锁之后执行回调，管理器的全部信号都经此推迟到数据真正落盘之后发出；
+     *       按登记顺序执行，当前线程不在事务中时立即执行，事务回滚时登记的回调被丢弃。
+     *       提交后的回调抛出异常时只记录警告：数据已经提交，不能再向调用方报告事务失败。
+     *
+     * @param action Post-commit side effect. 中文：提交后执行的副作用。
+     * @throws Whatever @p action throws when run immediately. 中文：不在事务中立即执行时透传回调异常。
+     */
+    void runAfterCommit(std::function<void()> action);
+
+    /**
+     * @brief Run @p action after the outermost transaction rolls back, to undo in-memory cache changes.
+     * 中文：管理器在事务内先落盘、再改写自身缓存；最外层事务回滚时这些改动必须撤销。
+     *       回调在 ROLLBACK 完成并释放写连接锁后执行，通常丢弃或重新装载受影响的缓存；
+     *       同一 key 在一个事务内只登记一次，事务提交时登记被丢弃，当前线程不在事务中时不做任何事。
+     *       回调抛出的异常只记录警告，不覆盖引发回滚的原始异常。
+     *
+     * @param key Deduplication key, usually the caller's this. 中文：去重键，通常为调用方 this。
+     * @param action Cache restore. 中文：撤销缓存改动的回调。
+     * @return true when this call registered @p key for the current transaction. 中文：本事务内首次登记该 key 时返回 true。
+     */
+    bool runOnRollback(const void* key, std::function<void()> action);
+
+    /**
+     * @brief Write the in-memory database back to its file (memory mode only).
+     * 中文：内存模式下经 backup API 把内存库写回文件，调用期间持有写连接锁；自上次检查点以来没有写入时直接返回。
+     *       进行中的后台检查点会让出，由本次调用写入最新内容。
+     *
+     * @return true if a checkpoint was written. 中文：实际写回返回 true；非内存模式、无变化或当前线程处于事务中返回 false。
+     * @throws std::runtime_error When the file cannot be written. 中文：写回失败时抛出异常。
+     */
+    bool checkpointToDisk();
+
+    /**
+     * @brief Whether the writer runs on :memory: with checkpoints to a file.
+     * 中文：是否处于内存模式；此时文件只是检查点，可能落后于内存库。
+     */
+    [[nodiscard]] bool isInMemory() const;
+
+    /**
+     * @brief Copy the live in-memory database into @p target (memory mode only).
+     * 中文：以内存连接为源执行 sqlite3_backup，每步只在写连接锁内复制 pagesPerStep 页，步间释放锁并休眠 pause；
+     *       步间提交的写入由 backup API 同步到目标，复制无需重来。目标在复制期间持有一个写事务，
+     *       失败、取消或数据库关闭时保持原样。供 BackupService 在内存模式下备份。
+     *
+     * @param target Destination connection. 中文：目标连接。
+     * @param pagesPerStep Pages per backup step. 中文：每步复制的页数。
+     * @param pause Sleep between steps. 中文：步间休眠时长。
+     * @param cancelled Optional cancel flag. 中文：可选的取消标志。
+     * @param steps Receives the number of steps taken. 中文：可选，返回执行的步数。
+     * @return Pages copied. 中文：复制的页数。
+     * @throws std::runtime_error When not in memory mode, cancelled, closed meanwhile or the copy fails.
+     *         中文：非内存模式、被取消、期间数据库被关闭或复制失败时抛出异常。
+     */
+    std::int64_t copyMemoryDatabase(sqlite3* target, int pagesPerStep, std::chrono::milliseconds pause,
+                                    const std::atomic<bool>* cancelled, std::int64_t* steps = nullptr);
+
+    /**
+     * @brief Whether the calling thread currently owns the writer transaction.
+     * 中文：当前线程是否处于事务中；为真时本线程的写入都会并入该事务。
+     */
+    [[nodiscard]] bool inTransaction() const noexcept;
+
+    /**
+     * @struct WriteCounters
+     * @brief Commits and rows written on the writer connection by the calling thread.
+     * 中文：当前线程在写连接上累计的提交次数与写入行数；不在显式事务中的单条写语句各自算一次提交。
+     *       UnitOfWork 取前后差值，得出一次用户操作实际付出的提交（fsync）次数。
+     */
+    struct WriteCounters {
+        std::uint64_t commits = 0;      //!< Committed write transactions. 中文：提交次数。
+        std::uint64_t rowsWritten = 0;  //!< Rows inserted/updated/deleted, triggers included. 中文：增删改的行数（含触发器写入）。
+    };
+
+    /**
+     * @brief Read the calling thread's write counters.
+     * 中文：读取当前线程的写入计数。
+     *
+     * @return Counter snapshot. 中文：计数快照。
+     * @throws None. 中文：不抛出异常。
+     */
+    [[nodiscard]] static WriteCounters threadWriteCounters() noexcept;
+
+    /**
+     * @struct StatementCacheStats
+     * @brief Hit/miss counters of the prepared-statement cache.
+     * 中文：预编译语句缓存的命中/未命中计数，用于性能分析。
+     */
+    struct StatementCacheStats {
+        std::uint64_t hits = 0;          //!< Lookups served by a cached statement. 中文：命中缓存的次数。
+        std::uint64_t misses = 0;        //!< Lookups that had to call sqlite3_prepare. 中文：需要重新编译的次数。
+        std::uint64_t invalidations = 0; //!< Cache flushes caused by schema changes. 中文：因结构变更而清空缓存的次数。
+        std::size_t cachedStatements = 0;//!< Statements currently held in the cache. 中文：当前缓存的语句数量。
+    };
+
+    /**
+     * @brief Read prepared-statement cache counters.
+     * 中文：读取预编译语句缓存的统计数据。
+     *
+     * @return Snapshot of cache counters. 中文：返回计数快照。
+     * @throws None. 中文：不抛出异常。
+     */
+    [[nodiscard]] StatementCacheStats statementCacheStats() const;
+
+    /**
+     * @brief Finalize every idle cached statement, e.g. after a schema change.
+     * 中文：释放所有空闲的缓存语句，通常在数据表结构变更后调用。
+     *
+     * @return void. 中文：无返回值。
+     * @throws None. 中文：不抛出异常。
+     */
+    void invalidateStatementCache() noexcept;
+
+    /**
+     * @struct SqliteMemoryStatus
+     * @brief SQLite memory counters.
+     * 中文：SQLite 内存读数。堆用量来自进程级 sqlite3_status64；页缓存、表结构、语句与 lookaside 读数为写连接与
+     *       空闲只读连接的 sqlite3_db_status 之和，正被租用的只读连接不参与统计。lookaside 命中与未命中为连接打开以来的累计值。
+     */
+    struct SqliteMemoryStatus {
+        std::int64_t heapUsed = 0;       //!< SQLITE_STATUS_MEMORY_USED. 中文：SQLite 当前堆用量。
+        std::int64_t heapHighwater = 0;  //!< Peak heap use. 中文：堆用量峰值。
+        std::int64_t pageCacheUsed = 0;  //!< SQLITE_DBSTATUS_CACHE_USED. 中文：页缓存用量。
+        std::int64_t schemaUsed = 0;     //!< SQLITE_DBSTATUS_SCHEMA_USED. 中文：表结构用量。
+        std::int64_t statementUsed = 0;  //!< SQLITE_DBSTATUS_STMT_USED. 中文：预编译语句用量。
+        std::int64_t lookasideUsed = 0;      //!< SQLITE_DBSTATUS_LOOKASIDE_USED. 中文：正在使用的 lookaside 槽数。
+        std::int64_t lookasideHits = 0;      //!< SQLITE_DBSTATUS_LOOKASIDE_HIT. 中文：由 lookaside 满足的分配次数。
+        std::int64_t lookasideMissSize = 0;  //!< SQLITE_DBSTATUS_LOOKASIDE_MISS_SIZE. 中文：请求大于槽而落到堆上的次数。
+        std::int64_t lookasideMissFull = 0;  //!< SQLITE_DBSTATUS_LOOKASIDE_MISS_FULL. 中文：槽已用尽而落到堆上的次数。
+        std::size_t connections = 0;     //!< Connections sampled; a busy writer is skipped. 中文：参与统计的连接数，写连接忙时不计入。
+    };
+
+    /**
+     * @brief Read SQLite heap and per-connection memory counters.
+     * 中文：读取 SQLite 堆与各连接的内存读数。
+     *
+     * @return Counter snapshot. 中文：读数快照。
+     * @throws None. 中文：不抛出异常。
+     */
+    [[nodiscard]] SqliteMemoryStatus memoryStatus() const;
+
+    /**
+     * @brief Drop unpinned page-cache pages on the writer and every idle reader.
+     * 中文：释放写连接与空闲只读连接页缓存中未被占用的页，供超出内存限额时回收；之后的查询按需重新读页。
+     *
+     * @return void. 中文：无返回值。
+     * @throws None. 中文：不抛出异常。
+     */
+    void releaseMemory() noexcept;
+
+    /**
+     * @struct QueryTraceOptions
+     * @brief Opt-in SQL tracer settings (sqlite3_trace_v2 with SQLITE_TRACE_PROFILE).
+     * 中文：可选的 SQL 跟踪配置：开启后按语句聚合执行次数与耗时，超过阈值的语句连同 EXPLAIN QUERY PLAN 记入慢查询日志。
+     *       SQLite 的 PROFILE 耗时只有毫秒精度，阈值因此以毫秒计；需要微秒级分布时看 Metrics 埋点。
+     */
+    struct QueryTraceOptions {
+        bool enabled = false;                //!< Register the PROFILE hook. 中文：是否注册 PROFILE 回调。
+        int slowThresholdMs = 50;            //!< Slow-query threshold. 中文：慢查询阈值（毫秒）。
+        std::size_t slowLogCapacity = 200;   //!< Most recent slow queries kept. 中文：保留的最近慢查询条数。
+    };
+
+    /**
+     * @struct QueryTraceStatement
+     * @brief Aggregated PROFILE samples of one SQL text.
+     * 中文：同一 SQL 文本的聚合统计；全表扫描依据 SQLITE_STMTSTATUS_FULLSCAN_STEP 逐次判定。
+     */
+    struct QueryTraceStatement {
+        std::string sql;
+        std::uint64_t executions = 0;
+        std::uint64_t totalNs = 0;
+        std::uint64_t maxNs = 0;
+        std::uint64_t fullScanSteps = 0;       //!< Rows stepped in full table scans. 中文：全表扫描中步进的行数。
+        std::uint64_t fullScanExecutions = 0;  //!< Executions that did a full table scan. 中文：发生全表扫描的执行次数。
+        std::uint64_t sortExecutions = 0;      //!< Executions that needed a sorter. 中文：需要临时排序的执行次数。
+        std::uint64_t autoIndexExecutions = 0; //!< Executions that built an automatic index. 中文：临时建自动索引的执行次数。
+    };
+
+    /**
+     * @struct SlowQuery
+     * @brief One statement slower than the threshold, with its query plan.
+     * 中文：一条超过阈值的语句及其执行计划。
+     */
+    struct SlowQuery {
+        std::string sql;                 //!< SQL with bound values expanded. 中文：展开绑定参数后的 SQL。
+        std::uint64_t elapsedNs = 0;
+        std::int64_t recordedAtMs = 0;   //!< Wall-clock time of the sample. 中文：记录时刻（毫秒时间戳）。
+        std::vector<std::string> plan;   //!< EXPLAIN QUERY PLAN rows, indented by depth. 中文：按层级缩进的计划行。
+        bool fullScan = false;           //!< Full table scan observed or planned. 中文：是否全表扫描。
+    };
+
+    /**
+     * @struct QueryTraceReport
+     * @brief Snapshot of the tracer state.
+     * 中文：跟踪器快照：语句按总耗时降序，慢查询按发生顺序。
+     */
+    struct QueryTraceReport {
+        std::vector<QueryTraceStatement> statements;
+        std::vector<SlowQuery> slowQueries;
+
+        /**
+         * @brief Plain-text summary of the top statements and all slow queries.
+         * 中文：输出总耗时最高的若干语句与全部慢查询的文本摘要。
+         */
+        [[nodiscard]] std::string toText(std::size_t topStatements = 20) const;
+    };
+
+    /**
+     * @brief Enable, disable or reconfigure the query tracer on every open connection.
+     * 中文：在写连接与全部只读连接上开启、关闭或调整查询跟踪；会等待正在使用的只读连接归还。
+     *
+     * @param options Tracer settings. 中文：跟踪配置。
+     * @return void. 中文：无返回值。
+     * @throws None. 中文：不抛出异常。
+     */
+    void setQueryTrace(const QueryTraceOptions& options);
+
+    [[nodiscard]] QueryTraceOptions queryTraceOptions() const;
+
+    /**
+     * @brief Copy the aggregated statements and slow-query log.
+     * 中文：复制当前的语句聚合与慢查询日志。
+     *
+     * @return Tracer snapshot. 中文：跟踪器快照。
+     * @throws None. 中文：不抛出异常。
+     */
+    [[nodiscard]] QueryTraceReport queryTraceReport() const;
+
+    /**
+     * @brief Clear aggregated statements, slow queries and cached plans.
+     * 中文：清空语句聚合、慢查询与执行计划缓存。
+     */
+    void resetQueryTrace();
+
+    /**
+     * @struct QueryPlanAudit
+     * @brief EXPLAIN QUERY PLAN result of one statement.
+     * 中文：一条语句的执行计划；fullScan 表示存在不经索引的 SCAN（常量行与子查询物化不计）。
+     */
+    struct QueryPlanAudit {
+        std::string sql;
+        std::vector<std::string> plan;  //!< Plan rows, indented by depth. 中文：按层级缩进的计划行。
+        std::vector<std::string> scannedTables;  //!< Tables (or aliases) read by full scan. 中文：被整表扫描的表或别名。
+        bool fullScan = false;
+        bool prepared = true;  //!< False when the statement failed to prepare. 中文：语句无法准备时为 false。
+    };
+
+    /**
+     * @brief Explain every statement currently held in the writer and reader statement caches.
+     * 中文：对写连接与全部只读连接缓存中的每条语句执行 EXPLAIN QUERY PLAN，按 SQL 文本排序返回；
+     *       缓存不淘汰，跑完一轮业务场景后即覆盖全部实际执行过的语句（含动态拼接的日志/快照查询）。
+     *       会等待正在使用的只读连接归还。只覆盖本次运行实际执行过的语句，供基准工具诊断；
+     *       回归门禁使用 queryPlanCatalog。
+     *
+     * @return One entry per distinct SQL text. 中文：每条不同的 SQL 一项。
+     * @throws None. 中文：不抛出异常（准备失败的语句以说明行作为计划）。
+     */
+    [[nodiscard]] std::vector<QueryPlanAudit> auditQueryPlans() const;
+
+    /**
+     * @brief Explain the given statements on the writer connection.
+     * 中文：在写连接上对给定语句逐条执行 EXPLAIN QUERY PLAN，按输入顺序返回。
+     *
+     * @param statements SQL texts. 中文：待审计的 SQL。
+     * @return One entry per statement. 中文：每条语句一项。
+     * @throws None. 中文：不抛出异常（准备失败的语句 prepared 为 false）。
+     */
+    [[nodiscard]] std::vector<QueryPlanAudit> auditQueryPlans(const std::vector<std::string>& statements) const;
+
+    /**
+     * @brief List the hot statements this class prepares, including every shape of the dynamic SQL builders.
+     * 中文：列出本类热路径上准备的语句：固定语句取自同一组常量，动态拼接的日志、快照、聚合与统计查询
+     *       按各可选条件的组合逐一生成（日志关键词同时覆盖 FTS 与 LIKE 两条路径）。新增查询时须一并登记，
+     *       query_plan_check 测试据此在迁移后的空库上审计执行计划。
+     *
+     * @return SQL texts in catalog order. 中文：按登记顺序返回的 SQL 文本。
+     * @throws None. 中文：不抛出异常。
+     */
+    [[nodiscard]] std::vector<std::string> queryPlanCatalog() const;
+
     /**
      * @brief Access raw sqlite3 handle.
      * 中文：访问底层 sqlite3 句柄。
@@ -461,33 +1471,318 @@ private:
     DatabaseManager(DatabaseManager&&) = delete;
     DatabaseManager& operator=(DatabaseManager&&) = delete;
 
+    /**
+     * @brief Writer-connection mutex; wait/hold times show up under "locks" in the metrics panel.
+     * 中文：写连接互斥量，等待与持有时间计入埋点的 locks 分组；事务期间由 m_transactionLock 持有。
+     */
+    using WriterMutex = metrics::ProfiledMutex<std::recursive_mutex>;
+
+    /**
+     * @brief Per-statement latency and row-count metrics, resolved once per cached statement.
+     * 中文：按语句 ID（SQL 文本摘要）登记的语句延迟与读取行数埋点，缓存语句首次计时时解析并保存在缓存槽上。
+     */
+    struct StatementMetrics {
+        metrics::Histogram* latency = nullptr;
+        metrics::Counter* rows = nullptr;
+    };
+
+    /**
+     * @brief Deleter that returns cached statements to the cache instead of finalizing them.
+     * 中文：语句句柄的删除器：缓存语句仅重置并归还缓存，非缓存语句直接 finalize。
+     */
+    struct StatementReleaser {
+        bool* inUse = nullptr;  //!< Cache slot flag, nullptr for uncached statements. 中文：缓存槽占用标记。
+        StatementMetrics timing;             //!< Empty when metrics are off. 中文：埋点关闭时为空。
+        metrics::TimePoint startedAt{};      //!< Checkout time. 中文：句柄取出时刻。
+        void operator()(sqlite3_stmt* statement) const noexcept;
+    };
+
+    /**
+     * @brief Cache slot owning one prepared statement.
+     * 中文：缓存槽，持有一条预编译语句及其占用状态。
+     */
+    struct CachedStatement {
+        std::unique_ptr<sqlite3_stmt, decltype(&sqlite3_finalize)> statement{nullptr, &sqlite3_finalize};
+        bool inUse = false;
+        StatementMetrics timing;  //!< Metric slots for this SQL. 中文：该 SQL 的埋点。
+    };
+
     using DatabaseHandle = std::unique_ptr<sqlite3, decltype(&sqlite3_close)>;
-    using StatementHandle = std::unique_ptr<sqlite3_stmt, decltype(&sqlite3_finalize)>;
+    using StatementHandle = std::unique_ptr<sqlite3_stmt, StatementReleaser>;
+    using StatementCache = std::unordered_map<std::string, CachedStatement>;
+
+    /**
+     * @brief One read-only connection of the reader pool, with its own statement cache.
+     * 中文：只读连接池中的一条连接，拥有独立的语句缓存。
+     */
+    struct ReadConnection {
+        DatabaseHandle handle{nullptr, &sqlite3_close};
+        StatementCache statementCache;
+        StatementCacheStats stats;     //!< Counters since last release. 中文：本次租用期间的计数。
+        std::size_t cachedCount = 0;   //!< Cache size at last release. 中文：上次归还时的缓存条目数。
+        bool leased = false;
+    };
+
+    /**
+     * @class ReadLease
+     * @brief RAII lease on a connection used for read-only queries.
+     * 中文：只读查询使用的连接租约（RAII）。
+     *
+     * Business logic: a lease either borrows an idle pooled WAL reader, so the query sees the last committed
+     * snapshot without touching m_mutex, or falls back to the writer connection under m_mutex. The fallback is
+     * used when the pool is empty or exhausted, and when the calling thread owns the open transaction (it must
+     * see its own uncommitted writes).
+     * 中文：租约优先借用空闲的 WAL 只读连接，读取最近一次提交的快照而无需持有 m_mutex；
+     *       当连接池为空/耗尽，或调用线程正持有事务（需要看到自身未提交的修改）时，回退到写连接并持有 m_mutex。
+     */
+    class ReadLease {
+    public:
+        ReadLease(const DatabaseManager& owner, ReadConnection* connection);
+        explicit ReadLease(const DatabaseManager& owner);
+        ~ReadLease();
+
+        ReadLease(const ReadLease&) = delete;
+        ReadLease& operator=(const ReadLease&) = delete;
+        ReadLease(ReadLease&&) = delete;
+        ReadLease& operator=(ReadLease&&) = delete;
+
+        /**
+         * @brief Handle used for error reporting and column access. 中文：用于错误信息的底层句柄。
+         */
+        [[nodiscard]] sqlite3* handle() const noexcept;
+
+        /**
+         * @brief Prepare (or fetch cached) statement on the leased connection. 中文：在租用连接上准备语句。
+         */
+        [[nodiscard]] StatementHandle prepare(const std::string& sql) const;
+
+    private:
+        const DatabaseManager& m_owner;
+        ReadConnection* m_connection;
+        std::unique_lock<WriterMutex> m_writerLock;
+    };
 
     void openDatabase(const std::string& path);
+    void applyConnectionProfile(const ConnectionProfile& profile);
+    [[nodiscard]] std::string readPragmaText(const std::string& pragma) const;
+    [[nodiscard]] std::int64_t readPragmaInteger(const std::string& pragma) const;
+    /**
+     * @brief 按名称排序的普通表（不含虚表与 sqlite_ 内部表），供分表维护任务定位进度。
+     */
+    [[nodiscard]] std::vector<std::string> listMaintenanceTables() const;
+    /**
+     * @brief 导入档案中的一张表，返回 false 表示进度回调要求取消。
+     */
+    bool importProfileTable(const ProfileArchiveTable& table,
+                            ProfileArchiveReader& archive,
+                            int userId,
+                            int sourceUserId,
+                            std::uint64_t totalRows,
+                            std::uint64_t& done,
+                            const ProfileProgress& progress);
+    MaintenanceProgress runPerTable(std::size_t firstTable,
+                                    std::chrono::milliseconds budget,
+                                    const std::function<void(const std::string&, MaintenanceProgress&)>& step);
     void closeDatabase() noexcept;
+    [[nodiscard]] bool hasStatementsInUse() const noexcept;
+    void loadIntoMemory(const std::string& path);
+    bool writeCheckpoint(bool background);
+    /**
+     * @brief 分步把内存库复制到 target；pollLock 时以 try_lock 取写锁，abort 返回 true 或写连接被关闭时放弃。
+     * @return 完成时内存库的数据版本；放弃时为空。
+     */
+    std::optional<unsigned int> copyMemoryImage(sqlite3* target, int pagesPerStep, std::chrono::milliseconds pause,
+                                                bool pollLock, const std::function<bool()>& abort,
+                                                std::int64_t* pages, std::int64_t* steps);
+    void startCheckpointer(int intervalMs);
+    void stopCheckpointer() noexcept;
+    void openReadPool(const ConnectionProfile& profile);
+    void closeReadPool() noexcept;
+    [[nodiscard]] ReadLease acquireReader() const;
+    void releaseReader(ReadConnection& connection) const noexcept;
+    [[nodiscard]] static StatementHandle prepareCachedStatement(sqlite3* handle,
+                                                                StatementCache& cache,
+                                                                StatementCacheStats& stats,
+                                                                const std::string& sql);
+    /**
+     * @brief Register the row-count (metrics) and PROFILE (query tracer) hooks that are currently wanted.
+     * 中文：按埋点是否编译、跟踪器是否开启，为连接注册 ROW / PROFILE 回调。
+     */
+    void applyTraceHooks(sqlite3* handle) noexcept;
+    static int traceCallback(unsigned int type, void* context, void* p, void* x);
+    /**
+     * @brief Commit/rollback hooks of the writer connection that maintain threadWriteCounters().
+     * 中文：写连接的提交/回滚回调：提交时把自上次结算以来的变更行数计入提交线程，回滚时丢弃这段变更。
+     *       两个回调都在持有写连接锁的线程上执行。
+     */
+    static int commitHook(void* context) noexcept;
+    static void rollbackHook(void* context) noexcept;
+    void recordQueryProfile(sqlite3_stmt* statement, std::uint64_t elapsedNs);
+
+    /**
+     * @brief Explain and log the slow queries this thread observed on @p handle.
+     * 中文：语句结束后（缓存句柄归还或 sqlite3_exec 返回）在同一连接上执行 EXPLAIN QUERY PLAN 并写入慢查询日志；
+     *       PROFILE 回调内不能在同一连接上再执行语句，因此推迟到这里。
+     */
+    static void flushSlowQueries(sqlite3* handle) noexcept;
+    [[nodiscard]] static StatementReleaser makeReleaser(bool* inUse,
+                                                        StatementMetrics* cached,
+                                                        sqlite3_stmt* statement);
     void executeNonQuery(const std::string& sql);
     [[nodiscard]] StatementHandle prepareStatement(const std::string& sql) const;
     [[nodiscard]] static bool isSuccessCode(int sqliteResult);
+    static void bindTaskUpdate(sqlite3_stmt* statement, const TaskRecord& task);
+    static void bindAchievementUpdate(sqlite3_stmt* statement, const AchievementRecord& record);
+    static void bindLogInsert(sqlite3_stmt* statement, const LogRecord& record);
+    /**
+     * @brief 把刚插入的日志渲染后写入全文索引；索引不可用时什么也不做。调用方持有写锁并处于事务中。
+     */
+    void indexLogRecord(int logId, const LogRecord& record);
+    /**
+     * @brief 刚插入的日志为手动日志时把它计入当日活动；调用方持有写锁并处于事务中。
+     */
+    void countManualLogActivity(const LogRecord& record);
+    /**
+     * @brief Fold one snapshot into every rollup table.
+     * 中文：把一条快照并入小时/天/周聚合表；调用方持有写锁并处于事务中。
+     */
+    void upsertGrowthRollups(const GrowthSnapshotRecord& record, std::int64_t timestampMs);
+    static void bindInventoryInsert(sqlite3_stmt* statement, const InventoryRecord& record);
+    static void bindInventoryUpdate(sqlite3_stmt* statement, const InventoryRecord& record);
+    template <typename Record, typename Binder>
+    std::size_t runBatchUpdate(const std::string& sql,
+                               const std::vector<Record>& records,
+                               Binder binder,
+                               const char* errorContext);
     [[nodiscard]] TaskRecord readTaskRecord(sqlite3_stmt* statement) const;
     [[nodiscard]] AchievementRecord readAchievementRecord(sqlite3_stmt* statement) const;
     [[nodiscard]] ShopItemRecord readShopItemRecord(sqlite3_stmt* statement) const;
     [[nodiscard]] InventoryRecord readInventoryRecord(sqlite3_stmt* statement) const;
     [[nodiscard]] LogRecord readLogRecord(sqlite3_stmt* statement) const;
+    void readTaskRecordInto(sqlite3_stmt* statement, TaskRecord& record) const;
+    void readAchievementRecordInto(sqlite3_stmt* statement, AchievementRecord& record) const;
+    void readLogRecordInto(sqlite3_stmt* statement, LogRecord& record) const;
+    /**
+     * @brief 日志查询参数：文本条件按 TEXT 绑定，时间条件按 INTEGER 绑定。
+     */
+    using SqlParam = std::variant<std::string, std::int64_t>;
+    [[nodiscard]] std::string buildLogQuerySql(const LogFilter& filter,
+                                               const std::optional<LogCursor>& after,
+                                               std::vector<SqlParam>& params) const;
+    [[nodiscard]] std::string buildLogSearchSql(const LogFilter& filter,
+                                                bool limited,
+                                                std::vector<SqlParam>& params) const;
+    void appendLogFilterSql(const LogFilter& filter, std::string& sql, std::vector<SqlParam>& params) const;
+    void appendLogKeywordSql(const std::string& keyword, std::string& sql, std::vector<SqlParam>& params) const;
+    static int bindLogQuery(sqlite3_stmt* statement,
+                            const std::vector<SqlParam>& params,
+                            const std::optional<LogCursor>& after);
     [[nodiscard]] GrowthSnapshotRecord readGrowthSnapshotRecord(sqlite3_stmt* statement) const;
+    void releaseTransactionLock();
+
+    /**
+     * @brief 按 PRAGMA user_version 执行尚未应用的编号迁移。
+     * 中文：版本已是最新时只做一次查询即返回，跳过全部 DDL 与预置数据；
+     *       否则在单个事务内依次执行迁移并写回版本号。
+     */
+    void migrateSchema();
+
+    /**
+     * @brief 迁移 1：建表、兼容旧版列布局并写入预置数据。
+     * 中文：各 ensure/migrate 步骤均可重入，未编号的旧库统一从这里升级。
+     */
+    void applyBaselineSchema();
+    /**
+     * @brief 迁移 2：新建 app_state 键值表，保存每日/每周重置与每日奇遇的已处理水位。
+     */
+    void applyAppStateSchema();
+    /**
+     * @brief 迁移 3：新建单行的 growth_analytics_state 表，保存成长分析的滚动窗口状态与快照水位。
+     */
+    void applyGrowthAnalyticsSchema();
+    /**
+     * @brief 迁移 4：新建 task_stats 逐日逐类统计表，并以当前已完成的任务作为基线。
+     */
+    void applyTaskStatsSchema();
+    /**
+     * @brief 迁移 5：任务、日志与成长快照新增 owner_id，派生表改为按用户分区。
+     */
+    void applyOwnerPartitionSchema();
+    /**
+     * @brief 迁移 6：成就与库存的用户名列改为引用 users(id) 的整数外键，并为按用户分区的表建立删除触发器。
+     */
+    void applyUserForeignKeySchema();
+    /**
+     * @brief 迁移 7：为自定义奖励成就的月度计数与按购买时间排序的库存列表补充覆盖/复合索引。
+     */
+    void applyCoveringIndexSchema();
+    /**
+     * @brief 迁移 8：日志新增 template_id，自动日志改存模板参数，全文索引改以渲染视图为内容源。
+     */
+    void applyLogTemplateSchema();
+    /**
+     * @brief 迁移 9：新建 growth_snapshot_blocks 快照块表及其按用户删除的触发器。
+     */
+    void applySnapshotBlockSchema();
+    /**
+     * @brief 迁移 10：新建 activity_feed_state 表，按用户保存仪表盘近期动态环形缓冲的编码。
+     */
+    void applyActivityFeedSchema();
+    /**
+     * @brief 迁移 11：新建按用户、按本地日期的 daily_activity 聚合表，并从既有统计、快照与日志一次性回填。
+     */
+    void applyDailyActivitySchema();
+    /**
+     * @brief 迁移 12：创建 progression_deltas 并从日志的等级变化与属性变化回填。
+     */
+    void applyProgressionDeltaSchema();
+    /**
+     * @brief 迁移 13：新建 task_deadline_failures，记录学期任务已按哪个截止时间判定失败，随任务级联删除。
+     */
+    void applyTaskDeadlineFailureSchema();
     void seedDefaultTasks();
     void seedDefaultAchievements();
     void seedDefaultShopItems();
 
     DatabaseHandle m_db;
     std::string m_databasePath;
-    mutable std::recursive_mutex m_mutex;
+    std::string m_checkpointPath;       //!< 内存模式写回的文件，非内存模式为空
+    std::atomic<unsigned int> m_checkpointedVersion;  //!< 已写回文件的内存库数据版本（SQLITE_FCNTL_DATA_VERSION）
+    std::mutex m_checkpointWriteMutex;  //!< 串行化定时检查点与关闭时的检查点
+    std::thread m_checkpointThread;
+    std::mutex m_checkpointerMutex;
+    std::condition_variable m_checkpointerWake;
+    std::atomic<bool> m_checkpointerStopping;
+    std::atomic<int> m_foregroundCheckpoints;  //!< 等待写回的前台检查点数，后台检查点见到非零即让出
+    mutable WriterMutex m_mutex;
     bool m_initialized;
     std::size_t m_transactionDepth;
-    std::unique_lock<std::recursive_mutex> m_transactionLock;
+    std::unique_lock<WriterMutex> m_transactionLock;
+    AppliedConnectionSettings m_connectionSettings;
+    mutable StatementCache m_statementCache;
+    mutable StatementCacheStats m_statementCacheStats;
+    std::atomic<std::thread::id> m_transactionOwner;
+    std::vector<std::pair<const void*, std::function<void()>>> m_preCommitActions;
+    std::vector<std::function<void()>> m_postCommitActions;  //!< runAfterCommit 登记，只由事务所有者线程访问
+    std::vector<std::pair<const void*, std::function<void()>>> m_rollbackActions;  //!< runOnRollback 登记，同上
+    sqlite3_int64 m_settledChanges;  //!< 上次提交/回滚时写连接的 sqlite3_total_changes64，受写连接锁保护
+    std::atomic<int> m_busyTimeoutMs;  //!< 忙等回调的超时毫秒数，所有连接共享；回调上下文指向此处
+    std::vector<std::unique_ptr<ReadConnection>> m_readPool;
+    mutable std::mutex m_readPoolMutex;
+    mutable std::condition_variable m_readPoolIdle;
+    mutable StatementCacheStats m_readerCacheStats;
+    std::atomic<bool> m_logSearchIndexed;
+    metrics::TimePoint m_transactionStartedAt;  //!< 最外层事务开始时刻，埋点关闭时为零值。
+    mutable std::mutex m_queryTraceMutex;       //!< Guards the tracer state below. 中文：保护以下跟踪器状态。
+    QueryTraceOptions m_queryTraceOptions;
+    std::unordered_map<std::string, QueryTraceStatement> m_queryTraceStatements;
+    std::deque<SlowQuery> m_slowQueries;
+    std::unordered_map<std::string, std::vector<std::string>> m_queryPlans;  //!< Plan cache by SQL text. 中文：按 SQL 文本缓存的计划。
+    metrics::MemoryRegistration m_memoryRegistration;  //!< "sqlite" entry in MemoryRegistry. 中文：内存报告登记。
 
     inline static const char* kPreconfiguredUsername = "x";
     inline static const char* kPreconfiguredPassword = "1";
+    inline static constexpr int kSchemaVersion = 13;  //!< 当前库结构版本，新增迁移时递增。
 };
 
 }  // namespace rove::data
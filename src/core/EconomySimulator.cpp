@@ -0,0 +1,187 @@
+#include "EconomySimulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "ShopManager.h"
+
+namespace rove::data {
+
+namespace {
+
+/**
+ * @brief 单个模拟玩家的累计结果，由所属工作线程独占写入。
+ */
+struct TrialResult {
+    double netCoins = 0.0;
+    double growth = 0.0;
+    double buffUptime = 0.0;
+    double easterEggTasks = 0.0;
+    double itemRewards = 0.0;
+};
+
+void simulateTrials(const EconomySimulator::Config& config,
+                    const ShopManager::AliasTable& table,
+                    unsigned workerIndex,
+                    TrialResult* first,
+                    TrialResult* last) {
+    // 中文：每个工作线程一条独立的随机流，种子由 (seed, 线程序号) 经 seed_seq 打散，线程之间互不相关。
+    std::seed_seq seedSequence{static_cast<std::uint32_t>(config.seed), static_cast<std::uint32_t>(config.seed >> 32),
+                               static_cast<std::uint32_t>(workerIndex)};
+    std::mt19937_64 engine(seedSequence);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const bool simulateBags = !config.luckyRewards.empty() && !table.probability.empty();
+
+    for (TrialResult* trial = first; trial != last; ++trial) {
+        int buffDays = 0;
+        int eggs = 0;
+        long long growth = 0;
+        long long coins = 0;
+        int items = 0;
+        for (int day = 0; day < config.daysPerTrial; ++day) {
+            switch (SerendipityEngine::classifyRoll(config.probability, unit(engine))) {
+                case SerendipityEngine::EventKind::Buff:
+                    ++buffDays;  // 中文：增益持续 kBuffDurationMinutes（一整天），按天计覆盖率。
+                    break;
+                case SerendipityEngine::EventKind::EasterEggTask:
+                    ++eggs;
+                    break;
+                case SerendipityEngine::EventKind::SmallReward:
+                    growth += SerendipityEngine::kSmallRewardGrowth;
+                    break;
+                case SerendipityEngine::EventKind::Calm:
+                    break;
+            }
+        }
+        if (simulateBags) {
+            for (int bag = 0; bag < config.bagsPerTrial; ++bag) {
+                const auto& reward = config.luckyRewards[table.sample(engine)];
+                switch (reward.type) {
+                    case ShopItem::LuckyBagReward::RewardType::Coins:
+                        coins += reward.amount;
+                        break;
+                    case ShopItem::LuckyBagReward::RewardType::Growth:
+                        growth += reward.amount;
+                        break;
+                    case ShopItem::LuckyBagReward::RewardType::ShopItem:
+                        ++items;
+                        break;
+                }
+            }
+            coins -= static_cast<long long>(config.bagPriceCoins) * config.bagsPerTrial;
+        }
+        trial->netCoins = static_cast<double>(coins);
+        trial->growth = static_cast<double>(growth);
+        trial->buffUptime = config.daysPerTrial > 0 ? static_cast<double>(buffDays) / config.daysPerTrial : 0.0;
+        trial->easterEggTasks = eggs;
+        trial->itemRewards = items;
+    }
+}
+
+EconomySimulator::Distribution summarize(std::vector<double> values) {
+    EconomySimulator::Distribution distribution;
+    if (values.empty()) {
+        return distribution;
+    }
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    distribution.mean = sum / static_cast<double>(values.size());
+    double squares = 0.0;
+    for (double value : values) {
+        squares += (value - distribution.mean) * (value - distribution.mean);
+    }
+    distribution.stddev = std::sqrt(squares / static_cast<double>(values.size()));
+    const auto percentile = [&values](double q) {
+        const auto rank = static_cast<std::size_t>(q * static_cast<double>(values.size() - 1) + 0.5);
+        return values[std::min(rank, values.size() - 1)];
+    };
+    distribution.min = values.front();
+    distribution.p10 = percentile(0.10);
+    distribution.p50 = percentile(0.50);
+    distribution.p90 = percentile(0.90);
+    distribution.p99 = percentile(0.99);
+    distribution.max = values.back();
+    return distribution;
+}
+
+template <typename Field>
+EconomySimulator::Distribution summarizeField(const std::vector<TrialResult>& trials, Field field) {
+    std::vector<double> values;
+    values.reserve(trials.size());
+    for (const auto& trial : trials) {
+        values.push_back(trial.*field);
+    }
+    return summarize(std::move(values));
+}
+
+}  // namespace
+
+/**
+ * @brief 按块把试验分给工作线程，各线程写入互不重叠的结果区间，全部汇合后在调用线程归并分布。
+ */
+EconomySimulator::Report EconomySimulator::run(const Config& config) {
+    SerendipityEngine::validateProbability(config.probability);
+    if (config.trials < 0 || config.daysPerTrial < 0 || config.bagsPerTrial < 0) {
+        throw std::invalid_argument("Simulation sizes must be non-negative");
+    }
+    const auto started = std::chrono::steady_clock::now();
+    const ShopManager::AliasTable table = ShopManager::AliasTable::build(config.luckyRewards);
+    const auto trialCount = static_cast<std::size_t>(config.trials);
+    unsigned workers = config.workers != 0 ? config.workers : std::max(1u, std::thread::hardware_concurrency());
+    workers = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(workers, trialCount)));
+
+    std::vector<TrialResult> trials(trialCount);
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    const std::size_t chunk = (trialCount + workers - 1) / workers;
+    for (unsigned worker = 0; worker < workers; ++worker) {
+        const std::size_t begin = std::min(trialCount, worker * chunk);
+        const std::size_t end = std::min(trialCount, begin + chunk);
+        threads.emplace_back(simulateTrials, std::cref(config), std::cref(table), worker, trials.data() + begin,
+                             trials.data() + end);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Report report;
+    report.workers = workers;
+    report.simulatedDays = static_cast<std::uint64_t>(trialCount) * static_cast<std::uint64_t>(config.daysPerTrial);
+    report.bagOpenings = config.luckyRewards.empty()
+                             ? 0
+                             : static_cast<std::uint64_t>(trialCount) * static_cast<std::uint64_t>(config.bagsPerTrial);
+    report.netCoins = summarizeField(trials, &TrialResult::netCoins);
+    report.growth = summarizeField(trials, &TrialResult::growth);
+    report.buffUptime = summarizeField(trials, &TrialResult::buffUptime);
+    report.easterEggTasks = summarizeField(trials, &TrialResult::easterEggTasks);
+    report.itemRewards = summarizeField(trials, &TrialResult::itemRewards);
+    report.elapsedMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return report;
+}
+
+std::string EconomySimulator::Report::toText() const {
+    std::ostringstream oss;
+    oss << "economy simulation: " << simulatedDays << " days, " << bagOpenings << " bag openings, " << workers
+        << " workers, " << elapsedMs << " ms\n";
+    const auto row = [&oss](const char* name, const Distribution& d) {
+        oss << "  " << name << ": mean " << d.mean << ", sd " << d.stddev << ", min " << d.min << ", p10 " << d.p10
+            << ", p50 " << d.p50 << ", p90 " << d.p90 << ", p99 " << d.p99 << ", max " << d.max << "\n";
+    };
+    row("net coins", netCoins);
+    row("growth", growth);
+    row("buff uptime", buffUptime);
+    row("easter egg tasks", easterEggTasks);
+    row("item rewards", itemRewards);
+    return oss.str();
+}
+
+}  // namespace rove::data
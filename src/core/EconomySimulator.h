@@ -0,0 +1,73 @@
+#ifndef ECONOMYSIMULATOR_H
+#define ECONOMYSIMULATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SerendipityEngine.h"
+#include "ShopItem.h"
+
+namespace rove::data {
+
+/**
+ * @class EconomySimulator
+ * @brief 奇遇与幸运礼包经济的蒙特卡洛模拟：纯计算，不访问数据库、UserManager 或 LogManager。
+ * 中文：一次模拟由 trials 个独立“玩家”组成，每个玩家经历 daysPerTrial 天的每日奇遇判定并开启 bagsPerTrial 个礼包；
+ *       试验按块均分给工作线程，每个线程使用由 (seed, 线程序号) 派生的独立 std::mt19937_64 流，
+ *       结束后把逐玩家结果归并成金币、成长值与增益覆盖率的分布。相同的 seed 与 workers 得到完全相同的结果。
+ *       判定公式与在线结算共用 SerendipityEngine::classifyRoll 与 ShopManager::AliasTable，调参结论可直接落地。
+ */
+class EconomySimulator final {
+public:
+    struct Config {
+        SerendipityEngine::ProbabilityConfig probability;
+        std::vector<ShopItem::LuckyBagReward> luckyRewards;  //!< 礼包奖励表；为空时不模拟开包。
+        int bagPriceCoins = 0;                               //!< 每次开包的成本，从净金币中扣除。
+        int trials = 10000;
+        int daysPerTrial = 120;  //!< 约一个学期。
+        int bagsPerTrial = 20;
+        unsigned workers = 0;  //!< 0 表示取 std::thread::hardware_concurrency()。
+        std::uint64_t seed = 42;
+    };
+
+    /**
+     * @brief 逐玩家指标的分布摘要。
+     */
+    struct Distribution {
+        double mean = 0.0;
+        double stddev = 0.0;
+        double min = 0.0;
+        double p10 = 0.0;
+        double p50 = 0.0;
+        double p90 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    struct Report {
+        std::uint64_t simulatedDays = 0;
+        std::uint64_t bagOpenings = 0;
+        unsigned workers = 0;
+        double elapsedMs = 0.0;
+        Distribution netCoins;     //!< 开包所得金币减去开包成本。
+        Distribution growth;       //!< 微小祝福与礼包成长值之和。
+        Distribution buffUptime;   //!< 增益生效天数占比，取值 [0,1]。
+        Distribution easterEggTasks;
+        Distribution itemRewards;  //!< 礼包开出的实物/道具件数。
+
+        /**
+         * @brief 多行文本摘要，供命令行与日志输出。
+         */
+        [[nodiscard]] std::string toText() const;
+    };
+
+    /**
+     * @brief 运行模拟；配置非法（概率越界、负数规模）时抛出 std::invalid_argument。
+     */
+    [[nodiscard]] static Report run(const Config& config);
+};
+
+}  // namespace rove::data
+
+#endif  // ECONOMYSIMULATOR_H
@@ -0,0 +1,44 @@
+#ifndef ENUMTEXT_H
+#define ENUMTEXT_H
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace rove::data {
+
+/**
+ * @file EnumText.h
+ * @brief 枚举与数据库文本列之间的编译期对照表。
+ * 中文：任务类型、日志类型、道具效果等在库中以固定英文单词存储（便于导出、索引与人工排查），内存中一律使用枚举。
+ *       对照表是 constexpr 数组：枚举转文本返回指向静态字面量的 string_view，不分配内存；
+ *       文本转枚举以 string_view 比较，调用方可直接传入列文本而无需先构造 std::string。
+ */
+template <typename Enum, std::size_t N>
+struct EnumTextTable {
+    std::array<std::pair<Enum, std::string_view>, N> entries;
+
+    [[nodiscard]] constexpr std::optional<std::string_view> text(Enum value) const noexcept {
+        for (const auto& entry : entries) {
+            if (entry.first == value) {
+                return entry.second;
+            }
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] constexpr std::optional<Enum> value(std::string_view text) const noexcept {
+        for (const auto& entry : entries) {
+            if (entry.second == text) {
+                return entry.first;
+            }
+        }
+        return std::nullopt;
+    }
+};
+
+}  // namespace rove::data
+
+#endif  // ENUMTEXT_H
@@ -0,0 +1,308 @@
+#include "EventJournal.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "Metrics.h"
+#include "RecordCodec.h"
+
+namespace rove::data {
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'L', 'J', 'R', 'N', 'L', '\0', '\0'};
+constexpr std::uint32_t kJournalFormatV1 = 1;
+constexpr std::size_t kHeaderBytes = 24;
+constexpr std::size_t kRecordFixedBytes = 45;
+constexpr std::size_t kMaxTextBytes = 16u * 1024 * 1024;  //!< 超过此长度的文本视为损坏
+constexpr std::size_t kWriteChunkBytes = 64 * 1024;
+
+static_assert((EventJournal::kCapacity & (EventJournal::kCapacity - 1)) == 0, "kCapacity must be a power of two");
+
+void encode(std::string& out, const JournalEvent& event) {
+    codec::putU64(out, event.sequence);
+    codec::putI64(out, event.timestampMs);
+    codec::putU8(out, static_cast<std::uint8_t>(event.command));
+    codec::putI32(out, event.userId);
+    codec::putI64(out, event.target);
+    codec::putI64(out, event.arg);
+    codec::putU32(out, event.rngSeed);
+    codec::putU32(out, static_cast<std::uint32_t>(event.text.size()));
+    out.append(event.text);
+}
+
+/**
+ * @brief splitmix64：相邻计数值也能得到分布均匀的种子，且不依赖标准库随机数实现。
+ */
+std::uint64_t splitmix64(std::uint64_t value) noexcept {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+std::int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+}  // namespace
+
+const char* journalCommandName(JournalCommand command) noexcept {
+    switch (command) {
+    case JournalCommand::CompleteTask:
+        return "complete_task";
+    case JournalCommand::FailTask:
+        return "fail_task";
+    case JournalCommand::TaskProgress:
+        return "task_progress";
+    case JournalCommand::Purchase:
+        return "purchase";
+    case JournalCommand::UseItem:
+        return "use_item";
+    case JournalCommand::ManualLog:
+        return "manual_log";
+    case JournalCommand::ForgiveLog:
+        return "forgive_log";
+    }
+    return "unknown";
+}
+
+EventJournal& EventJournal::instance() {
+    static EventJournal journal;
+    return journal;
+}
+
+EventJournal::~EventJournal() { stop(); }
+
+bool EventJournal::start(const std::string& path, std::uint32_t sessionSeed, std::string* error) {
+    std::unique_lock<std::mutex> lock(m_controlMutex);
+    if (m_recording.load(std::memory_order_relaxed) || m_writer.joinable()) {
+        if (error != nullptr) {
+            *error = "event journal already recording";
+        }
+        return false;
+    }
+    if (!m_slots) {
+        m_slots = std::make_unique<std::array<Slot, kCapacity>>();
+        for (std::size_t i = 0; i < kCapacity; ++i) {
+            (*m_slots)[i].turn.store(i, std::memory_order_relaxed);
+        }
+    }
+    // 中文：上次 stop 之后才入队的零星记录属于旧会话，直接丢弃。
+    JournalEvent stale;
+    while (tryPop(stale)) {
+    }
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file) {
+        if (error != nullptr) {
+            *error = "cannot create event journal " + path;
+        }
+        return false;
+    }
+    std::string head(kMagic, sizeof(kMagic));
+    codec::putU32(head, kJournalFormatV1);
+    codec::putU32(head, sessionSeed);
+    codec::putI64(head, nowMs());
+    m_file.write(head.data(), static_cast<std::streamsize>(head.size()));
+    m_file.flush();
+    m_bytesWritten.store(head.size(), std::memory_order_relaxed);
+    m_sessionSeed = sessionSeed;
+    m_sequence.store(0, std::memory_order_relaxed);
+    m_seedCounter.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_stopRequested = false;
+    m_writer = std::thread([this]() { flushLoop(); });
+    m_recording.store(true, std::memory_order_release);
+    return true;
+}
+
+void EventJournal::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_controlMutex);
+        if (!m_writer.joinable()) {
+            return;
+        }
+        m_recording.store(false, std::memory_order_release);
+        m_stopRequested = true;
+    }
+    m_wake.notify_one();
+    m_writer.join();
+    std::lock_guard<std::mutex> lock(m_controlMutex);
+    drainToFile();
+    m_file.close();
+}
+
+std::uint32_t EventJournal::nextSeed() noexcept {
+    const std::uint64_t counter = m_seedCounter.fetch_add(1, std::memory_order_relaxed);
+    const auto seed = static_cast<std::uint32_t>(splitmix64((static_cast<std::uint64_t>(m_sessionSeed) << 32) | counter));
+    return seed == 0 ? 1 : seed;
+}
+
+void EventJournal::record(JournalCommand command, std::int32_t userId, std::int64_t target, std::int64_t arg,
+                          std::string_view text, std::uint32_t rngSeed) {
+    if (!isRecording()) {
+        return;
+    }
+    JournalEvent event;
+    event.sequence = m_sequence.fetch_add(1, std::memory_order_relaxed);
+    event.timestampMs = nowMs();
+    event.command = command;
+    event.userId = userId;
+    event.target = target;
+    event.arg = arg;
+    event.rngSeed = rngSeed;
+    event.text.assign(text.substr(0, kMaxTextBytes));
+    if (!tryPush(std::move(event))) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        ROVE_COUNTER_ADD(Database, "journal.dropped", 1);
+    }
+}
+
+EventJournal::Stats EventJournal::stats() const noexcept {
+    Stats stats;
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    const std::uint64_t attempted = m_sequence.load(std::memory_order_relaxed);
+    stats.recorded = attempted >= stats.dropped ? attempted - stats.dropped : 0;
+    stats.bytesWritten = m_bytesWritten.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * @brief 有界多生产者队列：生产者以 CAS 领取位置，写完记录后把槽位的 turn 置为位置 + 1 发布给写出线程。
+ * 中文：槽位的 turn 小于领取位置说明写出线程尚未取走上一轮的记录，即缓冲已满，直接返回 false。
+ *       唤醒写出线程时不持有 m_controlMutex，错过的唤醒由 kFlushInterval 的周期兜底。
+ */
+bool EventJournal::tryPush(JournalEvent&& event) noexcept {
+    std::size_t position = m_head.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = (*m_slots)[position & (kCapacity - 1)];
+        const std::size_t turn = slot.turn.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(turn) - static_cast<std::ptrdiff_t>(position);
+        if (difference == 0) {
+            if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.event = std::move(event);
+                slot.turn.store(position + 1, std::memory_order_release);
+                if (((position + 1) & (kCapacity / 4 - 1)) == 0) {
+                    m_wake.notify_one();  // 中文：突发写入每填满四分之一缓冲提前唤醒写出线程，不等周期到期。
+                }
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;
+        } else {
+            position = m_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief 只由写出线程（或 stop 在其退出后）调用；取走记录后把 turn 推进一整圈，槽位回到可写状态。
+ */
+bool EventJournal::tryPop(JournalEvent& event) noexcept {
+    const std::size_t position = m_tail.load(std::memory_order_relaxed);
+    Slot& slot = (*m_slots)[position & (kCapacity - 1)];
+    if (slot.turn.load(std::memory_order_acquire) != position + 1) {
+        return false;
+    }
+    event = std::move(slot.event);
+    slot.turn.store(position + kCapacity, std::memory_order_release);
+    m_tail.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void EventJournal::flushLoop() {
+    std::unique_lock<std::mutex> lock(m_controlMutex);
+    while (!m_stopRequested) {
+        m_wake.wait_for(lock, kFlushInterval);
+        lock.unlock();
+        drainToFile();
+        lock.lock();
+    }
+}
+
+/**
+ * @brief 取出当前全部记录，按 kWriteChunkBytes 分批写出后刷新文件；进程崩溃最多丢失一个写出周期。
+ */
+void EventJournal::drainToFile() {
+    JournalEvent event;
+    bool wrote = false;
+    while (tryPop(event)) {
+        encode(m_encodeBuffer, event);
+        if (m_encodeBuffer.size() >= kWriteChunkBytes) {
+            m_file.write(m_encodeBuffer.data(), static_cast<std::streamsize>(m_encodeBuffer.size()));
+            m_bytesWritten.fetch_add(m_encodeBuffer.size(), std::memory_order_relaxed);
+            m_encodeBuffer.clear();
+        }
+        wrote = true;
+    }
+    if (!m_encodeBuffer.empty()) {
+        m_file.write(m_encodeBuffer.data(), static_cast<std::streamsize>(m_encodeBuffer.size()));
+        m_bytesWritten.fetch_add(m_encodeBuffer.size(), std::memory_order_relaxed);
+        m_encodeBuffer.clear();
+    }
+    if (wrote) {
+        m_file.flush();
+    }
+}
+
+EventJournalReader::EventJournalReader(std::istream& in) : m_in(in) {
+    char head[kHeaderBytes];
+    if (!readExact(head, sizeof(head)) || std::memcmp(head, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not an event journal");
+    }
+    codec::ByteReader reader{std::string_view(head, sizeof(head)), sizeof(kMagic)};
+    const std::uint32_t format = reader.u32();
+    if (format != kJournalFormatV1) {
+        throw std::runtime_error("Unsupported event journal format " + std::to_string(format));
+    }
+    m_header.sessionSeed = reader.u32();
+    m_header.startedAtMs = reader.i64();
+}
+
+bool EventJournalReader::next(JournalEvent& event) {
+    char fixed[kRecordFixedBytes];
+    m_in.read(fixed, static_cast<std::streamsize>(sizeof(fixed)));
+    if (m_in.gcount() == 0) {
+        return false;
+    }
+    if (m_in.gcount() != static_cast<std::streamsize>(sizeof(fixed))) {
+        m_truncated = true;
+        return false;
+    }
+    // 中文：定长部分已整块读入，ByteReader 不会越界，按写入顺序依次取字段。
+    codec::ByteReader reader{std::string_view(fixed, sizeof(fixed))};
+    event.sequence = reader.u64();
+    event.timestampMs = reader.i64();
+    const std::uint8_t command = reader.u8();
+    if (command < static_cast<std::uint8_t>(JournalCommand::CompleteTask) ||
+        command > static_cast<std::uint8_t>(JournalCommand::ForgiveLog)) {
+        throw std::runtime_error("Corrupted event journal: unknown command " + std::to_string(command));
+    }
+    event.command = static_cast<JournalCommand>(command);
+    event.userId = reader.i32();
+    event.target = reader.i64();
+    event.arg = reader.i64();
+    event.rngSeed = reader.u32();
+    const std::size_t textBytes = reader.u32();
+    if (textBytes > kMaxTextBytes) {
+        throw std::runtime_error("Corrupted event journal: text too long");
+    }
+    event.text.resize(textBytes);
+    if (!readExact(event.text.data(), textBytes)) {
+        m_truncated = true;
+        return false;
+    }
+    return true;
+}
+
+bool EventJournalReader::readExact(char* data, std::size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    m_in.read(data, static_cast<std::streamsize>(size));
+    return m_in.gcount() == static_cast<std::streamsize>(size);
+}
+
+}  // namespace rove::data
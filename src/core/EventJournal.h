@@ -0,0 +1,180 @@
+#ifndef EVENTJOURNAL_H
+#define EVENTJOURNAL_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace rove::data {
+
+/**
+ * @brief 日志中记录的管理器级命令。
+ * 中文：target 与 arg 的含义随命令而定：
+ *       CompleteTask / FailTask / TaskProgress 的 target 为任务 ID，FailTask 的 arg 为是否使用宽恕券，TaskProgress 的 arg 为进度增量；
+ *       Purchase 的 target 为商品 ID、arg 为数量；UseItem 的 target 为库存 ID；
+ *       ManualLog 的 arg 为心情枚举、text 为内容；ForgiveLog 的 target 为日志 ID。
+ */
+enum class JournalCommand : std::uint8_t {
+    CompleteTask = 1,
+    FailTask,
+    TaskProgress,
+    Purchase,
+    UseItem,
+    ManualLog,
+    ForgiveLog,
+};
+
+[[nodiscard]] const char* journalCommandName(JournalCommand command) noexcept;
+
+/**
+ * @brief 一条命令记录。
+ * 中文：sequence 按入队顺序连续编号，读取时出现空缺说明环形缓冲曾经写满、有记录被丢弃；
+ *       rngSeed 非 0 时，命令执行前商城抽奖引擎已用它重新播种，回放时照做即可得到相同的抽奖结果。
+ */
+struct JournalEvent {
+    std::uint64_t sequence = 0;
+    std::int64_t timestampMs = 0;  //!< UTC 毫秒
+    JournalCommand command = JournalCommand::CompleteTask;
+    std::int32_t userId = 0;
+    std::int64_t target = 0;
+    std::int64_t arg = 0;
+    std::uint32_t rngSeed = 0;
+    std::string text;
+};
+
+/**
+ * @brief 日志文件头：会话种子与开始记录的时刻。
+ */
+struct JournalHeader {
+    std::uint32_t sessionSeed = 0;
+    std::int64_t startedAtMs = 0;
+};
+
+/**
+ * @class EventJournal
+ * @brief 可选的二进制命令日志，用于在基准工具中按用户的真实会话回放并剖析性能。
+ * 中文：管理器在每个命令入口调用 record()；未开启时只有一次 relaxed 原子读。开启后记录写入固定容量的无锁环形缓冲
+ *       （多生产者，按槽位序号发布），后台线程每 kFlushInterval 取出一批编码后追加到文件，调用线程从不等待磁盘。
+ *       缓冲写满时丢弃新记录并计数，不阻塞界面；丢弃在文件中表现为序号空缺，回放工具会提示。
+ *       文件布局（小端序）：8 字节魔数 "CLJRNL\0\0"，u32 格式版本，u32 会话种子，i64 开始时刻；随后逐条记录：
+ *       u64 序号，i64 时刻，u8 命令，i32 用户，i64 target，i64 arg，u32 种子，u32 文本长度 + 文本。
+ *       没有结尾标记：进程崩溃时最后一条可能不完整，读取方把它视为结尾。
+ */
+class EventJournal {
+public:
+    static constexpr std::size_t kCapacity = 4096;  //!< 环形缓冲槽位数，须为 2 的幂
+    static constexpr std::chrono::milliseconds kFlushInterval{50};
+
+    /**
+     * @brief 记录与丢弃计数。
+     */
+    struct Stats {
+        std::uint64_t recorded = 0;
+        std::uint64_t dropped = 0;
+        std::uint64_t bytesWritten = 0;
+    };
+
+    static EventJournal& instance();
+
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+    ~EventJournal();
+
+    /**
+     * @brief 创建（覆盖）日志文件、写入文件头并启动后台写出线程。
+     * @param sessionSeed 派生各命令抽奖种子的会话种子。
+     * @return 已在记录或文件无法创建时返回 false 并写入 error。
+     */
+    bool start(const std::string& path, std::uint32_t sessionSeed, std::string* error = nullptr);
+
+    /**
+     * @brief 停止记录，写出缓冲中剩余的记录并关闭文件；未开启时无操作。
+     */
+    void stop();
+
+    [[nodiscard]] bool isRecording() const noexcept { return m_recording.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 由会话种子派生下一个非 0 的命令种子；只在 isRecording() 时有意义。
+     */
+    [[nodiscard]] std::uint32_t nextSeed() noexcept;
+
+    /**
+     * @brief 记录一条命令；未开启时立即返回，缓冲满时丢弃。可在任意线程调用。
+     */
+    void record(JournalCommand command, std::int32_t userId, std::int64_t target, std::int64_t arg = 0,
+                std::string_view text = {}, std::uint32_t rngSeed = 0);
+
+    [[nodiscard]] Stats stats() const noexcept;
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> turn{0};  //!< 等于位置时可写，等于位置 + 1 时可读
+        JournalEvent event;
+    };
+
+    EventJournal() = default;
+
+    bool tryPush(JournalEvent&& event) noexcept;
+    bool tryPop(JournalEvent& event) noexcept;
+    void flushLoop();
+    void drainToFile();
+
+    std::unique_ptr<std::array<Slot, kCapacity>> m_slots;
+    alignas(64) std::atomic<std::size_t> m_head{0};  //!< 生产者领取的下一个位置
+    alignas(64) std::atomic<std::size_t> m_tail{0};  //!< 写出线程读取的下一个位置
+    std::atomic<bool> m_recording{false};
+    std::atomic<std::uint64_t> m_sequence{0};
+    std::atomic<std::uint64_t> m_seedCounter{0};
+    std::atomic<std::uint64_t> m_dropped{0};
+    std::atomic<std::uint64_t> m_bytesWritten{0};
+    std::uint32_t m_sessionSeed = 0;
+
+    std::mutex m_controlMutex;  //!< 串行化 start/stop，并配合 m_wake 让写出线程按周期醒来
+    std::condition_variable m_wake;
+    bool m_stopRequested = false;
+    std::ofstream m_file;
+    std::string m_encodeBuffer;
+    std::thread m_writer;
+};
+
+/**
+ * @class EventJournalReader
+ * @brief 顺序读取 EventJournal 写出的文件。
+ * 中文：魔数或格式版本不符时构造抛出 std::runtime_error；末尾不完整的记录视为结尾并由 truncated() 报告。
+ */
+class EventJournalReader {
+public:
+    explicit EventJournalReader(std::istream& in);
+
+    [[nodiscard]] const JournalHeader& header() const noexcept { return m_header; }
+
+    /**
+     * @brief 读取下一条记录，复用 event 的存储；到达文件结尾时返回 false。
+     * @throws std::runtime_error 记录中的命令类型未知。
+     */
+    bool next(JournalEvent& event);
+
+    [[nodiscard]] bool truncated() const noexcept { return m_truncated; }
+
+private:
+    bool readExact(char* data, std::size_t size);
+
+    std::istream& m_in;
+    JournalHeader m_header;
+    bool m_truncated = false;
+};
+
+}  // namespace rove::data
+
+#endif  // EVENTJOURNAL_H
@@ -0,0 +1,249 @@
+#include "GrowthAnalytics.h"
+
+#include <algorithm>
+
+namespace rove::data {
+
+namespace {
+
+constexpr unsigned char kStateFormatV1 = 0xA1;
+constexpr std::size_t kWeekDays = static_cast<std::size_t>(GrowthAnalytics::Window::Week);
+constexpr auto kGrowth = static_cast<std::size_t>(SnapshotColumn::Growth);
+constexpr auto kCompleted = static_cast<std::size_t>(SnapshotColumn::CompletedTasks);
+constexpr auto kFirstAttribute = static_cast<std::size_t>(SnapshotColumn::Execution);
+
+void putI32(std::string& out, std::int32_t value) {
+    const auto bits = static_cast<std::uint32_t>(value);
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>((bits >> shift) & 0xFF));
+    }
+}
+
+void putI64(std::string& out, std::int64_t value) {
+    const auto bits = static_cast<std::uint64_t>(value);
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<char>((bits >> shift) & 0xFF));
+    }
+}
+
+/**
+ * @brief 顺序读取小端整数，越界时置 ok = false。
+ */
+struct StateReader {
+    std::string_view data;
+    std::size_t pos = 0;
+    bool ok = true;
+
+    std::uint64_t bits(std::size_t width) {
+        ok = ok && data.size() - pos >= width;
+        if (!ok) {
+            return 0;
+        }
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < width; ++i) {
+            value |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(data[pos + i])) << (8 * i);
+        }
+        pos += width;
+        return value;
+    }
+
+    std::uint8_t u8() { return static_cast<std::uint8_t>(bits(1)); }
+    std::int32_t i32() { return static_cast<std::int32_t>(static_cast<std::uint32_t>(bits(4))); }
+    std::int64_t i64() { return static_cast<std::int64_t>(bits(8)); }
+};
+
+double percentile(const std::int32_t* sorted, std::size_t count, double q) {
+    const auto rank = static_cast<std::size_t>(q * static_cast<double>(count - 1) + 0.5);
+    return sorted[std::min(rank, count - 1)];
+}
+
+}  // namespace
+
+void GrowthAnalytics::observe(std::int64_t timestampMs, std::int64_t day, const SnapshotSeries::Row& values) {
+    if (m_filled != 0 && timestampMs <= m_lastSampleMs) {
+        return;
+    }
+    m_cache = {};
+    m_lastSampleMs = timestampMs;
+    if (m_filled == 0) {
+        m_currentDay = day;
+        m_dayOpenCompleted = values[kCompleted];
+        pushDay(values);
+        recountStreak(values);
+        return;
+    }
+    if (day < m_currentDay) {
+        return;  // 中文：系统时间被回拨，收盘值不倒退。
+    }
+    if (day > m_currentDay) {
+        const std::int64_t gap = day - m_currentDay;
+        if (!m_currentDayCounted || gap > 1) {
+            m_currentStreak = 0;
+        }
+        // 中文：空缺的日子沿用上一收盘值；超过窗口长度的空缺只需填满一次环形缓冲。
+        const SnapshotSeries::Row previous = closeAt(0);
+        const auto fill = static_cast<std::size_t>(std::min<std::int64_t>(gap - 1, kHistoryDays));
+        for (std::size_t i = 0; i < fill; ++i) {
+            pushDay(previous);
+        }
+        m_dayOpenCompleted = previous[kCompleted];
+        m_currentDay = day;
+        m_currentDayCounted = false;
+        pushDay(values);
+    } else {
+        const std::int64_t change = static_cast<std::int64_t>(values[kGrowth]) - m_closes[m_head][kGrowth];
+        m_weekSum += change;
+        m_monthSum += change;
+        m_closes[m_head] = values;
+    }
+    recountStreak(values);
+}
+
+const GrowthAnalytics::Insights& GrowthAnalytics::insights(Window window) const {
+    auto& cached = m_cache[window == Window::Week ? 0 : 1];
+    if (!cached.has_value()) {
+        cached = computeInsights(static_cast<std::size_t>(window));
+    }
+    return *cached;
+}
+
+std::optional<std::int64_t> GrowthAnalytics::lastSampleMs() const noexcept {
+    if (m_filled == 0) {
+        return std::nullopt;
+    }
+    return m_lastSampleMs;
+}
+
+/**
+ * 布局（小端序）：
+ *   u8 版本标记 kStateFormatV1, i64 水位, i64 当日序号, i32 前日完成数, i32 当前连击, i32 最长连击,
+ *   u8 今日已计入, u8 天数 N, N × 12 × i32 收盘值（由旧到新）。滚动和由收盘值重算，不单独保存。
+ */
+std::string GrowthAnalytics::encode() const {
+    std::string out;
+    out.reserve(32 + m_filled * kSnapshotColumnCount * 4);
+    out.push_back(static_cast<char>(kStateFormatV1));
+    putI64(out, m_lastSampleMs);
+    putI64(out, m_currentDay);
+    putI32(out, m_dayOpenCompleted);
+    putI32(out, m_currentStreak);
+    putI32(out, m_longestStreak);
+    out.push_back(static_cast<char>(m_currentDayCounted ? 1 : 0));
+    out.push_back(static_cast<char>(m_filled));
+    for (std::size_t daysAgo = m_filled; daysAgo-- > 0;) {
+        for (const std::int32_t value : closeAt(daysAgo)) {
+            putI32(out, value);
+        }
+    }
+    return out;
+}
+
+std::optional<GrowthAnalytics> GrowthAnalytics::decode(std::string_view blob) {
+    StateReader reader{blob};
+    if (reader.u8() != kStateFormatV1) {
+        return std::nullopt;
+    }
+    GrowthAnalytics analytics;
+    analytics.m_lastSampleMs = reader.i64();
+    analytics.m_currentDay = reader.i64();
+    analytics.m_dayOpenCompleted = reader.i32();
+    analytics.m_currentStreak = reader.i32();
+    analytics.m_longestStreak = reader.i32();
+    analytics.m_currentDayCounted = reader.u8() != 0;
+    analytics.m_filled = reader.u8();
+    if (!reader.ok || analytics.m_filled > kHistoryDays) {
+        return std::nullopt;
+    }
+    for (std::size_t day = 0; day < analytics.m_filled; ++day) {
+        for (auto& value : analytics.m_closes[day]) {
+            value = reader.i32();
+        }
+    }
+    if (!reader.ok || reader.pos != blob.size()) {
+        return std::nullopt;
+    }
+    analytics.m_head = analytics.m_filled == 0 ? 0 : analytics.m_filled - 1;
+    analytics.recomputeSums();
+    return analytics;
+}
+
+const SnapshotSeries::Row& GrowthAnalytics::closeAt(std::size_t daysAgo) const noexcept {
+    return m_closes[(m_head + kHistoryDays - daysAgo) % kHistoryDays];
+}
+
+void GrowthAnalytics::pushDay(const SnapshotSeries::Row& close) {
+    // 中文：先减去即将滑出窗口的那一天，再写入新的一天；两个滚动和都只做一次加减。
+    if (m_filled >= kWeekDays) {
+        m_weekSum -= closeAt(kWeekDays - 1)[kGrowth];
+    }
+    if (m_filled == kHistoryDays) {
+        m_monthSum -= closeAt(kHistoryDays - 1)[kGrowth];
+    }
+    m_head = m_filled == 0 ? 0 : (m_head + 1) % kHistoryDays;
+    m_closes[m_head] = close;
+    m_filled = std::min(m_filled + 1, kHistoryDays);
+    m_weekSum += close[kGrowth];
+    m_monthSum += close[kGrowth];
+}
+
+void GrowthAnalytics::recountStreak(const SnapshotSeries::Row& close) {
+    const bool counted = close[kCompleted] > m_dayOpenCompleted;
+    if (counted && !m_currentDayCounted) {
+        ++m_currentStreak;
+        m_longestStreak = std::max(m_longestStreak, m_currentStreak);
+    } else if (!counted && m_currentDayCounted) {
+        --m_currentStreak;
+    }
+    m_currentDayCounted = counted;
+}
+
+void GrowthAnalytics::recomputeSums() noexcept {
+    m_weekSum = 0;
+    m_monthSum = 0;
+    for (std::size_t daysAgo = 0; daysAgo < m_filled; ++daysAgo) {
+        const std::int32_t growth = closeAt(daysAgo)[kGrowth];
+        m_monthSum += growth;
+        if (daysAgo < kWeekDays) {
+            m_weekSum += growth;
+        }
+    }
+}
+
+GrowthAnalytics::Insights GrowthAnalytics::computeInsights(std::size_t windowDays) const {
+    Insights result;
+    result.currentStreak = m_currentStreak;
+    result.longestStreak = m_longestStreak;
+    const std::size_t days = std::min(windowDays, m_filled);
+    if (days == 0) {
+        return result;
+    }
+    result.days = static_cast<int>(days);
+    const std::int64_t sum = windowDays <= kWeekDays ? m_weekSum : m_monthSum;
+    result.movingAverage = static_cast<double>(sum) / static_cast<double>(days);
+    if (days < 2) {
+        return result;
+    }
+
+    const auto span = static_cast<double>(days - 1);
+    const auto& latest = closeAt(0);
+    const auto& earliest = closeAt(days - 1);
+    result.growthVelocity = (latest[kGrowth] - earliest[kGrowth]) / span;
+    for (std::size_t i = 0; i < kAttributeCount; ++i) {
+        result.attributeVelocity[i] = (latest[kFirstAttribute + i] - earliest[kFirstAttribute + i]) / span;
+    }
+
+    std::array<std::int32_t, kHistoryDays> growth{};
+    for (std::size_t i = 0; i < days; ++i) {
+        growth[i] = closeAt(days - 1 - i)[kGrowth];
+    }
+    std::array<std::int32_t, kHistoryDays> gains{};
+    series::deltas(growth.data(), days, gains.data());
+    const std::size_t gainCount = days - 1;
+    std::sort(gains.begin(), gains.begin() + static_cast<std::ptrdiff_t>(gainCount));
+    result.dailyGain.p10 = percentile(gains.data(), gainCount, 0.10);
+    result.dailyGain.p50 = percentile(gains.data(), gainCount, 0.50);
+    result.dailyGain.p90 = percentile(gains.data(), gainCount, 0.90);
+    return result;
+}
+
+}  // namespace rove::data
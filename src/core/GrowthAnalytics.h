@@ -0,0 +1,118 @@
+#ifndef GROWTHANALYTICS_H
+#define GROWTHANALYTICS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "SnapshotSeries.h"
+
+namespace rove::data {
+
+/**
+ * @class GrowthAnalytics
+ * @brief 成长趋势分析：7/30 天移动平均、属性速度、完成连击与每日成长分位带。
+ * 中文：以“自然日收盘值”为单位增量维护。每条快照只更新当日收盘值与两个窗口的滚动和，跨日时环形缓冲前移一格，
+ *       单条样本的代价与历史长度无关；分位带与速度只在查询时由最多 30 个收盘值算出，并按窗口缓存到下一条样本。
+ *       状态可编码为定长字节串持久化，启动时只需补读水位之后的少量快照。本类不加锁，由调用方串行访问。
+ */
+class GrowthAnalytics {
+public:
+    static constexpr std::size_t kAttributeCount = 6;  //!< 行动、毅力、决断、知识、社交、自豪
+    static constexpr std::size_t kHistoryDays = 30;    //!< 保留的收盘天数，等于最长窗口
+
+    /**
+     * @brief 统计窗口，取值为窗口天数。
+     */
+    enum class Window : int { Week = 7, Month = 30 };
+
+    struct PercentileBand {
+        double p10 = 0.0;
+        double p50 = 0.0;
+        double p90 = 0.0;
+    };
+
+    /**
+     * @brief 一个窗口的分析结果；窗口内天数不足时按已有天数计算。
+     */
+    struct Insights {
+        int days = 0;                 //!< 窗口实际覆盖的天数（含今天）
+        double movingAverage = 0.0;   //!< 每日收盘成长值的平均
+        double growthVelocity = 0.0;  //!< 成长值每日变化量
+        std::array<double, kAttributeCount> attributeVelocity{};  //!< 各属性每日变化量
+        PercentileBand dailyGain;     //!< 相邻两日成长值增量的 p10/p50/p90
+        int currentStreak = 0;        //!< 截至今天（今天尚未完成时截至昨天）的连续完成天数
+        int longestStreak = 0;
+    };
+
+    /**
+     * @brief 并入一条快照。
+     * 中文：day 为本地自然日序号（如儒略日），只要求单调；同日样本覆盖当日收盘值，跨多日时以上一收盘值补齐空缺。
+     *       时间戳不晚于已并入样本的快照被忽略，因此重复并入同一条快照是幂等的。
+     */
+    void observe(std::int64_t timestampMs, std::int64_t day, const SnapshotSeries::Row& values);
+
+    /**
+     * @brief 依次并入列式时间线中的全部行，dayOf 把毫秒时间戳映射为自然日序号。
+     */
+    template <typename DayOf>
+    void observeSeries(const SnapshotSeries& series, DayOf dayOf) {
+        const auto& timestamps = series.timestamps();
+        for (std::size_t row = 0; row < series.size(); ++row) {
+            SnapshotSeries::Row values{};
+            for (std::size_t column = 0; column < kSnapshotColumnCount; ++column) {
+                values[column] = series.column(static_cast<SnapshotColumn>(column))[row];
+            }
+            observe(timestamps[row], dayOf(timestamps[row]), values);
+        }
+    }
+
+    /**
+     * @brief 返回窗口分析结果；同一窗口在下一次 observe 之前只计算一次。
+     */
+    [[nodiscard]] const Insights& insights(Window window) const;
+
+    [[nodiscard]] bool empty() const noexcept { return m_filled == 0; }
+
+    /**
+     * @brief 已并入的最新快照时间戳，即持久化水位；尚无样本时为空。
+     */
+    [[nodiscard]] std::optional<std::int64_t> lastSampleMs() const noexcept;
+
+    /**
+     * @brief 编码为紧凑的小端字节串（含 NUL 字节，需以 BLOB 存取）。
+     */
+    [[nodiscard]] std::string encode() const;
+
+    /**
+     * @brief 解码 encode 的输出；版本不符或数据损坏时返回空，调用方应从快照重建。
+     */
+    [[nodiscard]] static std::optional<GrowthAnalytics> decode(std::string_view blob);
+
+private:
+    [[nodiscard]] const SnapshotSeries::Row& closeAt(std::size_t daysAgo) const noexcept;
+    void pushDay(const SnapshotSeries::Row& close);
+    void recountStreak(const SnapshotSeries::Row& close);
+    void recomputeSums() noexcept;
+    [[nodiscard]] Insights computeInsights(std::size_t windowDays) const;
+
+    std::array<SnapshotSeries::Row, kHistoryDays> m_closes{};  //!< 环形缓冲，m_head 为当日
+    std::size_t m_head = 0;
+    std::size_t m_filled = 0;
+    std::int64_t m_currentDay = 0;
+    std::int64_t m_lastSampleMs = 0;
+    std::int64_t m_weekSum = 0;   //!< 最近至多 7 天收盘成长值之和
+    std::int64_t m_monthSum = 0;  //!< 最近至多 30 天收盘成长值之和
+    std::int32_t m_dayOpenCompleted = 0;  //!< 前一日收盘时的累计完成任务数
+    std::int32_t m_currentStreak = 0;
+    std::int32_t m_longestStreak = 0;
+    bool m_currentDayCounted = false;  //!< 今天是否已计入连击
+    mutable std::array<std::optional<Insights>, 2> m_cache;  //!< 依次对应 Week、Month
+};
+
+}  // namespace rove::data
+
+#endif  // GROWTHANALYTICS_H
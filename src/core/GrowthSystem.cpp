@@ -1,167 +1,236 @@
 #include "GrowthSystem.h"
+#include <algorithm>
 #include <QDebug>
 #include <QDateTime>
 #include "User.h"
 #include "Task.h"
 #include "Achievement.h"
+#include "LevelCurve.h"
 
 namespace rove::systems {
 
-// 经验需求表
-const QMap<int, int> GrowthSystem::EXP_REQUIREMENTS = {
-    {1, 100}, {2, 250}, {3, 450}, {4, 700}, {5, 1000},
-    {6, 1350}, {7, 1750}, {8, 2200}, {9, 2700}, {10, 3250},
-    {11, 3850}, {12, 4500}, {13, 5200}, {14, 5950}, {15, 6750},
-    {16, 7600}, {17, 8500}, {18, 9450}, {19, 10450}, {20, 11500}
+using data::levels::kMaxLevel;
+using data::levels::thresholdForLevel;
+
+namespace {
+
+struct FeatureUnlock {
+    GrowthSystem::Feature feature;
+    const char *key;
+    int level;
 };
 
-GrowthSystem::GrowthSystem(QObject *parent) : QObject(parent)
+// 功能表按解锁等级升序排列：升级时解锁的是表中一段连续区间，用二分查找定位区间终点
+constexpr std::array<FeatureUnlock, GrowthSystem::kFeatureCount> kFeatureUnlocks = {{
+    {GrowthSystem::Feature::CustomTaskAdvanced, "custom_task_advanced", 5},
+    {GrowthSystem::Feature::CustomAchievementAdvanced, "custom_achievement_advanced", 8},
+    {GrowthSystem::Feature::ShopDiscount, "shop_discount", 10},
+    {GrowthSystem::Feature::DoubleExpWeekend, "double_exp_weekend", 12},
+    {GrowthSystem::Feature::PremiumBackgrounds, "premium_backgrounds", 15},
+    {GrowthSystem::Feature::AchievementAnalyze, "achievement_analyze", 18},
+}};
+
+constexpr bool featureTableIsValid()
+{
+    std::array<bool, GrowthSystem::kFeatureCount> seen{};
+    for (std::size_t i = 0; i < kFeatureUnlocks.size(); ++i) {
+        const auto index = static_cast<std::size_t>(kFeatureUnlocks[i].feature);
+        if (index >= GrowthSystem::kFeatureCount || seen[index]) return false;
+        if (i > 0 && kFeatureUnlocks[i - 1].level > kFeatureUnlocks[i].level) return false;
+        seen[index] = true;
+    }
+    return true;
+}
+static_assert(featureTableIsValid(), "功能表须覆盖每个 Feature 恰好一次，并按解锁等级升序排列");
+
+const FeatureUnlock *findFeature(GrowthSystem::Feature feature)
+{
+    for (const FeatureUnlock &entry : kFeatureUnlocks) {
+        if (entry.feature == feature) return &entry;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+GrowthSystem::GrowthSystem(data::UserManager &userManager, QObject *parent)
+    : QObject(parent), m_userManager(userManager)
 {
-    m_currentLevel = 1;
-    m_currentExp = 0;
-    m_currentCoins = 0;
     m_totalExpGained = 0;
     m_totalCoinsGained = 0;
     m_firstLoginDate = QDateTime::currentDateTime();
     m_lastLoginDate = QDateTime::currentDateTime();
-    
-    // 初始化属性
-    for (int i = 0; i < static_cast<int>(Attribute::AttributeCount); ++i) {
-        m_attributes[static_cast<Attribute>(i)] = 0;
+}
+
+data::ProgressionState GrowthSystem::currentState() const
+{
+    if (!m_userManager.hasActiveUser()) {
+        return {};
     }
-    
-    // 初始化功能解锁等级
-    m_featureUnlockLevels = {
-        {"custom_task_advanced", 5},
-        {"custom_achievement_advanced", 8},
-        {"shop_discount", 10},
-        {"double_exp_weekend", 12},
-        {"premium_backgrounds", 15},
-        {"achievement_analyze", 18}
-    };
+    return data::ProgressionState::of(m_userManager.activeUser());
 }
 
 int GrowthSystem::getExpToNextLevel() const
 {
-    if (m_currentLevel >= EXP_REQUIREMENTS.size()) {
+    const int level = getLevel();
+    if (level >= kMaxLevel) {
         return 0; // 满级
     }
-    return EXP_REQUIREMENTS.value(m_currentLevel + 1, 0);
+    return thresholdForLevel(level + 1);
 }
 
-void GrowthSystem::addExperience(int exp, const QString &source)
+// 所有奖励汇总为一次 UserManager::applyRewards：只保存一次，升级判定由 User 按共用的 LevelCurve 完成，
+// 字段变化随后经 progressionChanged 合并通知，不在这里逐项发信号
+void GrowthSystem::grant(int exp, int coins, const AttributeArray &deltas, const QString &source)
 {
-    if (exp <= 0) return;
-    
-    int oldLevel = m_currentLevel;
-    m_currentExp += exp;
-    m_totalExpGained += exp;
-    
-    // 检查升级
-    while (m_currentLevel < EXP_REQUIREMENTS.size() && 
-           m_currentExp >= EXP_REQUIREMENTS.value(m_currentLevel + 1)) {
-        levelUp();
+    bool anyAttribute = false;
+    for (int delta : deltas) {
+        anyAttribute = anyAttribute || delta != 0;
     }
-    
-    emit experienceChanged(m_currentExp, getExpToNextLevel());
-    
-    if (m_currentLevel > oldLevel) {
-        emit levelChanged(m_currentLevel, oldLevel);
-        qDebug() << "升级！当前等级:" << m_currentLevel << "来源:" << source;
-    } else {
-        qDebug() << "获得经验:" << exp << "来源:" << source;
+    if (exp <= 0 && coins <= 0 && !anyAttribute) return;
+    if (!m_userManager.hasActiveUser()) {
+        qWarning() << "GrowthSystem: 未登录，忽略奖励，来源:" << source;
+        return;
     }
+    m_userManager.applyRewards(exp, coins, toUserAttributeSet(deltas));
+    qDebug() << "发放奖励 - 经验:" << exp << "金币:" << coins << "来源:" << source;
 }
 
-void GrowthSystem::levelUp()
+void GrowthSystem::addExperience(int exp, const QString &source)
 {
-    m_currentLevel++;
-    
-    // 检查新解锁的功能
-    checkLevelUpFeatures();
+    if (exp <= 0) return;
+    grant(exp, 0, AttributeArray{}, source);
 }
 
-void GrowthSystem::checkLevelUpFeatures()
+// 降级不会收回已解锁的功能，游标因此只前进；fromJson 恢复的位可能已在区间内，已置位的不重复通知
+void GrowthSystem::unlockFeaturesThroughLevel(bool notify)
 {
-    for (auto it = m_featureUnlockLevels.constBegin(); it != m_featureUnlockLevels.constEnd(); ++it) {
-        if (m_currentLevel >= it.value() && !m_unlockedFeatures.contains(it.key())) {
-            m_unlockedFeatures.append(it.key());
-            emit featureUnlocked(it.key());
-            qDebug() << "解锁功能:" << it.key();
+    const int level = getLevel();
+    const auto end = std::upper_bound(kFeatureUnlocks.begin(), kFeatureUnlocks.end(), level,
+                                      [](int value, const FeatureUnlock &entry) { return value < entry.level; });
+    const auto last = static_cast<std::size_t>(end - kFeatureUnlocks.begin());
+    for (; m_featureLevelCursor < last; ++m_featureLevelCursor) {
+        const FeatureUnlock &entry = kFeatureUnlocks[m_featureLevelCursor];
+        const auto index = static_cast<std::size_t>(entry.feature);
+        if (m_unlockedFeatures.test(index)) continue;
+        m_unlockedFeatures.set(index);
+        if (notify) {
+            emit featureUnlocked(QString::fromLatin1(entry.key));
+            qDebug() << "解锁功能:" << entry.key;
         }
     }
 }
 
+void GrowthSystem::checkLevelUpFeatures()
+{
+    unlockFeaturesThroughLevel(true);
+}
+
 int GrowthSystem::getAttribute(Attribute attr) const
 {
-    return m_attributes.value(attr, 0);
+    const auto index = static_cast<std::size_t>(attr);
+    return index < kAttributeCount ? getAllAttributes()[index] : 0;
 }
 
 void GrowthSystem::addAttribute(Attribute attr, int value)
 {
-    if (value == 0) return;
-    
-    int oldValue = m_attributes.value(attr, 0);
-    m_attributes[attr] = oldValue + value;
+    const auto index = static_cast<std::size_t>(attr);
+    if (value == 0 || index >= kAttributeCount) return;
     
-    emit attributeChanged(attr, m_attributes[attr]);
-    qDebug() << "属性增加:" << attributeToString(attr) << "值:" << value << "新值:" << m_attributes[attr];
+    AttributeArray deltas{};
+    deltas[index] = value;
+    grant(0, 0, deltas, attributeToString(attr));
 }
 
 void GrowthSystem::addAttributes(const QMap<Attribute, int> &attributes)
 {
+    AttributeArray deltas{};
     for (auto it = attributes.constBegin(); it != attributes.constEnd(); ++it) {
-        addAttribute(it.key(), it.value());
+        const auto index = static_cast<std::size_t>(it.key());
+        if (index < kAttributeCount) {
+            deltas[index] += it.value();
+        }
     }
+    addAttributes(deltas);
 }
 
-QMap<GrowthSystem::Attribute, int> GrowthSystem::getAllAttributes() const
+void GrowthSystem::addAttributes(const AttributeArray &deltas)
 {
-    return m_attributes;
+    grant(0, 0, deltas, "属性加成");
 }
 
 void GrowthSystem::addCoins(int coins)
 {
     if (coins <= 0) return;
-    
-    int oldCoins = m_currentCoins;
-    m_currentCoins += coins;
-    m_totalCoinsGained += coins;
-    
-    emit coinsChanged(m_currentCoins, coins);
-    qDebug() << "获得金币:" << coins << "总额:" << m_currentCoins;
+    grant(0, coins, AttributeArray{}, "金币奖励");
 }
 
 bool GrowthSystem::spendCoins(int coins)
 {
-    if (coins <= 0 || m_currentCoins < coins) {
+    if (coins <= 0 || !m_userManager.hasActiveUser()) {
         return false;
     }
-    
-    int oldCoins = m_currentCoins;
-    m_currentCoins -= coins;
-    
-    emit coinsChanged(m_currentCoins, -coins);
-    qDebug() << "花费金币:" << coins << "剩余:" << m_currentCoins;
+
+    // 中文：余额核对与扣减在同一次加锁内完成，数据线程上的购买不会与这里交错透支。
+    const bool spent = m_userManager.updateActiveUser([coins](data::User& user) {
+        if (user.coins() < coins) {
+            return false;
+        }
+        user.spendCoins(coins);
+        return true;
+    });
+    if (!spent) {
+        return false;
+    }
+    qDebug() << "花费金币:" << coins << "剩余:" << getCoins();
     return true;
 }
 
 bool GrowthSystem::isFeatureUnlocked(const QString &feature) const
 {
-    return m_unlockedFeatures.contains(feature);
+    const std::optional<Feature> id = featureFromKey(feature);
+    return id.has_value() && isFeatureUnlocked(*id);
 }
 
+// 按功能表顺序（即解锁等级顺序）列出
 QList<QString> GrowthSystem::getUnlockedFeatures() const
 {
-    return m_unlockedFeatures;
+    QList<QString> features;
+    for (const FeatureUnlock &entry : kFeatureUnlocks) {
+        if (m_unlockedFeatures.test(static_cast<std::size_t>(entry.feature))) {
+            features.append(QString::fromLatin1(entry.key));
+        }
+    }
+    return features;
+}
+
+QString GrowthSystem::featureKey(Feature feature)
+{
+    const FeatureUnlock *entry = findFeature(feature);
+    return entry != nullptr ? QString::fromLatin1(entry->key) : QString();
+}
+
+std::optional<GrowthSystem::Feature> GrowthSystem::featureFromKey(const QString &key)
+{
+    for (const FeatureUnlock &entry : kFeatureUnlocks) {
+        if (key == QLatin1String(entry.key)) return entry.feature;
+    }
+    return std::nullopt;
+}
+
+int GrowthSystem::featureUnlockLevel(Feature feature)
+{
+    const FeatureUnlock *entry = findFeature(feature);
+    return entry != nullptr ? entry->level : 0;
 }
 
 QJsonObject GrowthSystem::toJson() const
 {
+    const data::ProgressionState state = currentState();
     QJsonObject json;
-    json["level"] = m_currentLevel;
-    json["exp"] = m_currentExp;
-    json["coins"] = m_currentCoins;
+    json["level"] = state.level;
+    json["exp"] = state.growthPoints;
+    json["coins"] = state.coins;
     json["totalExpGained"] = m_totalExpGained;
     json["totalCoinsGained"] = m_totalCoinsGained;
     json["firstLoginDate"] = m_firstLoginDate.toString(Qt::ISODate);
@@ -169,14 +238,15 @@ QJsonObject GrowthSystem::toJson() const
     
     // 保存属性
     QJsonObject attrsJson;
-    for (auto it = m_attributes.constBegin(); it != m_attributes.constEnd(); ++it) {
-        attrsJson[attributeToString(it.key())] = it.value();
+    const AttributeArray attributes = fromUserAttributeSet(state.attributes);
+    for (std::size_t i = 0; i < kAttributeCount; ++i) {
+        attrsJson[attributeToString(static_cast<Attribute>(i))] = attributes[i];
     }
     json["attributes"] = attrsJson;
     
     // 保存解锁的功能
     QJsonArray featuresArray;
-    for (const QString &feature : m_unlockedFeatures) {
+    for (const QString &feature : getUnlockedFeatures()) {
         featuresArray.append(feature);
     }
     json["unlockedFeatures"] = featuresArray;
@@ -184,162 +254,78 @@ QJsonObject GrowthSystem::toJson() const
     return json;
 }
 
+// 等级、经验、金币与属性以 UserManager 中的用户为准，这里只恢复本类自己的统计与功能解锁记录
 bool GrowthSystem::fromJson(const QJsonObject &json)
 {
     if (json.isEmpty()) return false;
     
-    m_currentLevel = json["level"].toInt(1);
-    m_currentExp = json["exp"].toInt(0);
-    m_currentCoins = json["coins"].toInt(0);
     m_totalExpGained = json["totalExpGained"].toInt(0);
     m_totalCoinsGained = json["totalCoinsGained"].toInt(0);
     m_firstLoginDate = QDateTime::fromString(json["firstLoginDate"].toString(), Qt::ISODate);
     m_lastLoginDate = QDateTime::fromString(json["lastLoginDate"].toString(), Qt::ISODate);
     
-    // 加载属性
-    QJsonObject attrsJson = json["attributes"].toObject();
-    for (auto it = attrsJson.constBegin(); it != attrsJson.constEnd(); ++it) {
-        Attribute attr = stringToAttribute(it.key());
-        if (attr != Attribute::AttributeCount) {
-            m_attributes[attr] = it.value().toInt();
-        }
-    }
-    
-    // 加载解锁的功能
-    m_unlockedFeatures.clear();
-    QJsonArray featuresArray = json["unlockedFeatures"].toArray();
+    // 加载解锁的功能；已不在功能表中的旧键名忽略
+    m_unlockedFeatures.reset();
+    const QJsonArray featuresArray = json["unlockedFeatures"].toArray();
     for (const QJsonValue &value : featuresArray) {
-        m_unlockedFeatures.append(value.toString());
+        if (const std::optional<Feature> feature = featureFromKey(value.toString())) {
+            m_unlockedFeatures.set(static_cast<std::size_t>(*feature));
+        }
     }
+    // 游标与替换前的位图无关：从头按当前等级补齐，恢复的记录缺少的低等级功能也静默置位
+    m_featureLevelCursor = 0;
+    unlockFeaturesThroughLevel(false);
     
     return true;
 }
 
-// 任务系统调用接口
-void GrowthSystem::onTaskCompleted(const QJsonObject &taskData)
+// 进度变更通知：before/after 来自 UserManager，本类不保存等级、经验、金币或属性的副本
+void GrowthSystem::applyProgressionChange(const data::ProgressionChange &change)
 {
-    QString taskType = taskData["type"].toString();
-    int difficulty = taskData["difficulty"].toInt();
-    int coinReward = taskData["coinReward"].toInt();
-    int growthReward = taskData["growthReward"].toInt();
-    
-    // 基础经验奖励
-    int baseExp = growthReward > 0 ? growthReward : difficulty * 25;
-    
-    // 金币奖励
-    if (coinReward > 0) {
-        addCoins(coinReward);
+    if (change.has(data::ProgressionChange::Growth)) {
+        const int gained = change.after.growthPoints - change.before.growthPoints;
+        if (gained > 0) {
+            m_totalExpGained += gained;
+        }
+        emit experienceChanged(change.after.growthPoints, getExpToNextLevel());
     }
-    
-    // 根据任务类型给予属性奖励
-    if (taskType == "Daily") {
-        addAttribute(Attribute::Execution, 1);
-        addAttribute(Attribute::Perseverance, 1);
-    } else if (taskType == "Weekly") {
-        addAttribute(Attribute::Execution, 2);
-        addAttribute(Attribute::Decision, 1);
-    } else if (taskType == "Semester") {
-        addAttribute(Attribute::Execution, 3);
-        addAttribute(Attribute::Perseverance, 3);
-        addAttribute(Attribute::Decision, 2);
-    } else if (taskType == "Custom") {
-        addAttribute(Attribute::Execution, difficulty);
+    if (change.has(data::ProgressionChange::Level)) {
+        checkLevelUpFeatures();
+        emit levelChanged(change.after.level, change.before.level);
     }
-    
-    // 经验奖励
-    addExperience(baseExp, QString("任务:%1").arg(taskType));
-    
-    // 处理连续完成奖励
-    if (taskData.contains("continuous_days")) {
-        int continuousDays = taskData["continuous_days"].toInt();
-        if (continuousDays >= 7) {
-            addAttribute(Attribute::Perseverance, 2);
+    if (change.has(data::ProgressionChange::Coins)) {
+        const int delta = change.after.coins - change.before.coins;
+        if (delta > 0) {
+            m_totalCoinsGained += delta;
         }
+        emit coinsChanged(change.after.coins, delta);
     }
-}
-
-// 成就系统调用接口
-void GrowthSystem::onAchievementUnlocked(const QJsonObject &achievementData)
-{
-    QString achievementType = achievementData["rewardType"].toString();
-    int rarity = achievementData["rarity"].toInt(1);
-    bool isMilestone = achievementData["isMilestone"].toBool();
-    
-    // 基础经验奖励
-    int expReward = rarity * 50;
-    addExperience(expReward, "成就解锁");
-    
-    // 自豪感奖励
-    addAttribute(Attribute::Pride, rarity * 2);
-    
-    // 根据成就类别给予额外属性
-    QString category = achievementData["category"].toString();
-    if (category == "learning") {
-        addAttribute(Attribute::Knowledge, rarity);
-    } else if (category == "social") {
-        addAttribute(Attribute::Social, rarity);
-    } else if (category == "sports") {
-        addAttribute(Attribute::Perseverance, rarity);
-    } else if (category == "creativity") {
-        addAttribute(Attribute::Decision, rarity);
-    } else if (category == "milestone") {
-        addAttribute(Attribute::Execution, rarity);
-    }
-    
-    // 里程碑成就额外奖励
-    if (isMilestone) {
-        addExperience(expReward * 2, "里程碑成就");
-        addAttribute(Attribute::Pride, 5);
+    if (change.has(data::ProgressionChange::Attributes)) {
+        const AttributeArray before = fromUserAttributeSet(change.before.attributes);
+        const AttributeArray after = fromUserAttributeSet(change.after.attributes);
+        for (std::size_t i = 0; i < kAttributeCount; ++i) {
+            if (before[i] != after[i]) {
+                emit attributeChanged(static_cast<Attribute>(i), after[i]);
+            }
+        }
     }
-    
-    qDebug() << "成就奖励发放 - 类别:" << category << "稀有度:" << rarity;
 }
 
-// 与用户系统同步
-void GrowthSystem::syncWithUser(const data::User &user)
+// 登录时按新用户的等级静默重建解锁列表，只有之后升级新解锁的功能才发出 featureUnlocked
+void GrowthSystem::resetForSession()
 {
-    m_currentLevel = user.level();
-    m_currentExp = user.growthPoints();
-    m_currentCoins = user.coins();
-    
-    // 同步属性
-    const data::User::AttributeSet &userAttrs = user.attributes();
-    m_attributes[Attribute::Execution] = userAttrs.execution;
-    m_attributes[Attribute::Perseverance] = userAttrs.perseverance;
-    m_attributes[Attribute::Decision] = userAttrs.decision;
-    m_attributes[Attribute::Knowledge] = userAttrs.knowledge;
-    m_attributes[Attribute::Social] = userAttrs.social;
-    m_attributes[Attribute::Pride] = userAttrs.pride;
+    m_unlockedFeatures.reset();
+    m_featureLevelCursor = 0;
+    m_lastLoginDate = QDateTime::currentDateTime();
+    unlockFeaturesThroughLevel(false);
 }
 
 data::User::AttributeSet GrowthSystem::toUserAttributeSet() const
 {
-    data::User::AttributeSet attrs;
-    attrs.execution = m_attributes.value(Attribute::Execution, 0);
-    attrs.perseverance = m_attributes.value(Attribute::Perseverance, 0);
-    attrs.decision = m_attributes.value(Attribute::Decision, 0);
-    attrs.knowledge = m_attributes.value(Attribute::Knowledge, 0);
-    attrs.social = m_attributes.value(Attribute::Social, 0);
-    attrs.pride = m_attributes.value(Attribute::Pride, 0);
-    return attrs;
+    return currentState().attributes;
 }
 
 // 工具函数
-GrowthSystem::Attribute GrowthSystem::stringToAttribute(const QString &attrStr) const
-{
-    static const QMap<QString, Attribute> attributeMap = {
-        {"execution", Attribute::Execution},
-        {"perseverance", Attribute::Perseverance},
-        {"decision", Attribute::Decision},
-        {"knowledge", Attribute::Knowledge},
-        {"social", Attribute::Social},
-        {"pride", Attribute::Pride}
-    };
-    
-    QString key = attrStr.toLower();
-    return attributeMap.value(key, Attribute::AttributeCount);
-}
-
 QString GrowthSystem::attributeToString(Attribute attr) const
 {
     static const QMap<Attribute, QString> attributeMap = {
@@ -2,6 +2,12 @@
 #define GROWTHSYSTEM_H
 
 #include "User.h"
+#include "UserManager.h"
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <QObject>
 #include <QMap>
 #include <QJsonObject>
@@ -12,7 +18,10 @@ namespace rove::systems {
 /**
  * @class GrowthSystem
  * @brief 成长系统 - 负责等级、属性、成长值与任务/成就奖励的联动
- * 中文：与现有 User、TaskManager、AchievementManager 完全集成，提供统一的成长体验
+ * 中文：与现有 User、TaskManager、AchievementManager 完全集成，提供统一的成长体验。
+ *       等级、成长值、金币与属性只存于 UserManager 的当前用户，本类读取时直接取该状态，写入经 UserManager
+ *       一次保存；字段变化由 UserManagerSignalProxy::progressionChanged 合并通知，经 applyProgressionChange
+ *       转成本类按字段的信号，一次结算只通知一次。
  */
 class GrowthSystem : public QObject
 {
@@ -30,11 +39,29 @@ public:
         AttributeCount
     };
 
-    explicit GrowthSystem(QObject *parent = nullptr);
+    // 属性按枚举值连续存放，下标与 User::AttributeSet 的字段顺序一致
+    static constexpr std::size_t kAttributeCount = static_cast<std::size_t>(Attribute::AttributeCount);
+    using AttributeArray = std::array<int, kAttributeCount>;
+
+    // 等级特权 - 枚举值即位集下标，解锁等级见 GrowthSystem.cpp 中按等级排序的功能表
+    enum class Feature : std::uint8_t {
+        CustomTaskAdvanced = 0,     // custom_task_advanced
+        CustomAchievementAdvanced,  // custom_achievement_advanced
+        ShopDiscount,               // shop_discount
+        DoubleExpWeekend,           // double_exp_weekend
+        PremiumBackgrounds,         // premium_backgrounds
+        AchievementAnalyze,         // achievement_analyze
+        FeatureCount
+    };
+
+    static constexpr std::size_t kFeatureCount = static_cast<std::size_t>(Feature::FeatureCount);
+    using FeatureSet = std::bitset<kFeatureCount>;
+
+    explicit GrowthSystem(data::UserManager &userManager, QObject *parent = nullptr);
     
     // 核心等级系统
-    int getLevel() const { return m_currentLevel; }
-    int getExperience() const { return m_currentExp; }
+    int getLevel() const { return currentState().level; }
+    int getExperience() const { return currentState().growthPoints; }
     int getExpToNextLevel() const;
     void addExperience(int exp, const QString &source = "");
     
@@ -42,30 +69,53 @@ public:
     int getAttribute(Attribute attr) const;
     void addAttribute(Attribute attr, int value);
     void addAttributes(const QMap<Attribute, int> &attributes);
-    QMap<Attribute, int> getAllAttributes() const;
+    // 整组累加，只保存一次，attributeChanged 由随后的进度通知逐项发出
+    void addAttributes(const AttributeArray &deltas);
+    AttributeArray getAllAttributes() const { return fromUserAttributeSet(currentState().attributes); }
     
     // 货币系统
-    int getCoins() const { return m_currentCoins; }
+    int getCoins() const { return currentState().coins; }
     void addCoins(int coins);
     bool spendCoins(int coins);
     
-    // 等级特权
+    // 等级特权：界面门控用 Feature 重载，一次位测试；字符串重载先把键名换成 Feature，未知键名视为未解锁
+    bool isFeatureUnlocked(Feature feature) const noexcept
+    {
+        const auto index = static_cast<std::size_t>(feature);
+        return index < kFeatureCount && m_unlockedFeatures.test(index);
+    }
     bool isFeatureUnlocked(const QString &feature) const;
     QList<QString> getUnlockedFeatures() const;
+    FeatureSet unlockedFeatureSet() const noexcept { return m_unlockedFeatures; }
+    static QString featureKey(Feature feature);
+    static std::optional<Feature> featureFromKey(const QString &key);
+    static int featureUnlockLevel(Feature feature);
     
     // 数据持久化
     QJsonObject toJson() const;
     bool fromJson(const QJsonObject &json);
     
-    // 供任务系统调用的接口
-    void onTaskCompleted(const QJsonObject &taskData);
-    
-    // 供成就系统调用的接口
-    void onAchievementUnlocked(const QJsonObject &achievementData);
-    
-    // 供用户系统同步的接口
-    void syncWithUser(const data::User &user);
+    // 进度变更通知（由 GrowthSystemBridge 转发）：按字段发出本类信号并检查功能解锁
+    void applyProgressionChange(const data::ProgressionChange &change);
+    // 会话切换后按新用户的等级重新计算已解锁功能
+    void resetForSession();
     data::User::AttributeSet toUserAttributeSet() const;
+    // 与 User::AttributeSet 逐字段互转，只涉及 6 个 int，无堆分配
+    static constexpr AttributeArray fromUserAttributeSet(const data::User::AttributeSet &attrs) noexcept
+    {
+        return {attrs.execution, attrs.perseverance, attrs.decision, attrs.knowledge, attrs.social, attrs.pride};
+    }
+    static constexpr data::User::AttributeSet toUserAttributeSet(const AttributeArray &attrs) noexcept
+    {
+        data::User::AttributeSet set;
+        set.execution = attrs[static_cast<std::size_t>(Attribute::Execution)];
+        set.perseverance = attrs[static_cast<std::size_t>(Attribute::Perseverance)];
+        set.decision = attrs[static_cast<std::size_t>(Attribute::Decision)];
+        set.knowledge = attrs[static_cast<std::size_t>(Attribute::Knowledge)];
+        set.social = attrs[static_cast<std::size_t>(Attribute::Social)];
+        set.pride = attrs[static_cast<std::size_t>(Attribute::Pride)];
+        return set;
+    }
 
 signals:
     void levelChanged(int newLevel, int oldLevel);
@@ -75,32 +125,27 @@ signals:
     void featureUnlocked(const QString &feature);
 
 private:
-    void levelUp();
+    // 当前用户的进度状态；未登录时为默认值（1 级、全零）
+    data::ProgressionState currentState() const;
+    // 一次性发放成长值、金币与属性奖励，经 UserManager 保存
+    void grant(int exp, int coins, const AttributeArray &deltas, const QString &source);
+    // 把功能表中解锁等级不高于当前等级、尚未处理的一段连续区间置位；notify 为 false 时不发信号（登录重建）
+    void unlockFeaturesThroughLevel(bool notify);
     void checkLevelUpFeatures();
-    void applyAchievementReward(const QJsonObject &achievementData);
-    Attribute stringToAttribute(const QString &attrStr) const;
     QString attributeToString(Attribute attr) const;
     
-    // 核心数据
-    int m_currentLevel;
-    int m_currentExp;
-    int m_currentCoins;
-    
-    // 属性系统
-    QMap<Attribute, int> m_attributes;
+    // 进度状态的唯一来源
+    data::UserManager &m_userManager;
     
-    // 特权系统
-    QMap<QString, int> m_featureUnlockLevels;
-    QList<QString> m_unlockedFeatures;
+    // 特权系统：已解锁功能的位集，以及功能表中已按等级处理到的位置（其前的条目都已置位）
+    FeatureSet m_unlockedFeatures;
+    std::size_t m_featureLevelCursor = 0;
     
     // 统计信息
     int m_totalExpGained;
     int m_totalCoinsGained;
     QDateTime m_firstLoginDate;
     QDateTime m_lastLoginDate;
-    
-    // 经验需求配置
-    static const QMap<int, int> EXP_REQUIREMENTS;
 };
 
 } // namespace rove::systems
@@ -13,7 +13,8 @@ namespace rove::systems {
 /**
  * @class GrowthSystemBridge
  * @brief 成长系统桥接器 - 连接成长系统与现有系统
- * 中文：负责将任务系统、成就系统的信号转发给成长系统
+ * 中文：任务与成就奖励由 TaskManager/AchievementManager 经 UserManager 发放，进度状态只存一份；
+ *       桥接器只把 UserManager 的合并进度通知与会话切换转发给成长系统，不再重复结算或同步副本。
  */
 class GrowthSystemBridge : public QObject
 {
@@ -29,12 +30,8 @@ public:
     void initialize();
 
 private slots:
-    void onUserLoggedIn();
-    void onTaskCompleted(int taskId, int taskType, int difficulty);
-    void onAchievementUnlocked(int achievementId);
-    void onUserLevelChanged(int newLevel);
-    void onUserPrideChanged(int newPride);
-    void onUserCoinsChanged(int newCoins);
+    void onSessionChanged(int userId);
+    void onProgressionChanged(const data::ProgressionChange &change);
 
 private:
     GrowthSystem *m_growthSystem;
@@ -3,9 +3,19 @@
 #include <QtCharts/QCategoryAxis>
 #include <QtCharts/QSplineSeries>
 
-#include <sstream>
-#include <limits>
+#include <QBuffer>
+#include <QDate>
+
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#include "DatabaseManager.h"
+#include "Metrics.h"
 
 namespace QtCharts {}
 using namespace QtCharts;
@@ -17,7 +27,22 @@ GrowthVisualizer& GrowthVisualizer::instance() {
     return instance;
 }
 
+GrowthVisualizer::CalendarHeatmap GrowthVisualizer::buildCalendarHeatmap(const data::DatabaseManager& database,
+                                                                          int ownerId,
+                                                                          int year) const {
+    ROVE_SCOPED_TIMER(Charts, "buildCalendarHeatmap");
+    CalendarHeatmap heatmap{};
+    const qint64 firstDay = QDate(year, 1, 1).toJulianDay();
+    const qint64 lastDay = QDate(year, 12, 31).toJulianDay();
+    for (const auto& record : database.queryDailyActivity(ownerId, firstDay, lastDay)) {
+        heatmap[static_cast<std::size_t>(record.julianDay - firstDay)] =
+            HeatmapDay{record.completions, record.growth, record.logs};
+    }
+    return heatmap;
+}
+
 std::unique_ptr<QChart> GrowthVisualizer::buildRadarChart(const data::GrowthSnapshot& snapshot) const {
+    ROVE_SCOPED_TIMER(Charts, "buildRadarChart");
     auto chart = std::make_unique<QPolarChart>();
     chart->setTitle(QStringLiteral("六维属性雷达图（宽恕后展示）"));
 
@@ -66,13 +91,14 @@ std::unique_ptr<QChart> GrowthVisualizer::buildRadarChart(const data::GrowthSnap
 std::unique_ptr<QChart> GrowthVisualizer::buildGrowthLineChart(
     const std::vector<data::GrowthSnapshot>& snapshots,
     const std::vector<data::LogEntry>& milestones,
-    const std::set<int>& forgivenIds) const {
+    const data::SortedIdSet& forgivenIds) const {
+    ROVE_SCOPED_TIMER(Charts, "buildGrowthLineChart");
     auto chart = std::make_unique<QChart>();
     chart->setTitle(QStringLiteral("等级与成长值曲线"));
 
-    auto levelSeries = buildLevelSeries(snapshots);
-    auto growthSeries = buildGrowthSeries(snapshots);
-    auto milestoneSeries = buildMilestoneSeries(milestones, snapshots, forgivenIds);
+    auto levelSeries = buildLevelSeries({});
+    auto growthSeries = buildGrowthSeries({});
+    auto milestoneSeries = buildMilestoneSeries({}, {}, {});
 
     chart->addSeries(levelSeries);
     chart->addSeries(growthSeries);
@@ -93,68 +119,399 @@ std::unique_ptr<QChart> GrowthVisualizer::buildGrowthLineChart(
     chart->setAxisY(axisY, growthSeries);
     chart->setAxisY(axisY, milestoneSeries);
 
+    refreshGrowthLineChart(*chart, snapshots, milestones, forgivenIds);
     return chart;
 }
 
+void GrowthVisualizer::refreshGrowthLineChart(QChart& chart,
+                                              const std::vector<data::GrowthSnapshot>& snapshots,
+                                              const std::vector<data::LogEntry>& milestones,
+                                              const data::SortedIdSet& forgivenIds) const {
+    ROVE_SCOPED_TIMER(Charts, "refreshGrowthLineChart");
+    const auto seriesList = chart.series();
+    if (seriesList.size() < 3) {
+        return;  // 中文：不是 buildGrowthLineChart 创建的图表。
+    }
+    auto* levelSeries = qobject_cast<QLineSeries*>(seriesList.at(0));
+    auto* growthSeries = qobject_cast<QLineSeries*>(seriesList.at(1));
+    auto* milestoneSeries = qobject_cast<QScatterSeries*>(seriesList.at(2));
+    if (levelSeries == nullptr || growthSeries == nullptr || milestoneSeries == nullptr) {
+        return;
+    }
+    const QList<QPointF> levels = downsampleLttb(levelPoints(snapshots), kDefaultMaxChartPoints);
+    const QList<QPointF> growth = downsampleLttb(growthPoints(snapshots), kDefaultMaxChartPoints);
+    const bool useOpenGl = growth.size() > kOpenGlPointThreshold;
+    levelSeries->setUseOpenGL(useOpenGl);
+    growthSeries->setUseOpenGL(useOpenGl);
+    levelSeries->replace(levels);
+    growthSeries->replace(growth);
+    milestoneSeries->replace(milestonePoints(milestones, snapshots, forgivenIds));
+
+    // 中文：replace 不会重新计算坐标范围，按新数据手动设置。
+    qreal maxY = 1.0;
+    for (const auto* points : {&levels, &growth}) {
+        for (const auto& point : *points) {
+            maxY = std::max(maxY, point.y());
+        }
+    }
+    const auto horizontal = chart.axes(Qt::Horizontal);
+    if (!horizontal.isEmpty()) {
+        horizontal.front()->setRange(0, std::max(static_cast<int>(snapshots.size()) - 1, 1));
+    }
+    const auto vertical = chart.axes(Qt::Vertical);
+    if (!vertical.isEmpty()) {
+        vertical.front()->setRange(0, maxY);
+    }
+}
+
+namespace {
+constexpr std::size_t kExportChunkSize = 64 * 1024;
+constexpr std::size_t kExportProgressInterval = 1024;
+
+/**
+ * @brief 导出列：CSV 表头名与取值函数，CSV 与列式导出共用同一顺序。
+ */
+struct ExportColumn {
+    const char* name;
+    int (*value)(const data::GrowthSnapshot&);
+};
+
+constexpr ExportColumn kExportColumns[] = {
+    {"level", [](const data::GrowthSnapshot& s) { return s.level(); }},
+    {"growth", [](const data::GrowthSnapshot& s) { return s.growthPoints(); }},
+    {"execution", [](const data::GrowthSnapshot& s) { return s.attributes().execution; }},
+    {"perseverance", [](const data::GrowthSnapshot& s) { return s.attributes().perseverance; }},
+    {"decision", [](const data::GrowthSnapshot& s) { return s.attributes().decision; }},
+    {"knowledge", [](const data::GrowthSnapshot& s) { return s.attributes().knowledge; }},
+    {"social", [](const data::GrowthSnapshot& s) { return s.attributes().social; }},
+    {"pride", [](const data::GrowthSnapshot& s) { return s.attributes().pride; }},
+    {"achievements", [](const data::GrowthSnapshot& s) { return s.achievementCount(); }},
+    {"completed", [](const data::GrowthSnapshot& s) { return s.completedTasks(); }},
+    {"failed", [](const data::GrowthSnapshot& s) { return s.failedTasks(); }},
+    {"manual_logs", [](const data::GrowthSnapshot& s) { return s.manualLogCount(); }},
+};
+
+/**
+ * @brief 固定大小的写缓冲：写满即刷入设备，任何一次写失败后其余写入均被忽略。
+ */
+class ChunkWriter {
+public:
+    explicit ChunkWriter(QIODevice& device) : m_device(device), m_buffer(), m_used(0), m_ok(true) {}
+
+    void put(char c) {
+        if (m_used == m_buffer.size()) {
+            flush();
+        }
+        m_buffer[m_used++] = c;
+    }
+
+    void put(const char* data, std::size_t size) {
+        while (size > 0) {
+            if (m_used == m_buffer.size()) {
+                flush();
+            }
+            const std::size_t n = std::min(size, m_buffer.size() - m_used);
+            std::memcpy(m_buffer.data() + m_used, data, n);
+            m_used += n;
+            data += n;
+            size -= n;
+        }
+    }
+
+    void putDecimal(long long value) {
+        char digits[24];
+        int length = 0;
+        const bool negative = value < 0;
+        // 中文：以无符号运算取绝对值，LLONG_MIN 也不会溢出。
+        unsigned long long magnitude =
+            negative ? 0ULL - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+        do {
+            digits[length++] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (negative) {
+            put('-');
+        }
+        while (length > 0) {
+            put(digits[--length]);
+        }
+    }
+
+    void putPadded(int value, int width) {
+        char digits[8];
+        for (int i = width - 1; i >= 0; --i) {
+            digits[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        put(digits, static_cast<std::size_t>(width));
+    }
+
+    template <typename T>
+    void putLittleEndian(T value) {
+        auto bits = static_cast<std::make_unsigned_t<T>>(value);
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            put(static_cast<char>(bits & 0xFFU));
+            bits = static_cast<decltype(bits)>(bits >> 8U);
+        }
+    }
+
+    bool flush() {
+        if (m_ok && m_used > 0) {
+            m_ok = m_device.write(m_buffer.data(), static_cast<qint64>(m_used)) == static_cast<qint64>(m_used);
+        }
+        m_used = 0;
+        return m_ok;
+    }
+
+    [[nodiscard]] bool ok() const noexcept { return m_ok; }
+
+private:
+    QIODevice& m_device;
+    std::array<char, kExportChunkSize> m_buffer;
+    std::size_t m_used;
+    bool m_ok;
+};
+
+/**
+ * @brief 手工输出带 UTC 偏移的 ISO 8601 时间戳，不分配字符串。
+ */
+void putIsoTimestamp(ChunkWriter& writer, const QDateTime& timestamp) {
+    if (!timestamp.isValid()) {
+        return;
+    }
+    const QDate date = timestamp.date();
+    const QTime time = timestamp.time();
+    writer.putPadded(date.year(), 4);
+    writer.put('-');
+    writer.putPadded(date.month(), 2);
+    writer.put('-');
+    writer.putPadded(date.day(), 2);
+    writer.put('T');
+    writer.putPadded(time.hour(), 2);
+    writer.put(':');
+    writer.putPadded(time.minute(), 2);
+    writer.put(':');
+    writer.putPadded(time.second(), 2);
+    // 中文：UTC 写 Z，其余时间规格（本地时间、固定偏移、时区）一律写出当时的 UTC 偏移，导出结果不依赖读取方的时区。
+    if (timestamp.timeSpec() == Qt::UTC) {
+        writer.put('Z');
+        return;
+    }
+    const int offset = timestamp.offsetFromUtc();
+    const int minutes = (offset < 0 ? -offset : offset) / 60;
+    writer.put(offset < 0 ? '-' : '+');
+    writer.putPadded(minutes / 60, 2);
+    writer.put(':');
+    writer.putPadded(minutes % 60, 2);
+}
+}  // namespace
+
 QString GrowthVisualizer::exportCsv(const std::vector<data::GrowthSnapshot>& snapshots) const {
-    std::ostringstream oss;
-    oss << "timestamp,level,growth,execution,perseverance,decision,knowledge,social,pride,achievements,completed,failed,manual_logs\n";
+    QByteArray bytes;
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::WriteOnly);
+    exportCsv(buffer, snapshots);
+    return QString::fromUtf8(bytes);
+}
+
+bool GrowthVisualizer::exportCsv(QIODevice& device,
+                                 const std::vector<data::GrowthSnapshot>& snapshots,
+                                 const ExportProgress& progress) const {
+    ChunkWriter writer(device);
+    writer.put("timestamp", 9);
+    for (const auto& column : kExportColumns) {
+        writer.put(',');
+        writer.put(column.name, std::strlen(column.name));
+    }
+    writer.put('\n');
+    const std::size_t total = snapshots.size();
+    for (std::size_t row = 0; row < total; ++row) {
+        const auto& snapshot = snapshots[row];
+        putIsoTimestamp(writer, snapshot.timestamp());
+        for (const auto& column : kExportColumns) {
+            writer.put(',');
+            writer.putDecimal(column.value(snapshot));
+        }
+        writer.put('\n');
+        if (progress && (row + 1) % kExportProgressInterval == 0) {
+            if (!writer.ok() || !progress(row + 1, total)) {
+                return false;
+            }
+        }
+    }
+    if (!writer.flush()) {
+        return false;
+    }
+    return !progress || progress(total, total);
+}
+
+/**
+ * 中文说明：列式导出
+ * - 先写表头与列描述，再逐列连续写出全部行；时间戳以 i64 毫秒（无效时为 0）存储，其余列为 i32；
+ * - 每列单独遍历一次快照，缓冲仍为固定大小，总工作量为“行数 × 列数”，进度按该工作量每批回调一次。
+ */
+bool GrowthVisualizer::exportColumnar(QIODevice& device,
+                                      const std::vector<data::GrowthSnapshot>& snapshots,
+                                      const ExportProgress& progress) const {
+    constexpr std::size_t kColumnCount = std::size(kExportColumns) + 1;
+    ChunkWriter writer(device);
+    writer.put(kColumnarMagic, sizeof(kColumnarMagic));
+    writer.put(static_cast<char>(kColumnarVersion));
+    writer.putLittleEndian(static_cast<std::uint32_t>(snapshots.size()));
+    writer.putLittleEndian(static_cast<std::uint16_t>(kColumnCount));
+    writer.put('\0');
+    writer.putLittleEndian(static_cast<std::uint16_t>(9));
+    writer.put("timestamp", 9);
+    for (const auto& column : kExportColumns) {
+        const auto length = std::strlen(column.name);
+        writer.put('\1');
+        writer.putLittleEndian(static_cast<std::uint16_t>(length));
+        writer.put(column.name, length);
+    }
+
+    // 中文：与 CSV 一样每写满一批行回调一次进度，单列很长时也能及时取消。
+    const std::size_t total = snapshots.size() * kColumnCount;
+    std::size_t done = 0;
+    auto advance = [&]() {
+        ++done;
+        return done % kExportProgressInterval != 0 || (writer.ok() && (!progress || progress(done, total)));
+    };
     for (const auto& snapshot : snapshots) {
-        oss << snapshot.timestamp().toString(Qt::ISODate).toStdString() << ',' << snapshot.level() << ','
-            << snapshot.growthPoints() << ',' << snapshot.attributes().execution << ','
-            << snapshot.attributes().perseverance << ',' << snapshot.attributes().decision << ','
-            << snapshot.attributes().knowledge << ',' << snapshot.attributes().social << ','
-            << snapshot.attributes().pride << ',' << snapshot.achievementCount() << ','
-            << snapshot.completedTasks() << ',' << snapshot.failedTasks() << ',' << snapshot.manualLogCount() << "\n";
+        const QDateTime& timestamp = snapshot.timestamp();
+        writer.putLittleEndian(static_cast<std::int64_t>(timestamp.isValid() ? timestamp.toMSecsSinceEpoch() : 0));
+        if (!advance()) {
+            return false;
+        }
+    }
+    for (const auto& column : kExportColumns) {
+        for (const auto& snapshot : snapshots) {
+            writer.putLittleEndian(static_cast<std::int32_t>(column.value(snapshot)));
+            if (!advance()) {
+                return false;
+            }
+        }
+    }
+    if (!writer.flush()) {
+        return false;
+    }
+    return !progress || progress(total, total);
+}
+
+QList<QPointF> GrowthVisualizer::downsampleLttb(const QList<QPointF>& points, int threshold) {
+    const int count = static_cast<int>(points.size());
+    if (threshold < 3 || threshold >= count) {
+        return points;
+    }
+    QList<QPointF> sampled;
+    sampled.reserve(threshold);
+    sampled.append(points.front());
+    // 中文：首尾点固定，其余 count - 2 个点均分到 threshold - 2 个桶。
+    const double bucketSize = static_cast<double>(count - 2) / static_cast<double>(threshold - 2);
+    int anchor = 0;
+    for (int bucket = 0; bucket < threshold - 2; ++bucket) {
+        const int rangeStart = static_cast<int>(std::floor(bucket * bucketSize)) + 1;
+        const int rangeEnd = static_cast<int>(std::floor((bucket + 1) * bucketSize)) + 1;
+        const int nextStart = rangeEnd;
+        const int nextEnd = std::min(static_cast<int>(std::floor((bucket + 2) * bucketSize)) + 1, count);
+        double avgX = 0.0;
+        double avgY = 0.0;
+        for (int i = nextStart; i < nextEnd; ++i) {
+            avgX += points[i].x();
+            avgY += points[i].y();
+        }
+        const int nextCount = std::max(nextEnd - nextStart, 1);
+        avgX /= nextCount;
+        avgY /= nextCount;
+
+        const QPointF& a = points[anchor];
+        double maxArea = -1.0;
+        int selected = rangeStart;
+        for (int i = rangeStart; i < rangeEnd; ++i) {
+            const double area = std::abs((a.x() - avgX) * (points[i].y() - a.y()) -
+                                         (a.x() - points[i].x()) * (avgY - a.y()));
+            if (area > maxArea) {
+                maxArea = area;
+                selected = i;
+            }
+        }
+        sampled.append(points[selected]);
+        anchor = selected;
     }
-    return QString::fromStdString(oss.str());
+    sampled.append(points.back());
+    return sampled;
 }
 
 QLineSeries* GrowthVisualizer::buildLevelSeries(const std::vector<data::GrowthSnapshot>& snapshots) const {
     auto series = new QLineSeries();
     series->setName(QStringLiteral("等级"));
-    for (int i = 0; i < static_cast<int>(snapshots.size()); ++i) {
-        series->append(i, snapshots[i].level());
-    }
+    series->replace(downsampleLttb(levelPoints(snapshots), kDefaultMaxChartPoints));
     return series;
 }
 
 QLineSeries* GrowthVisualizer::buildGrowthSeries(const std::vector<data::GrowthSnapshot>& snapshots) const {
     auto series = new QLineSeries();
     series->setName(QStringLiteral("成长值"));
-    for (int i = 0; i < static_cast<int>(snapshots.size()); ++i) {
-        series->append(i, snapshots[i].growthPoints());
-    }
+    series->replace(downsampleLttb(growthPoints(snapshots), kDefaultMaxChartPoints));
     return series;
 }
 
 QScatterSeries* GrowthVisualizer::buildMilestoneSeries(const std::vector<data::LogEntry>& milestones,
                                                                  const std::vector<data::GrowthSnapshot>& snapshots,
-                                                                 const std::set<int>& forgivenIds) const {
+                                                                 const data::SortedIdSet& forgivenIds) const {
     auto series = new QScatterSeries();
     series->setName(QStringLiteral("里程碑"));
     series->setMarkerSize(10.0);
+    series->replace(milestonePoints(milestones, snapshots, forgivenIds));
+    return series;
+}
+
+QList<QPointF> GrowthVisualizer::levelPoints(const std::vector<data::GrowthSnapshot>& snapshots) {
+    QList<QPointF> points;
+    points.reserve(static_cast<int>(snapshots.size()));
+    for (int i = 0; i < static_cast<int>(snapshots.size()); ++i) {
+        points.append(QPointF(i, snapshots[i].level()));
+    }
+    return points;
+}
 
+QList<QPointF> GrowthVisualizer::growthPoints(const std::vector<data::GrowthSnapshot>& snapshots) {
+    QList<QPointF> points;
+    points.reserve(static_cast<int>(snapshots.size()));
+    for (int i = 0; i < static_cast<int>(snapshots.size()); ++i) {
+        points.append(QPointF(i, snapshots[i].growthPoints()));
+    }
+    return points;
+}
+
+QList<QPointF> GrowthVisualizer::milestonePoints(const std::vector<data::LogEntry>& milestones,
+                                                 const std::vector<data::GrowthSnapshot>& snapshots,
+                                                 const data::SortedIdSet& forgivenIds) {
+    // 中文：快照已按时间升序，预先展开为毫秒时间戳数组后，每个里程碑用 lower_bound 二分定位最近快照，
+    //       整体 O(m log n)；距离相同时取较早的快照，与逐条比较的结果一致。
+    std::vector<qint64> epochs;
+    epochs.reserve(snapshots.size());
+    for (const auto& snapshot : snapshots) {
+        epochs.push_back(snapshot.timestamp().toMSecsSinceEpoch());
+    }
+    QList<QPointF> points;
+    points.reserve(static_cast<int>(milestones.size()));
     for (const auto& log : milestones) {
-        if (forgivenIds.count(log.id()) > 0) {
+        if (forgivenIds.contains(log.id())) {
             continue;  // 宽恕券隐藏负面记录
         }
-        int closestIndex = 0;
-        qint64 minDiff = std::numeric_limits<qint64>::max();
-        for (int i = 0; i < static_cast<int>(snapshots.size()); ++i) {
-            qint64 diff = std::abs(log.timestamp().msecsTo(snapshots[i].timestamp()));
-            if (diff < minDiff) {
-                minDiff = diff;
-                closestIndex = i;
-            }
+        if (epochs.empty()) {
+            points.append(QPointF(0, 0));
+            continue;
         }
-        if (!snapshots.empty()) {
-            series->append(closestIndex, snapshots[closestIndex].growthPoints());
-        } else {
-            series->append(closestIndex, 0);
+        const qint64 target = log.timestamp().toMSecsSinceEpoch();
+        auto it = std::lower_bound(epochs.begin(), epochs.end(), target);
+        if (it == epochs.end() || (it != epochs.begin() && target - *std::prev(it) <= *it - target)) {
+            it = std::lower_bound(epochs.begin(), it, *std::prev(it));  // 中文：同一时间戳取最早一条。
         }
+        const auto closestIndex = static_cast<std::size_t>(std::distance(epochs.begin(), it));
+        points.append(QPointF(static_cast<qreal>(closestIndex), snapshots[closestIndex].growthPoints()));
     }
-    return series;
+    return points;
 }
 
 }  // namespace rove
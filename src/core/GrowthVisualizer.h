@@ -7,12 +7,19 @@
 #include <QtCharts/QScatterSeries>
 #include <QtCharts/QValueAxis>
 
+#include <QIODevice>
+#include <QList>
+#include <QPointF>
+
+#include <array>
+#include <cstddef>
+#include <functional>
 #include <memory>
-#include <set>
 #include <vector>
 
 #include "GrowthSnapshot.h"
 #include "LogEntry.h"
+#include "SortedIdSet.h"
 
 // 使用 Qt Charts 命名空间
 namespace QtCharts {}
@@ -20,14 +27,62 @@ using namespace QtCharts;
 
 namespace rove {
 
+namespace data {
+class DatabaseManager;
+}
+
 /**
  * @class GrowthVisualizer
  * @brief 成长可视化组件单例，负责绘制雷达图、折线图并提供数据导出与宽恕券美化。
  */
 class GrowthVisualizer {
 public:
+    /**
+     * @brief 未给出图表像素宽度时折线的默认最大点数。
+     */
+    static constexpr int kDefaultMaxChartPoints = 800;
+
+    /**
+     * @brief 降采样后仍超过该点数时折线改用 OpenGL 绘制。
+     * 中文：判断的是降采样后的点数，阈值须低于降采样上限，否则 OpenGL 分支永远不会生效。
+     */
+    static constexpr int kOpenGlPointThreshold = 500;
+    static_assert(kOpenGlPointThreshold < kDefaultMaxChartPoints, "OpenGL 阈值须低于默认降采样上限");
+
     static GrowthVisualizer& instance();
 
+    /**
+     * @brief 日历热力图中一天的活动量。
+     */
+    struct HeatmapDay {
+        int completions = 0;  //!< 完成的任务数
+        int growth = 0;       //!< 获得的成长值
+        int logs = 0;         //!< 写下的手动日志数
+    };
+
+    /**
+     * @brief 一年的逐日活动，下标为 dayOfYear() - 1；平年最后一格恒为零。
+     */
+    using CalendarHeatmap = std::array<HeatmapDay, 366>;
+
+    /**
+     * @brief 读取指定用户某一年的日历热力图数据。
+     * 中文：数据来自增量维护的 daily_activity 聚合表，一次 (owner_id, day) 主键区间读取，
+     *       不扫描日志与快照；没有活动的日期保持为零，返回稠密数组便于直接按格绘制。
+     */
+    [[nodiscard]] CalendarHeatmap buildCalendarHeatmap(const data::DatabaseManager& database,
+                                                       int ownerId,
+                                                       int year) const;
+
+    /**
+     * @brief Largest-Triangle-Three-Buckets 降采样：保留首尾点，中间按等宽桶各取一点，
+     *        选取与上一选中点及下一桶均值构成三角形面积最大的点，保留峰谷形状。
+     * @param points 按 x 升序的原始点。
+     * @param threshold 目标点数（通常取图表像素宽度）；小于 3 或不少于原始点数时原样返回。
+     * @return 降采样后的点，x 坐标取自原始点。
+     */
+    [[nodiscard]] static QList<QPointF> downsampleLttb(const QList<QPointF>& points, int threshold);
+
     /**
      * @brief 绘制六维属性雷达图，采用 QPolarChart 美化展示。
      */
@@ -39,13 +94,51 @@ public:
     [[nodiscard]] std::unique_ptr<QChart> buildGrowthLineChart(
         const std::vector<data::GrowthSnapshot>& snapshots,
         const std::vector<data::LogEntry>& milestones,
-        const std::set<int>& forgivenIds) const;
+        const data::SortedIdSet& forgivenIds) const;
+
+    /**
+     * @brief 原地刷新 buildGrowthLineChart 创建的图表：只替换序列数据并调整坐标范围，不分配新图表对象。
+     */
+    void refreshGrowthLineChart(QChart& chart,
+                                const std::vector<data::GrowthSnapshot>& snapshots,
+                                const std::vector<data::LogEntry>& milestones,
+                                const data::SortedIdSet& forgivenIds) const;
+
+    /**
+     * @brief 导出进度回调：参数为已处理与总工作量（CSV 按行，列式按行 × 列），返回 false 取消导出。
+     *        UI 可在回调内更新进度条并调用 QCoreApplication::processEvents 保持响应。
+     */
+    using ExportProgress = std::function<bool(std::size_t done, std::size_t total)>;
+
+    /**
+     * @brief 列式二进制导出的格式标记与版本。
+     *        布局（小端序）："RVGS" | u8 版本 | u32 行数 | u16 列数 |
+     *        每列 { u8 类型（0 = i64 毫秒时间戳，1 = i32）, u16 名称长度, 名称 } | 各列数据依次连续存放。
+     */
+    static constexpr char kColumnarMagic[4] = {'R', 'V', 'G', 'S'};
+    static constexpr unsigned char kColumnarVersion = 1;
 
     /**
      * @brief 导出可视化使用的数据为 CSV 字符串，便于教师留档。
      */
     [[nodiscard]] QString exportCsv(const std::vector<data::GrowthSnapshot>& snapshots) const;
 
+    /**
+     * @brief 以固定大小分块把 CSV 流式写入设备，整数与时间戳均手工格式化，内存占用与数据量无关。
+     * @return 成功返回 true；设备写入失败或回调取消时返回 false。
+     */
+    bool exportCsv(QIODevice& device,
+                   const std::vector<data::GrowthSnapshot>& snapshots,
+                   const ExportProgress& progress = {}) const;
+
+    /**
+     * @brief 以列式二进制格式分块写入设备，便于离线分析工具按列直接映射读取。
+     * @return 成功返回 true；设备写入失败或回调取消时返回 false。
+     */
+    bool exportColumnar(QIODevice& device,
+                        const std::vector<data::GrowthSnapshot>& snapshots,
+                        const ExportProgress& progress = {}) const;
+
 private:
     GrowthVisualizer() = default;
     /**
@@ -71,7 +164,20 @@ private:
      */
     QScatterSeries* buildMilestoneSeries(const std::vector<data::LogEntry>& milestones,
                                                    const std::vector<data::GrowthSnapshot>& snapshots,
-                                                   const std::set<int>& forgivenIds) const;
+                                                   const data::SortedIdSet& forgivenIds) const;
+
+    /**
+     * @brief 以快照序号为 x 生成等级/成长值点列。
+     */
+    static QList<QPointF> levelPoints(const std::vector<data::GrowthSnapshot>& snapshots);
+    static QList<QPointF> growthPoints(const std::vector<data::GrowthSnapshot>& snapshots);
+
+    /**
+     * @brief 将未被宽恕的里程碑对齐到最近的快照序号。
+     */
+    static QList<QPointF> milestonePoints(const std::vector<data::LogEntry>& milestones,
+                                          const std::vector<data::GrowthSnapshot>& snapshots,
+                                          const data::SortedIdSet& forgivenIds);
 };
 
 }  // namespace rove::data
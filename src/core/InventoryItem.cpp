@@ -2,12 +2,23 @@
 
 #include <QString>
 
+#include "EnumText.h"
+
 namespace rove::data {
 
+namespace {
+constexpr EnumTextTable<InventoryItem::UsageStatus, 4> kUsageStatusText{{{
+    {InventoryItem::UsageStatus::Unused, "Unused"},
+    {InventoryItem::UsageStatus::Active, "Active"},
+    {InventoryItem::UsageStatus::Consumed, "Consumed"},
+    {InventoryItem::UsageStatus::Expired, "Expired"},
+}}};
+}  // namespace
+
 InventoryItem::InventoryItem()
     : m_inventoryId(-1),
       m_itemId(-1),
-      m_owner(),
+      m_ownerId(0),
       m_purchaseTime(QDateTime::currentDateTimeUtc()),
       m_quantity(0),
       m_usedQuantity(0),
@@ -25,9 +36,9 @@ int InventoryItem::itemId() const noexcept { return m_itemId; }
 
 void InventoryItem::setItemId(int itemId) noexcept { m_itemId = itemId; }
 
-const std::string& InventoryItem::owner() const noexcept { return m_owner; }
+int InventoryItem::ownerId() const noexcept { return m_ownerId; }
 
-void InventoryItem::setOwner(std::string owner) { m_owner = std::move(owner); }
+void InventoryItem::setOwnerId(int ownerId) noexcept { m_ownerId = ownerId; }
 
 const QDateTime& InventoryItem::purchaseTime() const noexcept { return m_purchaseTime; }
 
@@ -71,11 +82,11 @@ InventoryItem InventoryItem::fromRecord(const DatabaseManager::InventoryRecord&
     InventoryItem item;
     item.m_inventoryId = record.id;
     item.m_itemId = record.itemId;
-    item.m_owner = record.owner;
-    item.m_purchaseTime = QDateTime::fromString(QString::fromStdString(record.purchaseTimeIso), Qt::ISODate);
-    if (!record.expirationTimeIso.empty()) {
-        item.m_expirationTime = QDateTime::fromString(QString::fromStdString(record.expirationTimeIso), Qt::ISODate);
-        item.m_hasExpiration = item.m_expirationTime.isValid();
+    item.m_ownerId = record.ownerId;
+    item.m_purchaseTime = QDateTime::fromMSecsSinceEpoch(record.purchaseTimeMs).toUTC();
+    if (record.expirationTimeMs.has_value()) {
+        item.m_expirationTime = QDateTime::fromMSecsSinceEpoch(*record.expirationTimeMs).toUTC();
+        item.m_hasExpiration = true;
     } else {
         item.m_expirationTime = QDateTime();
         item.m_hasExpiration = false;
@@ -92,7 +103,7 @@ DatabaseManager::InventoryRecord InventoryItem::toRecord() const {
     DatabaseManager::InventoryRecord record;
     record.id = m_inventoryId;
     record.itemId = m_itemId;
-    record.owner = m_owner;
+    record.ownerId = m_ownerId;
     record.quantity = m_quantity;
     record.usedQuantity = m_usedQuantity;
     record.status = statusToString(m_status);
@@ -105,30 +116,11 @@ DatabaseManager::InventoryRecord InventoryItem::toRecord() const {
 }
 
 std::string InventoryItem::statusToString(UsageStatus status) {
-    switch (status) {
-        case UsageStatus::Active:
-            return "Active";
-        case UsageStatus::Consumed:
-            return "Consumed";
-        case UsageStatus::Expired:
-            return "Expired";
-        case UsageStatus::Unused:
-        default:
-            return "Unused";
-    }
+    return std::string(kUsageStatusText.text(status).value_or("Unused"));
 }
 
-InventoryItem::UsageStatus InventoryItem::statusFromString(const std::string& text) {
-    if (text == "Active") {
-        return UsageStatus::Active;
-    }
-    if (text == "Consumed") {
-        return UsageStatus::Consumed;
-    }
-    if (text == "Expired") {
-        return UsageStatus::Expired;
-    }
-    return UsageStatus::Unused;
+InventoryItem::UsageStatus InventoryItem::statusFromString(std::string_view text) {
+    return kUsageStatusText.value(text).value_or(UsageStatus::Unused);
 }
 
 }  // namespace rove::data
@@ -4,6 +4,7 @@
 #include <QDateTime>
 
 #include <string>
+#include <string_view>
 
 #include "DatabaseManager.h"
 
@@ -25,8 +26,11 @@ public:
     int itemId() const noexcept;
     void setItemId(int itemId) noexcept;
 
-    const std::string& owner() const noexcept;
-    void setOwner(std::string owner);
+    /**
+     * @brief 所属学生的 users.id。
+     */
+    int ownerId() const noexcept;
+    void setOwnerId(int ownerId) noexcept;
 
     const QDateTime& purchaseTime() const noexcept;
     void setPurchaseTime(const QDateTime& time);
@@ -55,12 +59,12 @@ public:
     DatabaseManager::InventoryRecord toRecord() const;
 
     static std::string statusToString(UsageStatus status);
-    static UsageStatus statusFromString(const std::string& text);
+    static UsageStatus statusFromString(std::string_view text);
 
 private:
     int m_inventoryId;
     int m_itemId;
-    std::string m_owner;
+    int m_ownerId;
     QDateTime m_purchaseTime;
     int m_quantity;
     int m_usedQuantity;
@@ -1,42 +1,88 @@
 #include "InventoryManager.h"
 
 #include <algorithm>
+#include <iterator>
+#include <limits>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace rove::data {
 namespace {
 constexpr int kMaxEffectStack = 3;
 constexpr int kExpiringSoonHours = 48;
+
+/**
+ * @brief 与 DatabaseManager 写入 expiration_time_ms 的规则一致：取记录中的毫秒列，缺失时解析 ISO 文本。
+ */
+std::optional<std::int64_t> expirationMsOf(const DatabaseManager::InventoryRecord& record) {
+    if (record.expirationTimeMs.has_value()) {
+        return record.expirationTimeMs;
+    }
+    if (record.expirationTimeIso.empty()) {
+        return std::nullopt;
+    }
+    const QDateTime parsed = QDateTime::fromString(QString::fromStdString(record.expirationTimeIso), Qt::ISODate);
+    if (!parsed.isValid()) {
+        return std::nullopt;
+    }
+    return parsed.toMSecsSinceEpoch();
 }
+}  // namespace
 
 InventoryManager& InventoryManager::instance() {
     static InventoryManager instance;
     return instance;
 }
 
-InventoryManager::InventoryManager() : m_database(nullptr), m_mutex(), m_effects() {}
+InventoryManager::InventoryManager()
+    : m_database(nullptr),
+      m_mutex("InventoryManager"),
+      m_effects(),
+      m_effectDeadlines(),
+      m_expiryTimer(std::make_unique<QTimer>()),
+      m_signalProxy(std::make_unique<InventoryManagerSignalProxy>()),
+      m_cacheMutex("InventoryManager.cache"),
+      m_memoryRegistration() {
+    m_expiryTimer->setSingleShot(true);
+    m_expiryTimer->setTimerType(Qt::CoarseTimer);
+    QObject::connect(m_expiryTimer.get(), &QTimer::timeout, [this]() { expireEffects(); });
+    m_memoryRegistration = metrics::MemoryRegistry::instance().add(
+        "inventory", [this]() { return memoryUsage(); }, [this]() { trimMemory(); });
+}
 
 void InventoryManager::initialize(DatabaseManager& database) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_database = &database;
+    std::unique_lock<StateMutex> lock(m_mutex);
+    m_database.store(&database);
     m_effects.clear();
+    m_effectDeadlines = {};
+    m_expiryTimer->stop();
+    std::unique_lock<StateMutex> cacheLock(m_cacheMutex);
+    m_owners.clear();
+    m_ownerLoadOrder.clear();
+    ++m_cacheGeneration;
 }
 
-void InventoryManager::ensureInitialized() const {
-    if (m_database == nullptr) {
+void InventoryManager::ensureInitialized() const { static_cast<void>(database()); }
+
+DatabaseManager& InventoryManager::database() const {
+    DatabaseManager* database = m_database.load();
+    if (database == nullptr) {
         throw std::runtime_error("InventoryManager is not initialized");
     }
+    return *database;
 }
 
-InventoryItem InventoryManager::createFromShopItem(const ShopItem& item,
-                                                   const std::string& owner,
-                                                   int quantity,
-                                                   const std::string& specialAttributes) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
+bool InventoryManager::isStackable(const ShopItem& item) noexcept {
+    return item.itemType() == ShopItem::ItemType::Prop;
+}
+
+InventoryItem InventoryManager::buildEntry(const ShopItem& item,
+                                           int ownerId,
+                                           int quantity,
+                                           const std::string& specialAttributes) const {
     InventoryItem entry;
-    entry.setOwner(owner);
+    entry.setOwnerId(ownerId);
     entry.setItemId(item.id());
     entry.setQuantity(quantity);
     entry.setUsedQuantity(0);
@@ -56,104 +102,409 @@ InventoryItem InventoryManager::createFromShopItem(const ShopItem& item,
     } else {
         entry.setNotes(item.effectDescription());
     }
-    auto record = entry.toRecord();
-    record.owner = owner;
-    record.itemId = item.id();
-    record.luckyPayload = entry.specialAttributes();
-    const int newId = m_database->insertInventoryRecord(record);
+    return entry;
+}
+
+InventoryItem InventoryManager::createFromShopItem(const ShopItem& item,
+                                                   int ownerId,
+                                                   int quantity,
+                                                   const std::string& specialAttributes) {
+    InventoryItem entry = buildEntry(item, ownerId, quantity, specialAttributes);
+    const int newId = database().insertInventoryRecord(entry.toRecord());
     entry.setId(newId);
+    cacheUpsert(entry, item.itemType());
+    emitInserted(ownerId, {newId});
     return entry;
 }
 
+std::vector<InventoryItem> InventoryManager::createBatchFromShopItem(const ShopItem& item,
+                                                                     int ownerId,
+                                                                     int quantity) {
+    std::vector<InventoryItem> entries;
+    if (quantity <= 0) {
+        return entries;
+    }
+    if (isStackable(item)) {
+        InventoryItem entry = buildEntry(item, ownerId, quantity, std::string());
+        entry.setId(database().insertInventoryRecord(entry.toRecord()));
+        cacheUpsert(entry, item.itemType());
+        emitInserted(ownerId, {entry.id()});
+        entries.push_back(std::move(entry));
+        return entries;
+    }
+    // 中文：同一批次的各件商品仅 id 不同，构造一次后复制即可。
+    const InventoryItem prototype = buildEntry(item, ownerId, 1, std::string());
+    const std::vector<DatabaseManager::InventoryRecord> records(static_cast<std::size_t>(quantity),
+                                                                prototype.toRecord());
+    const std::vector<int> ids = database().insertInventoryRecords(records);
+    entries.reserve(ids.size());
+    QVector<int> inserted;
+    inserted.reserve(static_cast<int>(ids.size()));
+    for (int id : ids) {
+        entries.push_back(prototype);
+        entries.back().setId(id);
+        cacheUpsert(entries.back(), item.itemType());
+        inserted.append(id);
+    }
+    emitInserted(ownerId, inserted);
+    return entries;
+}
+
+/**
+ * @brief 先在已装载用户的缓存中查找，未命中（例如属于未装载的用户）时回退到数据库。
+ */
 std::optional<InventoryItem> InventoryManager::findById(int inventoryId) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
-    auto record = m_database->getInventoryRecordById(inventoryId);
+    {
+        std::shared_lock<StateMutex> lock(m_cacheMutex);
+        for (const auto& [owner, cache] : m_owners) {
+            const auto it = cache.byId.find(inventoryId);
+            if (it != cache.byId.end()) {
+                return it->second.item;
+            }
+        }
+    }
+    auto record = database().getInventoryRecordById(inventoryId);
     if (!record.has_value()) {
         return std::nullopt;
     }
     return InventoryItem::fromRecord(*record);
 }
 
-std::vector<InventoryItem> InventoryManager::listByOwner(const std::string& owner) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
-    auto records = m_database->getInventoryForUser(owner);
+/**
+ * @brief 返回缓存副本，顺序与原 SQL 一致：购买时间降序，同一时间按 id 降序。
+ */
+std::vector<InventoryItem> InventoryManager::listByOwner(int ownerId) const {
+    ensureOwnerLoaded(ownerId);
     std::vector<InventoryItem> items;
-    items.reserve(records.size());
-    for (const auto& record : records) {
-        items.push_back(InventoryItem::fromRecord(record));
+    {
+        std::shared_lock<StateMutex> lock(m_cacheMutex);
+        const auto found = m_owners.find(ownerId);
+        if (found != m_owners.end()) {
+            items.reserve(found->second.byId.size());
+            for (const auto& [id, entry] : found->second.byId) {
+                items.push_back(entry.item);
+            }
+        }
     }
+    std::sort(items.begin(), items.end(), [](const InventoryItem& lhs, const InventoryItem& rhs) {
+        if (lhs.purchaseTime() != rhs.purchaseTime()) {
+            return lhs.purchaseTime() > rhs.purchaseTime();
+        }
+        return lhs.id() > rhs.id();
+    });
     return items;
 }
 
 bool InventoryManager::updateInventory(const InventoryItem& item) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
-    return m_database->updateInventoryRecord(item.toRecord());
+    const bool updated = database().updateInventoryRecord(item.toRecord());
+    if (updated) {
+        cacheUpsert(item);
+        emitUpdated(item.id());
+    }
+    return updated;
 }
 
 bool InventoryManager::removeInventory(int inventoryId) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
-    return m_database->deleteInventoryRecord(inventoryId);
+    const bool removed = database().deleteInventoryRecord(inventoryId);
+    if (removed) {
+        cacheErase(inventoryId);
+    }
+    if (removed && m_signalProxy) {
+        database().runAfterCommit(
+            [proxy = m_signalProxy.get(), inventoryId]() { emit proxy->inventoryRemoved({inventoryId}); });
+    }
+    return removed;
 }
 
 void InventoryManager::cleanupExpiredItems() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
-    const auto records = m_database->getAllInventoryRecords();
+    DatabaseManager& db = database();
     const QDateTime now = QDateTime::currentDateTimeUtc();
-    for (const auto& record : records) {
-        InventoryItem item = InventoryItem::fromRecord(record);
-        if (item.status() == InventoryItem::UsageStatus::Expired) {
-            continue;
-        }
-        if (item.isExpired(now)) {
-            item.setStatus(InventoryItem::UsageStatus::Expired);
-            item.setNotes("效果已过期，系统自动回收");
-            m_database->updateInventoryRecord(item.toRecord());
+    // 中文：只取已到期且未回收的行，无需加载并逐条比较全部库存；写库不持有效果表的锁。
+    auto expired = db.getExpiredInventoryRecords(now.toMSecsSinceEpoch());
+    for (auto& record : expired) {
+        record.status = InventoryItem::statusToString(InventoryItem::UsageStatus::Expired);
+        record.notes = "效果已过期，系统自动回收";
+    }
+    db.updateInventoryRecords(expired);  // 中文：过期记录单事务批量写回。
+    for (const auto& record : expired) {
+        cacheUpsert(InventoryItem::fromRecord(record));
+    }
+    if (!expired.empty() && m_signalProxy) {
+        QVector<int> expiredIds;
+        expiredIds.reserve(static_cast<int>(expired.size()));
+        for (const auto& record : expired) {
+            expiredIds.append(record.id);
         }
+        db.runAfterCommit([proxy = m_signalProxy.get(), expiredIds]() { emit proxy->inventoryUpdated(expiredIds); });
     }
-    cleanupAllEffectsLocked();
+    std::unique_lock<StateMutex> lock(m_mutex);
+    expireDueEffectsLocked(now.toMSecsSinceEpoch());
+    scheduleNextExpiryLocked();
 }
 
-InventoryManager::InventoryStatistics InventoryManager::statisticsForOwner(const std::string& owner) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
+/**
+ * 中文说明：库存统计
+ * - 分类件数与总数由缓存随写入维护，读取为 O(1)；
+ * - “即将到期”依赖当前时间，按到期时间有序索引做一次区间遍历，代价与区间内的条目数成正比；
+ * - 商品已被删除的库存只计入 total 与 expiringSoon，与原先的聚合查询口径一致。
+ */
+InventoryManager::InventoryStatistics InventoryManager::statisticsForOwner(int ownerId) const {
+    ensureOwnerLoaded(ownerId);
     InventoryStatistics stats;
-    const auto records = m_database->getInventoryForUser(owner);
     const QDateTime now = QDateTime::currentDateTimeUtc();
-    for (const auto& record : records) {
-        const InventoryItem item = InventoryItem::fromRecord(record);
-        ++stats.total;
-        if (item.expirationTime().isValid() && item.expirationTime() > now &&
-            item.expirationTime() < now.addSecs(kExpiringSoonHours * 3600)) {
-            ++stats.expiringSoon;
+    const std::int64_t fromMs = now.toMSecsSinceEpoch();
+    const std::int64_t untilMs = now.addSecs(kExpiringSoonHours * 3600).toMSecsSinceEpoch();
+    std::shared_lock<StateMutex> lock(m_cacheMutex);
+    const auto found = m_owners.find(ownerId);
+    if (found == m_owners.end()) {
+        return stats;
+    }
+    const OwnerInventory& cache = found->second;
+    stats.total = cache.totalQuantity;
+    stats.physical = cache.quantityByType[static_cast<std::size_t>(ShopItem::ItemType::Physical)];
+    stats.props = cache.quantityByType[static_cast<std::size_t>(ShopItem::ItemType::Prop)];
+    stats.luckyBags = cache.quantityByType[static_cast<std::size_t>(ShopItem::ItemType::LuckyBag)];
+    // 中文：区间为开区间 (fromMs, untilMs)，与原 SQL 的比较方式相同。
+    for (auto it = cache.byExpiration.upper_bound(fromMs); it != cache.byExpiration.end() && it->first < untilMs; ++it) {
+        stats.expiringSoon += cache.byId.at(it->second).item.quantity();
+    }
+    return stats;
+}
+
+int InventoryManager::countPurchasesForItem(int ownerId, int itemId) const {
+    ensureOwnerLoaded(ownerId);
+    std::shared_lock<StateMutex> lock(m_cacheMutex);
+    const auto found = m_owners.find(ownerId);
+    if (found == m_owners.end()) {
+        return 0;
+    }
+    const auto count = found->second.quantityByItem.find(itemId);
+    return count == found->second.quantityByItem.end() ? 0 : count->second;
+}
+
+void InventoryManager::discardCachedOwner(int ownerId) {
+    std::unique_lock<StateMutex> lock(m_cacheMutex);
+    if (m_owners.erase(ownerId) > 0) {
+        m_ownerLoadOrder.erase(std::find(m_ownerLoadOrder.begin(), m_ownerLoadOrder.end(), ownerId));
+    }
+    ++m_cacheGeneration;
+}
+
+metrics::MemoryUsage InventoryManager::memoryUsage() const {
+    metrics::MemoryUsage usage;
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        usage.entries += m_effects.size();
+        usage.bytes += metrics::nodeContainerBytes(m_effects.size(), sizeof(std::pair<const std::string, EffectState>),
+                                                   m_effects.bucket_count()) +
+                       m_effectDeadlines.size() * sizeof(EffectDeadline);
+        for (const auto& [username, state] : m_effects) {
+            usage.bytes += metrics::heapBytes(username);
         }
-        auto shopRecord = m_database->getShopItemById(item.itemId());
-        if (!shopRecord.has_value()) {
-            continue;
+    }
+    std::shared_lock<StateMutex> lock(m_cacheMutex);
+    for (const auto& [ownerId, cache] : m_owners) {
+        usage.entries += cache.byId.size();
+        const std::size_t itemKeys = cache.quantityByItem.size() + cache.typeByItem.size();
+        const std::size_t itemBuckets = cache.quantityByItem.bucket_count() + cache.typeByItem.bucket_count();
+        usage.bytes +=
+            metrics::nodeContainerBytes(cache.byId.size(), sizeof(std::pair<const int, OwnerInventory::Entry>),
+                                        cache.byId.bucket_count()) +
+            metrics::nodeContainerBytes(cache.byId.size(), sizeof(std::pair<const std::int64_t, int>)) +
+            metrics::nodeContainerBytes(cache.idsByItem.size() + cache.byId.size(), sizeof(int) * 2,
+                                        cache.idsByItem.bucket_count()) +
+            metrics::nodeContainerBytes(itemKeys, sizeof(int) * 2, itemBuckets);
+        for (const auto& [inventoryId, entry] : cache.byId) {
+            usage.bytes += metrics::heapBytes(entry.item.specialAttributes()) + metrics::heapBytes(entry.item.notes());
         }
-        switch (ShopItem::itemTypeFromString(shopRecord->itemType)) {
-            case ShopItem::ItemType::Physical:
-                ++stats.physical;
-                break;
-            case ShopItem::ItemType::Prop:
-                ++stats.props;
-                break;
-            case ShopItem::ItemType::LuckyBag:
-                ++stats.luckyBags;
+    }
+    return usage;
+}
+
+void InventoryManager::trimMemory() {
+    const int activeOwner = m_activeOwnerId.load(std::memory_order_relaxed);
+    std::unique_lock<StateMutex> lock(m_cacheMutex);
+    for (auto it = m_owners.begin(); it != m_owners.end();) {
+        it = it->first == activeOwner ? std::next(it) : m_owners.erase(it);
+    }
+    m_ownerLoadOrder.erase(std::remove_if(m_ownerLoadOrder.begin(), m_ownerLoadOrder.end(),
+                                          [activeOwner](int ownerId) { return ownerId != activeOwner; }),
+                           m_ownerLoadOrder.end());
+}
+
+/**
+ * 中文说明：按需装载用户库存
+ * - 经读连接池读取库存行与商品类型，不占用写连接、不与写者的事务串行；
+ * - 构建在锁外完成；发布前比对写入代次，期间有任何写入（其同步缓存时本用户尚未装载）则丢弃重读；
+ * - 写者的事务尚未提交时读到的是旧行，由 settleLoadsAfterCommit 在提交后丢弃这类装载；
+ * - 其他线程已先一步装载时直接沿用；
+ * - 已缓存的用户达到上限时丢弃最早装载者，切换过多个学生账号后内存不随历史用户数增长。
+ */
+void InventoryManager::ensureOwnerLoaded(int ownerId) const {
+    m_activeOwnerId.store(ownerId, std::memory_order_relaxed);
+    {
+        std::shared_lock<StateMutex> lock(m_cacheMutex);
+        if (m_owners.find(ownerId) != m_owners.end()) {
+            return;
+        }
+    }
+    DatabaseManager& db = database();
+    for (;;) {
+        std::uint64_t generation = 0;
+        std::vector<DatabaseManager::InventoryRecord> records;
+        std::vector<std::pair<int, std::string>> types;
+        {
+            std::shared_lock<StateMutex> lock(m_cacheMutex);
+            generation = m_cacheGeneration;
+        }
+        records = db.getInventoryForUser(ownerId);
+        types = db.getInventoryItemTypes(ownerId);
+        OwnerInventory cache;
+        cache.byId.reserve(records.size());
+        for (const auto& [itemId, type] : types) {
+            cache.typeByItem.emplace(itemId, ShopItem::itemTypeFromString(type));
+        }
+        for (const auto& record : records) {
+            indexEntry(cache, InventoryItem::fromRecord(record), record.expirationTimeMs);
+        }
+        std::unique_lock<StateMutex> lock(m_cacheMutex);
+        if (m_owners.find(ownerId) != m_owners.end()) {
+            return;
+        }
+        if (generation == m_cacheGeneration) {
+            while (m_ownerLoadOrder.size() >= kMaxCachedOwners) {
+                m_owners.erase(m_ownerLoadOrder.front());
+                m_ownerLoadOrder.pop_front();
+            }
+            cache.loadedGeneration = generation;
+            m_owners.emplace(ownerId, std::move(cache));
+            m_ownerLoadOrder.push_back(ownerId);
+            return;
+        }
+    }
+}
+
+void InventoryManager::indexEntry(OwnerInventory& cache, InventoryItem item, std::optional<std::int64_t> expirationMs) {
+    const int inventoryId = item.id();
+    const int itemId = item.itemId();
+    const int quantity = item.quantity();
+    cache.idsByItem[itemId].insert(inventoryId);
+    cache.quantityByItem[itemId] += quantity;
+    cache.totalQuantity += quantity;
+    const auto type = cache.typeByItem.find(itemId);
+    if (type != cache.typeByItem.end()) {
+        cache.quantityByType[static_cast<std::size_t>(type->second)] += quantity;
+    }
+    if (expirationMs.has_value()) {
+        cache.byExpiration.emplace(*expirationMs, inventoryId);
+    }
+    cache.byId.insert_or_assign(inventoryId, OwnerInventory::Entry{std::move(item), expirationMs});
+}
+
+void InventoryManager::unindexEntry(OwnerInventory& cache, int inventoryId) {
+    const auto found = cache.byId.find(inventoryId);
+    if (found == cache.byId.end()) {
+        return;
+    }
+    const InventoryItem& item = found->second.item;
+    const int itemId = item.itemId();
+    const int quantity = item.quantity();
+    auto ids = cache.idsByItem.find(itemId);
+    if (ids != cache.idsByItem.end()) {
+        ids->second.erase(inventoryId);
+        if (ids->second.empty()) {
+            cache.idsByItem.erase(ids);
+            cache.quantityByItem.erase(itemId);
+        } else {
+            cache.quantityByItem[itemId] -= quantity;
+        }
+    }
+    cache.totalQuantity -= quantity;
+    const auto type = cache.typeByItem.find(itemId);
+    if (type != cache.typeByItem.end()) {
+        cache.quantityByType[static_cast<std::size_t>(type->second)] -= quantity;
+    }
+    if (found->second.expirationMs.has_value()) {
+        auto [begin, end] = cache.byExpiration.equal_range(*found->second.expirationMs);
+        for (auto it = begin; it != end; ++it) {
+            if (it->second == inventoryId) {
+                cache.byExpiration.erase(it);
                 break;
+            }
         }
     }
-    return stats;
+    cache.byId.erase(found);
 }
 
-int InventoryManager::countPurchasesForItem(const std::string& owner, int itemId) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
-    return m_database->countInventoryByUserAndItem(owner, itemId);
+/**
+ * @brief 写入处于外层事务中时，缓存先于提交改写；事务回滚时丢弃全部已装载用户，下次查询重新读库。
+ */
+void InventoryManager::discardCacheOnRollback() {
+    database().runOnRollback(this, [this]() {
+        std::unique_lock<StateMutex> lock(m_cacheMutex);
+        m_owners.clear();
+        m_ownerLoadOrder.clear();
+        ++m_cacheGeneration;
+    });
+}
+
+/**
+ * @brief 缓存在写入的事务提交前就已改写，而读连接上的装载只看得到已提交的行：写入之后才发布的装载可能缺少这次写入。
+ * 中文：提交后丢弃装载代次不早于本次写入的用户并递增代次，在途装载随之重读；不在事务中时写入已提交，无需登记。
+ *       须在取 m_cacheMutex 之前调用；写者经数据库写锁串行，读到的代次加一即本次写入的代次（偏小只会多丢弃）。
+ */
+void InventoryManager::settleLoadsAfterCommit() {
+    if (!database().inTransaction()) {
+        return;
+    }
+    std::uint64_t writeGeneration = 0;
+    {
+        std::shared_lock<StateMutex> lock(m_cacheMutex);
+        writeGeneration = m_cacheGeneration + 1;
+    }
+    database().runAfterCommit([this, writeGeneration]() {
+        std::unique_lock<StateMutex> lock(m_cacheMutex);
+        for (auto it = m_ownerLoadOrder.begin(); it != m_ownerLoadOrder.end();) {
+            const auto found = m_owners.find(*it);
+            if (found != m_owners.end() && found->second.loadedGeneration >= writeGeneration) {
+                m_owners.erase(found);
+                it = m_ownerLoadOrder.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        ++m_cacheGeneration;
+    });
+}
+
+void InventoryManager::cacheUpsert(const InventoryItem& item, std::optional<ShopItem::ItemType> type) {
+    discardCacheOnRollback();
+    settleLoadsAfterCommit();
+    std::unique_lock<StateMutex> lock(m_cacheMutex);
+    ++m_cacheGeneration;
+    const auto found = m_owners.find(item.ownerId());
+    if (found == m_owners.end()) {
+        return;  // 中文：未装载的用户首次查询时会从数据库读到这次写入。
+    }
+    OwnerInventory& cache = found->second;
+    unindexEntry(cache, item.id());
+    if (type.has_value()) {
+        cache.typeByItem.insert_or_assign(item.itemId(), *type);
+    }
+    indexEntry(cache, item, expirationMsOf(item.toRecord()));
+}
+
+void InventoryManager::cacheErase(int inventoryId) {
+    discardCacheOnRollback();
+    settleLoadsAfterCommit();
+    std::unique_lock<StateMutex> lock(m_cacheMutex);
+    ++m_cacheGeneration;
+    for (auto& [owner, cache] : m_owners) {
+        if (cache.byId.find(inventoryId) != cache.byId.end()) {
+            unindexEntry(cache, inventoryId);
+            return;
+        }
+    }
 }
 
 /**
@@ -162,37 +513,65 @@ int InventoryManager::countPurchasesForItem(const std::string& owner, int itemId
  *    其他系统可通过 hasEffectToken/consumeEffectToken 以 O(1) 查询/消费，保证“跳过任务”与“失败清零”逻辑可靠。
  * 2. DoubleExpCard：堆栈代表倍率-1，多个卡片会延长 expiresAt 并叠加 stack，doubleExpMultiplier 会返回 1+stack 的实时倍率。
  * 3. 所有效果写入 user_inventory.special_attributes，方便重新登录后恢复 UI 状态；
- * 4. 所有操作均在 mutex 保护下执行，确保多线程安全。
+ * 4. 效果表的读写在 m_mutex 内完成，库存行的写入在锁外进行，不阻塞效果查询；
+ * 5. 效果与使用条件来自商城目录中预先解析的 ShopItem::Rules，互斥与叠加上限在登记效果的同一临界区内判定。
  */
-bool InventoryManager::applyPropEffect(const ShopItem& item,
+bool InventoryManager::applyPropEffect(const ShopItem::Rules& rules,
                                        InventoryItem& entry,
                                        const std::string& username,
                                        std::string* message) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
-    cleanupExpiredEffectsLocked(username);
+    DatabaseManager& db = database();
+    const ShopItem::EffectSpec& effect = rules.effect;
     std::string feedback;
-    switch (item.propEffectType()) {
-        case ShopItem::PropEffectType::RestDay:
-            registerEffectLocked(username, ShopItem::PropEffectType::RestDay, item.effectDurationMinutes());
-            feedback = "已登记一张休息日卡，可在时效内跳过一次每日任务";
-            break;
-        case ShopItem::PropEffectType::ForgivenessCoupon:
-            registerEffectLocked(username, ShopItem::PropEffectType::ForgivenessCoupon, item.effectDurationMinutes());
-            feedback = "已存入原谅券，下一次任务失败会被清零记录";
-            break;
-        case ShopItem::PropEffectType::DoubleExpCard:
-            registerEffectLocked(username, ShopItem::PropEffectType::DoubleExpCard, item.effectDurationMinutes());
-            feedback = "已激活双倍成长 buff";
-            break;
-        case ShopItem::PropEffectType::None:
-            feedback = "该道具无实际效果";
-            break;
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+        expireDueEffectsLocked(nowMs);
+        const auto found = m_effects.find(username);
+        const std::uint32_t activeMask = found != m_effects.end() ? found->second.activeMask : 0;
+        const int activeStacks = found != m_effects.end() && effect.type != ShopItem::PropEffectType::None
+                                     ? found->second.stacks[static_cast<std::size_t>(effect.type)]
+                                     : 0;
+        std::string denied;
+        if ((activeMask & rules.usage.exclusiveMask) != 0) {
+            denied = "与正在生效的道具互斥，暂不能使用";
+        } else if (rules.usage.maxActiveStacks > 0 && activeStacks >= rules.usage.maxActiveStacks) {
+            denied = "同类效果已叠加到上限";
+        }
+        if (!denied.empty()) {
+            if (message != nullptr) {
+                *message = std::move(denied);
+            }
+            return false;
+        }
+        switch (effect.type) {
+            case ShopItem::PropEffectType::RestDay:
+                registerEffectLocked(username, effect.type, effect.durationMinutes, effect.stacks);
+                feedback = "已登记一张休息日卡，可在时效内跳过一次每日任务";
+                break;
+            case ShopItem::PropEffectType::ForgivenessCoupon:
+                registerEffectLocked(username, effect.type, effect.durationMinutes, effect.stacks);
+                feedback = "已存入原谅券，下一次任务失败会被清零记录";
+                break;
+            case ShopItem::PropEffectType::DoubleExpCard:
+                registerEffectLocked(username, effect.type, effect.durationMinutes, effect.stacks);
+                feedback = "已激活双倍成长 buff";
+                break;
+            case ShopItem::PropEffectType::None:
+                feedback = "该道具无实际效果";
+                break;
+        }
+    }
+    // 中文：堆叠记录每次只消耗一件，全部用完才标记为已消耗。
+    entry.setUsedQuantity(std::min(entry.usedQuantity() + 1, entry.quantity()));
+    if (entry.usedQuantity() >= entry.quantity()) {
+        entry.setStatus(InventoryItem::UsageStatus::Consumed);
+    }
+    entry.setSpecialAttributes("{\"effect\":\"" + ShopItem::propEffectToString(effect.type) + "\"}");
+    if (db.updateInventoryRecord(entry.toRecord())) {
+        cacheUpsert(entry);
+        emitUpdated(entry.id());
     }
-    entry.setStatus(InventoryItem::UsageStatus::Consumed);
-    entry.setUsedQuantity(entry.quantity());
-    entry.setSpecialAttributes("{\"effect\":\"" + ShopItem::propEffectToString(item.propEffectType()) + "\"}");
-    m_database->updateInventoryRecord(entry.toRecord());
     if (message != nullptr) {
         *message = feedback;
     }
@@ -200,123 +579,164 @@ bool InventoryManager::applyPropEffect(const ShopItem& item,
 }
 
 bool InventoryManager::markPhysicalRedeemed(InventoryItem& entry, const std::string& notes) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
     entry.setStatus(InventoryItem::UsageStatus::Consumed);
     entry.setUsedQuantity(entry.quantity());
     entry.setNotes(notes);
-    return m_database->updateInventoryRecord(entry.toRecord());
+    return updateInventory(entry);
 }
 
 bool InventoryManager::markLuckyBagOpened(InventoryItem& entry, const std::string& payload) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
     entry.setStatus(InventoryItem::UsageStatus::Consumed);
     entry.setUsedQuantity(entry.quantity());
     entry.setSpecialAttributes(payload);
-    return m_database->updateInventoryRecord(entry.toRecord());
+    return updateInventory(entry);
 }
 
 bool InventoryManager::consumeEffectToken(const std::string& username, ShopItem::PropEffectType type) {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<StateMutex> lock(m_mutex);
     ensureInitialized();
-    cleanupExpiredEffectsLocked(username);
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    expireDueEffectsLocked(nowMs);
     auto it = m_effects.find(username);
-    if (it == m_effects.end()) {
+    if (it == m_effects.end() || !it->second.has(type, nowMs)) {
         return false;
     }
-    auto& bucket = it->second;
-    for (auto& effect : bucket) {
-        if (effect.type == type && effect.stack > 0) {
-            --effect.stack;
-            if (effect.stack == 0) {
-                effect.expiresAt = QDateTime::currentDateTimeUtc();
-            }
-            return true;
+    auto& state = it->second;
+    if (--state.stacks[static_cast<std::size_t>(type)] == 0) {
+        // 中文：堆中残留的到期项出堆时发现该效果已不在掩码中，会被直接忽略。
+        state.clear(type);
+        if (state.activeMask == 0) {
+            m_effects.erase(it);
         }
     }
-    return false;
+    return true;
 }
 
+/**
+ * 中文说明：效果查询位于奖励结算的热路径上，只做一次哈希查找、一次时间比较与一次位测试；
+ *          取毫秒时间戳不构造 QDateTime。
+ */
 bool InventoryManager::hasEffectToken(const std::string& username, ShopItem::PropEffectType type) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::shared_lock<StateMutex> lock(m_mutex);
     ensureInitialized();
     auto it = m_effects.find(username);
-    if (it == m_effects.end()) {
-        return false;
-    }
-    const QDateTime now = QDateTime::currentDateTimeUtc();
-    for (const auto& effect : it->second) {
-        if (effect.type == type && effect.expiresAt > now && effect.stack > 0) {
-            return true;
-        }
-    }
-    return false;
+    return it != m_effects.end() && it->second.has(type, QDateTime::currentMSecsSinceEpoch());
 }
 
 double InventoryManager::doubleExpMultiplier(const std::string& username) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::shared_lock<StateMutex> lock(m_mutex);
     ensureInitialized();
     auto it = m_effects.find(username);
-    if (it == m_effects.end()) {
+    if (it == m_effects.end() ||
+        !it->second.has(ShopItem::PropEffectType::DoubleExpCard, QDateTime::currentMSecsSinceEpoch())) {
         return 1.0;
     }
-    const QDateTime now = QDateTime::currentDateTimeUtc();
-    for (const auto& effect : it->second) {
-        if (effect.type == ShopItem::PropEffectType::DoubleExpCard && effect.expiresAt > now) {
-            return 1.0 + effect.stack;
-        }
+    return 1.0 + it->second.stacks[static_cast<std::size_t>(ShopItem::PropEffectType::DoubleExpCard)];
+}
+
+InventoryManagerSignalProxy* InventoryManager::signalProxy() const noexcept { return m_signalProxy.get(); }
+
+/**
+ * @brief 库存信号经 runAfterCommit 在最外层事务提交后发出，回滚的写入不会通知界面。
+ */
+void InventoryManager::emitInserted(int ownerId, const QVector<int>& inventoryIds) const {
+    if (m_signalProxy && !inventoryIds.isEmpty()) {
+        database().runAfterCommit([proxy = m_signalProxy.get(), ownerId, inventoryIds]() {
+            emit proxy->inventoryInserted(ownerId, inventoryIds);
+        });
     }
-    return 1.0;
 }
 
-void InventoryManager::cleanupExpiredEffectsLocked(const std::string& username) const {
-    auto it = m_effects.find(username);
-    if (it == m_effects.end()) {
-        return;
+void InventoryManager::emitUpdated(int inventoryId) const {
+    if (m_signalProxy) {
+        database().runAfterCommit(
+            [proxy = m_signalProxy.get(), inventoryId]() { emit proxy->inventoryUpdated({inventoryId}); });
     }
-    const QDateTime now = QDateTime::currentDateTimeUtc();
-    auto& bucket = it->second;
-    bucket.erase(
-        std::remove_if(bucket.begin(), bucket.end(), [&now](const ActiveEffect& effect) { return effect.expiresAt <= now; }),
-        bucket.end());
-    if (bucket.empty()) {
-        m_effects.erase(it);
+}
+
+void InventoryManager::expireEffects() {
+    std::unique_lock<StateMutex> lock(m_mutex);
+    expireDueEffectsLocked(QDateTime::currentMSecsSinceEpoch());
+    scheduleNextExpiryLocked();
+}
+
+void InventoryManager::EffectState::clear(ShopItem::PropEffectType type) noexcept {
+    const auto index = static_cast<std::size_t>(type);
+    stacks[index] = 0;
+    expiresAtMs[index] = 0;
+    refresh();
+}
+
+void InventoryManager::EffectState::refresh() noexcept {
+    activeMask = 0;
+    nextExpiryMs = std::numeric_limits<qint64>::max();
+    for (std::size_t i = 0; i < kEffectTypeCount; ++i) {
+        if (stacks[i] > 0) {
+            activeMask |= 1U << i;
+            nextExpiryMs = std::min(nextExpiryMs, expiresAtMs[i]);
+        }
     }
 }
 
-void InventoryManager::cleanupAllEffectsLocked() const {
-    const QDateTime now = QDateTime::currentDateTimeUtc();
-    for (auto it = m_effects.begin(); it != m_effects.end();) {
-        auto& bucket = it->second;
-        bucket.erase(std::remove_if(bucket.begin(),
-                                    bucket.end(),
-                                    [&now](const ActiveEffect& effect) { return effect.expiresAt <= now; }),
-                     bucket.end());
-        if (bucket.empty()) {
-            it = m_effects.erase(it);
-        } else {
-            ++it;
+/**
+ * 中文说明：效果到期回收
+ * - 只弹出堆顶已到期的项，代价为 O(k log n)（k 为本次到期数），未到期时仅比较一次堆顶；
+ * - 效果被延长过时其当前到期时间晚于出堆项，说明出堆项已失效，直接忽略；
+ * - 回收后重算该用户的掩码与最早到期时刻，查询路径始终看到最新的预计算状态。
+ */
+void InventoryManager::expireDueEffectsLocked(qint64 nowMs) const {
+    while (!m_effectDeadlines.empty() && m_effectDeadlines.top().expiresAtMs <= nowMs) {
+        const EffectDeadline deadline = m_effectDeadlines.top();
+        m_effectDeadlines.pop();
+        auto it = m_effects.find(deadline.username);
+        if (it == m_effects.end()) {
+            continue;
         }
+        auto& state = it->second;
+        if ((state.activeMask & EffectState::bit(deadline.type)) == 0 ||
+            state.expiresAtMs[static_cast<std::size_t>(deadline.type)] > nowMs) {
+            continue;
+        }
+        state.clear(deadline.type);
+        if (state.activeMask == 0) {
+            m_effects.erase(it);
+        }
+    }
+}
+
+/**
+ * @brief 按到期堆堆顶重新布置定时器；QTimer 只能在所属线程启停，其他线程调用时排队到定时器线程执行。
+ */
+void InventoryManager::scheduleNextExpiryLocked() const {
+    QTimer* timer = m_expiryTimer.get();
+    if (m_effectDeadlines.empty()) {
+        QMetaObject::invokeMethod(timer, [timer]() { timer->stop(); });
+        return;
     }
+    const qint64 delayMs = m_effectDeadlines.top().expiresAtMs - QDateTime::currentDateTimeUtc().toMSecsSinceEpoch();
+    const int clamped = static_cast<int>(std::clamp<qint64>(delayMs, 0, std::numeric_limits<int>::max()));
+    QMetaObject::invokeMethod(timer, [timer, clamped]() { timer->start(clamped); });
 }
 
 void InventoryManager::registerEffectLocked(const std::string& username,
                                             ShopItem::PropEffectType type,
                                             int durationMinutes,
                                             int stackDelta) {
-    cleanupExpiredEffectsLocked(username);
-    auto& bucket = m_effects[username];
-    const QDateTime now = QDateTime::currentDateTimeUtc();
-    auto it = std::find_if(bucket.begin(), bucket.end(), [type](const ActiveEffect& effect) { return effect.type == type; });
-    const int duration = durationMinutes > 0 ? durationMinutes : 1440;
-    if (it == bucket.end()) {
-        ActiveEffect effect{type, std::min(stackDelta, kMaxEffectStack), now.addSecs(duration * 60)};
-        bucket.push_back(effect);
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    expireDueEffectsLocked(nowMs);
+    auto& state = m_effects[username];
+    const auto index = static_cast<std::size_t>(type);
+    const qint64 durationMs = static_cast<qint64>(durationMinutes > 0 ? durationMinutes : 1440) * 60 * 1000;
+    if ((state.activeMask & EffectState::bit(type)) == 0) {
+        state.stacks[index] = std::min(stackDelta, kMaxEffectStack);
+        state.expiresAtMs[index] = nowMs + durationMs;
     } else {
-        it->stack = std::min(it->stack + stackDelta, kMaxEffectStack);
-        it->expiresAt = it->expiresAt.addSecs(duration * 60);
+        state.stacks[index] = std::min(state.stacks[index] + stackDelta, kMaxEffectStack);
+        state.expiresAtMs[index] += durationMs;
     }
+    state.refresh();
+    m_effectDeadlines.push(EffectDeadline{state.expiresAtMs[index], username, type});
+    scheduleNextExpiryLocked();
 }
 
 }  // namespace rove::data
@@ -2,25 +2,63 @@
 #define INVENTORYMANAGER_H
 
 #include <QDateTime>
-
-#include <mutex>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
 #include <optional>
+#include <queue>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "DatabaseManager.h"
 #include "InventoryItem.h"
+#include "MemoryAccounting.h"
+#include "Metrics.h"
 #include "ShopItem.h"
 
 namespace rove::data {
 
+/**
+ * @brief InventoryManager 的信号代理：库存行写入成功后以 id 列表通知增删改。
+ * 中文：信号在写入所在的最外层事务提交后发射，回滚的写入不会通知；写操作可能运行在数据线程，订阅者应使用排队连接。
+ */
+class InventoryManagerSignalProxy : public QObject {
+    Q_OBJECT
+
+public:
+    explicit InventoryManagerSignalProxy(QObject* parent = nullptr) : QObject(parent) {}
+
+signals:
+    void inventoryInserted(int ownerId, const QVector<int>& inventoryIds);
+    void inventoryUpdated(const QVector<int>& inventoryIds);
+    void inventoryRemoved(const QVector<int>& inventoryIds);
+};
+
 /**
  * @class InventoryManager
  * @brief 库存管理器采用哈希表缓存 + SQLite 记录的混合结构：
- *        - 哈希表（m_effects）保存道具效果堆栈，便于 O(1) 查询 RestDay/原谅券/双倍经验状态；
+ *        - 哈希表（m_effects）按用户保存预先算好的效果状态（生效掩码、各类堆栈与最早到期时刻），
+ *          奖励结算路径上的 RestDay/原谅券/双倍经验查询只需一次时间比较与一次位测试；
+ *        - 到期最小堆（m_effectDeadlines）配合单次定时器在最近的到期时刻回收效果，查询路径不再整表扫描；
  *        - SQLite 表 user_inventory 提供持久化与线程安全的行级锁保证；
- *        - std::mutex 保护所有复合读写，确保 UI 线程与后台清理线程并发安全。
+ *        - 读写锁 m_mutex 只保护效果表与到期堆：查询取共享锁，登记/消费/回收取独占锁；
+ *        - 每个用户的库存行在首次查询时整体装入 m_owners（按库存 id 与商品 id 索引，维护购买件数与分类件数），
+ *          之后的查询不再访问 SQLite；写入先落库再同步缓存（write-through），由独立的 m_cacheMutex 保护；
+ *          最多同时缓存 kMaxCachedOwners 个用户，超出时按装载顺序丢弃最早者，再次查询时重新装载；
+ *        - 每次库存行写入成功后经 signalProxy() 发出带 id 的增量，界面据此只刷新变化的行。
  */
 class InventoryManager final {
 public:
@@ -37,50 +75,169 @@ public:
     void initialize(DatabaseManager& database);
 
     InventoryItem createFromShopItem(const ShopItem& item,
-                                     const std::string& owner,
+                                     int ownerId,
                                      int quantity,
                                      const std::string& specialAttributes = std::string());
 
+    /**
+     * @brief 一次购买 quantity 件商品：可堆叠的道具写入一条 quantity = N 的记录，
+     *        实物与幸运礼包需逐件兑换/开启，走 insertInventoryRecords 单事务批量插入。
+     */
+    std::vector<InventoryItem> createBatchFromShopItem(const ShopItem& item, int ownerId, int quantity);
+
+    /**
+     * @brief 道具按堆叠存储，其余类型一件一条记录。
+     */
+    static bool isStackable(const ShopItem& item) noexcept;
+
     std::optional<InventoryItem> findById(int inventoryId) const;
-    std::vector<InventoryItem> listByOwner(const std::string& owner) const;
+    std::vector<InventoryItem> listByOwner(int ownerId) const;
     bool updateInventory(const InventoryItem& item);
     bool removeInventory(int inventoryId);
 
     void cleanupExpiredItems();
-    InventoryStatistics statisticsForOwner(const std::string& owner) const;
-    int countPurchasesForItem(const std::string& owner, int itemId) const;
-
-    bool applyPropEffect(const ShopItem& item,
+    InventoryStatistics statisticsForOwner(int ownerId) const;
+    int countPurchasesForItem(int ownerId, int itemId) const;
+
+    /**
+     * @brief 按预解析的规则登记道具效果并消耗一件库存。
+     * @return 使用条件不满足（互斥效果生效中、叠加已达上限）时返回 false，原因写入 message，库存不变。
+     */
+    bool applyPropEffect(const ShopItem::Rules& rules,
                          InventoryItem& entry,
                          const std::string& username,
                          std::string* message);
     bool markPhysicalRedeemed(InventoryItem& entry, const std::string& notes);
     bool markLuckyBagOpened(InventoryItem& entry, const std::string& payload);
 
+    /**
+     * @brief 丢弃某用户的库存缓存，下次查询时重新装载；购买事务回滚后调用，撤销已写入缓存的插入。
+     */
+    void discardCachedOwner(int ownerId);
+
     bool consumeEffectToken(const std::string& username, ShopItem::PropEffectType type);
     bool hasEffectToken(const std::string& username, ShopItem::PropEffectType type) const;
     double doubleExpMultiplier(const std::string& username) const;
 
+    [[nodiscard]] InventoryManagerSignalProxy* signalProxy() const noexcept;
+
+    /**
+     * @brief 估算道具效果表与按用户缓存的库存索引的内存，登记为 MemoryRegistry 的 "inventory"。
+     */
+    [[nodiscard]] metrics::MemoryUsage memoryUsage() const;
+
+    /**
+     * @brief 超出内存限额时只保留最近访问的用户（即当前会话用户）的库存缓存，其余用户下次访问时重新读库。
+     *        效果表记录的是生效中的道具状态，不可丢弃。
+     */
+    void trimMemory();
+
 private:
     InventoryManager();
 
     void ensureInitialized() const;
-    void cleanupExpiredEffectsLocked(const std::string& username) const;
-    void cleanupAllEffectsLocked() const;
+    [[nodiscard]] DatabaseManager& database() const;
+    void expireEffects();
+    void emitInserted(int ownerId, const QVector<int>& inventoryIds) const;
+    void emitUpdated(int inventoryId) const;
+    InventoryItem buildEntry(const ShopItem& item,
+                             int ownerId,
+                             int quantity,
+                             const std::string& specialAttributes) const;
+    void expireDueEffectsLocked(qint64 nowMs) const;
+    void scheduleNextExpiryLocked() const;
     void registerEffectLocked(const std::string& username,
                               ShopItem::PropEffectType type,
                               int durationMinutes,
                               int stackDelta = 1);
 
-    struct ActiveEffect {
+    static constexpr std::size_t kEffectTypeCount = 4;  //!< PropEffectType 的枚举值个数
+    static_assert(static_cast<std::size_t>(ShopItem::PropEffectType::DoubleExpCard) + 1 == kEffectTypeCount,
+                  "kEffectTypeCount 须与 PropEffectType 的枚举值个数一致");
+
+    /**
+     * @brief 单个用户的效果状态，按 PropEffectType 枚举值下标存放堆栈与到期时刻。
+     *        activeMask 标记堆栈大于 0 的效果，nextExpiryMs 为其中最早的到期时刻；二者只在登记、消费与到期回收时
+     *        由 refresh() 重算。当前时间早于 nextExpiryMs 时掩码中的效果必然都未到期，查询不再逐项比较时间。
+     */
+    struct EffectState {
+        std::uint32_t activeMask = 0;
+        std::array<int, kEffectTypeCount> stacks{};
+        std::array<qint64, kEffectTypeCount> expiresAtMs{};
+        qint64 nextExpiryMs = std::numeric_limits<qint64>::max();
+
+        [[nodiscard]] static std::uint32_t bit(ShopItem::PropEffectType type) noexcept {
+            return 1U << static_cast<std::size_t>(type);
+        }
+        [[nodiscard]] bool has(ShopItem::PropEffectType type, qint64 nowMs) const noexcept {
+            return (activeMask & bit(type)) != 0 &&
+                   (nowMs < nextExpiryMs || expiresAtMs[static_cast<std::size_t>(type)] > nowMs);
+        }
+        void clear(ShopItem::PropEffectType type) noexcept;
+        void refresh() noexcept;
+    };
+
+    /**
+     * @brief 最小堆中的到期项；效果被延长时压入新项，旧项出堆时与效果当前到期时间比对后忽略。
+     */
+    struct EffectDeadline {
+        qint64 expiresAtMs;
+        std::string username;
         ShopItem::PropEffectType type;
-        int stack;
-        QDateTime expiresAt;
+
+        bool operator>(const EffectDeadline& other) const noexcept { return expiresAtMs > other.expiresAtMs; }
+    };
+
+    /**
+     * @brief 单个用户的库存缓存。
+     *        byId 保存条目本身；idsByItem/quantityByItem 支撑限购校验；quantityByType 与 totalQuantity
+     *        对应 statisticsForOwner 的分类件数；byExpiration 按到期毫秒有序，“即将到期”统计为一次区间遍历。
+     *        计数均按 quantity 累加，与原先的 SUM(quantity) 聚合口径一致。
+     */
+    struct OwnerInventory {
+        struct Entry {
+            InventoryItem item;
+            std::optional<std::int64_t> expirationMs;
+        };
+
+        std::unordered_map<int, Entry> byId;
+        std::unordered_map<int, std::unordered_set<int>> idsByItem;
+        std::unordered_map<int, int> quantityByItem;
+        std::unordered_map<int, ShopItem::ItemType> typeByItem;  //!< 商品已删除时缺席，对应件数只计入总数
+        std::array<int, 3> quantityByType{};                     //!< 按 ItemType 枚举值下标
+        int totalQuantity = 0;
+        std::multimap<std::int64_t, int> byExpiration;  //!< 到期毫秒 -> 库存 id
+        std::uint64_t loadedGeneration = 0;             //!< 装载发布时的 m_cacheGeneration
     };
 
-    DatabaseManager* m_database;
-    mutable std::mutex m_mutex;
-    mutable std::unordered_map<std::string, std::vector<ActiveEffect>> m_effects;
+    void ensureOwnerLoaded(int ownerId) const;
+    static void indexEntry(OwnerInventory& cache, InventoryItem item, std::optional<std::int64_t> expirationMs);
+    static void unindexEntry(OwnerInventory& cache, int inventoryId);
+    /**
+     * @brief 写库成功后同步缓存：所属用户已装载时替换条目；type 为空时沿用缓存中该商品的类型。
+     */
+    void cacheUpsert(const InventoryItem& item, std::optional<ShopItem::ItemType> type = std::nullopt);
+    void cacheErase(int inventoryId);
+    void discardCacheOnRollback();
+    void settleLoadsAfterCommit();
+
+    using StateMutex = metrics::ProfiledMutex<std::shared_mutex>;
+
+    static constexpr std::size_t kMaxCachedOwners = 4;
+
+    std::atomic<DatabaseManager*> m_database;
+    mutable StateMutex m_mutex;
+    mutable std::unordered_map<std::string, EffectState> m_effects;
+    mutable std::priority_queue<EffectDeadline, std::vector<EffectDeadline>, std::greater<EffectDeadline>>
+        m_effectDeadlines;
+    std::unique_ptr<QTimer> m_expiryTimer;  //!< 单次定时器，始终对准堆顶的到期时刻。
+    std::unique_ptr<InventoryManagerSignalProxy> m_signalProxy;
+    mutable StateMutex m_cacheMutex;  //!< 保护 m_owners 与 m_cacheGeneration，与效果表的锁互不嵌套。
+    mutable std::unordered_map<int, OwnerInventory> m_owners;  //!< 按 users.id 索引
+    mutable std::deque<int> m_ownerLoadOrder;  //!< m_owners 的装载顺序，最早者在前，用于淘汰
+    mutable std::uint64_t m_cacheGeneration{0};  //!< 每次写入递增，装载期间有写入时丢弃装载结果重读。
+    mutable std::atomic<int> m_activeOwnerId{0};  //!< 最近一次访问库存的用户，trimMemory 保留其缓存
+    metrics::MemoryRegistration m_memoryRegistration;
 };
 
 }  // namespace rove::data
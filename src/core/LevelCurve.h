@@ -0,0 +1,84 @@
+#ifndef LEVELCURVE_H
+#define LEVELCURVE_H
+
+#include <array>
+#include <cstddef>
+#include <limits>
+
+namespace rove::data::levels {
+
+/**
+ * @file LevelCurve.h
+ * @brief 等级曲线：Level = 1 + floor(sqrt(成长值 / 100))，以编译期累计阈值表表示。
+ * 中文：User 与 GrowthSystem 共用这一张表，等级与“距下一级所需成长值”始终一致；
+ *       kLevelThresholds[L] 是达到 L 级所需的累计成长值，按等级取阈值为直接下标，按成长值求等级为二分查找，
+ *       一次发放大量成长值也只需一次查找即可得到最终等级。
+ */
+
+constexpr long long kPointsPerLevelStep = 100;
+
+/**
+ * @brief 阈值不超过 int 上限的最高等级；User 的成长值为 int，因此它也是可达的最高等级。
+ */
+constexpr int computeMaxLevel() noexcept {
+    long long step = 0;
+    while (kPointsPerLevelStep * (step + 1) * (step + 1) <= std::numeric_limits<int>::max()) {
+        ++step;
+    }
+    return static_cast<int>(step) + 1;
+}
+
+constexpr int kMaxLevel = computeMaxLevel();
+
+using ThresholdTable = std::array<int, static_cast<std::size_t>(kMaxLevel) + 1>;
+
+constexpr ThresholdTable makeThresholds() noexcept {
+    ThresholdTable table{};
+    for (int level = 1; level <= kMaxLevel; ++level) {
+        const long long step = level - 1;
+        table[static_cast<std::size_t>(level)] = static_cast<int>(kPointsPerLevelStep * step * step);
+    }
+    return table;
+}
+
+/**
+ * @brief 下标即等级，下标 0 不使用（与 1 级同为 0）。
+ */
+inline constexpr ThresholdTable kLevelThresholds = makeThresholds();
+
+/**
+ * @brief 达到 level 级所需的累计成长值；低于 1 级按 1 级处理，超过最高等级返回 int 上限。
+ */
+constexpr int thresholdForLevel(int level) noexcept {
+    if (level <= 1) {
+        return 0;
+    }
+    if (level > kMaxLevel) {
+        return std::numeric_limits<int>::max();
+    }
+    return kLevelThresholds[static_cast<std::size_t>(level)];
+}
+
+/**
+ * @brief 成长值对应的等级：在阈值表中二分查找最后一个不超过 points 的等级。
+ */
+constexpr int levelForPoints(int points) noexcept {
+    if (points <= 0) {
+        return 1;
+    }
+    int low = 1;
+    int high = kMaxLevel;
+    while (low < high) {
+        const int mid = low + (high - low + 1) / 2;
+        if (kLevelThresholds[static_cast<std::size_t>(mid)] <= points) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+}  // namespace rove::data::levels
+
+#endif  // LEVELCURVE_H
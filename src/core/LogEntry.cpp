@@ -1,12 +1,32 @@
 #include "LogEntry.h"
 
+#include "EnumText.h"
+#include "LogTemplate.h"
+
 namespace rove::data {
 
+namespace {
+constexpr EnumTextTable<LogEntry::LogType, 4> kLogTypeText{{{
+    {LogEntry::LogType::Auto, "Auto"},
+    {LogEntry::LogType::Manual, "Manual"},
+    {LogEntry::LogType::Milestone, "Milestone"},
+    {LogEntry::LogType::Event, "Event"},
+}}};
+
+constexpr EnumTextTable<LogEntry::MoodTag, 3> kMoodText{{{
+    {LogEntry::MoodTag::Happy, "😊"},
+    {LogEntry::MoodTag::Neutral, "😐"},
+    {LogEntry::MoodTag::Sad, "😔"},
+}}};
+}  // namespace
+
 LogEntry::LogEntry()
     : m_id(-1),
       m_timestamp(QDateTime::currentDateTime()),
       m_type(LogType::Auto),
       m_content(),
+      m_templateId(0),
+      m_templateArgs(),
       m_relatedId(),
       m_attributeChanges(),
       m_levelChange(0),
@@ -26,6 +46,8 @@ LogEntry::LogEntry(int id,
       m_timestamp(timestamp),
       m_type(type),
       m_content(std::move(content)),
+      m_templateId(0),
+      m_templateArgs(),
       m_relatedId(std::move(relatedId)),
       m_attributeChanges(std::move(attributeChanges)),
       m_levelChange(levelChange),
@@ -51,7 +73,21 @@ void LogEntry::setType(LogType type) noexcept { m_type = type; }
 
 const std::string& LogEntry::content() const noexcept { return m_content; }
 
-void LogEntry::setContent(std::string content) { m_content = std::move(content); }
+void LogEntry::setContent(std::string content) {
+    m_content = std::move(content);
+    m_templateId = 0;
+    m_templateArgs.clear();
+}
+
+void LogEntry::setTemplate(int templateId, std::string args) {
+    m_templateId = templateId;
+    m_templateArgs = std::move(args);
+    m_content = renderLogTemplate(m_templateId, m_templateArgs);
+}
+
+int LogEntry::templateId() const noexcept { return m_templateId; }
+
+const std::string& LogEntry::templateArgs() const noexcept { return m_templateArgs; }
 
 const std::optional<int>& LogEntry::relatedId() const noexcept { return m_relatedId; }
 
@@ -76,42 +112,17 @@ const std::optional<LogEntry::MoodTag>& LogEntry::mood() const noexcept { return
 void LogEntry::setMood(const std::optional<MoodTag>& mood) noexcept { m_mood = mood; }
 
 std::string LogEntry::moodToEmoji(LogEntry::MoodTag mood) {
-    switch (mood) {
-        case MoodTag::Happy:
-            return "😊";
-        case MoodTag::Neutral:
-            return "😐";
-        case MoodTag::Sad:
-            return "😔";
-    }
-    return "😐";  // 未知值时回退到中立，保持 UI 一致性。
+    return std::string(kMoodText.text(mood).value_or("😐"));  // 未知值时回退到中立，保持 UI 一致性。
 }
 
+std::optional<LogEntry::MoodTag> LogEntry::moodFromEmoji(std::string_view emoji) { return kMoodText.value(emoji); }
+
 std::string LogEntry::typeToString(LogEntry::LogType type) {
-    switch (type) {
-        case LogType::Auto:
-            return "Auto";
-        case LogType::Manual:
-            return "Manual";
-        case LogType::Milestone:
-            return "Milestone";
-        case LogType::Event:
-            return "Event";
-    }
-    return "Auto";  // 默认回退到自动日志，保持兼容性。
+    return std::string(kLogTypeText.text(type).value_or("Auto"));  // 默认回退到自动日志，保持兼容性。
 }
 
-LogEntry::LogType LogEntry::typeFromString(const std::string& text) {
-    if (text == "Manual") {
-        return LogType::Manual;
-    }
-    if (text == "Milestone") {
-        return LogType::Milestone;
-    }
-    if (text == "Event") {
-        return LogType::Event;
-    }
-    return LogType::Auto;
+LogEntry::LogType LogEntry::typeFromString(std::string_view text) {
+    return kLogTypeText.value(text).value_or(LogType::Auto);
 }
 
 }  // namespace rove::data
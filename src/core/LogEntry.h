@@ -5,6 +5,7 @@
 
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace rove::data {
@@ -65,9 +66,19 @@ public:
     [[nodiscard]] LogType type() const noexcept;
     void setType(LogType type) noexcept;
 
+    /**
+     * @brief 日志文本；模板日志在 setTemplate 时即渲染，访问不做任何计算。
+     */
     [[nodiscard]] const std::string& content() const noexcept;
     void setContent(std::string content);
 
+    /**
+     * @brief 改为模板日志：持久化时只保存模板编号与紧凑参数，内存中同时保留渲染后的文本。
+     */
+    void setTemplate(int templateId, std::string args);
+    [[nodiscard]] int templateId() const noexcept;
+    [[nodiscard]] const std::string& templateArgs() const noexcept;
+
     [[nodiscard]] const std::optional<int>& relatedId() const noexcept;
     void setRelatedId(const std::optional<int>& relatedId) noexcept;
 
@@ -88,6 +99,11 @@ public:
      */
     [[nodiscard]] static std::string moodToEmoji(MoodTag mood);
 
+    /**
+     * @brief 将数据库中的 emoji 还原为心情枚举，无法识别时返回空。
+     */
+    [[nodiscard]] static std::optional<MoodTag> moodFromEmoji(std::string_view emoji);
+
     /**
      * @brief 将日志类型转换为字符串，便于存储和过滤。
      */
@@ -96,13 +112,15 @@ public:
     /**
      * @brief 从字符串解析日志类型，兼容数据库字段。
      */
-    [[nodiscard]] static LogType typeFromString(const std::string& text);
+    [[nodiscard]] static LogType typeFromString(std::string_view text);
 
 private:
     int m_id;
     QDateTime m_timestamp;
     LogType m_type;
-    std::string m_content;
+    std::string m_content;  //!< 原文，模板日志为渲染后的文本
+    int m_templateId;       //!< LogTemplate 编号，0 表示 m_content 为原文
+    std::string m_templateArgs;
     std::optional<int> m_relatedId;
     std::vector<AttributeChange> m_attributeChanges;
     int m_levelChange;
@@ -0,0 +1,118 @@
+#include "LogEntryView.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <utility>
+
+#include "LogTemplate.h"
+
+namespace rove::data {
+
+LogEntryView::LogEntryView()
+    : m_record(),
+      m_type(LogEntry::LogType::Auto),
+      m_renderedContent(),
+      m_attributeChanges(),
+      m_moodParsed(false),
+      m_mood() {}
+
+LogEntryView::LogEntryView(DatabaseManager::LogRecord record)
+    : m_record(std::move(record)),
+      m_type(LogEntry::typeFromString(m_record.type)),
+      m_renderedContent(m_record.templateId != 0 ? renderLogTemplate(m_record.templateId, m_record.content)
+                                                 : std::string()),
+      m_attributeChanges(),
+      m_moodParsed(false),
+      m_mood() {}
+
+LogEntryView::LogEntryView(const LogEntry& entry)
+    : m_record(), m_type(entry.type()), m_renderedContent(entry.templateId() != 0 ? entry.content() : std::string()),
+      m_attributeChanges(entry.attributeChanges()),
+      m_moodParsed(true), m_mood(entry.mood()) {
+    m_record.id = entry.id();
+    m_record.timestampIso = entry.timestamp().toString(Qt::ISODate).toStdString();
+    m_record.timestampMs = entry.timestamp().toMSecsSinceEpoch();
+    m_record.type = LogEntry::typeToString(entry.type());
+    m_record.templateId = entry.templateId();
+    m_record.content = entry.templateId() != 0 ? entry.templateArgs() : entry.content();
+    m_record.relatedId = entry.relatedId();
+    m_record.levelChange = entry.levelChange();
+    m_record.specialEvent = entry.specialEvent();
+}
+
+int LogEntryView::id() const noexcept { return m_record.id; }
+
+std::int64_t LogEntryView::timestampMs() const noexcept { return m_record.timestampMs; }
+
+QDateTime LogEntryView::timestamp() const { return QDateTime::fromMSecsSinceEpoch(m_record.timestampMs); }
+
+LogEntry::LogType LogEntryView::type() const noexcept { return m_type; }
+
+const std::string& LogEntryView::content() const noexcept {
+    return m_record.templateId == 0 ? m_record.content : m_renderedContent;
+}
+
+const std::optional<int>& LogEntryView::relatedId() const noexcept { return m_record.relatedId; }
+
+int LogEntryView::levelChange() const noexcept { return m_record.levelChange; }
+
+const std::string& LogEntryView::specialEvent() const noexcept { return m_record.specialEvent; }
+
+const std::vector<LogEntry::AttributeChange>& LogEntryView::attributeChanges() const {
+    if (!m_attributeChanges.has_value()) {
+        m_attributeChanges = parseAttributeChanges(m_record.attributeChanges);
+    }
+    return *m_attributeChanges;
+}
+
+const std::optional<LogEntry::MoodTag>& LogEntryView::mood() const {
+    if (!m_moodParsed) {
+        m_mood = parseMood(m_record.mood);
+        m_moodParsed = true;
+    }
+    return m_mood;
+}
+
+LogEntry LogEntryView::toEntry() const {
+    LogEntry entry(m_record.id, timestamp(), m_type, m_record.templateId == 0 ? m_record.content : std::string(),
+                   m_record.relatedId, attributeChanges(), m_record.levelChange, m_record.specialEvent, mood());
+    if (m_record.templateId != 0) {
+        entry.setTemplate(m_record.templateId, m_record.content);
+    }
+    return entry;
+}
+
+std::vector<LogEntry::AttributeChange> LogEntryView::parseAttributeChanges(const std::string& text) {
+    std::vector<LogEntry::AttributeChange> changes;
+    auto json = QJsonDocument::fromJson(QByteArray::fromStdString(text));
+    if (!json.isArray()) {
+        return changes;
+    }
+    for (const auto& value : json.array()) {
+        if (!value.isObject()) {
+            continue;
+        }
+        auto obj = value.toObject();
+        LogEntry::AttributeChange change;
+        change.name = obj.value("name").toString().toStdString();
+        change.delta = obj.value("delta").toInt();
+        changes.push_back(change);
+    }
+    return changes;
+}
+
+std::optional<LogEntry::MoodTag> LogEntryView::parseMood(std::string_view text) {
+    if (text.empty()) {
+        return std::nullopt;
+    }
+    if (const auto mood = LogEntry::moodFromEmoji(text)) {
+        return mood;
+    }
+    qWarning() << "Unknown mood string from database:" << QString::fromStdString(std::string(text));
+    return std::nullopt;
+}
+
+}  // namespace rove::data
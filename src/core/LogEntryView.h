@@ -0,0 +1,87 @@
+#ifndef LOGENTRYVIEW_H
+#define LOGENTRYVIEW_H
+
+#include <QDateTime>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "DatabaseManager.h"
+#include "LogEntry.h"
+
+namespace rove::data {
+
+/**
+ * @class LogEntryView
+ * @brief 日志行的轻量只读视图，持有数据库原始记录，按需解析字段。
+ * 中文：时间戳直接取 timestamp_ms 整数列，排序与时间线定位无需解析 ISO 字符串；
+ *       属性变化（JSON）与心情仅在首次访问时解析并缓存，只显示时间与内容的界面不付出解析开销。
+ *       模板日志的文本在构造时渲染，content() 因此不修改状态。
+ *       视图不是线程安全的：属性变化与心情的缓存在 const 访问中惰性填充。
+ */
+class LogEntryView {
+public:
+    LogEntryView();
+
+    /**
+     * @brief 包装数据库读出的原始记录，除日志类型外不做任何解析。
+     */
+    explicit LogEntryView(DatabaseManager::LogRecord record);
+
+    /**
+     * @brief 由内存中的完整日志构造，属性变化与心情视为已解析。
+     */
+    explicit LogEntryView(const LogEntry& entry);
+
+    [[nodiscard]] int id() const noexcept;
+    [[nodiscard]] std::int64_t timestampMs() const noexcept;
+    [[nodiscard]] QDateTime timestamp() const;
+    [[nodiscard]] LogEntry::LogType type() const noexcept;
+    /**
+     * @brief 模板日志返回构造时渲染的文本，普通日志直接返回原文。
+     */
+    [[nodiscard]] const std::string& content() const noexcept;
+    [[nodiscard]] const std::optional<int>& relatedId() const noexcept;
+    [[nodiscard]] int levelChange() const noexcept;
+    [[nodiscard]] const std::string& specialEvent() const noexcept;
+
+    /**
+     * @brief 首次访问时解析属性变化 JSON。
+     */
+    [[nodiscard]] const std::vector<LogEntry::AttributeChange>& attributeChanges() const;
+
+    /**
+     * @brief 首次访问时解析心情 emoji。
+     */
+    [[nodiscard]] const std::optional<LogEntry::MoodTag>& mood() const;
+
+    /**
+     * @brief 展开为完整的 LogEntry，会解析全部字段。
+     */
+    [[nodiscard]] LogEntry toEntry() const;
+
+    /**
+     * @brief 解析属性变化 JSON 数组，非法内容返回空列表。
+     */
+    [[nodiscard]] static std::vector<LogEntry::AttributeChange> parseAttributeChanges(const std::string& text);
+
+    /**
+     * @brief 解析心情 emoji；空串表示无心情，未知内容告警后同样视为无心情。
+     */
+    [[nodiscard]] static std::optional<LogEntry::MoodTag> parseMood(std::string_view text);
+
+private:
+    DatabaseManager::LogRecord m_record;
+    LogEntry::LogType m_type;
+    std::string m_renderedContent;  //!< 模板日志渲染后的文本，普通日志为空
+    mutable std::optional<std::vector<LogEntry::AttributeChange>> m_attributeChanges;
+    mutable bool m_moodParsed;
+    mutable std::optional<LogEntry::MoodTag> m_mood;
+};
+
+}  // namespace rove::data
+
+#endif  // LOGENTRYVIEW_H
@@ -6,10 +6,20 @@
 #include <QJsonObject>
 
 #include <algorithm>
-#include <sstream>
+#include <chrono>
+#include <utility>
+
+#include "EventJournal.h"
 
 namespace rove::data {
 
+namespace {
+constexpr int kSnapshotIntervalMs = 15 * 60 * 1000;  //!< 周期快照间隔
+constexpr int kSnapshotDebounceMs = 3000;            //!< 突发请求的合并窗口
+constexpr std::size_t kLogGroupCommitSize = 64;      //!< 队列达到该条数时立即组提交
+constexpr auto kLogGroupCommitWindow = std::chrono::milliseconds(50);  //!< 首条日志入队后的最长攒批时间
+}  // namespace
+
 LogManager& LogManager::instance(DatabaseManager& database,
                                  UserManager& userManager,
                                  AchievementManager& achievementManager,
@@ -26,29 +36,91 @@ LogManager::LogManager(DatabaseManager& database,
       m_userManager(userManager),
       m_achievementManager(achievementManager),
       m_taskManager(taskManager),
-      m_forgivenLogIds(m_database.loadForgivenLogIds()) {
+      m_snapshotTimer(std::make_unique<QTimer>()),
+      m_snapshotDebounce(std::make_unique<QTimer>()),
+      m_snapshotPool(std::make_unique<QThreadPool>()),
+      m_policyMutex(),
+      m_retentionPolicy(),
+      m_snapshotPackingPolicy(),
+      m_clock(),
+      m_ownerId(userManager.hasActiveUser() ? userManager.activeUserId() : 0),
+      m_manualLogCount(-1),
+      m_forgivenLogIds(),
+      m_analyticsMutex(),
+      m_analytics(),
+      m_analyticsOwner(0),
+      m_logQueueMutex(),
+      m_logQueueReady(),
+      m_logCommitted(),
+      m_logQueue(),
+      m_logEnqueued(0),
+      m_logCommittedCount(0),
+      m_logFlushRequested(false),
+      m_logWriterStopping(false),
+      m_logWriter(),
+      m_memoryRegistration() {
+    m_snapshotPool->setMaxThreadCount(1);
+    m_snapshotDebounce->setSingleShot(true);
+    m_snapshotDebounce->setInterval(kSnapshotDebounceMs);
+    QObject::connect(m_snapshotDebounce.get(), &QTimer::timeout, this, [this]() { captureSnapshotInBackground(); });
+    m_snapshotTimer->setTimerType(Qt::VeryCoarseTimer);
+    m_snapshotTimer->setInterval(kSnapshotIntervalMs);
+    QObject::connect(m_snapshotTimer.get(), &QTimer::timeout, this, [this]() { requestSnapshot(); });
+    m_snapshotTimer->start();
+    m_logWriter = std::thread([this]() { runLogWriter(); });
     bindSystemEvents();
+    m_memoryRegistration = metrics::MemoryRegistry::instance().add(
+        "logs", [this]() { return memoryUsage(); }, [this]() { trimMemory(); });
+}
+
+LogManager::~LogManager() {
+    {
+        std::lock_guard<std::mutex> lock(m_logQueueMutex);
+        m_logWriterStopping = true;
+    }
+    m_logQueueReady.notify_one();
+    if (m_logWriter.joinable()) {
+        m_logWriter.join();  // 中文：写入线程退出前会提交队列中剩余的日志。
+    }
+    m_snapshotTimer->stop();
+    m_snapshotDebounce->stop();
+    m_snapshotPool->waitForDone();  // 中文：后台写入会访问 this，析构前必须全部结束。
 }
 
 void LogManager::bindSystemEvents() {
+    // 中文：上游信号在触发它的事务提交后才发出，连接固定为直连，自动日志在发出信号的线程上交给后台写线程组提交。
     QObject::connect(m_taskManager.signalProxy(), &TaskManagerSignalProxy::taskCompleted, this,
                      [this](int taskId, int, int difficulty) {
-                         std::ostringstream oss;
-                         oss << "任务完成：" << taskId << "，难度" << difficulty << "星";
-                         recordAutoLog(LogEntry::LogType::Auto, oss.str(), taskId, {}, 0, "TaskCompleted");
-                     });
+                         recordTemplatedLog(LogEntry::LogType::Auto, LogTemplate::TaskCompleted, {taskId, difficulty},
+                                            taskId, 0, "TaskCompleted", LogDelivery::FireAndForget);
+                     },
+                     Qt::DirectConnection);
     QObject::connect(&m_achievementManager, &AchievementManager::achievementUnlocked, this,
                      [this](int achievementId) {
-                         std::ostringstream oss;
-                         oss << "解锁成就：" << achievementId;
-                         recordAutoLog(LogEntry::LogType::Milestone, oss.str(), achievementId, {}, 0, "AchievementUnlocked");
-                     });
+                         recordTemplatedLog(LogEntry::LogType::Milestone, LogTemplate::AchievementUnlocked,
+                                            {achievementId}, achievementId, 0, "AchievementUnlocked",
+                                            LogDelivery::FireAndForget);
+                     },
+                     Qt::DirectConnection);
     QObject::connect(m_userManager.signalProxy(), &UserManagerSignalProxy::levelChanged, this,
                      [this](int newLevel) {
-                         std::ostringstream oss;
-                         oss << "等级提升至 " << newLevel;
-                         recordAutoLog(LogEntry::LogType::Event, oss.str(), std::nullopt, {}, 1, "LevelUp");
-                     });
+                         recordTemplatedLog(LogEntry::LogType::Event, LogTemplate::LevelUp, {newLevel}, std::nullopt,
+                                            1, "LevelUp", LogDelivery::FireAndForget);
+                     },
+                     Qt::DirectConnection);
+    QObject::connect(m_userManager.signalProxy(), &UserManagerSignalProxy::sessionChanged, this,
+                     [this](int userId) { onSessionChanged(userId); });
+}
+
+/**
+ * @brief 切换日志所属用户：手动日志计数与宽恕集合按用户缓存，置为未读取，下次使用时按新用户重读。
+ * 中文：成长分析在下次使用时按所属用户判断是否需要重新恢复；已入队的旧用户日志仍按入队时的用户写入。
+ */
+void LogManager::onSessionChanged(int userId) {
+    m_ownerId.store(userId);
+    m_manualLogCount = -1;
+    std::lock_guard<std::mutex> lock(m_forgivenMutex);
+    m_forgivenLogIds.reset();
 }
 
 int LogManager::recordAutoLog(LogEntry::LogType type,
@@ -56,23 +128,51 @@ int LogManager::recordAutoLog(LogEntry::LogType type,
                               const std::optional<int>& relatedId,
                               const std::vector<LogEntry::AttributeChange>& attributeChanges,
                               int levelChange,
-                              const std::string& specialEvent) {
-    LogEntry entry(-1, QDateTime::currentDateTime(), type, content, relatedId, attributeChanges, levelChange,
+                              const std::string& specialEvent,
+                              LogDelivery delivery) {
+    LogEntry entry(-1, now(), type, content, relatedId, attributeChanges, levelChange,
                    specialEvent, std::nullopt);
-    int id = persistLog(entry);
+    int id = persistLog(entry, delivery);
     return id;
 }
 
-int LogManager::recordManualLog(const std::string& content, LogEntry::MoodTag mood) {
-    LogEntry entry(-1, QDateTime::currentDateTime(), LogEntry::LogType::Manual, content, std::nullopt, {}, 0,
+int LogManager::recordTemplatedLog(LogEntry::LogType type,
+                                   LogTemplate logTemplate,
+                                   std::initializer_list<std::int64_t> args,
+                                   const std::optional<int>& relatedId,
+                                   int levelChange,
+                                   const std::string& specialEvent,
+                                   LogDelivery delivery) {
+    LogEntry entry(-1, now(), type, std::string(), relatedId, {}, levelChange, specialEvent, std::nullopt);
+    entry.setTemplate(static_cast<int>(logTemplate), encodeLogTemplateArgs(args));
+    return persistLog(entry, delivery);
+}
+
+int LogManager::recordManualLog(const std::string& content, LogEntry::MoodTag mood, LogDelivery delivery) {
+    EventJournal::instance().record(JournalCommand::ManualLog, m_ownerId.load(), 0, static_cast<std::int64_t>(mood),
+                                    content);
+    LogEntry entry(-1, now(), LogEntry::LogType::Manual, content, std::nullopt, {}, 0,
                    "Manual", mood);
-    return persistLog(entry);
+    return persistLog(entry, delivery);
 }
 
-int LogManager::recordMilestone(const std::string& content, const std::optional<int>& relatedAchievementId) {
-    LogEntry entry(-1, QDateTime::currentDateTime(), LogEntry::LogType::Milestone, content, relatedAchievementId,
+int LogManager::recordMilestone(const std::string& content,
+                                const std::optional<int>& relatedAchievementId,
+                                LogDelivery delivery) {
+    LogEntry entry(-1, now(), LogEntry::LogType::Milestone, content, relatedAchievementId,
                    {}, 0, "Milestone", std::nullopt);
-    return persistLog(entry);
+    return persistLog(entry, delivery);
+}
+
+void LogManager::flush() {
+    std::unique_lock<std::mutex> lock(m_logQueueMutex);
+    const std::uint64_t target = m_logEnqueued;
+    if (m_logCommittedCount >= target) {
+        return;
+    }
+    m_logFlushRequested = true;
+    m_logQueueReady.notify_one();
+    m_logCommitted.wait(lock, [this, target]() { return m_logCommittedCount >= target; });
 }
 
 std::vector<LogEntry> LogManager::filterLogs(const std::optional<LogEntry::LogType>& type,
@@ -81,31 +181,130 @@ std::vector<LogEntry> LogManager::filterLogs(const std::optional<LogEntry::LogTy
                                              const std::optional<LogEntry::MoodTag>& mood,
                                              const std::optional<std::string>& keyword,
                                              bool includeForgiven) const {
-    auto records = m_database.queryLogRecords(
-        type ? std::make_optional(LogEntry::typeToString(*type)) : std::nullopt, toIso(start), toIso(end),
-        mood ? std::make_optional(serializeMood(mood)) : std::nullopt, keyword);
-
     std::vector<LogEntry> result;
-    result.reserve(records.size());
-    for (const auto& record : records) {
-        if (!includeForgiven && m_forgivenLogIds.count(record.id) > 0) {
-            continue;
+    for (const auto& view : filterLogViews(type, start, end, mood, keyword, includeForgiven)) {
+        result.push_back(view.toEntry());
+    }
+    return result;
+}
+
+std::vector<LogEntryView> LogManager::filterLogViews(const std::optional<LogEntry::LogType>& type,
+                                                     const std::optional<QDateTime>& start,
+                                                     const std::optional<QDateTime>& end,
+                                                     const std::optional<LogEntry::MoodTag>& mood,
+                                                     const std::optional<std::string>& keyword,
+                                                     bool includeForgiven) const {
+    auto filter = toRecordFilter(type, start, end, mood, keyword);
+    filter.excludeForgiven = !includeForgiven;
+    std::vector<LogEntryView> result;
+    if (keyword.has_value() && !keyword->empty()) {
+        // 中文：关键词检索走 FTS5 索引，结果按相关度排序。
+        for (auto& record : m_database.searchLogRecords(filter)) {
+            result.emplace_back(std::move(record));
         }
-        result.push_back(fromRecord(record));
+        return result;
     }
+    m_database.streamLogRecords(filter, std::nullopt, [&](DatabaseManager::LogRecord& record) {
+        result.emplace_back(std::move(record));
+        return true;
+    });
     return result;
 }
 
+LogManager::LogWindow LogManager::filterLogWindow(const std::optional<LogEntry::LogType>& type,
+                                                  const std::optional<QDateTime>& start,
+                                                  const std::optional<QDateTime>& end,
+                                                  const std::optional<LogEntry::MoodTag>& mood,
+                                                  const std::optional<std::string>& keyword,
+                                                  const std::optional<DatabaseManager::LogCursor>& after,
+                                                  std::size_t pageSize,
+                                                  bool includeForgiven) const {
+    auto filter = toRecordFilter(type, start, end, mood, keyword);
+    filter.excludeForgiven = !includeForgiven;
+    auto page = m_database.queryLogPage(filter, after, pageSize);
+    LogWindow window;
+    window.entries.reserve(page.records.size());
+    for (auto& record : page.records) {
+        window.entries.emplace_back(std::move(record));
+    }
+    window.nextCursor = page.nextCursor;
+    return window;
+}
+
+std::vector<DatabaseManager::LogDailySummaryRecord> LogManager::archivedDailySummaries(
+    const std::optional<QDateTime>& start, const std::optional<QDateTime>& end) const {
+    return m_database.queryLogDailySummaries(m_ownerId.load(), toEpochMs(start), toEpochMs(end));
+}
+
 GrowthSnapshot LogManager::captureSnapshot() {
-    if (!m_userManager.hasActiveUser()) {
+    auto snapshot = buildSnapshot();
+    if (!snapshot.has_value()) {
         return GrowthSnapshot();
     }
+    const int ownerId = m_userManager.activeUserId();
+    snapshot->setId(m_database.insertGrowthSnapshot(toSnapshotRecord(*snapshot, ownerId)));
+    observeSnapshot(*snapshot, ownerId);
+    emit snapshotCaptured(*snapshot);
+    return *snapshot;
+}
+
+void LogManager::requestSnapshot() {
+    // 中文：窗口开启后不再重置，持续的事件流也至多每个窗口写一次，且不会被无限推迟。
+    if (!m_snapshotDebounce->isActive()) {
+        m_snapshotDebounce->start();
+    }
+}
+
+/**
+ * 中文说明：后台快照
+ * - 用户对象只在 GUI 线程访问，因此在此读取并组装好记录，工作线程只负责写库；
+ * - 单线程池保证快照按请求顺序写入，DatabaseManager 的写锁负责与 GUI 线程上的事务串行化；
+ * - 写入完成后以排队调用回到 LogManager 所在线程发出 snapshotCaptured，槽函数无需关心线程。
+ */
+void LogManager::captureSnapshotInBackground() {
+    auto pending = buildSnapshot();
+    if (!pending.has_value()) {
+        return;
+    }
+    // 中文：所属用户与快照内容一同在 GUI 线程确定，后台写入期间切换会话也不会记到新用户名下。
+    const int ownerId = m_userManager.activeUserId();
+    m_snapshotPool->start([this, snapshot = *pending, ownerId]() mutable {
+        try {
+            snapshot.setId(m_database.insertGrowthSnapshot(toSnapshotRecord(snapshot, ownerId)));
+            observeSnapshot(snapshot, ownerId);
+        } catch (const std::exception& e) {
+            qWarning() << "LogManager: 后台写入成长快照失败:" << e.what();
+            return;
+        }
+        QMetaObject::invokeMethod(this, [this, snapshot]() { emit snapshotCaptured(snapshot); }, Qt::QueuedConnection);
+    });
+}
+
+void LogManager::setClock(Clock clock) { m_clock = std::move(clock); }
+
+QDateTime LogManager::now() const { return m_clock ? m_clock() : QDateTime::currentDateTime(); }
+
+std::optional<GrowthSnapshot> LogManager::buildSnapshot() {
+    if (!m_userManager.hasActiveUser()) {
+        return std::nullopt;
+    }
     const User& user = m_userManager.activeUser();
     const auto& stats = user.progress();
-    GrowthSnapshot snapshot(-1, QDateTime::currentDateTime(), user.level(), user.growthPoints(), user.attributes(),
-                            stats.achievementsUnlocked, stats.totalTasksCompleted, stats.personalTasksCompleted,
-                            static_cast<int>(m_database.countManualLogs()));
+    const auto tasks = m_taskManager.taskTotals();  // 中文：完成/失败计数取自 task_stats，与成就判定同源。
+    return GrowthSnapshot(-1, now(), user.level(), user.growthPoints(), user.attributes(),
+                          stats.achievementsUnlocked, tasks.completed, tasks.failed, manualLogCount());
+}
+
+int LogManager::manualLogCount() {
+    if (m_manualLogCount < 0) {
+        m_manualLogCount = m_database.countManualLogs(m_ownerId.load());
+    }
+    return m_manualLogCount;
+}
+
+DatabaseManager::GrowthSnapshotRecord LogManager::toSnapshotRecord(const GrowthSnapshot& snapshot, int ownerId) {
     DatabaseManager::GrowthSnapshotRecord record{};
+    record.ownerId = ownerId;
     record.timestampIso = snapshot.timestamp().toString(Qt::ISODate).toStdString();
     record.userLevel = snapshot.level();
     record.growthPoints = snapshot.growthPoints();
@@ -119,67 +318,326 @@ GrowthSnapshot LogManager::captureSnapshot() {
     record.completedTasks = snapshot.completedTasks();
     record.failedTasks = snapshot.failedTasks();
     record.manualLogCount = snapshot.manualLogCount();
-    int id = m_database.insertGrowthSnapshot(record);
-    snapshot.setId(id);
-    emit snapshotCaptured(snapshot);
-    return snapshot;
+    return record;
+}
+
+DatabaseManager::SnapshotResolution LogManager::chooseSnapshotResolution(int ownerId,
+                                                                         const std::optional<std::int64_t>& startMs,
+                                                                         const std::optional<std::int64_t>& endMs) const {
+    // 中文：按时间跨度估算各分辨率的行数，选取不超过预算的最细分辨率，不再逐级 COUNT；
+    //       像素级降采样交给 GrowthVisualizer，此处只保证读取量与时间跨度无关。
+    //       原始快照除定时写入外还有事件触发的写入，按定时间隔的一半估算原始行密度。
+    constexpr std::int64_t kMaxSnapshotQueryPoints = 2000;
+    constexpr std::int64_t kRawSpacingMs = kSnapshotIntervalMs / 2;
+    constexpr std::int64_t kHourMs = 60LL * 60 * 1000;
+    constexpr std::int64_t kDayMs = 24 * kHourMs;
+    const std::optional<std::int64_t> first = startMs ? startMs : m_database.growthTimelineStartMs(ownerId);
+    if (!first.has_value()) {
+        return DatabaseManager::SnapshotResolution::Raw;
+    }
+    const std::int64_t last = endMs.value_or(now().toMSecsSinceEpoch());
+    const std::int64_t span = std::max<std::int64_t>(0, last - *first);
+    if (span / kRawSpacingMs <= kMaxSnapshotQueryPoints) {
+        return DatabaseManager::SnapshotResolution::Raw;
+    }
+    if (span / kHourMs <= kMaxSnapshotQueryPoints) {
+        return DatabaseManager::SnapshotResolution::Hourly;
+    }
+    if (span / kDayMs <= kMaxSnapshotQueryPoints) {
+        return DatabaseManager::SnapshotResolution::Daily;
+    }
+    return DatabaseManager::SnapshotResolution::Weekly;
 }
 
 std::vector<GrowthSnapshot> LogManager::querySnapshots(const std::optional<QDateTime>& start,
                                                        const std::optional<QDateTime>& end) const {
-    auto records = m_database.queryGrowthSnapshots(toIso(start), toIso(end));
+    const int ownerId = m_ownerId.load();
+    const auto startMs = toEpochMs(start);
+    const auto endMs = toEpochMs(end);
+    const auto resolution = chooseSnapshotResolution(ownerId, startMs, endMs);
+    auto records = m_database.queryGrowthTimeline(ownerId, resolution, startMs, endMs);
     std::vector<GrowthSnapshot> snapshots;
     snapshots.reserve(records.size());
     for (const auto& record : records) {
-        GrowthSnapshot snapshot(record.id, QDateTime::fromString(QString::fromStdString(record.timestampIso), Qt::ISODate),
+        GrowthSnapshot snapshot(record.id, QDateTime::fromMSecsSinceEpoch(record.timestampMs),
                                 record.userLevel, record.growthPoints,
                                 User::AttributeSet{record.execution, record.perseverance, record.decision, record.knowledge,
                                                    record.social, record.pride},
                                 record.achievementCount, record.completedTasks, record.failedTasks, record.manualLogCount);
         snapshots.push_back(snapshot);
     }
-    constexpr std::size_t kMaxSnapshotDisplayPoints = 200;
-    if (snapshots.size() > kMaxSnapshotDisplayPoints) {
-        std::vector<GrowthSnapshot> compressed;
-        const std::size_t step = (snapshots.size() + kMaxSnapshotDisplayPoints - 1) / kMaxSnapshotDisplayPoints;
-        for (std::size_t i = 0; i < snapshots.size(); i += step) {
-            compressed.push_back(snapshots[i]);
+    return snapshots;
+}
+
+SnapshotSeries LogManager::querySnapshotSeries(const std::optional<QDateTime>& start,
+                                              const std::optional<QDateTime>& end) const {
+    const int ownerId = m_ownerId.load();
+    const auto startMs = toEpochMs(start);
+    const auto endMs = toEpochMs(end);
+    return m_database.querySnapshotSeries(ownerId, chooseSnapshotResolution(ownerId, startMs, endMs), startMs, endMs);
+}
+
+PointInTimeState LogManager::stateAt(const QDateTime& at, bool withInventory) const {
+    return StateHistory(m_database).stateAt(m_ownerId.load(), at.toMSecsSinceEpoch(), withInventory);
+}
+
+GrowthAnalytics::Insights LogManager::growthInsights(GrowthAnalytics::Window window) {
+    std::unique_lock<std::mutex> lock(m_analyticsMutex);
+    return analyticsLocked(lock, m_ownerId.load()).insights(window);
+}
+
+void LogManager::observeSnapshot(const GrowthSnapshot& snapshot, int ownerId) {
+    const std::int64_t timestampMs = snapshot.timestamp().toMSecsSinceEpoch();
+    const auto& attributes = snapshot.attributes();
+    const SnapshotSeries::Row values{snapshot.level(),          snapshot.growthPoints(),   attributes.execution,
+                                     attributes.perseverance,   attributes.decision,       attributes.knowledge,
+                                     attributes.social,         attributes.pride,          snapshot.achievementCount(),
+                                     snapshot.completedTasks(), snapshot.failedTasks(),    snapshot.manualLogCount()};
+    std::string state;
+    std::int64_t watermark = 0;
+    {
+        std::unique_lock<std::mutex> lock(m_analyticsMutex);
+        auto& analytics = analyticsLocked(lock, ownerId);
+        analytics.observe(timestampMs, snapshotDay(timestampMs), values);
+        state = analytics.encode();
+        watermark = analytics.lastSampleMs().value_or(timestampMs);
+    }
+    // 中文：调用线程可能持有数据库事务，保存放在分析锁之外，避免与后台线程形成“分析锁 → 写锁”的环。
+    m_database.saveGrowthAnalyticsState(ownerId, watermark, state);
+}
+
+GrowthAnalytics& LogManager::analyticsLocked(std::unique_lock<std::mutex>& lock, int ownerId) {
+    if (m_analytics.has_value() && m_analyticsOwner == ownerId) {
+        return *m_analytics;
+    }
+    // 中文：切换用户后只保留一份状态；前一用户的状态已随每条快照保存，切回时从数据库恢复。
+    lock.unlock();
+    GrowthAnalytics loaded = loadAnalytics(ownerId);
+    lock.lock();
+    if (!m_analytics.has_value() || m_analyticsOwner != ownerId) {
+        m_analytics = std::move(loaded);
+        m_analyticsOwner = ownerId;
+    }
+    return *m_analytics;
+}
+
+GrowthAnalytics LogManager::loadAnalytics(int ownerId) const {
+    GrowthAnalytics analytics;
+    if (const auto blob = m_database.loadGrowthAnalyticsState(ownerId); blob.has_value()) {
+        if (auto restored = GrowthAnalytics::decode(*blob); restored.has_value()) {
+            analytics = std::move(*restored);
         }
-        snapshots.swap(compressed);
     }
-    return snapshots;
+    if (const auto watermark = analytics.lastSampleMs(); watermark.has_value()) {
+        // 中文：只补读水位之后的快照，正常退出时为空，写入快照后、保存状态前退出才会有一两条。
+        analytics.observeSeries(
+            m_database.querySnapshotSeries(ownerId, DatabaseManager::SnapshotResolution::Raw, *watermark + 1,
+                                           std::nullopt),
+            snapshotDay);
+    } else {
+        // 中文：从未保存过（或格式已变更）时按每日聚合重建，每天只有一行收盘值。
+        analytics.observeSeries(
+            m_database.querySnapshotSeries(ownerId, DatabaseManager::SnapshotResolution::Daily, std::nullopt,
+                                           std::nullopt),
+            snapshotDay);
+    }
+    return analytics;
+}
+
+std::int64_t LogManager::snapshotDay(std::int64_t timestampMs) {
+    return QDateTime::fromMSecsSinceEpoch(timestampMs).date().toJulianDay();
 }
 
 void LogManager::forgiveLog(int logId) {
-    if (m_database.markLogForgiven(logId)) {
-        m_forgivenLogIds.insert(logId);
+    EventJournal::instance().record(JournalCommand::ForgiveLog, m_ownerId.load(), logId);
+    if (!m_database.markLogForgiven(logId)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_forgivenMutex);
+    if (m_forgivenLogIds.has_value()) {
+        m_forgivenLogIds->insert(logId);
+    }
+}
+
+SortedIdSet LogManager::forgivenLogIds() {
+    std::unique_lock<std::mutex> lock(m_forgivenMutex);
+    if (!m_forgivenLogIds.has_value()) {
+        // 中文：读库期间不持有集合锁；其间若有 forgiveLog 或会话切换，以先装入者为准，后者的结果仍是有效快照。
+        lock.unlock();
+        SortedIdSet loaded = m_database.loadForgivenLogIds(m_ownerId.load());
+        lock.lock();
+        if (!m_forgivenLogIds.has_value()) {
+            m_forgivenLogIds = std::move(loaded);
+        }
+    }
+    return *m_forgivenLogIds;
+}
+
+metrics::MemoryUsage LogManager::memoryUsage() const {
+    metrics::MemoryUsage usage;
+    {
+        std::lock_guard<std::mutex> lock(m_forgivenMutex);
+        if (m_forgivenLogIds.has_value()) {
+            usage.entries += m_forgivenLogIds->size();
+            usage.bytes += metrics::heapBytes(m_forgivenLogIds->ids());
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_logQueueMutex);
+        usage.entries += m_logQueue.size();
+        usage.bytes += metrics::heapBytes(m_logQueue);
+        for (const auto& pending : m_logQueue) {
+            usage.bytes += metrics::heapBytes(pending.entry.content()) + metrics::heapBytes(pending.record.content);
+        }
+    }
+    std::lock_guard<std::mutex> lock(m_analyticsMutex);
+    if (m_analytics.has_value()) {
+        usage.bytes += sizeof(GrowthAnalytics);
+    }
+    return usage;
+}
+
+void LogManager::trimMemory() {
+    std::lock_guard<std::mutex> lock(m_forgivenMutex);
+    m_forgivenLogIds.reset();
+}
+
+void LogManager::setRetentionPolicy(const DatabaseManager::LogRetentionPolicy& policy) {
+    std::lock_guard<std::mutex> lock(m_policyMutex);
+    m_retentionPolicy = policy;
+}
+
+void LogManager::setSnapshotPackingPolicy(const DatabaseManager::SnapshotPackingPolicy& policy) {
+    std::lock_guard<std::mutex> lock(m_policyMutex);
+    m_snapshotPackingPolicy = policy;
+}
+
+/**
+ * 中文说明：日志维护
+ * - 压缩把超出保留期的 Auto 日志汇总后移入归档库，主库只保留近期明细与全部手动/里程碑日志；
+ * - 归档之后再把留在主库的冷日志正文压缩存储，先归档可避免刚压缩的行随即被移走；
+ * - 旧的成长快照每满一块打包为关键帧加差分的快照块；
+ * - 空闲页回收与 WAL 截断是 MaintenanceScheduler 的独立任务，在本任务之后执行。
+ */
+std::size_t LogManager::runMaintenance(std::int64_t nowMs) {
+    DatabaseManager::LogRetentionPolicy policy;
+    DatabaseManager::SnapshotPackingPolicy packing;
+    {
+        std::lock_guard<std::mutex> lock(m_policyMutex);
+        policy = m_retentionPolicy;
+        packing = m_snapshotPackingPolicy;
+    }
+    const std::size_t archived = m_database.compactLogs(policy, nowMs);
+    if (archived > 0) {
+        QMetaObject::invokeMethod(this, [this, archived]() { emit logsCompacted(archived); }, Qt::QueuedConnection);
     }
+    m_database.compressColdLogs(policy, nowMs);
+    m_database.packGrowthSnapshots(packing, nowMs);
+    return archived;
 }
 
-int LogManager::persistLog(const LogEntry& entry) {
+int LogManager::persistLog(const LogEntry& entry, LogDelivery delivery) {
+    DatabaseManager::LogRecord record = toLogRecord(entry);
+    // 中文：调用线程处于事务（例如 UnitOfWork）中时直接并入该事务，与触发它的业务写入一起提交，
+    //       不再交给后台写线程另行提交；logInserted 推迟到事务提交之后发出，回滚的日志不会通知界面。
+    if (delivery == LogDelivery::FireAndForget && !m_database.inTransaction()) {
+        {
+            std::lock_guard<std::mutex> lock(m_logQueueMutex);
+            m_logQueue.push_back(PendingLog{entry, std::move(record)});
+            ++m_logEnqueued;
+        }
+        m_logQueueReady.notify_one();
+        return -1;
+    }
+    int id = m_database.insertLogRecord(record);
+    LogEntry persisted = entry;
+    persisted.setId(id);
+    m_database.runAfterCommit(
+        [this, persisted = std::move(persisted), ownerId = record.ownerId]() { publishLog(persisted, ownerId); });
+    return id;
+}
+
+DatabaseManager::LogRecord LogManager::toLogRecord(const LogEntry& entry) const {
     DatabaseManager::LogRecord record{};
     record.timestampIso = entry.timestamp().toString(Qt::ISODate).toStdString();
     record.type = LogEntry::typeToString(entry.type());
-    record.content = entry.content();
+    record.templateId = entry.templateId();
+    record.content = entry.templateId() != 0 ? entry.templateArgs() : entry.content();
     record.relatedId = entry.relatedId();
     record.attributeChanges = serializeAttributeChanges(entry.attributeChanges());
     record.levelChange = entry.levelChange();
     record.specialEvent = entry.specialEvent();
     record.mood = serializeMood(entry.mood());
-    int id = m_database.insertLogRecord(record);
-    LogEntry persisted = entry;
-    persisted.setId(id);
-    emit logInserted(persisted);
-    return id;
+    record.ownerId = m_ownerId.load();
+    return record;
+}
+
+/**
+ * @brief 日志落盘后的统一收尾：维护手动日志计数、通知界面并请求快照，始终在 LogManager 所在线程执行。
+ * 中文：会话切换前入队、切换后才提交的日志属于前一用户，不计入当前用户的手动日志数。
+ */
+void LogManager::publishLog(const LogEntry& entry, int ownerId) {
+    if (entry.type() == LogEntry::LogType::Manual && m_manualLogCount >= 0 && ownerId == m_ownerId.load()) {
+        ++m_manualLogCount;
+    }
+    emit logInserted(entry);
+    requestSnapshot();  // 中文：每条日志都对应一次有意义的成长事件。
 }
 
-LogEntry LogManager::fromRecord(const DatabaseManager::LogRecord& record) const {
-    LogEntry entry(record.id,
-                   QDateTime::fromString(QString::fromStdString(record.timestampIso), Qt::ISODate),
-                   LogEntry::typeFromString(record.type), record.content, record.relatedId,
-                   deserializeAttributeChanges(record.attributeChanges), record.levelChange, record.specialEvent,
-                   deserializeMood(record.mood));
-    return entry;
+/**
+ * 中文说明：异步日志写入线程（组提交）
+ * - 首条日志到达后最多再等 kLogGroupCommitWindow，期间攒满 kLogGroupCommitSize 条、收到 flush 或停止请求则立即提交；
+ * - 整批在一个事务内写入，调用方不再因逐条写日志而延长自身事务持有写锁的时间；
+ * - 提交成功后把带主键的日志排队投递回 LogManager 所在线程发出 logInserted；失败时整批丢弃并告警，
+ *   已处理计数照常推进，flush 不会因此永久阻塞。
+ */
+void LogManager::runLogWriter() {
+    std::unique_lock<std::mutex> lock(m_logQueueMutex);
+    while (true) {
+        m_logQueueReady.wait(lock, [this]() { return m_logWriterStopping || !m_logQueue.empty(); });
+        if (m_logQueue.empty()) {
+            return;  // 中文：仅在停止且队列已清空时退出。
+        }
+        m_logQueueReady.wait_for(lock, kLogGroupCommitWindow, [this]() {
+            return m_logWriterStopping || m_logFlushRequested || m_logQueue.size() >= kLogGroupCommitSize;
+        });
+        std::vector<PendingLog> batch = std::exchange(m_logQueue, {});
+        const std::uint64_t batchEnd = m_logEnqueued;
+        m_logFlushRequested = false;
+        lock.unlock();
+
+        std::vector<DatabaseManager::LogRecord> records;
+        records.reserve(batch.size());
+        for (const auto& pending : batch) {
+            records.push_back(pending.record);
+        }
+        std::vector<int> ids;
+        try {
+            ids = m_database.insertLogRecords(records);
+        } catch (const std::exception& e) {
+            qWarning() << "LogManager: 批量写入日志失败，丢弃" << static_cast<int>(batch.size()) << "条:" << e.what();
+        }
+        if (ids.size() == batch.size()) {
+            std::vector<std::pair<LogEntry, int>> committed;
+            committed.reserve(batch.size());
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                committed.emplace_back(std::move(batch[i].entry), batch[i].record.ownerId);
+                committed.back().first.setId(ids[i]);
+            }
+            QMetaObject::invokeMethod(
+                this,
+                [this, committed = std::move(committed)]() {
+                    for (const auto& [entry, ownerId] : committed) {
+                        publishLog(entry, ownerId);
+                    }
+                },
+                Qt::QueuedConnection);
+        }
+
+        lock.lock();
+        m_logCommittedCount = batchEnd;
+        m_logCommitted.notify_all();
+    }
 }
 
 std::string LogManager::serializeAttributeChanges(const std::vector<LogEntry::AttributeChange>& changes) const {
@@ -193,25 +651,6 @@ std::string LogManager::serializeAttributeChanges(const std::vector<LogEntry::At
     return QString(QJsonDocument(array).toJson(QJsonDocument::Compact)).toStdString();
 }
 
-std::vector<LogEntry::AttributeChange> LogManager::deserializeAttributeChanges(const std::string& text) const {
-    std::vector<LogEntry::AttributeChange> changes;
-    auto json = QJsonDocument::fromJson(QString::fromStdString(text).toUtf8());
-    if (!json.isArray()) {
-        return changes;
-    }
-    for (const auto& value : json.array()) {
-        if (!value.isObject()) {
-            continue;
-        }
-        auto obj = value.toObject();
-        LogEntry::AttributeChange change;
-        change.name = obj.value("name").toString().toStdString();
-        change.delta = obj.value("delta").toInt();
-        changes.push_back(change);
-    }
-    return changes;
-}
-
 std::string LogManager::serializeMood(const std::optional<LogEntry::MoodTag>& mood) {
     if (!mood.has_value()) {
         return {};
@@ -219,25 +658,26 @@ std::string LogManager::serializeMood(const std::optional<LogEntry::MoodTag>& mo
     return LogEntry::moodToEmoji(*mood);
 }
 
-std::optional<LogEntry::MoodTag> LogManager::deserializeMood(const std::string& text) {
-    if (text == "😊") {
-        return LogEntry::MoodTag::Happy;
-    }
-    if (text == "😐") {
-        return LogEntry::MoodTag::Neutral;
-    }
-    if (text == "😔") {
-        return LogEntry::MoodTag::Sad;
-    }
-    qWarning() << "Unknown mood string from database:" << QString::fromStdString(text);
-    return std::nullopt;
+DatabaseManager::LogFilter LogManager::toRecordFilter(const std::optional<LogEntry::LogType>& type,
+                                                      const std::optional<QDateTime>& start,
+                                                      const std::optional<QDateTime>& end,
+                                                      const std::optional<LogEntry::MoodTag>& mood,
+                                                      const std::optional<std::string>& keyword) const {
+    DatabaseManager::LogFilter filter;
+    filter.ownerId = m_ownerId.load();
+    filter.type = type ? std::make_optional(LogEntry::typeToString(*type)) : std::nullopt;
+    filter.startMs = toEpochMs(start);
+    filter.endMs = toEpochMs(end);
+    filter.mood = mood ? std::make_optional(serializeMood(mood)) : std::nullopt;
+    filter.keyword = keyword;
+    return filter;
 }
 
-std::optional<std::string> LogManager::toIso(const std::optional<QDateTime>& time) {
+std::optional<std::int64_t> LogManager::toEpochMs(const std::optional<QDateTime>& time) {
     if (!time.has_value()) {
         return std::nullopt;
     }
-    return time->toString(Qt::ISODate).toStdString();
+    return time->toMSecsSinceEpoch();
 }
 
 }  // namespace rove::data
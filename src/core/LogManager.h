@@ -2,16 +2,29 @@
 #define LOGMANAGER_H
 
 #include <QObject>
+#include <QThreadPool>
+#include <QTimer>
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
-#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "AchievementManager.h"
 #include "DatabaseManager.h"
+#include "GrowthAnalytics.h"
 #include "GrowthSnapshot.h"
 #include "LogEntry.h"
+#include "LogEntryView.h"
+#include "LogTemplate.h"
+#include "MemoryAccounting.h"
+#include "StateHistory.h"
 #include "TaskManager.h"
 #include "UserManager.h"
 
@@ -21,6 +34,7 @@ namespace rove::data {
  * @class LogManager
  * @brief 日志管理器单例，负责自动与手动日志写入、过滤查询以及成长快照采集。
  * 中文：LogManager 与任务、成就、用户系统联动，自动捕获事件并写入不可变日志，同时定期采集成长快照供可视化使用。
+ *       日志、快照与成长分析均属于当前登录用户；会话切换后查询只返回新用户的数据，按用户缓存的计数随之失效。
  */
 class LogManager : public QObject {
     Q_OBJECT
@@ -38,7 +52,14 @@ public:
     LogManager& operator=(const LogManager&) = delete;
     LogManager(LogManager&&) = delete;
     LogManager& operator=(LogManager&&) = delete;
-    ~LogManager() override = default;
+    ~LogManager() override;
+
+    /**
+     * @brief 日志送达方式。
+     * 中文：Durable 在调用线程同步写入（调用方持有事务时并入该事务）并返回主键；
+     *       FireAndForget 仅入队并返回 -1，由写入线程按批组提交，logInserted 在批次提交后发出。
+     */
+    enum class LogDelivery { Durable, FireAndForget };
 
     /**
      * @brief 记录自动日志，例如任务完成、升级、解锁成就。
@@ -48,20 +69,44 @@ public:
                       const std::optional<int>& relatedId,
                       const std::vector<LogEntry::AttributeChange>& attributeChanges,
                       int levelChange,
-                      const std::string& specialEvent);
+                      const std::string& specialEvent,
+                      LogDelivery delivery = LogDelivery::Durable);
+
+    /**
+     * @brief 记录模板自动日志：只存模板编号与整数参数，写入时不格式化文案。
+     */
+    int recordTemplatedLog(LogEntry::LogType type,
+                           LogTemplate logTemplate,
+                           std::initializer_list<std::int64_t> args,
+                           const std::optional<int>& relatedId,
+                           int levelChange,
+                           const std::string& specialEvent,
+                           LogDelivery delivery = LogDelivery::Durable);
 
     /**
      * @brief 记录手动日志（平凡事迹），带有心情表情。
      */
-    int recordManualLog(const std::string& content, LogEntry::MoodTag mood);
+    int recordManualLog(const std::string& content,
+                        LogEntry::MoodTag mood,
+                        LogDelivery delivery = LogDelivery::Durable);
 
     /**
      * @brief 添加里程碑日志，用于重大节点标记。
      */
-    int recordMilestone(const std::string& content, const std::optional<int>& relatedAchievementId);
+    int recordMilestone(const std::string& content,
+                        const std::optional<int>& relatedAchievementId,
+                        LogDelivery delivery = LogDelivery::Durable);
+
+    /**
+     * @brief 阻塞到调用前入队的日志全部提交，供退出与测试使用。
+     * 中文：对应的 logInserted 仍经排队连接稍后发出。写入线程需要数据库写锁，
+     *       因此不可在持有数据库事务的线程上调用，否则会死锁。
+     */
+    void flush();
 
     /**
      * @brief 按过滤条件检索日志，支持时间区间、类型、心情和关键词。
+     * 中文：无关键词时按时间升序；带关键词时走全文索引并按相关度排序。
      */
     [[nodiscard]] std::vector<LogEntry> filterLogs(const std::optional<LogEntry::LogType>& type,
                                                   const std::optional<QDateTime>& start,
@@ -71,24 +116,144 @@ public:
                                                   bool includeForgiven = false) const;
 
     /**
-     * @brief 采集当前成长快照并写入数据库。
+     * @brief 与 filterLogs 条件相同，但返回惰性解析的只读视图，适合只读取部分字段的调用方。
+     */
+    [[nodiscard]] std::vector<LogEntryView> filterLogViews(const std::optional<LogEntry::LogType>& type,
+                                                          const std::optional<QDateTime>& start,
+                                                          const std::optional<QDateTime>& end,
+                                                          const std::optional<LogEntry::MoodTag>& mood,
+                                                          const std::optional<std::string>& keyword,
+                                                          bool includeForgiven = false) const;
+
+    /**
+     * @brief 日志分页结果；nextCursor 为空表示没有更多日志。
+     */
+    struct LogWindow {
+        std::vector<LogEntryView> entries;
+        std::optional<DatabaseManager::LogCursor> nextCursor;
+    };
+
+    /**
+     * @brief 按过滤条件读取一页日志，供日志面板只加载可见窗口。
+     * 中文：基于 (timestamp, id) 键集分页；被宽恕的日志在 SQL 中排除，每页都是满页。
+     */
+    [[nodiscard]] LogWindow filterLogWindow(const std::optional<LogEntry::LogType>& type,
+                                            const std::optional<QDateTime>& start,
+                                            const std::optional<QDateTime>& end,
+                                            const std::optional<LogEntry::MoodTag>& mood,
+                                            const std::optional<std::string>& keyword,
+                                            const std::optional<DatabaseManager::LogCursor>& after,
+                                            std::size_t pageSize,
+                                            bool includeForgiven = false) const;
+
+    /**
+     * @brief 当前用户已归档 Auto 日志的按天汇总，区间按 [start, end] 与汇总行的首末时间重叠判断。
+     * 中文：维护把超出保留期的 Auto 明细移入归档库，主库只留按天、按事件的汇总；日志面板据此展示被归档的部分。
+     */
+    [[nodiscard]] std::vector<DatabaseManager::LogDailySummaryRecord> archivedDailySummaries(
+        const std::optional<QDateTime>& start, const std::optional<QDateTime>& end) const;
+
+    /**
+     * @brief 采集当前成长快照并同步写入数据库。
      */
     GrowthSnapshot captureSnapshot();
 
     /**
-     * @brief 查询指定时间段的成长快照，内部自动压缩冗余节点。
+     * @brief 请求一次后台快照采集；短时间内的多次请求合并为一次。
+     * 中文：用户状态在 GUI 线程读取，写库交给后台线程，完成后经排队连接发出 snapshotCaptured。
+     *       定时器也会周期性调用本函数；写日志（任务完成、升级、解锁成就等）会自动触发请求。
+     */
+    void requestSnapshot();
+
+    /**
+     * @brief 查询指定时间段的成长快照；跨度较长时自动改读小时/天/周聚合表，返回行数有上限。
      */
     [[nodiscard]] std::vector<GrowthSnapshot> querySnapshots(const std::optional<QDateTime>& start,
                                                             const std::optional<QDateTime>& end) const;
 
+    /**
+     * @brief 以列式 SnapshotSeries 返回同一时间线，分辨率选择规则与 querySnapshots 相同。
+     * 中文：看板只需成长值与坐标轴范围，跳过逐行构造 GrowthSnapshot 与 QDateTime。
+     */
+    [[nodiscard]] SnapshotSeries querySnapshotSeries(const std::optional<QDateTime>& start,
+                                                     const std::optional<QDateTime>& end) const;
+
+    /**
+     * @brief 重建当前用户在 at 时刻的等级、成长值、属性与持有库存，供看板时间轴拖动时展示。
+     * 中文：以最近的更早快照为起点回放变化记录，见 StateHistory。
+     */
+    [[nodiscard]] PointInTimeState stateAt(const QDateTime& at, bool withInventory = true) const;
+
+    /**
+     * @brief 成长趋势分析结果：移动平均、属性速度、完成连击与每日成长分位带。
+     * 中文：每条新快照写入后增量更新并持久化；首次调用时恢复已保存的状态，只补读水位之后的快照，
+     *       从未保存过时用每日聚合表重建一次。可在任意线程调用；恢复时的数据库读取不持有分析锁，
+     *       锁顺序始终是“数据库 → m_analyticsMutex”，调用方持有事务时也不会与后台快照线程互锁。
+     */
+    [[nodiscard]] GrowthAnalytics::Insights growthInsights(GrowthAnalytics::Window window);
+
     /**
      * @brief 标记一条日志为“宽恕”隐藏，用于负面记录美化折线图。
+     * 中文：已加载的宽恕集合就地插入该 ID，无需重新读取整张表。
      */
     void forgiveLog(int logId);
 
+    /**
+     * @brief 已宽恕日志 ID 集合的副本，首次访问时从数据库加载，之后随 forgiveLog 增量更新。
+     * 中文：日志列表查询已在 SQL 中排除宽恕日志，此集合供成长折线图等逐条判断的调用方使用；
+     *       返回副本而非引用，内存面板随时可能在其他线程丢弃缓存。
+     */
+    [[nodiscard]] SortedIdSet forgivenLogIds();
+
+    /**
+     * @brief 估算宽恕 ID 集合、待写日志队列与成长分析状态的内存，登记为 MemoryRegistry 的 "logs"。
+     *        各部分在各自的锁内读取，可在任意线程调用。
+     */
+    [[nodiscard]] metrics::MemoryUsage memoryUsage() const;
+
+    /**
+     * @brief 超出内存限额时丢弃宽恕 ID 集合，下次访问时重新读库。
+     */
+    void trimMemory();
+
+    /**
+     * @brief 设置日志保留策略，下次维护时生效。
+     */
+    void setRetentionPolicy(const DatabaseManager::LogRetentionPolicy& policy);
+
+    /**
+     * @brief 设置成长快照打包策略，下次维护时生效。
+     */
+    void setSnapshotPackingPolicy(const DatabaseManager::SnapshotPackingPolicy& policy);
+
+    /**
+     * @brief 在调用线程同步执行一次日志维护：归档旧 Auto 日志、压缩冷日志正文、打包旧成长快照。
+     * 中文：由 MaintenanceScheduler 在用户空闲时于数据线程调用，调度、间隔与进度均由它负责；
+     *       有日志被归档时经排队连接发出 logsCompacted。
+     *
+     * @return 移入归档库的日志条数。
+     * @throws std::runtime_error 任一步数据库操作失败时抛出，已完成的步骤保留。
+     */
+    std::size_t runMaintenance(std::int64_t nowMs);
+
+    /**
+     * @brief 日志与快照时间戳的时间源。
+     */
+    using Clock = std::function<QDateTime()>;
+
+    /**
+     * @brief 替换时间源；负载生成工具据此把模拟活动分布到过去数月，传空函数恢复系统时间。
+     * 中文：只应在写入日志之前于同一线程设置；维护的空闲判断始终使用系统时间。
+     */
+    void setClock(Clock clock);
+
 signals:
     void logInserted(const LogEntry& entry);
     void snapshotCaptured(const GrowthSnapshot& snapshot);
+    /**
+     * @brief 一次维护移出了主库中的旧日志，已加载日志的视图应重新读取。
+     */
+    void logsCompacted(std::size_t archivedCount);
 
 private:
     LogManager(DatabaseManager& database,
@@ -97,19 +262,77 @@ private:
                TaskManager& taskManager);
 
     void bindSystemEvents();
-    int persistLog(const LogEntry& entry);
-    LogEntry fromRecord(const DatabaseManager::LogRecord& record) const;
+    void onSessionChanged(int userId);
+    std::optional<GrowthSnapshot> buildSnapshot();
+    [[nodiscard]] QDateTime now() const;
+    void captureSnapshotInBackground();
+    int manualLogCount();
+    static DatabaseManager::GrowthSnapshotRecord toSnapshotRecord(const GrowthSnapshot& snapshot, int ownerId);
+    /**
+     * @brief 把已写入的快照并入所属用户的成长分析并保存状态；状态在锁外保存，依赖水位比较防止乱序覆盖。
+     */
+    void observeSnapshot(const GrowthSnapshot& snapshot, int ownerId);
+    /**
+     * @brief 返回 ownerId 的成长分析状态；已恢复的是其他用户时丢弃并重新恢复。
+     * 中文：lock 须已锁定 m_analyticsMutex；需要恢复时先解锁、在锁外读库，再加锁安装，期间被其他线程装好的状态优先。
+     */
+    GrowthAnalytics& analyticsLocked(std::unique_lock<std::mutex>& lock, int ownerId);
+    /**
+     * @brief 从数据库恢复 ownerId 的成长分析状态，不访问 m_analytics。
+     */
+    GrowthAnalytics loadAnalytics(int ownerId) const;
+    static std::int64_t snapshotDay(std::int64_t timestampMs);
+    /**
+     * @brief 等待写入线程组提交的日志：记录在入队线程上序列化，写入线程只负责执行 SQL。
+     */
+    struct PendingLog {
+        LogEntry entry;
+        DatabaseManager::LogRecord record;
+    };
+
+    int persistLog(const LogEntry& entry, LogDelivery delivery);
+    DatabaseManager::LogRecord toLogRecord(const LogEntry& entry) const;
+    void publishLog(const LogEntry& entry, int ownerId);
+    void runLogWriter();
+    [[nodiscard]] DatabaseManager::LogFilter toRecordFilter(const std::optional<LogEntry::LogType>& type,
+                                                            const std::optional<QDateTime>& start,
+                                                            const std::optional<QDateTime>& end,
+                                                            const std::optional<LogEntry::MoodTag>& mood,
+                                                            const std::optional<std::string>& keyword) const;
     std::string serializeAttributeChanges(const std::vector<LogEntry::AttributeChange>& changes) const;
-    std::vector<LogEntry::AttributeChange> deserializeAttributeChanges(const std::string& text) const;
     static std::string serializeMood(const std::optional<LogEntry::MoodTag>& mood);
-    static std::optional<LogEntry::MoodTag> deserializeMood(const std::string& text);
-    static std::optional<std::string> toIso(const std::optional<QDateTime>& time);
+    static std::optional<std::int64_t> toEpochMs(const std::optional<QDateTime>& time);
+    [[nodiscard]] DatabaseManager::SnapshotResolution chooseSnapshotResolution(
+        int ownerId, const std::optional<std::int64_t>& startMs, const std::optional<std::int64_t>& endMs) const;
 
     DatabaseManager& m_database;
     UserManager& m_userManager;
     AchievementManager& m_achievementManager;
     TaskManager& m_taskManager;
-    std::set<int> m_forgivenLogIds;
+    std::unique_ptr<QTimer> m_snapshotTimer;     //!< 周期定时器，按固定间隔请求快照
+    std::unique_ptr<QTimer> m_snapshotDebounce;  //!< 单次定时器，合并突发的快照请求
+    std::unique_ptr<QThreadPool> m_snapshotPool;  //!< 单线程池，按请求顺序在后台写入快照
+    mutable std::mutex m_policyMutex;  //!< 保护两项维护策略：界面线程设置，数据线程在维护时读取
+    DatabaseManager::LogRetentionPolicy m_retentionPolicy;
+    DatabaseManager::SnapshotPackingPolicy m_snapshotPackingPolicy;
+    Clock m_clock;
+    std::atomic<int> m_ownerId;  //!< 当前会话的 users.id，新日志与查询均按其分区；0 表示未登录
+    int m_manualLogCount;  //!< 手动日志计数，首次使用时从数据库读取，之后随写入递增；-1 表示尚未读取
+    mutable std::mutex m_forgivenMutex;            //!< 保护 m_forgivenLogIds：内存面板在界面线程丢弃或统计它
+    std::optional<SortedIdSet> m_forgivenLogIds;   //!< 宽恕 ID 缓存，为空表示尚未读取
+    mutable std::mutex m_analyticsMutex;           //!< 保护 m_analytics：后台快照线程与查询线程并发访问
+    std::optional<GrowthAnalytics> m_analytics;    //!< 成长分析状态，为空表示尚未恢复
+    int m_analyticsOwner;                          //!< m_analytics 所属用户，受 m_analyticsMutex 保护
+    mutable std::mutex m_logQueueMutex;
+    std::condition_variable m_logQueueReady;  //!< 通知写入线程：有新日志、请求 flush 或停止
+    std::condition_variable m_logCommitted;   //!< 通知 flush 等待者：又一批日志已提交
+    std::vector<PendingLog> m_logQueue;       //!< 多生产者入队、单写入线程整批取走
+    std::uint64_t m_logEnqueued;              //!< 累计入队条数
+    std::uint64_t m_logCommittedCount;        //!< 累计已处理条数（提交或失败丢弃）
+    bool m_logFlushRequested;
+    bool m_logWriterStopping;
+    std::thread m_logWriter;
+    metrics::MemoryRegistration m_memoryRegistration;
 };
 
 }  // namespace rove::data
@@ -0,0 +1,124 @@
+#include "LogTemplate.h"
+
+#include <array>
+#include <charconv>
+#include <vector>
+
+namespace rove::data {
+
+namespace {
+
+/**
+ * @brief 模板文案，下标为模板编号；{0}、{1} 依次替换为第 0、1 个参数。
+ */
+constexpr std::array<std::string_view, 4> kTemplates{{
+    "",
+    "任务完成：{0}，难度{1}星",
+    "解锁成就：{0}",
+    "等级提升至 {0}",
+}};
+
+/**
+ * @brief 取第 index 个逗号分隔的参数，不存在时返回空串。
+ */
+std::string_view argumentAt(std::string_view args, int index) {
+    std::size_t begin = 0;
+    for (int i = 0; i < index; ++i) {
+        const std::size_t comma = args.find(',', begin);
+        if (comma == std::string_view::npos) {
+            return {};
+        }
+        begin = comma + 1;
+    }
+    const std::size_t end = args.find(',', begin);
+    return args.substr(begin, end == std::string_view::npos ? std::string_view::npos : end - begin);
+}
+
+}  // namespace
+
+std::string encodeLogTemplateArgs(std::initializer_list<std::int64_t> args) {
+    std::string encoded;
+    char buffer[24];
+    for (const std::int64_t value : args) {
+        if (!encoded.empty()) {
+            encoded.push_back(',');
+        }
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        encoded.append(buffer, result.ptr);
+    }
+    return encoded;
+}
+
+std::string renderLogTemplate(int templateId, std::string_view args) {
+    if (templateId <= 0 || templateId >= static_cast<int>(kTemplates.size())) {
+        return std::string(args);
+    }
+    const std::string_view pattern = kTemplates[static_cast<std::size_t>(templateId)];
+    std::string rendered;
+    rendered.reserve(pattern.size() + args.size());
+    for (std::size_t i = 0; i < pattern.size(); ++i) {
+        if (pattern[i] == '{' && i + 2 < pattern.size() && pattern[i + 2] == '}' && pattern[i + 1] >= '0' &&
+            pattern[i + 1] <= '9') {
+            rendered.append(argumentAt(args, pattern[i + 1] - '0'));
+            i += 2;
+            continue;
+        }
+        rendered.push_back(pattern[i]);
+    }
+    return rendered;
+}
+
+std::optional<std::string> matchLogTemplate(int templateId, std::string_view text) {
+    if (templateId <= 0 || templateId >= static_cast<int>(kTemplates.size())) {
+        return std::nullopt;
+    }
+    const std::string_view pattern = kTemplates[static_cast<std::size_t>(templateId)];
+    std::vector<std::string_view> values;
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < pattern.size(); ++i) {
+        if (pattern[i] == '{' && i + 2 < pattern.size() && pattern[i + 2] == '}' && pattern[i + 1] >= '0' &&
+            pattern[i + 1] <= '9') {
+            std::size_t end = pos;
+            if (end < text.size() && text[end] == '-') {
+                ++end;
+            }
+            while (end < text.size() && text[end] >= '0' && text[end] <= '9') {
+                ++end;
+            }
+            const auto index = static_cast<std::size_t>(pattern[i + 1] - '0');
+            if (values.size() <= index) {
+                values.resize(index + 1);
+            }
+            values[index] = text.substr(pos, end - pos);
+            pos = end;
+            i += 2;
+            continue;
+        }
+        if (pos >= text.size() || text[pos] != pattern[i]) {
+            return std::nullopt;
+        }
+        ++pos;
+    }
+    if (pos != text.size()) {
+        return std::nullopt;
+    }
+    std::string args;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) {
+            args.push_back(',');
+        }
+        args.append(values[i]);
+    }
+    // 中文：逐字节回渲染核对，排除空参数、前导零等无法原样还原的文本。
+    if (renderLogTemplate(templateId, args) != text) {
+        return std::nullopt;
+    }
+    for (const auto value : values) {
+        if (value.empty() || value == "-") {
+            return std::nullopt;
+        }
+    }
+    return args;
+}
+
+}  // namespace rove::data
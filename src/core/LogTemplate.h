@@ -0,0 +1,45 @@
+#ifndef LOGTEMPLATE_H
+#define LOGTEMPLATE_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace rove::data {
+
+/**
+ * @enum LogTemplate
+ * @brief 自动日志的文案模板编号，持久化在 logs.template_id 列，已发布的编号不可改变含义。
+ * 中文：模板日志的 content 列只保存逗号分隔的整数参数（如 "12,3"），显示时由 renderLogTemplate 展开；
+ *       None 表示 content 即为完整文本（手动日志与旧版本写入的自动日志）。
+ */
+enum class LogTemplate : int {
+    None = 0,
+    TaskCompleted = 1,        //!< 参数：任务 id, 难度星级
+    AchievementUnlocked = 2,  //!< 参数：成就 id
+    LevelUp = 3,              //!< 参数：新等级
+};
+
+/**
+ * @brief 把整数参数编码为紧凑的逗号分隔串，写入时不做任何文案格式化。
+ */
+[[nodiscard]] std::string encodeLogTemplateArgs(std::initializer_list<std::int64_t> args);
+
+/**
+ * @brief 按模板编号展开文案；None 或未知编号原样返回 args，新版本写入的模板在旧版本中仍可读。
+ * 中文：文案集中在 LogTemplate.cpp 的模板表中，本地化只需替换该表。同时注册为 SQL 函数 render_log，
+ *       供 LIKE 检索与归档使用渲染后的文本；全文索引在写入日志时直接调用本函数。
+ */
+[[nodiscard]] std::string renderLogTemplate(int templateId, std::string_view args);
+
+/**
+ * @brief renderLogTemplate 的逆操作：文本恰好是该模板的渲染结果时返回参数串，否则返回空。
+ * 中文：供迁移把旧版本写入的整段文案改写为模板参数，只接受能逐字节还原的文本。
+ */
+[[nodiscard]] std::optional<std::string> matchLogTemplate(int templateId, std::string_view text);
+
+}  // namespace rove::data
+
+#endif  // LOGTEMPLATE_H
@@ -0,0 +1,296 @@
+#include "MaintenanceScheduler.h"
+
+#include "LogManager.h"
+#include "Metrics.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QEvent>
+#include <QGuiApplication>
+#include <QWindow>
+
+#include <cstdint>
+#include <exception>
+#include <string>
+
+namespace rove::data {
+
+namespace {
+
+std::string lastRunKey(const char* task) { return std::string("maintenance.") + task + ".last_ms"; }
+
+std::string cursorKey(const char* task) { return std::string("maintenance.") + task + ".cursor"; }
+
+constexpr const char* kVacuumConvertedKey = "maintenance.vacuum_conversion.done";
+
+}  // namespace
+
+MaintenanceScheduler::MaintenanceScheduler(DatabaseManager& database,
+                                           LogManager* logs,
+                                           CommandExecutor& executor,
+                                           Options options,
+                                           QObject* parent)
+    : QObject(parent),
+      m_database(database),
+      m_logs(logs),
+      m_executor(executor),
+      m_options(options),
+      m_timer(std::make_unique<QTimer>()),
+      m_tasks(),
+      m_lastInputMs(QDateTime::currentMSecsSinceEpoch()) {
+    m_tasks[static_cast<std::size_t>(Task::Checkpoint)].interval = m_options.checkpointEvery;
+    m_tasks[static_cast<std::size_t>(Task::Optimize)].interval = m_options.optimizeEvery;
+    m_tasks[static_cast<std::size_t>(Task::Analyze)].interval = m_options.analyzeEvery;
+    m_tasks[static_cast<std::size_t>(Task::IntegrityCheck)].interval = m_options.integrityEvery;
+    m_tasks[static_cast<std::size_t>(Task::LogCompaction)].interval = m_options.logCompactionEvery;
+    m_tasks[static_cast<std::size_t>(Task::ReclaimSpace)].interval = m_options.reclaimEvery;
+    m_timer->setInterval(static_cast<int>(m_options.checkInterval.count()));
+    QObject::connect(m_timer.get(), &QTimer::timeout, this, [this]() { onTick(); });
+}
+
+MaintenanceScheduler::~MaintenanceScheduler() {
+    if (auto* app = QCoreApplication::instance(); app != nullptr && m_started) {
+        app->removeEventFilter(this);
+    }
+}
+
+void MaintenanceScheduler::start() {
+    if (m_started) {
+        return;
+    }
+    m_started = true;
+    for (std::size_t i = 0; i < kTaskCount; ++i) {
+        const char* name = taskName(static_cast<Task>(i));
+        try {
+            m_tasks[i].lastRunMs = m_database.getAppState(lastRunKey(name)).value_or(0);
+            m_tasks[i].cursor = static_cast<std::size_t>(m_database.getAppState(cursorKey(name)).value_or(0));
+        } catch (const std::exception& e) {
+            qWarning() << "读取维护进度失败:" << name << e.what();
+        }
+    }
+    try {
+        m_vacuumConverted = m_database.getAppState(kVacuumConvertedKey).value_or(0) != 0;
+    } catch (const std::exception& e) {
+        qWarning() << "读取 auto_vacuum 转换状态失败:" << e.what();
+    }
+    if (auto* app = QCoreApplication::instance()) {
+        app->installEventFilter(this);
+    }
+    m_timer->start();
+}
+
+void MaintenanceScheduler::stop() {
+    m_stopped = true;
+    m_timer->stop();
+}
+
+bool MaintenanceScheduler::isUserIdle() const {
+    const qint64 quietMs = QDateTime::currentMSecsSinceEpoch() - m_lastInputMs;
+    return quietMs >= static_cast<qint64>(m_options.idleAfter.count()) || allWindowsMinimized();
+}
+
+const char* MaintenanceScheduler::taskName(Task task) noexcept {
+    switch (task) {
+    case Task::Checkpoint:
+        return "checkpoint";
+    case Task::Optimize:
+        return "optimize";
+    case Task::Analyze:
+        return "analyze";
+    case Task::IntegrityCheck:
+        return "quick_check";
+    case Task::LogCompaction:
+        return "log_compaction";
+    case Task::ReclaimSpace:
+        return "reclaim";
+    case Task::VacuumConversion:
+        return "vacuum_conversion";
+    }
+    return "unknown";
+}
+
+bool MaintenanceScheduler::eventFilter(QObject* watched, QEvent* event) {
+    switch (event->type()) {
+    case QEvent::KeyPress:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+        m_lastInputMs = QDateTime::currentMSecsSinceEpoch();
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void MaintenanceScheduler::onTick() {
+    if (m_stopped || m_stepInFlight || !isUserIdle()) {
+        return;
+    }
+    Task task = Task::Checkpoint;
+    if (pickTask(QDateTime::currentMSecsSinceEpoch(), task)) {
+        runStep(task);
+    }
+}
+
+bool MaintenanceScheduler::pickTask(qint64 nowMs, Task& task) const {
+    qint64 mostOverdueMs = -1;
+    for (std::size_t i = 0; i < kTaskCount; ++i) {
+        const TaskState& state = m_tasks[i];
+        if (state.cursor != 0) {
+            task = static_cast<Task>(i);
+            return true;
+        }
+        if (static_cast<Task>(i) == Task::VacuumConversion) {
+            const qint64 compactedMs = m_tasks[static_cast<std::size_t>(Task::LogCompaction)].lastRunMs;
+            if (m_vacuumConverted || compactedMs <= state.lastRunMs) {
+                continue;
+            }
+        }
+        const qint64 intervalMs = std::chrono::duration_cast<std::chrono::milliseconds>(state.interval).count();
+        const qint64 overdueMs = nowMs - state.lastRunMs - intervalMs;
+        if (overdueMs >= 0 && overdueMs > mostOverdueMs) {
+            mostOverdueMs = overdueMs;
+            task = static_cast<Task>(i);
+        }
+    }
+    return mostOverdueMs >= 0;
+}
+
+void MaintenanceScheduler::runStep(Task task) {
+    m_stepInFlight = true;
+    const std::size_t cursor = m_tasks[static_cast<std::size_t>(task)].cursor;
+    DatabaseManager& database = m_database;
+    LogManager* logs = m_logs;
+    m_executor
+        .submit(QStringLiteral("maintenance.%1").arg(QLatin1String(taskName(task))),
+                [&database, logs, task, cursor, options = m_options]() {
+                    return executeStep(database, logs, task, cursor, options);
+                })
+        .then(this, [this](const StepOutcome& outcome) { finishStep(outcome); });
+}
+
+/**
+ * @brief 回到 GUI 线程更新内存中的进度；失败的一步保留原游标，待下次检查周期重试，不在同一空闲时段内反复失败。
+ */
+void MaintenanceScheduler::finishStep(const StepOutcome& outcome) {
+    m_stepInFlight = false;
+    TaskState& state = m_tasks[static_cast<std::size_t>(outcome.task)];
+    if (!outcome.error.isEmpty()) {
+        qWarning() << "数据库维护失败:" << taskName(outcome.task) << outcome.error;
+        return;
+    }
+    if (outcome.converted) {
+        m_vacuumConverted = true;
+    }
+    if (outcome.finished) {
+        state.lastRunMs = QDateTime::currentMSecsSinceEpoch();
+        state.cursor = 0;
+        emit taskFinished(outcome.task, outcome.summary);
+    } else {
+        state.cursor = outcome.cursor;
+    }
+    onTick();
+}
+
+/**
+ * @brief 在数据线程执行。进度与一步维护不在同一事务中：步骤完成但进度未写入时，下次从旧游标重做几张表，结果相同。
+ * 日志维护的三步（归档、压缩、打包）与空闲页回收本身都可重复执行，中途失败时下次整轮重做。
+ * auto_vacuum 转换在 VACUUM 完成后才写入已转换标记，标记未写入时下次检查发现已是增量模式，直接补记。
+ */
+MaintenanceScheduler::StepOutcome MaintenanceScheduler::executeStep(DatabaseManager& database,
+                                                                    LogManager* logs,
+                                                                    Task task,
+                                                                    std::size_t cursor,
+                                                                    const Options& options) {
+    StepOutcome outcome;
+    outcome.task = task;
+    const char* name = taskName(task);
+    try {
+        switch (task) {
+        case Task::Checkpoint: {
+            const auto result = database.checkpointWal();
+            outcome.finished = true;
+            outcome.summary = QStringLiteral("WAL 检查点：%1/%2 帧%3")
+                                  .arg(result.checkpointedFrames)
+                                  .arg(result.walFrames)
+                                  .arg(result.truncated ? QStringLiteral("，已截断") : QString());
+            break;
+        }
+        case Task::Optimize:
+            database.optimizeQueryPlanner();
+            outcome.finished = true;
+            outcome.summary = QStringLiteral("PRAGMA optimize 完成");
+            break;
+        case Task::Analyze:
+        case Task::IntegrityCheck: {
+            const auto progress = task == Task::Analyze ? database.analyzeTables(cursor, options.stepBudget)
+                                                        : database.quickCheckTables(cursor, options.stepBudget);
+            for (const auto& problem : progress.problems) {
+                qWarning() << "quick_check 发现问题:" << problem.c_str();
+                ROVE_COUNTER_ADD(Database, "maintenance.problems", 1);
+            }
+            outcome.finished = progress.finished();
+            outcome.cursor = progress.nextTable;
+            outcome.summary = QStringLiteral("%1：%2/%3 张表")
+                                  .arg(QLatin1String(name))
+                                  .arg(progress.nextTable)
+                                  .arg(progress.tableCount);
+            break;
+        }
+        case Task::LogCompaction: {
+            const std::size_t archived =
+                logs != nullptr ? logs->runMaintenance(QDateTime::currentMSecsSinceEpoch()) : 0;
+            outcome.finished = true;
+            outcome.summary = QStringLiteral("日志维护：归档 %1 条").arg(archived);
+            break;
+        }
+        case Task::ReclaimSpace: {
+            const std::int64_t reclaimed = database.reclaimFreePages(options.reclaimPagesPerRun);
+            outcome.finished = true;
+            outcome.summary = QStringLiteral("空闲页回收：%1 页").arg(reclaimed);
+            break;
+        }
+        case Task::VacuumConversion:
+            outcome.converted = database.convertToIncrementalVacuum(options.vacuumConversionMinFreePages);
+            if (outcome.converted) {
+                database.setAppState(kVacuumConvertedKey, 1);
+            }
+            outcome.finished = true;
+            outcome.summary = outcome.converted ? QStringLiteral("auto_vacuum 已是增量模式")
+                                                : QStringLiteral("空闲页不足，暂不转换 auto_vacuum");
+            break;
+        }
+        if (outcome.finished) {
+            database.setAppState(lastRunKey(name), QDateTime::currentMSecsSinceEpoch());
+            database.setAppState(cursorKey(name), 0);
+        } else {
+            database.setAppState(cursorKey(name), static_cast<std::int64_t>(outcome.cursor));
+        }
+    } catch (const std::exception& e) {
+        outcome.error = QString::fromUtf8(e.what());
+    }
+    return outcome;
+}
+
+bool MaintenanceScheduler::allWindowsMinimized() {
+    if (qobject_cast<QGuiApplication*>(QCoreApplication::instance()) == nullptr) {
+        return false;
+    }
+    bool anyVisible = false;
+    for (const QWindow* window : QGuiApplication::topLevelWindows()) {
+        if (!window->isVisible()) {
+            continue;
+        }
+        anyVisible = true;
+        if (!(window->windowStates() & Qt::WindowMinimized)) {
+            return false;
+        }
+    }
+    return anyVisible;
+}
+
+}  // namespace rove::data
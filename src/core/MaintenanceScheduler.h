@@ -0,0 +1,150 @@
+#ifndef MAINTENANCESCHEDULER_H
+#define MAINTENANCESCHEDULER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QtGlobal>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "CommandExecutor.h"
+#include "DatabaseManager.h"
+
+class QEvent;
+
+namespace rove::data {
+
+class LogManager;
+
+/**
+ * @class MaintenanceScheduler
+ * @brief 在用户空闲时执行数据库维护：WAL 截断、PRAGMA optimize、逐表 ANALYZE、逐表 quick_check、
+ *        日志维护（归档旧日志、压缩冷日志正文、打包旧快照）、空闲页回收，以及旧库到增量 auto_vacuum 的一次性转换。
+ * 中文：空闲指最近 idleAfter 内没有键盘、鼠标、触摸输入，或所有可见窗口都已最小化。定时器每 checkInterval 检查一次，
+ *       空闲时挑选最该执行的任务，作为一条命令提交到 CommandExecutor 的数据线程，与界面命令串行、不另开写者。
+ *       分表任务每步只处理到 stepBudget 用完为止，步结束后若仍空闲则立即接着下一步；用户一有输入，
+ *       正在执行的那一步做完即停，进度游标写入 app_state，下次空闲（包括重启之后）从断点继续。
+ *       各任务的上次完成时刻同样保存在 app_state，到期才会再次执行。
+ *       旧库的 auto_vacuum 转换需要一次完整 VACUUM：只在日志维护完成之后、空闲页达到 vacuumConversionMinFreePages
+ *       时执行，成功后在 app_state 记下已转换，此后不再检查。
+ */
+class MaintenanceScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Task { Checkpoint = 0, Optimize, Analyze, IntegrityCheck, LogCompaction, ReclaimSpace, VacuumConversion };
+    static constexpr std::size_t kTaskCount = 7;
+
+    /**
+     * @brief 空闲判定与各任务的执行间隔。
+     */
+    struct Options {
+        std::chrono::milliseconds idleAfter{std::chrono::minutes(5)};     //!< 无输入多久视为空闲
+        std::chrono::milliseconds checkInterval{std::chrono::seconds(30)};  //!< 空闲检查的周期
+        std::chrono::milliseconds stepBudget{200};                        //!< 分表任务每步的时间预算
+        std::chrono::hours checkpointEvery{1};
+        std::chrono::hours optimizeEvery{24};
+        std::chrono::hours analyzeEvery{24 * 7};
+        std::chrono::hours integrityEvery{24 * 7};
+        std::chrono::hours logCompactionEvery{24};
+        std::chrono::hours reclaimEvery{24};
+        std::int64_t reclaimPagesPerRun = 4096;  //!< 每轮增量回收的最大页数
+        std::int64_t vacuumConversionMinFreePages = 2560;  //!< 旧库值得一次完整 VACUUM 的最少空闲页数（4 KiB 页约 10 MiB）
+    };
+
+    /**
+     * @param logs 日志归档任务的执行者；为空时该任务视为无事可做，直接记为完成。
+     */
+    MaintenanceScheduler(DatabaseManager& database, LogManager* logs, CommandExecutor& executor, Options options,
+                         QObject* parent = nullptr);
+    ~MaintenanceScheduler() override;
+
+    /**
+     * @brief 读取 app_state 中的上次完成时刻与游标，在应用对象上安装输入过滤器并启动定时器；重复调用无效。
+     */
+    void start();
+
+    /**
+     * @brief 停止调度；已提交的一步仍会执行完，但不再提交新的步骤。须在 CommandExecutor::stop 之前调用。
+     */
+    void stop();
+
+    /**
+     * @brief 当前是否满足空闲条件。
+     */
+    [[nodiscard]] bool isUserIdle() const;
+
+    [[nodiscard]] static const char* taskName(Task task) noexcept;
+
+signals:
+    /**
+     * @brief 一项任务整轮完成时发出；summary 为面向日志的简短描述。
+     */
+    void taskFinished(rove::data::MaintenanceScheduler::Task task, const QString& summary);
+
+protected:
+    /**
+     * @brief 记录最近一次用户输入的时刻，不拦截事件。
+     */
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    /**
+     * @brief 一步维护在数据线程上的结果；异常在数据线程内转为 error，future 总是正常完成。
+     */
+    struct StepOutcome {
+        Task task = Task::Checkpoint;
+        bool finished = false;
+        bool converted = false;  //!< VacuumConversion：库已是增量 auto_vacuum
+        std::size_t cursor = 0;  //!< 未完成时下一步的起始表序号
+        QString summary;
+        QString error;
+    };
+
+    struct TaskState {
+        std::chrono::hours interval{0};
+        qint64 lastRunMs = 0;    //!< 上次整轮完成的 UTC 毫秒，0 表示从未执行
+        std::size_t cursor = 0;  //!< 非 0 表示分表任务执行到一半
+    };
+
+    void onTick();
+
+    /**
+     * @brief 进行到一半的任务优先；否则在到期的任务中挑选逾期最久的一个。
+     *        auto_vacuum 转换不按间隔到期，在上次检查之后日志维护又完成过一轮时才参与挑选。
+     * @return 是否有任务需要执行。
+     */
+    bool pickTask(qint64 nowMs, Task& task) const;
+
+    void runStep(Task task);
+    void finishStep(const StepOutcome& outcome);
+
+    /**
+     * @brief 在数据线程执行一步并把进度写入 app_state。
+     */
+    static StepOutcome executeStep(DatabaseManager& database, LogManager* logs, Task task, std::size_t cursor,
+                                   const Options& options);
+
+    [[nodiscard]] static bool allWindowsMinimized();
+
+    DatabaseManager& m_database;
+    LogManager* m_logs;
+    CommandExecutor& m_executor;
+    Options m_options;
+    std::unique_ptr<QTimer> m_timer;
+    std::array<TaskState, kTaskCount> m_tasks;
+    qint64 m_lastInputMs = 0;
+    bool m_started = false;
+    bool m_stopped = false;
+    bool m_stepInFlight = false;
+    bool m_vacuumConverted = false;  //!< 库已是增量 auto_vacuum，转换任务不再参与挑选
+};
+
+}  // namespace rove::data
+
+#endif  // MAINTENANCESCHEDULER_H
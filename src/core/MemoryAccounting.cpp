@@ -0,0 +1,175 @@
+#include "MemoryAccounting.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+
+#include <algorithm>
+#include <charconv>
+#include <utility>
+
+#include "Metrics.h"
+
+namespace rove::metrics {
+
+namespace {
+/**
+ * @brief 当前标准库短串缓冲能容纳的最大长度，按默认构造的空串容量推得。
+ */
+const std::size_t kInlineStringCapacity = std::string().capacity();
+
+std::string_view trimmed(std::string_view text) noexcept {
+    while (!text.empty() && text.front() == ' ') {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && text.back() == ' ') {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+}  // namespace
+
+std::size_t heapBytes(const std::string& text) noexcept {
+    return text.capacity() > kInlineStringCapacity ? text.capacity() + 1 : 0;
+}
+
+std::size_t nodeContainerBytes(std::size_t nodes, std::size_t elementBytes, std::size_t buckets) noexcept {
+    return nodes * (elementBytes + 2 * sizeof(void*)) + buckets * sizeof(void*);
+}
+
+MemoryRegistration::~MemoryRegistration() { reset(); }
+
+MemoryRegistration::MemoryRegistration(MemoryRegistration&& other) noexcept : m_id(std::exchange(other.m_id, 0)) {}
+
+MemoryRegistration& MemoryRegistration::operator=(MemoryRegistration&& other) noexcept {
+    if (this != &other) {
+        reset();
+        m_id = std::exchange(other.m_id, 0);
+    }
+    return *this;
+}
+
+void MemoryRegistration::reset() noexcept {
+    if (m_id != 0) {
+        MemoryRegistry::instance().remove(std::exchange(m_id, 0));
+    }
+}
+
+MemoryRegistry& MemoryRegistry::instance() {
+    static MemoryRegistry registry;
+    return registry;
+}
+
+MemoryRegistration MemoryRegistry::add(std::string name, Reporter reporter, Trimmer trimmer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const std::uint64_t id = m_nextId++;
+    m_entries.push_back(Entry{id, std::move(name), std::move(reporter), std::move(trimmer)});
+    return MemoryRegistration(id);
+}
+
+void MemoryRegistry::remove(std::uint64_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [id](const Entry& entry) { return entry.id == id; }),
+                    m_entries.end());
+}
+
+void MemoryRegistry::setBudget(std::string_view name, std::optional<std::size_t> bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = std::find_if(m_budgets.begin(), m_budgets.end(),
+                                 [name](const auto& budget) { return budget.first == name; });
+    if (!bytes.has_value()) {
+        if (it != m_budgets.end()) {
+            m_budgets.erase(it);
+        }
+        return;
+    }
+    if (it != m_budgets.end()) {
+        it->second = *bytes;
+        return;
+    }
+    m_budgets.emplace_back(std::string(name), *bytes);
+}
+
+bool MemoryRegistry::applyBudgetSpec(std::string_view spec) {
+    while (!spec.empty()) {
+        const std::size_t comma = spec.find(',');
+        const std::string_view item = trimmed(spec.substr(0, comma));
+        spec = comma == std::string_view::npos ? std::string_view{} : spec.substr(comma + 1);
+        if (item.empty()) {
+            continue;
+        }
+        const std::size_t equals = item.find('=');
+        if (equals == std::string_view::npos) {
+            return false;
+        }
+        const std::string_view name = trimmed(item.substr(0, equals));
+        const std::string_view value = trimmed(item.substr(equals + 1));
+        std::size_t kib = 0;
+        const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), kib);
+        if (name.empty() || error != std::errc() || end != value.data() + value.size()) {
+            return false;
+        }
+        setBudget(name, kib * 1024);
+    }
+    return true;
+}
+
+std::optional<std::size_t> MemoryRegistry::budgetLocked(std::string_view name) const {
+    for (const auto& [budgetName, bytes] : m_budgets) {
+        if (budgetName == name) {
+            return bytes;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<MemoryReport> MemoryRegistry::report() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<MemoryReport> reports;
+    reports.reserve(m_entries.size());
+    for (const auto& entry : m_entries) {
+        reports.push_back(MemoryReport{entry.name, entry.reporter(), budgetLocked(entry.name), bool(entry.trimmer)});
+    }
+    return reports;
+}
+
+/**
+ * @brief 回收后不再复查：回收函数只丢弃可重建的缓存，仍然超额说明限额低于工作集，下一轮检查会再次回收。
+ */
+std::size_t MemoryRegistry::enforceBudgets() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t trimmedCount = 0;
+    for (const auto& entry : m_entries) {
+        const auto budget = budgetLocked(entry.name);
+        if (!entry.trimmer || !budget.has_value() || entry.reporter().bytes <= *budget) {
+            continue;
+        }
+        entry.trimmer();
+        ++trimmedCount;
+        if (isEnabled()) {
+            Registry::instance().counter(Subsystem::Memory, "budget.trim", entry.name).add();
+        }
+    }
+    return trimmedCount;
+}
+
+std::string MemoryRegistry::toJson() const {
+    QJsonArray modules;
+    for (const auto& entry : report()) {
+        QJsonObject obj;
+        obj.insert("name", QString::fromStdString(entry.name));
+        obj.insert("bytes", static_cast<double>(entry.usage.bytes));
+        obj.insert("entries", static_cast<double>(entry.usage.entries));
+        if (entry.budgetBytes.has_value()) {
+            obj.insert("budgetBytes", static_cast<double>(*entry.budgetBytes));
+        }
+        obj.insert("trimmable", entry.trimmable);
+        modules.append(obj);
+    }
+    QJsonObject root;
+    root.insert("modules", modules);
+    return QJsonDocument(root).toJson(QJsonDocument::Indented).toStdString();
+}
+
+}  // namespace rove::metrics
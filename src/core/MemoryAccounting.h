@@ -0,0 +1,157 @@
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @file MemoryAccounting.h
+ * @brief 按模块估算常驻内存：各管理器提供 memoryUsage()，在 MemoryRegistry 中登记后统一汇总与限额。
+ * 中文：估算值按容器容量、节点大小与字符串堆缓冲累加，不追踪分配器开销，只用于观察增长趋势与触发回收；
+ *       与 ROVE_ENABLE_METRICS 无关，只在查看面板或检查限额时计算一次，不在热路径上埋点。
+ */
+
+namespace rove::metrics {
+
+/**
+ * @brief 一个模块的内存估算：字节数与条目数。
+ */
+struct MemoryUsage {
+    std::size_t bytes = 0;
+    std::size_t entries = 0;
+
+    MemoryUsage& operator+=(const MemoryUsage& other) noexcept {
+        bytes += other.bytes;
+        entries += other.entries;
+        return *this;
+    }
+};
+
+/**
+ * @brief 注册表中一个模块的报告行；budgetBytes 为空表示未设限额。
+ */
+struct MemoryReport {
+    std::string name;
+    MemoryUsage usage;
+    std::optional<std::size_t> budgetBytes;
+    bool trimmable = false;  //!< 是否登记了超额时的回收函数
+};
+
+/**
+ * @brief 字符串超出短串缓冲后占用的堆字节数。
+ */
+[[nodiscard]] std::size_t heapBytes(const std::string& text) noexcept;
+
+/**
+ * @brief vector 已分配的元素存储字节数（按容量计）。
+ */
+template <typename T, typename Alloc>
+[[nodiscard]] std::size_t heapBytes(const std::vector<T, Alloc>& values) noexcept {
+    return values.capacity() * sizeof(T);
+}
+
+/**
+ * @brief 节点式容器（unordered_map、map、set、list）的估算：每个节点为元素加两个指针，哈希表另计桶数组。
+ * @param elementBytes 单个元素自身的大小，通常为 sizeof(value_type)。
+ */
+[[nodiscard]] std::size_t nodeContainerBytes(std::size_t nodes, std::size_t elementBytes, std::size_t buckets = 0) noexcept;
+
+/**
+ * @class MemoryRegistration
+ * @brief MemoryRegistry::add 返回的登记凭据，析构时注销；只可移动。
+ */
+class MemoryRegistration {
+public:
+    MemoryRegistration() = default;
+    ~MemoryRegistration();
+    MemoryRegistration(MemoryRegistration&& other) noexcept;
+    MemoryRegistration& operator=(MemoryRegistration&& other) noexcept;
+    MemoryRegistration(const MemoryRegistration&) = delete;
+    MemoryRegistration& operator=(const MemoryRegistration&) = delete;
+
+    void reset() noexcept;
+
+private:
+    friend class MemoryRegistry;
+    explicit MemoryRegistration(std::uint64_t id) noexcept : m_id(id) {}
+
+    std::uint64_t m_id = 0;
+};
+
+/**
+ * @class MemoryRegistry
+ * @brief 进程级内存报告注册表：按名称登记估算函数与可选的回收函数，并按名称配置字节限额。
+ * 中文：report() 与 enforceBudgets() 在注册表锁内依次调用各模块的函数，模块注销会等待正在进行的调用结束。
+ *       界面对象也会登记，因此这两个函数应在 GUI 线程调用；管理器的估算与回收函数自行加锁，不依赖调用线程。
+ */
+class MemoryRegistry {
+public:
+    using Reporter = std::function<MemoryUsage()>;
+    using Trimmer = std::function<void()>;
+
+    static MemoryRegistry& instance();
+
+    MemoryRegistry(const MemoryRegistry&) = delete;
+    MemoryRegistry& operator=(const MemoryRegistry&) = delete;
+
+    /**
+     * @brief 登记一个模块；trimmer 为空表示只报告、超额时无可回收的缓存。
+     */
+    [[nodiscard]] MemoryRegistration add(std::string name, Reporter reporter, Trimmer trimmer = {});
+
+    /**
+     * @brief 设置或清除（nullopt）某模块的字节限额；可在模块登记之前设置。
+     */
+    void setBudget(std::string_view name, std::optional<std::size_t> bytes);
+
+    /**
+     * @brief 解析 "tasks=4096,sqlite=16384" 形式的限额（单位 KiB），逐项调用 setBudget。
+     * @return 格式错误时返回 false，此前已解析的条目仍然生效。
+     */
+    bool applyBudgetSpec(std::string_view spec);
+
+    /**
+     * @brief 按登记顺序返回全部模块的当前估算。
+     */
+    [[nodiscard]] std::vector<MemoryReport> report() const;
+
+    /**
+     * @brief 对超出限额且登记了回收函数的模块调用一次回收。
+     * @return 触发回收的模块数。
+     */
+    std::size_t enforceBudgets();
+
+    /**
+     * @brief 以 JSON 导出 report() 的结果。
+     */
+    [[nodiscard]] std::string toJson() const;
+
+private:
+    friend class MemoryRegistration;
+
+    struct Entry {
+        std::uint64_t id = 0;
+        std::string name;
+        Reporter reporter;
+        Trimmer trimmer;
+    };
+
+    MemoryRegistry() = default;
+    void remove(std::uint64_t id);
+    [[nodiscard]] std::optional<std::size_t> budgetLocked(std::string_view name) const;
+
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+    std::vector<std::pair<std::string, std::size_t>> m_budgets;
+    std::uint64_t m_nextId = 1;
+};
+
+}  // namespace rove::metrics
+
+#endif  // MEMORYACCOUNTING_H
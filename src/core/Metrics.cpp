@@ -0,0 +1,257 @@
+#include "Metrics.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+
+#include <algorithm>
+#include <mutex>
+
+namespace rove::metrics {
+
+namespace {
+/**
+ * @brief 最高有效位的位置（value 须非零），二分查找以免依赖编译器内建函数。
+ */
+int highestBit(std::uint64_t value) noexcept {
+    int bit = 0;
+    for (int shift = 32; shift > 0; shift /= 2) {
+        if ((value >> shift) != 0) {
+            value >>= shift;
+            bit += shift;
+        }
+    }
+    return bit;
+}
+
+double toMicroseconds(std::uint64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1000.0; }
+}  // namespace
+
+const char* subsystemName(Subsystem subsystem) noexcept {
+    switch (subsystem) {
+    case Subsystem::Database:
+        return "database";
+    case Subsystem::Achievements:
+        return "achievements";
+    case Subsystem::Dashboard:
+        return "dashboard";
+    case Subsystem::Charts:
+        return "charts";
+    case Subsystem::Locks:
+        return "locks";
+    case Subsystem::Memory:
+        return "memory";
+    }
+    return "unknown";
+}
+
+void setEnabled(bool enabled) noexcept {
+#if ROVE_ENABLE_METRICS
+    detail::g_enabled.store(enabled, std::memory_order_relaxed);
+#else
+    static_cast<void>(enabled);
+#endif
+}
+
+void Histogram::record(std::uint64_t nanoseconds) noexcept {
+    m_buckets[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    m_totalNs.fetch_add(nanoseconds, std::memory_order_relaxed);
+    std::uint64_t previous = m_maxNs.load(std::memory_order_relaxed);
+    while (previous < nanoseconds &&
+           !m_maxNs.compare_exchange_weak(previous, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+Histogram::Snapshot Histogram::snapshot() const noexcept {
+    Snapshot result;
+    for (const auto& bucket : m_buckets) {
+        result.count += bucket.load(std::memory_order_relaxed);
+    }
+    result.totalNs = m_totalNs.load(std::memory_order_relaxed);
+    result.maxNs = m_maxNs.load(std::memory_order_relaxed);
+    result.p50Ns = std::min(quantile(0.50, result.count), result.maxNs);
+    result.p99Ns = std::min(quantile(0.99, result.count), result.maxNs);
+    return result;
+}
+
+void Histogram::reset() noexcept {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_totalNs.store(0, std::memory_order_relaxed);
+    m_maxNs.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 小于 4 的值各占一个桶；其余按最高位分段，再取其后两位作为子桶。
+ */
+std::size_t Histogram::bucketIndex(std::uint64_t value) noexcept {
+    if (value < kSubBuckets) {
+        return static_cast<std::size_t>(value);
+    }
+    const int bit = highestBit(value);
+    const auto sub = static_cast<std::size_t>((value >> (bit - 2)) & (kSubBuckets - 1));
+    return static_cast<std::size_t>(bit) * kSubBuckets + sub - kSubBuckets;
+}
+
+std::uint64_t Histogram::bucketUpperBound(std::size_t index) noexcept {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    const std::size_t bit = (index + kSubBuckets) / kSubBuckets;
+    const std::uint64_t sub = (index + kSubBuckets) % kSubBuckets;
+    const std::uint64_t width = std::uint64_t{1} << (bit - 2);
+    return ((kSubBuckets + sub) << (bit - 2)) + (width - 1);
+}
+
+std::uint64_t Histogram::quantile(double fraction, std::uint64_t count) const noexcept {
+    if (count == 0) {
+        return 0;
+    }
+    const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(fraction * static_cast<double>(count) + 0.5));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(kBucketCount - 1);
+}
+
+LockProfile LockProfile::forLock(std::string_view name) {
+    auto& registry = Registry::instance();
+    LockProfile profile;
+    profile.acquired = &registry.counter(Subsystem::Locks, "acquire", name);
+    profile.contended = &registry.counter(Subsystem::Locks, "contended", name);
+    profile.wait = &registry.histogram(Subsystem::Locks, "wait", name);
+    profile.hold = &registry.histogram(Subsystem::Locks, "hold", name);
+    profile.sharedAcquired = &registry.counter(Subsystem::Locks, "acquire.shared", name);
+    profile.sharedContended = &registry.counter(Subsystem::Locks, "contended.shared", name);
+    profile.sharedWait = &registry.histogram(Subsystem::Locks, "wait.shared", name);
+    return profile;
+}
+
+Registry& Registry::instance() {
+    static Registry registry;
+    return registry;
+}
+
+Counter& Registry::counter(Subsystem subsystem, std::string_view name, std::string_view label) {
+    const auto lookup = std::make_tuple(subsystem, name, label);
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        if (auto it = m_counters.find(lookup); it != m_counters.end()) {
+            return *it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto& slot = m_counters[Key(subsystem, std::string(name), std::string(label))];
+    if (!slot) {
+        slot = std::make_unique<Counter>();
+    }
+    return *slot;
+}
+
+Histogram& Registry::histogram(Subsystem subsystem, std::string_view name, std::string_view label) {
+    const auto lookup = std::make_tuple(subsystem, name, label);
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        if (auto it = m_histograms.find(lookup); it != m_histograms.end()) {
+            return *it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto& slot = m_histograms[Key(subsystem, std::string(name), std::string(label))];
+    if (!slot) {
+        slot = std::make_unique<Histogram>();
+    }
+    return *slot;
+}
+
+void Registry::describe(std::string_view label, std::string_view detail) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        if (m_details.find(label) != m_details.end()) {
+            return;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_details.emplace(std::string(label), std::string(detail));
+}
+
+std::vector<MetricSnapshot> Registry::snapshot() const {
+    std::vector<MetricSnapshot> result;
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    result.reserve(m_counters.size() + m_histograms.size());
+    for (const auto& [key, counter] : m_counters) {
+        MetricSnapshot entry;
+        entry.kind = MetricSnapshot::Kind::Counter;
+        std::tie(entry.subsystem, entry.name, entry.label) = key;
+        entry.value = counter->value();
+        if (auto it = m_details.find(entry.label); it != m_details.end()) {
+            entry.detail = it->second;
+        }
+        result.push_back(std::move(entry));
+    }
+    for (const auto& [key, histogram] : m_histograms) {
+        MetricSnapshot entry;
+        entry.kind = MetricSnapshot::Kind::Histogram;
+        std::tie(entry.subsystem, entry.name, entry.label) = key;
+        entry.timing = histogram->snapshot();
+        if (auto it = m_details.find(entry.label); it != m_details.end()) {
+            entry.detail = it->second;
+        }
+        result.push_back(std::move(entry));
+    }
+    lock.unlock();
+    std::sort(result.begin(), result.end(), [](const MetricSnapshot& lhs, const MetricSnapshot& rhs) {
+        return std::tie(lhs.subsystem, lhs.name, lhs.label) < std::tie(rhs.subsystem, rhs.name, rhs.label);
+    });
+    return result;
+}
+
+std::string Registry::toJson() const {
+    QJsonArray metrics;
+    for (const auto& entry : snapshot()) {
+        QJsonObject obj;
+        obj.insert("subsystem", QString::fromUtf8(subsystemName(entry.subsystem)));
+        obj.insert("name", QString::fromStdString(entry.name));
+        if (!entry.label.empty()) {
+            obj.insert("label", QString::fromStdString(entry.label));
+        }
+        if (!entry.detail.empty()) {
+            obj.insert("detail", QString::fromStdString(entry.detail));
+        }
+        if (entry.kind == MetricSnapshot::Kind::Counter) {
+            obj.insert("kind", "counter");
+            obj.insert("value", static_cast<double>(entry.value));
+        } else {
+            obj.insert("kind", "histogram");
+            obj.insert("count", static_cast<double>(entry.timing.count));
+            obj.insert("totalUs", toMicroseconds(entry.timing.totalNs));
+            obj.insert("p50Us", toMicroseconds(entry.timing.p50Ns));
+            obj.insert("p99Us", toMicroseconds(entry.timing.p99Ns));
+            obj.insert("maxUs", toMicroseconds(entry.timing.maxNs));
+        }
+        metrics.append(obj);
+    }
+    QJsonObject root;
+    root.insert("compiledIn", kCompiledIn);
+    root.insert("enabled", isEnabled());
+    root.insert("metrics", metrics);
+    return QJsonDocument(root).toJson(QJsonDocument::Indented).toStdString();
+}
+
+void Registry::reset() noexcept {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    for (auto& [key, counter] : m_counters) {
+        counter->reset();
+    }
+    for (auto& [key, histogram] : m_histograms) {
+        histogram->reset();
+    }
+}
+
+}  // namespace rove::metrics
@@ -0,0 +1,342 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+/**
+ * @file Metrics.h
+ * @brief 热路径埋点：按子系统分组的计数器、延迟直方图与 RAII 计时器。
+ * 中文：编译开关 ROVE_ENABLE_METRICS（CMake 选项 CYBER_LANDA_ENABLE_METRICS）为 0 时，
+ *       ROVE_SCOPED_TIMER / ROVE_COUNTER_ADD / ROVE_RECORD_SINCE 展开为空语句，热路径上不留任何代码；
+ *       两者默认都关闭：编译进来后仍需在运行期用 setEnabled(true)（开发者面板或基准工具）开启，
+ *       未开启时每个埋点只剩一次 relaxed 原子读。
+ */
+
+#ifndef ROVE_ENABLE_METRICS
+#define ROVE_ENABLE_METRICS 0
+#endif
+
+namespace rove::metrics {
+
+/**
+ * @brief 埋点所属子系统，决定面板与 JSON 中的分组。
+ */
+enum class Subsystem { Database, Achievements, Dashboard, Charts, Locks, Memory };
+
+[[nodiscard]] const char* subsystemName(Subsystem subsystem) noexcept;
+
+using Clock = std::chrono::steady_clock;
+using TimePoint = Clock::time_point;
+
+namespace detail {
+inline std::atomic<bool> g_enabled{false};
+}  // namespace detail
+
+/**
+ * @brief 运行期开关；未编译埋点时恒为 false。
+ */
+[[nodiscard]] inline bool isEnabled() noexcept {
+#if ROVE_ENABLE_METRICS
+    return detail::g_enabled.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+}
+
+void setEnabled(bool enabled) noexcept;
+
+/**
+ * @class Counter
+ * @brief 无锁单调计数器，relaxed 原子累加。
+ */
+class Counter {
+public:
+    void add(std::uint64_t delta = 1) noexcept { m_value.fetch_add(delta, std::memory_order_relaxed); }
+    [[nodiscard]] std::uint64_t value() const noexcept { return m_value.load(std::memory_order_relaxed); }
+    void reset() noexcept { m_value.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint64_t> m_value{0};
+};
+
+/**
+ * @class Histogram
+ * @brief 无锁延迟直方图（纳秒），每个 2 的幂区间再分 4 个子桶，分位数相对误差约 25% 以内。
+ * 中文：记录只做几次 relaxed 原子操作，不分配内存；快照时遍历桶累加计算 p50/p99。
+ */
+class Histogram {
+public:
+    struct Snapshot {
+        std::uint64_t count = 0;
+        std::uint64_t totalNs = 0;
+        std::uint64_t maxNs = 0;
+        std::uint64_t p50Ns = 0;
+        std::uint64_t p99Ns = 0;
+    };
+
+    void record(std::uint64_t nanoseconds) noexcept;
+    [[nodiscard]] Snapshot snapshot() const noexcept;
+    void reset() noexcept;
+
+private:
+    static constexpr std::size_t kSubBuckets = 4;
+    static constexpr std::size_t kBucketCount = 63 * kSubBuckets;  //!< 最高位 0..63，其中 0/1 两段并入前 4 个精确桶。
+
+    [[nodiscard]] static std::size_t bucketIndex(std::uint64_t value) noexcept;
+    [[nodiscard]] static std::uint64_t bucketUpperBound(std::size_t index) noexcept;
+    [[nodiscard]] std::uint64_t quantile(double fraction, std::uint64_t count) const noexcept;
+
+    std::array<std::atomic<std::uint64_t>, kBucketCount> m_buckets{};
+    std::atomic<std::uint64_t> m_totalNs{0};
+    std::atomic<std::uint64_t> m_maxNs{0};
+};
+
+/**
+ * @brief 一条埋点的只读快照，label 用于同名指标的细分（例如按语句 ID 区分语句），detail 为标签的说明。
+ */
+struct MetricSnapshot {
+    enum class Kind { Counter, Histogram };
+
+    Kind kind = Kind::Counter;
+    Subsystem subsystem = Subsystem::Database;
+    std::string name;
+    std::string label;
+    std::string detail;            //!< describe() 登记的标签说明（语句 ID 对应的 SQL 文本），可为空。
+    std::uint64_t value = 0;       //!< 计数器取值。
+    Histogram::Snapshot timing;    //!< 直方图统计。
+};
+
+/**
+ * @class Registry
+ * @brief 进程级埋点注册表，按 (子系统, 名称, 标签) 登记计数器与直方图。
+ * 中文：返回的引用在进程生命周期内有效，调用点用函数内 static 缓存，只在首次经过时查表加锁；
+ *       已存在的条目走共享锁查找，可同时被多个读连接线程访问。
+ */
+class Registry {
+public:
+    static constexpr bool kCompiledIn = ROVE_ENABLE_METRICS != 0;  //!< 编译开关，面板据此提示埋点是否可用。
+
+    static Registry& instance();
+
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    [[nodiscard]] Counter& counter(Subsystem subsystem, std::string_view name, std::string_view label = {});
+    [[nodiscard]] Histogram& histogram(Subsystem subsystem, std::string_view name, std::string_view label = {});
+
+    /**
+     * @brief 为标签登记一段说明，面板作为提示、JSON 作为 detail 字段输出；同一标签只保留首次登记的说明。
+     * 中文：标签本身保持短小（如语句 ID），较长的原文只在这里存一份，不参与埋点查找。
+     */
+    void describe(std::string_view label, std::string_view detail);
+
+    /**
+     * @brief 按子系统、名称、标签排序的全部埋点快照。
+     */
+    [[nodiscard]] std::vector<MetricSnapshot> snapshot() const;
+
+    /**
+     * @brief 以 JSON 导出全部埋点，耗时单位为微秒。
+     */
+    [[nodiscard]] std::string toJson() const;
+
+    /**
+     * @brief 清零全部计数与直方图，保留已登记的条目（调用点缓存的引用仍然有效）。
+     */
+    void reset() noexcept;
+
+private:
+    Registry() = default;
+
+    using Key = std::tuple<Subsystem, std::string, std::string>;
+
+    mutable std::shared_mutex m_mutex;
+    std::map<Key, std::unique_ptr<Counter>, std::less<>> m_counters;
+    std::map<Key, std::unique_ptr<Histogram>, std::less<>> m_histograms;
+    std::map<std::string, std::string, std::less<>> m_details;
+};
+
+/**
+ * @class ScopedTimer
+ * @brief RAII 计时器：构造时取时间戳，析构时把耗时记入直方图；运行期关闭时不读时钟。
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram) noexcept
+        : m_histogram(isEnabled() ? &histogram : nullptr), m_start(m_histogram != nullptr ? Clock::now() : TimePoint{}) {}
+
+    ~ScopedTimer() {
+        if (m_histogram != nullptr) {
+            m_histogram->record(elapsedNanoseconds(m_start));
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    [[nodiscard]] static std::uint64_t elapsedNanoseconds(TimePoint start) noexcept {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+private:
+    Histogram* m_histogram;
+    TimePoint m_start;
+};
+
+/**
+ * @brief 跨函数区间（如事务开始到提交）的起点；运行期关闭时返回零值，ROVE_RECORD_SINCE 据此跳过记录。
+ */
+[[nodiscard]] inline TimePoint startTiming() noexcept { return isEnabled() ? Clock::now() : TimePoint{}; }
+
+/**
+ * @brief 一把具名锁在注册表中的埋点，标签为锁名：acquire/contended 计数、争用时的 wait 与独占期间的 hold 直方图。
+ */
+struct LockProfile {
+    Counter* acquired = nullptr;
+    Counter* contended = nullptr;
+    Histogram* wait = nullptr;
+    Histogram* hold = nullptr;
+    Counter* sharedAcquired = nullptr;
+    Counter* sharedContended = nullptr;
+    Histogram* sharedWait = nullptr;
+
+    [[nodiscard]] static LockProfile forLock(std::string_view name);
+};
+
+/**
+ * @class ProfiledMutex
+ * @brief 包装标准互斥量并记录等待与持有时间，满足 Lockable（及 Mutex 为 std::shared_mutex 时的 SharedLockable），
+ *        可直接配合 std::lock_guard / std::unique_lock / std::shared_lock 使用。
+ * 中文：先 try_lock，成功即视为无争用、不读时钟；失败才计时阻塞等待。持有时间从最外层加锁记到最外层解锁，
+ *       递归互斥量的嵌套加锁不重复计时。共享锁可被多个读者同时持有，只记等待与争用次数。
+ *       编译关闭埋点时换用下方只接受名称的派生类，加解锁即底层互斥量自身的成员函数。
+ */
+#if ROVE_ENABLE_METRICS
+template <typename Mutex>
+class ProfiledMutex {
+public:
+    explicit ProfiledMutex(std::string_view name) : m_profile(LockProfile::forLock(name)) {}
+
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+    void lock() {
+        if (isEnabled()) {
+            if (!m_mutex.try_lock()) {
+                const TimePoint start = Clock::now();
+                m_mutex.lock();
+                m_profile.wait->record(ScopedTimer::elapsedNanoseconds(start));
+                m_profile.contended->add();
+            }
+            m_profile.acquired->add();
+            if (m_depth++ == 0) {
+                m_acquiredAt = Clock::now();
+            }
+            return;
+        }
+        m_mutex.lock();
+        ++m_depth;
+    }
+
+    [[nodiscard]] bool try_lock() {
+        if (!m_mutex.try_lock()) {
+            return false;
+        }
+        if (m_depth++ == 0) {
+            m_acquiredAt = startTiming();
+        }
+        return true;
+    }
+
+    void unlock() {
+        if (--m_depth == 0 && m_acquiredAt != TimePoint{}) {
+            const std::uint64_t held = ScopedTimer::elapsedNanoseconds(m_acquiredAt);
+            m_acquiredAt = TimePoint{};
+            m_mutex.unlock();
+            m_profile.hold->record(held);
+            return;
+        }
+        m_mutex.unlock();
+    }
+
+    void lock_shared() {
+        if (isEnabled()) {
+            if (!m_mutex.try_lock_shared()) {
+                const TimePoint start = Clock::now();
+                m_mutex.lock_shared();
+                m_profile.sharedWait->record(ScopedTimer::elapsedNanoseconds(start));
+                m_profile.sharedContended->add();
+            }
+            m_profile.sharedAcquired->add();
+            return;
+        }
+        m_mutex.lock_shared();
+    }
+
+    [[nodiscard]] bool try_lock_shared() { return m_mutex.try_lock_shared(); }
+    void unlock_shared() { m_mutex.unlock_shared(); }
+
+private:
+    Mutex m_mutex;
+    LockProfile m_profile;
+    int m_depth = 0;          //!< 独占加锁深度，只由持有者线程修改。
+    TimePoint m_acquiredAt;   //!< 最外层独占加锁时刻；加锁时运行期开关关闭则为零值，解锁时不计持有时间。
+};
+#else
+template <typename Mutex>
+class ProfiledMutex : public Mutex {
+public:
+    explicit ProfiledMutex(std::string_view /*name*/) {}
+};
+#endif
+
+}  // namespace rove::metrics
+
+#define ROVE_METRICS_CONCAT_INNER(a, b) a##b
+#define ROVE_METRICS_CONCAT(a, b) ROVE_METRICS_CONCAT_INNER(a, b)
+
+#if ROVE_ENABLE_METRICS
+/// 为当前作用域计时，subsystem 取 rove::metrics::Subsystem 的枚举名。
+#define ROVE_SCOPED_TIMER(subsystem, name)                                                              \
+    static ::rove::metrics::Histogram& ROVE_METRICS_CONCAT(roveMetricHistogram, __LINE__) =            \
+        ::rove::metrics::Registry::instance().histogram(::rove::metrics::Subsystem::subsystem, name); \
+    const ::rove::metrics::ScopedTimer ROVE_METRICS_CONCAT(roveMetricTimer, __LINE__)(                \
+        ROVE_METRICS_CONCAT(roveMetricHistogram, __LINE__))
+
+#define ROVE_COUNTER_ADD(subsystem, name, delta)                                                          \
+    do {                                                                                                  \
+        if (::rove::metrics::isEnabled()) {                                                               \
+            static ::rove::metrics::Counter& roveMetricCounter =                                          \
+                ::rove::metrics::Registry::instance().counter(::rove::metrics::Subsystem::subsystem, name); \
+            roveMetricCounter.add(static_cast<std::uint64_t>(delta));                                     \
+        }                                                                                                 \
+    } while (false)
+
+/// 把 start（来自 startTiming()）到现在的耗时记入直方图。
+#define ROVE_RECORD_SINCE(subsystem, name, start)                                                             \
+    do {                                                                                                      \
+        if ((start) != ::rove::metrics::TimePoint{}) {                                                        \
+            static ::rove::metrics::Histogram& roveMetricHistogram =                                          \
+                ::rove::metrics::Registry::instance().histogram(::rove::metrics::Subsystem::subsystem, name); \
+            roveMetricHistogram.record(::rove::metrics::ScopedTimer::elapsedNanoseconds(start));              \
+        }                                                                                                     \
+    } while (false)
+#else
+#define ROVE_SCOPED_TIMER(subsystem, name) static_cast<void>(0)
+#define ROVE_COUNTER_ADD(subsystem, name, delta) static_cast<void>(0)
+#define ROVE_RECORD_SINCE(subsystem, name, start) static_cast<void>(0)
+#endif
+
+#endif  // METRICS_H
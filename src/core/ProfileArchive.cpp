@@ -0,0 +1,265 @@
+#include "ProfileArchive.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "RecordCodec.h"
+
+namespace rove::data {
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'L', 'P', 'R', 'O', 'F', '\0', '\0'};
+constexpr std::uint32_t kArchiveFormatV1 = 1;
+constexpr char kTableTag = 'T';
+constexpr char kChunkTag = 'C';
+constexpr char kEndTag = 'Z';
+constexpr std::size_t kMaxChunkBytes = 64u * 1024 * 1024;  //!< 单行超过分块大小时分块随之变大，超出此值视为损坏
+
+void putName(std::string& out, const std::string& name) {
+    if (name.size() > 0xFFFF) {
+        throw std::runtime_error("Profile archive name too long: " + name.substr(0, 64));
+    }
+    codec::putU16(out, static_cast<std::uint16_t>(name.size()));
+    out.append(name);
+}
+
+[[noreturn]] void corrupted(const char* what) {
+    throw std::runtime_error(std::string("Corrupted profile archive: ") + what);
+}
+
+}  // namespace
+
+ProfileArchiveWriter::ProfileArchiveWriter(std::ostream& out, const ProfileArchiveHeader& header) : m_out(out) {
+    m_chunk.reserve(kChunkBytes + 4096);
+    std::string head(kMagic, sizeof(kMagic));
+    codec::putU32(head, kArchiveFormatV1);
+    codec::putU32(head, header.schemaVersion);
+    codec::putI32(head, header.sourceUserId);
+    codec::putI64(head, header.exportedAtMs);
+    codec::putU64(head, header.totalRows);
+    m_out.write(head.data(), static_cast<std::streamsize>(head.size()));
+}
+
+void ProfileArchiveWriter::beginTable(const ProfileArchiveTable& table) {
+    flushChunk();
+    std::string head(1, kTableTag);
+    putName(head, table.name);
+    codec::putU16(head, static_cast<std::uint16_t>(table.columns.size()));
+    for (const auto& column : table.columns) {
+        putName(head, column);
+    }
+    codec::putU64(head, table.rowCount);
+    m_out.write(head.data(), static_cast<std::streamsize>(head.size()));
+}
+
+void ProfileArchiveWriter::putNull() { m_chunk.push_back(static_cast<char>(ProfileArchiveValue::Type::Null)); }
+
+void ProfileArchiveWriter::putInteger(std::int64_t value) {
+    m_chunk.push_back(static_cast<char>(ProfileArchiveValue::Type::Integer));
+    codec::putI64(m_chunk, value);
+}
+
+void ProfileArchiveWriter::putReal(double value) {
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    m_chunk.push_back(static_cast<char>(ProfileArchiveValue::Type::Real));
+    codec::putU64(m_chunk, bits);
+}
+
+void ProfileArchiveWriter::putText(std::string_view value) {
+    m_chunk.push_back(static_cast<char>(ProfileArchiveValue::Type::Text));
+    codec::putU32(m_chunk, static_cast<std::uint32_t>(value.size()));
+    m_chunk.append(value);
+}
+
+void ProfileArchiveWriter::putBlob(std::string_view value) {
+    m_chunk.push_back(static_cast<char>(ProfileArchiveValue::Type::Blob));
+    codec::putU32(m_chunk, static_cast<std::uint32_t>(value.size()));
+    m_chunk.append(value);
+}
+
+void ProfileArchiveWriter::endRow() {
+    ++m_chunkRows;
+    ++m_rowsWritten;
+    if (m_chunk.size() >= kChunkBytes) {
+        flushChunk();
+    }
+}
+
+void ProfileArchiveWriter::finish() {
+    flushChunk();
+    std::string tail(1, kEndTag);
+    codec::putU64(tail, m_rowsWritten);
+    m_out.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+    m_out.flush();
+}
+
+bool ProfileArchiveWriter::ok() const { return static_cast<bool>(m_out); }
+
+void ProfileArchiveWriter::flushChunk() {
+    if (m_chunkRows == 0) {
+        return;
+    }
+    std::string head(1, kChunkTag);
+    codec::putU32(head, static_cast<std::uint32_t>(m_chunkRows));
+    codec::putU32(head, static_cast<std::uint32_t>(m_chunk.size()));
+    m_out.write(head.data(), static_cast<std::streamsize>(head.size()));
+    m_out.write(m_chunk.data(), static_cast<std::streamsize>(m_chunk.size()));
+    m_chunk.clear();
+    m_chunkRows = 0;
+}
+
+ProfileArchiveReader::ProfileArchiveReader(std::istream& in) : m_in(in) {
+    char head[36];
+    readExact(head, sizeof(head));
+    if (std::memcmp(head, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a profile archive");
+    }
+    codec::ByteReader reader{std::string_view(head, sizeof(head)), sizeof(kMagic)};
+    const std::uint32_t format = reader.u32();
+    if (format != kArchiveFormatV1) {
+        throw std::runtime_error("Unsupported profile archive format " + std::to_string(format));
+    }
+    m_header.schemaVersion = reader.u32();
+    m_header.sourceUserId = reader.i32();
+    m_header.exportedAtMs = reader.i64();
+    m_header.totalRows = reader.u64();
+}
+
+bool ProfileArchiveReader::nextTable(ProfileArchiveTable& table) {
+    if (m_finished) {
+        return false;
+    }
+    if (m_inTable) {
+        std::vector<ProfileArchiveValue> skipped;
+        while (nextRow(skipped)) {
+        }
+    }
+    const std::uint8_t tag = readTag();
+    if (tag == kEndTag) {
+        char tail[8];
+        readExact(tail, sizeof(tail));
+        if (codec::ByteReader{std::string_view(tail, sizeof(tail))}.u64() != m_rowsRead ||
+            m_rowsRead != m_header.totalRows) {
+            corrupted("row total mismatch");
+        }
+        m_finished = true;
+        return false;
+    }
+    if (tag != kTableTag) {
+        corrupted("expected table header");
+    }
+    const auto readName = [this]() {
+        char length[2];
+        readExact(length, sizeof(length));
+        std::string name(codec::ByteReader{std::string_view(length, sizeof(length))}.u16(), '\0');
+        readExact(name.data(), name.size());
+        return name;
+    };
+    table.name = readName();
+    char count[8];
+    readExact(count, 2);
+    m_columnCount = codec::ByteReader{std::string_view(count, 2)}.u16();
+    table.columns.clear();
+    for (std::size_t i = 0; i < m_columnCount; ++i) {
+        table.columns.push_back(readName());
+    }
+    readExact(count, 8);
+    table.rowCount = codec::ByteReader{std::string_view(count, 8)}.u64();
+    m_tableRowsLeft = table.rowCount;
+    m_inTable = true;
+    return true;
+}
+
+bool ProfileArchiveReader::nextRow(std::vector<ProfileArchiveValue>& row) {
+    if (!m_inTable || m_tableRowsLeft == 0) {
+        m_inTable = false;
+        return false;
+    }
+    if (m_chunkRowsLeft == 0) {
+        if (readTag() != kChunkTag) {
+            corrupted("expected row chunk");
+        }
+        loadChunk();
+    }
+    row.resize(m_columnCount);
+    codec::ByteReader reader{m_chunk, m_chunkPos};
+    for (auto& value : row) {
+        const std::uint8_t type = reader.u8();
+        if (!reader.ok) {
+            corrupted("row overruns chunk");
+        }
+        switch (static_cast<ProfileArchiveValue::Type>(type)) {
+        case ProfileArchiveValue::Type::Null:
+            break;
+        case ProfileArchiveValue::Type::Integer:
+        case ProfileArchiveValue::Type::Real: {
+            const std::uint64_t bits = reader.u64();
+            if (!reader.ok) {
+                corrupted("truncated number");
+            }
+            value.integer = static_cast<std::int64_t>(bits);
+            std::memcpy(&value.real, &bits, sizeof(bits));
+            break;
+        }
+        case ProfileArchiveValue::Type::Text:
+        case ProfileArchiveValue::Type::Blob: {
+            const std::uint32_t length = reader.u32();
+            if (!reader.ok) {
+                corrupted("truncated length");
+            }
+            const std::string_view bytes = reader.bytes(length);
+            if (!reader.ok) {
+                corrupted("truncated bytes");
+            }
+            value.bytes.assign(bytes);
+            break;
+        }
+        default:
+            corrupted("unknown value type");
+        }
+        value.type = static_cast<ProfileArchiveValue::Type>(type);
+    }
+    m_chunkPos = reader.pos;
+    --m_chunkRowsLeft;
+    --m_tableRowsLeft;
+    ++m_rowsRead;
+    if (m_chunkRowsLeft == 0 && m_chunkPos != m_chunk.size()) {
+        corrupted("trailing bytes in chunk");
+    }
+    return true;
+}
+
+std::uint8_t ProfileArchiveReader::readTag() {
+    char tag = 0;
+    readExact(&tag, 1);
+    return static_cast<std::uint8_t>(tag);
+}
+
+void ProfileArchiveReader::readExact(char* data, std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    m_in.read(data, static_cast<std::streamsize>(size));
+    if (m_in.gcount() != static_cast<std::streamsize>(size)) {
+        corrupted("unexpected end of file");
+    }
+}
+
+void ProfileArchiveReader::loadChunk() {
+    char head[8];
+    readExact(head, sizeof(head));
+    codec::ByteReader reader{std::string_view(head, sizeof(head))};
+    const std::uint32_t rows = reader.u32();
+    const std::size_t bytes = reader.u32();
+    if (rows == 0 || rows > m_tableRowsLeft || bytes > kMaxChunkBytes) {
+        corrupted("bad chunk header");
+    }
+    m_chunk.resize(bytes);
+    readExact(m_chunk.data(), bytes);
+    m_chunkPos = 0;
+    m_chunkRowsLeft = rows;
+}
+
+}  // namespace rove::data
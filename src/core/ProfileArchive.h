@@ -0,0 +1,139 @@
+#ifndef PROFILEARCHIVE_H
+#define PROFILEARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rove::data {
+
+/**
+ * @brief 用户档案归档的文件头。
+ * 中文：schemaVersion 为导出时的库结构版本，导入时不得高于当前版本；totalRows 为全部表的行数之和，
+ *       导入方据此在读取第一行前就能报告进度。
+ */
+struct ProfileArchiveHeader {
+    std::uint32_t schemaVersion = 0;
+    std::int32_t sourceUserId = 0;
+    std::int64_t exportedAtMs = 0;
+    std::uint64_t totalRows = 0;
+};
+
+/**
+ * @brief 归档中的一张表：名称、列名与行数。
+ */
+struct ProfileArchiveTable {
+    std::string name;
+    std::vector<std::string> columns;
+    std::uint64_t rowCount = 0;
+};
+
+/**
+ * @brief 一个列值，类型与 SQLite 的五种存储类一一对应；Text 与 Blob 的内容都在 bytes 中。
+ */
+struct ProfileArchiveValue {
+    enum class Type : std::uint8_t { Null = 0, Integer, Real, Text, Blob };
+
+    Type type = Type::Null;
+    std::int64_t integer = 0;
+    double real = 0.0;
+    std::string bytes;
+};
+
+/**
+ * @class ProfileArchiveWriter
+ * @brief 流式写出用户档案归档，内存占用不超过一个分块。
+ * 中文：布局（小端序）：
+ *         8 字节魔数 "CLPROF\0\0"，u32 格式版本，u32 库结构版本，i32 来源用户 id，i64 导出时刻，u64 总行数；
+ *         每张表：u8 'T'，u16 名称长度 + 名称，u16 列数，逐列 u16 长度 + 列名，u64 行数；
+ *         表内若干分块：u8 'C'，u32 行数，u32 字节数，随后是逐行逐列的值（u8 类型，整数 i64，实数 8 字节 IEEE 754，
+ *         文本与 BLOB 为 u32 长度 + 内容）；
+ *         结尾：u8 'Z'，u64 总行数。
+ *       行累积到 kChunkBytes 后整块写出，读取方按分块字节数一次读入，同样只缓冲一个分块。
+ *       写出失败由 ok() 报告，不抛出异常。
+ */
+class ProfileArchiveWriter {
+public:
+    static constexpr std::size_t kChunkBytes = 256 * 1024;
+
+    ProfileArchiveWriter(std::ostream& out, const ProfileArchiveHeader& header);
+
+    /**
+     * @brief 开始一张表；上一张表未写出的行先作为分块写出。
+     */
+    void beginTable(const ProfileArchiveTable& table);
+
+    void putNull();
+    void putInteger(std::int64_t value);
+    void putReal(double value);
+    void putText(std::string_view value);
+    void putBlob(std::string_view value);
+
+    /**
+     * @brief 结束当前行，缓冲达到分块大小时写出。
+     */
+    void endRow();
+
+    /**
+     * @brief 写出剩余分块与结尾标记并刷新流。
+     */
+    void finish();
+
+    [[nodiscard]] bool ok() const;
+    [[nodiscard]] std::uint64_t rowsWritten() const noexcept { return m_rowsWritten; }
+
+private:
+    void flushChunk();
+
+    std::ostream& m_out;
+    std::string m_chunk;
+    std::uint32_t m_chunkRows = 0;
+    std::uint64_t m_rowsWritten = 0;
+};
+
+/**
+ * @class ProfileArchiveReader
+ * @brief 流式读取 ProfileArchiveWriter 的输出，每次只缓冲一个分块。
+ * 中文：构造时校验魔数与格式版本；nextTable 与 nextRow 交替调用遍历全部行。
+ *       截断、分块越界、行数与表头不符或结尾总数不符时抛出 std::runtime_error，调用方据此回滚导入。
+ */
+class ProfileArchiveReader {
+public:
+    explicit ProfileArchiveReader(std::istream& in);
+
+    [[nodiscard]] const ProfileArchiveHeader& header() const noexcept { return m_header; }
+
+    /**
+     * @brief 读取下一张表的表头；到达结尾标记时返回 false。当前表未读完的行被跳过。
+     */
+    bool nextTable(ProfileArchiveTable& table);
+
+    /**
+     * @brief 读取当前表的下一行，复用 row 已有的存储；当前表读完时返回 false。
+     */
+    bool nextRow(std::vector<ProfileArchiveValue>& row);
+
+private:
+    std::uint8_t readTag();
+    void readExact(char* data, std::size_t size);
+    void loadChunk();
+
+    std::istream& m_in;
+    ProfileArchiveHeader m_header;
+    std::string m_chunk;
+    std::size_t m_chunkPos = 0;
+    std::uint32_t m_chunkRowsLeft = 0;
+    std::size_t m_columnCount = 0;
+    std::uint64_t m_tableRowsLeft = 0;
+    std::uint64_t m_rowsRead = 0;
+    bool m_inTable = false;
+    bool m_finished = false;
+};
+
+}  // namespace rove::data
+
+#endif  // PROFILEARCHIVE_H
@@ -0,0 +1,173 @@
+#include "RecordCodec.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+
+namespace rove::data::codec {
+namespace {
+
+bool parseInt(std::string_view token, int& value) {
+    const char* end = token.data() + token.size();
+    const auto result = std::from_chars(token.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+Achievement::Condition::ConditionType toConditionType(int raw) {
+    return static_cast<Achievement::Condition::ConditionType>(raw);
+}
+
+/**
+ * @brief 旧版文本格式解析：按 ';' 切分条目，按 ',' 切分前三个数值字段，其余部分为元数据。
+ */
+void decodeLegacyConditions(std::string_view text, std::vector<Achievement::Condition>& out) {
+    while (!text.empty()) {
+        const std::size_t end = text.find(';');
+        std::string_view segment = text.substr(0, end);
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+        if (segment.empty()) {
+            continue;
+        }
+        std::string_view fields[3];
+        bool complete = true;
+        for (auto& field : fields) {
+            const std::size_t comma = segment.find(',');
+            field = segment.substr(0, comma);
+            if (comma == std::string_view::npos) {
+                segment = std::string_view();
+                complete = &field == &fields[2];
+                break;
+            }
+            segment.remove_prefix(comma + 1);
+        }
+        int type = 0;
+        int target = 0;
+        int current = 0;
+        if (!complete || !parseInt(fields[0], type) || !parseInt(fields[1], target)
+            || !parseInt(fields[2], current)) {
+            continue;
+        }
+        Achievement::Condition& condition = out.emplace_back();
+        condition.type = toConditionType(type);
+        condition.targetValue = std::max(1, target);
+        condition.currentValue = std::max(0, current);
+        condition.metadata.assign(segment.data(), segment.size());
+    }
+}
+
+int parseIntOrZero(std::string_view token) {
+    int value = 0;
+    return parseInt(token, value) ? value : 0;
+}
+
+}  // namespace
+
+AttributeFields attributeFields(const User::AttributeSet& set) noexcept {
+    return {set.execution, set.perseverance, set.decision, set.knowledge, set.social, set.pride};
+}
+
+User::AttributeSet attributesFromFields(const AttributeFields& fields) noexcept {
+    User::AttributeSet set;
+    set.execution = fields[0];
+    set.perseverance = fields[1];
+    set.decision = fields[2];
+    set.knowledge = fields[3];
+    set.social = fields[4];
+    set.pride = fields[5];
+    return set;
+}
+
+User::AttributeSet decodeLegacyAttributes(std::string_view text) noexcept {
+    static constexpr std::string_view kKeys[kAttributeFieldCount] = {
+        "execution", "perseverance", "decision", "knowledge", "social", "pride"};
+    AttributeFields fields{};
+    if (text.find('=') == std::string_view::npos) {
+        for (std::size_t i = 0; i < kAttributeFieldCount && !text.empty(); ++i) {
+            const std::size_t comma = text.find(',');
+            fields[i] = parseIntOrZero(text.substr(0, comma));
+            text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+        }
+        return attributesFromFields(fields);
+    }
+    while (!text.empty()) {
+        const std::size_t end = text.find(';');
+        const std::string_view segment = text.substr(0, end);
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+        const std::size_t separator = segment.find('=');
+        if (separator == std::string_view::npos) {
+            continue;
+        }
+        const std::string_view key = segment.substr(0, separator);
+        for (std::size_t i = 0; i < kAttributeFieldCount; ++i) {
+            if (key == kKeys[i]) {
+                fields[i] = parseIntOrZero(segment.substr(separator + 1));
+                break;
+            }
+        }
+    }
+    return attributesFromFields(fields);
+}
+
+std::string encodeConditions(const std::vector<Achievement::Condition>& conditions) {
+    constexpr std::size_t kMaxField = std::numeric_limits<std::uint16_t>::max();
+    const std::size_t count = std::min<std::size_t>(conditions.size(), kMaxField);
+    std::size_t size = 3;
+    for (std::size_t i = 0; i < count; ++i) {
+        size += 13 + std::min(conditions[i].metadata.size(), kMaxField) +
+                8 * std::min(conditions[i].ruleHits.size(), kMaxField);
+    }
+    std::string out;
+    out.reserve(size);
+    out.push_back(static_cast<char>(kConditionFormatV2));
+    putU16(out, static_cast<std::uint16_t>(count));
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& condition = conditions[i];
+        const std::size_t metadataSize = std::min(condition.metadata.size(), kMaxField);
+        const std::size_t hitCount = std::min(condition.ruleHits.size(), kMaxField);
+        out.push_back(static_cast<char>(condition.type));
+        putI32(out, condition.targetValue);
+        putI32(out, condition.currentValue);
+        putU16(out, static_cast<std::uint16_t>(metadataSize));
+        out.append(condition.metadata, 0, metadataSize);
+        putU16(out, static_cast<std::uint16_t>(hitCount));
+        // 保留最新的命中：超出上限时丢弃最早的部分。
+        for (std::size_t h = condition.ruleHits.size() - hitCount; h < condition.ruleHits.size(); ++h) {
+            putI64(out, condition.ruleHits[h]);
+        }
+    }
+    return out;
+}
+
+void decodeConditions(std::string_view blob, std::vector<Achievement::Condition>& out) {
+    out.clear();
+    const unsigned char format = blob.empty() ? 0 : static_cast<unsigned char>(blob.front());
+    if (format != kConditionFormatV1 && format != kConditionFormatV2) {
+        decodeLegacyConditions(blob, out);
+        return;
+    }
+    ByteReader reader{blob, 1};
+    const std::uint16_t count = reader.u16();
+    out.reserve(count);
+    for (std::uint16_t i = 0; i < count && reader.ok; ++i) {
+        const std::uint8_t type = reader.u8();
+        const std::int32_t target = reader.i32();
+        const std::int32_t current = reader.i32();
+        const std::string_view metadata = reader.bytes(reader.u16());
+        const std::uint16_t hitCount = format == kConditionFormatV2 ? reader.u16() : 0;
+        if (!reader.ok || !reader.require(std::size_t{8} * hitCount)) {
+            break;
+        }
+        Achievement::Condition& condition = out.emplace_back();
+        condition.type = toConditionType(type);
+        condition.targetValue = std::max<int>(1, target);
+        condition.currentValue = std::max<int>(0, current);
+        condition.metadata.assign(metadata.data(), metadata.size());
+        condition.ruleHits.reserve(hitCount);
+        for (std::uint16_t h = 0; h < hitCount; ++h) {
+            condition.ruleHits.push_back(reader.i64());
+        }
+    }
+}
+
+}  // namespace rove::data::codec
@@ -0,0 +1,133 @@
+#ifndef RECORDCODEC_H
+#define RECORDCODEC_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Achievement.h"
+#include "User.h"
+
+namespace rove::data::codec {
+
+/**
+ * @brief 按小端序把 value 的低 width 字节追加到 out。
+ * 中文：各二进制格式（成就条件、事件日志、档案、动态流）共用同一套定宽整数写法。
+ */
+inline void putLittleEndian(std::string& out, std::uint64_t value, std::size_t width) {
+    for (std::size_t i = 0; i < width; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+inline void putU8(std::string& out, std::uint8_t value) { putLittleEndian(out, value, 1); }
+inline void putU16(std::string& out, std::uint16_t value) { putLittleEndian(out, value, 2); }
+inline void putU32(std::string& out, std::uint32_t value) { putLittleEndian(out, value, 4); }
+inline void putI32(std::string& out, std::int32_t value) { putU32(out, static_cast<std::uint32_t>(value)); }
+inline void putU64(std::string& out, std::uint64_t value) { putLittleEndian(out, value, 8); }
+inline void putI64(std::string& out, std::int64_t value) { putU64(out, static_cast<std::uint64_t>(value)); }
+
+/**
+ * @brief 顺序读取小端序字节的游标，越界时置 ok = false 并返回 0，而不是抛异常。
+ * 中文：调用方读完一组字段后检查一次 ok 即可，不必逐字段判断长度。
+ */
+struct ByteReader {
+    std::string_view data;
+    std::size_t pos = 0;
+    bool ok = true;
+
+    bool require(std::size_t count) {
+        ok = ok && data.size() - pos >= count;
+        return ok;
+    }
+
+    std::uint64_t littleEndian(std::size_t width) {
+        if (!require(width)) {
+            return 0;
+        }
+        std::uint64_t bits = 0;
+        for (std::size_t i = 0; i < width; ++i) {
+            bits |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(data[pos + i])) << (8 * i);
+        }
+        pos += width;
+        return bits;
+    }
+
+    std::uint8_t u8() { return static_cast<std::uint8_t>(littleEndian(1)); }
+    std::uint16_t u16() { return static_cast<std::uint16_t>(littleEndian(2)); }
+    std::uint32_t u32() { return static_cast<std::uint32_t>(littleEndian(4)); }
+    std::int32_t i32() { return static_cast<std::int32_t>(u32()); }
+    std::uint64_t u64() { return littleEndian(8); }
+    std::int64_t i64() { return static_cast<std::int64_t>(u64()); }
+
+    std::string_view bytes(std::size_t count) {
+        if (!require(count)) {
+            return {};
+        }
+        const std::string_view view = data.substr(pos, count);
+        pos += count;
+        return view;
+    }
+};
+
+/**
+ * @brief 成就条件二进制格式的版本标记，位于编码首字节。
+ * 中文：旧版文本格式总以数字开头（或为空），因此首字节即可区分两种格式。
+ *
+ * 布局（小端序）：
+ *   u8  版本标记 kConditionFormatV1
+ *   u16 条件数量 N
+ *   N × { u8 类型, i32 目标值, i32 当前值, u16 元数据长度 L, L 字节元数据 }
+ */
+inline constexpr unsigned char kConditionFormatV1 = 0xC1;
+
+/**
+ * @brief V2 在每个条目末尾追加规则窗口状态：u16 命中数 H，H × i64 命中时刻（毫秒）。
+ * 中文：只有带时间窗的 Rule 条件会写入命中时刻，其余条目 H 为 0；V1 数据照常解码，命中列表为空。
+ */
+inline constexpr unsigned char kConditionFormatV2 = 0xC2;
+
+/**
+ * @brief 将条件列表编码为紧凑二进制格式，结果可能包含 NUL 字节，需以 BLOB 形式存取。
+ */
+[[nodiscard]] std::string encodeConditions(const std::vector<Achievement::Condition>& conditions);
+
+/**
+ * @brief 解码条件列表，自动识别二进制格式（V1/V2）与旧版 "type,target,current,metadata;..." 文本格式。
+ * 中文：解析过程直接在 string_view 上进行，除输出向量与元数据字符串外不做任何堆分配。
+ *       数值按既有规则修正（目标值至少为 1、当前值不小于 0），损坏的条目被跳过。
+ * @param blob 数据库中读取的原始字节。
+ * @param out 输出列表，调用前会被清空；复用同一向量可避免重复分配。
+ */
+void decodeConditions(std::string_view blob, std::vector<Achievement::Condition>& out);
+
+/**
+ * @brief 六维属性的固定字段数，数据库中对应 attr_execution … attr_pride 六个整数列。
+ */
+inline constexpr std::size_t kAttributeFieldCount = 6;
+
+using AttributeFields = std::array<int, kAttributeFieldCount>;
+
+/**
+ * @brief 按固定顺序（行动力、毅力、决断力、知识力、社交力、自豪感）展开属性集合。
+ */
+[[nodiscard]] AttributeFields attributeFields(const User::AttributeSet& set) noexcept;
+
+/**
+ * @brief attributeFields 的逆操作。
+ */
+[[nodiscard]] User::AttributeSet attributesFromFields(const AttributeFields& fields) noexcept;
+
+/**
+ * @brief 解析旧版属性文本，仅供迁移使用。
+ * 中文：兼容两种历史格式——成就奖励的 "e,p,d,k,s,pride" 逗号列表，以及任务奖励与用户数据的
+ *       "execution=1;pride=2" 键值串（未知键被忽略，非法数值按 0 处理）。
+ */
+[[nodiscard]] User::AttributeSet decodeLegacyAttributes(std::string_view text) noexcept;
+
+}  // namespace rove::data::codec
+
+#endif  // RECORDCODEC_H
@@ -0,0 +1,94 @@
+#include "RewardRules.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rove::data::rewards {
+
+namespace {
+
+int scaleReward(int base, double factor) noexcept {
+    return std::max(0, static_cast<int>(std::round(base * factor)));
+}
+
+}  // namespace
+
+RewardInput RewardInput::fromTask(const Task& task) {
+    RewardInput input;
+    input.type = task.type();
+    input.difficultyStars = task.difficultyStars();
+    input.bonusStreak = task.bonusStreak();
+    input.baseCoins = task.coinReward();
+    input.baseGrowth = task.growthReward();
+    input.baseAttributes = task.attributeReward();
+    return input;
+}
+
+/**
+ * @brief 金币与成长值按难度×连胜倍率缩放，再按类型追加教育意义的属性奖励。
+ * 中文：每日任务强调执行力 +1；每周项目强调团队协作，社交 +星级；学期任务学识 +2×星级、毅力 +星级。
+ */
+template <Task::TaskType Type>
+RewardOutcome scoreAs(const RewardInput& input) noexcept {
+    const double factor = difficultyMultiplier(Type, input.difficultyStars) * streakMultiplier(input.bonusStreak);
+    RewardOutcome outcome;
+    outcome.coins = scaleReward(input.baseCoins, factor);
+    outcome.growth = scaleReward(input.baseGrowth, factor);
+    outcome.attributes = input.baseAttributes;
+    if constexpr (Type == Task::TaskType::Daily) {
+        outcome.attributes.execution += 1;
+    } else if constexpr (Type == Task::TaskType::Weekly) {
+        outcome.attributes.social += input.difficultyStars;
+        outcome.weeklyStreakMilestone = (input.bonusStreak + 1) % 4 == 0;
+    } else if constexpr (Type == Task::TaskType::Semester) {
+        outcome.attributes.knowledge += input.difficultyStars * 2;
+        outcome.attributes.perseverance += input.difficultyStars;
+    }
+    return outcome;
+}
+
+template RewardOutcome scoreAs<Task::TaskType::Daily>(const RewardInput&) noexcept;
+template RewardOutcome scoreAs<Task::TaskType::Weekly>(const RewardInput&) noexcept;
+template RewardOutcome scoreAs<Task::TaskType::Semester>(const RewardInput&) noexcept;
+template RewardOutcome scoreAs<Task::TaskType::Custom>(const RewardInput&) noexcept;
+
+RewardOutcome score(const RewardInput& input) noexcept {
+    switch (input.type) {
+        case Task::TaskType::Daily:
+            return scoreAs<Task::TaskType::Daily>(input);
+        case Task::TaskType::Weekly:
+            return scoreAs<Task::TaskType::Weekly>(input);
+        case Task::TaskType::Semester:
+            return scoreAs<Task::TaskType::Semester>(input);
+        case Task::TaskType::Custom:
+            return scoreAs<Task::TaskType::Custom>(input);
+    }
+    return scoreAs<Task::TaskType::Custom>(input);
+}
+
+void scoreBatch(const RewardInput* inputs, std::size_t count, RewardOutcome* outputs) noexcept {
+    for (std::size_t i = 0; i < count; ++i) {
+        outputs[i] = score(inputs[i]);
+    }
+}
+
+std::vector<RewardOutcome> scoreBatch(const std::vector<RewardInput>& inputs) {
+    std::vector<RewardOutcome> outputs(inputs.size());
+    scoreBatch(inputs.data(), inputs.size(), outputs.data());
+    return outputs;
+}
+
+RewardTotals sumBatch(const std::vector<RewardInput>& inputs) noexcept {
+    RewardTotals totals;
+    for (const auto& input : inputs) {
+        const RewardOutcome outcome = score(input);
+        totals.coins += outcome.coins;
+        totals.growth += outcome.growth;
+        totals.attributes.add(outcome.attributes);
+        totals.weeklyStreakMilestones += outcome.weeklyStreakMilestone ? 1 : 0;
+    }
+    totals.completions = inputs.size();
+    return totals;
+}
+
+}  // namespace rove::data::rewards
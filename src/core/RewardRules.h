@@ -0,0 +1,143 @@
+#ifndef REWARDRULES_H
+#define REWARDRULES_H
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "Task.h"
+#include "User.h"
+
+namespace rove::data::rewards {
+
+/**
+ * @file RewardRules.h
+ * @brief 任务奖励规则引擎：难度/连胜倍率为编译期常量表，等级曲线见 LevelCurve.h。
+ * 中文：TaskManager 结算与平衡模拟共用同一套公式；score()/scoreBatch() 不访问数据库与任何管理器，
+ *       可以在微秒级批量评估成千上万次模拟完成，用于调整数值。
+ */
+
+constexpr int kMinDifficultyStars = 1;
+constexpr int kMaxDifficultyStars = 5;
+constexpr std::size_t kTaskTypeCount = 4;
+constexpr std::size_t kStreakTableSize = 64;  //!< 连胜倍率表覆盖 0..63，更长的连胜按同一公式现算。
+
+/**
+ * @brief 难度-奖励平衡公式：1+(星级-1)*0.15，学期任务额外 +0.35，每周任务 +0.1。
+ */
+constexpr double difficultyFormula(Task::TaskType type, int stars) noexcept {
+    double factor = 1.0 + (static_cast<double>(stars) - 1.0) * 0.15;
+    if (type == Task::TaskType::Semester) {
+        factor += 0.35;
+    } else if (type == Task::TaskType::Weekly) {
+        factor += 0.1;
+    }
+    return factor;
+}
+
+/**
+ * @brief 连续完成奖励公式：每次连胜额外 +5%。
+ */
+constexpr double streakFormula(int streak) noexcept { return 1.0 + static_cast<double>(streak) * 0.05; }
+
+using DifficultyTable = std::array<std::array<double, kMaxDifficultyStars + 1>, kTaskTypeCount>;
+
+constexpr DifficultyTable makeDifficultyTable() noexcept {
+    DifficultyTable table{};
+    for (std::size_t type = 0; type < kTaskTypeCount; ++type) {
+        for (int stars = kMinDifficultyStars; stars <= kMaxDifficultyStars; ++stars) {
+            table[type][static_cast<std::size_t>(stars)] = difficultyFormula(static_cast<Task::TaskType>(type), stars);
+        }
+    }
+    return table;
+}
+
+constexpr std::array<double, kStreakTableSize> makeStreakTable() noexcept {
+    std::array<double, kStreakTableSize> table{};
+    for (std::size_t streak = 0; streak < kStreakTableSize; ++streak) {
+        table[streak] = streakFormula(static_cast<int>(streak));
+    }
+    return table;
+}
+
+/**
+ * @brief 按 [TaskType][星级] 索引的难度倍率；星级 0 不使用。
+ */
+inline constexpr DifficultyTable kDifficultyMultipliers = makeDifficultyTable();
+inline constexpr std::array<double, kStreakTableSize> kStreakMultipliers = makeStreakTable();
+
+constexpr double difficultyMultiplier(Task::TaskType type, int stars) noexcept {
+    const int clamped = stars < kMinDifficultyStars   ? kMinDifficultyStars
+                        : stars > kMaxDifficultyStars ? kMaxDifficultyStars
+                                                      : stars;
+    return kDifficultyMultipliers[static_cast<std::size_t>(type)][static_cast<std::size_t>(clamped)];
+}
+
+constexpr double streakMultiplier(int streak) noexcept {
+    if (streak <= 0) {
+        return 1.0;
+    }
+    return static_cast<std::size_t>(streak) < kStreakTableSize ? kStreakMultipliers[static_cast<std::size_t>(streak)]
+                                                               : streakFormula(streak);
+}
+
+/**
+ * @brief 一次任务完成的结算输入，取自 Task 或由模拟器直接构造。
+ */
+struct RewardInput {
+    Task::TaskType type = Task::TaskType::Daily;
+    int difficultyStars = kMinDifficultyStars;
+    int bonusStreak = 0;  //!< 本次完成前的连胜次数。
+    int baseCoins = 0;
+    int baseGrowth = 0;
+    User::AttributeSet baseAttributes;
+
+    [[nodiscard]] static RewardInput fromTask(const Task& task);
+};
+
+/**
+ * @brief 结算结果：最终金币、成长值与属性加成；weeklyStreakMilestone 表示每周任务连胜满 4 次，需额外解锁成就。
+ */
+struct RewardOutcome {
+    int coins = 0;
+    int growth = 0;
+    User::AttributeSet attributes;
+    bool weeklyStreakMilestone = false;
+};
+
+/**
+ * @brief 批量结算的汇总，平衡模拟据此比较不同参数下的产出。
+ */
+struct RewardTotals {
+    long long coins = 0;
+    long long growth = 0;
+    User::AttributeSet attributes;
+    int weeklyStreakMilestones = 0;
+    std::size_t completions = 0;
+};
+
+/**
+ * @brief 按任务类型在编译期特化的结算公式；类型相关的分支与倍率在实例化时即确定。
+ */
+template <Task::TaskType Type>
+[[nodiscard]] RewardOutcome scoreAs(const RewardInput& input) noexcept;
+
+/**
+ * @brief 单次结算，按 input.type 分派到对应的 scoreAs 特化。
+ */
+[[nodiscard]] RewardOutcome score(const RewardInput& input) noexcept;
+
+/**
+ * @brief 批量结算：outputs 需能容纳 count 个结果。
+ */
+void scoreBatch(const RewardInput* inputs, std::size_t count, RewardOutcome* outputs) noexcept;
+[[nodiscard]] std::vector<RewardOutcome> scoreBatch(const std::vector<RewardInput>& inputs);
+
+/**
+ * @brief 只累加不保存逐条结果，用于大规模平衡模拟。
+ */
+[[nodiscard]] RewardTotals sumBatch(const std::vector<RewardInput>& inputs) noexcept;
+
+}  // namespace rove::data::rewards
+
+#endif  // REWARDRULES_H
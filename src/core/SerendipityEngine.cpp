@@ -18,7 +18,12 @@ SerendipityEngine::SerendipityEngine(DatabaseManager& database, LogManager& logM
       m_logManager(logManager),
       m_userManager(userManager) {}
 
-SerendipityEngine::SerendipityResult SerendipityEngine::triggerDailyLogin() {
+SerendipityEngine::SerendipityResult SerendipityEngine::triggerDailyLogin(const QDate& today) {
+    if (!claimDailyLogin(today)) {
+        SerendipityResult result;
+        result.description = "今日奇遇已结算";
+        return result;
+    }
     SerendipityResult result = rollEvent();
     if (result.triggered) {
         std::string content = "奇遇事件：" + result.description;
@@ -27,7 +32,29 @@ SerendipityEngine::SerendipityResult SerendipityEngine::triggerDailyLogin() {
     return result;
 }
 
+bool SerendipityEngine::claimDailyLogin(const QDate& today) {
+    std::string key = "serendipity.login_day";
+    if (m_userManager.hasActiveUser()) {
+        key += ":" + std::to_string(m_userManager.activeUserId());
+    }
+    const qint64 day = today.toJulianDay();
+    bool claimed = false;
+    m_database.runInTransaction([&]() {
+        const std::optional<std::int64_t> last = m_database.getAppState(key);
+        if (!last.has_value() || *last < day) {
+            m_database.setAppState(key, day);
+            claimed = true;
+        }
+    });
+    return claimed;
+}
+
 void SerendipityEngine::updateProbability(const ProbabilityConfig& config) {
+    validateProbability(config);
+    m_config = config;
+}
+
+void SerendipityEngine::validateProbability(const ProbabilityConfig& config) {
     const auto validateRange = [](double value, const char* name) {
         if (value < 0.0 || value > 1.0) {
             throw std::invalid_argument(std::string(name) + " probability must be within [0,1]");
@@ -40,36 +67,52 @@ void SerendipityEngine::updateProbability(const ProbabilityConfig& config) {
     if (total > 1.0) {
         throw std::invalid_argument("Total probability cannot exceed 1.0");
     }
-    m_config = config;
 }
 
 SerendipityEngine::ProbabilityConfig SerendipityEngine::probability() const noexcept { return m_config; }
 
+SerendipityEngine::EventKind SerendipityEngine::classifyRoll(const ProbabilityConfig& config, double roll) noexcept {
+    const double taskThreshold = config.buffChance + config.taskChance;
+    const double rewardThreshold = taskThreshold + config.smallRewardChance;
+    if (roll < config.buffChance) {
+        return EventKind::Buff;
+    }
+    if (roll < taskThreshold) {
+        return EventKind::EasterEggTask;
+    }
+    if (roll < rewardThreshold) {
+        return EventKind::SmallReward;
+    }
+    return EventKind::Calm;
+}
+
 SerendipityEngine::SerendipityResult SerendipityEngine::rollEvent() {
     SerendipityResult result;
-    constexpr int kBuffDurationOneDayMinutes = 1440;
-    const double roll = random01();
-    const double taskThreshold = m_config.buffChance + m_config.taskChance;
-    const double rewardThreshold = taskThreshold + m_config.smallRewardChance;
-
-    if (roll < m_config.buffChance) {
-        result.triggered = true;
-        result.buffDurationMinutes = kBuffDurationOneDayMinutes;  // 当天有效
-        result.rewardMultiplier = 1.2;
-        result.description = "今日任务奖励 +20%";
-    } else if (roll < taskThreshold) {
-        result.triggered = true;
-        result.spawnedTask = true;
-        result.description = "获得彩蛋任务：校园探索";
-    } else if (roll < rewardThreshold) {
-        result.triggered = true;
-        result.description = "获得微小祝福，成长值 +5";
-        if (m_userManager.hasActiveUser()) {
-            auto& user = m_userManager.activeUser();
-            user.addGrowthPoints(5);
-        }
-    } else {
-        result.description = "今日平静如常";
+    switch (classifyRoll(m_config, random01())) {
+        case EventKind::Buff:
+            result.triggered = true;
+            result.buffDurationMinutes = kBuffDurationMinutes;
+            result.rewardMultiplier = kBuffRewardMultiplier;
+            result.description = "今日任务奖励 +20%";
+            break;
+        case EventKind::EasterEggTask:
+            result.triggered = true;
+            result.spawnedTask = true;
+            result.description = "获得彩蛋任务：校园探索";
+            break;
+        case EventKind::SmallReward:
+            result.triggered = true;
+            result.description = "获得微小祝福，成长值 +5";
+            if (m_userManager.hasActiveUser()) {
+                m_userManager.updateActiveUser([](User& user) {
+                    user.addGrowthPoints(kSmallRewardGrowth);
+                    return true;
+                });
+            }
+            break;
+        case EventKind::Calm:
+            result.description = "今日平静如常";
+            break;
     }
     return result;
 }
@@ -1,6 +1,7 @@
 #ifndef SERENDIPITYENGINE_H
 #define SERENDIPITYENGINE_H
 
+#include <QDate>
 #include <QObject>
 
 #include <random>
@@ -24,6 +25,15 @@ public:
         double smallRewardChance = 0.2;  // 小额奖励概率
     };
 
+    /**
+     * @brief 一次每日判定的结果类别；模拟器只需类别，不需要描述文本。
+     */
+    enum class EventKind { Calm, Buff, EasterEggTask, SmallReward };
+
+    static constexpr int kBuffDurationMinutes = 1440;  // 增益当天有效
+    static constexpr double kBuffRewardMultiplier = 1.2;
+    static constexpr int kSmallRewardGrowth = 5;
+
     struct SerendipityResult {
         bool triggered = false;
         std::string description;
@@ -42,8 +52,10 @@ public:
 
     /**
      * @brief 每日登录时调用，按概率返回奇遇结果并自动记录日志。
+     * 中文：每个用户每天只结算一次，已处理日期持久化在 app_state 中；当天重复打开窗口或重启应用时
+     *       返回未触发的结果，不再掷骰、不写日志。
      */
-    SerendipityResult triggerDailyLogin();
+    SerendipityResult triggerDailyLogin(const QDate& today = QDate::currentDate());
 
     /**
      * @brief 更新概率表，方便教师微调平衡。
@@ -55,9 +67,24 @@ public:
      */
     [[nodiscard]] ProbabilityConfig probability() const noexcept;
 
+    /**
+     * @brief 由 [0,1) 均匀随机数判定当天的奇遇类别，纯函数、无副作用；在线结算与 EconomySimulator 共用。
+     */
+    [[nodiscard]] static EventKind classifyRoll(const ProbabilityConfig& config, double roll) noexcept;
+
+    /**
+     * @brief 校验概率表：各项位于 [0,1] 且总和不超过 1，否则抛出 std::invalid_argument。
+     */
+    static void validateProbability(const ProbabilityConfig& config);
+
 private:
     SerendipityEngine(DatabaseManager& database, LogManager& logManager, UserManager& userManager);
 
+    /**
+     * @brief 若 today 尚未结算则推进水位并返回 true；读写在同一事务内，并发调用只有一个返回 true。
+     */
+    bool claimDailyLogin(const QDate& today);
+
     SerendipityResult rollEvent();
     double random01();
 
@@ -4,9 +4,83 @@
 #include <QString>
 
 #include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+#include "EnumText.h"
 
 namespace rove::data {
 
+namespace {
+constexpr EnumTextTable<ShopItem::ItemType, 3> kItemTypeText{{{
+    {ShopItem::ItemType::Physical, "Physical"},
+    {ShopItem::ItemType::Prop, "Prop"},
+    {ShopItem::ItemType::LuckyBag, "LuckyBag"},
+}}};
+
+constexpr EnumTextTable<ShopItem::PropEffectType, 4> kPropEffectText{{{
+    {ShopItem::PropEffectType::None, "None"},
+    {ShopItem::PropEffectType::RestDay, "RestDay"},
+    {ShopItem::PropEffectType::ForgivenessCoupon, "ForgivenessCoupon"},
+    {ShopItem::PropEffectType::DoubleExpCard, "DoubleExpCard"},
+}}};
+
+constexpr EnumTextTable<ShopItem::LuckyBagReward::RewardType, 3> kRewardTypeText{{{
+    {ShopItem::LuckyBagReward::RewardType::Coins, "Coins"},
+    {ShopItem::LuckyBagReward::RewardType::ShopItem, "ShopItem"},
+    {ShopItem::LuckyBagReward::RewardType::Growth, "Growth"},
+}}};
+
+std::string_view trimmed(std::string_view text) {
+    const auto first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+/**
+ * @brief 逐条回调 "键=值" 条目；不含 '=' 的条目是说明文字，跳过。
+ */
+template <typename Handler>
+void forEachRuleEntry(std::string_view text, Handler&& handler) {
+    while (!text.empty()) {
+        const std::size_t end = text.find(';');
+        const std::string_view entry = trimmed(text.substr(0, end));
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+        const std::size_t equals = entry.find('=');
+        if (equals == std::string_view::npos) {
+            continue;
+        }
+        handler(trimmed(entry.substr(0, equals)), trimmed(entry.substr(equals + 1)), entry);
+    }
+}
+
+[[noreturn]] void invalidRule(std::string_view field, std::string_view entry, const char* reason) {
+    throw std::runtime_error(std::string(field) + " 条目 \"" + std::string(entry) + "\" 无效：" + reason);
+}
+
+int ruleInt(std::string_view field, std::string_view entry, std::string_view value, int minimum) {
+    int parsed = 0;
+    const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), parsed);
+    if (value.empty() || ec != std::errc() || end != value.data() + value.size()) {
+        invalidRule(field, entry, "需要整数");
+    }
+    if (parsed < minimum) {
+        invalidRule(field, entry, "数值过小");
+    }
+    return parsed;
+}
+
+ShopItem::PropEffectType ruleEffect(std::string_view field, std::string_view entry, std::string_view value) {
+    const auto type = kPropEffectText.value(value);
+    if (!type.has_value() || *type == ShopItem::PropEffectType::None) {
+        invalidRule(field, entry, "未知效果");
+    }
+    return *type;
+}
+}  // namespace
+
 ShopItem::ShopItem()
     : m_id(-1),
       m_name(),
@@ -94,6 +168,44 @@ int ShopItem::levelRequirement() const noexcept { return m_levelRequirement; }
 
 void ShopItem::setLevelRequirement(int level) noexcept { m_levelRequirement = level; }
 
+ShopItem::Rules ShopItem::parseRules() const {
+    Rules rules;
+    rules.effect.type = m_propEffectType;
+    rules.effect.durationMinutes = m_effectDurationMinutes;
+    forEachRuleEntry(m_effectLogic, [&](std::string_view key, std::string_view value, std::string_view entry) {
+        if (key == "effect") {
+            const PropEffectType type = ruleEffect("effectLogic", entry, value);
+            if (m_propEffectType != PropEffectType::None && type != m_propEffectType) {
+                invalidRule("effectLogic", entry, "与商品的效果类型不一致");
+            }
+            rules.effect.type = type;
+        } else if (key == "minutes") {
+            rules.effect.durationMinutes = ruleInt("effectLogic", entry, value, 1);
+        } else if (key == "stacks") {
+            rules.effect.stacks = ruleInt("effectLogic", entry, value, 1);
+        } else {
+            invalidRule("effectLogic", entry, "未知键");
+        }
+    });
+    forEachRuleEntry(m_usageConditions, [&](std::string_view key, std::string_view value, std::string_view entry) {
+        if (key == "min_level") {
+            rules.usage.minLevel = ruleInt("usageConditions", entry, value, 0);
+        } else if (key == "max_stacks") {
+            rules.usage.maxActiveStacks = ruleInt("usageConditions", entry, value, 1);
+        } else if (key == "exclusive") {
+            while (!value.empty()) {
+                const std::size_t comma = value.find(',');
+                const std::string_view name = trimmed(value.substr(0, comma));
+                value = comma == std::string_view::npos ? std::string_view() : value.substr(comma + 1);
+                rules.usage.exclusiveMask |= 1U << static_cast<unsigned>(ruleEffect("usageConditions", entry, name));
+            }
+        } else {
+            invalidRule("usageConditions", entry, "未知键");
+        }
+    });
+    return rules;
+}
+
 std::string ShopItem::serializeLuckyRewards() const {
     QJsonArray entries;
     for (const auto& reward : m_luckyRewards) {
@@ -181,74 +293,27 @@ DatabaseManager::ShopItemRecord ShopItem::toRecord() const {
 }
 
 std::string ShopItem::itemTypeToString(ItemType type) {
-    switch (type) {
-        case ItemType::Physical:
-            return "Physical";
-        case ItemType::Prop:
-            return "Prop";
-        case ItemType::LuckyBag:
-            return "LuckyBag";
-    }
-    return "Physical";
+    return std::string(kItemTypeText.text(type).value_or("Physical"));
 }
 
-ShopItem::ItemType ShopItem::itemTypeFromString(const std::string& text) {
-    if (text == "Prop") {
-        return ItemType::Prop;
-    }
-    if (text == "LuckyBag") {
-        return ItemType::LuckyBag;
-    }
-    return ItemType::Physical;
+ShopItem::ItemType ShopItem::itemTypeFromString(std::string_view text) {
+    return kItemTypeText.value(text).value_or(ItemType::Physical);
 }
 
 std::string ShopItem::propEffectToString(PropEffectType type) {
-    switch (type) {
-        case PropEffectType::RestDay:
-            return "RestDay";
-        case PropEffectType::ForgivenessCoupon:
-            return "ForgivenessCoupon";
-        case PropEffectType::DoubleExpCard:
-            return "DoubleExpCard";
-        case PropEffectType::None:
-        default:
-            return "None";
-    }
+    return std::string(kPropEffectText.text(type).value_or("None"));
 }
 
-ShopItem::PropEffectType ShopItem::propEffectFromString(const std::string& text) {
-    if (text == "RestDay") {
-        return PropEffectType::RestDay;
-    }
-    if (text == "ForgivenessCoupon") {
-        return PropEffectType::ForgivenessCoupon;
-    }
-    if (text == "DoubleExpCard") {
-        return PropEffectType::DoubleExpCard;
-    }
-    return PropEffectType::None;
+ShopItem::PropEffectType ShopItem::propEffectFromString(std::string_view text) {
+    return kPropEffectText.value(text).value_or(PropEffectType::None);
 }
 
 std::string ShopItem::rewardTypeToString(LuckyBagReward::RewardType type) {
-    switch (type) {
-        case LuckyBagReward::RewardType::Coins:
-            return "Coins";
-        case LuckyBagReward::RewardType::ShopItem:
-            return "ShopItem";
-        case LuckyBagReward::RewardType::Growth:
-            return "Growth";
-    }
-    return "Coins";
+    return std::string(kRewardTypeText.text(type).value_or("Coins"));
 }
 
-ShopItem::LuckyBagReward::RewardType ShopItem::rewardTypeFromString(const std::string& text) {
-    if (text == "ShopItem") {
-        return LuckyBagReward::RewardType::ShopItem;
-    }
-    if (text == "Growth") {
-        return LuckyBagReward::RewardType::Growth;
-    }
-    return LuckyBagReward::RewardType::Coins;
+ShopItem::LuckyBagReward::RewardType ShopItem::rewardTypeFromString(std::string_view text) {
+    return kRewardTypeText.value(text).value_or(LuckyBagReward::RewardType::Coins);
 }
 
 }  // namespace rove::data
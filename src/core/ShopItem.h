@@ -5,8 +5,10 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "DatabaseManager.h"
@@ -21,6 +23,9 @@ class ShopItem final {
 public:
     enum class ItemType { Physical, Prop, LuckyBag };
 
+    /**
+     * @brief 道具效果类型；新增类型追加在末尾，并同步 InventoryManager::kEffectTypeCount。
+     */
     enum class PropEffectType { None, RestDay, ForgivenessCoupon, DoubleExpCard };
 
     struct LuckyBagReward {
@@ -32,6 +37,32 @@ public:
         std::string description;
     };
 
+    /**
+     * @brief effectLogic 解析后的道具效果：使用一次登记的效果类型、时长与叠加层数。
+     */
+    struct EffectSpec {
+        PropEffectType type = PropEffectType::None;
+        int durationMinutes = 0;
+        int stacks = 1;
+    };
+
+    /**
+     * @brief usageConditions 解析后的使用条件。
+     */
+    struct UsageRules {
+        int minLevel = 0;                 //!< 使用所需等级
+        int maxActiveStacks = 0;          //!< 同类效果已叠加到该层数时拒绝使用；0 表示不限
+        std::uint32_t exclusiveMask = 0;  //!< 这些效果生效期间拒绝使用，按 PropEffectType 取位
+    };
+
+    /**
+     * @brief 商品规则的解析结果，存放在商城目录快照中，使用道具时不再解析文本。
+     */
+    struct Rules {
+        EffectSpec effect;
+        UsageRules usage;
+    };
+
     ShopItem();
 
     int id() const noexcept;
@@ -85,6 +116,15 @@ public:
     int levelRequirement() const noexcept;
     void setLevelRequirement(int level) noexcept;
 
+    /**
+     * @brief 解析 effectLogic 与 usageConditions。
+     * 中文：两段文本均为以 ';' 分隔的 "键=值" 条目，不含 '=' 的条目视为说明文字并忽略，因此已有的纯文字描述仍然有效。
+     *       effectLogic 支持 effect（效果名，须与 propEffectType 一致）、minutes（覆盖效果时长）、stacks（每次叠加层数）；
+     *       usageConditions 支持 min_level、max_stacks 与 exclusive（以 ',' 分隔的效果名）。
+     * @throws std::runtime_error 未知键、非法数值或未知效果名，信息指明出错的条目。
+     */
+    [[nodiscard]] Rules parseRules() const;
+
     std::string serializeLuckyRewards() const;
     void deserializeLuckyRewards(const std::string& json);
 
@@ -92,11 +132,11 @@ public:
     DatabaseManager::ShopItemRecord toRecord() const;
 
     static std::string itemTypeToString(ItemType type);
-    static ItemType itemTypeFromString(const std::string& text);
+    static ItemType itemTypeFromString(std::string_view text);
     static std::string propEffectToString(PropEffectType type);
-    static PropEffectType propEffectFromString(const std::string& text);
+    static PropEffectType propEffectFromString(std::string_view text);
     static std::string rewardTypeToString(LuckyBagReward::RewardType type);
-    static LuckyBagReward::RewardType rewardTypeFromString(const std::string& text);
+    static LuckyBagReward::RewardType rewardTypeFromString(std::string_view text);
 
 private:
     int m_id;
@@ -1,9 +1,13 @@
 #include "ShopManager.h"
 
+#include <QDebug>
+
 #include <algorithm>
 #include <sstream>
 #include <stdexcept>
+#include <tuple>
 
+#include "EventJournal.h"
 #include "InventoryItem.h"
 #include "InventoryManager.h"
 #include "ShopItem.h"
@@ -12,6 +16,18 @@
 namespace rove::data {
 namespace {
 constexpr int kThreeStarRewardBaseline = 60;
+
+/**
+ * @brief 逐字段比较两条商品记录，updateItem 据此跳过未改变任何内容的写入。
+ */
+bool sameShopRecord(const DatabaseManager::ShopItemRecord& lhs, const DatabaseManager::ShopItemRecord& rhs) {
+    const auto fields = [](const DatabaseManager::ShopItemRecord& r) {
+        return std::tie(r.id, r.name, r.description, r.iconPath, r.itemType, r.priceCoins, r.purchaseLimit,
+                        r.available, r.effectDescription, r.effectLogic, r.propEffectType, r.propDurationMinutes,
+                        r.usageConditions, r.physicalRedeem, r.physicalNotes, r.luckyBagRules, r.levelRequirement);
+    };
+    return fields(lhs) == fields(rhs);
+}
 }
 
 ShopManager& ShopManager::instance() {
@@ -19,13 +35,22 @@ ShopManager& ShopManager::instance() {
     return instance;
 }
 
-ShopManager::ShopManager() : m_database(nullptr), m_userManager(nullptr), m_inventoryManager(nullptr), m_mutex() {}
+ShopManager::ShopManager()
+    : m_database(nullptr),
+      m_userManager(nullptr),
+      m_inventoryManager(nullptr),
+      m_mutex("ShopManager"),
+      m_catalog(),
+      m_catalogVersion(0),
+      m_randomMutex(),
+      m_random(QRandomGenerator::securelySeeded()) {}
 
 void ShopManager::initialize(DatabaseManager& database, UserManager& userManager, InventoryManager& inventoryManager) {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_lock<StateMutex> lock(m_mutex);
     m_database = &database;
     m_userManager = &userManager;
     m_inventoryManager = &inventoryManager;
+    m_catalog.reset();  // 中文：更换数据库后在首次访问时重建目录。
 }
 
 void ShopManager::ensureInitialized() const {
@@ -35,93 +60,207 @@ void ShopManager::ensureInitialized() const {
 }
 
 int ShopManager::createItem(ShopItem item) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
-    ShopItem priced = applyPricingStrategy(item);
-    auto record = priced.toRecord();
-    const int newId = m_database->insertShopItem(record);
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        ensureInitialized();
+    }
+    static_cast<void>(item.parseRules());  // 中文：规则有误时在录入商品时报错，而不是等到学生使用。
+    const ShopItem priced = applyPricingStrategy(item);
+    int newId = 0;
+    m_database->runInTransaction([&]() {
+        newId = m_database->insertShopItem(priced.toRecord());
+        publishCatalog(buildCatalog());
+    });
     return newId;
 }
 
 bool ShopManager::updateItem(ShopItem item) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
-    ShopItem priced = applyPricingStrategy(item);
-    return m_database->updateShopItem(priced.toRecord());
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        ensureInitialized();
+    }
+    static_cast<void>(item.parseRules());
+    const ShopItem priced = applyPricingStrategy(item);
+    const DatabaseManager::ShopItemRecord record = priced.toRecord();
+    // 中文：内容与目录中的记录完全相同时不写库也不发布新目录，界面据目录版本即可跳过刷新。
+    {
+        const std::shared_ptr<const Catalog> snapshot = catalog();
+        const CatalogEntry* current = snapshot->find(record.id);
+        if (current != nullptr && sameShopRecord(current->item.toRecord(), record)) {
+            return true;
+        }
+    }
+    bool updated = false;
+    m_database->runInTransaction([&]() {
+        updated = m_database->updateShopItem(record);
+        if (updated) {
+            publishCatalog(buildCatalog());
+        }
+    });
+    return updated;
 }
 
 bool ShopManager::removeItem(int itemId) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
-    return m_database->deleteShopItem(itemId);
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        ensureInitialized();
+    }
+    bool removed = false;
+    m_database->runInTransaction([&]() {
+        removed = m_database->deleteShopItem(itemId);
+        if (removed) {
+            publishCatalog(buildCatalog());
+        }
+    });
+    return removed;
 }
 
 std::vector<ShopItem> ShopManager::listItems(bool includeUnavailable) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
-    const auto records = m_database->getAllShopItems();
+    const std::shared_ptr<const Catalog> snapshot = catalog();
     std::vector<ShopItem> items;
-    for (const auto& record : records) {
-        ShopItem item = ShopItem::fromRecord(record);
-        if (!includeUnavailable && !item.isAvailable()) {
+    items.reserve(snapshot->entries.size());
+    for (const auto& entry : snapshot->entries) {
+        if (!includeUnavailable && !entry.item.isAvailable()) {
             continue;
         }
-        items.push_back(item);
+        items.push_back(entry.item);
     }
     return items;
 }
 
 std::optional<ShopItem> ShopManager::findItem(int itemId) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return findItemUnlocked(itemId);
+    const std::shared_ptr<const Catalog> snapshot = catalog();
+    const CatalogEntry* entry = snapshot->find(itemId);
+    if (entry == nullptr) {
+        return std::nullopt;
+    }
+    return entry->item;
 }
 
-std::optional<ShopItem> ShopManager::findItemUnlocked(int itemId) const {
-    ensureInitialized();
-    auto record = m_database->getShopItemById(itemId);
-    if (!record.has_value()) {
-        return std::nullopt;
+/**
+ * 中文说明：目录读取
+ * - 已有快照时只在共享锁内复制 shared_ptr；
+ * - 首次访问在锁外读库构建，仅当目录仍为空时发布：写者发布的目录一定更新，不能被懒加载的旧快照覆盖。
+ */
+std::shared_ptr<const ShopManager::Catalog> ShopManager::catalog() const {
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        ensureInitialized();
+        if (m_catalog) {
+            return m_catalog;
+        }
+    }
+    std::shared_ptr<Catalog> built = buildCatalog();
+    std::unique_lock<StateMutex> lock(m_mutex);
+    if (!m_catalog) {
+        built->version = ++m_catalogVersion;
+        m_catalog = std::move(built);
     }
-    return ShopItem::fromRecord(*record);
+    return m_catalog;
+}
+
+const ShopManager::CatalogEntry* ShopManager::Catalog::find(int itemId) const noexcept {
+    auto it = indexById.find(itemId);
+    return it == indexById.end() ? nullptr : &entries[it->second];
+}
+
+/**
+ * 中文说明：商品目录快照
+ * - 读取全部商品并解析幸运礼包概率表，同时预先计算定价策略，后续浏览与购买均为纯内存查找；
+ * - 构建不持有 m_mutex；写者在事务内调用，读到的是自身刚写入的数据。
+ */
+std::shared_ptr<ShopManager::Catalog> ShopManager::buildCatalog() const {
+    auto next = std::make_shared<Catalog>();
+    const auto records = m_database->getAllShopItems();
+    next->entries.reserve(records.size());
+    next->indexById.reserve(records.size());
+    for (const auto& record : records) {
+        ShopItem item = ShopItem::fromRecord(record);
+        ShopItem priced = applyPricingStrategy(item);
+        AliasTable luckyTable;
+        if (item.itemType() == ShopItem::ItemType::LuckyBag) {
+            luckyTable = AliasTable::build(item.luckyRewards());
+        }
+        ShopItem::Rules rules;
+        std::string ruleError;
+        try {
+            rules = item.parseRules();
+        } catch (const std::exception& error) {
+            ruleError = error.what();
+            qWarning() << "商品" << item.id() << "规则无法解析，已暂停出售:" << QString::fromStdString(ruleError);
+        }
+        next->entries.push_back(CatalogEntry{std::move(item), std::move(priced), std::move(luckyTable),
+                                             std::move(rules), std::move(ruleError)});
+    }
+    std::sort(next->entries.begin(), next->entries.end(), [](const CatalogEntry& lhs, const CatalogEntry& rhs) {
+        return lhs.item.id() < rhs.item.id();
+    });
+    for (std::size_t i = 0; i < next->entries.size(); ++i) {
+        next->indexById.emplace(next->entries[i].item.id(), i);
+    }
+    return next;
+}
+
+/**
+ * @brief 新快照整体替换 m_catalog，旧快照由仍持有它的读者自然释放；独占锁只覆盖指针交换。
+ */
+void ShopManager::publishCatalog(std::shared_ptr<Catalog> next) const {
+    std::unique_lock<StateMutex> lock(m_mutex);
+    next->version = ++m_catalogVersion;
+    m_catalog = std::move(next);
 }
 
 /**
  * 中文说明：交易系统的安全性与回滚
  * - purchaseItem 会在最外层调用 DatabaseManager::beginTransaction，保证“扣币 + 入库”原子性；
+ * - 限购与余额校验也放在事务内，事务的写连接锁串行化并发购买，不再需要持有 ShopManager 的锁；
  * - UserManager::saveActiveUser 内部有嵌套事务，借助 DatabaseManager 的递归深度控制；
  * - 任一环节失败都会 rollbackTransaction，确保兰大币不会凭空消失或重复扣除。
  */
 ShopManager::PurchaseResult ShopManager::purchaseItem(int itemId, int quantity) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
+    const std::shared_ptr<const Catalog> snapshot = catalog();
     PurchaseResult result;
     if (!m_userManager->hasActiveUser()) {
         result.message = "请先登录后再购买";
         return result;
     }
-    auto itemOpt = findItemUnlocked(itemId);
-    if (!itemOpt.has_value()) {
+    EventJournal::instance().record(JournalCommand::Purchase, m_userManager->activeUserId(), itemId, quantity);
+    const CatalogEntry* catalogEntry = snapshot->find(itemId);
+    if (catalogEntry == nullptr) {
         result.message = "商品不存在";
         return result;
     }
-    ShopItem item = applyPricingStrategy(*itemOpt);
-    std::string reason;
-    const User& user = m_userManager->activeUser();
-    if (!validatePurchase(item, user, quantity, reason)) {
-        result.message = reason;
+    if (!catalogEntry->ruleError.empty()) {
+        result.message = "商品规则配置有误，暂停出售：" + catalogEntry->ruleError;
         return result;
     }
+    const ShopItem& item = catalogEntry->priced;
     const int totalCost = item.priceCoins() * quantity;
+    const int ownerId = m_userManager->activeUserId();
     bool transactionStarted = false;
     try {
         transactionStarted = m_database->beginTransaction();
-        User& mutableUser = m_userManager->activeUser();
-        mutableUser.spendCoins(totalCost);
-        m_userManager->saveActiveUser();
-        for (int i = 0; i < quantity; ++i) {
-            InventoryItem entry = m_inventoryManager->createFromShopItem(item, mutableUser.username(), 1);
-            result.grantedItems.push_back(entry);
+        std::string reason;
+        if (!validatePurchase(item, m_userManager->activeUser(), quantity, reason)) {
+            m_database->commitTransaction();
+            result.message = reason;
+            return result;
         }
+        // 中文：校验用的是快照，扣款时在用户锁内重新核对余额，其他线程在两者之间的花费不会被透支。
+        const bool paid = m_userManager->updateActiveUser([totalCost](User& user) {
+            if (user.coins() < totalCost) {
+                return false;
+            }
+            user.spendCoins(totalCost);
+            return true;
+        });
+        if (!paid) {
+            m_database->commitTransaction();
+            result.message = "兰大币余额不足";
+            return result;
+        }
+        // 中文：道具按 quantity = N 堆叠为一条记录，其余类型单事务批量插入。
+        result.grantedItems = m_inventoryManager->createBatchFromShopItem(item, ownerId, quantity);
         m_database->commitTransaction();
         result.success = true;
         std::ostringstream oss;
@@ -134,20 +273,27 @@ ShopManager::PurchaseResult ShopManager::purchaseItem(int itemId, int quantity)
             } catch (...) {
             }
         }
+        // 中文：库存缓存是写穿式的，回滚后丢弃该用户的缓存，避免保留未提交的插入。
+        m_inventoryManager->discardCachedOwner(ownerId);
         throw;
     }
     return result;
 }
 
 bool ShopManager::useInventoryItem(int inventoryId, std::string* message) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    ensureInitialized();
+    const std::shared_ptr<const Catalog> snapshot = catalog();
     if (!m_userManager->hasActiveUser()) {
         if (message != nullptr) {
             *message = "请先登录";
         }
         return false;
     }
+    // 中文：记录事件日志时每次使用前按派生种子重播抽奖引擎，回放工具用同一种子即可复现幸运包结果。
+    if (EventJournal& journal = EventJournal::instance(); journal.isRecording()) {
+        const std::uint32_t seed = journal.nextSeed();
+        seedRandomEngine(seed);
+        journal.record(JournalCommand::UseItem, m_userManager->activeUserId(), inventoryId, 0, {}, seed);
+    }
     auto entryOpt = m_inventoryManager->findById(inventoryId);
     if (!entryOpt.has_value()) {
         if (message != nullptr) {
@@ -156,25 +302,40 @@ bool ShopManager::useInventoryItem(int inventoryId, std::string* message) {
         return false;
     }
     InventoryItem entry = *entryOpt;
-    if (entry.owner() != m_userManager->activeUser().username()) {
+    if (entry.ownerId() != m_userManager->activeUserId()) {
         if (message != nullptr) {
             *message = "无权使用他人道具";
         }
         return false;
     }
-    auto itemOpt = findItemUnlocked(entry.itemId());
-    if (!itemOpt.has_value()) {
+    const CatalogEntry* catalogEntry = snapshot->find(entry.itemId());
+    if (catalogEntry == nullptr) {
         if (message != nullptr) {
             *message = "对应商品缺失";
         }
         return false;
     }
-    ShopItem item = *itemOpt;
+    const ShopItem& item = catalogEntry->item;
+    // 中文：过期道具无论规则与等级如何都要先落为 Expired 状态，使用门槛只对仍有效的道具生效。
+    const bool expired = entry.isExpired();
+    if (!expired && !catalogEntry->ruleError.empty()) {
+        if (message != nullptr) {
+            *message = "商品规则配置有误，暂不能使用：" + catalogEntry->ruleError;
+        }
+        return false;
+    }
+    if (!expired && m_userManager->activeUser().level() < catalogEntry->rules.usage.minLevel) {
+        if (message != nullptr) {
+            *message = "等级不足，无法使用";
+        }
+        return false;
+    }
+    bool applied = true;
     bool transactionStarted = false;
     try {
         transactionStarted = m_database->beginTransaction();
         std::string feedback;
-        if (entry.isExpired()) {
+        if (expired) {
             entry.setStatus(InventoryItem::UsageStatus::Expired);
             m_inventoryManager->updateInventory(entry);
             feedback = "道具已过期";
@@ -187,12 +348,17 @@ bool ShopManager::useInventoryItem(int inventoryId, std::string* message) {
                     break;
                 }
                 case ShopItem::ItemType::Prop: {
-                    m_inventoryManager->applyPropEffect(item, entry, entry.owner(), &feedback);
+                    const std::string username = m_userManager->activeUser().username();
+                    applied = m_inventoryManager->applyPropEffect(catalogEntry->rules, entry, username, &feedback);
                     break;
                 }
                 case ShopItem::ItemType::LuckyBag: {
-                    LuckyBagOutcome outcome = rollLuckyBag(item);
-                    applyLuckyBagReward(outcome, entry.owner());
+                    LuckyBagOutcome outcome;
+                    {
+                        std::lock_guard<std::mutex> lock(m_randomMutex);
+                        outcome = rollLuckyBagLocked(item, catalogEntry->luckyTable);
+                    }
+                    applyLuckyBagReward(*snapshot, outcome, entry.ownerId());
                     m_inventoryManager->markLuckyBagOpened(entry, outcome.payload);
                     feedback = "已开启幸运包：" + outcome.payload;
                     break;
@@ -210,9 +376,11 @@ bool ShopManager::useInventoryItem(int inventoryId, std::string* message) {
             } catch (...) {
             }
         }
+        // 中文：与 purchaseItem 相同，回滚后丢弃该用户的库存缓存，避免保留未提交的使用状态。
+        m_inventoryManager->discardCachedOwner(entry.ownerId());
         throw;
     }
-    return true;
+    return applied;
 }
 
 /**
@@ -297,7 +465,7 @@ bool ShopManager::validatePurchase(const ShopItem& item, const User& user, int q
         return false;
     }
     if (item.purchaseLimit() > 0) {
-        const int purchased = m_inventoryManager->countPurchasesForItem(user.username(), item.id());
+        const int purchased = m_inventoryManager->countPurchasesForItem(user.id(), item.id());
         if (purchased + quantity > item.purchaseLimit()) {
             reason = "已达到限购次数";
             return false;
@@ -307,37 +475,84 @@ bool ShopManager::validatePurchase(const ShopItem& item, const User& user, int q
 }
 
 /**
- * 中文说明：幸运礼包随机算法
- * - 先遍历 luckyRewards，累加概率形成累积分布；
- * - 使用 QRandomGenerator::global()->generateDouble() 生成 [0,1) 随机数，再映射到累积分布；
- * - 若概率和不足 1，则自动归一化到最后一档，保证每次必有奖励；
- * - outcome.payload 记录 JSON 字符串，方便 UI 展示和库存追踪。
+ * 中文说明：幸运礼包随机算法（Vose 别名法）
+ * - 将各档概率按总和归一化后乘以档数 n，小于 1 的进入 small 队列、其余进入 large 队列；
+ * - 每次从两队各取一档：small 档保留自身概率，剩余部分由 large 档补足并记为别名，
+ *   large 档扣除补足量后按新值重新入队；收尾时剩余档的停留概率为 1；
+ * - 概率和不大于 0 时所有槽都指向最后一档，与旧版累积扫描的兜底行为一致。
  */
-ShopManager::LuckyBagOutcome ShopManager::rollLuckyBag(const ShopItem& luckyBag) {
+ShopManager::AliasTable ShopManager::AliasTable::build(const std::vector<ShopItem::LuckyBagReward>& rewards) {
+    AliasTable table;
+    const std::size_t count = rewards.size();
+    if (count == 0) {
+        return table;
+    }
+    table.probability.assign(count, 1.0);
+    table.alias.resize(count);
+    double totalProbability = 0.0;
+    for (const auto& reward : rewards) {
+        totalProbability += std::max(reward.probability, 0.0);
+    }
+    if (totalProbability <= 0.0) {
+        std::fill(table.probability.begin(), table.probability.end(), 0.0);
+        std::fill(table.alias.begin(), table.alias.end(), count - 1);
+        return table;
+    }
+    std::vector<double> scaled(count);
+    std::vector<std::size_t> small;
+    std::vector<std::size_t> large;
+    for (std::size_t i = 0; i < count; ++i) {
+        table.alias[i] = i;
+        scaled[i] = std::max(rewards[i].probability, 0.0) * static_cast<double>(count) / totalProbability;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        const std::size_t less = small.back();
+        small.pop_back();
+        const std::size_t more = large.back();
+        large.pop_back();
+        table.probability[less] = scaled[less];
+        table.alias[less] = more;
+        scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+        (scaled[more] < 1.0 ? small : large).push_back(more);
+    }
+    // 中文：剩余档（含浮点误差残留在 small 中的档）停留概率为 1。
+    for (std::size_t index : large) {
+        table.probability[index] = 1.0;
+    }
+    for (std::size_t index : small) {
+        table.probability[index] = 1.0;
+    }
+    return table;
+}
+
+std::size_t ShopManager::AliasTable::sample(QRandomGenerator& engine) const {
+    const auto slot = static_cast<std::size_t>(engine.bounded(static_cast<int>(probability.size())));
+    return engine.generateDouble() < probability[slot] ? slot : alias[slot];
+}
+
+std::size_t ShopManager::AliasTable::sample(std::mt19937_64& engine) const {
+    std::uniform_int_distribution<std::size_t> pickSlot(0, probability.size() - 1);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    const std::size_t slot = pickSlot(engine);
+    return coin(engine) < probability[slot] ? slot : alias[slot];
+}
+
+/**
+ * 中文说明：单次抽奖
+ * - 使用别名表 O(1) 选出奖励档，未配置奖励时发放基准兰大币；
+ * - outcome.payload 记录 JSON 字符串，方便 UI 展示和库存追踪；
+ * - 调用方需持有 m_randomMutex。
+ */
+ShopManager::LuckyBagOutcome ShopManager::rollLuckyBagLocked(const ShopItem& luckyBag, const AliasTable& table) {
     LuckyBagOutcome outcome;
     const auto& rewards = luckyBag.luckyRewards();
-    if (rewards.empty()) {
+    if (rewards.empty() || table.probability.size() != rewards.size()) {
         outcome.reward.type = ShopItem::LuckyBagReward::RewardType::Coins;
         outcome.reward.amount = kThreeStarRewardBaseline;
         outcome.reward.probability = 1.0;
     } else {
-        double totalProbability = 0.0;
-        for (const auto& reward : rewards) {
-            totalProbability += reward.probability;
-        }
-        const double randomValue = QRandomGenerator::global()->generateDouble();
-        const double target = totalProbability > 0.0 ? randomValue * totalProbability : randomValue;
-        double cursor = 0.0;
-        for (const auto& reward : rewards) {
-            cursor += reward.probability;
-            if (target <= cursor) {
-                outcome.reward = reward;
-                break;
-            }
-        }
-        if (outcome.reward.probability <= 0.0) {
-            outcome.reward = rewards.back();
-        }
+        outcome.reward = rewards[table.sample(m_random)];
     }
     std::ostringstream oss;
     oss << "{\"type\":\"" << ShopItem::rewardTypeToString(outcome.reward.type) << "\",";
@@ -347,25 +562,52 @@ ShopManager::LuckyBagOutcome ShopManager::rollLuckyBag(const ShopItem& luckyBag)
     return outcome;
 }
 
-void ShopManager::applyLuckyBagReward(const LuckyBagOutcome& outcome, const std::string& username) {
+std::vector<ShopManager::LuckyBagOutcome> ShopManager::rollLuckyBags(const ShopItem& luckyBag, int count) {
+    const std::shared_ptr<const Catalog> snapshot = catalog();
+    std::vector<LuckyBagOutcome> outcomes;
+    if (count <= 0) {
+        return outcomes;
+    }
+    outcomes.reserve(static_cast<std::size_t>(count));
+    const CatalogEntry* entry = snapshot->find(luckyBag.id());
+    const AliasTable* cached = entry != nullptr ? &entry->luckyTable : nullptr;
+    AliasTable adhoc;
+    if (cached == nullptr || cached->probability.size() != luckyBag.luckyRewards().size()) {
+        adhoc = AliasTable::build(luckyBag.luckyRewards());
+        cached = &adhoc;
+    }
+    std::lock_guard<std::mutex> lock(m_randomMutex);
+    for (int i = 0; i < count; ++i) {
+        outcomes.push_back(rollLuckyBagLocked(luckyBag, *cached));
+    }
+    return outcomes;
+}
+
+void ShopManager::seedRandomEngine(quint32 seed) {
+    std::lock_guard<std::mutex> lock(m_randomMutex);
+    m_random.seed(seed);
+}
+
+void ShopManager::applyLuckyBagReward(const Catalog& catalog, const LuckyBagOutcome& outcome, int ownerId) {
     switch (outcome.reward.type) {
         case ShopItem::LuckyBagReward::RewardType::Coins: {
-            User& user = m_userManager->activeUser();
-            user.addCoins(outcome.reward.amount);
-            m_userManager->saveActiveUser();
+            m_userManager->updateActiveUser([amount = outcome.reward.amount](User& user) {
+                user.addCoins(amount);
+                return true;
+            });
             break;
         }
         case ShopItem::LuckyBagReward::RewardType::Growth: {
-            User& user = m_userManager->activeUser();
-            user.addGrowthPoints(outcome.reward.amount);
-            m_userManager->saveActiveUser();
+            m_userManager->updateActiveUser([amount = outcome.reward.amount](User& user) {
+                user.addGrowthPoints(amount);
+                return true;
+            });
             break;
         }
         case ShopItem::LuckyBagReward::RewardType::ShopItem: {
             if (outcome.reward.referenceItemId > 0) {
-                auto referenced = findItemUnlocked(outcome.reward.referenceItemId);
-                if (referenced.has_value()) {
-                    m_inventoryManager->createFromShopItem(*referenced, username, 1);
+                if (const CatalogEntry* referenced = catalog.find(outcome.reward.referenceItemId)) {
+                    m_inventoryManager->createFromShopItem(referenced->item, ownerId, 1);
                 }
             }
             break;
@@ -3,14 +3,20 @@
 
 #include <QRandomGenerator>
 
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <random>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "DatabaseManager.h"
 #include "InventoryItem.h"
 #include "InventoryManager.h"
+#include "Metrics.h"
 #include "ShopItem.h"
 #include "UserManager.h"
 
@@ -21,8 +27,10 @@ namespace rove::data {
  * @brief 商城系统分三类商品：
  *        1) Physical 实物奖励：遵循“3 星任务奖励 ≈ 中档实物的 1/5~1/10”定价；
  *        2) Prop 系统道具：根据时效/功能计算兰大币成本，并与任务难度形成闭环；
- *        3) LuckyBag 幸运礼包：存储概率表，使用 QRandomGenerator 保证公平可复现。
+ *        3) LuckyBag 幸运礼包：存储概率表并预建别名表，使用可设种子的 QRandomGenerator 保证公平可复现。
  *        该类负责商品 CRUD、购买校验、交易事务、库存落地与礼包抽奖。
+ *        锁模型：m_mutex（读写锁）只保护目录指针，读者复制 shared_ptr 后在锁外遍历；
+ *        抽奖引擎由独立的 m_randomMutex 保护；购买与目录维护的数据库写入由事务串行化，不持有本类的锁。
  */
 class ShopManager final {
 public:
@@ -32,40 +40,105 @@ public:
         std::vector<InventoryItem> grantedItems;
     };
 
+    struct LuckyBagOutcome {
+        ShopItem::LuckyBagReward reward;
+        std::string payload;
+    };
+
+    /**
+     * @brief Walker/Vose 别名表：O(n) 构建，每次抽样 O(1)（一次均匀取槽 + 一次伯努利判定）。
+     *        probability[i] 为停留在槽 i 的概率，否则取 alias[i]；空表表示礼包未配置奖励。
+     */
+    struct AliasTable {
+        std::vector<double> probability;
+        std::vector<std::size_t> alias;
+
+        static AliasTable build(const std::vector<ShopItem::LuckyBagReward>& rewards);
+        [[nodiscard]] std::size_t sample(QRandomGenerator& engine) const;
+        /**
+         * @brief 供 EconomySimulator 的工作线程使用各自独立的标准库引擎抽样；表非空时调用。
+         */
+        [[nodiscard]] std::size_t sample(std::mt19937_64& engine) const;
+    };
+
+    /**
+     * @brief 商品目录条目：item 为数据库中的原始商品（幸运礼包概率表已解析），
+     *        priced 为应用定价策略后的版本，展示与购买均以其价格为准；
+     *        luckyTable 仅对幸运礼包构建；rules 为构建目录时解析好的效果与使用条件，
+     *        解析失败时 ruleError 非空，该商品暂停出售与使用。
+     */
+    struct CatalogEntry {
+        ShopItem item;
+        ShopItem priced;
+        AliasTable luckyTable;
+        ShopItem::Rules rules;
+        std::string ruleError;
+    };
+
+    /**
+     * @brief 不可变的商品目录快照，条目按 id 升序排列。
+     *        仅在首次访问与 createItem/updateItem/removeItem 实际改变内容时整体重建并递增 version；
+     *        读者持有 shared_ptr 即可在锁外遍历，不会观察到半更新状态。
+     */
+    struct Catalog {
+        std::uint64_t version = 0;
+        std::vector<CatalogEntry> entries;
+        std::unordered_map<int, std::size_t> indexById;
+
+        [[nodiscard]] const CatalogEntry* find(int itemId) const noexcept;
+    };
+
     static ShopManager& instance();
 
     void initialize(DatabaseManager& database, UserManager& userManager, InventoryManager& inventoryManager);
 
+    /**
+     * @throws std::runtime_error effectLogic 或 usageConditions 无法解析，商品不会写入。
+     */
     int createItem(ShopItem item);
     bool updateItem(ShopItem item);
     bool removeItem(int itemId);
 
     std::vector<ShopItem> listItems(bool includeUnavailable = false) const;
     std::optional<ShopItem> findItem(int itemId) const;
+    std::shared_ptr<const Catalog> catalog() const;
 
     PurchaseResult purchaseItem(int itemId, int quantity);
+
+    /**
+     * @brief 连续开启 count 次幸运礼包，只抽奖不发放奖励，供多开展示与概率模拟使用。
+     *        目录中已有的礼包复用预建别名表，否则临时构建。
+     */
+    std::vector<LuckyBagOutcome> rollLuckyBags(const ShopItem& luckyBag, int count);
+
+    /**
+     * @brief 以固定种子重置抽奖引擎，使模拟与测试结果可精确复现。
+     */
+    void seedRandomEngine(quint32 seed);
     bool useInventoryItem(int inventoryId, std::string* message);
 
 private:
     ShopManager();
 
+    using StateMutex = metrics::ProfiledMutex<std::shared_mutex>;
+
     void ensureInitialized() const;
-    std::optional<ShopItem> findItemUnlocked(int itemId) const;
+    [[nodiscard]] std::shared_ptr<Catalog> buildCatalog() const;
+    void publishCatalog(std::shared_ptr<Catalog> next) const;
     ShopItem applyPricingStrategy(const ShopItem& item) const;
     bool validatePurchase(const ShopItem& item, const User& user, int quantity, std::string& reason) const;
 
-    struct LuckyBagOutcome {
-        ShopItem::LuckyBagReward reward;
-        std::string payload;
-    };
-
-    LuckyBagOutcome rollLuckyBag(const ShopItem& luckyBag);
-    void applyLuckyBagReward(const LuckyBagOutcome& outcome, const std::string& username);
+    LuckyBagOutcome rollLuckyBagLocked(const ShopItem& luckyBag, const AliasTable& table);
+    void applyLuckyBagReward(const Catalog& catalog, const LuckyBagOutcome& outcome, int ownerId);
 
     DatabaseManager* m_database;
     UserManager* m_userManager;
     InventoryManager* m_inventoryManager;
-    mutable std::mutex m_mutex;
+    mutable StateMutex m_mutex;  //!< 保护依赖指针与目录快照。
+    mutable std::shared_ptr<const Catalog> m_catalog;
+    mutable std::uint64_t m_catalogVersion;
+    std::mutex m_randomMutex;   //!< 只保护 m_random，抽奖不与目录读者互斥。
+    QRandomGenerator m_random;  //!< 每个管理器独立的抽奖引擎，默认随机种子。
 };
 
 }  // namespace rove::data
@@ -0,0 +1,184 @@
+#include "SnapshotSeries.h"
+
+#include <algorithm>
+
+namespace rove::data {
+
+void SnapshotSeries::reserve(std::size_t rows) {
+    m_timestamps.reserve(rows);
+    for (auto& column : m_columns) {
+        column.reserve(rows);
+    }
+}
+
+void SnapshotSeries::append(std::int64_t timestampMs, const Row& values) {
+    m_timestamps.push_back(timestampMs);
+    for (std::size_t i = 0; i < kSnapshotColumnCount; ++i) {
+        m_columns[i].push_back(values[i]);
+    }
+}
+
+ColumnStats SnapshotSeries::stats(SnapshotColumn column) const noexcept {
+    const auto& values = this->column(column);
+    return series::columnStats(values.data(), values.size());
+}
+
+SnapshotSeries::Row SnapshotSeries::row(std::size_t index) const noexcept {
+    Row values{};
+    for (std::size_t i = 0; i < kSnapshotColumnCount; ++i) {
+        values[i] = m_columns[i][index];
+    }
+    return values;
+}
+
+namespace {
+
+void putVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void putSignedVarint(std::string& out, std::int64_t value) {
+    putVarint(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+/**
+ * @brief 顺序读取 varint，越界或超长时置 ok = false。
+ */
+struct BlockReader {
+    std::string_view data;
+    std::size_t pos = 0;
+    bool ok = true;
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; ok && shift < 64; shift += 7) {
+            if (pos >= data.size()) {
+                break;
+            }
+            const auto byte = static_cast<unsigned char>(data[pos++]);
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    std::int64_t signedVarint() {
+        const std::uint64_t bits = varint();
+        return static_cast<std::int64_t>(bits >> 1) ^ -static_cast<std::int64_t>(bits & 1);
+    }
+};
+
+}  // namespace
+
+namespace series {
+
+// 中文：以下循环均为单一归约或逐元素运算，-O2 起 GCC/Clang 即生成 SIMD 指令，无需手写 intrinsics。
+
+std::int32_t minValue(const std::int32_t* values, std::size_t count) noexcept {
+    if (count == 0) {
+        return 0;
+    }
+    std::int32_t result = values[0];
+    for (std::size_t i = 1; i < count; ++i) {
+        result = std::min(result, values[i]);
+    }
+    return result;
+}
+
+std::int32_t maxValue(const std::int32_t* values, std::size_t count) noexcept {
+    if (count == 0) {
+        return 0;
+    }
+    std::int32_t result = values[0];
+    for (std::size_t i = 1; i < count; ++i) {
+        result = std::max(result, values[i]);
+    }
+    return result;
+}
+
+std::int64_t sum(const std::int32_t* values, std::size_t count) noexcept {
+    std::int64_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        total += values[i];
+    }
+    return total;
+}
+
+void deltas(const std::int32_t* values, std::size_t count, std::int32_t* out) noexcept {
+    for (std::size_t i = 0; i + 1 < count; ++i) {
+        out[i] = values[i + 1] - values[i];
+    }
+}
+
+ColumnStats columnStats(const std::int32_t* values, std::size_t count) noexcept {
+    ColumnStats stats;
+    if (count == 0) {
+        return stats;
+    }
+    stats.min = minValue(values, count);
+    stats.max = maxValue(values, count);
+    stats.mean = static_cast<double>(sum(values, count)) / static_cast<double>(count);
+    stats.delta = static_cast<std::int64_t>(values[count - 1]) - values[0];
+    return stats;
+}
+
+std::string encodeBlock(const SnapshotSeries& rows, std::size_t first, std::size_t count) {
+    std::string out;
+    out.reserve(8 + count * (kSnapshotColumnCount + 3));
+    out.push_back(static_cast<char>(kSnapshotBlockFormatV1));
+    putVarint(out, count);
+    const auto& timestamps = rows.timestamps();
+    for (std::size_t i = first; i < first + count; ++i) {
+        const bool keyframe = i == first;
+        putSignedVarint(out, keyframe ? timestamps[i] : timestamps[i] - timestamps[i - 1]);
+        for (std::size_t c = 0; c < kSnapshotColumnCount; ++c) {
+            const auto& values = rows.column(static_cast<SnapshotColumn>(c));
+            putSignedVarint(out, keyframe ? values[i] : static_cast<std::int64_t>(values[i]) - values[i - 1]);
+        }
+    }
+    return out;
+}
+
+bool decodeBlock(std::string_view blob, std::int64_t startMs, std::int64_t endMs, SnapshotSeries& out) {
+    BlockReader reader{blob};
+    if (blob.empty() || static_cast<unsigned char>(blob[0]) != kSnapshotBlockFormatV1) {
+        return false;
+    }
+    reader.pos = 1;
+    const std::uint64_t count = reader.varint();
+    // 中文：每行至少 13 字节，行数超过剩余长度说明块已损坏，避免按伪造的行数循环。
+    if (!reader.ok || count > blob.size()) {
+        return false;
+    }
+    std::int64_t timestampMs = 0;
+    std::array<std::int64_t, kSnapshotColumnCount> values{};
+    SnapshotSeries::Row row{};
+    for (std::uint64_t i = 0; i < count; ++i) {
+        timestampMs += reader.signedVarint();
+        for (std::size_t c = 0; c < kSnapshotColumnCount; ++c) {
+            values[c] += reader.signedVarint();
+            row[c] = static_cast<std::int32_t>(values[c]);
+        }
+        if (!reader.ok) {
+            return false;
+        }
+        if (timestampMs > endMs) {
+            break;  // 中文：块内按时间升序，之后的行都在区间外。
+        }
+        if (timestampMs >= startMs) {
+            out.append(timestampMs, row);
+        }
+    }
+    return true;
+}
+
+}  // namespace series
+
+}  // namespace rove::data
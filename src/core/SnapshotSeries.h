@@ -0,0 +1,120 @@
+#ifndef SNAPSHOTSERIES_H
+#define SNAPSHOTSERIES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rove::data {
+
+/**
+ * @brief 快照数值列，顺序与 growth_snapshots 的数值列及导出列一致。
+ */
+enum class SnapshotColumn : std::size_t {
+    Level,
+    Growth,
+    Execution,
+    Perseverance,
+    Decision,
+    Knowledge,
+    Social,
+    Pride,
+    Achievements,
+    CompletedTasks,
+    FailedTasks,
+    ManualLogs,
+};
+
+constexpr std::size_t kSnapshotColumnCount = 12;
+
+/**
+ * @brief 单列统计：最小、最大、均值，以及末值减首值的区间变化量；空列全部为 0。
+ */
+struct ColumnStats {
+    std::int32_t min = 0;
+    std::int32_t max = 0;
+    double mean = 0.0;
+    std::int64_t delta = 0;
+};
+
+/**
+ * @class SnapshotSeries
+ * @brief 列式成长时间线：时间戳与每个数值列各自连续存放，行号即快照序号。
+ * 中文：DatabaseManager 直接按列填充，不构造 QDateTime 与 AttributeSet；看板统计、坐标轴范围与列式导出
+ *       都只需对单列做一次紧凑循环，一年的数据也只是几次顺序扫描。
+ */
+class SnapshotSeries {
+public:
+    using Row = std::array<std::int32_t, kSnapshotColumnCount>;
+
+    [[nodiscard]] std::size_t size() const noexcept { return m_timestamps.size(); }
+    [[nodiscard]] bool empty() const noexcept { return m_timestamps.empty(); }
+    void reserve(std::size_t rows);
+    void append(std::int64_t timestampMs, const Row& values);
+
+    /**
+     * @brief 毫秒时间戳列，按时间升序。
+     */
+    [[nodiscard]] const std::vector<std::int64_t>& timestamps() const noexcept { return m_timestamps; }
+    [[nodiscard]] const std::vector<std::int32_t>& column(SnapshotColumn column) const noexcept {
+        return m_columns[static_cast<std::size_t>(column)];
+    }
+    [[nodiscard]] ColumnStats stats(SnapshotColumn column) const noexcept;
+
+    /**
+     * @brief 取第 index 行的全部数值列，调用方保证 index < size()。
+     */
+    [[nodiscard]] Row row(std::size_t index) const noexcept;
+
+private:
+    std::vector<std::int64_t> m_timestamps;
+    std::array<std::vector<std::int32_t>, kSnapshotColumnCount> m_columns;
+};
+
+/**
+ * @brief 看板统计内核：输入为连续的 int32 数组，循环体无分支、无别名，编译器可以直接向量化。
+ */
+namespace series {
+
+[[nodiscard]] std::int32_t minValue(const std::int32_t* values, std::size_t count) noexcept;
+[[nodiscard]] std::int32_t maxValue(const std::int32_t* values, std::size_t count) noexcept;
+[[nodiscard]] std::int64_t sum(const std::int32_t* values, std::size_t count) noexcept;
+
+/**
+ * @brief 相邻差分：out[i] = values[i + 1] - values[i]，out 需能容纳 count - 1 个元素。
+ */
+void deltas(const std::int32_t* values, std::size_t count, std::int32_t* out) noexcept;
+
+[[nodiscard]] ColumnStats columnStats(const std::int32_t* values, std::size_t count) noexcept;
+
+/**
+ * @brief 快照块格式的版本标记，位于编码首字节。
+ * 中文：一块是若干条按时间升序的快照：首行为关键帧，其后每行只记录与上一行的差值；成长数值在相邻快照间
+ *       大多不变，差值多为 0，zigzag varint 编码后每列只占 1 字节。每块自带关键帧，块与块之间互不依赖。
+ *
+ * 布局：
+ *   u8 版本标记 kSnapshotBlockFormatV1, varint 行数 N,
+ *   关键帧 { svarint 时间戳, 12 × svarint 数值 },
+ *   (N - 1) × { svarint 时间戳差, 12 × svarint 数值差 }
+ */
+inline constexpr unsigned char kSnapshotBlockFormatV1 = 0xB1;
+
+/**
+ * @brief 把 rows 中 [first, first + count) 行编码为一个快照块。
+ */
+[[nodiscard]] std::string encodeBlock(const SnapshotSeries& rows, std::size_t first, std::size_t count);
+
+/**
+ * @brief 解码快照块，把时间戳落在 [startMs, endMs] 内的行依次追加到 out，不构造中间行对象。
+ * @return 块格式损坏时返回 false，此前已追加的行保留在 out 中。
+ */
+[[nodiscard]] bool decodeBlock(std::string_view blob, std::int64_t startMs, std::int64_t endMs, SnapshotSeries& out);
+
+}  // namespace series
+
+}  // namespace rove::data
+
+#endif  // SNAPSHOTSERIES_H
@@ -0,0 +1,32 @@
+#include "SortedIdSet.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace rove::data {
+
+SortedIdSet::SortedIdSet(std::vector<int> ids) : m_ids(std::move(ids)) {
+    if (!std::is_sorted(m_ids.begin(), m_ids.end())) {
+        std::sort(m_ids.begin(), m_ids.end());
+    }
+    m_ids.erase(std::unique(m_ids.begin(), m_ids.end()), m_ids.end());
+}
+
+bool SortedIdSet::contains(int id) const noexcept { return std::binary_search(m_ids.begin(), m_ids.end(), id); }
+
+bool SortedIdSet::insert(int id) {
+    auto it = std::lower_bound(m_ids.begin(), m_ids.end(), id);
+    if (it != m_ids.end() && *it == id) {
+        return false;
+    }
+    m_ids.insert(it, id);
+    return true;
+}
+
+std::size_t SortedIdSet::size() const noexcept { return m_ids.size(); }
+
+bool SortedIdSet::empty() const noexcept { return m_ids.empty(); }
+
+const std::vector<int>& SortedIdSet::ids() const noexcept { return m_ids; }
+
+}  // namespace rove::data
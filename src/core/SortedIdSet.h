@@ -0,0 +1,41 @@
+#ifndef SORTEDIDSET_H
+#define SORTEDIDSET_H
+
+#include <cstddef>
+#include <vector>
+
+namespace rove::data {
+
+/**
+ * @class SortedIdSet
+ * @brief 以有序连续数组保存的整数主键集合，用于宽恕日志等只增不减、查多改少的 ID 集合。
+ * 中文：每个 ID 只占 4 字节且内存连续，contains() 二分查找；相对 std::set 省去每个节点的指针与分配开销。
+ *       插入保持有序，逐条插入为 O(n)，适合批量加载后偶尔追加的场景。
+ */
+class SortedIdSet {
+public:
+    SortedIdSet() = default;
+
+    /**
+     * @brief 由任意顺序的 ID 构造，内部排序并去重。
+     */
+    explicit SortedIdSet(std::vector<int> ids);
+
+    [[nodiscard]] bool contains(int id) const noexcept;
+
+    /**
+     * @brief 插入一个 ID，已存在时返回 false。
+     */
+    bool insert(int id);
+
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] bool empty() const noexcept;
+    [[nodiscard]] const std::vector<int>& ids() const noexcept;
+
+private:
+    std::vector<int> m_ids;
+};
+
+}  // namespace rove::data
+
+#endif  // SORTEDIDSET_H
@@ -0,0 +1,134 @@
+#include "SqliteMemory.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+
+namespace rove::data {
+
+namespace {
+
+std::mutex g_configMutex;
+bool g_configured = false;
+std::size_t g_pageCacheSlotBytes = 0;  //!< 页缓存池每槽字节数（页大小加页头），未配置池时为 0
+
+SqliteMemoryProfile& activeProfile() {
+    static SqliteMemoryProfile profile = SqliteMemoryProfile::system();
+    return profile;
+}
+
+std::size_t roundUp8(std::size_t bytes) noexcept { return (bytes + 7) & ~static_cast<std::size_t>(7); }
+
+void appendError(std::string* error, const std::string& message) {
+    if (error == nullptr) {
+        return;
+    }
+    if (!error->empty()) {
+        error->append("; ");
+    }
+    error->append(message);
+}
+
+}  // namespace
+
+SqliteMemoryProfile SqliteMemoryProfile::system() { return SqliteMemoryProfile{}; }
+
+SqliteMemoryProfile SqliteMemoryProfile::pooled() {
+    SqliteMemoryProfile profile;
+    profile.name = "pooled";
+    profile.pageCacheSlots = 2048;
+    profile.pageSize = 4096;
+    profile.lookasideSlotBytes = 1200;
+    profile.lookasideSlots = 128;
+    profile.writerLookasideSlots = 512;
+    return profile;
+}
+
+/**
+ * @brief 先以 SQLITE_CONFIG_MEMSTATUS 探测 SQLite 是否已初始化（已初始化时返回 SQLITE_MISUSE），再依次配置
+ *        页缓存池与默认 lookaside。
+ * 中文：页缓存缓冲区在 SQLite shutdown 之前都可能被引用，因此在进程退出前不释放；它是固定大小的预留，
+ *       槽位释放后留在池内复用，超出池容量的页照常走堆分配并可被 sqlite3_db_release_memory 归还。
+ */
+bool configureSqliteMemory(const SqliteMemoryProfile& profile, std::string* error) {
+    std::lock_guard<std::mutex> lock(g_configMutex);
+    if (g_configured) {
+        appendError(error, "SQLite memory profile already configured");
+        return false;
+    }
+    if (sqlite3_config(SQLITE_CONFIG_MEMSTATUS, 1) != SQLITE_OK) {
+        appendError(error, "SQLite already initialized; memory profile must be applied before opening any connection");
+        return false;
+    }
+    SqliteMemoryProfile applied = profile;
+    bool ok = true;
+
+    if (profile.pageCacheSlots > 0) {
+        int headerBytes = 0;
+        sqlite3_config(SQLITE_CONFIG_PCACHE_HDRSZ, &headerBytes);
+        const std::size_t slotBytes = roundUp8(static_cast<std::size_t>(std::max(profile.pageSize, 512) + headerBytes));
+        void* buffer = std::malloc(slotBytes * static_cast<std::size_t>(profile.pageCacheSlots));
+        if (buffer == nullptr || sqlite3_config(SQLITE_CONFIG_PAGECACHE, buffer, static_cast<int>(slotBytes),
+                                                profile.pageCacheSlots) != SQLITE_OK) {
+            std::free(buffer);
+            appendError(error, "SQLITE_CONFIG_PAGECACHE rejected");
+            applied.pageCacheSlots = 0;
+            ok = false;
+        } else {
+            g_pageCacheSlotBytes = slotBytes;
+        }
+    }
+
+    if (profile.lookasideSlotBytes > 0 && profile.lookasideSlots > 0 &&
+        sqlite3_config(SQLITE_CONFIG_LOOKASIDE, profile.lookasideSlotBytes, profile.lookasideSlots) != SQLITE_OK) {
+        appendError(error, "SQLITE_CONFIG_LOOKASIDE rejected");
+        applied.lookasideSlots = 0;
+        applied.writerLookasideSlots = 0;
+        ok = false;
+    }
+
+    activeProfile() = applied;
+    g_configured = true;
+    return ok;
+}
+
+const SqliteMemoryProfile& activeSqliteMemoryProfile() noexcept { return activeProfile(); }
+
+/**
+ * @brief 槽数与进程默认值相同时 SQLITE_CONFIG_LOOKASIDE 已经生效，不再重新分配。
+ */
+bool applyConnectionLookaside(sqlite3* handle, bool writer) noexcept {
+    const SqliteMemoryProfile& profile = activeProfile();
+    const int slotCount = writer ? profile.writerLookasideSlots : profile.lookasideSlots;
+    if (handle == nullptr || profile.lookasideSlotBytes <= 0 || slotCount <= 0 || slotCount == profile.lookasideSlots) {
+        return true;
+    }
+    return sqlite3_db_config(handle, SQLITE_DBCONFIG_LOOKASIDE, nullptr, profile.lookasideSlotBytes, slotCount) ==
+           SQLITE_OK;
+}
+
+SqliteMemoryStats sqliteMemoryStats() noexcept {
+    const SqliteMemoryProfile& profile = activeProfile();
+    SqliteMemoryStats stats;
+    stats.profileName = profile.name;
+    stats.pageCacheSlots = profile.pageCacheSlots;
+    stats.pageCacheSlotBytes = g_pageCacheSlotBytes;
+    sqlite3_int64 current = 0;
+    sqlite3_int64 highwater = 0;
+    if (sqlite3_status64(SQLITE_STATUS_PAGECACHE_USED, &current, &highwater, 0) == SQLITE_OK) {
+        stats.pageCacheSlotsUsed = current;
+        stats.pageCacheSlotsPeak = highwater;
+    }
+    if (sqlite3_status64(SQLITE_STATUS_PAGECACHE_OVERFLOW, &current, &highwater, 0) == SQLITE_OK) {
+        stats.pageCacheOverflowBytes = current;
+    }
+    if (sqlite3_status64(SQLITE_STATUS_MALLOC_COUNT, &current, &highwater, 0) == SQLITE_OK) {
+        stats.outstandingAllocations = current;
+    }
+    if (sqlite3_status64(SQLITE_STATUS_MALLOC_SIZE, &current, &highwater, 0) == SQLITE_OK) {
+        stats.largestAllocation = highwater;
+    }
+    return stats;
+}
+
+}  // namespace rove::data
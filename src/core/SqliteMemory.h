@@ -0,0 +1,83 @@
+#ifndef SQLITEMEMORY_H
+#define SQLITEMEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <sqlite3.h>
+
+/**
+ * @file SqliteMemory.h
+ * @brief SQLite 进程级内存配置：预分配页缓存池与 lookaside。
+ * 中文：sqlite3_config 只能在 SQLite 初始化之前调用，因此 configureSqliteMemory 须在打开任何连接
+ *       （包括备份恢复）之前执行一次；之后 DatabaseManager 打开的每个连接都按当前配置设置 lookaside。
+ *       不替换 SQLite 的分配器：语句生命周期里的小块分配由各连接独占的 lookaside 无锁满足，
+ *       其余分配交给系统堆，避免全局锁串行化分配且内存可归还系统。
+ */
+
+namespace rove::data {
+
+/**
+ * @brief 启动时选定的 SQLite 内存配置。
+ * 中文：各数值为 0 表示保持 SQLite 内置默认值（malloc 页缓存、每连接 1200 字节 × 40 个 lookaside 槽）。
+ */
+struct SqliteMemoryProfile {
+    std::string name = "system";
+    int pageCacheSlots = 0;                   //!< SQLITE_CONFIG_PAGECACHE 预分配的页槽数，超出部分回落到堆
+    int pageSize = 4096;                      //!< 页槽按此页大小加页头计算，须与库文件的 page_size 一致
+    int lookasideSlotBytes = 0;               //!< 每个 lookaside 槽的字节数（8 的倍数）
+    int lookasideSlots = 0;                   //!< 只读连接与其他连接的 lookaside 槽数
+    int writerLookasideSlots = 0;             //!< 写连接的 lookaside 槽数；写连接语句最多，单独放大
+
+    /**
+     * @brief 全部使用 SQLite 默认值。
+     */
+    [[nodiscard]] static SqliteMemoryProfile system();
+
+    /**
+     * @brief 约 8 MiB 预分配页缓存与放大的 lookaside。
+     */
+    [[nodiscard]] static SqliteMemoryProfile pooled();
+};
+
+/**
+ * @brief SQLite 进程级内存读数。
+ * 中文：页缓存与分配次数来自 sqlite3_status64。
+ */
+struct SqliteMemoryStats {
+    std::string profileName;
+    int pageCacheSlots = 0;                  //!< 预分配的页槽数
+    std::size_t pageCacheSlotBytes = 0;      //!< 每个页槽的字节数；未配置页缓存池时为 0
+    std::int64_t pageCacheSlotsUsed = 0;     //!< SQLITE_STATUS_PAGECACHE_USED：正在使用的页槽
+    std::int64_t pageCacheSlotsPeak = 0;
+    std::int64_t pageCacheOverflowBytes = 0; //!< SQLITE_STATUS_PAGECACHE_OVERFLOW：池满后落到堆上的页缓存字节
+    std::int64_t outstandingAllocations = 0; //!< SQLITE_STATUS_MALLOC_COUNT：未释放的分配次数
+    std::int64_t largestAllocation = 0;      //!< SQLITE_STATUS_MALLOC_SIZE 峰值：最大单次请求
+};
+
+/**
+ * @brief 应用内存配置；须在 SQLite 初始化前调用，重复调用或初始化之后调用返回 false 并写入 error。
+ * 中文：单项配置失败（例如页槽参数越界）不影响其他项，已生效的部分保留。
+ */
+bool configureSqliteMemory(const SqliteMemoryProfile& profile, std::string* error = nullptr);
+
+/**
+ * @brief 当前生效的配置；从未调用 configureSqliteMemory 时为 system()。
+ */
+[[nodiscard]] const SqliteMemoryProfile& activeSqliteMemoryProfile() noexcept;
+
+/**
+ * @brief 在刚打开、尚未执行任何语句的连接上按当前配置设置 lookaside。
+ * @return 未配置 lookaside 或设置成功时返回 true；连接已在使用 lookaside 时返回 false，保持原设置。
+ */
+bool applyConnectionLookaside(sqlite3* handle, bool writer) noexcept;
+
+/**
+ * @brief 读取进程级 SQLite 内存读数，不加任何数据库锁。
+ */
+[[nodiscard]] SqliteMemoryStats sqliteMemoryStats() noexcept;
+
+}  // namespace rove::data
+
+#endif  // SQLITEMEMORY_H
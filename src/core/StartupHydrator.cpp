@@ -0,0 +1,77 @@
+#include "StartupHydrator.h"
+
+#include <QDebug>
+
+#include <exception>
+#include <utility>
+
+namespace rove::data {
+
+StartupHydrator::StartupHydrator(TaskManager& taskManager,
+                                 AchievementManager& achievementManager,
+                                 ShopManager& shopManager,
+                                 QObject* parent)
+    : QObject(parent),
+      m_taskManager(taskManager),
+      m_achievementManager(achievementManager),
+      m_shopManager(shopManager),
+      m_pool(std::make_unique<QThreadPool>()),
+      m_hydrated(),
+      m_pending(0),
+      m_started(false) {
+    m_pool->setMaxThreadCount(static_cast<int>(kSectionCount));
+}
+
+StartupHydrator::~StartupHydrator() {
+    m_pool->waitForDone();  // 中文：装载任务引用各管理器与 this，析构前必须全部结束。
+}
+
+void StartupHydrator::start() {
+    if (m_started) {
+        return;
+    }
+    m_started = true;
+    m_pending = kSectionCount;
+    submit(Section::Tasks, [this]() {
+        m_taskManager.refreshFromDatabase();
+        // 中文：应用关闭期间跨过的每日/每周重置在装载后一次性补做。
+        m_taskManager.catchUpResets();
+    });
+    // 中文：启动时尚无待写进度，刷写定时器处于停止状态，在工作线程刷新不会跨线程操作定时器。
+    submit(Section::Achievements, [this]() { m_achievementManager.refreshFromDatabase(); });
+    submit(Section::ShopCatalog, [this]() { static_cast<void>(m_shopManager.catalog()); });
+}
+
+bool StartupHydrator::isHydrated(Section section) const noexcept {
+    return m_hydrated[static_cast<std::size_t>(section)];
+}
+
+bool StartupHydrator::isFinished() const noexcept { return m_started && m_pending == 0; }
+
+void StartupHydrator::submit(Section section, std::function<void()> load) {
+    m_pool->start([this, section, load = std::move(load)]() {
+        QString error;
+        try {
+            load();
+        } catch (const std::exception& e) {
+            error = QString::fromUtf8(e.what());
+        }
+        QMetaObject::invokeMethod(this, [this, section, error]() { completeSection(section, error); },
+                                  Qt::QueuedConnection);
+    });
+}
+
+void StartupHydrator::completeSection(Section section, const QString& error) {
+    if (error.isEmpty()) {
+        m_hydrated[static_cast<std::size_t>(section)] = true;
+        emit sectionHydrated(section);
+    } else {
+        qWarning() << "StartupHydrator: 启动装载失败:" << error;
+        emit sectionFailed(section, error);
+    }
+    if (--m_pending == 0) {
+        emit finished();
+    }
+}
+
+}  // namespace rove::data
@@ -0,0 +1,92 @@
+#ifndef STARTUPHYDRATOR_H
+#define STARTUPHYDRATOR_H
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include <array>
+#include <functional>
+#include <memory>
+
+#include "AchievementManager.h"
+#include "ShopManager.h"
+#include "TaskManager.h"
+
+namespace rove::data {
+
+/**
+ * @class StartupHydrator
+ * @brief 启动编排器：窗口显示后在工作线程并行装载互不依赖的管理器缓存。
+ * 中文：任务列表、成就与商城目录各自读取只读连接池，彼此没有数据依赖，可同时装载；
+ *       每个区域完成后在 GUI 线程发出 sectionHydrated，界面先显示骨架，再按区域填充。
+ *       日志历史与成长快照不在此处装载，由对应页面首次打开时按需读取。
+ */
+class StartupHydrator : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 可并行装载的区域。
+     */
+    enum class Section { Tasks, Achievements, ShopCatalog };
+
+    StartupHydrator(TaskManager& taskManager,
+                    AchievementManager& achievementManager,
+                    ShopManager& shopManager,
+                    QObject* parent = nullptr);
+    ~StartupHydrator() override;
+
+    StartupHydrator(const StartupHydrator&) = delete;
+    StartupHydrator& operator=(const StartupHydrator&) = delete;
+
+    /**
+     * @brief 把各区域的装载任务提交到线程池，立即返回；重复调用无效。
+     * 中文：须在登录之后调用，成就按当前用户装载。
+     */
+    void start();
+
+    /**
+     * @brief 区域是否已装载完成，只在 GUI 线程调用。
+     */
+    [[nodiscard]] bool isHydrated(Section section) const noexcept;
+
+    /**
+     * @brief 全部区域是否已结束（成功或失败）。
+     */
+    [[nodiscard]] bool isFinished() const noexcept;
+
+signals:
+    /**
+     * @brief 区域装载完成，在 GUI 线程发出。
+     */
+    void sectionHydrated(rove::data::StartupHydrator::Section section);
+
+    /**
+     * @brief 区域装载失败，在 GUI 线程发出；界面可提示后回退为空列表。
+     */
+    void sectionFailed(rove::data::StartupHydrator::Section section, const QString& message);
+
+    /**
+     * @brief 全部区域结束后发出一次。
+     */
+    void finished();
+
+private:
+    static constexpr std::size_t kSectionCount = 3;
+
+    void submit(Section section, std::function<void()> load);
+    void completeSection(Section section, const QString& error);
+
+    TaskManager& m_taskManager;
+    AchievementManager& m_achievementManager;
+    ShopManager& m_shopManager;
+    std::unique_ptr<QThreadPool> m_pool;
+    std::array<bool, kSectionCount> m_hydrated;
+    std::size_t m_pending;
+    bool m_started;
+};
+
+}  // namespace rove::data
+
+#endif  // STARTUPHYDRATOR_H
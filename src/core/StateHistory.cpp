@@ -0,0 +1,51 @@
+#include "StateHistory.h"
+
+#include <limits>
+
+#include "Metrics.h"
+
+namespace rove::data {
+
+StateHistory::StateHistory(const DatabaseManager& database) noexcept : m_database(database) {}
+
+/**
+ * @brief 没有更早的快照时从新用户的初始状态（1 级、成长值与属性为 0）回放全部变化记录。
+ */
+PointInTimeState StateHistory::stateAt(int ownerId, std::int64_t timestampMs, bool withInventory) const {
+    ROVE_SCOPED_TIMER(Charts, "StateHistory::stateAt");
+    PointInTimeState state;
+    state.timestampMs = timestampMs;
+    std::int64_t replayFromMs = std::numeric_limits<std::int64_t>::min();
+    if (const auto checkpoint = m_database.findSnapshotCheckpoint(ownerId, timestampMs)) {
+        const auto value = [&checkpoint](SnapshotColumn column) {
+            return checkpoint->values[static_cast<std::size_t>(column)];
+        };
+        state.checkpointMs = checkpoint->timestampMs;
+        state.level = value(SnapshotColumn::Level);
+        state.growthPoints = value(SnapshotColumn::Growth);
+        state.attributes.execution = value(SnapshotColumn::Execution);
+        state.attributes.perseverance = value(SnapshotColumn::Perseverance);
+        state.attributes.decision = value(SnapshotColumn::Decision);
+        state.attributes.knowledge = value(SnapshotColumn::Knowledge);
+        state.attributes.social = value(SnapshotColumn::Social);
+        state.attributes.pride = value(SnapshotColumn::Pride);
+        replayFromMs = checkpoint->timestampMs;
+    }
+    replay(state, m_database.queryProgressionDeltas(ownerId, replayFromMs, timestampMs));
+    if (withInventory) {
+        state.inventory = m_database.queryInventoryHeldAt(ownerId, timestampMs);
+    }
+    return state;
+}
+
+void StateHistory::replay(PointInTimeState& state,
+                          const std::vector<DatabaseManager::ProgressionDeltaRecord>& deltas) {
+    for (const auto& delta : deltas) {
+        state.level += delta.levelDelta;
+        state.growthPoints += delta.growthDelta;
+        state.attributes.add(delta.attributeDelta);
+    }
+    state.replayedDeltas += deltas.size();
+}
+
+}  // namespace rove::data
@@ -0,0 +1,56 @@
+#ifndef STATEHISTORY_H
+#define STATEHISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "DatabaseManager.h"
+#include "User.h"
+
+namespace rove::data {
+
+/**
+ * @brief 某一时刻的用户状态：等级、成长值、六维属性与当时持有的库存。
+ */
+struct PointInTimeState {
+    std::int64_t timestampMs = 0;
+    std::optional<std::int64_t> checkpointMs;  //!< 回放起点快照的时刻；为空表示从初始状态开始回放
+    std::size_t replayedDeltas = 0;            //!< 起点之后回放的变化记录条数
+    int level = 1;
+    int growthPoints = 0;
+    User::AttributeSet attributes;
+    std::vector<DatabaseManager::InventoryRecord> inventory;  //!< 已购入且未到期的库存，使用状态为当前值
+};
+
+/**
+ * @class StateHistory
+ * @brief 按时间点重建用户状态：取该时刻之前最近的成长快照作为起点，再顺序回放其后的变化记录。
+ * 中文：快照由 LogManager 在成长事件后写入，变化记录由 UserManager 在每次写回用户行时追加，
+ *       因此回放量只取决于两次快照之间的写回次数，一次查询为 O(log n + 回放条数)，与历史总长无关，
+ *       可直接响应看板时间轴的拖动。本类只读数据库，可在任意线程使用。
+ */
+class StateHistory {
+public:
+    explicit StateHistory(const DatabaseManager& database) noexcept;
+
+    /**
+     * @brief 重建 ownerId 在 timestampMs 时刻的状态。
+     * @param withInventory 为 false 时跳过库存查询，只重建数值状态。
+     * @throws std::runtime_error 数据库读取失败或快照块损坏。
+     */
+    [[nodiscard]] PointInTimeState stateAt(int ownerId, std::int64_t timestampMs, bool withInventory = true) const;
+
+    /**
+     * @brief 把变化记录依次叠加到 state 上，更新 replayedDeltas。
+     */
+    static void replay(PointInTimeState& state, const std::vector<DatabaseManager::ProgressionDeltaRecord>& deltas);
+
+private:
+    const DatabaseManager& m_database;
+};
+
+}  // namespace rove::data
+
+#endif  // STATEHISTORY_H
@@ -3,11 +3,21 @@
 #include <algorithm>
 #include <stdexcept>
 
+#include "EnumText.h"
+#include "MemoryAccounting.h"
+
 namespace rove::data {
 
 namespace {
 constexpr int kMinDifficulty = 1;
 constexpr int kMaxDifficulty = 5;
+
+constexpr EnumTextTable<Task::TaskType, 4> kTaskTypeText{{{
+    {Task::TaskType::Daily, "Daily"},
+    {Task::TaskType::Weekly, "Weekly"},
+    {Task::TaskType::Semester, "Semester"},
+    {Task::TaskType::Custom, "Custom"},
+}}};
 }
 
 Task::Task()
@@ -24,6 +34,7 @@ Task::Task()
       m_bonusStreak(0),
       m_forgivenessCoupons(0),
       m_customSettings("{}"),
+      m_settingsCache(),
       m_progressValue(0),
       m_progressGoal(100) {}
 
@@ -55,6 +66,7 @@ Task::Task(int id,
       m_bonusStreak(std::max(0, bonusStreak)),
       m_forgivenessCoupons(std::max(0, forgivenessCoupons)),
       m_customSettings(std::move(customSettings)),
+      m_settingsCache(),
       m_progressValue(std::max(0, progressValue)),
       m_progressGoal(std::max(1, progressGoal)) {}
 
@@ -112,7 +124,46 @@ void Task::setForgivenessCoupons(int count) noexcept { m_forgivenessCoupons = st
 
 const std::string& Task::customSettings() const noexcept { return m_customSettings; }
 
-void Task::setCustomSettings(std::string settings) { m_customSettings = std::move(settings); }
+void Task::setCustomSettings(std::string settings) {
+    m_customSettings = std::move(settings);
+    m_settingsCache.reset();
+}
+
+const TaskSettings& Task::settings() const {
+    std::shared_ptr<const TaskSettings> parsed = m_settingsCache.load();
+    if (parsed == nullptr) {
+        parsed = m_settingsCache.publish(std::make_shared<const TaskSettings>(TaskSettings::parse(m_customSettings)));
+    }
+    return *parsed;
+}
+
+bool Task::updateSettings(const std::function<void(TaskSettings&)>& edit) {
+    const TaskSettings& current = settings();
+    TaskSettings next = current;
+    edit(next);
+    if (next == current) {
+        return false;
+    }
+    m_customSettings = next.serialize();
+    m_settingsCache.reset(std::make_shared<const TaskSettings>(std::move(next)));
+    return true;
+}
+
+std::size_t Task::settingsHeapBytes() const {
+    std::size_t bytes = metrics::heapBytes(m_customSettings);
+    if (const std::shared_ptr<const TaskSettings> parsed = m_settingsCache.load()) {
+        bytes += sizeof(TaskSettings) + parsed->heapBytes();
+    }
+    return bytes;
+}
+
+std::shared_ptr<const TaskSettings> Task::SettingsCache::publish(std::shared_ptr<const TaskSettings> parsed) const {
+    std::shared_ptr<const TaskSettings> expected;
+    if (std::atomic_compare_exchange_strong(&m_parsed, &expected, parsed)) {
+        return parsed;
+    }
+    return expected;
+}
 
 int Task::progressValue() const noexcept { return m_progressValue; }
 
@@ -147,31 +198,15 @@ bool Task::recordFailure(bool useForgiveness) {
 }
 
 std::string Task::typeToString(TaskType type) {
-    switch (type) {
-        case TaskType::Daily:
-            return "Daily";
-        case TaskType::Weekly:
-            return "Weekly";
-        case TaskType::Semester:
-            return "Semester";
-        case TaskType::Custom:
-            return "Custom";
+    if (const auto text = kTaskTypeText.text(type)) {
+        return std::string(*text);
     }
     throw std::runtime_error("Unknown task type");
 }
 
-Task::TaskType Task::typeFromString(const std::string& text) {
-    if (text == "Daily") {
-        return TaskType::Daily;
-    }
-    if (text == "Weekly") {
-        return TaskType::Weekly;
-    }
-    if (text == "Semester") {
-        return TaskType::Semester;
-    }
-    if (text == "Custom") {
-        return TaskType::Custom;
+Task::TaskType Task::typeFromString(std::string_view text) {
+    if (const auto type = kTaskTypeText.value(text)) {
+        return *type;
     }
     throw std::runtime_error("Unsupported task type string");
 }
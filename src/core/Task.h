@@ -3,8 +3,12 @@
 
 #include <QDateTime>
 
+#include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
 
+#include "TaskSettings.h"
 #include "User.h"
 
 namespace rove::data {
@@ -88,9 +92,31 @@ public:
     [[nodiscard]] int forgivenessCoupons() const noexcept;
     void setForgivenessCoupons(int count) noexcept;
 
+    /**
+     * @brief 数据库中保存的设置文本；只有 updateSettings 确实改变了内容时才重新生成。
+     */
     [[nodiscard]] const std::string& customSettings() const noexcept;
     void setCustomSettings(std::string settings);
 
+    /**
+     * @brief 解析后的设置：首次访问时解析 customSettings 并缓存，之后直接返回缓存；复制任务时共享同一份解析结果。
+     * 中文：TaskManager 的读者在共享锁内并发访问同一个 Task，缓存以原子比较交换发布，先发布者胜出，
+     *       已发布的缓存只会被非 const 操作替换，返回的引用在任务被修改前一直有效。
+     */
+    [[nodiscard]] const TaskSettings& settings() const;
+
+    /**
+     * @brief 修改设置：edit 作用于缓存的副本，内容有变化时才重新序列化 customSettings。
+     *        更新进度等其他字段不会触碰设置文本。
+     * @return 设置是否发生变化。
+     */
+    bool updateSettings(const std::function<void(TaskSettings&)>& edit);
+
+    /**
+     * @brief 设置文本与已解析缓存的堆内存估算；尚未解析时只计文本，不为统计触发解析。
+     */
+    [[nodiscard]] std::size_t settingsHeapBytes() const;
+
     [[nodiscard]] int progressValue() const noexcept;
     void setProgressValue(int value);
 
@@ -130,9 +156,35 @@ public:
     /**
      * @brief 将数据库中的字符串还原为 TaskType。
      */
-    static TaskType typeFromString(const std::string& text);
+    static TaskType typeFromString(std::string_view text);
 
 private:
+    /**
+     * @brief 设置解析缓存；拷贝与读取经 std::atomic_load/std::atomic_compare_exchange_strong，
+     *        与其他读者的首次解析并发时也不会撕裂指针。
+     */
+    class SettingsCache {
+    public:
+        SettingsCache() = default;
+        SettingsCache(const SettingsCache& other) : m_parsed(other.load()) {}
+        SettingsCache& operator=(const SettingsCache& other) {
+            m_parsed = other.load();
+            return *this;
+        }
+        SettingsCache(SettingsCache&&) noexcept = default;
+        SettingsCache& operator=(SettingsCache&&) noexcept = default;
+
+        [[nodiscard]] std::shared_ptr<const TaskSettings> load() const { return std::atomic_load(&m_parsed); }
+        /**
+         * @brief 缓存为空时发布 parsed，返回最终生效的缓存（可能是其他读者先发布的）。
+         */
+        [[nodiscard]] std::shared_ptr<const TaskSettings> publish(std::shared_ptr<const TaskSettings> parsed) const;
+        void reset(std::shared_ptr<const TaskSettings> parsed = nullptr) { m_parsed = std::move(parsed); }
+
+    private:
+        mutable std::shared_ptr<const TaskSettings> m_parsed;
+    };
+
     int m_taskId;
     std::string m_name;
     std::string m_description;
@@ -146,6 +198,7 @@ private:
     int m_bonusStreak;
     int m_forgivenessCoupons;
     std::string m_customSettings;
+    SettingsCache m_settingsCache;
     int m_progressValue;
     int m_progressGoal;
 };
@@ -1,20 +1,59 @@
 #include "TaskManager.h"
 
 #include <QDate>
+#include <QDateTime>
 #include <QString>
+#include <QTime>
 #include <QtGlobal>
 
 #include <algorithm>
-#include <cmath>
-#include <sstream>
+#include <iterator>
+#include <limits>
 #include <stdexcept>
 
+#include "EventJournal.h"
+#include "RewardRules.h"
+
 namespace rove::data {
 
 namespace {
-constexpr int kDayMilliseconds = 24 * 60 * 60 * 1000;
+constexpr qint64 kBoundarySlackMilliseconds = 1000;          // 晚于零点 1 秒触发，避免定时器略早到达时仍是前一天
+constexpr qint64 kMaxBoundaryWaitMilliseconds = 60 * 60 * 1000;  // 最长一小时重新对齐，吸收系统改时与休眠
+constexpr const char* kDailyWatermarkKey = "tasks.daily_reset_day";    // 已处理到的日期（儒略日），按用户加后缀
+constexpr const char* kWeeklyWatermarkKey = "tasks.weekly_reset_week";  // 已处理到的周一（儒略日），按用户加后缀
+
+constexpr qint64 kNoPendingDeadline = std::numeric_limits<qint64>::max();
+
+QDate weekStart(const QDate& day) { return day.addDays(1 - day.dayOfWeek()); }
+
+/**
+ * @brief 距下一个本地零点的毫秒数；按本地时区构造“明天 00:00”，夏令时切换日的 23/25 小时由 Qt 换算，
+ *        零点不存在的时区顺延到跳变后的首个有效时刻。每周边界（周一零点）也是零点，无需单独计算。
+ */
+qint64 msecsUntilNextMidnight(const QDateTime& now) {
+    const QDateTime nextMidnight(now.date().addDays(1), QTime(0, 0));
+    return std::max<qint64>(now.msecsTo(nextMidnight), 0);
 }
 
+qint64 deadlineKey(const Task& task) { return task.deadline().toMSecsSinceEpoch(); }
+
+/**
+ * @brief 一个任务映射与其截止队列的内存估算；已解析的设置对象计入每份引用它的任务，副本共享时略有高估。
+ */
+metrics::MemoryUsage taskMapUsage(const std::unordered_map<int, Task>& tasks,
+                                  const std::set<std::pair<qint64, int>>& deadlineQueue) {
+    metrics::MemoryUsage usage;
+    usage.entries = tasks.size();
+    usage.bytes = metrics::nodeContainerBytes(tasks.size(), sizeof(std::pair<const int, Task>), tasks.bucket_count()) +
+                  metrics::nodeContainerBytes(deadlineQueue.size(), sizeof(std::pair<qint64, int>));
+    for (const auto& [id, task] : tasks) {
+        usage.bytes += metrics::heapBytes(task.name()) + metrics::heapBytes(task.description()) +
+                       task.settingsHeapBytes();
+    }
+    return usage;
+}
+}  // namespace
+
 TaskManager& TaskManager::instance(DatabaseManager& database, UserManager& userManager) {
     static TaskManager instance(database, userManager);
     return instance;
@@ -24,54 +63,213 @@ TaskManager::TaskManager(DatabaseManager& database, UserManager& userManager)
     : m_database(database),
       m_userManager(userManager),
       m_tasks(),
-      m_completionStats(),
-      m_dailyTimer(),
-      m_weeklyTimer(),
+      m_typeIndex(),
+      m_outcomeTotals(),
+      m_generation(0),
+      m_ownerId(0),
+      m_hydrated(false),
+      m_parkedCaches(),
+      m_processedDay(0),
+      m_deadlineQueue(),
+      m_enforcedDeadlines(),
+      m_armedDeadlineMs(kNoPendingDeadline),
+      m_deadlineRearmPosted(false),
+      m_boundaryTimer(),
+      m_deadlineTimer(),
       m_timerContext(),
       m_signalProxy(std::make_unique<TaskManagerSignalProxy>()),
-      m_mutex() {
-    m_dailyTimer = std::make_unique<QTimer>();
-    m_weeklyTimer = std::make_unique<QTimer>();
-    refreshFromDatabase();
+      m_mutex("TaskManager"),
+      m_memoryRegistration() {
+    m_boundaryTimer = std::make_unique<QTimer>();
+    m_deadlineTimer = std::make_unique<QTimer>();
+    // 中文：任务列表不在构造时装载，启动时由 StartupHydrator 在工作线程调用 refreshFromDatabase()。
     configureTimers();
+    if (auto* proxy = m_userManager.signalProxy()) {
+        QObject::connect(proxy, &UserManagerSignalProxy::sessionChanged, &m_timerContext,
+                         [this](int userId) { onSessionChanged(userId); });
+        QObject::connect(proxy, &UserManagerSignalProxy::userDeleted, &m_timerContext,
+                         [this](int userId) { onUserDeleted(userId); });
+    }
+    m_memoryRegistration = metrics::MemoryRegistry::instance().add(
+        "tasks", [this]() { return memoryUsage(); }, [this]() { trimMemory(); });
+}
+
+/**
+ * @brief 会话切换：暂存当前用户的缓存，恢复或装载新用户的缓存，再按新用户的水位补做重置。
+ * 中文：退出登录（userId 为 0）只暂存不装载，不访问数据库；暂存区按最近使用排序，超出容量时丢弃最久未用者。
+ */
+void TaskManager::onSessionChanged(int userId) {
+    bool restored = false;
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        if (!m_hydrated || userId == m_ownerId) {
+            return;
+        }
+        TaskCache active;
+        active.ownerId = m_ownerId;
+        active.tasks.swap(m_tasks);
+        active.typeIndex.swap(m_typeIndex);
+        active.outcomeTotals = std::exchange(m_outcomeTotals, {});
+        active.deadlineQueue.swap(m_deadlineQueue);
+        active.enforcedDeadlines.swap(m_enforcedDeadlines);
+        const auto parked = std::find_if(m_parkedCaches.begin(), m_parkedCaches.end(),
+                                         [userId](const TaskCache& cache) { return cache.ownerId == userId; });
+        if (parked != m_parkedCaches.end()) {
+            installCacheLocked(std::move(*parked));
+            m_parkedCaches.erase(parked);
+            restored = true;
+        } else {
+            m_ownerId = userId;
+            ++m_generation;
+        }
+        if (active.ownerId != 0) {
+            m_parkedCaches.push_front(std::move(active));
+        }
+        while (m_parkedCaches.size() > kMaxParkedOwners) {
+            m_parkedCaches.pop_back();
+        }
+    }
+    if (restored || userId == 0) {
+        emitTasksReloaded();
+    }
+    if (userId == 0) {
+        return;
+    }
+    if (!restored) {
+        refreshFromDatabase();
+    }
+    m_processedDay.store(0);
+    catchUpResets();
+}
+
+/**
+ * @brief 用户被删除：丢弃其暂存缓存（任务、截止队列与判定标记一并丢弃）。
+ * 中文：当前登录用户不能被删除，因此只需处理暂存区；不访问数据库。
+ */
+void TaskManager::onUserDeleted(int userId) {
+    std::unique_lock<StateMutex> lock(m_mutex);
+    m_parkedCaches.remove_if([userId](const TaskCache& cache) { return cache.ownerId == userId; });
+}
+
+/**
+ * @brief 以构建好的缓存替换当前缓存，已判定过的截止条目不再入队；调用方需持有独占锁。
+ * 中文：判定标记随缓存整体替换，已删除任务的标记不会残留。
+ */
+void TaskManager::installCacheLocked(TaskCache&& cache) {
+    m_ownerId = cache.ownerId;
+    m_tasks.swap(cache.tasks);
+    m_typeIndex.swap(cache.typeIndex);
+    m_outcomeTotals = cache.outcomeTotals;
+    m_deadlineQueue.swap(cache.deadlineQueue);
+    m_enforcedDeadlines.swap(cache.enforcedDeadlines);
+    for (auto it = m_deadlineQueue.begin(); it != m_deadlineQueue.end();) {
+        const auto enforced = m_enforcedDeadlines.find(it->second);
+        it = enforced != m_enforcedDeadlines.end() && enforced->second == it->first ? m_deadlineQueue.erase(it)
+                                                                                    : std::next(it);
+    }
+    if (!m_deadlineQueue.empty()) {
+        requestDeadlineRearmLocked(m_deadlineQueue.begin()->first);
+    }
+    ++m_generation;
 }
 
 /**
- * @brief 配置每日/每周 QTimer，自动触发重置逻辑。
- * 中文：Qt 定时器保证在主线程安全执行，避免多线程直接操纵任务缓存，满足“使用 QTimer 实现重置”的要求。
+ * @brief 开启事件日志时记录一条任务命令；未登录时用户记为 0，不因记录而抛出。
+ */
+void TaskManager::journalCommand(JournalCommand command, int taskId, std::int64_t arg) const {
+    EventJournal& journal = EventJournal::instance();
+    if (!journal.isRecording()) {
+        return;
+    }
+    const int userId = m_userManager.hasActiveUser() ? m_userManager.activeUserId() : 0;
+    journal.record(command, userId, taskId, arg);
+}
+
+/**
+ * @brief 新写入的行与统计归属当前缓存的用户；首次装载前退回当前会话。
+ */
+int TaskManager::ownerForWrites() const {
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        if (m_ownerId != 0) {
+            return m_ownerId;
+        }
+    }
+    return m_userManager.activeUserId();
+}
+
+/**
+ * @brief 配置零点对齐的单次定时器：触发后先按当前时间重新布置，再调用 catchUpResets()。
+ * 中文：Qt 定时器保证在主线程安全执行；定时器只负责“在边界时刻醒来”，是否重置由持久化水位判断，
+ *       因此提前、推迟或因改时多次触发都只会补做一次。
+ *       截止定时器同为单次定时器，瞄准截止队列中最早的学期任务，触发后判定到期任务并重新瞄准下一个。
  */
 void TaskManager::configureTimers() {
-    if (m_dailyTimer) {
-        m_dailyTimer->setInterval(kDayMilliseconds);
-        m_dailyTimer->setTimerType(Qt::VeryCoarseTimer);
-        QObject::connect(m_dailyTimer.get(), &QTimer::timeout, &m_timerContext, [this]() { resetDailyTasks(); });
-        m_dailyTimer->start();
-    }
-    if (m_weeklyTimer) {
-        m_weeklyTimer->setInterval(kDayMilliseconds);
-        m_weeklyTimer->setTimerType(Qt::VeryCoarseTimer);
-        QObject::connect(m_weeklyTimer.get(), &QTimer::timeout, &m_timerContext, [this]() {
-            if (QDate::currentDate().dayOfWeek() == 1) {
-                resetWeeklyTasks();
-            }
+    if (m_boundaryTimer) {
+        m_boundaryTimer->setSingleShot(true);
+        m_boundaryTimer->setTimerType(Qt::PreciseTimer);
+        QObject::connect(m_boundaryTimer.get(), &QTimer::timeout, &m_timerContext, [this]() {
+            scheduleNextBoundary();
+            catchUpResets();
+        });
+        scheduleNextBoundary();
+    }
+    if (m_deadlineTimer) {
+        m_deadlineTimer->setSingleShot(true);
+        m_deadlineTimer->setTimerType(Qt::PreciseTimer);
+        QObject::connect(m_deadlineTimer.get(), &QTimer::timeout, &m_timerContext, [this]() {
+            std::vector<int> failed;
+            m_database.runInTransaction([&]() { failed = enforceSemesterDeadlines(); });
+            emitTasksChanged(failed);
+            scheduleNextDeadline();
         });
-        m_weeklyTimer->start();
     }
 }
 
+/**
+ * @brief 布置到下一个本地零点（加少量余量）；等待时间封顶一小时，系统时间被调整或机器休眠后最迟一小时内重新对齐。
+ */
+void TaskManager::scheduleNextBoundary() {
+    const qint64 untilMidnight = msecsUntilNextMidnight(QDateTime::currentDateTime()) + kBoundarySlackMilliseconds;
+    m_boundaryTimer->start(static_cast<int>(std::min(untilMidnight, kMaxBoundaryWaitMilliseconds)));
+}
+
+/**
+ * @brief 瞄准截止队列队首：到期后 1 毫秒触发（isExpired 要求严格晚于截止时间），队列为空时停表；
+ *        等待同样封顶一小时，吸收系统改时。只在定时器所在线程调用，其他线程经 requestDeadlineRearmLocked 投递。
+ */
+void TaskManager::scheduleNextDeadline() {
+    m_deadlineRearmPosted.store(false);
+    qint64 next = kNoPendingDeadline;
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        if (!m_deadlineQueue.empty()) {
+            next = m_deadlineQueue.begin()->first;
+        }
+        m_armedDeadlineMs = next;
+    }
+    if (next == kNoPendingDeadline) {
+        m_deadlineTimer->stop();
+        return;
+    }
+    const qint64 untilDeadline = std::max<qint64>(next - QDateTime::currentMSecsSinceEpoch() + 1, 0);
+    m_deadlineTimer->start(static_cast<int>(std::min(untilDeadline, kMaxBoundaryWaitMilliseconds)));
+}
+
 /**
  * @brief 创建任务时，先写入数据库再更新内存缓存，保证 ID 与持久化一致。
- * 中文：此处持有互斥锁，确保在并发环境中不会出现重复插入或 ID 冲突。
+ * 中文：新行 ID 由数据库分配，插入本身即可与其他写者并发；只在写入缓存时短暂持有独占锁。
  */
 int TaskManager::createTask(Task task) {
-    std::lock_guard<std::mutex> lock(m_mutex);
     DatabaseManager::TaskRecord record = toRecord(task);
+    record.ownerId = ownerForWrites();
     const int newId = m_database.createTask(record);
     task.setId(newId);
-    m_tasks[newId] = task;
-    if (task.isCompleted()) {
-        m_completionStats[task.type()] += 1;
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        storeTaskLocked(std::move(task));
     }
+    emitTasksChanged({newId});
     return newId;
 }
 
@@ -80,28 +278,42 @@ int TaskManager::createTask(Task task) {
  * 中文：若任务不存在立即抛异常，让 UI 层提示用户防止误操作。
  */
 void TaskManager::updateTask(const Task& task) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    if (task.id() <= 0 || m_tasks.find(task.id()) == m_tasks.end()) {
-        throw std::runtime_error("Task not found");
-    }
-    m_tasks[task.id()] = task;
-    m_database.updateTask(toRecord(task));
+    m_database.runInTransaction([&]() {
+        if (task.id() <= 0 || !taskById(task.id()).has_value()) {
+            throw std::runtime_error("Task not found");
+        }
+        m_database.updateTask(toRecord(task));
+        std::unique_lock<StateMutex> lock(m_mutex);
+        storeTaskLocked(task);
+    });
+    emitTasksChanged({task.id()});
 }
 
 /**
  * @brief 删除任务的统一入口，确保数据库与缓存同步删除。
  */
 void TaskManager::deleteTask(int taskId) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_database.deleteTask(taskId);
-    m_tasks.erase(taskId);
+    m_database.runInTransaction([&]() {
+        m_database.deleteTask(taskId);
+        std::unique_lock<StateMutex> lock(m_mutex);
+        auto it = m_tasks.find(taskId);
+        if (it != m_tasks.end()) {
+            reloadCacheOnRollback();
+            unindexTaskLocked(taskId, it->second.type());
+            dequeueDeadlineLocked(it->second);
+            m_enforcedDeadlines.erase(taskId);
+            m_tasks.erase(it);
+            ++m_generation;
+        }
+    });
+    emitTasksChanged({taskId});
 }
 
 /**
  * @brief 提供按 ID 查询的线程安全方法，方便 UI 或脚本读取详情。
  */
 std::optional<Task> TaskManager::taskById(int taskId) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::shared_lock<StateMutex> lock(m_mutex);
     auto it = m_tasks.find(taskId);
     if (it == m_tasks.end()) {
         return std::nullopt;
@@ -113,29 +325,55 @@ std::optional<Task> TaskManager::taskById(int taskId) const {
  * @brief 根据类型筛选任务，用于 Daily/Weekly/Semester 分栏展示。
  */
 std::vector<Task> TaskManager::tasksByType(Task::TaskType type) const {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    std::shared_lock<StateMutex> lock(m_mutex);
+    const auto& bucket = typeBucket(type);
     std::vector<Task> result;
-    for (const auto& [id, task] : m_tasks) {
-        if (task.type() == type) {
-            result.push_back(task);
-        }
+    result.reserve(bucket.size());
+    for (int id : bucket) {
+        result.push_back(m_tasks.at(id));
     }
     return result;
 }
 
 /**
- * @brief 标记任务完成并分发奖励，内部调用 applyRewardsLocked 完成事务保护。
+ * @brief 直接在类型桶上遍历，UI 填充列表时无需深拷贝任务及其字符串。
  */
-void TaskManager::markTaskCompleted(int taskId) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_tasks.find(taskId);
-    if (it == m_tasks.end()) {
-        throw std::runtime_error("Task not found");
+void TaskManager::forEachTask(Task::TaskType type, const TaskVisitor& visitor) const {
+    std::shared_lock<StateMutex> lock(m_mutex);
+    for (int id : typeBucket(type)) {
+        visitor(m_tasks.at(id));
     }
-    if (it->second.isCompleted()) {
-        return;
+}
+
+void TaskManager::forEachTask(const TaskVisitor& visitor) const {
+    std::shared_lock<StateMutex> lock(m_mutex);
+    for (const auto& bucket : m_typeIndex) {
+        for (int id : bucket) {
+            visitor(m_tasks.at(id));
+        }
+    }
+}
+
+/**
+ * @brief 标记任务完成并分发奖励；applyRewards 在事务内结算，taskCompleted 在提交后发出。
+ */
+void TaskManager::markTaskCompleted(int taskId) {
+    journalCommand(JournalCommand::CompleteTask, taskId, 0);
+    std::optional<Task> completed;
+    m_database.runInTransaction([&]() {
+        std::optional<Task> task = taskById(taskId);
+        if (!task.has_value()) {
+            throw std::runtime_error("Task not found");
+        }
+        if (task->isCompleted()) {
+            return;
+        }
+        applyRewards(*task);
+        completed = std::move(task);
+    });
+    if (completed.has_value()) {
+        emitTaskCompleted(*completed);
     }
-    applyRewardsLocked(it->second);
 }
 
 /**
@@ -144,113 +382,387 @@ void TaskManager::markTaskCompleted(int taskId) {
  *       并立刻持久化，保证数据一致。
  */
 void TaskManager::failTask(int taskId, bool useForgiveness) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_tasks.find(taskId);
-    if (it == m_tasks.end()) {
-        throw std::runtime_error("Task not found");
-    }
-    it->second.recordFailure(useForgiveness);
-    m_database.updateTask(toRecord(it->second));
+    journalCommand(JournalCommand::FailTask, taskId, useForgiveness ? 1 : 0);
+    m_database.runInTransaction([&]() {
+        std::optional<Task> task = taskById(taskId);
+        if (!task.has_value()) {
+            throw std::runtime_error("Task not found");
+        }
+        const bool recorded = task->recordFailure(useForgiveness);
+        bool failed = recorded;
+        // 中文：学期任务按截止时间只计一次失败，手动判定与到期判定共用 task_deadline_failures 的标记。
+        const bool deadlineBound = task->type() == Task::TaskType::Semester && task->deadline().isValid();
+        if (failed && deadlineBound) {
+            failed = m_database.recordTaskDeadlineFailure(task->id(), deadlineKey(*task));
+        }
+        m_database.updateTask(toRecord(*task));
+        if (failed) {
+            m_database.recordTaskOutcome(ownerForWrites(), statsDay(), Task::typeToString(task->type()), 0, 1);
+        }
+        std::unique_lock<StateMutex> lock(m_mutex);
+        if (failed) {
+            ++m_outcomeTotals[static_cast<std::size_t>(task->type())].failed;
+        }
+        if (recorded && deadlineBound) {
+            m_enforcedDeadlines[task->id()] = deadlineKey(*task);
+        }
+        storeTaskLocked(std::move(*task));
+    });
+    emitTasksChanged({taskId});
 }
 
 /**
  * @brief 更新任务进度，达到目标后自动触发完成，体现“进度跟踪与统计”。
  */
 void TaskManager::updateTaskProgress(int taskId, int delta) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_tasks.find(taskId);
-    if (it == m_tasks.end()) {
-        throw std::runtime_error("Task not found");
-    }
-    const int newValue = std::clamp(it->second.progressValue() + delta, 0, it->second.progressGoal());
-    it->second.setProgressValue(newValue);
+    journalCommand(JournalCommand::TaskProgress, taskId, delta);
+    int newValue = 0;
+    int goalValue = 0;
+    std::optional<Task> completed;
+    m_database.runInTransaction([&]() {
+        std::optional<Task> task = taskById(taskId);
+        if (!task.has_value()) {
+            throw std::runtime_error("Task not found");
+        }
+        newValue = std::clamp(task->progressValue() + delta, 0, task->progressGoal());
+        goalValue = task->progressGoal();
+        task->setProgressValue(newValue);
+        if (newValue >= goalValue) {
+            applyRewards(*task);
+            completed = std::move(task);
+            return;
+        }
+        m_database.updateTask(toRecord(*task));
+        std::unique_lock<StateMutex> lock(m_mutex);
+        storeTaskLocked(std::move(*task));
+    });
     if (m_signalProxy) {
-        emit m_signalProxy->taskProgressed(taskId, newValue, it->second.progressGoal());
+        m_database.runAfterCommit([proxy = m_signalProxy.get(), taskId, newValue, goalValue]() {
+            emit proxy->taskProgressed(taskId, newValue, goalValue);
+        });
     }
-    if (newValue >= it->second.progressGoal()) {
-        applyRewardsLocked(it->second);
-        return;
+    if (completed.has_value()) {
+        emitTaskCompleted(*completed);
     }
-    m_database.updateTask(toRecord(it->second));
 }
 
 /**
- * @brief 从数据库重新加载任务，便于多端协作或教师远程干预后保持一致性。
+ * @brief 从数据库重新加载当前用户的任务，便于多端协作或教师远程干预后保持一致性。
+ * 中文：在事务内读取代次并流式读取该用户的记录，此时之前的写者均已提交，读到的行与代次一致；
+ *       每行直接移入新缓存，不保留中间记录数组，构建在 m_mutex 之外完成，最后在独占锁内整体交换。
+ *       若期间有写者更新过缓存（代次变化），快照已过时，丢弃后重读。
  */
 void TaskManager::refreshFromDatabase() {
-    auto records = m_database.getAllTasks();
-    std::lock_guard<std::mutex> lock(m_mutex);
-    hydrateTasksFromRecords(records);
+    for (;;) {
+        std::uint64_t generation = 0;
+        TaskCache cache;
+        cache.ownerId = m_userManager.hasActiveUser() ? m_userManager.activeUserId() : 0;
+        m_database.runInTransaction([&]() {
+            {
+                std::shared_lock<StateMutex> lock(m_mutex);
+                generation = m_generation;
+            }
+            m_database.streamTasksForOwner(cache.ownerId, [this, &cache](DatabaseManager::TaskRecord& record) {
+                hydrateIntoCache(cache, std::move(record));
+            });
+            for (const auto& totals : m_database.getTaskStatTotals(cache.ownerId)) {
+                const auto type = Task::typeFromString(totals.type);
+                cache.outcomeTotals[static_cast<std::size_t>(type)] = TaskTotals{totals.completed, totals.failed};
+            }
+            for (const auto& [taskId, deadlineMs] : m_database.getTaskDeadlineFailures(cache.ownerId)) {
+                cache.enforcedDeadlines.emplace(taskId, deadlineMs);
+            }
+        });
+        std::unique_lock<StateMutex> lock(m_mutex);
+        if (generation != m_generation) {
+            continue;
+        }
+        installCacheLocked(std::move(cache));
+        m_hydrated = true;
+        lock.unlock();
+        emitTasksReloaded();
+        return;
+    }
 }
 
 /**
  * @brief 返回当前统计信息副本，让 UI 可以在不加锁的情况下展示完成度。
  */
 std::unordered_map<Task::TaskType, int> TaskManager::taskStatistics() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_completionStats;
+    std::shared_lock<StateMutex> lock(m_mutex);
+    std::unordered_map<Task::TaskType, int> stats;
+    for (auto type : {Task::TaskType::Daily, Task::TaskType::Weekly, Task::TaskType::Semester, Task::TaskType::Custom}) {
+        stats[type] = m_outcomeTotals[static_cast<std::size_t>(type)].completed;
+    }
+    return stats;
+}
+
+TaskManager::TaskTotals TaskManager::taskTotals() const {
+    std::shared_lock<StateMutex> lock(m_mutex);
+    TaskTotals sum;
+    for (const auto& totals : m_outcomeTotals) {
+        sum.completed += totals.completed;
+        sum.failed += totals.failed;
+    }
+    return sum;
+}
+
+std::vector<DatabaseManager::TaskStatRecord> TaskManager::dailyStatistics(const QDate& from, const QDate& to) const {
+    int ownerId = 0;
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        ownerId = m_ownerId;
+    }
+    return m_database.queryTaskStats(ownerId, from.toString(Qt::ISODate).toStdString(),
+                                     to.toString(Qt::ISODate).toStdString());
 }
 
 /**
  * @brief 每日重置逻辑：对所有日常任务重置进度、必要时清空连胜，并再次检查学期任务是否过期。
  */
 void TaskManager::resetDailyTasks() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    resetTasksByPredicate(Task::TaskType::Daily);
-    enforceSemesterDeadlinesLocked();
+    std::vector<int> changed;
+    m_database.runInTransaction([&]() {
+        changed = resetTasksByPredicate(Task::TaskType::Daily, false);
+        const std::vector<int> failed = enforceSemesterDeadlines();
+        changed.insert(changed.end(), failed.begin(), failed.end());
+    });
+    emitTasksChanged(changed);
 }
 
 /**
  * @brief 每周重置逻辑，只在周一触发，保持周任务节奏感。
  */
-void TaskManager::resetWeeklyTasks() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    if (QDate::currentDate().dayOfWeek() != 1) {
+void TaskManager::resetWeeklyTasks(const QDate& today) {
+    if (today.dayOfWeek() != 1) {
         return;
     }
-    resetTasksByPredicate(Task::TaskType::Weekly);
-    enforceSemesterDeadlinesLocked();
+    std::vector<int> changed;
+    m_database.runInTransaction([&]() {
+        changed = resetTasksByPredicate(Task::TaskType::Weekly, false);
+        const std::vector<int> failed = enforceSemesterDeadlines();
+        changed.insert(changed.end(), failed.begin(), failed.end());
+    });
+    emitTasksChanged(changed);
+}
+
+/**
+ * @brief 补做错过的重置：比较 app_state 中的每日/每周水位与 today，落后时各重置一次并推进水位。
+ * 中文：读水位、重置任务与写回水位在同一事务内完成，并发调用由事务串行化，后到者看到已推进的水位直接返回。
+ *       跨越多个周期（如应用关闭数天）时只做一次批量更新，但中间周期无人完成任务，连胜一并清零；
+ *       首次运行尚无水位时只记录当天，不做重置。当天已处理过则不开事务。水位按缓存所属用户分别记录，
+ *       尚未装载任何用户时不处理。
+ */
+void TaskManager::catchUpResets(const QDate& today) {
+    const qint64 todayDay = today.toJulianDay();
+    if (m_processedDay.load() == todayDay) {
+        return;
+    }
+    int ownerId = 0;
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        ownerId = m_ownerId;
+    }
+    if (ownerId == 0) {
+        return;
+    }
+    const qint64 currentWeek = weekStart(today).toJulianDay();
+    const std::string dailyKey = watermarkKey(kDailyWatermarkKey, ownerId);
+    const std::string weeklyKey = watermarkKey(kWeeklyWatermarkKey, ownerId);
+    std::vector<int> changed;
+    m_database.runInTransaction([&]() {
+        changed.clear();
+        const std::optional<std::int64_t> lastDay = m_database.getAppState(dailyKey);
+        const std::optional<std::int64_t> lastWeek = m_database.getAppState(weeklyKey);
+        bool resetApplied = false;
+        if (lastDay.has_value() && *lastDay < todayDay) {
+            changed = resetTasksByPredicate(Task::TaskType::Daily, todayDay - *lastDay > 1);
+            resetApplied = true;
+        }
+        if (lastWeek.has_value() && *lastWeek < currentWeek) {
+            const std::vector<int> weekly = resetTasksByPredicate(Task::TaskType::Weekly, currentWeek - *lastWeek > 7);
+            changed.insert(changed.end(), weekly.begin(), weekly.end());
+            resetApplied = true;
+        }
+        if (resetApplied) {
+            const std::vector<int> failed = enforceSemesterDeadlines();
+            changed.insert(changed.end(), failed.begin(), failed.end());
+        }
+        if (!lastDay.has_value() || *lastDay < todayDay) {
+            m_database.setAppState(dailyKey, todayDay);
+        }
+        if (!lastWeek.has_value() || *lastWeek < currentWeek) {
+            m_database.setAppState(weeklyKey, currentWeek);
+        }
+    });
+    m_processedDay.store(todayDay);
+    emitTasksChanged(changed);
 }
 
 TaskManagerSignalProxy* TaskManager::signalProxy() const noexcept { return m_signalProxy.get(); }
 
+metrics::MemoryUsage TaskManager::memoryUsage() const {
+    std::shared_lock<StateMutex> lock(m_mutex);
+    metrics::MemoryUsage usage = taskMapUsage(m_tasks, m_deadlineQueue);
+    for (const auto& bucket : m_typeIndex) {
+        usage.bytes += metrics::heapBytes(bucket);
+    }
+    usage.bytes += metrics::nodeContainerBytes(m_enforcedDeadlines.size(), sizeof(std::pair<const int, qint64>),
+                                               m_enforcedDeadlines.bucket_count());
+    for (const auto& parked : m_parkedCaches) {
+        usage += taskMapUsage(parked.tasks, parked.deadlineQueue);
+        usage.bytes += metrics::nodeContainerBytes(parked.enforcedDeadlines.size(),
+                                                   sizeof(std::pair<const int, qint64>),
+                                                   parked.enforcedDeadlines.bucket_count());
+        for (const auto& bucket : parked.typeIndex) {
+            usage.bytes += metrics::heapBytes(bucket);
+        }
+    }
+    return usage;
+}
+
+void TaskManager::trimMemory() {
+    std::list<TaskCache> dropped;
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        dropped.swap(m_parkedCaches);
+    }
+    // 中文：在锁外释放被丢弃的缓存，析构大量 Task 不阻塞读者。
+}
+
+/**
+ * @brief 将一条数据库记录灌入新的缓存，同时累计统计数据与截止队列。
+ * 中文：应用启动时一次性装载，既保证 UI 快速响应，也避免频繁访问磁盘；不访问成员状态，可在锁外执行。
+ *       记录中的字符串直接移入 Task 并原位构造进映射，每个字段只分配一次；类型与 ISO 截止文本留在记录中供下一行复用。
+ */
+void TaskManager::hydrateIntoCache(TaskCache& cache, DatabaseManager::TaskRecord&& record) const {
+    const int id = record.id;
+    const auto [it, inserted] = cache.tasks.try_emplace(id, hydrateTask(std::move(record)));
+    if (!inserted) {
+        return;
+    }
+    const Task& task = it->second;
+    cache.typeIndex[static_cast<std::size_t>(task.type())].push_back(id);
+    if (task.type() == Task::TaskType::Semester && !task.isCompleted() && task.deadline().isValid()) {
+        cache.deadlineQueue.emplace(deadlineKey(task), id);
+    }
+}
+
 /**
- * @brief 将数据库记录灌入内存缓存，同时重建统计数据。
- * 中文：应用启动时一次性装载，既保证 UI 快速响应，也避免频繁访问磁盘。
+ * @brief 写回缓存中的一条任务，类型变化时同步调整类型桶，并按新的类型/完成状态/截止时间重排截止队列；
+ *        调用方需持有独占锁。
  */
-void TaskManager::hydrateTasksFromRecords(const std::vector<DatabaseManager::TaskRecord>& records) {
-    m_tasks.clear();
-    m_completionStats.clear();
-    for (const auto& record : records) {
-        Task task = hydrateTask(record);
-        if (task.isCompleted()) {
-            m_completionStats[task.type()] += 1;
+void TaskManager::storeTaskLocked(Task task) {
+    reloadCacheOnRollback();
+    auto it = m_tasks.find(task.id());
+    if (it == m_tasks.end()) {
+        indexTaskLocked(task);
+        queueDeadlineLocked(task);
+        m_tasks.emplace(task.id(), std::move(task));
+    } else {
+        if (it->second.type() != task.type()) {
+            unindexTaskLocked(task.id(), it->second.type());
+            indexTaskLocked(task);
         }
-        m_tasks.emplace(task.id(), task);
+        dequeueDeadlineLocked(it->second);
+        queueDeadlineLocked(task);
+        it->second = std::move(task);
     }
+    ++m_generation;
 }
 
 /**
- * @brief 将 TaskRecord 还原为领域对象，包含截止时间、奖励等字段。
+ * @brief 缓存在事务内先于提交改写（任务、统计与截止队列）；外层事务回滚时整体从数据库重新装载。
+ * 中文：同一事务内多次调用只登记一次；不在事务中时写入已各自提交，无需登记。可在持有 m_mutex 时调用。
+ */
+void TaskManager::reloadCacheOnRollback() {
+    m_database.runOnRollback(this, [this]() { refreshFromDatabase(); });
+}
+
+/**
+ * @brief 未完成、截止时间有效且尚未按该截止时间判定过失败的学期任务才需要等待截止；调用方需持有 m_mutex。
+ */
+bool TaskManager::awaitsDeadlineLocked(const Task& task) const {
+    if (task.type() != Task::TaskType::Semester || task.isCompleted() || !task.deadline().isValid()) {
+        return false;
+    }
+    const auto enforced = m_enforcedDeadlines.find(task.id());
+    return enforced == m_enforcedDeadlines.end() || enforced->second != deadlineKey(task);
+}
+
+/**
+ * @brief 需要等待截止的任务加入截止队列；比定时器当前目标更早时请求重新瞄准。调用方需持有独占锁。
+ */
+void TaskManager::queueDeadlineLocked(const Task& task) {
+    if (!awaitsDeadlineLocked(task)) {
+        return;
+    }
+    const qint64 deadlineMs = deadlineKey(task);
+    m_deadlineQueue.emplace(deadlineMs, task.id());
+    requestDeadlineRearmLocked(deadlineMs);
+}
+
+/**
+ * @brief 按缓存中的旧值移除队列条目，条目不存在时无操作；调用方需持有独占锁。
  */
-Task TaskManager::hydrateTask(const DatabaseManager::TaskRecord& record) const {
-    QDateTime deadline = QDateTime::fromString(QString::fromStdString(record.deadlineIso), Qt::ISODate);
-    if (!deadline.isValid()) {
-        deadline = QDateTime::currentDateTimeUtc();
+void TaskManager::dequeueDeadlineLocked(const Task& task) {
+    m_deadlineQueue.erase({deadlineKey(task), task.id()});
+}
+
+/**
+ * @brief 更早的截止时间需要重新布置定时器：QTimer 只能在所属线程操作，这里向定时器线程投递一次
+ *        scheduleNextDeadline()，已有待处理的投递时不再重复；调用方需持有独占锁。
+ */
+void TaskManager::requestDeadlineRearmLocked(qint64 deadlineMs) {
+    if (deadlineMs >= m_armedDeadlineMs || m_deadlineRearmPosted.exchange(true)) {
+        return;
     }
+    QMetaObject::invokeMethod(&m_timerContext, [this]() { scheduleNextDeadline(); }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief 将任务 ID 加入对应类型桶，调用方需持有 m_mutex。
+ */
+void TaskManager::indexTaskLocked(const Task& task) {
+    typeBucket(task.type()).push_back(task.id());
+}
+
+/**
+ * @brief 从类型桶移除任务 ID，调用方需持有 m_mutex。
+ */
+void TaskManager::unindexTaskLocked(int taskId, Task::TaskType type) {
+    auto& bucket = typeBucket(type);
+    bucket.erase(std::remove(bucket.begin(), bucket.end(), taskId), bucket.end());
+}
+
+std::vector<int>& TaskManager::typeBucket(Task::TaskType type) {
+    return m_typeIndex[static_cast<std::size_t>(type)];
+}
+
+const std::vector<int>& TaskManager::typeBucket(Task::TaskType type) const {
+    return m_typeIndex[static_cast<std::size_t>(type)];
+}
+
+/**
+ * @brief 将 TaskRecord 还原为领域对象，包含截止时间、奖励等字段。
+ */
+Task TaskManager::hydrateTask(DatabaseManager::TaskRecord&& record) const {
+    // 中文：直接取 deadline_ms 整数列，启动加载全部任务时无需逐条解析 ISO 文本。
+    const QDateTime deadline = record.deadlineMs > 0 ? QDateTime::fromMSecsSinceEpoch(record.deadlineMs).toUTC()
+                                                     : QDateTime::currentDateTimeUtc();
     return Task(record.id,
-                record.name,
-                record.description,
+                std::move(record.name),
+                std::move(record.description),
                 Task::typeFromString(record.type),
                 record.difficulty,
                 deadline,
                 record.completed,
                 record.coinReward,
                 record.growthReward,
-                deserializeAttributes(record.attributeReward),
+                record.attributeReward,
                 record.bonusStreak,
                 record.forgivenessCoupons,
-                record.customSettings,
+                std::move(record.customSettings),
                 record.progressValue,
                 record.progressGoal);
 }
@@ -269,9 +781,12 @@ DatabaseManager::TaskRecord TaskManager::toRecord(const Task& task) const {
     record.completed = task.isCompleted();
     record.coinReward = task.coinReward();
     record.growthReward = task.growthReward();
-    record.attributeReward = serializeAttributes(task.attributeReward());
+    record.attributeReward = task.attributeReward();
     record.bonusStreak = task.bonusStreak();
-    record.customSettings = task.customSettings();
+    // 中文：旧版 key=value 键值串在写回时经 TaskSettings 转为 JSON；已是 JSON 的文本原样写回，进度等字段的更新不会重新序列化设置。
+    const std::string& settingsText = task.customSettings();
+    record.customSettings =
+        settingsText.empty() || settingsText.front() == '{' ? settingsText : task.settings().serialize();
     record.forgivenessCoupons = task.forgivenessCoupons();
     record.progressValue = task.progressValue();
     record.progressGoal = task.progressGoal();
@@ -279,142 +794,145 @@ DatabaseManager::TaskRecord TaskManager::toRecord(const Task& task) const {
 }
 
 /**
- * @brief 将属性奖励压缩为 key=value 串，方便存入 TEXT 字段。
+ * @brief 批量落盘任务副本并把副本移回缓存，返回写回的任务 id；调用方需处于事务中。
  */
-std::string TaskManager::serializeAttributes(const User::AttributeSet& set) const {
-    std::ostringstream stream;
-    stream << "execution=" << set.execution << ';'
-           << "perseverance=" << set.perseverance << ';'
-           << "decision=" << set.decision << ';'
-           << "knowledge=" << set.knowledge << ';'
-           << "social=" << set.social << ';'
-           << "pride=" << set.pride;
-    return stream.str();
+std::vector<int> TaskManager::persistTasks(std::vector<Task> tasks) {
+    std::vector<int> ids;
+    if (tasks.empty()) {
+        return ids;
+    }
+    std::vector<DatabaseManager::TaskRecord> records;
+    records.reserve(tasks.size());
+    ids.reserve(tasks.size());
+    for (const auto& task : tasks) {
+        records.push_back(toRecord(task));
+        ids.push_back(task.id());
+    }
+    m_database.updateTasks(records);
+    std::unique_lock<StateMutex> lock(m_mutex);
+    for (auto& task : tasks) {
+        storeTaskLocked(std::move(task));
+    }
+    return ids;
 }
 
 /**
- * @brief 将 TEXT 字段还原为 AttributeSet，异常时使用 0 兜底，保证健壮性。
+ * @brief 针对给定类型执行重置策略，包含进度归零和连胜校验。
+ * 中文：共享锁内复制并重置该类型的全部任务，再通过 updateTasks 在单个事务内批量写回。
  */
-User::AttributeSet TaskManager::deserializeAttributes(const std::string& blob) const {
-    User::AttributeSet attributes;
-    std::istringstream stream(blob);
-    std::string segment;
-    while (std::getline(stream, segment, ';')) {
-        if (segment.empty()) {
-            continue;
-        }
-        const auto separator = segment.find('=');
-        if (separator == std::string::npos) {
-            continue;
-        }
-        const std::string key = segment.substr(0, separator);
-        const std::string valuePart = segment.substr(separator + 1);
-        int value = 0;
-        try {
-            value = std::stoi(valuePart);
-        } catch (...) {
-            value = 0;
-        }
-        if (key == "execution") {
-            attributes.execution = value;
-        } else if (key == "perseverance") {
-            attributes.perseverance = value;
-        } else if (key == "decision") {
-            attributes.decision = value;
-        } else if (key == "knowledge") {
-            attributes.knowledge = value;
-        } else if (key == "social") {
-            attributes.social = value;
-        } else if (key == "pride") {
-            attributes.pride = value;
+std::vector<int> TaskManager::resetTasksByPredicate(Task::TaskType type, bool breakAllStreaks) {
+    std::vector<Task> updated;
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        updated.reserve(typeBucket(type).size());
+        for (int id : typeBucket(type)) {
+            Task task = m_tasks.at(id);
+            if (breakAllStreaks || !task.isCompleted()) {
+                task.resetBonusStreak();
+            }
+            task.resetProgressForNewCycle();
+            updated.push_back(std::move(task));
         }
     }
-    return attributes;
+    return persistTasks(std::move(updated));
 }
 
 /**
- * @brief 针对给定类型执行重置策略，包含进度归零和连胜校验。
+ * @brief 奖励发放核心：RewardRules 结算 -> UserManager -> 持久化。
+ * 中文：该函数负责“任务完成”数据流：任务 -> rewards::score 计算奖励 -> UserManager 更新成长/属性/成就 -> Database 更新任务状态。
+ *       难度/连胜倍率与类型属性加成由 RewardRules 的常量表给出，每周连胜达到阈值时解锁成就，实现“多系统联动”。
+ *       调用方需处于事务中，任何异常都会回滚，保证成长值、金币与任务状态始终一致；
+ *       task 为缓存副本，落盘成功后才写回缓存，UserManager 的信号在不持有本类锁的情况下发出。
  */
-void TaskManager::resetTasksByPredicate(Task::TaskType type) {
-    for (auto& [id, task] : m_tasks) {
-        if (task.type() != type) {
-            continue;
-        }
-        if (!task.isCompleted()) {
-            task.resetBonusStreak();
-        }
-        task.resetProgressForNewCycle();
-        m_database.updateTask(toRecord(task));
+void TaskManager::applyRewards(Task& task) {
+    const rewards::RewardOutcome reward = rewards::score(rewards::RewardInput::fromTask(task));
+    m_userManager.applyTaskCompletion(reward.growth, reward.coins, reward.attributes, mapToUserCategory(task.type()));
+    if (reward.weeklyStreakMilestone) {
+        m_userManager.unlockAchievement();
+    }
+
+    task.setCompleted(true);
+    task.incrementBonusStreak();
+    task.setProgressValue(task.progressGoal());
+    m_database.updateTask(toRecord(task));
+    m_database.recordTaskOutcome(ownerForWrites(), statsDay(), Task::typeToString(task.type()), 1, 0);
+    int completedOfType = 0;
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        storeTaskLocked(task);
+        completedOfType = ++m_outcomeTotals[static_cast<std::size_t>(task.type())].completed;
+    }
+    if (completedOfType % 10 == 0) {
+        m_userManager.unlockAchievement();
     }
 }
 
 /**
- * @brief 奖励发放核心：难度+连胜加权 -> UserManager -> 持久化。
- * 中文：该函数负责“任务完成”数据流：任务 -> 计算奖励 -> UserManager 更新成长/属性/成就 -> Database 更新任务状态。
- *       期间还会根据类型追加教育意义的属性奖励，并在连胜达到阈值时解锁成就，实现“多系统联动”。
- *       全过程放在事务内，任何异常都会回滚，保证成长值、金币与任务状态始终一致。
+ * @brief 判定已过截止时间的学期任务失败；调用方需处于事务中。
+ * 中文：只从截止队列队首弹出 deadline_ms 早于当前时刻的条目，不再扫描全部学期任务；
+ *       每个任务按同一截止时间只判定一次，修改截止时间后重新入队。判定标记先于失败状态写入
+ *       task_deadline_failures 并缓存在 m_enforcedDeadlines，进程重启后装载缓存时一并读回，不再重复判定。
  */
-void TaskManager::applyRewardsLocked(Task& task) {
-    bool transactionStarted = false;
-    try {
-        transactionStarted = m_database.beginTransaction();
-
-        const double rewardFactor = difficultyFactor(task) * streakFactor(task);
-        const int finalCoins = std::max(0, static_cast<int>(std::round(task.coinReward() * rewardFactor)));
-        const int finalGrowth = std::max(0, static_cast<int>(std::round(task.growthReward() * rewardFactor)));
-        User::AttributeSet finalAttributes = task.attributeReward();
-
-        if (task.type() == Task::TaskType::Daily) {
-            finalAttributes.execution += 1;  // 每日任务强调执行力。
-        } else if (task.type() == Task::TaskType::Weekly) {
-            finalAttributes.social += task.difficultyStars();  // 每周项目强调团队协作。
-        } else if (task.type() == Task::TaskType::Semester) {
-            finalAttributes.knowledge += task.difficultyStars() * 2;
-            finalAttributes.perseverance += task.difficultyStars();
-        }
-
-        m_userManager.applyTaskCompletion(finalGrowth, finalCoins, finalAttributes, mapToUserCategory(task.type()));
-        if (task.type() == Task::TaskType::Weekly && (task.bonusStreak() + 1) % 4 == 0) {
-            m_userManager.unlockAchievement();
-        }
-
-        task.setCompleted(true);
-        task.incrementBonusStreak();
-        task.setProgressValue(task.progressGoal());
-        m_database.updateTask(toRecord(task));
-        m_completionStats[task.type()] += 1;
-        if (m_signalProxy) {
-            emit m_signalProxy->taskCompleted(task.id(), static_cast<int>(task.type()), task.difficultyStars());
+std::vector<int> TaskManager::enforceSemesterDeadlines() {
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    std::vector<Task> expired;
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        for (auto it = m_deadlineQueue.begin(); it != m_deadlineQueue.end() && it->first < nowMs; ++it) {
+            expired.push_back(m_tasks.at(it->second));
+            expired.back().recordFailure(false);
         }
-        if (m_completionStats[task.type()] % 10 == 0) {
-            m_userManager.unlockAchievement();
+    }
+    if (expired.empty()) {
+        return {};
+    }
+    // 中文：判定标记已存在的任务此前已计入失败（如手动判定或另一进程），只出队，不再重复累加统计与快照。
+    std::vector<Task> newlyFailed;
+    for (auto& task : expired) {
+        if (m_database.recordTaskDeadlineFailure(task.id(), deadlineKey(task))) {
+            newlyFailed.push_back(task);
         }
+    }
+    std::vector<int> ids;
+    if (!newlyFailed.empty()) {
+        m_database.recordTaskOutcome(ownerForWrites(), statsDay(), Task::typeToString(Task::TaskType::Semester), 0,
+                                     static_cast<int>(newlyFailed.size()));
+        ids = persistTasks(newlyFailed);
+    }
+    std::unique_lock<StateMutex> lock(m_mutex);
+    m_outcomeTotals[static_cast<std::size_t>(Task::TaskType::Semester)].failed += static_cast<int>(newlyFailed.size());
+    for (const auto& task : expired) {
+        m_enforcedDeadlines[task.id()] = deadlineKey(task);
+        dequeueDeadlineLocked(task);
+    }
+    return ids;
+}
 
-        m_database.commitTransaction();
-    } catch (...) {
-        if (transactionStarted) {
-            try {
-                m_database.rollbackTransaction();
-            } catch (...) {
-            }
-        }
-        throw;
+/**
+ * @brief 经 runAfterCommit 在最外层事务提交、锁全部释放后发出完成信号，成就与日志的槽函数可以安全地回调 TaskManager；
+ *        本次调用并入 UnitOfWork 等外层事务时同样等到外层提交，回滚则不发出。
+ */
+void TaskManager::emitTaskCompleted(const Task& task) const {
+    if (m_signalProxy) {
+        m_database.runAfterCommit([proxy = m_signalProxy.get(), id = task.id(), type = static_cast<int>(task.type()),
+                                   stars = task.difficultyStars()]() { emit proxy->taskCompleted(id, type, stars); });
     }
 }
 
 /**
- * @brief 检查学期任务的截止时间，过期则按失败处理。
+ * @brief 同样在提交后发出；空集合不发信号，重置时没有任务的类型不会惊动订阅者。
  */
-void TaskManager::enforceSemesterDeadlinesLocked() {
-    const QDateTime now = QDateTime::currentDateTimeUtc();
-    for (auto& [id, task] : m_tasks) {
-        if (task.type() != Task::TaskType::Semester || task.isCompleted()) {
-            continue;
-        }
-        if (task.isExpired(now)) {
-            task.recordFailure(false);
-            m_database.updateTask(toRecord(task));
-        }
+void TaskManager::emitTasksChanged(const std::vector<int>& taskIds) const {
+    if (m_signalProxy && !taskIds.empty()) {
+        m_database.runAfterCommit([proxy = m_signalProxy.get(), ids = QVector<int>(taskIds.begin(), taskIds.end())]() {
+            emit proxy->tasksChanged(ids);
+        });
+    }
+}
+
+void TaskManager::emitTasksReloaded() const {
+    if (m_signalProxy) {
+        m_database.runAfterCommit([proxy = m_signalProxy.get()]() { emit proxy->tasksReloaded(); });
     }
 }
 
@@ -436,25 +954,15 @@ User::TaskCategory TaskManager::mapToUserCategory(Task::TaskType type) const {
 }
 
 /**
- * @brief 难度-奖励平衡公式：1+(星级-1)*0.15，并对长周期任务附加加成。
- * 中文：学期任务投入时间长，因此额外 +0.35；每周任务强调团队协作，+0.1。这样既满足“难度越大奖励越多”的教学要求，
- *       又避免奖励增长过快导致失衡。
+ * @brief task_stats 的日期键：本地日期 yyyy-MM-dd。
  */
-double TaskManager::difficultyFactor(const Task& task) const {
-    double factor = 1.0 + (static_cast<double>(task.difficultyStars()) - 1.0) * 0.15;
-    if (task.type() == Task::TaskType::Semester) {
-        factor += 0.35;
-    } else if (task.type() == Task::TaskType::Weekly) {
-        factor += 0.1;
-    }
-    return factor;
-}
+std::string TaskManager::statsDay() { return QDate::currentDate().toString(Qt::ISODate).toStdString(); }
 
 /**
- * @brief 连续完成奖励公式：每次连胜额外 +5% 奖励，鼓励学生保持学习节奏。
+ * @brief app_state 中按用户区分的水位键：基础键加 ":" 与 users.id。
  */
-double TaskManager::streakFactor(const Task& task) const {
-    return 1.0 + static_cast<double>(task.bonusStreak()) * 0.05;
+std::string TaskManager::watermarkKey(const char* key, int ownerId) {
+    return std::string(key) + ":" + std::to_string(ownerId);
 }
 
 }  // namespace rove::data
@@ -1,21 +1,40 @@
 #ifndef TASKMANAGER_H
 #define TASKMANAGER_H
 
+#include <QDate>
 #include <QObject>
 #include <QTimer>
+#include <QVector>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
 #include <memory>
-#include <mutex>
 #include <optional>
+#include <set>
+#include <shared_mutex>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "DatabaseManager.h"
+#include "MemoryAccounting.h"
+#include "Metrics.h"
 #include "Task.h"
 #include "UserManager.h"
 
 namespace rove::data {
 
+enum class JournalCommand : std::uint8_t;
+
+/**
+ * @brief TaskManager 的信号代理。
+ * 中文：taskProgressed 逐次发出，成就条件依赖每一次变化；界面把它直连到 ChangeBus，按 id 合并后每周期刷新一次。
+ *       tasksChanged 覆盖创建、编辑、删除、失败判定与周期重置，tasksReloaded 表示整份缓存被替换，
+ *       两者都在事务提交后发出，界面模型据此按 id 增量回读。
+ */
 class TaskManagerSignalProxy : public QObject {
     Q_OBJECT
 
@@ -25,10 +44,34 @@ public:
 signals:
     void taskCompleted(int taskId, int taskType, int difficultyStars);
     void taskProgressed(int taskId, int currentValue, int goalValue);
+    /**
+     * @brief 这些任务的字段已变化；taskById 查不到的 id 表示任务已删除。
+     */
+    void tasksChanged(const QVector<int>& taskIds);
+    /**
+     * @brief 缓存整体替换（刷新或切换用户），订阅者应重新遍历全部任务。
+     */
+    void tasksReloaded();
 };
 
+/**
+ * @class TaskManager
+ * @brief 任务缓存与结算。
+ * 中文：锁模型——m_mutex 为读写锁，只保护内存缓存：读接口取共享锁，互不阻塞，也不会等待数据库 I/O；
+ *       写接口在 DatabaseManager::runInTransaction 内完成“读取副本 → 落盘 → 独占锁内更新缓存”，
+ *       并发写者由事务的写连接锁串行化，全局锁顺序为 DatabaseManager → TaskManager，持锁期间从不访问数据库。
+ *       全部信号经 DatabaseManager::runAfterCommit 在最外层事务提交、锁全部释放后发出，槽函数可以自由回调本类；
+ *       事务内先于提交改写的缓存登记了回滚回调，外层事务回滚时从数据库重新装载。
+ *       缓存只装载当前登录用户的任务；切换用户时当前缓存暂存进 m_parkedCaches（按最近使用排序，
+ *       最多保留 kMaxParkedOwners 份），切回时直接恢复，超出容量的最久未用者被丢弃，再切回时从数据库重读。
+ */
 class TaskManager final {
 public:
+    /**
+     * @brief 只读遍历回调；在 TaskManager 共享锁内执行，回调中不得再调用 TaskManager。
+     */
+    using TaskVisitor = std::function<void(const Task&)>;
+
     static TaskManager& instance(DatabaseManager& database, UserManager& userManager);
 
     TaskManager(const TaskManager&) = delete;
@@ -41,40 +84,132 @@ public:
     void deleteTask(int taskId);
     [[nodiscard]] std::optional<Task> taskById(int taskId) const;
     [[nodiscard]] std::vector<Task> tasksByType(Task::TaskType type) const;
+    /**
+     * @brief 按类型索引遍历任务，不复制 Task 对象。
+     */
+    void forEachTask(Task::TaskType type, const TaskVisitor& visitor) const;
+    /**
+     * @brief 按 Daily/Weekly/Semester/Custom 顺序遍历全部任务。
+     */
+    void forEachTask(const TaskVisitor& visitor) const;
     void markTaskCompleted(int taskId);
     void failTask(int taskId, bool useForgiveness);
     void updateTaskProgress(int taskId, int delta);
+    /**
+     * @brief 重新装载当前登录用户的任务与累计统计。
+     */
     void refreshFromDatabase();
+    /**
+     * @brief 累计完成与失败次数，由 task_stats 表在刷新时装载，结算时随事务递增。
+     */
+    struct TaskTotals {
+        int completed = 0;
+        int failed = 0;
+    };
+
+    /**
+     * @brief 各类任务的累计完成次数（跨会话持久化），不扫描任务或日志。
+     */
     [[nodiscard]] std::unordered_map<Task::TaskType, int> taskStatistics() const;
+    /**
+     * @brief 全部类型合计的累计完成/失败次数，供成长快照计数使用。
+     */
+    [[nodiscard]] TaskTotals taskTotals() const;
+    /**
+     * @brief 逐日逐类的完成/失败次数，直接读取 task_stats，供看板按日期范围展示。
+     */
+    [[nodiscard]] std::vector<DatabaseManager::TaskStatRecord> dailyStatistics(const QDate& from,
+                                                                               const QDate& to) const;
     void resetDailyTasks();
-    void resetWeeklyTasks();
+    /**
+     * @brief 周一执行周任务重置；today 默认取系统日期，负载生成工具传入模拟日期。
+     */
+    void resetWeeklyTasks(const QDate& today = QDate::currentDate());
+    /**
+     * @brief 按持久化水位补做自上次处理以来错过的每日/每周重置，可重复调用；启动装载后与零点定时器调用。
+     */
+    void catchUpResets(const QDate& today = QDate::currentDate());
     [[nodiscard]] TaskManagerSignalProxy* signalProxy() const noexcept;
+    /**
+     * @brief 估算当前任务缓存、暂存的其他用户缓存与截止队列的内存，登记为 MemoryRegistry 的 "tasks"。
+     */
+    [[nodiscard]] metrics::MemoryUsage memoryUsage() const;
+    /**
+     * @brief 超出内存限额时丢弃暂存的其他用户缓存；当前用户的缓存保留，切回被丢弃的用户时重新读库。
+     */
+    void trimMemory();
 
 private:
     TaskManager(DatabaseManager& database, UserManager& userManager);
 
+    static constexpr std::size_t kTaskTypeCount = 4;
+    static constexpr std::size_t kMaxParkedOwners = 3;
+    using StateMutex = metrics::ProfiledMutex<std::shared_mutex>;
+
+    /**
+     * @brief 完整的任务缓存；刷新时在锁外构建，再在独占锁内整体交换。
+     */
+    struct TaskCache {
+        int ownerId = 0;  //!< 所属用户 users.id
+        std::unordered_map<int, Task> tasks;
+        std::array<std::vector<int>, kTaskTypeCount> typeIndex;
+        std::array<TaskTotals, kTaskTypeCount> outcomeTotals;
+        std::set<std::pair<qint64, int>> deadlineQueue;
+        std::unordered_map<int, qint64> enforcedDeadlines;  //!< 读自 task_deadline_failures 的判定标记
+    };
+
     void configureTimers();
-    void hydrateTasksFromRecords(const std::vector<DatabaseManager::TaskRecord>& records);
-    Task hydrateTask(const DatabaseManager::TaskRecord& record) const;
+    void onSessionChanged(int userId);
+    void onUserDeleted(int userId);
+    void installCacheLocked(TaskCache&& cache);
+    [[nodiscard]] int ownerForWrites() const;
+    void journalCommand(JournalCommand command, int taskId, std::int64_t arg) const;
+    void scheduleNextBoundary();
+    void scheduleNextDeadline();
+    void hydrateIntoCache(TaskCache& cache, DatabaseManager::TaskRecord&& record) const;
+    Task hydrateTask(DatabaseManager::TaskRecord&& record) const;
     DatabaseManager::TaskRecord toRecord(const Task& task) const;
-    std::string serializeAttributes(const User::AttributeSet& set) const;
-    User::AttributeSet deserializeAttributes(const std::string& blob) const;
-    void resetTasksByPredicate(Task::TaskType type);
-    void applyRewardsLocked(Task& task);
-    void enforceSemesterDeadlinesLocked();
+    void storeTaskLocked(Task task);
+    void reloadCacheOnRollback();
+    void indexTaskLocked(const Task& task);
+    void unindexTaskLocked(int taskId, Task::TaskType type);
+    [[nodiscard]] bool awaitsDeadlineLocked(const Task& task) const;
+    void queueDeadlineLocked(const Task& task);
+    void dequeueDeadlineLocked(const Task& task);
+    void requestDeadlineRearmLocked(qint64 deadlineMs);
+    [[nodiscard]] std::vector<int>& typeBucket(Task::TaskType type);
+    [[nodiscard]] const std::vector<int>& typeBucket(Task::TaskType type) const;
+    std::vector<int> persistTasks(std::vector<Task> tasks);
+    std::vector<int> resetTasksByPredicate(Task::TaskType type, bool breakAllStreaks);
+    void applyRewards(Task& task);
+    std::vector<int> enforceSemesterDeadlines();
+    void emitTaskCompleted(const Task& task) const;
+    void emitTasksChanged(const std::vector<int>& taskIds) const;
+    void emitTasksReloaded() const;
     User::TaskCategory mapToUserCategory(Task::TaskType type) const;
-    double difficultyFactor(const Task& task) const;
-    double streakFactor(const Task& task) const;
+    static std::string statsDay();
+    static std::string watermarkKey(const char* key, int ownerId);
 
     DatabaseManager& m_database;
     UserManager& m_userManager;
     std::unordered_map<int, Task> m_tasks;
-    std::unordered_map<Task::TaskType, int> m_completionStats;
-    std::unique_ptr<QTimer> m_dailyTimer;
-    std::unique_ptr<QTimer> m_weeklyTimer;
+    std::array<std::vector<int>, kTaskTypeCount> m_typeIndex;  //!< 按 TaskType 分桶的任务 ID，随增删改同步维护
+    std::array<TaskTotals, kTaskTypeCount> m_outcomeTotals;  //!< 按 TaskType 下标的累计完成/失败次数，与 task_stats 一致
+    std::uint64_t m_generation;  //!< 缓存每次写入递增，刷新据此判断读库期间是否有写者提交。
+    int m_ownerId;    //!< 当前缓存所属用户，受 m_mutex 保护；0 表示没有装载任何用户
+    bool m_hydrated;  //!< 首次装载完成前忽略会话切换，启动装载本身会读取当前会话，受 m_mutex 保护
+    std::list<TaskCache> m_parkedCaches;  //!< 切换用户时暂存的缓存，最近使用者在前，受 m_mutex 保护
+    std::atomic<qint64> m_processedDay;  //!< 本进程已确认处理过的日期（儒略日），同日重复检查不再访问数据库。
+    std::set<std::pair<qint64, int>> m_deadlineQueue;  //!< 待判定的学期任务 (deadline_ms, 任务 ID)，最早到期者在前
+    std::unordered_map<int, qint64> m_enforcedDeadlines;  //!< 已按该截止时间判定失败的任务（task_deadline_failures 的缓存），截止时间不变就不再入队
+    qint64 m_armedDeadlineMs;  //!< 截止定时器当前瞄准的时刻，受 m_mutex 保护；无待判定任务时为 qint64 上限
+    std::atomic<bool> m_deadlineRearmPosted;
+    std::unique_ptr<QTimer> m_boundaryTimer;
+    std::unique_ptr<QTimer> m_deadlineTimer;
     QObject m_timerContext;
     std::unique_ptr<TaskManagerSignalProxy> m_signalProxy;
-    mutable std::mutex m_mutex;
+    mutable StateMutex m_mutex;
+    metrics::MemoryRegistration m_memoryRegistration;
 };
 
 }  // namespace rove::data
@@ -0,0 +1,204 @@
+#include "TaskSettings.h"
+
+#include "MemoryAccounting.h"
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+
+#include <charconv>
+
+namespace rove::data {
+namespace {
+
+std::string_view trimmed(std::string_view text) {
+    const auto first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+/**
+ * @brief 键值串中的值按 true/false、整数、浮点的顺序识别，其余保留为文本。
+ */
+TaskSettings::Value typedValue(std::string_view raw) {
+    if (raw == "true" || raw == "false") {
+        return raw == "true";
+    }
+    qint64 integer = 0;
+    const char* end = raw.data() + raw.size();
+    if (auto [ptr, ec] = std::from_chars(raw.data(), end, integer); !raw.empty() && ec == std::errc() && ptr == end) {
+        return integer;
+    }
+    bool isNumber = false;
+    const double number = QString::fromUtf8(raw.data(), static_cast<int>(raw.size())).toDouble(&isNumber);
+    if (isNumber) {
+        return number;
+    }
+    return std::string(raw);
+}
+
+/**
+ * @brief JSON 整数经 toInteger 原样取出，超过 2^53 的 qint64 不经 double 中转；嵌套数组与对象保持为 QJsonValue。
+ */
+TaskSettings::Value fromJson(const QJsonValue& value) {
+    if (value.isBool()) {
+        return value.toBool();
+    }
+    if (value.isDouble()) {
+        // 中文：非整数时 toInteger 返回给定的默认值，两次默认值不同即可区分。
+        const qint64 integer = value.toInteger(0);
+        if (integer == value.toInteger(1)) {
+            return integer;
+        }
+        return value.toDouble();
+    }
+    if (value.isString()) {
+        return value.toString().toStdString();
+    }
+    return value;
+}
+
+std::size_t nestedBytes(const QJsonValue& value) {
+    const QJsonDocument document = value.isArray() ? QJsonDocument(value.toArray()) : QJsonDocument(value.toObject());
+    return static_cast<std::size_t>(document.toJson(QJsonDocument::Compact).size());
+}
+
+}  // namespace
+
+TaskSettings TaskSettings::parse(std::string_view text) {
+    TaskSettings settings;
+    text = trimmed(text);
+    if (text.empty()) {
+        return settings;
+    }
+    if (text.front() == '{') {
+        const QJsonDocument document =
+            QJsonDocument::fromJson(QByteArray(text.data(), static_cast<int>(text.size())));
+        const QJsonObject object = document.object();
+        for (auto it = object.begin(); it != object.end(); ++it) {
+            if (!it.value().isNull() && !it.value().isUndefined()) {
+                settings.m_values.emplace(it.key().toStdString(), fromJson(it.value()));
+            }
+        }
+        return settings;
+    }
+    while (!text.empty()) {
+        const std::size_t end = text.find(';');
+        const std::string_view entry = text.substr(0, end);
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+        const std::size_t equals = entry.find('=');
+        if (equals == std::string_view::npos) {
+            continue;
+        }
+        const std::string_view key = trimmed(entry.substr(0, equals));
+        if (!key.empty()) {
+            settings.m_values.insert_or_assign(std::string(key), typedValue(trimmed(entry.substr(equals + 1))));
+        }
+    }
+    return settings;
+}
+
+std::string TaskSettings::serialize() const {
+    QJsonObject object;
+    for (const auto& [key, value] : m_values) {
+        const QString name = QString::fromStdString(key);
+        std::visit(
+            [&](const auto& held) {
+                using Held = std::decay_t<decltype(held)>;
+                if constexpr (std::is_same_v<Held, std::string>) {
+                    object.insert(name, QString::fromStdString(held));
+                } else if constexpr (std::is_same_v<Held, qint64>) {
+                    object.insert(name, QJsonValue(held));
+                } else {
+                    object.insert(name, held);
+                }
+            },
+            value);
+    }
+    return QJsonDocument(object).toJson(QJsonDocument::Compact).toStdString();
+}
+
+const TaskSettings::Value* TaskSettings::find(std::string_view key) const {
+    const auto it = m_values.find(key);
+    return it != m_values.end() ? &it->second : nullptr;
+}
+
+std::optional<qint64> TaskSettings::integer(std::string_view key) const {
+    const Value* value = find(key);
+    if (value == nullptr) {
+        return std::nullopt;
+    }
+    if (const auto* integer = std::get_if<qint64>(value)) {
+        return *integer;
+    }
+    if (const auto* number = std::get_if<double>(value)) {
+        return static_cast<qint64>(*number);
+    }
+    return std::nullopt;
+}
+
+std::optional<bool> TaskSettings::flag(std::string_view key) const {
+    const Value* value = find(key);
+    if (value == nullptr) {
+        return std::nullopt;
+    }
+    if (const auto* flag = std::get_if<bool>(value)) {
+        return *flag;
+    }
+    if (const auto* integer = std::get_if<qint64>(value)) {
+        return *integer != 0;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> TaskSettings::text(std::string_view key) const {
+    const Value* value = find(key);
+    if (value == nullptr) {
+        return std::nullopt;
+    }
+    if (const auto* text = std::get_if<std::string>(value)) {
+        return *text;
+    }
+    return std::nullopt;
+}
+
+std::optional<QJsonValue> TaskSettings::nested(std::string_view key) const {
+    const Value* value = find(key);
+    if (value == nullptr) {
+        return std::nullopt;
+    }
+    if (const auto* nested = std::get_if<QJsonValue>(value)) {
+        return *nested;
+    }
+    return std::nullopt;
+}
+
+std::size_t TaskSettings::heapBytes() const {
+    std::size_t bytes = metrics::nodeContainerBytes(m_values.size(), sizeof(std::pair<const std::string, Value>));
+    for (const auto& [key, value] : m_values) {
+        bytes += metrics::heapBytes(key);
+        if (const auto* text = std::get_if<std::string>(&value)) {
+            bytes += metrics::heapBytes(*text);
+        } else if (const auto* nested = std::get_if<QJsonValue>(&value)) {
+            bytes += nestedBytes(*nested);
+        }
+    }
+    return bytes;
+}
+
+void TaskSettings::set(std::string key, Value value) { m_values.insert_or_assign(std::move(key), std::move(value)); }
+
+bool TaskSettings::remove(std::string_view key) {
+    const auto it = m_values.find(key);
+    if (it == m_values.end()) {
+        return false;
+    }
+    m_values.erase(it);
+    return true;
+}
+
+}  // namespace rove::data
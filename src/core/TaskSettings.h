@@ -0,0 +1,58 @@
+#ifndef TASKSETTINGS_H
+#define TASKSETTINGS_H
+
+#include <QJsonValue>
+#include <QtGlobal>
+
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+
+namespace rove::data {
+
+/**
+ * @class TaskSettings
+ * @brief 任务自定义设置的解析结果：键 -> 值 表，值为布尔、整数、浮点、文本或嵌套的 JSON 数组/对象。
+ * 中文：custom_settings 列中既有 JSON 对象也有 "key=value;key=value" 键值串，两种都能解析；
+ *       序列化统一输出紧凑 JSON。嵌套的对象与数组保持为 QJsonValue，整数按 qint64 原样保存，往返不丢精度。
+ */
+class TaskSettings final {
+public:
+    using Value = std::variant<bool, qint64, double, std::string, QJsonValue>;
+
+    /**
+     * @brief 宽松解析：空文本或无法识别的内容得到空设置，不抛异常。
+     */
+    [[nodiscard]] static TaskSettings parse(std::string_view text);
+    [[nodiscard]] std::string serialize() const;
+
+    [[nodiscard]] bool empty() const noexcept { return m_values.empty(); }
+    [[nodiscard]] const Value* find(std::string_view key) const;
+    [[nodiscard]] std::optional<qint64> integer(std::string_view key) const;
+    [[nodiscard]] std::optional<bool> flag(std::string_view key) const;
+    [[nodiscard]] std::optional<std::string> text(std::string_view key) const;
+    /**
+     * @brief 嵌套的 JSON 数组或对象；键不存在或值为标量时返回空。
+     */
+    [[nodiscard]] std::optional<QJsonValue> nested(std::string_view key) const;
+    /**
+     * @brief 键与文本值占用的堆内存估算，供任务缓存的内存统计使用；嵌套值按其紧凑 JSON 长度估算。
+     */
+    [[nodiscard]] std::size_t heapBytes() const;
+
+    void set(std::string key, Value value);
+    bool remove(std::string_view key);
+
+    bool operator==(const TaskSettings& other) const { return m_values == other.m_values; }
+    bool operator!=(const TaskSettings& other) const { return !(*this == other); }
+
+private:
+    std::map<std::string, Value, std::less<>> m_values;
+};
+
+}  // namespace rove::data
+
+#endif  // TASKSETTINGS_H
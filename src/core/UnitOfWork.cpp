@@ -0,0 +1,57 @@
+#include "UnitOfWork.h"
+
+#include <QDebug>
+
+#include <utility>
+
+#include "Metrics.h"
+
+namespace rove::data {
+
+UnitOfWork::UnitOfWork(DatabaseManager& database, std::string action)
+    : m_database(database), m_action(std::move(action)) {}
+
+/**
+ * @brief 取操作前后本线程写入计数的差值；计数只由本线程的提交累加，其他线程的并发写入不会混入。
+ * 中文：work 开始时先登记一个提交后回调，它排在所有提交后回调之前执行，记下的计数把本事务的提交
+ *       与订阅者随后引发的提交分开。本事务提交多于一次时打印警告，说明有写入绕开了工作单元。
+ */
+UnitOfWork::Report UnitOfWork::run(const std::function<void()>& work) {
+    const auto before = DatabaseManager::threadWriteCounters();
+    auto committed = before;
+    const bool outermost = !m_database.inTransaction();
+    const auto start = metrics::Clock::now();
+    m_database.runInTransaction([&]() {
+        if (outermost) {
+            m_database.runAfterCommit([&committed]() { committed = DatabaseManager::threadWriteCounters(); });
+        }
+        work();
+    });
+    if (!outermost) {
+        committed = DatabaseManager::threadWriteCounters();  // 中文：并入外层事务，本次没有提交。
+    }
+
+    const auto after = DatabaseManager::threadWriteCounters();
+    Report report;
+    report.action = m_action;
+    report.commits = committed.commits - before.commits;
+    report.followUpCommits = after.commits - committed.commits;
+    report.rowsWritten = after.rowsWritten - before.rowsWritten;
+    report.elapsedNs = metrics::ScopedTimer::elapsedNanoseconds(start);
+
+    if (metrics::isEnabled()) {
+        auto& registry = metrics::Registry::instance();
+        registry.counter(metrics::Subsystem::Database, "unitOfWork.actions", m_action).add(1);
+        registry.counter(metrics::Subsystem::Database, "unitOfWork.commits", m_action).add(report.commits);
+        registry.counter(metrics::Subsystem::Database, "unitOfWork.followUpCommits", m_action)
+            .add(report.followUpCommits);
+        registry.counter(metrics::Subsystem::Database, "unitOfWork.rows", m_action).add(report.rowsWritten);
+        registry.histogram(metrics::Subsystem::Database, "unitOfWork.elapsed", m_action).record(report.elapsedNs);
+    }
+    if (report.commits > 1) {
+        qWarning() << "UnitOfWork:" << QString::fromStdString(m_action) << "产生了" << report.commits << "次提交";
+    }
+    return report;
+}
+
+}  // namespace rove::data
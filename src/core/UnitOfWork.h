@@ -0,0 +1,51 @@
+#ifndef UNITOFWORK_H
+#define UNITOFWORK_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "DatabaseManager.h"
+
+namespace rove::data {
+
+/**
+ * @class UnitOfWork
+ * @brief 一次用户操作（完成任务、购买商品等）的工作单元：操作内所有管理器的写入并入同一个事务，只提交一次。
+ * 中文：以“完成任务”为例，TaskManager 结算奖励、UserManager 保存用户，原先各自开启事务、各自 fsync。
+ *       工作单元在调用线程上开启最外层事务，各管理器的 runInTransaction 随之并入。管理器的全部信号
+ *       （taskCompleted、levelChanged、achievementUnlocked、logInserted 等）都经 DatabaseManager::runAfterCommit
+ *       推迟到提交之后，订阅者（成就推进、自动日志）在提交后各自开启事务；回滚时信号被丢弃，
+ *       管理器经 runOnRollback 登记的回调撤销已写入缓存的改动。
+ *       run() 分别报告本操作事务的提交次数与提交后回调引发的后续提交次数，同时计入埋点（带操作名标签）。
+ *       已处于事务中时嵌套调用直接并入外层，报告中的提交次数为 0。
+ */
+class UnitOfWork {
+public:
+    /**
+     * @brief 一次操作的写入统计。
+     */
+    struct Report {
+        std::string action;
+        std::uint64_t commits = 0;          //!< 本操作事务的提交次数，正常为 1
+        std::uint64_t followUpCommits = 0;  //!< 提交后回调（信号订阅者）引发的提交次数
+        std::uint64_t rowsWritten = 0;      //!< 操作期间本线程增删改的行数（含后续提交）
+        std::uint64_t elapsedNs = 0;
+    };
+
+    UnitOfWork(DatabaseManager& database, std::string action);
+
+    /**
+     * @brief 在一个事务中执行 work，提交后执行登记的提交后回调，返回写入统计。
+     * @throws 透传 work 或提交的异常；此时事务已回滚，不产生报告。
+     */
+    Report run(const std::function<void()>& work);
+
+private:
+    DatabaseManager& m_database;
+    std::string m_action;
+};
+
+}  // namespace rove::data
+
+#endif  // UNITOFWORK_H
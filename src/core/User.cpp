@@ -1,10 +1,11 @@
 #include "User.h"
 
 #include <algorithm>
-#include <cmath>
 #include <sstream>
 #include <stdexcept>
 
+#include "LevelCurve.h"
+
 namespace rove::data {
 namespace {
 constexpr int kAttributeMin = 0;
@@ -176,18 +177,11 @@ std::string User::buildAttributeSummary() const {
 }
 
 /**
- * @brief Implement level curve = 1 + sqrt(growth/100).
- * 中文：实现等级曲线公式：Level = 1 + sqrt(成长值 / 100)。
+ * @brief Level curve = 1 + sqrt(growth/100), looked up in the shared threshold table.
+ * 中文：等级曲线公式：Level = 1 + sqrt(成长值 / 100)，阈值取自与 GrowthSystem 共用的 LevelCurve 常量表。
  * 平衡说明：平方根带来前期升级快、后期渐缓的体验，符合校园成长节奏。
  */
-int User::computeLevelFromGrowth(int growthPoints) noexcept {
-    if (growthPoints <= 0) {
-        return 1;
-    }
-    const double normalized = static_cast<double>(growthPoints) / 100.0;
-    const int computed = 1 + static_cast<int>(std::sqrt(normalized));
-    return std::max(1, computed);
-}
+int User::computeLevelFromGrowth(int growthPoints) noexcept { return levels::levelForPoints(growthPoints); }
 
 void User::recalculateLevel() { m_level = computeLevelFromGrowth(m_growthPoints); }
 
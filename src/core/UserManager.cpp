@@ -1,5 +1,10 @@
 #include "UserManager.h"
 
+#include "RecordCodec.h"
+
+#include <QDateTime>
+
+#include <algorithm>
 #include <sstream>
 #include <stdexcept>
 
@@ -7,12 +12,6 @@ namespace rove::data {
 namespace {
 // Key names reused during serialization to keep schema human-readable.
 constexpr const char* kGrowthKey = "growth";
-constexpr const char* kExecutionKey = "execution";
-constexpr const char* kPerseveranceKey = "perseverance";
-constexpr const char* kDecisionKey = "decision";
-constexpr const char* kKnowledgeKey = "knowledge";
-constexpr const char* kSocialKey = "social";
-constexpr const char* kPrideKey = "pride";
 constexpr const char* kAchievementsKey = "achievements";
 constexpr const char* kTasksTotalKey = "tasks_total";
 constexpr const char* kTasksAcademicKey = "tasks_academic";
@@ -21,13 +20,21 @@ constexpr const char* kTasksPersonalKey = "tasks_personal";
 constexpr const char* kAttributeSpentKey = "attribute_spent";
 }  // namespace
 
+ProgressionState ProgressionState::of(const User& user) noexcept {
+    return ProgressionState{user.level(), user.growthPoints(), user.coins(), user.attributes()};
+}
+
 /**
  * @brief Constructor simply stores DatabaseManager reference.
  * 中文：构造函数仅保存 DatabaseManager 引用，实现依赖注入。
  * 说明：Manager 本身不拥有数据库，遵循 RAII，避免重复关闭句柄。
  */
 UserManager::UserManager(DatabaseManager& database)
-    : m_database(database), m_activeUser(), m_signalProxy(std::make_unique<UserManagerSignalProxy>()) {}
+    : m_database(database),
+      m_mutex("UserManager"),
+      m_activeUser(),
+      m_persistedRecord(),
+      m_signalProxy(std::make_unique<UserManagerSignalProxy>()) {}
 
 /**
  * @brief Validate credentials and populate in-memory session.
@@ -42,7 +49,18 @@ bool UserManager::login(const std::string& username, const std::string& password
     if (record->password != password) {
         return false;  // 中文：密码不匹配。
     }
-    m_activeUser = hydrateUser(*record);
+    User user = hydrateUser(*record);
+    const int userId = record->id;
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        m_userIds[record->username] = userId;
+        m_publishedProgression = ProgressionState::of(user);
+        m_activeUser = std::move(user);
+        m_persistedRecord = std::move(*record);
+    }
+    if (m_signalProxy) {
+        emit m_signalProxy->sessionChanged(userId);
+    }
     return true;
 }
 
@@ -50,26 +68,65 @@ bool UserManager::login(const std::string& username, const std::string& password
  * @brief Clear optional session to free memory and展示退出操作。
  * 中文：清空可选对象，释放内存并展示退出操作。
  */
-void UserManager::logout() noexcept { m_activeUser.reset(); }
+void UserManager::logout() noexcept {
+    bool hadSession = false;
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        hadSession = m_activeUser.has_value();
+        m_activeUser.reset();
+        m_persistedRecord.reset();
+        m_publishedProgression.reset();
+    }
+    if (hadSession && m_signalProxy) {
+        emit m_signalProxy->sessionChanged(0);
+    }
+}
 
 /**
  * @brief Check session existence for UI enabling/disabling.
  * 中文：检查会话是否存在，供界面启用/禁用按钮使用。
  */
-bool UserManager::hasActiveUser() const noexcept { return m_activeUser.has_value(); }
+bool UserManager::hasActiveUser() const noexcept {
+    std::shared_lock<StateMutex> lock(m_mutex);
+    return m_activeUser.has_value();
+}
 
-const User& UserManager::activeUser() const {
+User UserManager::activeUser() const {
+    std::shared_lock<StateMutex> lock(m_mutex);
     if (!m_activeUser.has_value()) {
         throw std::runtime_error("No active user session");
     }
     return *m_activeUser;
 }
 
-User& UserManager::activeUser() {
+int UserManager::activeUserId() const {
+    std::shared_lock<StateMutex> lock(m_mutex);
     if (!m_activeUser.has_value()) {
         throw std::runtime_error("No active user session");
     }
-    return *m_activeUser;
+    return m_activeUser->id();
+}
+
+bool UserManager::updateActiveUser(const std::function<bool(User&)>& mutate) {
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        if (!m_activeUser.has_value()) {
+            throw std::runtime_error("No active user session");
+        }
+        if (!mutate(*m_activeUser)) {
+            return false;
+        }
+    }
+    persistActiveUser();
+    return true;
+}
+
+void UserManager::mutateActiveUser(const std::function<void(User&)>& mutate) {
+    std::unique_lock<StateMutex> lock(m_mutex);
+    if (!m_activeUser.has_value()) {
+        throw std::runtime_error("No active user session");
+    }
+    mutate(*m_activeUser);
 }
 
 /**
@@ -77,10 +134,10 @@ User& UserManager::activeUser() {
  * 中文：会话存在时调用事务保存，统一错误信息。
  */
 void UserManager::saveActiveUser() {
-    if (!m_activeUser.has_value()) {
+    if (!hasActiveUser()) {
         throw std::runtime_error("Cannot save without active user");
     }
-    persistUser(*m_activeUser);
+    persistActiveUser();
 }
 
 /**
@@ -92,29 +149,70 @@ void UserManager::applyTaskCompletion(int growthGain,
                                       int coinGain,
                                       const User::AttributeSet& attributeBonus,
                                       User::TaskCategory category) {
-    User& user = activeUser();
-    const int previousLevel = user.level();
-    const int previousCoins = user.coins();
-    const int previousPride = user.attributes().pride;
-    if (growthGain > 0) {
-        user.addGrowthPoints(growthGain);
-    }
-    if (coinGain > 0) {
-        user.addCoins(coinGain);
-    }
-    user.applyAttributeBonus(attributeBonus);
-    user.recordTaskCompletion(category);
-    persistUser(user);
-    if (m_signalProxy) {
-        if (user.level() != previousLevel) {
-            emit m_signalProxy->levelChanged(user.level());
+    applyProgressionDelta(growthGain, coinGain, attributeBonus, category);
+}
+
+void UserManager::applyRewards(int growthGain, int coinGain, const User::AttributeSet& attributeBonus) {
+    applyProgressionDelta(growthGain, coinGain, attributeBonus, std::nullopt);
+}
+
+/**
+ * @brief applyTaskCompletion 与 applyRewards 的共同实现；category 为空时不计入任务统计。
+ * 中文：完成次数与成长值增量同时累加到当日的 daily_activity 行，供日历热力图按年读取。
+ */
+void UserManager::applyProgressionDelta(int growthGain,
+                                        int coinGain,
+                                        const User::AttributeSet& attributeBonus,
+                                        std::optional<User::TaskCategory> category) {
+    int userId = 0;
+    int previousLevel = 0;
+    int previousCoins = 0;
+    int previousPride = 0;
+    int level = 0;
+    int coins = 0;
+    int pride = 0;
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        if (!m_activeUser.has_value()) {
+            throw std::runtime_error("No active user session");
+        }
+        User& user = *m_activeUser;
+        previousLevel = user.level();
+        previousCoins = user.coins();
+        previousPride = user.attributes().pride;
+        if (growthGain > 0) {
+            user.addGrowthPoints(growthGain);
         }
-        if (user.coins() != previousCoins) {
-            emit m_signalProxy->coinsChanged(user.coins());
+        if (coinGain > 0) {
+            user.addCoins(coinGain);
         }
-        if (user.attributes().pride != previousPride) {
-            emit m_signalProxy->prideChanged(user.attributes().pride);
+        user.applyAttributeBonus(attributeBonus);
+        if (category.has_value()) {
+            user.recordTaskCompletion(*category);
         }
+        userId = user.id();
+        level = user.level();
+        coins = user.coins();
+        pride = user.attributes().pride;
+    }
+    if (category.has_value() || growthGain > 0) {
+        m_database.recordDailyActivity(userId, QDateTime::currentMSecsSinceEpoch(), category.has_value() ? 1 : 0,
+                                       std::max(growthGain, 0), 0);
+    }
+    persistActiveUser();
+    if (m_signalProxy) {
+        m_database.runAfterCommit([proxy = m_signalProxy.get(), level, coins, pride, previousLevel, previousCoins,
+                                   previousPride]() {
+            if (level != previousLevel) {
+                emit proxy->levelChanged(level);
+            }
+            if (coins != previousCoins) {
+                emit proxy->coinsChanged(coins);
+            }
+            if (pride != previousPride) {
+                emit proxy->prideChanged(pride);
+            }
+        });
     }
 }
 
@@ -123,9 +221,10 @@ void UserManager::applyTaskCompletion(int growthGain,
  * 中文：递增成就计数并立即保存，方便荣誉墙实时刷新。
  */
 void UserManager::unlockAchievement() {
-    User& user = activeUser();
-    user.recordAchievementUnlock();
-    persistUser(user);
+    updateActiveUser([](User& user) {
+        user.recordAchievementUnlock();
+        return true;
+    });
 }
 
 /**
@@ -133,12 +232,16 @@ void UserManager::unlockAchievement() {
  * 中文：把 UI 分配结果交给 User 进行校验，然后保存，保证逻辑集中。
  */
 void UserManager::distributeAttributePoints(const User::AttributeSet& distribution) {
-    User& user = activeUser();
-    const int previousPride = user.attributes().pride;
-    user.distributeAttributes(distribution);
-    persistUser(user);
-    if (m_signalProxy && user.attributes().pride != previousPride) {
-        emit m_signalProxy->prideChanged(user.attributes().pride);
+    int previousPride = 0;
+    int pride = 0;
+    updateActiveUser([&](User& user) {
+        previousPride = user.attributes().pride;
+        user.distributeAttributes(distribution);
+        pride = user.attributes().pride;
+        return true;
+    });
+    if (m_signalProxy && pride != previousPride) {
+        m_database.runAfterCommit([proxy = m_signalProxy.get(), pride]() { emit proxy->prideChanged(pride); });
     }
 }
 
@@ -148,14 +251,67 @@ void UserManager::distributeAttributePoints(const User::AttributeSet& distributi
  * 用途：当老师使用外部工具修改数据库时，学生客户端可刷新以避免脏数据。
  */
 void UserManager::refreshFromDatabase() {
-    if (!m_activeUser.has_value()) {
-        return;  // 中文：无会话无需刷新。
+    std::string username;
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        if (!m_activeUser.has_value()) {
+            return;  // 中文：无会话无需刷新。
+        }
+        username = m_activeUser->username();
     }
-    auto record = m_database.getUserByName(m_activeUser->username());
+    auto record = m_database.getUserByName(username);
     if (!record.has_value()) {
         throw std::runtime_error("Active user missing from database");
     }
-    m_activeUser = hydrateUser(*record);
+    User user = hydrateUser(*record);
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        if (!m_activeUser.has_value() || m_activeUser->id() != record->id) {
+            return;  // 中文：查询期间会话已切换，丢弃旧用户的记录。
+        }
+        m_activeUser = std::move(user);
+        m_persistedRecord = std::move(*record);
+    }
+    queueProgressionNotice();
+}
+
+std::optional<int> UserManager::userIdFor(const std::string& username) const {
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        if (const auto it = m_userIds.find(username); it != m_userIds.end()) {
+            return it->second;
+        }
+    }
+    const auto id = m_database.getUserIdByName(username);
+    if (id.has_value()) {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        m_userIds.emplace(username, *id);
+    }
+    return id;
+}
+
+/**
+ * @brief Remove a user row; owned rows go with it.
+ * 中文：按 id 删除，成就与库存经 ON DELETE CASCADE 清理，其余按 owner_id 分区的表由触发器清理；
+ *       提交后发出 userDeleted，由各管理器丢弃该用户的内存缓存。
+ */
+bool UserManager::deleteUser(const std::string& username) {
+    const auto id = userIdFor(username);
+    if (!id.has_value()) {
+        return false;
+    }
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        if (m_activeUser.has_value() && m_activeUser->id() == *id) {
+            throw std::runtime_error("Cannot delete the active user");
+        }
+        m_userIds.erase(username);
+    }
+    const bool deleted = m_database.deleteUser(*id);
+    if (deleted && m_signalProxy) {
+        m_database.runAfterCommit([proxy = m_signalProxy.get(), userId = *id]() { emit proxy->userDeleted(userId); });
+    }
+    return deleted;
 }
 
 UserManagerSignalProxy* UserManager::signalProxy() const noexcept { return m_signalProxy.get(); }
@@ -165,7 +321,7 @@ UserManagerSignalProxy* UserManager::signalProxy() const noexcept { return m_sig
  * 中文：将数据库记录转换为包含属性与统计信息的领域对象。
  */
 User UserManager::hydrateUser(const DatabaseManager::UserRecord& record) const {
-    const auto rawMap = parseAttributesBlob(record.attributes);
+    const auto rawMap = parseStatsBlob(record.attributes);
     auto valueFor = [&rawMap](const std::string& key) -> int {
         auto it = rawMap.find(key);
         if (it == rawMap.end()) {
@@ -174,13 +330,7 @@ User UserManager::hydrateUser(const DatabaseManager::UserRecord& record) const {
         return it->second;
     };
 
-    User::AttributeSet attributes;
-    attributes.execution = valueFor(kExecutionKey);
-    attributes.perseverance = valueFor(kPerseveranceKey);
-    attributes.decision = valueFor(kDecisionKey);
-    attributes.knowledge = valueFor(kKnowledgeKey);
-    attributes.social = valueFor(kSocialKey);
-    attributes.pride = valueFor(kPrideKey);
+    const User::AttributeSet& attributes = record.attributeSet;
 
     User::ProgressStats stats;
     stats.achievementsUnlocked = valueFor(kAchievementsKey);
@@ -203,19 +353,13 @@ User UserManager::hydrateUser(const DatabaseManager::UserRecord& record) const {
 }
 
 /**
- * @brief Flatten User state into key=value pairs for SQLite column.
- * 中文：把用户状态压平成 key=value; 字符串存入 SQLite 字段。
- * 这样无需增加额外列，减少迁移成本，便于课堂说明。
+ * @brief Flatten growth and progress counters into key=value pairs for SQLite column.
+ * 中文：把成长值与统计计数压平成 key=value; 字符串存入 SQLite 字段。
+ * 六维属性已拆为 attr_* 整数列，这里只保留不参与 SQL 聚合的计数器。
  */
-std::string UserManager::serializeAttributes(const User& user) const {
+std::string UserManager::serializeStats(const User& user) const {
     std::ostringstream stream;
     stream << kGrowthKey << '=' << user.growthPoints() << ';'
-           << kExecutionKey << '=' << user.attributes().execution << ';'
-           << kPerseveranceKey << '=' << user.attributes().perseverance << ';'
-           << kDecisionKey << '=' << user.attributes().decision << ';'
-           << kKnowledgeKey << '=' << user.attributes().knowledge << ';'
-           << kSocialKey << '=' << user.attributes().social << ';'
-           << kPrideKey << '=' << user.attributes().pride << ';'
            << kAchievementsKey << '=' << user.progress().achievementsUnlocked << ';'
            << kTasksTotalKey << '=' << user.progress().totalTasksCompleted << ';'
            << kTasksAcademicKey << '=' << user.progress().academicTasksCompleted << ';'
@@ -226,10 +370,10 @@ std::string UserManager::serializeAttributes(const User& user) const {
 }
 
 /**
- * @brief Split attribute blob into map with异常兜底。
- * 中文：将属性串拆分为映射，并为异常情况提供兜底值。
+ * @brief Split stats blob into map with异常兜底。
+ * 中文：将统计串拆分为映射，并为异常情况提供兜底值。
  */
-std::unordered_map<std::string, int> UserManager::parseAttributesBlob(const std::string& blob) const {
+std::unordered_map<std::string, int> UserManager::parseStatsBlob(const std::string& blob) const {
     std::unordered_map<std::string, int> values;
     std::istringstream stream(blob);
     std::string segment;
@@ -253,28 +397,144 @@ std::unordered_map<std::string, int> UserManager::parseAttributesBlob(const std:
 }
 
 /**
- * @brief Persist user data using explicit transaction for ACID 保证。
- * 中文：使用显式事务写入用户数据，保证 ACID 特性。
- * 步骤：BEGIN -> 三条更新 -> COMMIT，出错则 ROLLBACK，完全符合老师对事务安全的要求。
+ * @brief Convert User -> DatabaseManager::UserRecord.
+ * 中文：hydrateUser 的逆操作；updateUser 按 id 做 UPSERT，id 直接取自 User。
  */
-void UserManager::persistUser(const User& user) {
-    bool transactionStarted = false;
-    try {
-        transactionStarted = m_database.beginTransaction();
-        m_database.updateUserLevel(user.username(), user.level());
-        m_database.updateUserCurrency(user.username(), user.coins());
-        m_database.updateUserAttributes(user.username(), serializeAttributes(user));
-        m_database.commitTransaction();
-    } catch (...) {
-        if (transactionStarted) {
-            try {
-                m_database.rollbackTransaction();
-            } catch (...) {
-                // 中文：回滚失败只能记录，保持异常向上抛出。
-            }
+DatabaseManager::UserRecord UserManager::toRecord(const User& user) const {
+    DatabaseManager::UserRecord record;
+    record.id = user.id();
+    record.username = user.username();
+    record.password = user.password();
+    record.level = user.level();
+    record.currency = user.coins();
+    record.attributes = serializeStats(user);
+    record.attributeSet = user.attributes();
+    return record;
+}
+
+/**
+ * @brief Persist user data with one UPSERT statement.
+ * 中文：单条语句即原子，无需显式事务；调用方已开启事务（任务结算、购买）时，
+ *       通过 deferUntilCommit 合并为提交前的一次写入，避免同一事务内重复写 users 行。
+ *       内存中的当前用户此时已被改写，事务回滚时从数据库重新装载，撤销未能落盘的改动。
+ */
+void UserManager::persistActiveUser() {
+    m_database.runOnRollback(this, [this]() { refreshFromDatabase(); });
+    m_database.deferUntilCommit(this, [this]() { flushActiveUser(); });
+    queueProgressionNotice();
+}
+
+void UserManager::flushActiveUser() {
+    // 中文：在用户锁内取出待写行与上次落盘的行，写库时已释放用户锁。
+    DatabaseManager::UserRecord record;
+    std::optional<DatabaseManager::UserRecord> persisted;
+    {
+        std::shared_lock<StateMutex> lock(m_mutex);
+        if (!m_activeUser.has_value()) {
+            return;  // 中文：提交前会话已退出，无需写入。
+        }
+        record = toRecord(*m_activeUser);
+        if (m_persistedRecord.has_value() && m_persistedRecord->id == record.id) {
+            persisted = m_persistedRecord;
+        }
+    }
+    std::uint32_t columns = DatabaseManager::UserAllColumns;
+    if (persisted.has_value()) {
+        columns = 0;
+        if (persisted->level != record.level) {
+            columns |= DatabaseManager::UserLevelColumn;
+        }
+        if (persisted->currency != record.currency) {
+            columns |= DatabaseManager::UserCurrencyColumn;
+        }
+        if (persisted->attributes != record.attributes) {
+            columns |= DatabaseManager::UserStatsColumn;
+        }
+        if (codec::attributeFields(persisted->attributeSet) != codec::attributeFields(record.attributeSet)) {
+            columns |= DatabaseManager::UserAttributeColumns;
+        }
+    }
+    if (columns == 0) {
+        return;  // 中文：与数据库一致，跳过写入。
+    }
+    if (persisted.has_value()) {
+        recordProgressionDelta(*persisted, record);
+    }
+    m_database.updateUser(record, columns);
+    // 中文：只有事务真正提交后数据库才与 record 一致；回滚时回调被丢弃，下次仍以旧行为基准比较。
+    m_database.runAfterCommit([this, record = std::move(record)]() mutable {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        if (m_activeUser.has_value() && m_activeUser->id() == record.id) {
+            m_persistedRecord = std::move(record);
+        }
+    });
+}
+
+void UserManager::recordProgressionDelta(const DatabaseManager::UserRecord& before,
+                                         const DatabaseManager::UserRecord& after) {
+    DatabaseManager::ProgressionDeltaRecord delta;
+    delta.ownerId = after.id;
+    delta.levelDelta = after.level - before.level;
+    if (before.attributes != after.attributes) {
+        const auto growthOf = [this](const std::string& blob) {
+            const auto values = parseStatsBlob(blob);
+            const auto it = values.find(kGrowthKey);
+            return it == values.end() ? 0 : it->second;
+        };
+        delta.growthDelta = growthOf(after.attributes) - growthOf(before.attributes);
+    }
+    const auto beforeFields = codec::attributeFields(before.attributeSet);
+    auto fields = codec::attributeFields(after.attributeSet);
+    bool changed = delta.levelDelta != 0 || delta.growthDelta != 0;
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        fields[i] -= beforeFields[i];
+        changed = changed || fields[i] != 0;
+    }
+    if (!changed) {
+        return;  // 中文：只有金币或计数器变化，时间回放不需要记录。
+    }
+    delta.attributeDelta = codec::attributesFromFields(fields);
+    delta.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    m_database.recordProgressionDelta(delta);
+}
+
+void UserManager::queueProgressionNotice() {
+    m_database.runAfterCommit([this]() { publishProgression(); });
+}
+
+/**
+ * @brief 比较当前用户与上次通知时的状态，按字段汇总后发出一次 progressionChanged。
+ */
+void UserManager::publishProgression() {
+    if (!m_signalProxy) {
+        return;
+    }
+    ProgressionChange change;
+    {
+        std::unique_lock<StateMutex> lock(m_mutex);
+        if (!m_activeUser.has_value() || !m_publishedProgression.has_value()) {
+            return;
+        }
+        change.before = *m_publishedProgression;
+        change.after = ProgressionState::of(*m_activeUser);
+        if (change.before.level != change.after.level) {
+            change.fields |= ProgressionChange::Level;
+        }
+        if (change.before.growthPoints != change.after.growthPoints) {
+            change.fields |= ProgressionChange::Growth;
+        }
+        if (change.before.coins != change.after.coins) {
+            change.fields |= ProgressionChange::Coins;
+        }
+        if (codec::attributeFields(change.before.attributes) != codec::attributeFields(change.after.attributes)) {
+            change.fields |= ProgressionChange::Attributes;
+        }
+        if (change.fields == 0U) {
+            return;
         }
-        throw;
+        m_publishedProgression = change.after;
     }
+    emit m_signalProxy->progressionChanged(change);
 }
 
 }  // namespace rove::data
@@ -3,16 +3,50 @@
 
 #include <QObject>
 
+#include <functional>
 #include <optional>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <memory>
 
 #include "DatabaseManager.h"
+#include "Metrics.h"
 #include "User.h"
 
 namespace rove::data {
 
+/**
+ * @brief 成长进度的四个字段：等级、成长值、金币与六维属性。
+ * 中文：UserManager 持有的当前用户是这些字段唯一的真实来源，GrowthSystem 等上层只读取、不另存副本。
+ */
+struct ProgressionState {
+    int level = 1;
+    int growthPoints = 0;
+    int coins = 0;
+    User::AttributeSet attributes;
+
+    [[nodiscard]] static ProgressionState of(const User& user) noexcept;
+};
+
+/**
+ * @brief 一次合并后的进度变更：fields 标记变化的字段，before/after 为上次通知与本次通知时的状态。
+ */
+struct ProgressionChange {
+    enum Field : unsigned {
+        Level = 1U << 0,
+        Growth = 1U << 1,
+        Coins = 1U << 2,
+        Attributes = 1U << 3,
+    };
+
+    unsigned fields = 0;
+    ProgressionState before;
+    ProgressionState after;
+
+    [[nodiscard]] bool has(Field field) const noexcept { return (fields & field) != 0U; }
+};
+
 /**
  * @brief Signal proxy for UserManager to emit Qt signals
  * 中文：UserManager 的信号代理类，用于发射 Qt 信号
@@ -21,12 +55,31 @@ class UserManagerSignalProxy : public QObject {
     Q_OBJECT
 
 public:
-    explicit UserManagerSignalProxy(QObject* parent = nullptr) : QObject(parent) {}
+    explicit UserManagerSignalProxy(QObject* parent = nullptr) : QObject(parent) {
+        // 中文：写操作可在命令执行器的数据线程上发出本信号，排队送往 GUI 线程需要登记元类型。
+        qRegisterMetaType<ProgressionChange>("rove::data::ProgressionChange");
+    }
 
 signals:
     void levelChanged(int newLevel);
     void prideChanged(int newPride);
     void coinsChanged(int newCoins);
+    /**
+     * @brief 进度字段变化的合并通知：每个事务提交后最多发出一次，订阅者按 fields 只处理关心的字段。
+     * 中文：levelChanged/prideChanged/coinsChanged 同样在提交后逐项发出，驱动成就条件等后续写入；
+     *       界面与 GrowthSystem 只订阅本信号，一次任务结算无论改动几个字段都只收到一次通知。
+     */
+    void progressionChanged(const rove::data::ProgressionChange& change);
+    /**
+     * @brief 登录成功或退出后发射；userId 为新会话的 users.id，退出时为 0。
+     * 中文：按用户分区的管理器据此切换缓存，退出时的处理不得访问数据库。
+     */
+    void sessionChanged(int userId);
+    /**
+     * @brief 用户行删除并提交后发射；数据库中的从属行已由外键与触发器清理。
+     * 中文：按用户缓存数据的管理器据此丢弃该用户的缓存，避免同一 id 的残留数据被后续读取。
+     */
+    void userDeleted(int userId);
 };
 
 /**
@@ -81,20 +134,39 @@ public:
     [[nodiscard]] bool hasActiveUser() const noexcept;
 
     /**
-     * @brief Immutable access to active user.
-     * 中文：以只读方式访问当前用户。
-     * @return Constant reference to active user. 中文：返回当前用户常量引用。
+     * @brief Snapshot of the active user.
+     * 中文：返回当前用户的快照副本；命令执行器的数据线程可能同时改写当前用户，因此不再交出引用。
+     * @return Copy taken under the user lock. 中文：在用户锁内拷贝的副本。
+     * @throws std::runtime_error When no session exists. 中文：无会话时抛异常。
+     */
+    [[nodiscard]] User activeUser() const;
+
+    /**
+     * @brief users.id of the active user without copying the whole entity.
+     * 中文：只取当前用户的 id，免去整份快照的拷贝。
+     * @return Active user id. 中文：当前用户 id。
      * @throws std::runtime_error When no session exists. 中文：无会话时抛异常。
      */
-    [[nodiscard]] const User& activeUser() const;
+    [[nodiscard]] int activeUserId() const;
 
     /**
-     * @brief Mutable access to active user for UI adjustments.
-     * 中文：以可写方式访问当前用户。
-     * @return Writable reference. 中文：返回可写引用。
+     * @brief Mutate the active user under the user lock and persist it when the callback reports a change.
+     * 中文：在用户锁内调用 mutate 改写当前用户，mutate 返回 true 时按 saveActiveUser 的方式保存（外层事务中
+     *       合并到提交前写入）。校验与扣减须放在同一次回调里，避免另一线程在两者之间改动余额。
+     *       mutate 持锁执行，不得访问数据库或其他管理器。
+     * @param mutate Callback returning whether the user changed. 中文：返回是否改动了用户的回调。
+     * @return Value returned by mutate. 中文：mutate 的返回值。
+     * @throws std::runtime_error When no session or DB fails. 中文：无会话或数据库失败抛异常。
+     */
+    bool updateActiveUser(const std::function<bool(User&)>& mutate);
+
+    /**
+     * @brief Mutate the active user under the user lock without persisting.
+     * 中文：只在用户锁内改写当前用户、不保存；供已持有其他管理器锁、随后由同一流程保存的调用方使用
+     *       （如成就奖励随 unlockAchievement 一并落盘）。mutate 同样不得访问数据库或其他管理器。
      * @throws std::runtime_error When no session exists. 中文：无会话时抛异常。
      */
-    [[nodiscard]] User& activeUser();
+    void mutateActiveUser(const std::function<void(User&)>& mutate);
 
     /**
      * @brief Persist current in-memory state back to SQLite.
@@ -119,6 +191,14 @@ public:
                              const User::AttributeSet& attributeBonus,
                              User::TaskCategory category);
 
+    /**
+     * @brief Apply growth/coin/attribute rewards that do not come from a task.
+     * 中文：发放与任务无关的成长、金币、属性奖励（例如 GrowthSystem::addExperience 等直接加成），不计入任务统计；
+     *       与 applyTaskCompletion 一样一次保存，并在事务提交后发出 levelChanged/coinsChanged/prideChanged。
+     * @throws std::runtime_error When no session or DB fails. 中文：无会话或数据库失败抛异常。
+     */
+    void applyRewards(int growthGain, int coinGain, const User::AttributeSet& attributeBonus);
+
     /**
      * @brief Register newly unlocked achievement.
      * 中文：登记新的成就解锁事件。
@@ -144,6 +224,26 @@ public:
      */
     void refreshFromDatabase();
 
+    /**
+     * @brief Resolve a username to its users.id.
+     * 中文：把用户名解析为 users.id；成就、库存等表只以 id 引用用户，用户名仅在登录与界面入口处出现。
+     *       结果缓存在 m_userIds 中，同一用户名不再重复查询。
+     * @param username Username to resolve. 中文：要解析的用户名。
+     * @return User id, or std::nullopt when unknown. 中文：找不到时返回 std::nullopt。
+     * @throws std::runtime_error When database query fails. 中文：查询失败时抛异常。
+     */
+    [[nodiscard]] std::optional<int> userIdFor(const std::string& username) const;
+
+    /**
+     * @brief Delete a user together with every row owned by that user.
+     * 中文：删除用户；外键级联与删除触发器一并清理其成就、库存、任务、日志与成长快照。
+     *       不允许删除当前登录的用户。
+     * @param username Username to delete. 中文：要删除的用户名。
+     * @return true when a row was deleted. 中文：确有用户被删除时返回 true。
+     * @throws std::runtime_error When DB operations fail. 中文：数据库失败时抛异常。
+     */
+    bool deleteUser(const std::string& username);
+
     /**
      * @brief 暴露信号代理，供成就系统监听等级/自豪感等事件。
      */
@@ -160,35 +260,81 @@ private:
     User hydrateUser(const DatabaseManager::UserRecord& record) const;
 
     /**
-     * @brief Serialize growth/attributes/progress into compact string.
-     * 中文：将成长值、属性、统计序列化为紧凑字符串。
+     * @brief Serialize growth/progress counters into compact string.
+     * 中文：将成长值与统计序列化为紧凑字符串；六维属性单独存于 attr_* 列。
      * @param user In-memory entity. 中文：需要序列化的用户对象。
      * @return Key-value blob used by DatabaseManager. 中文：返回用于存储的键值串。
      * @throws None. 中文：不抛异常。
      */
-    std::string serializeAttributes(const User& user) const;
+    std::string serializeStats(const User& user) const;
 
     /**
-     * @brief Parse attribute blob string into key-value map.
-     * 中文：把属性字符串解析成键值映射，便于读取。
+     * @brief Parse stats blob string into key-value map.
+     * 中文：把统计字符串解析成键值映射，便于读取。
      * @param blob Compact serialized payload. 中文：紧凑的序列化字符串。
      * @return Map of field names to integers. 中文：返回字段到整数的映射。
      * @throws None (invalid pairs skipped). 中文：遇到非法键值对会跳过，不抛异常。
      */
-    std::unordered_map<std::string, int> parseAttributesBlob(const std::string& blob) const;
+    std::unordered_map<std::string, int> parseStatsBlob(const std::string& blob) const;
+
+    /**
+     * @brief Convert the domain object back into a users row.
+     * 中文：将 User 转换回 users 表记录。
+     * @param user In-memory entity. 中文：内存中的用户对象。
+     * @return Row ready for DatabaseManager::updateUser. 中文：返回可直接写入的记录。
+     * @throws None. 中文：不抛异常。
+     */
+    DatabaseManager::UserRecord toRecord(const User& user) const;
+
+    /**
+     * @brief Persist the active user with a single UPSERT of the changed columns.
+     * 中文：以单条 UPSERT 只写入变化的列；处于外层事务中时延迟到提交前统一写一次。
+     *       调用时不得持有 m_mutex：写入经数据库写锁执行，锁序为 DatabaseManager -> UserManager。
+     * @return void. 中文：无返回值。
+     * @throws std::runtime_error When DB operations fail. 中文：数据库失败时抛异常。
+     */
+    void persistActiveUser();
 
     /**
-     * @brief Persist a given user within a transaction for安全性。
-     * 中文：在事务中保存用户，保证一致性。
-     * @param user Target user. 中文：要保存的用户。
+     * @brief Write the active user's dirty columns and refresh the persisted snapshot.
+     * 中文：写入当前用户的脏列，并更新已持久化快照。
      * @return void. 中文：无返回值。
      * @throws std::runtime_error When DB operations fail. 中文：数据库失败时抛异常。
      */
-    void persistUser(const User& user);
+    void flushActiveUser();
+
+    /**
+     * @brief Append the level/growth/attribute difference between two rows to the delta history.
+     * 中文：把两次写回之间的等级、成长值与六维属性变化量追加到变化记录，供按时间点回放状态；全为 0 时跳过。
+     * @throws std::runtime_error When DB operations fail. 中文：数据库失败时抛异常。
+     */
+    void recordProgressionDelta(const DatabaseManager::UserRecord& before, const DatabaseManager::UserRecord& after);
+
+    /**
+     * @brief 登记一次提交后的进度通知；同一事务内多次登记只有第一次会发出信号。
+     * 中文：通知时把当前用户与上次通知的状态比较，字段未变化时不发信号；回滚的事务不会通知。
+     */
+    void queueProgressionNotice();
+    void applyProgressionDelta(int growthGain,
+                               int coinGain,
+                               const User::AttributeSet& attributeBonus,
+                               std::optional<User::TaskCategory> category);
+    void publishProgression();
+
+    using StateMutex = metrics::ProfiledMutex<std::shared_mutex>;
 
     DatabaseManager& m_database;
+    /**
+     * @brief 保护当前用户、已持久化快照、已通知进度与用户名缓存。
+     * 中文：GUI 线程读写当前用户，命令执行器的数据线程也会结算任务、购买道具；持锁期间不访问数据库、
+     *       不发信号，需要同时持有数据库写锁时先取写锁。
+     */
+    mutable StateMutex m_mutex;
     std::optional<User> m_activeUser;  //!< RAII session object. 中文：RAII 管理的会话对象。
+    std::optional<DatabaseManager::UserRecord> m_persistedRecord;  //!< Last row written/read. 中文：最近一次与数据库一致的行。
     std::unique_ptr<UserManagerSignalProxy> m_signalProxy;
+    std::optional<ProgressionState> m_publishedProgression;  //!< 最近一次 progressionChanged 通知时的状态。
+    mutable std::unordered_map<std::string, int> m_userIds;  //!< 用户名 -> users.id 缓存。
 };
 
 }  // namespace rove::data
@@ -1,7 +1,17 @@
 #include <QApplication>
+#include <QCryptographicHash>
+#include <QFile>
 #include <QMessageBox>
 #include <QStandardPaths>
 #include <QDir>
+#include <QDebug>
+#include <QTimer>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
 
 #include "ui/MainWindow.h"
 #include "core/DatabaseManager.h"
@@ -13,14 +23,23 @@
 #include "core/InventoryManager.h"
 #include "core/SerendipityEngine.h"
 #include "core/GrowthVisualizer.h"
+#include "core/StartupHydrator.h"
+#include "core/MaintenanceScheduler.h"
+#include "core/BackupService.h"
+#include "core/CommandExecutor.h"
+#include "core/EventJournal.h"
+#include "core/ActivityFeed.h"
+#include "core/MemoryAccounting.h"
+#include "core/SqliteMemory.h"
 
 /**
  * @brief 应用程序入口点
  * 
  * 初始化流程：
  * 1. 初始化数据库连接
- * 2. 创建所有核心管理器实例
- * 3. 创建并显示主窗口
+ * 2. 创建所有核心管理器实例（构造不读取业务数据）
+ * 3. 登录后在工作线程并行装载任务、成就与商城目录
+ * 4. 创建并显示主窗口，各页面先显示骨架，装载完成后填充
  */
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
@@ -35,9 +54,154 @@ int main(int argc, char *argv[]) {
         auto dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
         QDir().mkpath(dataPath);
         QString dbPath = dataPath + "/growth.db";
-        
+
+        // 设置 CYBER_LANDA_SQLITE_MEMORY=pooled 启用预分配页缓存池与放大的 lookaside；
+        // 须在恢复备份与打开数据库之前配置，SQLite 一旦初始化便不再接受。
+        if (qEnvironmentVariable("CYBER_LANDA_SQLITE_MEMORY") == QStringLiteral("pooled")) {
+            std::string memoryError;
+            if (!rove::data::configureSqliteMemory(rove::data::SqliteMemoryProfile::pooled(), &memoryError)) {
+                qWarning() << "SQLite 内存配置未完全生效:" << memoryError.c_str();
+            }
+        }
+
+        // 设置 CYBER_LANDA_RESTORE_BACKUP=<备份文件> 在打开数据库前用该备份覆盖当前库。
+        const QString restoreFrom = qEnvironmentVariable("CYBER_LANDA_RESTORE_BACKUP");
+        if (!restoreFrom.isEmpty()) {
+            rove::data::BackupService::restore(restoreFrom.toStdString(), dbPath.toStdString());
+        }
+
+        // 设置 CYBER_LANDA_IN_MEMORY=<秒> 在内存库上运行（展示机、演示），按该间隔及退出时写回 growth.db。
+        bool inMemoryRequested = false;
+        const int checkpointSeconds = qEnvironmentVariableIntValue("CYBER_LANDA_IN_MEMORY", &inMemoryRequested);
+        auto profile = rove::data::DatabaseManager::ConnectionProfile::balanced();
+        if (inMemoryRequested) {
+            profile = rove::data::DatabaseManager::ConnectionProfile::inMemoryCheckpointed();
+            profile.memoryCheckpointIntervalMs = std::max(0, checkpointSeconds) * 1000;
+        }
+
         auto& dbManager = rove::data::DatabaseManager::instance();
-        dbManager.initialize(dbPath.toStdString());
+        dbManager.initialize(dbPath.toStdString(), profile);
+        if (inMemoryRequested) {
+            QObject::connect(&app, &QCoreApplication::aboutToQuit, &app, [&dbManager]() {
+                try {
+                    dbManager.checkpointToDisk();
+                } catch (const std::exception& e) {
+                    qWarning() << "退出时写回内存库失败:" << e.what();
+                }
+            });
+        }
+
+        // 设置 CYBER_LANDA_QUERY_TRACE_MS=<毫秒> 开启 SQL 追踪，超过阈值的语句连同查询计划写入日志，退出时输出汇总。
+        bool traceRequested = false;
+        const int traceThresholdMs = qEnvironmentVariableIntValue("CYBER_LANDA_QUERY_TRACE_MS", &traceRequested);
+        if (traceRequested) {
+            rove::data::DatabaseManager::QueryTraceOptions traceOptions;
+            traceOptions.enabled = true;
+            traceOptions.slowThresholdMs = traceThresholdMs;
+            dbManager.setQueryTrace(traceOptions);
+            QObject::connect(&app, &QCoreApplication::aboutToQuit, &app, [&dbManager]() {
+                qInfo().noquote() << QString::fromStdString(dbManager.queryTraceReport().toText());
+            });
+        }
+
+        // 设置 CYBER_LANDA_IMPORT_PROFILE=<档案文件> 在装载前用档案替换预置账号的数据（换机、重装后恢复）；
+        // 设置 CYBER_LANDA_EXPORT_PROFILE=<档案文件> 把预置账号的数据导出为档案。导入先于导出执行。
+        const QString importProfile = qEnvironmentVariable("CYBER_LANDA_IMPORT_PROFILE");
+        const QString exportProfile = qEnvironmentVariable("CYBER_LANDA_EXPORT_PROFILE");
+        if (!importProfile.isEmpty() || !exportProfile.isEmpty()) {
+            const auto profileUserId = dbManager.getUserIdByName("x");
+            if (!profileUserId.has_value()) {
+                throw std::runtime_error("预置账号不存在，无法导入或导出档案");
+            }
+            int reportedDecile = -1;
+            const auto reportProgress = [&reportedDecile](std::uint64_t done, std::uint64_t total) {
+                const int decile = total == 0 ? 10 : static_cast<int>(done * 10 / total);
+                if (decile != reportedDecile) {
+                    reportedDecile = decile;
+                    qInfo() << "档案处理进度:" << decile * 10 << "%";
+                }
+                return true;
+            };
+            if (!importProfile.isEmpty()) {
+                // 中文：环境变量在每次启动时都还在；以档案内容的摘要记入 app_state，同一份档案只导入一次，
+                //       否则之后每次启动都会用旧档案覆盖期间产生的新数据。
+                QFile archive(importProfile);
+                QCryptographicHash digest(QCryptographicHash::Sha256);
+                if (!archive.open(QIODevice::ReadOnly) || !digest.addData(&archive)) {
+                    throw std::runtime_error("无法打开档案文件: " + importProfile.toStdString());
+                }
+                const QByteArray hash = digest.result();
+                qint64 archiveId = 0;
+                std::memcpy(&archiveId, hash.constData(), sizeof(archiveId));
+                if (dbManager.getAppState("profile_import_hash") == archiveId) {
+                    qInfo() << "档案已导入过，跳过:" << importProfile;
+                } else {
+                    std::ifstream in(importProfile.toStdString(), std::ios::binary);
+                    if (!in) {
+                        throw std::runtime_error("无法打开档案文件: " + importProfile.toStdString());
+                    }
+                    const auto report = dbManager.importUserProfile(*profileUserId, in, reportProgress);
+                    dbManager.setAppState("profile_import_hash", archiveId);
+                    qInfo() << "已导入档案:" << report.rows << "行," << report.tables << "张表";
+                }
+            }
+            if (!exportProfile.isEmpty()) {
+                // 中文：先写同目录的 .part 文件，完整写出后再替换目标，导出中途失败不会留下残缺档案。
+                reportedDecile = -1;
+                const QString partialPath = exportProfile + QStringLiteral(".part");
+                std::ofstream out(partialPath.toStdString(), std::ios::binary | std::ios::trunc);
+                rove::data::DatabaseManager::ProfileTransferReport report;
+                try {
+                    report = dbManager.exportUserProfile(*profileUserId, out, reportProgress);
+                } catch (...) {
+                    out.close();
+                    QFile::remove(partialPath);
+                    throw;
+                }
+                out.close();
+                if (!out || (QFile::exists(exportProfile) && !QFile::remove(exportProfile)) ||
+                    !QFile::rename(partialPath, exportProfile)) {
+                    QFile::remove(partialPath);
+                    throw std::runtime_error("无法写入档案文件: " + exportProfile.toStdString());
+                }
+                qInfo() << "已导出档案:" << report.rows << "行," << report.tables << "张表";
+            }
+        }
+
+        // 设置 CYBER_LANDA_EVENT_JOURNAL=<日志文件> 记录本次会话的管理器命令，供 journal_replay 复现与剖析；
+        // 同时把当前库快照到 <日志文件>.base.db 作为回放起点。快照或日志创建失败只告警，不影响启动。
+        const QString journalPath = qEnvironmentVariable("CYBER_LANDA_EVENT_JOURNAL");
+        if (!journalPath.isEmpty()) {
+            const std::string snapshotPath = journalPath.toStdString() + ".base.db";
+            const auto snapshot =
+                inMemoryRequested
+                    ? rove::data::BackupService::backupMemoryTo(dbManager, snapshotPath, 1024, std::chrono::milliseconds(0))
+                    : rove::data::BackupService::backupTo(dbPath.toStdString(), snapshotPath, 1024,
+                                                          std::chrono::milliseconds(0));
+            std::string journalError;
+            if (!snapshot.succeeded) {
+                qWarning() << "事件日志的起点快照失败，未开启记录:" << snapshot.error.c_str();
+            } else if (!rove::data::EventJournal::instance().start(journalPath.toStdString(), std::random_device{}(),
+                                                                    &journalError)) {
+                qWarning() << "事件日志未开启:" << journalError.c_str();
+            }
+        }
+
+        // 后台在线备份：独立只读连接分批复制，不占用写锁；内存模式下改从内存库分步复制。
+        // CYBER_LANDA_BACKUP_INTERVAL_MIN=0 关闭计划备份。
+        rove::data::BackupService::Options backupOptions;
+        backupOptions.directory = (dataPath + "/backups").toStdString();
+        bool backupIntervalSet = false;
+        const int backupIntervalMin = qEnvironmentVariableIntValue("CYBER_LANDA_BACKUP_INTERVAL_MIN", &backupIntervalSet);
+        if (backupIntervalSet) {
+            backupOptions.interval = std::chrono::minutes(backupIntervalMin);
+        }
+        rove::data::BackupService backupService(dbPath.toStdString(), backupOptions);
+        if (inMemoryRequested) {
+            backupService.setMemorySource(&dbManager);
+        }
+        backupService.start();
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, &backupService, [&backupService]() { backupService.stop(); });
 
         // 获取和创建管理器实例
         rove::data::UserManager userManager(dbManager);
@@ -48,8 +212,27 @@ int main(int argc, char *argv[]) {
         inventoryManager.initialize(dbManager);
         auto& shopManager = rove::data::ShopManager::instance();
         shopManager.initialize(dbManager, userManager, inventoryManager);
+        // 删除用户后丢弃其库存缓存；任务缓存由 TaskManager 自行订阅清理。
+        QObject::connect(userManager.signalProxy(), &rove::data::UserManagerSignalProxy::userDeleted, &app,
+                         [&inventoryManager](int userId) { inventoryManager.discardCachedOwner(userId); });
         auto& serendipityEngine = rove::data::SerendipityEngine::instance(dbManager, logManager, userManager);
         auto& growthVisualizer = rove::GrowthVisualizer::instance();
+        // 仪表盘近期动态：登录时读取当前用户的缓冲，此后随业务信号逐条追加。
+        rove::data::ActivityFeed activityFeed(dbManager, userManager, taskManager, achievementManager, logManager,
+                                              shopManager, inventoryManager);
+
+        // 设置 CYBER_LANDA_MEMORY_BUDGETS=<模块=KiB,...>（如 tasks=4096,sqlite=16384）为各模块设定内存限额，
+        // 每分钟检查一次，超出限额的模块回收可重建的缓存；估算值可在指标面板查看。
+        const QString memoryBudgets = qEnvironmentVariable("CYBER_LANDA_MEMORY_BUDGETS");
+        if (!memoryBudgets.isEmpty()
+            && !rove::metrics::MemoryRegistry::instance().applyBudgetSpec(memoryBudgets.toStdString())) {
+            qWarning() << "内存限额格式无效，已忽略:" << memoryBudgets;
+        }
+        QTimer memoryBudgetTimer;
+        memoryBudgetTimer.setInterval(60 * 1000);
+        QObject::connect(&memoryBudgetTimer, &QTimer::timeout, &app,
+                         []() { rove::metrics::MemoryRegistry::instance().enforceBudgets(); });
+        memoryBudgetTimer.start();
 
         // 使用预置账号登录 (用户名: x, 密码: 1)
         if (!userManager.login("x", "1")) {
@@ -59,8 +242,35 @@ int main(int argc, char *argv[]) {
             return 1;
         }
 
-        // 预加载系统成就，确保画廊与奖励逻辑立即可用。
-        achievementManager.refreshFromDatabase();
+        // 任务、成就与商城目录互不依赖，在工作线程并行装载，主窗口无需等待。
+        rove::data::StartupHydrator hydrator(taskManager, achievementManager, shopManager);
+        hydrator.start();
+        // 界面发起的写操作在独立的数据线程上执行；退出时先执行完已提交的命令，再刷写成就进度与日志。
+        rove::data::CommandExecutor commandExecutor;
+        commandExecutor.start();
+        // 用户空闲时在数据线程上做数据库维护（WAL 截断、optimize、ANALYZE、quick_check、日志归档、空闲页回收，
+        // 以及日志归档后旧库到增量 auto_vacuum 的一次性转换），进度跨重启保留；
+        // 设置 CYBER_LANDA_MAINTENANCE_IDLE_MIN=<分钟> 调整空闲判定时长。退出时先于执行器停止，不再提交新的步骤。
+        rove::data::MaintenanceScheduler::Options maintenanceOptions;
+        bool maintenanceIdleSet = false;
+        const int maintenanceIdleMin = qEnvironmentVariableIntValue("CYBER_LANDA_MAINTENANCE_IDLE_MIN", &maintenanceIdleSet);
+        if (maintenanceIdleSet) {
+            maintenanceOptions.idleAfter = std::chrono::minutes(maintenanceIdleMin);
+        }
+        rove::data::MaintenanceScheduler maintenanceScheduler(dbManager, &logManager, commandExecutor, maintenanceOptions);
+        maintenanceScheduler.start();
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, &maintenanceScheduler,
+                         [&maintenanceScheduler]() { maintenanceScheduler.stop(); });
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, &commandExecutor,
+                         [&commandExecutor]() { commandExecutor.stop(); });
+        // 执行器停止后不再有命令入口被调用，此时写出事件日志的剩余记录。
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, &app, []() { rove::data::EventJournal::instance().stop(); });
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, &activityFeed, [&activityFeed]() { activityFeed.persist(); });
+        // 成就进度采用写后缓冲，退出事件循环前把尚未落盘的进度写回。
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, &achievementManager,
+                         [&achievementManager]() { achievementManager.flushPendingProgress(); });
+        // 自动日志经后台队列组提交，退出前等待队列写完。
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, &logManager, [&logManager]() { logManager.flush(); });
 
         // 创建主窗口
         MainWindow mainWindow(
@@ -71,7 +281,10 @@ int main(int argc, char *argv[]) {
             shopManager,
             inventoryManager,
             serendipityEngine,
-            growthVisualizer
+            growthVisualizer,
+            hydrator,
+            commandExecutor,
+            activityFeed
         );
 
         mainWindow.setWindowTitle(QStringLiteral("兰大成长模拟 - Cyber Landa"));
@@ -0,0 +1,73 @@
+#include "AchievementCardDelegate.h"
+
+#include <QPainter>
+#include <QPixmap>
+
+#include "AchievementListModel.h"
+
+namespace {
+constexpr int kPadding = 8;
+constexpr int kRadius = 6;
+const QColor kUnlockedBackground(0xe6, 0xff, 0xe6);  // 中文：与旧版卡片样式表的底色一致。
+const QColor kLockedBackground(0xf2, 0xf2, 0xf2);
+}  // namespace
+
+AchievementCardDelegate::AchievementCardDelegate(QObject* parent) : QStyledItemDelegate(parent) {}
+
+/**
+ * @brief 绘制一张卡片：左侧图标，右侧依次为名称、两行以内的描述与解锁状态（进度型成就显示百分比）。
+ */
+void AchievementCardDelegate::paint(QPainter* painter,
+                                    const QStyleOptionViewItem& option,
+                                    const QModelIndex& index) const {
+    const bool unlocked = index.data(AchievementListModel::UnlockedRole).toBool();
+    const QRect card = option.rect.adjusted(2, 2, -2, -2);
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(option.palette.mid().color());
+    painter->setBrush(unlocked ? kUnlockedBackground : kLockedBackground);
+    painter->drawRoundedRect(card, kRadius, kRadius);
+
+    const int iconExtent = AchievementListModel::kIconExtent;
+    const QRect iconRect(card.left() + kPadding, card.top() + kPadding, iconExtent, iconExtent);
+    const QPixmap icon = index.data(Qt::DecorationRole).value<QPixmap>();
+    if (!icon.isNull()) {
+        const QSize scaled = icon.size().scaled(iconRect.size(), Qt::KeepAspectRatio);
+        painter->drawPixmap(QRect(iconRect.topLeft(), scaled), icon);
+    }
+
+    const QRect textRect(iconRect.right() + kPadding, card.top() + kPadding,
+                         card.right() - iconRect.right() - 2 * kPadding, card.height() - 2 * kPadding);
+    const QFontMetrics metrics = option.fontMetrics;
+    const int lineHeight = metrics.height();
+    painter->setPen(option.palette.text().color());
+
+    QFont nameFont = option.font;
+    nameFont.setBold(true);
+    painter->setFont(nameFont);
+    const QString name = QFontMetrics(nameFont).elidedText(index.data(Qt::DisplayRole).toString(), Qt::ElideRight,
+                                                           textRect.width());
+    painter->drawText(QRect(textRect.left(), textRect.top(), textRect.width(), lineHeight),
+                      Qt::AlignLeft | Qt::AlignVCenter, name);
+
+    painter->setFont(option.font);
+    const QRect descriptionRect(textRect.left(), textRect.top() + lineHeight, textRect.width(), 2 * lineHeight);
+    painter->setClipRect(descriptionRect);  // 中文：超过两行的描述直接截断，完整内容见悬停提示。
+    painter->drawText(descriptionRect, Qt::AlignLeft | Qt::AlignTop | Qt::TextWordWrap,
+                      index.data(AchievementListModel::DescriptionRole).toString());
+    painter->setClipping(false);
+
+    QString status = unlocked ? QStringLiteral("已解锁") : QStringLiteral("未解锁");
+    if (!unlocked && index.data(AchievementListModel::ProgressBasedRole).toBool()) {
+        status = QStringLiteral("进度 %1%").arg(index.data(AchievementListModel::ProgressPercentRole).toInt());
+    }
+    painter->setPen(option.palette.placeholderText().color());
+    painter->drawText(QRect(textRect.left(), textRect.bottom() - lineHeight, textRect.width(), lineHeight),
+                      Qt::AlignLeft | Qt::AlignVCenter, status);
+    painter->restore();
+}
+
+QSize AchievementCardDelegate::sizeHint(const QStyleOptionViewItem&, const QModelIndex&) const {
+    return {kCardWidth, kCardHeight};
+}
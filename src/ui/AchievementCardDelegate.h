@@ -0,0 +1,25 @@
+#ifndef ACHIEVEMENTCARDDELEGATE_H
+#define ACHIEVEMENTCARDDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+/**
+ * @class AchievementCardDelegate
+ * @brief 直接用 QPainter 绘制成就卡片：底色、图标、名称、描述与状态。
+ * 中文说明：取代每张卡片一个 QWidget 加三个 QLabel 与独立样式表的做法；卡片尺寸固定，
+ *          视图只为可见行调用 paint，成就数量再多也不会创建控件或解析样式表。
+ */
+class AchievementCardDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    explicit AchievementCardDelegate(QObject* parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+    static constexpr int kCardWidth = 220;
+    static constexpr int kCardHeight = 112;
+};
+
+#endif  // ACHIEVEMENTCARDDELEGATE_H
@@ -1,69 +1,62 @@
 #include "AchievementGallery.h"
 #include "ui_AchievementGallery.h"
 
-#include <QLabel>
-#include <QVBoxLayout>
+#include <QListView>
+
+#include "AchievementCardDelegate.h"
+#include "AchievementListModel.h"
 
 /**
- * @brief 构造函数：搭建网格布局。
+ * @brief 构造函数：配置图标模式列表视图，卡片尺寸统一，窗口变化时自动重排。
  */
-AchievementGallery::AchievementGallery(rove::data::AchievementManager& manager, QWidget* parent)
-    : QWidget(parent), ui(std::make_unique<Ui::AchievementGallery>()), m_manager(manager) {
+AchievementGallery::AchievementGallery(rove::data::AchievementManager& manager, IconCache& icons, QWidget* parent)
+    : QWidget(parent),
+      ui(std::make_unique<Ui::AchievementGallery>()),
+      m_manager(manager),
+      m_model(new AchievementListModel(manager, icons, this)) {
     ui->setupUi(this);
-    m_grid = ui->gridLayout;
+    auto* view = ui->listView;
+    view->setViewMode(QListView::IconMode);
+    view->setResizeMode(QListView::Adjust);
+    view->setMovement(QListView::Static);
+    view->setUniformItemSizes(true);
+    view->setSelectionMode(QAbstractItemView::NoSelection);
+    view->setSpacing(6);
+    view->setItemDelegate(new AchievementCardDelegate(view));
+    view->setModel(m_model);
+    showLoading();
 }
 
 AchievementGallery::~AchievementGallery() = default;
 
 /**
- * @brief 重新加载成就网格：清理旧控件，按行列填充新卡片。
- * 中文：当 AchievementManager 状态刷新或新增自定义成就时调用，避免残留指针导致崩溃。
+ * @brief 重新加载全部成就，仅在启动装载完成或整体刷新时调用。
  */
 void AchievementGallery::reload() {
-    const auto all = m_manager.achievements();
-    while (m_grid->count() > 0) {
-        if (auto* item = m_grid->takeAt(0)) {
-            delete item->widget();
-            delete item;
-        }
-    }
+    m_loaded = true;
+    m_model->reload();
+    updatePlaceholder();
+}
 
-    if (all.empty()) {
-        auto* placeholder = new QLabel(QStringLiteral("暂无成就，先去完成任务试试吧"), this);
-        placeholder->setAlignment(Qt::AlignCenter);
-        m_grid->addWidget(placeholder, 0, 0);
+void AchievementGallery::updateAchievements(const QSet<int>& achievementIds) {
+    if (!m_loaded) {
         return;
     }
-
-    int row = 0;
-    int col = 0;
-    for (const auto& ac : all) {
-        m_grid->addWidget(createCard(ac), row, col);
-        ++col;
-        if (col > 2) {
-            col = 0;
-            ++row;
-        }
-    }
+    m_model->refreshAchievements(achievementIds);
+    updatePlaceholder();
 }
 
-/**
- * @brief 创建单个成就卡片，展示图标、名称与状态。
- */
-QWidget* AchievementGallery::createCard(const rove::data::Achievement& achievement) {
-    auto* card = new QWidget(this);
-    auto* layout = new QVBoxLayout(card);
-    auto* nameLabel = new QLabel(QString::fromStdString(achievement.name()), card);
-    auto* descLabel = new QLabel(QString::fromStdString(achievement.description()), card);
-    auto* statusLabel = new QLabel(achievement.unlocked() ? QStringLiteral("已解锁")
-                                                           : QStringLiteral("未解锁"),
-                                  card);
-    layout->addWidget(nameLabel);
-    layout->addWidget(descLabel);
-    layout->addWidget(statusLabel);
-    card->setStyleSheet(achievement.unlocked() ? "background:#e6ffe6;" : "background:#f2f2f2;");
-    return card;
+void AchievementGallery::showLoading() {
+    ui->placeholderLabel->setText(QStringLiteral("成就加载中…"));
+    ui->placeholderLabel->show();
+    ui->listView->hide();
 }
 
-
-
+void AchievementGallery::updatePlaceholder() {
+    const bool empty = m_model->rowCount() == 0;
+    if (empty) {
+        ui->placeholderLabel->setText(QStringLiteral("暂无成就，先去完成任务试试吧"));
+    }
+    ui->placeholderLabel->setVisible(empty);
+    ui->listView->setVisible(!empty);
+}
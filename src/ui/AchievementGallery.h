@@ -1,9 +1,8 @@
 #ifndef ACHIEVEMENTGALLERY_H
 #define ACHIEVEMENTGALLERY_H
 
+#include <QSet>
 #include <QWidget>
-#include <QGridLayout>
-#include <QScrollArea>
 #include <memory>
 #include "../core/AchievementManager.h"
 
@@ -11,16 +10,20 @@ namespace Ui {
 class AchievementGallery;
 }
 
+class AchievementListModel;
+class IconCache;
+
 /**
  * @class AchievementGallery
  * @brief 成就陈列室，网格展示已获得与锁定的徽章。
- * 中文说明：使用滚动网格布局，支持懒加载和实时解锁高亮。
+ * 中文说明：IconMode 的 QListView 配合 AchievementListModel 与 AchievementCardDelegate，
+ *          卡片由委托绘制、只绘制可见部分；解锁与进度变化只刷新对应的行。
  */
 class AchievementGallery : public QWidget {
     Q_OBJECT
 
 public:
-    AchievementGallery(rove::data::AchievementManager& manager, QWidget* parent = nullptr);
+    AchievementGallery(rove::data::AchievementManager& manager, IconCache& icons, QWidget* parent = nullptr);
     ~AchievementGallery() override;
 
 public slots:
@@ -29,18 +32,26 @@ public slots:
      */
     void reload();
 
+    /**
+     * @brief 只刷新给定成就对应的卡片，供变更总线合并后的增量通知使用。
+     */
+    void updateAchievements(const QSet<int>& achievementIds);
+
+    /**
+     * @brief 显示加载占位，等待启动装载完成后由 reload() 替换。
+     */
+    void showLoading();
+
 private:
     /**
-     * @brief 创建单个成就卡片控件。
-     * @param achievement 业务成就数据。
-     * @return QWidget* 卡片。
+     * @brief 列表为空时显示提示文字，否则显示列表。
      */
-    QWidget* createCard(const rove::data::Achievement& achievement);
+    void updatePlaceholder();
 
     std::unique_ptr<Ui::AchievementGallery> ui;
     rove::data::AchievementManager& m_manager;
-    QGridLayout* m_grid{nullptr};
+    AchievementListModel* m_model{nullptr};  //!< 由本控件持有。
+    bool m_loaded{false};  //!< 首次 reload 之前的增量通知直接忽略，装载完成时整体读取。
 };
 
 #endif  // ACHIEVEMENTGALLERY_H
-
@@ -0,0 +1,113 @@
+#include "AchievementListModel.h"
+
+#include "IconCache.h"
+
+AchievementListModel::AchievementListModel(rove::data::AchievementManager& manager, IconCache& icons, QObject* parent)
+    : QAbstractListModel(parent), m_manager(manager), m_icons(icons) {
+    connect(&m_icons, &IconCache::iconReady, this, &AchievementListModel::onIconReady);
+}
+
+int AchievementListModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_cards.size());
+}
+
+QVariant AchievementListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(m_cards.size())) {
+        return {};
+    }
+    const Card& card = m_cards[static_cast<std::size_t>(index.row())];
+    switch (role) {
+    case Qt::DisplayRole:
+        return card.name;
+    case Qt::DecorationRole:
+        return card.iconPath.isEmpty() ? QVariant()
+                                       : QVariant(m_icons.icon(card.iconPath, QSize(kIconExtent, kIconExtent)));
+    case Qt::ToolTipRole:
+    case DescriptionRole:
+        return card.description;
+    case UnlockedRole:
+        return card.unlocked;
+    case ProgressBasedRole:
+        return card.progressBased;
+    case ProgressPercentRole:
+        return card.progressPercent;
+    default:
+        return {};
+    }
+}
+
+void AchievementListModel::reload() {
+    const auto all = m_manager.snapshot();
+    beginResetModel();
+    m_cards.clear();
+    m_cards.reserve(all->items.size());
+    for (const auto& achievement : all->items) {
+        m_cards.push_back(toCard(*achievement));
+    }
+    rebuildRowIndex();
+    endResetModel();
+}
+
+/**
+ * @brief 逐个替换受影响的行；删除行时行号整体前移，因此最后重建索引。
+ */
+void AchievementListModel::refreshAchievements(const QSet<int>& achievementIds) {
+    for (int id : achievementIds) {
+        const auto achievement = m_manager.achievementById(id);
+        const auto found = m_rowById.constFind(id);
+        if (found == m_rowById.constEnd()) {
+            if (!achievement) {
+                continue;
+            }
+            const int row = static_cast<int>(m_cards.size());
+            beginInsertRows(QModelIndex(), row, row);
+            m_cards.push_back(toCard(*achievement));
+            m_rowById.insert(id, row);
+            endInsertRows();
+            continue;
+        }
+        const int row = found.value();
+        if (!achievement) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_cards.erase(m_cards.begin() + row);
+            rebuildRowIndex();
+            endRemoveRows();
+            continue;
+        }
+        m_cards[static_cast<std::size_t>(row)] = toCard(*achievement);
+        const QModelIndex changed = index(row);
+        emit dataChanged(changed, changed);
+    }
+}
+
+AchievementListModel::Card AchievementListModel::toCard(const rove::data::Achievement& achievement) {
+    Card card;
+    card.id = achievement.id();
+    card.name = QString::fromStdString(achievement.name());
+    card.description = QString::fromStdString(achievement.description());
+    card.iconPath = QString::fromStdString(achievement.iconPath());
+    card.unlocked = achievement.unlocked();
+    card.progressBased = achievement.isProgressBased();
+    card.progressPercent = achievement.progressPercent();
+    return card;
+}
+
+void AchievementListModel::rebuildRowIndex() {
+    m_rowById.clear();
+    m_rowById.reserve(static_cast<int>(m_cards.size()));
+    for (std::size_t row = 0; row < m_cards.size(); ++row) {
+        m_rowById.insert(m_cards[row].id, static_cast<int>(row));
+    }
+}
+
+void AchievementListModel::onIconReady(const QString& path, const QSize& size) {
+    if (size != QSize(kIconExtent, kIconExtent)) {
+        return;
+    }
+    for (std::size_t row = 0; row < m_cards.size(); ++row) {
+        if (m_cards[row].iconPath == path) {
+            const QModelIndex changed = index(static_cast<int>(row));
+            emit dataChanged(changed, changed, {Qt::DecorationRole});
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef ACHIEVEMENTLISTMODEL_H
+#define ACHIEVEMENTLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <vector>
+#include "../core/AchievementManager.h"
+
+class IconCache;
+
+/**
+ * @class AchievementListModel
+ * @brief 成就陈列室的列表模型，每行是一张卡片所需的已格式化字段。
+ * 中文说明：reload 只在装载完成时整表重置；成就解锁或进度变化经 refreshAchievements 只替换对应行并发出
+ *          dataChanged。图标取自共享的 IconCache，未就绪时先显示占位图，iconReady 后只通知引用该路径的行。
+ */
+class AchievementListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Role {
+        DescriptionRole = Qt::UserRole + 1,
+        UnlockedRole,
+        ProgressBasedRole,
+        ProgressPercentRole,
+    };
+
+    static constexpr int kIconExtent = 48;  //!< 卡片图标边长（像素）
+
+    AchievementListModel(rove::data::AchievementManager& manager, IconCache& icons, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief 从管理器重新读取全部成就并重置模型。
+     */
+    void reload();
+
+    /**
+     * @brief 只刷新给定成就所在的行；新出现的成就追加到末尾，已删除的成就移除。
+     */
+    void refreshAchievements(const QSet<int>& achievementIds);
+
+private:
+    /**
+     * @brief 一张卡片的展示字段，构造时一次性转换为 QString，绘制时不再做编码转换。
+     */
+    struct Card {
+        int id = -1;
+        QString name;
+        QString description;
+        QString iconPath;
+        bool unlocked = false;
+        bool progressBased = false;
+        int progressPercent = 0;
+    };
+
+    static Card toCard(const rove::data::Achievement& achievement);
+    void rebuildRowIndex();
+
+    void onIconReady(const QString& path, const QSize& size);
+
+    rove::data::AchievementManager& m_manager;
+    std::vector<Card> m_cards;
+    IconCache& m_icons;
+    QHash<int, int> m_rowById;  //!< 成就 ID -> 行号
+};
+
+#endif  // ACHIEVEMENTLISTMODEL_H
@@ -0,0 +1,84 @@
+#include "ChangeBus.h"
+
+#include <QMetaObject>
+
+#include <utility>
+
+ChangeBus::ChangeBus(QObject* parent) : QObject(parent) {}
+
+void ChangeBus::postTaskChanged(int taskId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dirtyTasks.insert(taskId);
+    schedule();
+}
+
+void ChangeBus::postUserChanged() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_userDirty = true;
+    schedule();
+}
+
+void ChangeBus::postAchievementChanged(int achievementId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dirtyAchievements.insert(achievementId);
+    schedule();
+}
+
+void ChangeBus::postShopChanged() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shopDirty = true;
+    schedule();
+}
+
+void ChangeBus::postSnapshotAdded() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_snapshotsDirty = true;
+    schedule();
+}
+
+/**
+ * @brief 调用方持有 m_mutex；排队连接保证 flush 在总线所在线程执行，即使 post 来自数据线程。
+ */
+void ChangeBus::schedule() {
+    if (m_flushQueued) {
+        return;
+    }
+    m_flushQueued = true;
+    QMetaObject::invokeMethod(this, &ChangeBus::flush, Qt::QueuedConnection);
+}
+
+/**
+ * @brief 先取出状态再派发，订阅者在槽中产生的新变更会排到下一个周期。
+ */
+void ChangeBus::flush() {
+    QSet<int> tasks;
+    QSet<int> achievements;
+    bool user = false;
+    bool shop = false;
+    bool snapshots = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_flushQueued = false;
+        tasks = std::exchange(m_dirtyTasks, {});
+        achievements = std::exchange(m_dirtyAchievements, {});
+        user = std::exchange(m_userDirty, false);
+        shop = std::exchange(m_shopDirty, false);
+        snapshots = std::exchange(m_snapshotsDirty, false);
+    }
+
+    if (user) {
+        emit userDirty();
+    }
+    if (!tasks.isEmpty()) {
+        emit tasksDirty(tasks);
+    }
+    if (!achievements.isEmpty()) {
+        emit achievementsDirty(achievements);
+    }
+    if (shop) {
+        emit shopDirty();
+    }
+    if (snapshots) {
+        emit snapshotsDirty();
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef CHANGEBUS_H
+#define CHANGEBUS_H
+
+#include <QObject>
+#include <QSet>
+
+#include <mutex>
+
+/**
+ * @class ChangeBus
+ * @brief 界面变更通知总线，收集带类型的增量并在每个事件循环周期合并派发一次。
+ * 中文说明：业务信号只标记“哪一块脏了”，各界面组件仅订阅自己展示的区域；
+ *          同一周期内的多次变更（例如完成任务同时触发金币、等级、成就变化）只会触发一次重绘。
+ *          post* 可在任意线程调用（数据线程上的进度信号直连到这里），信号总在总线所在线程发出。
+ */
+class ChangeBus : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ChangeBus(QObject* parent = nullptr);
+
+    /**
+     * @brief 标记指定任务已变化（完成、进度、重置）。
+     */
+    void postTaskChanged(int taskId);
+
+    /**
+     * @brief 标记用户数值（金币、等级、属性）已变化。
+     */
+    void postUserChanged();
+
+    /**
+     * @brief 标记指定成就的进度或解锁状态已变化。
+     */
+    void postAchievementChanged(int achievementId);
+
+    /**
+     * @brief 标记商店库存已变化。
+     */
+    void postShopChanged();
+
+    /**
+     * @brief 标记新增了成长快照。
+     */
+    void postSnapshotAdded();
+
+signals:
+    /**
+     * @brief 合并后的任务变更集合。
+     */
+    void tasksDirty(const QSet<int>& taskIds);
+
+    void userDirty();
+
+    /**
+     * @brief 合并后的成就变更集合。
+     */
+    void achievementsDirty(const QSet<int>& achievementIds);
+
+    void shopDirty();
+    void snapshotsDirty();
+
+private:
+    /**
+     * @brief 本周期首次变更时排队一次 flush；调用方持有 m_mutex。
+     */
+    void schedule();
+
+    /**
+     * @brief 派发并清空本周期累积的脏区域。
+     */
+    void flush();
+
+    std::mutex m_mutex;  //!< 保护下列成员，post* 可能来自数据线程
+    QSet<int> m_dirtyTasks;
+    QSet<int> m_dirtyAchievements;
+    bool m_userDirty{false};
+    bool m_shopDirty{false};
+    bool m_snapshotsDirty{false};
+    bool m_flushQueued{false};
+};
+
+#endif  // CHANGEBUS_H
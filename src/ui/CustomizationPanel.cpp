@@ -58,8 +58,8 @@ void CustomizationPanel::onCreateTaskClicked() {
 /**
  * @brief 创建自定义成就，带有最小化的输入校验与默认模板。
  * 中文：AchievementManager 要求至少存在一条条件，否则会抛出运行时异常导致应用退出。
- *       因此这里主动解析“条件”文本，生成一个可用的 CustomCounter 条件并捕获异常，
- *       以提示方式反馈给学生。
+ *       因此这里主动解析“条件”文本，生成一个可用的 CustomCounter 条件（"rule:" 前缀时为规则条件）
+ *       并捕获异常，以提示方式反馈给学生，规则语法错误也经此提示。
  */
 void CustomizationPanel::onCreateAchievementClicked() {
     const QString name = ui->achNameEdit->text().trimmed();
@@ -88,6 +88,11 @@ void CustomizationPanel::onCreateAchievementClicked() {
     condition.targetValue = targetValue;
     condition.currentValue = 0;
     condition.metadata = condText.toStdString();
+    // 以 "rule:" 开头的条件按成就规则编译（语法见 AchievementRule.h），目标值由规则决定。
+    if (condText.startsWith(QStringLiteral("rule:"), Qt::CaseInsensitive)) {
+        condition.type = rove::data::Achievement::Condition::ConditionType::Rule;
+        condition.metadata = condText.mid(5).trimmed().toStdString();
+    }
 
     rove::data::Achievement achievement;
     achievement.setName(name.toStdString());
@@ -5,8 +5,11 @@
 #include <QtCharts/QSplineSeries>
 #include <QtCharts/QValueAxis>
 
+#include <QDateTime>
 #include <QVBoxLayout>
 
+#include "../core/Metrics.h"
+
 // Qt6 charts namespace handling
 namespace QtCharts {}
 using namespace QtCharts;
@@ -35,11 +38,28 @@ void DashboardWidget::renderUser(const rove::data::User& user) {
 }
 
 /**
- * @brief 更新最近活动列表。
+ * @brief 按缓冲内容重建最近活动列表。
  */
-void DashboardWidget::setRecentActivities(const QStringList& activities) {
+void DashboardWidget::setRecentActivities(const rove::data::ActivityRing& activities) {
     ui->activityList->clear();
-    ui->activityList->addItems(activities);
+    for (std::size_t i = 0; i < activities.size(); ++i) {
+        ui->activityList->addItem(activityText(activities.at(i)));
+    }
+}
+
+/**
+ * @brief 逐行增删，列表行数与缓冲容量一致，不整表重建。
+ */
+void DashboardWidget::prependActivity(const rove::data::ActivityEvent& event, bool evictOldest) {
+    if (evictOldest && ui->activityList->count() > 0) {
+        delete ui->activityList->takeItem(ui->activityList->count() - 1);
+    }
+    ui->activityList->insertItem(0, activityText(event));
+}
+
+QString DashboardWidget::activityText(const rove::data::ActivityEvent& event) {
+    return QDateTime::fromMSecsSinceEpoch(event.timestampMs).toString(QStringLiteral("MM-dd HH:mm  ")) +
+           QString::fromStdString(event.text);
 }
 
 /**
@@ -71,6 +91,7 @@ void DashboardWidget::buildRadarChart() {
  * @brief 更新雷达图数据集。
  */
 void DashboardWidget::updateRadar(const rove::data::User::AttributeSet& attrs) {
+    ROVE_SCOPED_TIMER(Charts, "DashboardWidget::updateRadar");
     auto series = new QSplineSeries();
     series->append(1, attrs.execution);
     series->append(2, attrs.perseverance);
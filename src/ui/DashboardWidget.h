@@ -8,6 +8,7 @@
 #include <QtCharts/QPolarChart>
 #include <QtCharts/QValueAxis>
 #include <memory>
+#include "../core/ActivityFeed.h"
 #include "../core/User.h"
 
 namespace Ui {
@@ -37,10 +38,15 @@ public:
     void renderUser(const rove::data::User& user);
 
     /**
-     * @brief 更新最近活动列表。
-     * @param activities 活动文本集合。
+     * @brief 按缓冲内容重建最近活动列表，只在会话切换等整体替换时调用。
+     * @param activities 近期动态，从新到旧排列。
      */
-    void setRecentActivities(const QStringList& activities);
+    void setRecentActivities(const rove::data::ActivityRing& activities);
+
+    /**
+     * @brief 在列表顶部插入一条动态；evictOldest 为 true 时同时移除最底部的一行。
+     */
+    void prependActivity(const rove::data::ActivityEvent& event, bool evictOldest);
 
 private:
     /**
@@ -54,6 +60,11 @@ private:
      */
     void updateRadar(const rove::data::User::AttributeSet& attrs);
 
+    /**
+     * @brief 动态的展示文本：发生时刻加描述。
+     */
+    static QString activityText(const rove::data::ActivityEvent& event);
+
     std::unique_ptr<Ui::DashboardWidget> ui;
     QPolarChart* m_polarChart{nullptr};
     QChartView* m_chartView{nullptr};
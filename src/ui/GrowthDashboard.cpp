@@ -5,8 +5,19 @@
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QSplineSeries>
 #include <QtCharts/QValueAxis>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QProgressDialog>
+#include <QPushButton>
+#include <QSaveFile>
 #include <QVBoxLayout>
 
+#include <algorithm>
+
+#include "../core/Metrics.h"
+
 // Qt6 charts namespace handling
 namespace QtCharts {}
 using namespace QtCharts;
@@ -14,47 +25,45 @@ using namespace QtCharts;
 GrowthDashboard::GrowthDashboard(rove::GrowthVisualizer& visualizer, QWidget* parent)
     : QWidget(parent), ui(std::make_unique<Ui::GrowthDashboard>()), m_visualizer(visualizer) {
     ui->setupUi(this);
-    m_radarView = new QChartView(new QChart(), this);
-    ui->radarLayout->addWidget(m_radarView);
-
-    m_lineView = new QChartView(new QChart(), this);
-    ui->timelineLayout->addWidget(m_lineView);
+    setupRadarChart();
+    setupTimelineChart();
+    setupScrubber();
+    setupExport();
+    // 中文：图表对象本身大小固定，随数据增长的是点缓冲与序列中的点；超额时释放可在下次刷新重建的点缓冲。
+    m_memoryRegistration = rove::metrics::MemoryRegistry::instance().add(
+        "charts",
+        [this]() {
+            const auto points = static_cast<std::size_t>(m_timelineSeries->count() + m_radarSeries->count());
+            return rove::metrics::MemoryUsage{
+                (static_cast<std::size_t>(m_timelinePoints.capacity()) + points) * sizeof(QPointF), points};
+        },
+        [this]() { m_timelinePoints = QList<QPointF>(); });
 }
 
 GrowthDashboard::~GrowthDashboard() = default;
 
-void GrowthDashboard::render(const rove::data::User& user,
-                             const std::vector<rove::data::GrowthSnapshot>& snapshots) {
+void GrowthDashboard::render(const rove::data::User& user, const rove::data::SnapshotSeries& series) {
     updateRadar(user.attributes());
-    buildTimeline(snapshots);
+    buildTimeline(series);
 }
 
-/**
- * @brief 绘制成长时间线，使用折线图展示成长值趋势。
- */
-void GrowthDashboard::buildTimeline(const std::vector<rove::data::GrowthSnapshot>& snapshots) {
+void GrowthDashboard::setupTimelineChart() {
     auto* chart = new QChart();
-    auto* series = new QLineSeries(chart);
-    int index = 0;
-    for (const auto& snap : snapshots) {
-        series->append(index++, snap.growthPoints());
-    }
-    chart->addSeries(series);
-    auto* axisX = new QValueAxis();
-    axisX->setTitleText(QStringLiteral("时间"));
-    chart->addAxis(axisX, Qt::AlignBottom);
-    auto* axisY = new QValueAxis();
-    axisY->setTitleText(QStringLiteral("成长"));
-    chart->addAxis(axisY, Qt::AlignLeft);
-    series->attachAxis(axisX);
-    series->attachAxis(axisY);
-    m_lineView->setChart(chart);
+    m_timelineSeries = new QLineSeries(chart);
+    chart->addSeries(m_timelineSeries);
+    m_timelineAxisX = new QValueAxis();
+    m_timelineAxisX->setTitleText(QStringLiteral("时间"));
+    chart->addAxis(m_timelineAxisX, Qt::AlignBottom);
+    m_timelineAxisY = new QValueAxis();
+    m_timelineAxisY->setTitleText(QStringLiteral("成长"));
+    chart->addAxis(m_timelineAxisY, Qt::AlignLeft);
+    m_timelineSeries->attachAxis(m_timelineAxisX);
+    m_timelineSeries->attachAxis(m_timelineAxisY);
+    m_lineView = new QChartView(chart, this);
+    ui->timelineLayout->addWidget(m_lineView);
 }
 
-/**
- * @brief 使用 GrowthVisualizer 输出的属性集更新雷达图。
- */
-void GrowthDashboard::updateRadar(const rove::data::User::AttributeSet& attrs) {
+void GrowthDashboard::setupRadarChart() {
     auto* chart = new QPolarChart();
     auto* radial = new QValueAxis();
     radial->setRange(0, 100);
@@ -68,19 +77,163 @@ void GrowthDashboard::updateRadar(const rove::data::User::AttributeSet& attrs) {
     angular->append(QStringLiteral("自豪"), 6);
     chart->addAxis(angular, QPolarChart::PolarOrientationAngular);
 
-    auto* series = new QSplineSeries(chart);
-    series->append(1, attrs.execution);
-    series->append(2, attrs.perseverance);
-    series->append(3, attrs.decision);
-    series->append(4, attrs.knowledge);
-    series->append(5, attrs.social);
-    series->append(6, attrs.pride);
-    chart->addSeries(series);
-    series->attachAxis(radial);
-    series->attachAxis(angular);
-
-    m_radarView->setChart(chart);
+    m_radarSeries = new QSplineSeries(chart);
+    chart->addSeries(m_radarSeries);
+    m_radarSeries->attachAxis(radial);
+    m_radarSeries->attachAxis(angular);
+    m_radarView = new QChartView(chart, this);
+    ui->radarLayout->addWidget(m_radarView);
+}
+
+/**
+ * @brief 滑块关闭跟踪，只在松开或键盘步进时发出一次 valueChanged，拖动过程中不查询数据库。
+ */
+void GrowthDashboard::setupScrubber() {
+    constexpr int kScrubSteps = 1000;
+    m_scrubber = new QSlider(Qt::Horizontal, this);
+    m_scrubber->setRange(0, kScrubSteps);
+    m_scrubber->setValue(kScrubSteps);
+    m_scrubber->setTracking(false);
+    m_scrubber->setEnabled(false);
+    m_scrubLabel = new QLabel(this);
+    m_insightsLabel = new QLabel(this);
+    ui->timelineLayout->addWidget(m_scrubber);
+    ui->timelineLayout->addWidget(m_scrubLabel);
+    ui->timelineLayout->addWidget(m_insightsLabel);
+    connect(m_scrubber, &QSlider::valueChanged, this, [this](int value) {
+        const qint64 span = m_scrubEndMs - m_scrubStartMs;
+        emit scrubRequested(m_scrubStartMs + span * value / m_scrubber->maximum());
+    });
+}
+
+void GrowthDashboard::setupExport() {
+    auto* row = new QHBoxLayout();
+    auto* button = new QPushButton(QStringLiteral("导出数据"), this);
+    m_exportLabel = new QLabel(this);
+    row->addWidget(button);
+    row->addWidget(m_exportLabel, 1);
+    ui->timelineLayout->addLayout(row);
+    connect(button, &QPushButton::clicked, this, [this]() {
+        const QString csvFilter = QStringLiteral("CSV (*.csv)");
+        QString selected = csvFilter;
+        const QString path = QFileDialog::getSaveFileName(
+            this, QStringLiteral("导出成长数据"), QStringLiteral("growth.csv"),
+            csvFilter + QStringLiteral(";;") + QStringLiteral("列式二进制 (*.rvgs)"), &selected);
+        if (!path.isEmpty()) {
+            emit exportRequested(path, selected != csvFilter);
+        }
+    });
+}
+
+/**
+ * @brief 绘制成长时间线，使用折线图展示成长值趋势。
+ * 中文：图表、坐标轴与序列在构造时创建一次，这里只用 replace 整体替换数据并调整坐标范围。
+ *       纵轴范围取自成长值整列的 min/max，而不是逐个扫描降采样后的 QPointF。
+ */
+void GrowthDashboard::buildTimeline(const rove::data::SnapshotSeries& series) {
+    ROVE_SCOPED_TIMER(Charts, "GrowthDashboard::buildTimeline");
+    const auto& growth = series.column(rove::data::SnapshotColumn::Growth);
+    m_timelinePoints.clear();
+    m_timelinePoints.reserve(static_cast<int>(growth.size()));
+    int index = 0;
+    for (const std::int32_t value : growth) {
+        m_timelinePoints.append(QPointF(index++, value));
+    }
+    // 中文：折线最多保留约每像素一个点，时间跨度再长绘制成本也与视图宽度相当。
+    const int width = m_lineView != nullptr ? m_lineView->width() : 0;
+    const QList<QPointF> sampled = rove::GrowthVisualizer::downsampleLttb(
+        m_timelinePoints, width > 0 ? width : rove::GrowthVisualizer::kDefaultMaxChartPoints);
+    m_timelineSeries->setUseOpenGL(sampled.size() > rove::GrowthVisualizer::kOpenGlPointThreshold);
+    m_timelineSeries->replace(sampled);
+
+    qreal minY = 0.0;
+    qreal maxY = 1.0;
+    if (!series.empty()) {
+        const auto stats = series.stats(rove::data::SnapshotColumn::Growth);
+        minY = stats.min;
+        maxY = stats.max;
+    }
+    m_timelineAxisX->setRange(0, std::max(index - 1, 1));
+    m_timelineAxisY->setRange(minY, maxY > minY ? maxY : minY + 1.0);
+
+    m_scrubEndMs = QDateTime::currentMSecsSinceEpoch();
+    m_scrubStartMs = series.empty() ? m_scrubEndMs : series.timestamps().front();
+    m_scrubber->setEnabled(m_scrubEndMs > m_scrubStartMs);
+    if (m_scrubber->isSliderDown()) {
+        return;
+    }
+    const QSignalBlocker blocker(m_scrubber);
+    m_scrubber->setValue(m_scrubber->maximum());
+    m_scrubLabel->clear();
+}
+
+/**
+ * @brief 使用 GrowthVisualizer 输出的属性集更新雷达图。
+ */
+void GrowthDashboard::updateRadar(const rove::data::User::AttributeSet& attrs) {
+    ROVE_SCOPED_TIMER(Charts, "GrowthDashboard::updateRadar");
+    m_radarSeries->replace(QList<QPointF>{QPointF(1, attrs.execution),
+                                          QPointF(2, attrs.perseverance),
+                                          QPointF(3, attrs.decision),
+                                          QPointF(4, attrs.knowledge),
+                                          QPointF(5, attrs.social),
+                                          QPointF(6, attrs.pride)});
 }
 
+void GrowthDashboard::showStateAt(const rove::data::PointInTimeState& state) {
+    updateRadar(state.attributes);
+    m_scrubLabel->setText(QStringLiteral("%1 · 等级 %2 · 成长 %3 · 持有物品 %4 件")
+                              .arg(QDateTime::fromMSecsSinceEpoch(state.timestampMs)
+                                       .toString(QStringLiteral("yyyy-MM-dd HH:mm")))
+                              .arg(state.level)
+                              .arg(state.growthPoints)
+                              .arg(static_cast<int>(state.inventory.size())));
+}
 
+void GrowthDashboard::showInsights(const rove::data::GrowthAnalytics::Insights& insights) {
+    if (insights.days == 0) {
+        m_insightsLabel->clear();
+        return;
+    }
+    m_insightsLabel->setText(QStringLiteral("近 %1 天 · 日均成长 %2 · 每日增量中位数 %3 · 连续完成 %4 天（最长 %5 天）")
+                                 .arg(insights.days)
+                                 .arg(insights.growthVelocity, 0, 'f', 1)
+                                 .arg(insights.dailyGain.p50, 0, 'f', 1)
+                                 .arg(insights.currentStreak)
+                                 .arg(insights.longestStreak));
+}
 
+/**
+ * @brief 经 QSaveFile 写入，成功才替换目标文件；失败或取消时目标文件保持原样。
+ * 中文：进度回调每处理一批行更新一次对话框并处理事件，界面在大批量导出时保持响应。
+ */
+void GrowthDashboard::exportSnapshots(const std::vector<rove::data::GrowthSnapshot>& snapshots,
+                                      const QString& path,
+                                      bool columnar) {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_exportLabel->setText(QStringLiteral("导出失败：%1").arg(file.errorString()));
+        return;
+    }
+    constexpr int kProgressSteps = 1000;
+    QProgressDialog dialog(QStringLiteral("正在导出成长数据…"), QStringLiteral("取消"), 0, kProgressSteps, this);
+    dialog.setWindowModality(Qt::WindowModal);
+    dialog.setMinimumDuration(500);
+    const auto progress = [&dialog](std::size_t done, std::size_t total) {
+        dialog.setValue(total == 0 ? kProgressSteps : static_cast<int>(done * kProgressSteps / total));
+        QCoreApplication::processEvents();
+        return !dialog.wasCanceled();
+    };
+    const bool written = columnar ? m_visualizer.exportColumnar(file, snapshots, progress)
+                                  : m_visualizer.exportCsv(file, snapshots, progress);
+    if (dialog.wasCanceled()) {
+        file.cancelWriting();
+        m_exportLabel->setText(QStringLiteral("导出已取消"));
+        return;
+    }
+    if (!written || !file.commit()) {
+        m_exportLabel->setText(QStringLiteral("导出失败：%1").arg(file.errorString()));
+        return;
+    }
+    m_exportLabel->setText(QStringLiteral("已导出 %1 条到 %2").arg(static_cast<qulonglong>(snapshots.size())).arg(path));
+}
@@ -1,13 +1,21 @@
 #ifndef GROWTHDASHBOARD_H
 #define GROWTHDASHBOARD_H
 
+#include <QLabel>
+#include <QSlider>
 #include <QWidget>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
+#include <QtCharts/QSplineSeries>
 #include <QtCharts/QValueAxis>
 #include <memory>
+#include <vector>
+#include "../core/GrowthAnalytics.h"
 #include "../core/GrowthSnapshot.h"
 #include "../core/GrowthVisualizer.h"
+#include "../core/MemoryAccounting.h"
+#include "../core/SnapshotSeries.h"
+#include "../core/StateHistory.h"
 #include "../core/User.h"
 
 namespace Ui {
@@ -30,25 +38,84 @@ public slots:
     /**
      * @brief 渲染指定用户的成长趋势。
      * @param user 用户实体。
-     * @param snapshots 历史快照列表。
+     * @param series 列式成长时间线。
      */
-    void render(const rove::data::User& user, const std::vector<rove::data::GrowthSnapshot>& snapshots);
+    void render(const rove::data::User& user, const rove::data::SnapshotSeries& series);
 
-private:
     /**
-     * @brief 构建折线图表并调整坐标轴。
+     * @brief 原地更新折线序列与坐标轴范围，仅在快照变化时调用。
      */
-    void buildTimeline(const std::vector<rove::data::GrowthSnapshot>& snapshots);
+    void buildTimeline(const rove::data::SnapshotSeries& series);
 
     /**
-     * @brief 更新雷达图数据。
+     * @brief 更新雷达图数据，属性变化时无需重建折线图。
      */
     void updateRadar(const rove::data::User::AttributeSet& attrs);
 
+    /**
+     * @brief 展示时间轴拖动到的历史时刻：雷达图改为当时的属性，说明行显示等级、成长值与持有物品数。
+     */
+    void showStateAt(const rove::data::PointInTimeState& state);
+
+    /**
+     * @brief 在时间线下方显示近期成长趋势：日均成长速度、每日增量的中位数与当前连续完成天数。
+     */
+    void showInsights(const rove::data::GrowthAnalytics::Insights& insights);
+
+    /**
+     * @brief 把快照导出到 path：先写临时文件，完成后整体替换；导出期间显示可取消的进度对话框。
+     * @param columnar true 时使用列式二进制格式，否则为 CSV。
+     */
+    void exportSnapshots(const std::vector<rove::data::GrowthSnapshot>& snapshots, const QString& path, bool columnar);
+
+signals:
+    /**
+     * @brief 时间轴松开时发出，timestampMs 为滑块位置对应的时刻；由持有 LogManager 的一方重建状态后回调 showStateAt。
+     */
+    void scrubRequested(qint64 timestampMs);
+
+    /**
+     * @brief 用户选定导出文件后发出；由持有 LogManager 的一方读取快照后回调 exportSnapshots。
+     */
+    void exportRequested(const QString& path, bool columnar);
+
+private:
+    /**
+     * @brief 创建常驻的时间线图表；之后的刷新只替换序列数据，不再分配图表对象。
+     */
+    void setupTimelineChart();
+
+    /**
+     * @brief 创建常驻的雷达图表。
+     */
+    void setupRadarChart();
+
+    /**
+     * @brief 在折线图下方创建时间轴滑块与说明行。
+     */
+    void setupScrubber();
+
+    /**
+     * @brief 在说明行下方创建导出按钮：弹出保存对话框，按所选文件类型决定 CSV 或列式格式。
+     */
+    void setupExport();
+
     std::unique_ptr<Ui::GrowthDashboard> ui;
     rove::GrowthVisualizer& m_visualizer;
     QChartView* m_lineView{nullptr};
     QChartView* m_radarView{nullptr};
+    QLineSeries* m_timelineSeries{nullptr};   //!< 由图表持有。
+    QValueAxis* m_timelineAxisX{nullptr};
+    QValueAxis* m_timelineAxisY{nullptr};
+    QSplineSeries* m_radarSeries{nullptr};    //!< 由图表持有。
+    QList<QPointF> m_timelinePoints;          //!< 复用的点缓冲，避免每次刷新重新分配。
+    QSlider* m_scrubber{nullptr};
+    QLabel* m_scrubLabel{nullptr};
+    QLabel* m_insightsLabel{nullptr};
+    QLabel* m_exportLabel{nullptr};
+    qint64 m_scrubStartMs{0};                 //!< 滑块最左端对应的时刻：时间线首个快照
+    qint64 m_scrubEndMs{0};                   //!< 滑块最右端对应的时刻：最近一次重建时间线的时刻
+    rove::metrics::MemoryRegistration m_memoryRegistration;  //!< "charts"：折线点缓冲与图表序列
 };
 
 #endif  // GROWTHDASHBOARD_H
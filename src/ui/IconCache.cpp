@@ -0,0 +1,148 @@
+#include "IconCache.h"
+
+#include <QColor>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+constexpr int kDecodeThreads = 2;  // 中文：解码是 I/O 与 CPU 混合负载，两个线程足以跟上滚动，不与数据库线程争抢。
+const QColor kPlaceholderColor(0xdd, 0xdd, 0xdd);
+}  // namespace
+
+IconCache::IconCache(qint64 budgetBytes, QObject* parent) : QObject(parent), m_budgetBytes(budgetBytes) {
+    m_pool.setMaxThreadCount(kDecodeThreads);
+    const QString cacheRoot = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!cacheRoot.isEmpty()) {
+        const QString dir = cacheRoot + QStringLiteral("/thumbnails");
+        if (QDir().mkpath(dir)) {
+            m_thumbnailDir = dir;
+        }
+    }
+}
+
+/**
+ * 中文：先丢弃排队中的解码并等待正在执行的任务结束；任务投递给本对象的回调会随对象销毁被 Qt 丢弃。
+ */
+IconCache::~IconCache() {
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QPixmap IconCache::icon(const QString& path, const QSize& size) {
+    if (path.isEmpty()) {
+        return placeholder(size);
+    }
+    const QString key = cacheKey(path, size);
+    const auto found = m_entries.find(key);
+    if (found != m_entries.end()) {
+        m_recency.splice(m_recency.begin(), m_recency, found->recency);
+        return found->pixmap.isNull() ? placeholder(size) : found->pixmap;
+    }
+    if (!m_pending.contains(key)) {
+        m_pending.insert(key);
+        const QString thumbnailDir = m_thumbnailDir;
+        m_pool.start([this, path, size, thumbnailDir]() {
+            const QImage image = loadScaled(path, size, thumbnailDir);
+            QMetaObject::invokeMethod(
+                this, [this, path, size, image]() { onDecoded(path, size, image); }, Qt::QueuedConnection);
+        });
+    }
+    return placeholder(size);
+}
+
+QString IconCache::cacheKey(const QString& path, const QSize& size) {
+    return QStringLiteral("%1x%2:%3").arg(size.width()).arg(size.height()).arg(path);
+}
+
+/**
+ * @brief 工作线程：按 (路径, 修改时间, 尺寸) 查磁盘缩略图，未命中时解码原图并缩放，再原子地写回缩略图。
+ * 中文：源文件被替换后修改时间变化，旧缩略图自然失效；源文件不存在或无法解码时返回空图。
+ */
+QImage IconCache::loadScaled(const QString& path, const QSize& size, const QString& thumbnailDir) {
+    const QFileInfo source(path);
+    if (!source.exists()) {
+        return {};
+    }
+    QString thumbnailPath;
+    if (!thumbnailDir.isEmpty()) {
+        const QByteArray digest = QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Sha1).toHex();
+        thumbnailPath = QStringLiteral("%1/%2_%3_%4x%5.png")
+                            .arg(thumbnailDir, QString::fromLatin1(digest))
+                            .arg(source.lastModified().toMSecsSinceEpoch())
+                            .arg(size.width())
+                            .arg(size.height());
+        QImage cached(thumbnailPath);
+        if (!cached.isNull()) {
+            return cached;
+        }
+    }
+
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+    const QSize original = reader.size();
+    if (original.isValid()) {
+        reader.setScaledSize(original.scaled(size, Qt::KeepAspectRatio));
+    }
+    QImage image = reader.read();
+    if (image.isNull()) {
+        return {};
+    }
+    if (image.width() > size.width() || image.height() > size.height()) {
+        image = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);  // 中文：读取器不支持缩放解码时补做。
+    }
+    if (!thumbnailPath.isEmpty()) {
+        QSaveFile file(thumbnailPath);
+        if (file.open(QIODevice::WriteOnly) && image.save(&file, "PNG")) {
+            static_cast<void>(file.commit());
+        }
+    }
+    return image;
+}
+
+QPixmap IconCache::placeholder(const QSize& size) {
+    const QString key = QStringLiteral("%1x%2").arg(size.width()).arg(size.height());
+    auto found = m_placeholders.find(key);
+    if (found == m_placeholders.end()) {
+        QPixmap pixmap(size);
+        pixmap.fill(kPlaceholderColor);
+        found = m_placeholders.insert(key, pixmap);
+    }
+    return found.value();
+}
+
+void IconCache::onDecoded(const QString& path, const QSize& size, const QImage& image) {
+    const QString key = cacheKey(path, size);
+    m_pending.remove(key);
+    insert(key, image.isNull() ? QPixmap() : QPixmap::fromImage(image));
+    emit iconReady(path, size);
+}
+
+void IconCache::insert(const QString& key, const QPixmap& pixmap) {
+    Entry entry;
+    entry.pixmap = pixmap;
+    entry.cost = pixmap.isNull() ? 0 : static_cast<qint64>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    m_recency.push_front(key);
+    entry.recency = m_recency.begin();
+    m_usedBytes += entry.cost;
+    m_entries.insert(key, entry);
+    evictToBudget();
+}
+
+/**
+ * @brief 从最久未使用的一端淘汰，直到回到预算以内；刚插入的条目总是保留。
+ */
+void IconCache::evictToBudget() {
+    while (m_usedBytes > m_budgetBytes && m_recency.size() > 1) {
+        const auto found = m_entries.find(m_recency.back());
+        if (found != m_entries.end()) {
+            m_usedBytes -= found->cost;
+            m_entries.erase(found);
+        }
+        m_recency.pop_back();
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef ICONCACHE_H
+#define ICONCACHE_H
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+#include <list>
+
+/**
+ * @class IconCache
+ * @brief 商店与成就陈列室共用的图标缓存：后台解码缩放、按字节预算 LRU 淘汰、磁盘缩略图复用。
+ * 中文说明：icon() 立即返回已缓存的图标或占位图，未命中时把解码交给自有线程池；解码结果先查磁盘缩略图
+ *          （以源路径、修改时间与目标尺寸为键），未命中才读取原图并缩放，再写回缩略图。
+ *          QImage 在工作线程生成，回到 GUI 线程转为 QPixmap 后入缓存并发出 iconReady，视图据此只刷新引用该路径的项。
+ *          只在 GUI 线程调用。
+ */
+class IconCache : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr qint64 kDefaultBudgetBytes = 16LL * 1024 * 1024;
+
+    explicit IconCache(qint64 budgetBytes = kDefaultBudgetBytes, QObject* parent = nullptr);
+    ~IconCache() override;
+
+    IconCache(const IconCache&) = delete;
+    IconCache& operator=(const IconCache&) = delete;
+
+    /**
+     * @brief 取 path 缩放到 size 以内的图标；未就绪时返回同尺寸占位图并在后台加载，完成后发出 iconReady。
+     * 中文：加载失败的路径缓存为占位图，不会反复重试；路径为空时直接返回占位图。
+     */
+    [[nodiscard]] QPixmap icon(const QString& path, const QSize& size);
+
+    [[nodiscard]] qint64 usedBytes() const noexcept { return m_usedBytes; }
+
+signals:
+    void iconReady(const QString& path, const QSize& size);
+
+private:
+    struct Entry {
+        QPixmap pixmap;
+        qint64 cost = 0;
+        std::list<QString>::iterator recency;  //!< 在 m_recency 中的位置，越靠前越近期使用
+    };
+
+    static QString cacheKey(const QString& path, const QSize& size);
+    static QImage loadScaled(const QString& path, const QSize& size, const QString& thumbnailDir);
+    QPixmap placeholder(const QSize& size);
+    void onDecoded(const QString& path, const QSize& size, const QImage& image);
+    void insert(const QString& key, const QPixmap& pixmap);
+    void evictToBudget();
+
+    qint64 m_budgetBytes;
+    qint64 m_usedBytes{0};
+    QHash<QString, Entry> m_entries;
+    std::list<QString> m_recency;
+    QSet<QString> m_pending;                //!< 已提交、尚未返回的键
+    QHash<QString, QPixmap> m_placeholders;  //!< 按尺寸缓存的占位图，不计入预算
+    QString m_thumbnailDir;                 //!< 为空表示无可写缓存目录，仅使用内存缓存
+    QThreadPool m_pool;
+};
+
+#endif  // ICONCACHE_H
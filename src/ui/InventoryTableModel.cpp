@@ -0,0 +1,168 @@
+#include "InventoryTableModel.h"
+
+#include <algorithm>
+
+namespace {
+/**
+ * @brief 行按 id 降序排列时的比较器，供 lower_bound 定位。
+ */
+struct IdDescending {
+    template <typename Row>
+    bool operator()(const Row& row, int inventoryId) const {
+        return row.item.id() > inventoryId;
+    }
+};
+}  // namespace
+
+InventoryTableModel::InventoryTableModel(rove::data::InventoryManager& inventoryManager,
+                                         rove::data::ShopManager& shopManager,
+                                         rove::data::UserManager& userManager,
+                                         QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_inventoryManager(inventoryManager)
+    , m_shopManager(shopManager)
+    , m_userManager(userManager) {
+    // 中文：排队连接保证在购买事务结束后才回读，回滚的插入不会出现在表中。
+    auto* proxy = m_inventoryManager.signalProxy();
+    connect(proxy, &rove::data::InventoryManagerSignalProxy::inventoryInserted, this,
+            &InventoryTableModel::onInserted, Qt::QueuedConnection);
+    connect(proxy, &rove::data::InventoryManagerSignalProxy::inventoryUpdated, this,
+            &InventoryTableModel::onUpdated, Qt::QueuedConnection);
+    connect(proxy, &rove::data::InventoryManagerSignalProxy::inventoryRemoved, this,
+            &InventoryTableModel::onRemoved, Qt::QueuedConnection);
+}
+
+int InventoryTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int InventoryTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant InventoryTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole || index.row() >= static_cast<int>(m_rows.size())) {
+        return {};
+    }
+    const Row& row = m_rows[static_cast<std::size_t>(index.row())];
+    switch (index.column()) {
+    case NameColumn:
+        return row.name;
+    case QuantityColumn:
+        return row.item.quantity() - row.item.usedQuantity();
+    case AttributesColumn:
+        return QString::fromStdString(row.item.specialAttributes());
+    default:
+        return {};
+    }
+}
+
+QVariant InventoryTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+    case NameColumn:
+        return QStringLiteral("名称");
+    case QuantityColumn:
+        return QStringLiteral("数量");
+    case AttributesColumn:
+        return QStringLiteral("属性");
+    default:
+        return {};
+    }
+}
+
+void InventoryTableModel::reload() {
+    const auto catalog = m_shopManager.catalog();
+    const int ownerId = m_userManager.activeUserId();
+    auto items = m_inventoryManager.listByOwner(ownerId);
+    std::sort(items.begin(), items.end(), [](const auto& lhs, const auto& rhs) { return lhs.id() > rhs.id(); });
+    beginResetModel();
+    m_rows.clear();
+    m_rows.reserve(items.size());
+    for (auto& item : items) {
+        const QString name = itemName(*catalog, item.itemId());
+        m_rows.push_back(Row{std::move(item), name});
+    }
+    m_ownerId = ownerId;
+    m_loaded = true;
+    endResetModel();
+}
+
+/**
+ * 中文说明：新库存 id 由数据库自增分配，通常大于所有已显示的 id，因此插入点几乎总在第 0 行；
+ *          仍按二分查找定位，保证乱序到达时的降序不变式。
+ */
+void InventoryTableModel::onInserted(int ownerId, const QVector<int>& inventoryIds) {
+    if (!m_loaded || ownerId != m_ownerId) {
+        return;
+    }
+    const auto catalog = m_shopManager.catalog();
+    for (int inventoryId : inventoryIds) {
+        if (rowOf(inventoryId) >= 0) {
+            continue;
+        }
+        auto item = m_inventoryManager.findById(inventoryId);
+        if (!item.has_value()) {
+            continue;
+        }
+        const auto pos = std::lower_bound(m_rows.begin(), m_rows.end(), inventoryId, IdDescending{});
+        const int row = static_cast<int>(pos - m_rows.begin());
+        const QString name = itemName(*catalog, item->itemId());
+        beginInsertRows(QModelIndex(), row, row);
+        m_rows.insert(pos, Row{std::move(*item), name});
+        endInsertRows();
+    }
+}
+
+void InventoryTableModel::onUpdated(const QVector<int>& inventoryIds) {
+    if (!m_loaded) {
+        return;
+    }
+    for (int inventoryId : inventoryIds) {
+        const int row = rowOf(inventoryId);
+        if (row < 0) {
+            continue;
+        }
+        auto item = m_inventoryManager.findById(inventoryId);
+        if (!item.has_value()) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_rows.erase(m_rows.begin() + row);
+            endRemoveRows();
+            continue;
+        }
+        m_rows[static_cast<std::size_t>(row)].item = std::move(*item);
+        emit dataChanged(index(row, QuantityColumn), index(row, AttributesColumn), {Qt::DisplayRole});
+    }
+}
+
+void InventoryTableModel::onRemoved(const QVector<int>& inventoryIds) {
+    if (!m_loaded) {
+        return;
+    }
+    for (int inventoryId : inventoryIds) {
+        const int row = rowOf(inventoryId);
+        if (row < 0) {
+            continue;
+        }
+        beginRemoveRows(QModelIndex(), row, row);
+        m_rows.erase(m_rows.begin() + row);
+        endRemoveRows();
+    }
+}
+
+int InventoryTableModel::rowOf(int inventoryId) const {
+    const auto pos = std::lower_bound(m_rows.begin(), m_rows.end(), inventoryId, IdDescending{});
+    if (pos == m_rows.end() || pos->item.id() != inventoryId) {
+        return -1;
+    }
+    return static_cast<int>(pos - m_rows.begin());
+}
+
+QString InventoryTableModel::itemName(const rove::data::ShopManager::Catalog& catalog, int itemId) {
+    if (const auto* entry = catalog.find(itemId)) {
+        return QString::fromStdString(entry->item.name());
+    }
+    return QStringLiteral("未知物品");
+}
@@ -0,0 +1,80 @@
+#ifndef INVENTORYTABLEMODEL_H
+#define INVENTORYTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QString>
+#include <QVector>
+#include <vector>
+#include "../core/InventoryManager.h"
+#include "../core/ShopManager.h"
+#include "../core/UserManager.h"
+
+/**
+ * @class InventoryTableModel
+ * @brief 当前用户的背包表格模型，按库存变更信号增量更新。
+ * 中文说明：reload() 只在首次装载时整表读取；此后订阅 InventoryManager 的插入/更新/删除信号，
+ *          按 id 回读变化的行并发出对应的 rowsInserted/dataChanged/rowsRemoved，代价与变化条数成正比。
+ *          行按库存 id 降序（最新在前）保存，定位某一行为二分查找。
+ */
+class InventoryTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { NameColumn = 0, QuantityColumn, AttributesColumn, ColumnCount };
+
+    InventoryTableModel(rove::data::InventoryManager& inventoryManager,
+                        rove::data::ShopManager& shopManager,
+                        rove::data::UserManager& userManager,
+                        QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief 读取当前用户的全部库存；商品名称取自商城目录，应在目录装载完成后调用。
+     */
+    void reload();
+
+private slots:
+    /**
+     * @brief 当前用户新增库存时按 id 回读并插入到表头；事务回滚的 id 查不到，直接跳过。
+     */
+    void onInserted(int ownerId, const QVector<int>& inventoryIds);
+
+    /**
+     * @brief 回读已显示的行并刷新对应单元格，未显示的 id 忽略。
+     */
+    void onUpdated(const QVector<int>& inventoryIds);
+
+    /**
+     * @brief 删除已显示的行。
+     */
+    void onRemoved(const QVector<int>& inventoryIds);
+
+private:
+    struct Row {
+        rove::data::InventoryItem item;
+        QString name;  //!< 装载时解析的商品名称，避免每次绘制都查询目录
+    };
+
+    /**
+     * @brief 返回 id 所在行号，不存在时返回 -1。
+     */
+    int rowOf(int inventoryId) const;
+
+    /**
+     * @brief 在当前目录快照中解析商品名称，商品已删除时显示“未知物品”。
+     */
+    static QString itemName(const rove::data::ShopManager::Catalog& catalog, int itemId);
+
+    rove::data::InventoryManager& m_inventoryManager;
+    rove::data::ShopManager& m_shopManager;
+    rove::data::UserManager& m_userManager;
+    std::vector<Row> m_rows;  //!< 按库存 id 降序
+    int m_ownerId{0};         //!< 已装载库存的用户 users.id，插入信号据此过滤
+    bool m_loaded{false};     //!< 首次 reload 前忽略所有增量
+};
+
+#endif  // INVENTORYTABLEMODEL_H
@@ -1,78 +1,120 @@
 #include "LogBrowser.h"
 #include "ui_LogBrowser.h"
+#include "LogTableModel.h"
 
-#include <QHeaderView>
 #include <QDateTime>
+#include <QHeaderView>
+#include <QStringList>
 
 LogBrowser::LogBrowser(rove::data::LogManager& manager, QWidget* parent)
     : QWidget(parent), ui(std::make_unique<Ui::LogBrowser>()), m_manager(manager) {
     ui->setupUi(this);
     m_table = ui->logTable;
+    m_model = new LogTableModel(m_manager, this);
+    m_table->setModel(m_model);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     ui->filterCombo->addItems({QStringLiteral("全部"), QStringLiteral("自动"), QStringLiteral("手动"),
                                QStringLiteral("里程碑"), QStringLiteral("事件")});
     connect(ui->filterCombo,
             qOverload<int>(&QComboBox::currentIndexChanged),
             this,
             &LogBrowser::onFilterChanged);
-    reload();
+    ui->rangeCombo->addItems({QStringLiteral("全部时间"), QStringLiteral("最近7天"), QStringLiteral("最近30天")});
+    connect(ui->rangeCombo,
+            qOverload<int>(&QComboBox::currentIndexChanged),
+            this,
+            &LogBrowser::onRangeChanged);
+    // 中文：日志历史不在启动时读取，MainWindow 在日志页首次打开时调用 reload()。
 }
 
 LogBrowser::~LogBrowser() = default;
 
+/**
+ * @brief 丢弃已加载的页并从第一页重新拉取。
+ */
 void LogBrowser::reload() {
-    populateTable(m_manager.filterLogs(std::nullopt, std::nullopt, std::nullopt, std::nullopt, std::nullopt));
-}
-
-void LogBrowser::onFilterChanged(int index) {
-    const auto logs = m_manager.filterLogs(std::nullopt, std::nullopt, std::nullopt, std::nullopt, std::nullopt);
-    std::vector<rove::data::LogEntry> filtered;
-    for (const auto& log : logs) {
-        if (index == 0) {
-            filtered.push_back(log);
-        } else if (index == 1 && log.type() == rove::data::LogEntry::LogType::Auto) {
-            filtered.push_back(log);
-        } else if (index == 2 && log.type() == rove::data::LogEntry::LogType::Manual) {
-            filtered.push_back(log);
-        } else if (index == 3 && log.type() == rove::data::LogEntry::LogType::Milestone) {
-            filtered.push_back(log);
-        } else if (index == 4 && log.type() == rove::data::LogEntry::LogType::Event) {
-            filtered.push_back(log);
-        }
-    }
-    populateTable(filtered);
+    m_model->reload();
+    refreshArchivedSummary();
 }
 
 /**
- * @brief 将日志数据填充到表格，列自适应宽度。
+ * @brief 明细已移入归档库的日子只剩按天汇总，在表格下方说明其天数与条数，悬停列出最近几天的事件分布。
  */
-void LogBrowser::populateTable(const std::vector<rove::data::LogEntry>& entries) {
-    m_table->clearContents();
-    m_table->setRowCount(static_cast<int>(entries.size()));
-    int row = 0;
-    for (const auto& entry : entries) {
-        QString typeText;
-        switch (entry.type()) {
-        case rove::data::LogEntry::LogType::Auto:
-            typeText = QStringLiteral("自动");
-            break;
-        case rove::data::LogEntry::LogType::Manual:
-            typeText = QStringLiteral("手动");
-            break;
-        case rove::data::LogEntry::LogType::Milestone:
-            typeText = QStringLiteral("里程碑");
-            break;
-        case rove::data::LogEntry::LogType::Event:
-            typeText = QStringLiteral("事件");
-            break;
-        default:
-            typeText = QStringLiteral("其他");
+void LogBrowser::refreshArchivedSummary() {
+    constexpr int kTooltipDays = 7;
+    const int filter = ui->filterCombo->currentIndex();
+    std::vector<rove::data::DatabaseManager::LogDailySummaryRecord> summaries;
+    if (filter == 0 || filter == 1) {
+        summaries = m_manager.archivedDailySummaries(m_rangeStart, std::nullopt);
+    }
+    if (summaries.empty()) {
+        ui->archivedLabel->setVisible(false);
+        return;
+    }
+    int entries = 0;
+    QStringList days;
+    for (const auto& summary : summaries) {
+        entries += summary.entryCount;
+        const QString day = QString::fromStdString(summary.day);
+        if (days.isEmpty() || days.last() != day) {
+            days.append(day);
         }
-        m_table->setItem(row, 0, new QTableWidgetItem(entry.timestamp().toString(Qt::ISODate)));
-        m_table->setItem(row, 1, new QTableWidgetItem(typeText));
-        m_table->setItem(row, 2, new QTableWidgetItem(QString::fromStdString(entry.content())));
-        ++row;
     }
-    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    ui->archivedLabel->setText(QStringLiteral("已归档的自动日志：%1 天共 %2 条（%3 至 %4）")
+                                   .arg(days.size())
+                                   .arg(entries)
+                                   .arg(days.first(), days.last()));
+    QStringList lines;
+    const QString oldestShown = days.size() > kTooltipDays ? days.at(days.size() - kTooltipDays) : days.first();
+    for (const auto& summary : summaries) {
+        const QString day = QString::fromStdString(summary.day);
+        if (day < oldestShown) {
+            continue;
+        }
+        const QString event = summary.specialEvent.empty() ? QStringLiteral("常规")
+                                                           : QString::fromStdString(summary.specialEvent);
+        lines.append(QStringLiteral("%1  %2×%3").arg(day, event).arg(summary.entryCount));
+    }
+    ui->archivedLabel->setToolTip(lines.join(QLatin1Char('\n')));
+    ui->archivedLabel->setVisible(true);
 }
 
+void LogBrowser::onFilterChanged(int index) {
+    using LogType = rove::data::LogEntry::LogType;
+    switch (index) {
+    case 1:
+        m_model->setTypeFilter(LogType::Auto);
+        break;
+    case 2:
+        m_model->setTypeFilter(LogType::Manual);
+        break;
+    case 3:
+        m_model->setTypeFilter(LogType::Milestone);
+        break;
+    case 4:
+        m_model->setTypeFilter(LogType::Event);
+        break;
+    default:
+        m_model->setTypeFilter(std::nullopt);
+    }
+    refreshArchivedSummary();
+}
 
+void LogBrowser::onRangeChanged(int index) {
+    const QDateTime now = QDateTime::currentDateTime();
+    switch (index) {
+    case 1:
+        m_rangeStart = now.addDays(-7);
+        break;
+    case 2:
+        m_rangeStart = now.addDays(-30);
+        break;
+    default:
+        m_rangeStart = std::nullopt;
+    }
+    m_model->setTimeRange(m_rangeStart, std::nullopt);
+    refreshArchivedSummary();
+}
@@ -2,12 +2,15 @@
 #define LOGBROWSER_H
 
 #include <QWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QComboBox>
+#include <QDateTime>
 #include <optional>
 #include <memory>
 #include "../core/LogManager.h"
 
+class LogTableModel;
+
 namespace Ui {
 class LogBrowser;
 }
@@ -15,7 +18,7 @@ class LogBrowser;
 /**
  * @class LogBrowser
  * @brief 日志浏览器，时间轴样式查看并支持过滤。
- * 中文说明：使用表格呈现日志，提供类型过滤与关键词搜索入口。
+ * 中文说明：使用按页懒加载的表格模型呈现日志，提供类型过滤与关键词搜索入口。
  */
 class LogBrowser : public QWidget {
     Q_OBJECT
@@ -36,17 +39,22 @@ private slots:
      */
     void onFilterChanged(int index);
 
+    /**
+     * @brief 时间区间变更时重建表格。
+     */
+    void onRangeChanged(int index);
+
 private:
     /**
-     * @brief 用管理器数据填充表格。
+     * @brief 按当前区间与过滤刷新“已归档自动日志”提示；归档汇总只含 Auto 日志。
      */
-    void populateTable(const std::vector<rove::data::LogEntry>& entries);
+    void refreshArchivedSummary();
 
     std::unique_ptr<Ui::LogBrowser> ui;
     rove::data::LogManager& m_manager;
-    QTableWidget* m_table{nullptr};
+    QTableView* m_table{nullptr};
+    LogTableModel* m_model{nullptr};
+    std::optional<QDateTime> m_rangeStart;  //!< 当前时间区间起点；std::nullopt 表示全部时间
 };
 
 #endif  // LOGBROWSER_H
-
-
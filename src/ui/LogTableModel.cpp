@@ -0,0 +1,145 @@
+#include "LogTableModel.h"
+
+#include <QDateTime>
+
+#include <iterator>
+
+namespace {
+constexpr std::size_t kLogPageSize = 200;  // 中文：每次只加载一屏多一点的日志。
+}
+
+LogTableModel::LogTableModel(rove::data::LogManager& manager, QObject* parent)
+    : QAbstractTableModel(parent), m_manager(manager) {
+    connect(&m_manager, &rove::data::LogManager::logInserted, this, &LogTableModel::onLogInserted);
+    connect(&m_manager, &rove::data::LogManager::logsCompacted, this, [this]() {
+        if (m_loaded) {
+            reload();
+        }
+    });
+}
+
+int LogTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int LogTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+/**
+ * @brief 仅为可见单元格格式化文本。
+ */
+QVariant LogTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole || index.row() >= static_cast<int>(m_rows.size())) {
+        return {};
+    }
+    const auto& entry = m_rows[static_cast<std::size_t>(index.row())];
+    switch (index.column()) {
+    case TimeColumn:
+        return entry.timestamp().toString(Qt::ISODate);
+    case TypeColumn:
+        return typeText(entry.type());
+    case ContentColumn:
+        return QString::fromStdString(entry.content());
+    default:
+        return {};
+    }
+}
+
+QVariant LogTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+    case TimeColumn:
+        return QStringLiteral("时间");
+    case TypeColumn:
+        return QStringLiteral("类型");
+    case ContentColumn:
+        return QStringLiteral("详情");
+    default:
+        return {};
+    }
+}
+
+bool LogTableModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && m_loaded && !m_exhausted;
+}
+
+/**
+ * @brief 从游标位置读取下一页并追加到末尾。
+ */
+void LogTableModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid() || !m_loaded || m_exhausted) {
+        return;
+    }
+    auto window = m_manager.filterLogWindow(m_typeFilter, m_start, m_end, std::nullopt, std::nullopt, m_cursor,
+                                            kLogPageSize);
+    m_cursor = window.nextCursor;
+    m_exhausted = !m_cursor.has_value();
+    if (window.entries.empty()) {
+        return;
+    }
+    const int first = static_cast<int>(m_rows.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(window.entries.size()) - 1);
+    m_rows.insert(m_rows.end(), std::make_move_iterator(window.entries.begin()),
+                  std::make_move_iterator(window.entries.end()));
+    endInsertRows();
+}
+
+void LogTableModel::setTypeFilter(const std::optional<rove::data::LogEntry::LogType>& type) {
+    m_typeFilter = type;
+    reload();
+}
+
+void LogTableModel::setTimeRange(const std::optional<QDateTime>& start, const std::optional<QDateTime>& end) {
+    m_start = start;
+    m_end = end;
+    reload();
+}
+
+void LogTableModel::reload() {
+    beginResetModel();
+    m_rows.clear();
+    m_rows.shrink_to_fit();
+    m_cursor.reset();
+    m_exhausted = false;
+    m_loaded = true;
+    endResetModel();
+    fetchMore(QModelIndex());
+}
+
+/**
+ * @brief 日志按时间升序排列，新日志总在末尾。
+ * 中文：尚未翻到末页时无需处理，后续 fetchMore 会自然读到这条日志。
+ */
+void LogTableModel::onLogInserted(const rove::data::LogEntry& entry) {
+    if (!m_loaded || !m_exhausted) {
+        return;
+    }
+    if (m_typeFilter.has_value() && entry.type() != *m_typeFilter) {
+        return;
+    }
+    if ((m_start.has_value() && entry.timestamp() < *m_start) || (m_end.has_value() && entry.timestamp() > *m_end)) {
+        return;
+    }
+    const int row = static_cast<int>(m_rows.size());
+    beginInsertRows(QModelIndex(), row, row);
+    m_rows.emplace_back(entry);
+    endInsertRows();
+}
+
+QString LogTableModel::typeText(rove::data::LogEntry::LogType type) {
+    switch (type) {
+    case rove::data::LogEntry::LogType::Auto:
+        return QStringLiteral("自动");
+    case rove::data::LogEntry::LogType::Manual:
+        return QStringLiteral("手动");
+    case rove::data::LogEntry::LogType::Milestone:
+        return QStringLiteral("里程碑");
+    case rove::data::LogEntry::LogType::Event:
+        return QStringLiteral("事件");
+    default:
+        return QStringLiteral("其他");
+    }
+}
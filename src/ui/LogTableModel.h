@@ -0,0 +1,65 @@
+#ifndef LOGTABLEMODEL_H
+#define LOGTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QDateTime>
+#include <optional>
+#include <vector>
+#include "../core/LogManager.h"
+
+/**
+ * @class LogTableModel
+ * @brief 日志表格模型，按页懒加载并增量追加新日志。
+ * 中文说明：视图滚动到底部时通过 canFetchMore/fetchMore 拉取下一页，单元格文本仅在 data() 被调用时格式化；
+ *          logInserted 信号只追加一行，不再整表重建。
+ */
+class LogTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { TimeColumn = 0, TypeColumn, ContentColumn, ColumnCount };
+
+    explicit LogTableModel(rove::data::LogManager& manager, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    /**
+     * @brief 设置类型过滤并从第一页重新加载。
+     */
+    void setTypeFilter(const std::optional<rove::data::LogEntry::LogType>& type);
+
+    /**
+     * @brief 设置时间区间并从第一页重新加载，区间条件由 SQL 处理。
+     */
+    void setTimeRange(const std::optional<QDateTime>& start, const std::optional<QDateTime>& end);
+
+    /**
+     * @brief 丢弃已加载的行并读取第一页，其余页由视图滚动时触发 fetchMore。
+     */
+    void reload();
+
+private slots:
+    /**
+     * @brief 新日志写入后按需追加一行。
+     */
+    void onLogInserted(const rove::data::LogEntry& entry);
+
+private:
+    static QString typeText(rove::data::LogEntry::LogType type);
+
+    rove::data::LogManager& m_manager;
+    std::vector<rove::data::LogEntryView> m_rows;  //!< 只读视图，表格只用到时间、类型与内容，其余字段不解析
+    std::optional<rove::data::LogEntry::LogType> m_typeFilter;
+    std::optional<QDateTime> m_start;
+    std::optional<QDateTime> m_end;
+    std::optional<rove::data::DatabaseManager::LogCursor> m_cursor;
+    bool m_exhausted{false};
+    bool m_loaded{false};  //!< 首次 reload 前不读取任何页，由日志页首次打开时触发。
+};
+
+#endif  // LOGTABLEMODEL_H
@@ -2,26 +2,43 @@
 #include "ui_MainWindow.h"
 
 #include <QComboBox>
+#include <QDateTime>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QKeySequence>
 #include <QMessageBox>
-#include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QShortcut>
+#include <QTableView>
 #include <QToolButton>
 #include <QVBoxLayout>
 #include <optional>
 
 #include "AchievementGallery.h"
+#include "IconCache.h"
+#include "InventoryTableModel.h"
+#include "ChangeBus.h"
 #include "CustomizationPanel.h"
 #include "DashboardWidget.h"
 #include "GrowthDashboard.h"
 #include "LogBrowser.h"
+#include "MetricsPanel.h"
 #include "ShopInterface.h"
 #include "../core/ShopItem.h"
 #include "../core/LogEntry.h"
+#include "../core/UnitOfWork.h"
 #include "TaskView.h"
 #include "TutorialManager.h"
 
+namespace {
+
+void installPage(QWidget* page, QWidget* child) {
+    auto* layout = new QVBoxLayout(page);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(child);
+}
+
+}  // namespace
+
 /**
  * @brief 构造函数：创建所有子组件并连接业务逻辑。
  */
@@ -33,6 +50,9 @@ MainWindow::MainWindow(rove::data::UserManager& userManager,
                        rove::data::InventoryManager& inventoryManager,
                        rove::data::SerendipityEngine& serendipityEngine,
                        rove::GrowthVisualizer& growthVisualizer,
+                       rove::data::StartupHydrator& hydrator,
+                       rove::data::CommandExecutor& commandExecutor,
+                       rove::data::ActivityFeed& activityFeed,
                        QWidget* parent)
     : QMainWindow(parent)
     , ui(std::make_unique<Ui::MainWindow>())
@@ -43,36 +63,25 @@ MainWindow::MainWindow(rove::data::UserManager& userManager,
     , m_shopManager(shopManager)
     , m_inventoryManager(inventoryManager)
     , m_serendipityEngine(serendipityEngine)
-    , m_growthVisualizer(growthVisualizer) {
+    , m_growthVisualizer(growthVisualizer)
+    , m_hydrator(hydrator)
+    , m_commandExecutor(commandExecutor)
+    , m_activityFeed(activityFeed) {
     ui->setupUi(this);
 
-    // 初始化子组件
+    // 初始化子组件：首屏只创建概览页，其余页面在首次切换到时由 ensurePage() 创建。
+    m_iconCache = new IconCache(IconCache::kDefaultBudgetBytes, this);
     m_dashboard = new DashboardWidget(this);
-    m_taskView = new TaskView(m_taskManager, this);
-    m_achievementGallery = new AchievementGallery(m_achievementManager, this);
-    m_growthDashboard = new GrowthDashboard(m_growthVisualizer, this);
-    m_shopInterface = new ShopInterface(m_shopManager, m_inventoryManager, this);
-    m_logBrowser = new LogBrowser(m_logManager, this);
-    m_customizationPanel = new CustomizationPanel(m_taskManager, m_achievementManager, m_serendipityEngine, this);
     m_tutorialManager = new TutorialManager(this);
-
-    // 安装布局到各页面
-    auto setPage = [](QWidget* page, QWidget* child) {
-        auto* layout = new QVBoxLayout(page);
-        layout->setContentsMargins(0, 0, 0, 0);
-        layout->addWidget(child);
-    };
-    setPage(ui->pageDashboard, m_dashboard);
-    setPage(ui->pageTask, m_taskView);
-    setPage(ui->pageAchievement, m_achievementGallery);
-    setPage(ui->pageGrowth, m_growthDashboard);
-    setPage(ui->pageShop, m_shopInterface);
-    setPage(ui->pageLog, m_logBrowser);
-    setPage(ui->pageCustom, m_customizationPanel);
+    m_changeBus = new ChangeBus(this);
+    installPage(ui->pageDashboard, m_dashboard);
+    m_dashboard->setRecentActivities(m_activityFeed.recent());
 
     setupNavigation();
     connectSignals();
+    connectChangeBus();
     setupTrayIcon();
+    setupDeveloperPanel();
     refreshDashboard();
     showRealtimeNotification(m_tutorialManager->currentHint());
 }
@@ -81,13 +90,13 @@ MainWindow::~MainWindow() = default;
 
 void MainWindow::setupNavigation() {
     // 导航按钮与堆叠页对应
-    connect(ui->dashboardBtn, &QPushButton::clicked, [this] { onSectionChanged(0); });
-    connect(ui->taskBtn, &QPushButton::clicked, [this] { onSectionChanged(1); });
-    connect(ui->achievementBtn, &QPushButton::clicked, [this] { onSectionChanged(2); });
-    connect(ui->growthBtn, &QPushButton::clicked, [this] { onSectionChanged(3); });
-    connect(ui->shopBtn, &QPushButton::clicked, [this] { onSectionChanged(4); });
-    connect(ui->logBtn, &QPushButton::clicked, [this] { onSectionChanged(5); });
-    connect(ui->customBtn, &QPushButton::clicked, [this] { onSectionChanged(6); });
+    connect(ui->dashboardBtn, &QPushButton::clicked, [this] { onSectionChanged(DashboardPage); });
+    connect(ui->taskBtn, &QPushButton::clicked, [this] { onSectionChanged(TaskPage); });
+    connect(ui->achievementBtn, &QPushButton::clicked, [this] { onSectionChanged(AchievementPage); });
+    connect(ui->growthBtn, &QPushButton::clicked, [this] { onSectionChanged(GrowthPage); });
+    connect(ui->shopBtn, &QPushButton::clicked, [this] { onSectionChanged(ShopPage); });
+    connect(ui->logBtn, &QPushButton::clicked, [this] { onSectionChanged(LogPage); });
+    connect(ui->customBtn, &QPushButton::clicked, [this] { onSectionChanged(CustomPage); });
     connect(ui->skipTutorialBtn, &QPushButton::clicked, m_tutorialManager, &TutorialManager::skip);
 
     // 皮肤与心情/宽恕券/背包面板
@@ -130,67 +139,47 @@ void MainWindow::setupNavigation() {
                                     : QStringLiteral("没有可用的宽恕券"));
     });
 
-    // 背包简易表格
-    auto* inventoryTable = new QTableWidget(ui->navPanel);
-    inventoryTable->setColumnCount(3);
-    inventoryTable->setHorizontalHeaderLabels({QStringLiteral("名称"), QStringLiteral("数量"), QStringLiteral("属性")});
+    // 背包简易表格：模型按库存变更信号增量更新，购买后不再整表重建。
+    m_inventoryModel = new InventoryTableModel(m_inventoryManager, m_shopManager, m_userManager, this);
+    auto* inventoryTable = new QTableView(ui->navPanel);
+    inventoryTable->setModel(m_inventoryModel);
     navLayout->insertWidget(navLayout->count() - 1, new QLabel(QStringLiteral("随身道具"), ui->navPanel));
     navLayout->insertWidget(navLayout->count() - 1, inventoryTable);
-    auto refreshInventory = [this, inventoryTable]() {
-        const auto username = m_userManager.activeUser().username();
-        const auto items = m_inventoryManager.listByOwner(username);
-        inventoryTable->setRowCount(static_cast<int>(items.size()));
-        int row = 0;
-        for (const auto& it : items) {
-            // Get item name from ShopManager using itemId
-            QString itemName = QStringLiteral("未知物品");
-            auto shopItem = m_shopManager.findItem(it.itemId());
-            if (shopItem) {
-                itemName = QString::fromStdString(shopItem->name());
-            }
-            inventoryTable->setItem(row, 0, new QTableWidgetItem(itemName));
-            inventoryTable->setItem(row, 1, new QTableWidgetItem(QString::number(it.quantity())));
-            inventoryTable->setItem(row, 2, new QTableWidgetItem(QString::fromStdString(it.specialAttributes())));
-            ++row;
-        }
-    };
-    refreshInventory();
-    connect(m_shopInterface, &ShopInterface::purchaseRequested, this, [refreshInventory]() { refreshInventory(); });
+    // 中文：道具名称取自商城目录，目录在后台构建完成后再装载，避免在 GUI 线程同步构建。
+    if (m_hydrator.isHydrated(rove::data::StartupHydrator::Section::ShopCatalog)) {
+        m_inventoryModel->reload();
+    }
+    connect(&m_hydrator, &rove::data::StartupHydrator::sectionHydrated, this,
+            [this](rove::data::StartupHydrator::Section section) {
+                if (section == rove::data::StartupHydrator::Section::ShopCatalog) {
+                    m_inventoryModel->reload();
+                }
+            });
 }
 
 void MainWindow::connectSignals() {
-    connect(m_taskView, &TaskView::taskCompletionRequested, this, [this](int taskId) {
-        m_taskManager.markTaskCompleted(taskId);
-        m_logManager.recordAutoLog(rove::data::LogEntry::LogType::Event,
-                                   QStringLiteral("任务完成").toStdString(),
-                                   taskId,
-                                   {},
-                                   0,
-                                   std::string{});
-        m_tutorialManager->markStepDone(QStringLiteral("createTask"));
-        refreshDashboard();
-    });
-
-    connect(m_shopInterface, &ShopInterface::purchaseRequested, this, [this](int itemId) {
-        auto result = m_shopManager.purchaseItem(itemId, 1);
-        showRealtimeNotification(QString::fromStdString(result.message));
-        m_tutorialManager->markStepDone(QStringLiteral("firstPurchase"));
-        refreshDashboard();
-    });
-
-    connect(m_customizationPanel,
-            &CustomizationPanel::customAchievementCreated,
-            this,
-            [this](const QString&, const QString&) { m_tutorialManager->markStepDone(QStringLiteral("firstAchievement")); });
+    connect(&m_commandExecutor, &rove::data::CommandExecutor::commandFailed, this,
+            [this](quint64, const QString&, const QString& message) {
+                showRealtimeNotification(QStringLiteral("操作失败：%1").arg(message));
+            });
 
     connect(&m_achievementManager,
             &rove::data::AchievementManager::achievementUnlocked,
             this,
             [this](int) { showRealtimeNotification(QStringLiteral("新的成就已解锁！")); });
 
-    connect(m_userManager.signalProxy(), &rove::data::UserManagerSignalProxy::coinsChanged, this, [this](int) {
-        refreshDashboard();
-    });
+    // 中文：近期动态逐行追加与淘汰，会话切换时才整体重建。
+    connect(&m_activityFeed, &rove::data::ActivityFeed::activityAppended, m_dashboard,
+            &DashboardWidget::prependActivity);
+    connect(&m_activityFeed, &rove::data::ActivityFeed::activitiesReset, m_dashboard,
+            [this] { m_dashboard->setRecentActivities(m_activityFeed.recent()); });
+
+    connect(&m_hydrator, &rove::data::StartupHydrator::sectionHydrated, this, &MainWindow::onSectionHydrated);
+    connect(&m_hydrator, &rove::data::StartupHydrator::sectionFailed, this,
+            [this](rove::data::StartupHydrator::Section section, const QString& message) {
+                showRealtimeNotification(QStringLiteral("数据加载失败：%1").arg(message));
+                onSectionHydrated(section);  // 中文：以当前缓存替换骨架占位，避免一直显示“加载中”。
+            });
 
     connect(m_tutorialManager, &TutorialManager::tutorialHintChanged, this, &MainWindow::showRealtimeNotification);
     connect(m_tutorialManager, &TutorialManager::tutorialFinished, this, &MainWindow::handleTutorialFinished);
@@ -210,6 +199,108 @@ void MainWindow::connectSignals() {
     }
 }
 
+/**
+ * @brief 写操作作为命令在数据线程上执行，界面先做乐观更新；结果经 future 回到 GUI 线程，失败时先回滚再提示。
+ */
+void MainWindow::completeTask(int taskId) {
+    m_taskView->setTaskCompletedOptimistically(taskId, true);
+    m_commandExecutor
+        .submit(
+            QStringLiteral("completeTask"),
+            [this, taskId]() {
+                // 中文：任务结算、用户保存与完成日志并入一个工作单元只提交一次；成就推进等订阅者在提交后执行。
+                rove::data::UnitOfWork(rove::data::DatabaseManager::instance(), "completeTask").run([&]() {
+                    m_taskManager.markTaskCompleted(taskId);
+                    m_logManager.recordAutoLog(rove::data::LogEntry::LogType::Event,
+                                               QStringLiteral("任务完成").toStdString(),
+                                               taskId,
+                                               {},
+                                               0,
+                                               std::string{});
+                });
+            },
+            [this, taskId]() { m_taskView->setTaskCompletedOptimistically(taskId, false); })
+        .then(this, [this]() { m_tutorialManager->markStepDone(QStringLiteral("createTask")); });
+}
+
+void MainWindow::purchaseItem(int itemId) {
+    m_shopInterface->setPurchasePending(true);
+    m_commandExecutor
+        .submit(
+            QStringLiteral("purchaseItem"),
+            [this, itemId]() { return m_shopManager.purchaseItem(itemId, 1); },
+            [this]() { m_shopInterface->setPurchasePending(false); })
+        .then(this, [this](const rove::data::ShopManager::PurchaseResult& result) {
+            m_shopInterface->setPurchasePending(false);
+            showRealtimeNotification(QString::fromStdString(result.message));
+            m_tutorialManager->markStepDone(QStringLiteral("firstPurchase"));
+            m_changeBus->postShopChanged();
+        });
+}
+
+void MainWindow::connectChangeBus() {
+    using rove::data::AchievementManager;
+    using rove::data::LogManager;
+    using rove::data::TaskManagerSignalProxy;
+    using rove::data::UserManagerSignalProxy;
+
+    // 业务信号 -> 增量标记
+    connect(m_taskManager.signalProxy(), &TaskManagerSignalProxy::taskCompleted, m_changeBus, [this](int taskId, int, int) {
+        m_changeBus->postTaskChanged(taskId);
+        m_changeBus->postUserChanged();  // 中文：任务奖励会改变成长值与属性。
+    });
+    // 中文：进度信号可能在数据线程上逐条发出（批量事件一次上百条），直连到线程安全的 ChangeBus，
+    //       只记下 id，不为每条变化各排一个跨线程事件；合并后每周期在界面线程派发一次。
+    connect(m_taskManager.signalProxy(), &TaskManagerSignalProxy::taskProgressed, m_changeBus,
+            [this](int taskId, int, int) { m_changeBus->postTaskChanged(taskId); }, Qt::DirectConnection);
+    // 中文：创建、编辑、删除、失败判定与周期重置同样按 id 合并；缓存整体替换时任务页整表重读。
+    connect(m_taskManager.signalProxy(), &TaskManagerSignalProxy::tasksChanged, m_changeBus,
+            [this](const QVector<int>& taskIds) {
+                for (int taskId : taskIds) {
+                    m_changeBus->postTaskChanged(taskId);
+                }
+            });
+    connect(m_taskManager.signalProxy(), &TaskManagerSignalProxy::tasksReloaded, this,
+            [this] { markPageStale(TaskPage); });
+    // 中文：进度字段（等级、成长值、金币、属性）每次提交后合并通知一次，购买、开福袋等路径也会覆盖到。
+    connect(m_userManager.signalProxy(), &UserManagerSignalProxy::progressionChanged, m_changeBus,
+            [this](const rove::data::ProgressionChange&) { m_changeBus->postUserChanged(); });
+    connect(&m_achievementManager, &AchievementManager::achievementUnlocked, m_changeBus, [this](int id) {
+        m_changeBus->postAchievementChanged(id);
+    });
+    connect(&m_achievementManager, &AchievementManager::achievementProgressChanged, m_changeBus,
+            [this](int id, int, int) { m_changeBus->postAchievementChanged(id); }, Qt::DirectConnection);
+    connect(&m_logManager, &LogManager::snapshotCaptured, m_changeBus, [this](const rove::data::GrowthSnapshot&) {
+        m_changeBus->postSnapshotAdded();
+    });
+
+    // 合并后的脏区域 -> 各自页面：可见页立即刷新，隐藏页只记为过期，切换到时再刷新；
+    // 日志表由 LogTableModel 直接增量追加，不经过总线。
+    connect(m_changeBus, &ChangeBus::userDirty, this, [this] {
+        markPageStale(DashboardPage);
+        if (isPageVisible(GrowthPage) && m_userManager.hasActiveUser()) {
+            m_growthDashboard->updateRadar(m_userManager.activeUser().attributes());
+        } else {
+            markPageStale(GrowthPage);
+        }
+    });
+    // 中文：任务页无论是否可见都直接按 id 增量更新，代价与变化条数成正比，不必等到切换时整表重读。
+    connect(m_changeBus, &ChangeBus::tasksDirty, this, [this](const QSet<int>& taskIds) {
+        if (m_taskView != nullptr) {
+            m_taskView->applyTaskChanges(taskIds);
+        }
+    });
+    connect(m_changeBus, &ChangeBus::achievementsDirty, this, [this](const QSet<int>& achievementIds) {
+        if (isPageVisible(AchievementPage)) {
+            m_achievementGallery->updateAchievements(achievementIds);
+        } else {
+            markPageStale(AchievementPage);
+        }
+    });
+    connect(m_changeBus, &ChangeBus::shopDirty, this, [this] { markPageStale(ShopPage); });
+    connect(m_changeBus, &ChangeBus::snapshotsDirty, this, [this] { markPageStale(GrowthPage); });
+}
+
 void MainWindow::setupTrayIcon() {
     m_trayIcon = new QSystemTrayIcon(this);
     m_trayIcon->setToolTip(QStringLiteral("兰大成长模拟"));
@@ -217,9 +308,161 @@ void MainWindow::setupTrayIcon() {
 }
 
 void MainWindow::onSectionChanged(int index) {
+    if (pageWidget(index) == nullptr) {
+        ensurePage(index);
+    } else if (m_stalePages.test(static_cast<std::size_t>(index))) {
+        refreshPage(index);
+    }
     ui->stackedWidget->setCurrentIndex(index);
 }
 
+QWidget* MainWindow::pageWidget(int index) const {
+    switch (index) {
+    case DashboardPage:
+        return m_dashboard;
+    case TaskPage:
+        return m_taskView;
+    case AchievementPage:
+        return m_achievementGallery;
+    case GrowthPage:
+        return m_growthDashboard;
+    case ShopPage:
+        return m_shopInterface;
+    case LogPage:
+        return m_logBrowser;
+    case CustomPage:
+        return m_customizationPanel;
+    default:
+        return nullptr;
+    }
+}
+
+bool MainWindow::isPageVisible(int index) const {
+    return pageWidget(index) != nullptr && ui->stackedWidget->currentIndex() == index;
+}
+
+/**
+ * @brief 创建页面、连接它发出的操作信号，并按当前数据填充一次。
+ */
+void MainWindow::ensurePage(int index) {
+    ROVE_SCOPED_TIMER(Dashboard, "ensurePage");
+    switch (index) {
+    case TaskPage:
+        m_taskView = new TaskView(m_taskManager, this);
+        installPage(ui->pageTask, m_taskView);
+        connect(m_taskView, &TaskView::taskCompletionRequested, this, &MainWindow::completeTask);
+        break;
+    case AchievementPage:
+        m_achievementGallery = new AchievementGallery(m_achievementManager, *m_iconCache, this);
+        installPage(ui->pageAchievement, m_achievementGallery);
+        break;
+    case GrowthPage:
+        m_growthDashboard = new GrowthDashboard(m_growthVisualizer, this);
+        installPage(ui->pageGrowth, m_growthDashboard);
+        connect(m_growthDashboard, &GrowthDashboard::scrubRequested, this, [this](qint64 timestampMs) {
+            if (m_userManager.hasActiveUser()) {
+                m_growthDashboard->showStateAt(m_logManager.stateAt(QDateTime::fromMSecsSinceEpoch(timestampMs)));
+            }
+        });
+        connect(m_growthDashboard, &GrowthDashboard::exportRequested, this, [this](const QString& path, bool columnar) {
+            m_growthDashboard->exportSnapshots(m_logManager.querySnapshots(std::nullopt, std::nullopt), path, columnar);
+        });
+        break;
+    case ShopPage:
+        m_shopInterface = new ShopInterface(m_shopManager, m_inventoryManager, *m_iconCache, this);
+        installPage(ui->pageShop, m_shopInterface);
+        connect(m_shopInterface, &ShopInterface::purchaseRequested, this, &MainWindow::purchaseItem);
+        break;
+    case LogPage:
+        m_logBrowser = new LogBrowser(m_logManager, this);
+        installPage(ui->pageLog, m_logBrowser);
+        break;
+    case CustomPage:
+        m_customizationPanel = new CustomizationPanel(m_taskManager, m_achievementManager, m_serendipityEngine, this);
+        installPage(ui->pageCustom, m_customizationPanel);
+        connect(m_customizationPanel, &CustomizationPanel::customAchievementCreated, this,
+                [this](const QString&, const QString&) {
+                    m_tutorialManager->markStepDone(QStringLiteral("firstAchievement"));
+                });
+        break;
+    default:
+        return;
+    }
+    refreshPage(index);
+}
+
+/**
+ * @brief 尚未创建的页面无需记录，创建时会按最新数据填充；可见页立即刷新，隐藏页记为过期。
+ */
+void MainWindow::markPageStale(int index) {
+    if (pageWidget(index) == nullptr) {
+        return;
+    }
+    if (isPageVisible(index)) {
+        refreshPage(index);
+    } else {
+        m_stalePages.set(static_cast<std::size_t>(index));
+    }
+}
+
+/**
+ * @brief 按当前数据重绘页面；依赖启动装载的页面在对应区域结束前保持骨架占位。
+ */
+void MainWindow::refreshPage(int index) {
+    using Section = rove::data::StartupHydrator::Section;
+    m_stalePages.reset(static_cast<std::size_t>(index));
+    switch (index) {
+    case DashboardPage:
+        if (m_userManager.hasActiveUser()) {
+            m_dashboard->renderUser(m_userManager.activeUser());
+        }
+        break;
+    case TaskPage:
+        if (isSectionSettled(Section::Tasks)) {
+            m_taskView->reloadTasks();
+        }
+        break;
+    case AchievementPage:
+        if (isSectionSettled(Section::Achievements)) {
+            m_achievementGallery->reload();
+        }
+        break;
+    case GrowthPage:
+        if (m_userManager.hasActiveUser()) {
+            m_growthDashboard->updateRadar(m_userManager.activeUser().attributes());
+        }
+        m_growthDashboard->buildTimeline(m_logManager.querySnapshotSeries(std::nullopt, std::nullopt));
+        m_growthDashboard->showInsights(m_logManager.growthInsights(rove::data::GrowthAnalytics::Window::Week));
+        break;
+    case ShopPage:
+        if (isSectionSettled(Section::ShopCatalog)) {
+            m_shopInterface->reload();
+        }
+        break;
+    case LogPage:
+        m_logBrowser->reload();
+        break;
+    default:
+        break;
+    }
+}
+
+bool MainWindow::isSectionSettled(rove::data::StartupHydrator::Section section) const {
+    return m_settledSections[static_cast<std::size_t>(section)];
+}
+
+void MainWindow::setupDeveloperPanel() {
+    auto* shortcut = new QShortcut(QKeySequence(QStringLiteral("Ctrl+Shift+M")), this);
+    connect(shortcut, &QShortcut::activated, this, [this] {
+        if (m_metricsPanel == nullptr) {
+            m_metricsPanel = new MetricsPanel(this);
+        }
+        m_metricsPanel->show();
+        m_metricsPanel->raise();
+        m_metricsPanel->activateWindow();
+    });
+}
+
 void MainWindow::showRealtimeNotification(const QString& message) {
     ui->notificationLabel->setText(message);
     if (m_trayIcon) {
@@ -228,18 +471,34 @@ void MainWindow::showRealtimeNotification(const QString& message) {
 }
 
 void MainWindow::refreshDashboard() {
-    if (!m_userManager.hasActiveUser()) {
-        return;
+    ROVE_SCOPED_TIMER(Dashboard, "refreshDashboard");
+    // 中文：任务、成就与商品由 StartupHydrator 并行装载，此处只记下构造前已完成的区域，页面创建时据此填充。
+    using Section = rove::data::StartupHydrator::Section;
+    for (Section section : {Section::Tasks, Section::Achievements, Section::ShopCatalog}) {
+        m_settledSections[static_cast<std::size_t>(section)] = m_hydrator.isHydrated(section);
+    }
+    const int current = ui->stackedWidget->currentIndex();
+    if (pageWidget(current) == nullptr) {
+        ensurePage(current);
+    } else {
+        refreshPage(current);
+    }
+}
+
+void MainWindow::onSectionHydrated(rove::data::StartupHydrator::Section section) {
+    using Section = rove::data::StartupHydrator::Section;
+    m_settledSections[static_cast<std::size_t>(section)] = true;
+    switch (section) {
+    case Section::Tasks:
+        markPageStale(TaskPage);
+        break;
+    case Section::Achievements:
+        markPageStale(AchievementPage);
+        break;
+    case Section::ShopCatalog:
+        markPageStale(ShopPage);
+        break;
     }
-    const auto& user = m_userManager.activeUser();
-    m_dashboard->renderUser(user);
-    m_achievementGallery->reload();
-    m_taskView->reloadTasks();
-    m_shopInterface->reload();
-    m_logBrowser->reload();
-
-    const auto snapshots = m_logManager.querySnapshots(std::nullopt, std::nullopt);
-    m_growthDashboard->render(user, snapshots);
 }
 
 void MainWindow::handleTutorialFinished() {
@@ -5,6 +5,8 @@
 #include <QStackedWidget>
 #include <QSystemTrayIcon>
 #include <QTimer>
+#include <array>
+#include <bitset>
 #include <memory>
 
 #include "../core/UserManager.h"
@@ -15,6 +17,9 @@
 #include "../core/InventoryManager.h"
 #include "../core/SerendipityEngine.h"
 #include "../core/GrowthVisualizer.h"
+#include "../core/StartupHydrator.h"
+#include "../core/CommandExecutor.h"
+#include "../core/ActivityFeed.h"
 
 class DashboardWidget;
 class TaskView;
@@ -24,6 +29,10 @@ class ShopInterface;
 class LogBrowser;
 class CustomizationPanel;
 class TutorialManager;
+class ChangeBus;
+class IconCache;
+class InventoryTableModel;
+class MetricsPanel;
 
 namespace Ui {
 class MainWindow;
@@ -47,6 +56,9 @@ public:
      * @param shopManager 商店管理器引用，支撑购买逻辑与库存刷新。
      * @param inventoryManager 背包管理器引用，支撑库存界面与优惠券应用。
      * @param serendipityEngine 奇遇系统引用，用于实时事件提醒。
+     * @param hydrator 启动编排器，各区域装载完成后替换骨架占位。
+     * @param commandExecutor 命令执行器，完成任务与购买等写操作在其数据线程上执行。
+     * @param activityFeed 近期动态数据源，概览页随其信号逐行更新。
      */
     MainWindow(rove::data::UserManager& userManager,
                rove::data::TaskManager& taskManager,
@@ -56,6 +68,9 @@ public:
                rove::data::InventoryManager& inventoryManager,
                rove::data::SerendipityEngine& serendipityEngine,
                rove::GrowthVisualizer& growthVisualizer,
+               rove::data::StartupHydrator& hydrator,
+               rove::data::CommandExecutor& commandExecutor,
+               rove::data::ActivityFeed& activityFeed,
                QWidget* parent = nullptr);
     ~MainWindow() override;
 
@@ -73,16 +88,27 @@ private slots:
     void showRealtimeNotification(const QString& message);
 
     /**
-     * @brief 刷新仪表盘的核心统计数据。
+     * @brief 启动时只渲染内存中的用户概览，其余页面显示骨架，运行期变更经 ChangeBus 按区域增量刷新。
      */
     void refreshDashboard();
 
+    /**
+     * @brief 启动装载的区域完成后填充对应页面。
+     * @param section 已装载的区域。
+     */
+    void onSectionHydrated(rove::data::StartupHydrator::Section section);
+
     /**
      * @brief 响应教程跳过或完成，关闭引导提示。
      */
     void handleTutorialFinished();
 
 private:
+    /**
+     * @brief 堆叠页索引，与 MainWindow.ui 中的页顺序一致。
+     */
+    enum Page { DashboardPage = 0, TaskPage, AchievementPage, GrowthPage, ShopPage, LogPage, CustomPage, PageCount };
+
     /**
      * @brief 建立导航按钮与堆叠页之间的映射关系。
      */
@@ -93,11 +119,58 @@ private:
      */
     void connectSignals();
 
+    /**
+     * @brief 将业务信号转成 ChangeBus 增量，并让各组件只订阅自己展示的区域。
+     */
+    void connectChangeBus();
+
     /**
      * @brief 初始化托盘图标和提示气泡，用于后台通知。
      */
     void setupTrayIcon();
 
+    /**
+     * @brief 提交完成任务命令，并把任务行乐观标记为已完成。
+     */
+    void completeTask(int taskId);
+
+    /**
+     * @brief 提交购买命令，命令结束前禁用购买按钮。
+     */
+    void purchaseItem(int itemId);
+
+    /**
+     * @brief 页面首次切换到时才创建并填充；概览页在构造时创建。
+     * @param index 即将显示的页索引。
+     */
+    void ensurePage(int index);
+
+    /**
+     * @brief 页面数据已变化：可见时立即刷新，隐藏时只记为过期，下次切换到时再刷新。
+     */
+    void markPageStale(int index);
+
+    /**
+     * @brief 按当前数据重绘已创建的页面并清除过期标记。
+     */
+    void refreshPage(int index);
+
+    /**
+     * @brief 页索引对应的页面组件，尚未创建时为 nullptr。
+     */
+    [[nodiscard]] QWidget* pageWidget(int index) const;
+    [[nodiscard]] bool isPageVisible(int index) const;
+
+    /**
+     * @brief 启动装载的区域是否已结束（成功或失败），结束后页面才以管理器缓存替换骨架占位。
+     */
+    [[nodiscard]] bool isSectionSettled(rove::data::StartupHydrator::Section section) const;
+
+    /**
+     * @brief 注册 Ctrl+Shift+M 快捷键，按需创建并显示开发者埋点面板。
+     */
+    void setupDeveloperPanel();
+
     std::unique_ptr<Ui::MainWindow> ui;  //!< UI 指针负责托管 .ui 生成的控件
 
     rove::data::UserManager& m_userManager;
@@ -108,8 +181,12 @@ private:
     rove::data::InventoryManager& m_inventoryManager;
     rove::data::SerendipityEngine& m_serendipityEngine;
     rove::GrowthVisualizer& m_growthVisualizer;
+    rove::data::StartupHydrator& m_hydrator;
+    rove::data::CommandExecutor& m_commandExecutor;
+    rove::data::ActivityFeed& m_activityFeed;
 
     DashboardWidget* m_dashboard{nullptr};
+    // 中文：以下页面在首次切换到时创建，此前为 nullptr。
     TaskView* m_taskView{nullptr};
     AchievementGallery* m_achievementGallery{nullptr};
     GrowthDashboard* m_growthDashboard{nullptr};
@@ -117,9 +194,15 @@ private:
     LogBrowser* m_logBrowser{nullptr};
     CustomizationPanel* m_customizationPanel{nullptr};
     TutorialManager* m_tutorialManager{nullptr};
+    ChangeBus* m_changeBus{nullptr};
+    IconCache* m_iconCache{nullptr};  //!< 商店与成就陈列室共用的图标缓存
+    InventoryTableModel* m_inventoryModel{nullptr};  //!< 侧栏背包表格的增量模型
+    MetricsPanel* m_metricsPanel{nullptr};  //!< 首次按下快捷键时创建
 
     QSystemTrayIcon* m_trayIcon{nullptr};
     QTimer* m_reminderTimer{nullptr};
+    std::bitset<PageCount> m_stalePages;         //!< 已创建但隐藏期间数据变化、待切换时刷新的页面
+    std::array<bool, 3> m_settledSections{};    //!< 按 StartupHydrator::Section 记录装载是否已结束
 };
 
 #endif  // MAINWINDOW_H
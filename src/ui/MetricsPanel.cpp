@@ -0,0 +1,170 @@
+#include "MetricsPanel.h"
+
+#include <QCheckBox>
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+
+#include "../core/DatabaseManager.h"
+#include "../core/MemoryAccounting.h"
+#include "../core/Metrics.h"
+#include "../core/SqliteMemory.h"
+
+namespace {
+QString formatMicros(std::uint64_t nanoseconds) { return QString::number(static_cast<double>(nanoseconds) / 1000.0, 'f', 1); }
+QString formatKiB(std::size_t bytes) { return QString::number(static_cast<double>(bytes) / 1024.0, 'f', 1); }
+}  // namespace
+
+MetricsPanel::MetricsPanel(QWidget* parent) : QDialog(parent) {
+    setWindowTitle(QStringLiteral("性能埋点"));
+    resize(900, 560);
+
+    m_tree = new QTreeWidget(this);
+    m_tree->setColumnCount(6);
+    m_tree->setHeaderLabels({QStringLiteral("指标"), QStringLiteral("次数/取值"), QStringLiteral("p50 (µs)"),
+                             QStringLiteral("p99 (µs)"), QStringLiteral("最大 (µs)"), QStringLiteral("合计 (ms)")});
+    m_tree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_tree->setTextElideMode(Qt::ElideMiddle);
+
+    m_enabledBox = new QCheckBox(QStringLiteral("记录埋点"), this);
+    m_enabledBox->setChecked(rove::metrics::isEnabled());
+    m_enabledBox->setEnabled(rove::metrics::Registry::kCompiledIn);
+    connect(m_enabledBox, &QCheckBox::toggled, this, [](bool checked) { rove::metrics::setEnabled(checked); });
+
+    auto* resetButton = new QPushButton(QStringLiteral("清零"), this);
+    connect(resetButton, &QPushButton::clicked, this, [this] {
+        rove::metrics::Registry::instance().reset();
+        refresh();
+    });
+    auto* exportButton = new QPushButton(QStringLiteral("导出 JSON"), this);
+    connect(exportButton, &QPushButton::clicked, this, &MetricsPanel::exportJson);
+
+    m_statusLabel = new QLabel(this);
+
+    auto* buttons = new QHBoxLayout();
+    buttons->addWidget(m_enabledBox);
+    buttons->addWidget(m_statusLabel, 1);
+    buttons->addWidget(resetButton);
+    buttons->addWidget(exportButton);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addWidget(m_tree);
+    layout->addLayout(buttons);
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, &MetricsPanel::refresh);
+}
+
+void MetricsPanel::showEvent(QShowEvent* event) {
+    QDialog::showEvent(event);
+    refresh();
+    m_refreshTimer->start();
+}
+
+void MetricsPanel::hideEvent(QHideEvent* event) {
+    m_refreshTimer->stop();
+    QDialog::hideEvent(event);
+}
+
+void MetricsPanel::refresh() {
+    using rove::metrics::MetricSnapshot;
+    if (!rove::metrics::Registry::kCompiledIn) {
+        m_statusLabel->setText(QStringLiteral("埋点未编译（CYBER_LANDA_ENABLE_METRICS=OFF）"));
+        return;
+    }
+
+    const int scroll = m_tree->verticalScrollBar()->value();
+    m_tree->clear();
+    std::map<rove::metrics::Subsystem, QTreeWidgetItem*> groups;
+    const auto entries = rove::metrics::Registry::instance().snapshot();
+    for (const auto& entry : entries) {
+        auto& group = groups[entry.subsystem];
+        if (group == nullptr) {
+            group = new QTreeWidgetItem(m_tree, {QString::fromUtf8(rove::metrics::subsystemName(entry.subsystem))});
+            group->setExpanded(true);
+        }
+        QString title = QString::fromStdString(entry.name);
+        if (!entry.label.empty()) {
+            title += QStringLiteral(" · ") + QString::fromStdString(entry.label);
+        }
+        auto* item = new QTreeWidgetItem(group, {title});
+        item->setToolTip(0, entry.detail.empty() ? title : QString::fromStdString(entry.detail));
+        if (entry.kind == MetricSnapshot::Kind::Counter) {
+            item->setText(1, QString::number(static_cast<qulonglong>(entry.value)));
+            continue;
+        }
+        item->setText(1, QString::number(static_cast<qulonglong>(entry.timing.count)));
+        item->setText(2, formatMicros(entry.timing.p50Ns));
+        item->setText(3, formatMicros(entry.timing.p99Ns));
+        item->setText(4, formatMicros(entry.timing.maxNs));
+        item->setText(5, QString::number(static_cast<double>(entry.timing.totalNs) / 1e6, 'f', 2));
+    }
+    // 中文：内存估算不依赖埋点开关，单独成组；“次数/取值”列为估算字节数（KiB），设有限额的行附注限额。
+    auto* memory = new QTreeWidgetItem(m_tree, {QStringLiteral("memory (KiB)")});
+    memory->setExpanded(true);
+    for (const auto& report : rove::metrics::MemoryRegistry::instance().report()) {
+        QString title = QStringLiteral("%1 · %2 项").arg(QString::fromStdString(report.name)).arg(
+            static_cast<qulonglong>(report.usage.entries));
+        if (report.budgetBytes.has_value()) {
+            title += QStringLiteral(" · 限额 %1").arg(formatKiB(*report.budgetBytes));
+        }
+        auto* item = new QTreeWidgetItem(memory, {title, formatKiB(report.usage.bytes)});
+        item->setToolTip(0, title);
+    }
+    // 中文：SQLite 分配器读数同样不依赖埋点开关；页缓存池与 lookaside 的未命中持续增长说明配置偏小。
+    const auto sqliteStats = rove::data::sqliteMemoryStats();
+    const auto connectionStatus = rove::data::DatabaseManager::instance().memoryStatus();
+    auto* sqliteGroup = new QTreeWidgetItem(
+        m_tree, {QStringLiteral("sqlite memory · %1").arg(QString::fromStdString(sqliteStats.profileName))});
+    sqliteGroup->setExpanded(true);
+    const auto addSqliteRow = [sqliteGroup](const QString& title, const QString& value) {
+        auto* item = new QTreeWidgetItem(sqliteGroup, {title, value});
+        item->setToolTip(0, title);
+    };
+    addSqliteRow(QStringLiteral("page-cache 池 · 已用/峰值/总槽数"),
+                 QStringLiteral("%1 / %2 / %3")
+                     .arg(static_cast<qlonglong>(sqliteStats.pageCacheSlotsUsed))
+                     .arg(static_cast<qlonglong>(sqliteStats.pageCacheSlotsPeak))
+                     .arg(sqliteStats.pageCacheSlots));
+    addSqliteRow(QStringLiteral("page-cache 溢出到堆 (KiB)"),
+                 formatKiB(static_cast<std::size_t>(std::max<std::int64_t>(sqliteStats.pageCacheOverflowBytes, 0))));
+    addSqliteRow(QStringLiteral("lookaside · 已用槽"), QString::number(static_cast<qlonglong>(connectionStatus.lookasideUsed)));
+    addSqliteRow(QStringLiteral("lookaside · 命中/槽过小/槽用尽"),
+                 QStringLiteral("%1 / %2 / %3")
+                     .arg(static_cast<qlonglong>(connectionStatus.lookasideHits))
+                     .arg(static_cast<qlonglong>(connectionStatus.lookasideMissSize))
+                     .arg(static_cast<qlonglong>(connectionStatus.lookasideMissFull)));
+    addSqliteRow(QStringLiteral("未释放分配 · 最大单次请求 (B)"),
+                 QStringLiteral("%1 · %2")
+                     .arg(static_cast<qlonglong>(sqliteStats.outstandingAllocations))
+                     .arg(static_cast<qlonglong>(sqliteStats.largestAllocation)));
+    m_tree->verticalScrollBar()->setValue(scroll);
+    m_statusLabel->setText(QStringLiteral("%1 项").arg(static_cast<qulonglong>(entries.size())));
+}
+
+void MetricsPanel::exportJson() {
+    const QString path = QFileDialog::getSaveFileName(this, QStringLiteral("导出埋点"), QStringLiteral("metrics.json"),
+                                                      QStringLiteral("JSON (*.json)"));
+    if (path.isEmpty()) {
+        return;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_statusLabel->setText(QStringLiteral("导出失败：%1").arg(file.errorString()));
+        return;
+    }
+    file.write(QByteArray::fromStdString(rove::metrics::Registry::instance().toJson()));
+    m_statusLabel->setText(QStringLiteral("已导出到 %1").arg(path));
+}
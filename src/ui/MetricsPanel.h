@@ -0,0 +1,45 @@
+#ifndef METRICSPANEL_H
+#define METRICSPANEL_H
+
+#include <QDialog>
+
+class QCheckBox;
+class QLabel;
+class QTimer;
+class QTreeWidget;
+
+/**
+ * @class MetricsPanel
+ * @brief 隐藏的开发者面板，按子系统展示热路径埋点的调用次数与延迟分位数。
+ * 中文说明：主窗口按 Ctrl+Shift+M 打开；可见期间每秒刷新一次，支持运行期开关、清零与导出 JSON。
+ *          编译时关闭 CYBER_LANDA_ENABLE_METRICS 后面板只提示埋点未编译。
+ */
+class MetricsPanel : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit MetricsPanel(QWidget* parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private slots:
+    /**
+     * @brief 读取注册表快照并重建列表，保留滚动位置。
+     */
+    void refresh();
+
+    /**
+     * @brief 选择路径并写出 Registry::toJson() 的结果。
+     */
+    void exportJson();
+
+private:
+    QTreeWidget* m_tree{nullptr};
+    QCheckBox* m_enabledBox{nullptr};
+    QLabel* m_statusLabel{nullptr};
+    QTimer* m_refreshTimer{nullptr};
+};
+
+#endif  // METRICSPANEL_H
@@ -2,24 +2,82 @@
 #include "ui_ShopInterface.h"
 
 #include <QMessageBox>
+#include <QSet>
+
+#include "IconCache.h"
+
+namespace {
+const QSize kShopIconSize(24, 24);
+constexpr int kIconPathRole = Qt::UserRole + 1;  //!< 行当前使用的图标路径，用于比对与维护图标索引
+
+/**
+ * @brief 商品类型对应的分类根节点下标，与 ensureCategoryRoots 的创建顺序一致。
+ */
+std::size_t categoryIndex(rove::data::ShopItem::ItemType type) {
+    switch (type) {
+    case rove::data::ShopItem::ItemType::Physical:
+        return 0;
+    case rove::data::ShopItem::ItemType::Prop:
+        return 1;
+    default:
+        return 2;
+    }
+}
+
+/**
+ * @brief 仅在文本不同时写入，避免无变化的更新触发 dataChanged 重绘。
+ */
+void setTextIfChanged(QTreeWidgetItem* row, int column, const QString& text) {
+    if (row->text(column) != text) {
+        row->setText(column, text);
+    }
+}
+
+/**
+ * @brief 按商品 id 升序把行插入分类节点；从末尾向前查找，按 id 顺序填充时为 O(1)。
+ */
+void insertSortedById(QTreeWidgetItem* parent, QTreeWidgetItem* row, int itemId) {
+    int pos = parent->childCount();
+    while (pos > 0 && parent->child(pos - 1)->data(0, Qt::UserRole).toInt() > itemId) {
+        --pos;
+    }
+    parent->insertChild(pos, row);
+}
+}  // namespace
 
 ShopInterface::ShopInterface(rove::data::ShopManager& shopManager,
                              rove::data::InventoryManager& inventoryManager,
+                             IconCache& icons,
                              QWidget* parent)
     : QWidget(parent)
     , ui(std::make_unique<Ui::ShopInterface>())
     , m_shopManager(shopManager)
-    , m_inventoryManager(inventoryManager) {
+    , m_inventoryManager(inventoryManager)
+    , m_icons(icons) {
     ui->setupUi(this);
     m_tree = ui->shopTree;
+    m_tree->setIconSize(kShopIconSize);
+    connect(&m_icons, &IconCache::iconReady, this, &ShopInterface::onIconReady);
     connect(ui->purchaseBtn, &QPushButton::clicked, this, &ShopInterface::onPurchaseClicked);
-    reload();
+    showLoading();
 }
 
 ShopInterface::~ShopInterface() = default;
 
 void ShopInterface::reload() { populate(); }
 
+void ShopInterface::showLoading() {
+    m_itemsByIcon.clear();
+    m_rowsById.clear();
+    m_categoryRoots.fill(nullptr);
+    m_shownVersion = 0;
+    m_tree->clear();
+    auto* item = new QTreeWidgetItem(m_tree, QStringList(QStringLiteral("商品加载中…")));
+    item->setFlags(Qt::NoItemFlags);
+}
+
+void ShopInterface::setPurchasePending(bool pending) { ui->purchaseBtn->setEnabled(!pending); }
+
 /**
  * @brief 点击购买后校验并发射事件。
  */
@@ -33,30 +91,127 @@ void ShopInterface::onPurchaseClicked() {
 }
 
 /**
- * @brief 填充商品树，按照分类懒加载。
+ * 中文说明：增量同步商品树
+ * - 目录版本未变（例如购买或任务完成后触发的 reload）时直接返回；
+ * - 否则按 id 遍历目录：新商品插入、已有商品只更新变化的列，下架或删除的商品移除；
+ * - 不调用 clear()，已有行对象保持不变，用户的展开状态与选中项不受影响。
  */
 void ShopInterface::populate() {
-    m_tree->clear();
-    const auto items = m_shopManager.listItems();
-    QTreeWidgetItem* physicalRoot = new QTreeWidgetItem(m_tree, QStringList(QStringLiteral("实体")));
-    QTreeWidgetItem* propRoot = new QTreeWidgetItem(m_tree, QStringList(QStringLiteral("道具")));
-    QTreeWidgetItem* bagRoot = new QTreeWidgetItem(m_tree, QStringList(QStringLiteral("福袋")));
-    for (const auto& item : items) {
-        QTreeWidgetItem* parent = nullptr;
-        if (item.itemType() == rove::data::ShopItem::ItemType::Physical) {
-            parent = physicalRoot;
-        } else if (item.itemType() == rove::data::ShopItem::ItemType::Prop) {
-            parent = propRoot;
-        } else {
-            parent = bagRoot;
+    // 中文：持有目录快照即可在锁外遍历；价格显示为定价策略后的实际售价。
+    const auto catalog = m_shopManager.catalog();
+    if (catalog->version == m_shownVersion) {
+        return;
+    }
+    ensureCategoryRoots();
+    QSet<int> live;
+    live.reserve(static_cast<int>(catalog->entries.size()));
+    for (const auto& entry : catalog->entries) {
+        const auto& item = entry.priced;
+        if (!item.isAvailable()) {
+            continue;
+        }
+        live.insert(item.id());
+        syncRow(item);
+    }
+    QList<int> stale;
+    for (auto it = m_rowsById.constBegin(); it != m_rowsById.constEnd(); ++it) {
+        if (!live.contains(it.key())) {
+            stale.append(it.key());
         }
-        auto* child = new QTreeWidgetItem(parent);
-        child->setText(0, QString::fromStdString(item.name()));
-        child->setText(1, QString::number(item.priceCoins()));
-        child->setText(2, QString::fromStdString(item.description()));
-        child->setData(0, Qt::UserRole, item.id());
     }
-    m_tree->expandAll();
+    for (int itemId : stale) {
+        removeRow(itemId);
+    }
+    m_shownVersion = catalog->version;
+}
+
+void ShopInterface::ensureCategoryRoots() {
+    if (m_categoryRoots[0] != nullptr) {
+        return;
+    }
+    m_tree->clear();  // 中文：移除 showLoading 的占位行
+    m_categoryRoots[0] = new QTreeWidgetItem(m_tree, QStringList(QStringLiteral("实体")));
+    m_categoryRoots[1] = new QTreeWidgetItem(m_tree, QStringList(QStringLiteral("道具")));
+    m_categoryRoots[2] = new QTreeWidgetItem(m_tree, QStringList(QStringLiteral("福袋")));
+    for (auto* root : m_categoryRoots) {
+        root->setExpanded(true);
+    }
+}
+
+/**
+ * 中文说明：单行同步
+ * - 子行按 id 升序排列；目录同样按 id 升序，首次填充时每次都命中末尾追加的快速路径；
+ * - 分类变化时 removeChild 会丢失选中与当前项，挂到新分类后按原状态恢复。
+ */
+void ShopInterface::syncRow(const rove::data::ShopItem& item) {
+    QTreeWidgetItem* parent = m_categoryRoots[categoryIndex(item.itemType())];
+    QTreeWidgetItem* row = m_rowsById.value(item.id(), nullptr);
+    if (row == nullptr) {
+        row = new QTreeWidgetItem();
+        row->setData(0, Qt::UserRole, item.id());
+        m_rowsById.insert(item.id(), row);
+        insertSortedById(parent, row, item.id());
+    } else if (row->parent() != parent) {
+        const bool wasCurrent = m_tree->currentItem() == row;
+        const bool wasSelected = row->isSelected();
+        row->parent()->removeChild(row);
+        insertSortedById(parent, row, item.id());
+        // 中文：未挂入树的行无法被选中，因此在插入后恢复状态。
+        row->setSelected(wasSelected);
+        if (wasCurrent) {
+            m_tree->setCurrentItem(row);
+        }
+    }
+    setTextIfChanged(row, 0, QString::fromStdString(item.name()));
+    setTextIfChanged(row, 1, QString::number(item.priceCoins()));
+    setTextIfChanged(row, 2, QString::fromStdString(item.description()));
+    setRowIcon(row, QString::fromStdString(item.iconPath()));
+}
+
+void ShopInterface::removeRow(int itemId) {
+    QTreeWidgetItem* row = m_rowsById.take(itemId);
+    if (row == nullptr) {
+        return;
+    }
+    setRowIcon(row, QString());
+    delete row;  // 中文：QTreeWidgetItem 析构时自动从父节点移除
+}
+
+void ShopInterface::setRowIcon(QTreeWidgetItem* row, const QString& iconPath) {
+    const QString previous = row->data(0, kIconPathRole).toString();
+    if (previous == iconPath) {
+        return;
+    }
+    if (!previous.isEmpty()) {
+        auto found = m_itemsByIcon.find(previous);
+        if (found != m_itemsByIcon.end()) {
+            found.value().removeOne(row);
+            if (found.value().isEmpty()) {
+                m_itemsByIcon.erase(found);
+            }
+        }
+    }
+    row->setData(0, kIconPathRole, iconPath);
+    if (iconPath.isEmpty()) {
+        row->setIcon(0, QIcon());
+        return;
+    }
+    row->setIcon(0, m_icons.icon(iconPath, kShopIconSize));
+    m_itemsByIcon[iconPath].append(row);
+}
+
+void ShopInterface::onIconReady(const QString& path, const QSize& size) {
+    if (size != kShopIconSize) {
+        return;
+    }
+    const auto found = m_itemsByIcon.constFind(path);
+    if (found == m_itemsByIcon.constEnd()) {
+        return;
+    }
+    const QIcon icon(m_icons.icon(path, size));
+    for (auto* item : found.value()) {
+        item->setIcon(0, icon);
+    }
 }
 
 
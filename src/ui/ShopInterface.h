@@ -1,9 +1,13 @@
 #ifndef SHOPINTERFACE_H
 #define SHOPINTERFACE_H
 
+#include <QHash>
+#include <QList>
 #include <QWidget>
 #include <QTreeWidget>
 #include <QPushButton>
+#include <array>
+#include <cstdint>
 #include <memory>
 #include "../core/ShopManager.h"
 #include "../core/InventoryManager.h"
@@ -12,10 +16,14 @@ namespace Ui {
 class ShopInterface;
 }
 
+class IconCache;
+
 /**
  * @class ShopInterface
  * @brief 商店界面，分类展示商品并提供购买交互。
- * 中文说明：通过树控件按类别显示物品，提供购买按钮并与库存管理器同步更新。
+ * 中文说明：通过树控件按类别显示物品，提供购买按钮并与库存管理器同步更新；商品图标经 IconCache 异步加载。
+ *          树按商品 id 与目录版本增量同步：目录未变时 reload() 直接返回，变化时只增删改受影响的行，
+ *          分类节点与商品行对象保持不变，因此用户的展开/折叠与选中状态得以保留。
  */
 class ShopInterface : public QWidget {
     Q_OBJECT
@@ -23,6 +31,7 @@ class ShopInterface : public QWidget {
 public:
     ShopInterface(rove::data::ShopManager& shopManager,
                   rove::data::InventoryManager& inventoryManager,
+                  IconCache& icons,
                   QWidget* parent = nullptr);
     ~ShopInterface() override;
 
@@ -35,26 +44,66 @@ signals:
 
 public slots:
     /**
-     * @brief 重新加载商品列表。
+     * @brief 与商品目录同步；目录版本与已显示版本相同时不做任何事。
      */
     void reload();
 
+    /**
+     * @brief 显示加载占位行，目录在后台构建完成后由 reload() 替换。
+     */
+    void showLoading();
+
+    /**
+     * @brief 购买命令执行期间禁用购买按钮，避免重复提交；命令结束（成功或失败）后恢复。
+     */
+    void setPurchasePending(bool pending);
+
 private slots:
     /**
      * @brief 处理购买按钮点击，读取当前选中商品。
      */
     void onPurchaseClicked();
 
+    /**
+     * @brief 图标解码完成后替换引用该路径的商品行的占位图。
+     */
+    void onIconReady(const QString& path, const QSize& size);
+
 private:
     /**
-     * @brief 将商品填充到树控件。
+     * @brief 将目录快照与树控件逐行比对，只插入、删除或更新发生变化的商品行。
      */
     void populate();
 
+    /**
+     * @brief 首次同步时移除加载占位行并创建三个分类根节点（默认展开）。
+     */
+    void ensureCategoryRoots();
+
+    /**
+     * @brief 为单个可售商品插入新行或就地更新已有行；分类改变时把行移到新分类下并恢复选中状态。
+     */
+    void syncRow(const rove::data::ShopItem& item);
+
+    /**
+     * @brief 从图标索引与树中删除商品行。
+     */
+    void removeRow(int itemId);
+
+    /**
+     * @brief 更新行的图标路径并维护 m_itemsByIcon；路径未变时不做任何事。
+     */
+    void setRowIcon(QTreeWidgetItem* row, const QString& iconPath);
+
     std::unique_ptr<Ui::ShopInterface> ui;
     rove::data::ShopManager& m_shopManager;
     rove::data::InventoryManager& m_inventoryManager;
+    IconCache& m_icons;
     QTreeWidget* m_tree{nullptr};
+    std::array<QTreeWidgetItem*, 3> m_categoryRoots{};       //!< 实体 / 道具 / 福袋，首次同步时创建
+    QHash<int, QTreeWidgetItem*> m_rowsById;                   //!< 商品 id -> 树中的行
+    QHash<QString, QList<QTreeWidgetItem*>> m_itemsByIcon;     //!< 图标路径 -> 使用它的商品行，随行增删维护
+    std::uint64_t m_shownVersion{0};                           //!< 树当前反映的目录版本，0 表示尚未同步
 };
 
 #endif  // SHOPINTERFACE_H
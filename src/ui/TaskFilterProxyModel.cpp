@@ -0,0 +1,74 @@
+#include "TaskFilterProxyModel.h"
+
+#include <QDateTime>
+#include <QTime>
+
+#include "TaskModel.h"
+
+TaskFilterProxyModel::TaskFilterProxyModel(QObject* parent) : QSortFilterProxyModel(parent) {
+    setSortRole(TaskModel::SortKeyRole);
+    setDynamicSortFilter(true);
+}
+
+void TaskFilterProxyModel::setTypeFilter(const std::optional<rove::data::Task::TaskType>& type) {
+    if (m_type == type) {
+        return;
+    }
+    m_type = type;
+    invalidateRowsFilter();
+}
+
+void TaskFilterProxyModel::setCompletionFilter(const std::optional<bool>& completed) {
+    if (m_completed == completed) {
+        return;
+    }
+    m_completed = completed;
+    invalidateRowsFilter();
+}
+
+void TaskFilterProxyModel::setDeadlineRange(const std::optional<QDate>& from, const std::optional<QDate>& to) {
+    std::optional<qint64> fromMs;
+    std::optional<qint64> toMs;
+    if (from.has_value()) {
+        fromMs = QDateTime(*from, QTime(0, 0)).toMSecsSinceEpoch();
+    }
+    if (to.has_value()) {
+        toMs = QDateTime(to->addDays(1), QTime(0, 0)).toMSecsSinceEpoch();
+    }
+    if (fromMs == m_deadlineFromMs && toMs == m_deadlineToMs) {
+        return;
+    }
+    m_deadlineFromMs = fromMs;
+    m_deadlineToMs = toMs;
+    invalidateRowsFilter();
+}
+
+void TaskFilterProxyModel::setSearchText(const QString& text) {
+    const QString needle = text.trimmed().toCaseFolded();
+    if (needle == m_needle) {
+        return;
+    }
+    m_needle = needle;
+    invalidateRowsFilter();
+}
+
+/**
+ * @brief 先比较整数条件，最后才做文本匹配，多数行在前几项就被排除。
+ */
+bool TaskFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const {
+    const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
+    if (m_type.has_value() && index.data(TaskModel::TypeRole).toInt() != static_cast<int>(*m_type)) {
+        return false;
+    }
+    if (m_completed.has_value() && index.data(TaskModel::CompletedRole).toBool() != *m_completed) {
+        return false;
+    }
+    if (m_deadlineFromMs.has_value() || m_deadlineToMs.has_value()) {
+        const qint64 deadlineMs = index.data(TaskModel::DeadlineRole).toLongLong();
+        if ((m_deadlineFromMs.has_value() && deadlineMs < *m_deadlineFromMs) ||
+            (m_deadlineToMs.has_value() && deadlineMs >= *m_deadlineToMs)) {
+            return false;
+        }
+    }
+    return m_needle.isEmpty() || index.data(TaskModel::SearchKeyRole).toString().contains(m_needle);
+}
@@ -0,0 +1,54 @@
+#ifndef TASKFILTERPROXYMODEL_H
+#define TASKFILTERPROXYMODEL_H
+
+#include <QDate>
+#include <QSortFilterProxyModel>
+#include <QString>
+#include <optional>
+#include "../core/Task.h"
+
+/**
+ * @class TaskFilterProxyModel
+ * @brief 任务列表的筛选与排序代理：类型、完成状态、截止日期区间与文本搜索。
+ * 中文说明：筛选只读取 TaskModel 提供的原始角色（搜索文本已在装载时大小写折叠），不格式化显示文本；
+ *          条件变化时只重新筛选行，不重建列。排序启用 dynamicSortFilter，源模型单行变化时代理只把该行
+ *          移到新位置，不整表重排，大量学期任务下输入搜索词仍然流畅。
+ */
+class TaskFilterProxyModel : public QSortFilterProxyModel {
+    Q_OBJECT
+
+public:
+    explicit TaskFilterProxyModel(QObject* parent = nullptr);
+
+    /**
+     * @brief 只显示该类型的任务；空值表示全部类型。
+     */
+    void setTypeFilter(const std::optional<rove::data::Task::TaskType>& type);
+
+    /**
+     * @brief 只显示已完成（true）或未完成（false）的任务；空值表示不限。
+     */
+    void setCompletionFilter(const std::optional<bool>& completed);
+
+    /**
+     * @brief 截止日期落在 [from, to]（本地日期，两端含）内的任务；任一端为空表示该端不限。
+     */
+    void setDeadlineRange(const std::optional<QDate>& from, const std::optional<QDate>& to);
+
+    /**
+     * @brief 按名称与描述做不区分大小写的子串匹配；空串表示不限。
+     */
+    void setSearchText(const QString& text);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    std::optional<rove::data::Task::TaskType> m_type;
+    std::optional<bool> m_completed;
+    std::optional<qint64> m_deadlineFromMs;  //!< 区间起点当天零点，UTC 毫秒
+    std::optional<qint64> m_deadlineToMs;    //!< 区间终点次日零点（不含），UTC 毫秒
+    QString m_needle;                        //!< 已大小写折叠的搜索词
+};
+
+#endif  // TASKFILTERPROXYMODEL_H
@@ -0,0 +1,199 @@
+#include "TaskModel.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+
+namespace {
+/**
+ * @brief 行按 id 升序排列时的比较器，供 lower_bound 定位。
+ */
+struct IdAscending {
+    template <typename Row>
+    bool operator()(const Row& row, int taskId) const {
+        return row.id < taskId;
+    }
+};
+}  // namespace
+
+TaskModel::TaskModel(rove::data::TaskManager& manager, QObject* parent)
+    : QAbstractTableModel(parent), m_taskManager(manager) {}
+
+int TaskModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int TaskModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TaskModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(m_rows.size())) {
+        return {};
+    }
+    const Row& row = m_rows[static_cast<std::size_t>(index.row())];
+    switch (role) {
+    case Qt::DisplayRole:
+        break;
+    case TaskIdRole:
+        return row.id;
+    case SortKeyRole:
+        return sortKey(row, index.column());
+    case TypeRole:
+        return static_cast<int>(row.type);
+    case CompletedRole:
+        return row.completed;
+    case DeadlineRole:
+        return row.deadlineMs;
+    case SearchKeyRole:
+        return row.searchKey;
+    default:
+        return {};
+    }
+    switch (index.column()) {
+    case NameColumn:
+        return row.name;
+    case TypeColumn:
+        return typeText(row.type);
+    case DeadlineColumn:
+        return QDateTime::fromMSecsSinceEpoch(row.deadlineMs).toString(QStringLiteral("yyyy-MM-dd HH:mm"));
+    case RewardColumn:
+        return QStringLiteral("成长 %1 / 金币 %2").arg(row.growthReward).arg(row.coinReward);
+    case StreakColumn:
+        return row.bonusStreak;
+    case StatusColumn:
+        return row.completed ? QStringLiteral("已完成") : QStringLiteral("未完成");
+    default:
+        return {};
+    }
+}
+
+QVariant TaskModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+    case NameColumn:
+        return QStringLiteral("任务");
+    case TypeColumn:
+        return QStringLiteral("类型");
+    case DeadlineColumn:
+        return QStringLiteral("截止");
+    case RewardColumn:
+        return QStringLiteral("奖励");
+    case StreakColumn:
+        return QStringLiteral("连胜");
+    case StatusColumn:
+        return QStringLiteral("状态");
+    default:
+        return {};
+    }
+}
+
+/**
+ * @brief 共享锁内只复制展示字段；TaskManager 的类型桶按插入顺序排列，装载后统一按 id 排序一次。
+ */
+void TaskModel::reload() {
+    std::vector<Row> rows;
+    m_taskManager.forEachTask([&rows](const rove::data::Task& task) { rows.push_back(makeRow(task)); });
+    std::sort(rows.begin(), rows.end(), [](const Row& lhs, const Row& rhs) { return lhs.id < rhs.id; });
+    beginResetModel();
+    m_rows = std::move(rows);
+    m_loaded = true;
+    endResetModel();
+}
+
+void TaskModel::applyChanges(const QSet<int>& taskIds) {
+    if (!m_loaded) {
+        return;
+    }
+    for (int taskId : taskIds) {
+        const auto task = m_taskManager.taskById(taskId);
+        const auto pos = std::lower_bound(m_rows.begin(), m_rows.end(), taskId, IdAscending{});
+        const int row = static_cast<int>(pos - m_rows.begin());
+        const bool present = pos != m_rows.end() && pos->id == taskId;
+        if (!task.has_value()) {
+            if (present) {
+                beginRemoveRows(QModelIndex(), row, row);
+                m_rows.erase(pos);
+                endRemoveRows();
+            }
+            continue;
+        }
+        if (present) {
+            *pos = makeRow(*task);
+            emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+            continue;
+        }
+        beginInsertRows(QModelIndex(), row, row);
+        m_rows.insert(pos, makeRow(*task));
+        endInsertRows();
+    }
+}
+
+void TaskModel::setCompletedOverride(int taskId, bool completed) {
+    const int row = rowOf(taskId);
+    if (row < 0 || m_rows[static_cast<std::size_t>(row)].completed == completed) {
+        return;
+    }
+    m_rows[static_cast<std::size_t>(row)].completed = completed;
+    emit dataChanged(index(row, StatusColumn), index(row, StatusColumn));
+}
+
+TaskModel::Row TaskModel::makeRow(const rove::data::Task& task) {
+    Row row;
+    row.id = task.id();
+    row.type = task.type();
+    row.name = QString::fromStdString(task.name());
+    row.searchKey = (row.name + QLatin1Char('\n') + QString::fromStdString(task.description())).toCaseFolded();
+    row.deadlineMs = task.deadline().toMSecsSinceEpoch();
+    row.coinReward = task.coinReward();
+    row.growthReward = task.growthReward();
+    row.bonusStreak = task.bonusStreak();
+    row.completed = task.isCompleted();
+    return row;
+}
+
+QString TaskModel::typeText(rove::data::Task::TaskType type) {
+    switch (type) {
+    case rove::data::Task::TaskType::Daily:
+        return QStringLiteral("日常");
+    case rove::data::Task::TaskType::Weekly:
+        return QStringLiteral("每周");
+    case rove::data::Task::TaskType::Semester:
+        return QStringLiteral("学期");
+    case rove::data::Task::TaskType::Custom:
+        return QStringLiteral("自定义");
+    }
+    return {};
+}
+
+/**
+ * @brief 奖励列先比成长值再比金币，与显示顺序一致；组合成一个整数键，比较时无需拆分。
+ */
+QVariant TaskModel::sortKey(const Row& row, int column) const {
+    switch (column) {
+    case NameColumn:
+        return row.name;
+    case TypeColumn:
+        return static_cast<int>(row.type);
+    case DeadlineColumn:
+        return row.deadlineMs;
+    case RewardColumn:
+        return (static_cast<qint64>(row.growthReward) << 32) | static_cast<quint32>(row.coinReward);
+    case StreakColumn:
+        return row.bonusStreak;
+    case StatusColumn:
+        return row.completed;
+    default:
+        return {};
+    }
+}
+
+int TaskModel::rowOf(int taskId) const {
+    const auto pos = std::lower_bound(m_rows.begin(), m_rows.end(), taskId, IdAscending{});
+    if (pos == m_rows.end() || pos->id != taskId) {
+        return -1;
+    }
+    return static_cast<int>(pos - m_rows.begin());
+}
@@ -0,0 +1,88 @@
+#ifndef TASKMODEL_H
+#define TASKMODEL_H
+
+#include <QAbstractTableModel>
+#include <QSet>
+#include <QString>
+#include <vector>
+#include "../core/TaskManager.h"
+
+/**
+ * @class TaskModel
+ * @brief 当前用户的任务表格模型，按任务变更 id 增量更新。
+ * 中文说明：reload() 只在装载完成或缓存整体替换时遍历一次 TaskManager；此后 applyChanges() 按 id 回读变化的任务，
+ *          发出对应的 rowsInserted/dataChanged/rowsRemoved，代价与变化条数成正比。
+ *          行按任务 id 升序保存，定位为二分查找；排序与筛选交给 TaskFilterProxyModel，
+ *          本模型通过 SortKeyRole 与筛选角色提供原始键，避免代理在比较时解析显示文本。
+ */
+class TaskModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { NameColumn = 0, TypeColumn, DeadlineColumn, RewardColumn, StreakColumn, StatusColumn, ColumnCount };
+
+    enum Role {
+        TaskIdRole = Qt::UserRole,
+        SortKeyRole,    //!< 当前列的排序键：名称文本、类型序号、截止毫秒、奖励组合键、连胜数或完成标记
+        TypeRole,       //!< Task::TaskType 的整数值
+        CompletedRole,  //!< bool
+        DeadlineRole,   //!< 截止时间的 UTC 毫秒，qint64
+        SearchKeyRole   //!< 名称与描述的大小写折叠文本，供文本搜索直接匹配
+    };
+
+    explicit TaskModel(rove::data::TaskManager& manager, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief 遍历当前缓存的全部任务并重置模型。
+     */
+    void reload();
+
+    /**
+     * @brief 按 id 回读变化的任务：已显示的行刷新，新任务按 id 插入，缓存中已不存在的任务移除。
+     *        首次 reload 前忽略。
+     */
+    void applyChanges(const QSet<int>& taskIds);
+
+    /**
+     * @brief 只改显示的完成状态，不访问 TaskManager；供乐观更新与回滚使用，下一次增量以真实状态覆盖。
+     */
+    void setCompletedOverride(int taskId, bool completed);
+
+    [[nodiscard]] bool isLoaded() const noexcept { return m_loaded; }
+
+private:
+    /**
+     * @brief 展示与筛选所需的任务字段快照，不持有描述、设置等大字段。
+     */
+    struct Row {
+        int id{0};
+        rove::data::Task::TaskType type{rove::data::Task::TaskType::Daily};
+        QString name;
+        QString searchKey;  //!< 名称与描述的大小写折叠拼接
+        qint64 deadlineMs{0};
+        int coinReward{0};
+        int growthReward{0};
+        int bonusStreak{0};
+        bool completed{false};
+    };
+
+    static Row makeRow(const rove::data::Task& task);
+    static QString typeText(rove::data::Task::TaskType type);
+    QVariant sortKey(const Row& row, int column) const;
+
+    /**
+     * @brief 返回 id 所在行号，不存在时返回 -1。
+     */
+    int rowOf(int taskId) const;
+
+    rove::data::TaskManager& m_taskManager;
+    std::vector<Row> m_rows;  //!< 按任务 id 升序
+    bool m_loaded{false};
+};
+
+#endif  // TASKMODEL_H
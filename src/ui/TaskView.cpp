@@ -1,93 +1,129 @@
 #include "TaskView.h"
 #include "ui_TaskView.h"
 
+#include <QDate>
 #include <QMessageBox>
 
+#include "TaskFilterProxyModel.h"
+#include "TaskModel.h"
+
+namespace {
+constexpr int kSearchDebounceMs = 150;
+}  // namespace
+
 /**
- * @brief 构造函数：加载 UI 并绑定信号。
+ * @brief 构造函数：加载 UI、挂接模型与代理并绑定信号。
  */
 TaskView::TaskView(rove::data::TaskManager& manager, QWidget* parent)
     : QWidget(parent), ui(std::make_unique<Ui::TaskView>()), m_taskManager(manager) {
     ui->setupUi(this);
-    m_taskTree = ui->taskTree;
+    m_model = new TaskModel(m_taskManager, this);
+    m_proxy = new TaskFilterProxyModel(this);
+    m_proxy->setSourceModel(m_model);
+    ui->taskTree->setModel(m_proxy);
+    ui->taskTree->sortByColumn(TaskModel::DeadlineColumn, Qt::AscendingOrder);
+
     ui->periodCombo->addItems({QStringLiteral("全部"), QStringLiteral("日常"), QStringLiteral("每周"),
-                               QStringLiteral("学期")});
+                               QStringLiteral("学期"), QStringLiteral("自定义")});
+    ui->statusCombo->addItems({QStringLiteral("全部状态"), QStringLiteral("未完成"), QStringLiteral("已完成")});
+    const QDate today = QDate::currentDate();
+    ui->deadlineFrom->setDate(today);
+    ui->deadlineTo->setDate(today.addDays(7));
+
+    m_searchDebounce = new QTimer(this);
+    m_searchDebounce->setSingleShot(true);
+    m_searchDebounce->setInterval(kSearchDebounceMs);
+    connect(m_searchDebounce, &QTimer::timeout, this, [this] { m_proxy->setSearchText(ui->searchEdit->text()); });
+    connect(ui->searchEdit, &QLineEdit::textChanged, m_searchDebounce, qOverload<>(&QTimer::start));
+
     connect(ui->completeBtn, &QPushButton::clicked, this, &TaskView::onCompleteClicked);
     connect(ui->periodCombo,
             qOverload<int>(&QComboBox::currentIndexChanged),
             this,
             &TaskView::onPeriodChanged);
-    reloadTasks();
+    connect(ui->statusCombo,
+            qOverload<int>(&QComboBox::currentIndexChanged),
+            this,
+            &TaskView::onStatusChanged);
+    connect(ui->deadlineCheck, &QCheckBox::toggled, this, &TaskView::onDeadlineRangeChanged);
+    connect(ui->deadlineFrom, &QDateEdit::dateChanged, this, &TaskView::onDeadlineRangeChanged);
+    connect(ui->deadlineTo, &QDateEdit::dateChanged, this, &TaskView::onDeadlineRangeChanged);
+    showLoading();  // 中文：任务由 StartupHydrator 在后台装载，完成后 MainWindow 调用 reloadTasks()。
 }
 
 TaskView::~TaskView() = default;
 
 void TaskView::reloadTasks() {
-    std::vector<rove::data::Task> tasks;
-    const auto daily = m_taskManager.tasksByType(rove::data::Task::TaskType::Daily);
-    const auto weekly = m_taskManager.tasksByType(rove::data::Task::TaskType::Weekly);
-    const auto semester = m_taskManager.tasksByType(rove::data::Task::TaskType::Semester);
-    const auto custom = m_taskManager.tasksByType(rove::data::Task::TaskType::Custom);
-    tasks.insert(tasks.end(), daily.begin(), daily.end());
-    tasks.insert(tasks.end(), weekly.begin(), weekly.end());
-    tasks.insert(tasks.end(), semester.begin(), semester.end());
-    tasks.insert(tasks.end(), custom.begin(), custom.end());
-    populateTree(tasks);
+    m_model->reload();
+    ui->loadingLabel->hide();
+    ui->taskTree->resizeColumnToContents(TaskModel::NameColumn);
+}
+
+void TaskView::applyTaskChanges(const QSet<int>& taskIds) {
+    m_model->applyChanges(taskIds);
+}
+
+void TaskView::showLoading() {
+    ui->loadingLabel->setVisible(!m_model->isLoaded());
+}
+
+void TaskView::setTaskCompletedOptimistically(int taskId, bool completed) {
+    m_model->setCompletedOverride(taskId, completed);
 }
 
 /**
  * @brief 点击完成按钮后的槽函数，校验选择并发射信号。
  */
 void TaskView::onCompleteClicked() {
-    auto* item = m_taskTree->currentItem();
-    if (!item) {
+    const QModelIndex current = ui->taskTree->currentIndex();
+    if (!current.isValid()) {
         QMessageBox::information(this, QStringLiteral("提示"), QStringLiteral("请先选择一个任务"));
         return;
     }
-    const int taskId = item->data(0, Qt::UserRole).toInt();
+    const int taskId = current.data(TaskModel::TaskIdRole).toInt();
     emit taskCompletionRequested(taskId);
 }
 
 void TaskView::onPeriodChanged(int index) {
-    std::vector<rove::data::Task> tasks;
-    const auto daily = m_taskManager.tasksByType(rove::data::Task::TaskType::Daily);
-    const auto weekly = m_taskManager.tasksByType(rove::data::Task::TaskType::Weekly);
-    const auto semester = m_taskManager.tasksByType(rove::data::Task::TaskType::Semester);
-    const auto custom = m_taskManager.tasksByType(rove::data::Task::TaskType::Custom);
-    tasks.insert(tasks.end(), daily.begin(), daily.end());
-    tasks.insert(tasks.end(), weekly.begin(), weekly.end());
-    tasks.insert(tasks.end(), semester.begin(), semester.end());
-    tasks.insert(tasks.end(), custom.begin(), custom.end());
-    std::vector<rove::data::Task> filtered;
-    for (const auto& task : tasks) {
-        if (index == 0) {
-            filtered.push_back(task);
-        } else if (index == 1 && task.type() == rove::data::Task::TaskType::Daily) {
-            filtered.push_back(task);
-        } else if (index == 2 && task.type() == rove::data::Task::TaskType::Weekly) {
-            filtered.push_back(task);
-        } else if (index == 3 && task.type() == rove::data::Task::TaskType::Semester) {
-            filtered.push_back(task);
-        }
+    using TaskType = rove::data::Task::TaskType;
+    switch (index) {
+    case 1:
+        m_proxy->setTypeFilter(TaskType::Daily);
+        break;
+    case 2:
+        m_proxy->setTypeFilter(TaskType::Weekly);
+        break;
+    case 3:
+        m_proxy->setTypeFilter(TaskType::Semester);
+        break;
+    case 4:
+        m_proxy->setTypeFilter(TaskType::Custom);
+        break;
+    default:
+        m_proxy->setTypeFilter(std::nullopt);
     }
-    populateTree(filtered);
 }
 
-/**
- * @brief 将任务列表填充到树控件，支持懒加载。
- */
-void TaskView::populateTree(const std::vector<rove::data::Task>& tasks) {
-    m_taskTree->clear();
-    for (const auto& task : tasks) {
-        auto* item = new QTreeWidgetItem(m_taskTree);
-        item->setText(0, QString::fromStdString(task.name()));
-        item->setText(1, QStringLiteral("成长 %1 / 金币 %2")
-                             .arg(task.growthReward())
-                             .arg(task.coinReward()));
-        item->setText(2, task.isCompleted() ? QStringLiteral("已完成") : QStringLiteral("未完成"));
-        item->setData(0, Qt::UserRole, task.id());
+void TaskView::onStatusChanged(int index) {
+    switch (index) {
+    case 1:
+        m_proxy->setCompletionFilter(false);
+        break;
+    case 2:
+        m_proxy->setCompletionFilter(true);
+        break;
+    default:
+        m_proxy->setCompletionFilter(std::nullopt);
     }
-    m_taskTree->resizeColumnToContents(0);
 }
 
-
+void TaskView::onDeadlineRangeChanged() {
+    const bool enabled = ui->deadlineCheck->isChecked();
+    ui->deadlineFrom->setEnabled(enabled);
+    ui->deadlineTo->setEnabled(enabled);
+    if (!enabled) {
+        m_proxy->setDeadlineRange(std::nullopt, std::nullopt);
+        return;
+    }
+    m_proxy->setDeadlineRange(ui->deadlineFrom->date(), ui->deadlineTo->date());
+}
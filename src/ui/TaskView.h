@@ -2,10 +2,11 @@
 #define TASKVIEW_H
 
 #include <QWidget>
-#include <QTreeWidget>
 #include <QPushButton>
 #include <QComboBox>
-#include <vector>
+#include <QSet>
+#include <QTimer>
+#include <QTreeView>
 #include <memory>
 #include "../core/TaskManager.h"
 
@@ -13,10 +14,14 @@ namespace Ui {
 class TaskView;
 }
 
+class TaskModel;
+class TaskFilterProxyModel;
+
 /**
  * @class TaskView
- * @brief 任务管理界面，展示日/周/学期任务并支持完成控制。
- * 中文说明：通过树状视图按周期分类任务，提供完成、提醒与刷新功能，并通过信号将操作交给 TaskManager。
+ * @brief 任务管理界面，展示日/周/学期/自定义任务并支持完成控制。
+ * 中文说明：TaskModel 保存任务行并按变更 id 增量更新，TaskFilterProxyModel 负责类型、完成状态、截止区间
+ *          与文本搜索筛选以及按列排序；操作通过信号交给业务层处理。
  */
 class TaskView : public QWidget {
     Q_OBJECT
@@ -34,10 +39,26 @@ signals:
 
 public slots:
     /**
-     * @brief 从管理器重新加载任务列表。
+     * @brief 从管理器重新装载全部任务，用于首次装载与缓存整体替换。
      */
     void reloadTasks();
 
+    /**
+     * @brief 按 id 增量回读变化的任务，首次装载前忽略。
+     */
+    void applyTaskChanges(const QSet<int>& taskIds);
+
+    /**
+     * @brief 显示加载占位，任务装载完成后由 reloadTasks() 撤下。
+     */
+    void showLoading();
+
+    /**
+     * @brief 乐观更新：完成命令提交后立即把任务行标为“已完成”，命令失败时以 completed=false 撤销。
+     * 中文：命令成功后任务变更经 ChangeBus 到达 applyTaskChanges()，届时以管理器中的真实状态为准。
+     */
+    void setTaskCompletedOptimistically(int taskId, bool completed);
+
 private slots:
     /**
      * @brief 点击完成按钮时触发，提取所选任务信息。
@@ -45,21 +66,27 @@ private slots:
     void onCompleteClicked();
 
     /**
-     * @brief 周期过滤变更时刷新视图。
+     * @brief 类型过滤变更：0 为全部，其余依次对应 Daily/Weekly/Semester/Custom。
      * @param index 组合框索引。
      */
     void onPeriodChanged(int index);
 
-private:
     /**
-     * @brief 将任务填充到树形控件中。
+     * @brief 完成状态过滤变更：0 为全部，1 为未完成，2 为已完成。
+     */
+    void onStatusChanged(int index);
+
+    /**
+     * @brief 截止日期复选框或日期变化时更新区间条件。
      */
-    void populateTree(const std::vector<rove::data::Task>& tasks);
+    void onDeadlineRangeChanged();
 
+private:
     std::unique_ptr<Ui::TaskView> ui;
     rove::data::TaskManager& m_taskManager;
-    QTreeWidget* m_taskTree{nullptr};
+    TaskModel* m_model{nullptr};
+    TaskFilterProxyModel* m_proxy{nullptr};
+    QTimer* m_searchDebounce{nullptr};  //!< 输入停顿后才应用搜索词，连续击键只筛选一次
 };
 
 #endif  // TASKVIEW_H
-
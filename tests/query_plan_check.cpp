@@ -0,0 +1,90 @@
+#include <QCoreApplication>
+#include <QDir>
+
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "DatabaseManager.h"
+
+/**
+ * @file query_plan_check.cpp
+ * @brief 执行计划回归测试：在迁移后的临时库上对 DatabaseManager::queryPlanCatalog 中的每条语句做 EXPLAIN QUERY PLAN。
+ * 中文：由 ctest 运行（query_plan_check），无需造数。语句无法准备，或在允许列表之外的表上出现整表扫描时以退出码 1 结束，
+ *       并打印对应 SQL 与计划。与 bench_core --check-plans 不同，审计范围是登记的全部热路径语句与动态拼接形态，
+ *       不依赖某次运行恰好执行过哪些查询。
+ */
+
+namespace {
+
+using rove::data::DatabaseManager;
+
+/**
+ * @brief 允许整表扫描的表：商品目录与账号表按设计整表读取且行数很少，sqlite_master 只在启动与迁移时查询。
+ */
+constexpr const char* kScanAllowedTables[] = {"shop_items", "users", "sqlite_master"};
+
+bool isScanAllowed(const std::string& table) {
+    for (const char* allowed : kScanAllowedTables) {
+        if (table == allowed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void removeDatabaseFiles(const std::string& path) {
+    for (const char* suffix : {"", "-wal", "-shm", "-journal"}) {
+        std::remove((path + suffix).c_str());
+    }
+}
+
+int runCheck() {
+    const std::string path = QDir::tempPath().toStdString() + "/query_plan_check.db";
+    removeDatabaseFiles(path);
+    auto& database = DatabaseManager::instance();
+    database.initialize(path);
+
+    const auto audits = database.auditQueryPlans(database.queryPlanCatalog());
+    std::size_t violations = 0;
+    for (const auto& audit : audits) {
+        std::vector<std::string> disallowed;
+        for (const auto& table : audit.scannedTables) {
+            if (!isScanAllowed(table)) {
+                disallowed.push_back(table);
+            }
+        }
+        if (audit.prepared && disallowed.empty()) {
+            continue;
+        }
+        ++violations;
+        if (!audit.prepared) {
+            std::printf("unprepared: %s\n", audit.sql.c_str());
+        } else {
+            std::printf("full scan of");
+            for (const auto& table : disallowed) {
+                std::printf(" %s", table.c_str());
+            }
+            std::printf(": %s\n", audit.sql.c_str());
+        }
+        for (const auto& row : audit.plan) {
+            std::printf("    %s\n", row.c_str());
+        }
+    }
+    std::printf("query plans: %zu statements checked, %zu violations\n", audits.size(), violations);
+    removeDatabaseFiles(path);
+    return violations == 0 ? 0 : 1;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    try {
+        return runCheck();
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "query_plan_check failed: %s\n", e.what());
+        return 1;
+    }
+}